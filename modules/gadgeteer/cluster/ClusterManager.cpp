@@ -26,6 +26,7 @@
 
 #include <gadget/gadgetConfig.h>
 
+#include <cstdlib>
 #include <iomanip>
 #include <sstream>
 #include <boost/version.hpp>
@@ -58,6 +59,7 @@
 #include <cluster/ClusterNetwork.h>
 #include <cluster/ClusterPlugin.h>
 #include <cluster/ConfigHandler.h>
+#include <cluster/FrameTrace.h>
 #include <cluster/Packets/ConfigPacket.h>
 #include <cluster/Packets/Packet.h>
 
@@ -160,6 +162,7 @@ ClusterManager::ClusterManager()
    , mWindowOpened( false )
    , mIsMaster(false)
    , mSoftwareSwapLock(false)
+   , mFusedSync(false)
    , mLocalNodeName()
    , mListenPort(DEFAULT_SLAVE_PORT)
    , mClusterNetwork(NULL)
@@ -167,8 +170,11 @@ ClusterManager::ClusterManager()
    , mPostPostFrameCallCount(0)
 {
    mConfigHandler = ConfigHandler::create();
+   mFrameTrace = FrameTrace::create();
    mClusterNetwork = new ClusterNetwork();
    mClusterNetwork->addHandler(mConfigHandler);
+   mClusterNetwork->addHandler(mFrameTrace);
+   mClusterNetwork->setFrameTrace(mFrameTrace);
 }
 
 ClusterManager::~ClusterManager()
@@ -228,6 +234,12 @@ void ClusterManager::start()
 
    mClusterStarted = true;
 
+   // The start-up barrier below is the first one used to align the clocks,
+   // so the trace must know its role before then.
+   mFrameTrace->start(mIsMaster,
+                      NULL != mLocalNodeElement.get() ?
+                         mLocalNodeElement->getName() : std::string("master"));
+
    // Connect the entire cluster.
    if (mIsMaster)
    {
@@ -236,8 +248,23 @@ void ClusterManager::start()
          throw ClusterException("Master must have a ClusterManager config element.", VPR_LOCATION);
       }
       configCluster(mClusterElement);
-      mClusterNetwork->connectToSlaves();
 
+      vpr::Interval connect_timeout(60, vpr::Interval::Sec);
+      std::string timeout_str;
+      if ( vpr::System::getenv("GADGET_CONNECT_TIMEOUT", timeout_str) )
+      {
+         const int value = std::atoi(timeout_str.c_str());
+         if ( value > 0 )
+         {
+            connect_timeout.set(value, vpr::Interval::Sec);
+         }
+      }
+
+      if ( ! mClusterNetwork->connectToSlaves(connect_timeout) )
+      {
+         throw ClusterException("Could not connect to every cluster node.",
+                                VPR_LOCATION);
+      }
 
       // Send initial configuration to each node.
       ClusterNetwork::node_list_t& nodes = mClusterNetwork->getNodes();
@@ -362,6 +389,7 @@ void ClusterManager::removePlugin( ClusterPluginPtr oldPlugin )
          << "Removing Plugin: " << oldPlugin->getPluginName()
          << std::endl << vprDEBUG_FLUSH;
       mPlugins.erase(found);
+      mPluginTraceNames.erase(oldPlugin.get());
    }
 }
 
@@ -373,9 +401,13 @@ void ClusterManager::preDraw()
    vprDEBUG( gadgetDBG_NET_MGR, vprDBG_HVERB_LVL )
       << clrOutBOLD( clrCYAN,"[ClusterManager]" )
       << " preDraw" << std::endl << vprDEBUG_FLUSH;
+   FrameTrace* trace = mFrameTrace->isEnabled() ? mFrameTrace.get() : NULL;
+   FrameTrace::Scope trace_scope(trace, FrameTrace::PRE_DRAW);
    getNetwork()->corkNetwork();
    for ( plugin_list_t::iterator itr = mPlugins.begin(); itr != mPlugins.end(); itr++ )
    {
+      FrameTrace::Scope plugin_scope(trace,
+                                     NULL != trace ? getTraceName(*itr) : 0);
       (*itr)->preDraw();
       updateNeeded = true;
    }
@@ -383,7 +415,7 @@ void ClusterManager::preDraw()
    if ( updateNeeded )
    {
       mPreDrawCallCount++;
-      update(2);
+      exchange(ClusterPlugin::PRE_DRAW, 2);
    }
 }
 
@@ -399,17 +431,93 @@ void ClusterManager::postPostFrame()
    vprDEBUG( gadgetDBG_NET_MGR, vprDBG_HVERB_LVL )
       << clrOutBOLD( clrCYAN,"[ClusterManager]" )
       << " postPostFrame" << std::endl << vprDEBUG_FLUSH;
-   getNetwork()->corkNetwork();
+   FrameTrace* trace = mFrameTrace->isEnabled() ? mFrameTrace.get() : NULL;
+
+   {
+      FrameTrace::Scope trace_scope(trace, FrameTrace::POST_POST_FRAME);
+      getNetwork()->corkNetwork();
+      for ( plugin_list_t::iterator itr = mPlugins.begin(); itr != mPlugins.end(); itr++ )
+      {
+         FrameTrace::Scope plugin_scope(trace,
+                                        NULL != trace ? getTraceName(*itr) : 0);
+         (*itr)->postPostFrame();
+         updateNeeded = true;
+      }
+
+      // The spans recorded so far leave with this exchange.
+      if ( NULL != trace )
+      {
+         trace->flush(*getNetwork());
+      }
+
+      if ( updateNeeded )
+      {
+         mPostPostFrameCallCount++;
+         exchange(ClusterPlugin::POST_POST_FRAME, 3);
+      }
+   }
+
+   if ( NULL != trace )
+   {
+      trace->endFrame();
+   }
+}
+
+vpr::Uint16 ClusterManager::getTraceName(const ClusterPluginPtr& plugin)
+{
+   std::map<ClusterPlugin*, vpr::Uint16>::const_iterator found =
+      mPluginTraceNames.find(plugin.get());
+
+   if ( mPluginTraceNames.end() != found )
+   {
+      return found->second;
+   }
+
+   const vpr::Uint16 name(mFrameTrace->addName(plugin->getPluginName()));
+   mPluginTraceNames[plugin.get()] = name;
+   return name;
+}
+
+void ClusterManager::exchange(const ClusterPlugin::SyncPhase phase,
+                              const int temp)
+{
+   if ( ! mFusedSync )
+   {
+      update(temp);
+      return;
+   }
+
+   // Without the software swap lock, the end of the frame is where the
+   // nodes are held in step.
+   const bool sync_point = ! mSoftwareSwapLock &&
+                           ClusterPlugin::POST_POST_FRAME == phase;
+
+   vpr::Uint32 phases(0);
+   bool wait(! mIsMaster || sync_point);
+
    for ( plugin_list_t::iterator itr = mPlugins.begin(); itr != mPlugins.end(); itr++ )
    {
-      (*itr)->postPostFrame();
-      updateNeeded = true;
+      phases |= (*itr)->getSyncPhases();
+
+      if ( ! wait && (*itr)->needsSlaveData(phase) )
+      {
+         wait = true;
+      }
    }
 
-   if ( updateNeeded )
+   if ( ! sync_point && 0 == (phases & phase) )
    {
-      mPostPostFrameCallCount++;
-      update(3);
+      // Nothing is needed yet.  Whatever was written goes out now and is
+      // read at the next exchange.
+      getNetwork()->uncorkNetwork();
+   }
+   else if ( wait )
+   {
+      update(temp);
+   }
+   else
+   {
+      getNetwork()->sendUpdate(temp);
    }
 }
 
@@ -687,6 +795,11 @@ bool ClusterManager::configAdd( jccl::ConfigElementPtr element )
          const std::string swap_lock_prop_name( "use_software_swap_lock" );
          mSoftwareSwapLock = element->getProperty<bool>( swap_lock_prop_name);
 
+         // Find out if the master should wait for the slaves only once per
+         // frame.
+         const std::string fused_sync_prop_name( "use_fused_sync" );
+         mFusedSync = element->getProperty<bool>( fused_sync_prop_name );
+
          ret_val = true;
       }
 
@@ -910,6 +1023,9 @@ std::ostream& operator<<( std::ostream& out, ClusterManager& mgr )
        << std::endl;
    out << "preDraw() call count:       " << mgr.mPreDrawCallCount << std::endl;
    out << "postPostFrame() call count: " << mgr.mPostPostFrameCallCount << std::endl;
+   out << "Software swap lock:         " << (mgr.mSoftwareSwapLock ? "on" : "off") << std::endl;
+   out << "Fused synchronization:      " << (mgr.mFusedSync ? "on" : "off") << std::endl;
+   out << "Frame tracing:              " << (mgr.mFrameTrace->isEnabled() ? "on" : "off") << std::endl;
    out << "Plugins:" << std::endl;
 
    // Dump Plugins
@@ -41,9 +41,11 @@
 
 #include <cluster/ClusterDepChecker.h>
 #include <cluster/ClusterNetwork.h>
+#include <cluster/ClusterPlugin.h>
 #include <cluster/ClusterPluginPtr.h>
 #include <cluster/Packets/PacketPtr.h>
 #include <cluster/ConfigHandlerPtr.h>
+#include <cluster/FrameTrace.h>
 #include <gadget/Util/Debug.h>
 
 #include <list>
@@ -270,12 +272,15 @@ public:
 
    /**
     * Cycle through ClusterPlugins until one of them can
-    * achieve swaplock.
+    * achieve swaplock.  With fused synchronization, this is the one point
+    * in the frame at which the master waits for every slave.
     */
    void swapBarrier()
    {
       if (mSoftwareSwapLock)
       {
+         FrameTrace::Scope trace_scope(mFrameTrace.get(),
+                                       FrameTrace::SWAP_BARRIER);
          barrier();
       }
    }
@@ -349,6 +354,22 @@ public:
 private:
    ClusterDepChecker            mDepChecker;
 
+   /**
+    * Exchanges the data written by the plugins in the given phase.  Without
+    * fused synchronization this is a full update().  With it, the exchange
+    * is skipped if no plugin needs its data delivered in this phase, and
+    * the master sends its end block without waiting for the slaves unless
+    * a plugin needs their data now or this is the last exchange of the
+    * frame.
+    */
+   void exchange(const ClusterPlugin::SyncPhase phase, const int temp);
+
+   /**
+    * Returns the name under which the spans of the given plugin are
+    * recorded in the frame trace.
+    */
+   vpr::Uint16 getTraceName(const ClusterPluginPtr& plugin);
+
    typedef std::list<ClusterPluginPtr> plugin_list_t;
 
    plugin_list_t                mPlugins;               /**< List of Plugins.*/
@@ -360,6 +381,7 @@ private:
    bool                         mWindowOpened;          /**< If a window has been opened on the local machine. */
    bool                         mIsMaster;              /**< True if we are the cluster master. */
    bool                         mSoftwareSwapLock;      /**< If we should swap lock the cluster in software. */
+   bool                         mFusedSync;             /**< If the master should wait for the slaves only once per frame. */
 
    //@{
    /** @name Cluster configuration elements. */
@@ -373,6 +395,8 @@ private:
    vpr::Uint16                  mListenPort;            /**< Port that we should listen on if we are a slave. */
    ClusterNetwork*              mClusterNetwork;        /**< The network representation of the cluster. */
    ConfigHandlerPtr             mConfigHandler;         /**< Delegate that handles all configuration packets. */
+   FrameTracePtr                mFrameTrace;            /**< Timeline of the cluster frames. */
+   std::map<ClusterPlugin*, vpr::Uint16> mPluginTraceNames; /**< Span names of the plugins. */
 
    vpr::Uint64                  mPreDrawCallCount;       /**< # calls to preDraw() */
    vpr::Uint64                  mPostPostFrameCallCount; /**< # calls to postPostFrame() */
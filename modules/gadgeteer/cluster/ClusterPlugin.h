@@ -34,6 +34,7 @@
 #include <boost/concept_check.hpp>
 #include <boost/enable_shared_from_this.hpp>
 
+#include <vpr/vprTypes.h>
 #include <vpr/Util/Assert.h>
 
 #include <jccl/RTRC/ConfigElementHandler.h>
@@ -64,10 +65,42 @@ public:
    void setActive(bool active);
    bool isActive();
    
+   /**
+    * The points in the frame at which cluster data is exchanged.
+    */
+   enum SyncPhase
+   {
+      PRE_DRAW        = 0x1,   /**< preDraw() */
+      POST_POST_FRAME = 0x2    /**< postPostFrame() */
+   };
+
    virtual void preDraw() = 0;
    virtual void postPostFrame() = 0;
    virtual std::string getPluginName() = 0;
 
+   /**
+    * Returns the phases (a mask of SyncPhase values) at the end of which
+    * the data sent by this plugin must have been delivered.  When fused
+    * synchronization is enabled, a phase that no plugin needs is not
+    * exchanged and its data is delivered with the next exchange.  This
+    * must be the same on every node.
+    */
+   virtual vpr::Uint32 getSyncPhases()
+   {
+      return PRE_DRAW | POST_POST_FRAME;
+   }
+
+   /**
+    * Indicates whether the master must wait for the data sent by the
+    * slaves in the given phase.  If no plugin does, the master sends its
+    * data for that phase without waiting, and the slaves' data is read at
+    * the next full exchange.  This is only asked on the master.
+    */
+   virtual bool needsSlaveData(const SyncPhase phase)
+   {
+      return (getSyncPhases() & phase) != 0;
+   }
+
    virtual void addSerializableObject(vpr::SerializableObject* object)
    {
       boost::ignore_unused_variable_warning(object);
@@ -0,0 +1,568 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <gadget/gadgetConfig.h>
+
+#include <algorithm>
+#include <boost/concept_check.hpp>
+
+#include <vpr/System.h>
+#include <vpr/IO/ObjectReader.h>
+#include <vpr/IO/ObjectWriter.h>
+#include <vpr/Sync/Guard.h>
+
+#include <gadget/Util/Debug.h>
+#include <cluster/ClusterException.h>
+#include <cluster/Packets/DataPacket.h>
+#include <cluster/Packets/Header.h>
+#include <cluster/FrameTrace.h>
+
+namespace
+{
+
+/** Names of the spans in cluster::FrameTrace::SpanName. */
+const char* const SPAN_NAMES[] =
+{
+   "preDraw", "postPostFrame", "swapBarrier", "barrier", "wait"
+};
+
+/** Number of round trips over which the clock offset bounds are kept. */
+const std::size_t OFFSET_WINDOW(64);
+
+/** Sequence number of a round trip that has not been recorded. */
+const vpr::Uint32 NO_ROUND_TRIP(0xffffffff);
+
+/** Closes the JSON array of the timeline. */
+const char TIMELINE_END[] = "\n]\n";
+
+/** Returns \p str with the characters that may not appear in a JSON string
+ * escaped or replaced.
+ */
+std::string escape(const std::string& str)
+{
+   std::string result;
+   result.reserve(str.size());
+
+   for ( std::string::const_iterator c = str.begin(); c != str.end(); ++c )
+   {
+      if ( '"' == *c || '\\' == *c )
+      {
+         result += '\\';
+         result += *c;
+      }
+      else if ( static_cast<unsigned char>(*c) < 0x20 )
+      {
+         result += ' ';
+      }
+      else
+      {
+         result += *c;
+      }
+   }
+
+   return result;
+}
+
+}
+
+namespace cluster
+{
+
+FrameTrace::FrameTrace()
+   : mEnabled(false)
+   , mMaster(false)
+   , mFrame(0)
+   , mRoundTripCount(0)
+   , mNamesSent(0)
+   , mFirstEvent(true)
+   , mBase(0)
+   , mInFirstName(0)
+{
+   std::string trace;
+   mEnabled = vpr::System::getenv("GADGET_CLUSTER_TRACE", trace) &&
+              ! trace.empty();
+
+   for ( unsigned int i = 0; i < NUM_SPAN_NAMES; ++i )
+   {
+      mNames.push_back(SPAN_NAMES[i]);
+   }
+
+   // Make room for a frame's worth of spans so that recording them does
+   // not allocate.
+   mSpans.reserve(256);
+   mOutSpans.reserve(256);
+
+   // The packet is reused for every frame.
+   mPacket = DataPacket::create(getHandlerGUID(), getHandlerGUID());
+}
+
+FrameTrace::~FrameTrace()
+{
+   // A timeline in a file was closed by its last write.
+   if ( mOutput.is_open() )
+   {
+      if ( std::streampos(-1) == mOutput.tellp() )
+      {
+         mOutput << TIMELINE_END;
+      }
+      mOutput.close();
+   }
+}
+
+FrameTracePtr FrameTrace::create()
+{
+   return FrameTracePtr(new FrameTrace());
+}
+
+void FrameTrace::start(const bool master, const std::string& nodeName)
+{
+   mMaster = master;
+
+   if ( ! mEnabled || ! mMaster )
+   {
+      return;
+   }
+
+   std::string file_name;
+   vpr::System::getenv("GADGET_CLUSTER_TRACE", file_name);
+
+   vpr::Guard<vpr::Mutex> guard(mTimelineLock);
+
+   mOutput.open(file_name.c_str());
+
+   if ( ! mOutput )
+   {
+      vprDEBUG(gadgetDBG_RIM, vprDBG_CRITICAL_LVL)
+         << clrOutBOLD(clrRED, "ERROR")
+         << ": Failed to open cluster trace file '" << file_name << "'"
+         << std::endl << vprDEBUG_FLUSH;
+      mEnabled = false;
+      return;
+   }
+
+   vprDEBUG(gadgetDBG_RIM, vprDBG_CONFIG_LVL)
+      << clrOutBOLD(clrCYAN, "[FrameTrace] ")
+      << "Writing the cluster timeline to " << file_name
+      << std::endl << vprDEBUG_FLUSH;
+
+   mBase      = vpr::Interval::now().usec();
+   mLocalName = nodeName;
+   mOutput << "[\n";
+
+   NodeTrace& local = getNodeTrace(mLocalName);
+   local.haveOffset = true;
+   closeTimeline();
+}
+
+vpr::Uint16 FrameTrace::addName(const std::string& name)
+{
+   vpr::Guard<vpr::Mutex> guard(mLock);
+   mNames.push_back(name);
+   return static_cast<vpr::Uint16>(mNames.size() - 1);
+}
+
+void FrameTrace::addSpan(const vpr::Uint16 name, const vpr::Interval& start,
+                         const vpr::Interval& end)
+{
+   Span span;
+   span.start    = start.usec();
+   span.duration = end.usec() > span.start ?
+                      static_cast<vpr::Uint32>(end.usec() - span.start) : 0;
+   span.frame    = mFrame;
+   span.name     = name;
+
+   vpr::Thread* self(vpr::Thread::self());
+
+   vpr::Guard<vpr::Mutex> guard(mLock);
+
+   std::vector<vpr::Thread*>::iterator lane =
+      std::find(mLanes.begin(), mLanes.end(), self);
+   if ( mLanes.end() == lane )
+   {
+      lane = mLanes.insert(mLanes.end(), self);
+   }
+   span.lane = static_cast<vpr::Uint8>(lane - mLanes.begin());
+
+   mSpans.push_back(span);
+}
+
+void FrameTrace::addRoundTrip(const gadget::NetworkManager::node_list_t& nodes,
+                              const vpr::Interval& sent)
+{
+   typedef gadget::NetworkManager::node_list_t::const_iterator iter_t;
+
+   const vpr::Uint32 seq(mRoundTripCount++);
+
+   for ( iter_t i = nodes.begin(); i != nodes.end(); ++i )
+   {
+      if ( ! (*i)->isConnected() )
+      {
+         continue;
+      }
+
+      RoundTrip sample;
+      sample.seq      = seq;
+      sample.sent     = sent.usec();
+      sample.received = (*i)->getUpdateTime().usec();
+
+      if ( mMaster )
+      {
+         vpr::Guard<vpr::Mutex> guard(mTimelineLock);
+         NodeTrace& node = getNodeTrace((*i)->getName());
+         node.roundTrips[seq % OFFSET_WINDOW] = sample;
+      }
+      else
+      {
+         vpr::Guard<vpr::Mutex> guard(mLock);
+         mRoundTrips.push_back(sample);
+      }
+   }
+}
+
+void FrameTrace::flush(gadget::NetworkManager& network)
+{
+   {
+      vpr::Guard<vpr::Mutex> guard(mLock);
+      mOutSpans.swap(mSpans);
+      mOutRoundTrips.swap(mRoundTrips);
+
+      if ( mNames.size() > mNamesSent )
+      {
+         mOutNames.assign(mNames.begin() + mNamesSent, mNames.end());
+      }
+   }
+
+   if ( mMaster )
+   {
+      vpr::Guard<vpr::Mutex> guard(mTimelineLock);
+      NodeTrace& local = getNodeTrace(mLocalName);
+
+      for ( std::vector<std::string>::const_iterator n = mOutNames.begin();
+            n != mOutNames.end();
+            ++n )
+      {
+         local.names.push_back(escape(*n));
+      }
+
+      writeSpans(local, 0, mOutSpans);
+      closeTimeline();
+   }
+   else if ( ! mOutSpans.empty() || ! mOutRoundTrips.empty() ||
+             ! mOutNames.empty() )
+   {
+      mPacket->serialize(*this);
+
+      for ( gadget::NetworkManager::node_list_t::iterator i = network.getNodesBegin();
+            i != network.getNodesEnd();
+            ++i )
+      {
+         if ( ! (*i)->isConnected() )
+         {
+            continue;
+         }
+
+         try
+         {
+            (*i)->send(mPacket);
+         }
+         catch (cluster::ClusterException& ex)
+         {
+            // A node that has gone away is dealt with at the next exchange.
+            vprDEBUG(gadgetDBG_RIM, vprDBG_WARNING_LVL)
+               << clrOutBOLD(clrCYAN, "[FrameTrace] ")
+               << "Failed to send spans to " << (*i)->getName() << ": "
+               << ex.what() << std::endl << vprDEBUG_FLUSH;
+         }
+      }
+   }
+
+   mNamesSent = static_cast<vpr::Uint16>(mNamesSent + mOutNames.size());
+   mOutNames.clear();
+   mOutSpans.clear();
+   mOutRoundTrips.clear();
+}
+
+bool FrameTrace::getClockOffset(const gadget::Node& node, vpr::Int64& offset)
+{
+   vpr::Guard<vpr::Mutex> guard(mTimelineLock);
+
+   std::map<std::string, NodeTrace>::const_iterator found =
+      mNodes.find(node.getName());
+
+   if ( mNodes.end() == found || ! found->second.haveOffset )
+   {
+      return false;
+   }
+
+   offset = static_cast<vpr::Int64>(node.getDelta());
+   return true;
+}
+
+void FrameTrace::handlePacket(cluster::PacketPtr packet, gadget::NodePtr node)
+{
+   // Spans sent to a master that is not tracing are dropped.
+   if ( ! mEnabled || ! mMaster || NULL == node.get() )
+   {
+      return;
+   }
+
+   vprASSERT(Header::RIM_DATA_PACKET == packet->getPacketType() &&
+             "Not a data packet.");
+   DataPacketPtr data_packet = boost::dynamic_pointer_cast<DataPacket>(packet);
+   vprASSERT(NULL != data_packet.get() && "Failed to cast DataPacket.");
+
+   vpr::Guard<vpr::Mutex> guard(mTimelineLock);
+
+   readObject(data_packet->getPacketReader());
+
+   NodeTrace& trace = getNodeTrace(node->getName());
+
+   if ( trace.names.size() < mInFirstName + mInNames.size() )
+   {
+      trace.names.resize(mInFirstName + mInNames.size());
+   }
+
+   for ( std::size_t i = 0; i < mInNames.size(); ++i )
+   {
+      trace.names[mInFirstName + i] = escape(mInNames[i]);
+   }
+
+   for ( std::vector<RoundTrip>::const_iterator s = mInRoundTrips.begin();
+         s != mInRoundTrips.end();
+         ++s )
+   {
+      updateOffset(trace, *node, *s);
+   }
+
+   // Spans that arrive before the first round trip cannot be placed.
+   if ( trace.haveOffset )
+   {
+      writeSpans(trace, static_cast<vpr::Int64>(node->getDelta()), mInSpans);
+   }
+
+   closeTimeline();
+}
+
+void FrameTrace::recoverFromLostNode(gadget::NodePtr lostNode)
+{
+   boost::ignore_unused_variable_warning(lostNode);
+}
+
+void FrameTrace::writeObject(vpr::ObjectWriter* writer)
+{
+   writer->writeUint16(mNamesSent);
+   writer->writeUint16(static_cast<vpr::Uint16>(mOutNames.size()));
+   for ( std::vector<std::string>::const_iterator n = mOutNames.begin();
+         n != mOutNames.end();
+         ++n )
+   {
+      writer->writeString(*n);
+   }
+
+   writer->writeUint32(static_cast<vpr::Uint32>(mOutRoundTrips.size()));
+   for ( std::vector<RoundTrip>::const_iterator s = mOutRoundTrips.begin();
+         s != mOutRoundTrips.end();
+         ++s )
+   {
+      writer->writeUint32(s->seq);
+      writer->writeUint64(s->sent);
+      writer->writeUint64(s->received);
+   }
+
+   writer->writeUint32(static_cast<vpr::Uint32>(mOutSpans.size()));
+   for ( std::vector<Span>::const_iterator s = mOutSpans.begin();
+         s != mOutSpans.end();
+         ++s )
+   {
+      writer->writeUint64(s->start);
+      writer->writeUint32(s->duration);
+      writer->writeUint32(s->frame);
+      writer->writeUint16(s->name);
+      writer->writeUint8(s->lane);
+   }
+}
+
+void FrameTrace::readObject(vpr::ObjectReader* reader)
+{
+   mInNames.clear();
+   mInRoundTrips.clear();
+   mInSpans.clear();
+
+   mInFirstName = reader->readUint16();
+   const vpr::Uint16 num_names = reader->readUint16();
+   for ( vpr::Uint16 i = 0; i < num_names; ++i )
+   {
+      mInNames.push_back(reader->readString());
+   }
+
+   const vpr::Uint32 num_round_trips = reader->readUint32();
+   for ( vpr::Uint32 i = 0; i < num_round_trips; ++i )
+   {
+      RoundTrip sample;
+      sample.seq      = reader->readUint32();
+      sample.sent     = reader->readUint64();
+      sample.received = reader->readUint64();
+      mInRoundTrips.push_back(sample);
+   }
+
+   const vpr::Uint32 num_spans = reader->readUint32();
+   for ( vpr::Uint32 i = 0; i < num_spans; ++i )
+   {
+      Span span;
+      span.start    = reader->readUint64();
+      span.duration = reader->readUint32();
+      span.frame    = reader->readUint32();
+      span.name     = reader->readUint16();
+      span.lane     = reader->readUint8();
+      mInSpans.push_back(span);
+   }
+}
+
+FrameTrace::NodeTrace& FrameTrace::getNodeTrace(const std::string& name)
+{
+   std::map<std::string, NodeTrace>::iterator found = mNodes.find(name);
+
+   if ( mNodes.end() != found )
+   {
+      return found->second;
+   }
+
+   NodeTrace& node = mNodes[name];
+   node.pid = static_cast<vpr::Uint32>(mNodes.size() - 1);
+
+   RoundTrip none;
+   none.seq      = NO_ROUND_TRIP;
+   none.sent     = 0;
+   none.received = 0;
+   node.roundTrips.resize(OFFSET_WINDOW, none);
+
+   for ( unsigned int i = 0; i < NUM_SPAN_NAMES; ++i )
+   {
+      node.names.push_back(SPAN_NAMES[i]);
+   }
+
+   mOutput << (mFirstEvent ? "" : ",\n")
+           << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << node.pid
+           << ",\"args\":{\"name\":\"" << escape(name) << "\"}},\n"
+           << "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":"
+           << node.pid << ",\"args\":{\"sort_index\":" << node.pid << "}}";
+   mFirstEvent = false;
+
+   return node;
+}
+
+// The master's clock is the node's clock plus the offset.  The node read
+// the master's end block after the master sent it, and the master read the
+// node's end block after the node sent it, so each round trip gives a lower
+// and an upper bound on the offset.  Either bound is loosened by network
+// delay or by an end block waiting to be read, which is why the tightest
+// bounds of the last few round trips are used.
+void FrameTrace::updateOffset(NodeTrace& trace, gadget::Node& node,
+                              const RoundTrip& remote)
+{
+   const RoundTrip& local(trace.roundTrips[remote.seq % OFFSET_WINDOW]);
+
+   if ( local.seq != remote.seq )
+   {
+      return;
+   }
+
+   const vpr::Int64 lower =
+      static_cast<vpr::Int64>(local.sent) -
+         static_cast<vpr::Int64>(remote.received);
+   const vpr::Int64 upper =
+      static_cast<vpr::Int64>(local.received) -
+         static_cast<vpr::Int64>(remote.sent);
+
+   trace.bounds.push_back(std::make_pair(lower, upper));
+   if ( trace.bounds.size() > OFFSET_WINDOW )
+   {
+      trace.bounds.pop_front();
+   }
+
+   vpr::Int64 max_lower(lower);
+   vpr::Int64 min_upper(upper);
+   for ( std::deque<std::pair<vpr::Int64, vpr::Int64> >::const_iterator b = trace.bounds.begin();
+         b != trace.bounds.end();
+         ++b )
+   {
+      max_lower = std::max(max_lower, b->first);
+      min_upper = std::min(min_upper, b->second);
+   }
+
+   // Bounds that no longer overlap mean that the clocks drifted apart
+   // within the window.  The latest round trip is the best guess then.
+   const vpr::Int64 offset = max_lower <= min_upper ?
+                                (max_lower + min_upper) / 2 :
+                                (lower + upper) / 2;
+   node.setDelta(static_cast<vpr::Uint64>(offset));
+   trace.haveOffset = true;
+
+   mOutput << ",\n{\"name\":\"clock offset\",\"ph\":\"C\",\"pid\":" << trace.pid
+           << ",\"ts\":"
+           << static_cast<vpr::Int64>(local.sent) -
+                 static_cast<vpr::Int64>(mBase)
+           << ",\"args\":{\"usec\":" << offset << "}}";
+}
+
+void FrameTrace::writeSpans(const NodeTrace& node, const vpr::Int64 offset,
+                            const std::vector<Span>& spans)
+{
+   const vpr::Int64 shift(offset - static_cast<vpr::Int64>(mBase));
+
+   for ( std::vector<Span>::const_iterator s = spans.begin();
+         s != spans.end();
+         ++s )
+   {
+      const char* name = s->name < node.names.size() ?
+                            node.names[s->name].c_str() : "unknown";
+
+      mOutput << ",\n{\"name\":\"" << name
+              << "\",\"cat\":\"cluster\",\"ph\":\"X\",\"pid\":" << node.pid
+              << ",\"tid\":" << static_cast<unsigned int>(s->lane)
+              << ",\"ts\":" << static_cast<vpr::Int64>(s->start) + shift
+              << ",\"dur\":" << s->duration
+              << ",\"args\":{\"frame\":" << s->frame << "}}";
+   }
+}
+
+void FrameTrace::closeTimeline()
+{
+   const std::streampos end(mOutput.tellp());
+
+   // A timeline that cannot be rewound, such as one written to a pipe, is
+   // closed when the trace is destroyed.
+   if ( std::streampos(-1) == end )
+   {
+      mOutput.flush();
+      return;
+   }
+
+   mOutput << TIMELINE_END << std::flush;
+   mOutput.seekp(end);
+}
+
+} // end namespace cluster
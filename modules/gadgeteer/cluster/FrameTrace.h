@@ -0,0 +1,332 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _CLUSTER_FRAME_TRACE_H_
+#define _CLUSTER_FRAME_TRACE_H_
+
+#include <gadget/gadgetConfig.h>
+
+#include <deque>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+#include <vpr/vprTypes.h>
+#include <vpr/IO/SerializableObject.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/Interval.h>
+
+#include <gadget/PacketHandler.h>
+#include <gadget/Node.h>
+#include <gadget/NetworkManager.h>
+#include <cluster/Packets/DataPacketPtr.h>
+#include <cluster/FrameTracePtr.h>
+
+namespace cluster
+{
+
+/** \class FrameTrace FrameTrace.h cluster/FrameTrace.h
+ *
+ * Records timestamped spans for the phases of each cluster frame and merges
+ * the spans of all nodes into one timeline on the master.
+ *
+ * Tracing is turned on by setting the environment variable
+ * \c GADGET_CLUSTER_TRACE on each node that should be traced.  On the
+ * master, its value names the file to which the timeline is written in the
+ * Chrome trace event format (it can be loaded in chrome://tracing or
+ * Perfetto).  On a slave, any non-empty value turns tracing on, and the
+ * slave sends its spans to the master once per frame.  The JSON array in
+ * the file is closed after every write, so the file can be read while the
+ * cluster runs.
+ *
+ * The clocks of the slaves are mapped onto the master's clock using the end
+ * block round trips of gadget::NetworkManager::update() and barrier(), so
+ * there are samples every frame.  Each round trip bounds the offset between
+ * the two clocks from both sides, and the offset is the middle of the
+ * tightest bounds seen over the last few round trips.  The master keeps the
+ * offset of each slave as the delta of its gadget::Node, which is also used
+ * to map the time stamps of the slave's remote input devices.
+ *
+ * Recording a span reads the clock twice and appends a few bytes to a
+ * buffer, so tracing can be left on.  When it is off, nothing is recorded.
+ */
+class GADGET_API FrameTrace
+   : public gadget::PacketHandler
+   , public vpr::SerializableObject
+{
+protected:
+   FrameTrace();
+
+public:
+   virtual ~FrameTrace();
+
+   /**
+    * Creates a FrameTrace instance and returns it wrapped in a
+    * FrameTracePtr object.  Whether tracing is on is decided here from
+    * the environment.
+    */
+   static FrameTracePtr create();
+
+   /** Names of the spans recorded by the cluster code itself. */
+   enum SpanName
+   {
+      PRE_DRAW = 0,        /**< cluster::ClusterManager::preDraw() */
+      POST_POST_FRAME,     /**< cluster::ClusterManager::postPostFrame() */
+      SWAP_BARRIER,        /**< cluster::ClusterManager::swapBarrier() */
+      BARRIER,             /**< gadget::NetworkManager::barrier() */
+      WAIT,                /**< Waiting for the end blocks of other nodes */
+      NUM_SPAN_NAMES
+   };
+
+   /** \class Scope FrameTrace.h cluster/FrameTrace.h
+    *
+    * Records a span from its construction to its destruction.  Nothing is
+    * recorded if the trace is NULL or tracing is off.
+    */
+   class Scope : boost::noncopyable
+   {
+   public:
+      Scope(FrameTrace* trace, const vpr::Uint16 name)
+         : mTrace(NULL != trace && trace->isEnabled() ? trace : NULL)
+         , mName(name)
+      {
+         if ( NULL != mTrace )
+         {
+            mStart.setNow();
+         }
+      }
+
+      ~Scope()
+      {
+         if ( NULL != mTrace )
+         {
+            mTrace->addSpan(mName, mStart, vpr::Interval::now());
+         }
+      }
+
+   private:
+      FrameTrace*       mTrace;
+      const vpr::Uint16 mName;
+      vpr::Interval     mStart;
+   };
+
+   /**
+    * Returns true if spans are being recorded on this node.
+    */
+   bool isEnabled() const
+   {
+      return mEnabled;
+   }
+
+   /**
+    * Prepares the trace once the role of this node is known.  On the master,
+    * this opens the timeline file.
+    *
+    * @param master   True if this node is the cluster master.
+    * @param nodeName The name under which this node appears in the timeline.
+    */
+   void start(const bool master, const std::string& nodeName);
+
+   /**
+    * Adds a span name, such as the name of a cluster plugin, and returns
+    * the identifier to pass to addSpan().
+    */
+   vpr::Uint16 addName(const std::string& name);
+
+   /**
+    * Records a span of the current frame.  This may be called from any
+    * thread.
+    */
+   void addSpan(const vpr::Uint16 name, const vpr::Interval& start,
+                const vpr::Interval& end);
+
+   /**
+    * Records the timing of a completed end block round trip.
+    *
+    * @param nodes The nodes that took part in the round trip.  The update
+    *              time of each one must be the time at which its end block
+    *              was read.
+    * @param sent  The time at which this node sent its end block.
+    */
+   void addRoundTrip(const gadget::NetworkManager::node_list_t& nodes,
+                     const vpr::Interval& sent);
+
+   /**
+    * Counts an end block exchange that this node did not wait for, so that
+    * the round trips of the master and the slaves stay numbered alike.
+    */
+   void skipRoundTrip()
+   {
+      ++mRoundTripCount;
+   }
+
+   /**
+    * Hands over the spans recorded so far.  The master writes them to the
+    * timeline and a slave sends them to the master.  This is called while
+    * the network is corked so that a slave's spans leave with its end block.
+    */
+   void flush(gadget::NetworkManager& network);
+
+   /**
+    * Gets the current estimate of the offset between the clock of the given
+    * node and the clock of the master (master clock minus node clock), which
+    * is the delta of the node.  This is only known on the master.
+    *
+    * @param node   The node.
+    * @param offset Set to the offset in microseconds.
+    *
+    * @return false if there is no estimate for the node yet.
+    */
+   bool getClockOffset(const gadget::Node& node, vpr::Int64& offset);
+
+   /**
+    * Advances the frame number given to new spans.
+    */
+   void endFrame()
+   {
+      ++mFrame;
+   }
+
+   /** @name PacketHandler interface. */
+   //@{
+   virtual vpr::GUID getHandlerGUID()
+   {
+      return vpr::GUID("206c4165-9a35-436c-ad3c-a0c27bfd3581");
+   }
+
+   virtual std::string getHandlerName()
+   {
+      return std::string("Frame Trace");
+   }
+
+   /**
+    * Merges the spans sent by a slave into the timeline.
+    */
+   virtual void handlePacket(cluster::PacketPtr packet, gadget::NodePtr node);
+
+   virtual void recoverFromLostNode(gadget::NodePtr lostNode);
+   //@}
+
+   /** @name vpr::SerializableObject interface. */
+   //@{
+   /** Writes the names, round trip timings and spans not yet sent. */
+   virtual void writeObject(vpr::ObjectWriter* writer);
+
+   /** Reads the data written by writeObject() on a slave. */
+   virtual void readObject(vpr::ObjectReader* reader);
+   //@}
+
+private:
+   struct Span
+   {
+      vpr::Uint64 start;      /**< Microseconds on the recording node */
+      vpr::Uint32 duration;   /**< Microseconds */
+      vpr::Uint32 frame;
+      vpr::Uint16 name;
+      vpr::Uint8  lane;       /**< Index of the recording thread */
+   };
+
+   struct RoundTrip
+   {
+      vpr::Uint32 seq;        /**< Index of the round trip since start-up */
+      vpr::Uint64 sent;       /**< When this node sent its end block */
+      vpr::Uint64 received;   /**< When the other node's end block was read */
+   };
+
+   /** What the master knows about one node of the timeline. */
+   struct NodeTrace
+   {
+      NodeTrace()
+         : pid(0)
+         , haveOffset(false)
+      {;}
+
+      vpr::Uint32                 pid;
+      std::vector<std::string>    names;      /**< Escaped span names */
+      std::vector<RoundTrip>      roundTrips; /**< The master's side, by seq */
+      std::deque<std::pair<vpr::Int64, vpr::Int64> > bounds;
+      bool                        haveOffset; /**< The node's delta is set */
+   };
+
+   NodeTrace& getNodeTrace(const std::string& name);
+
+   void updateOffset(NodeTrace& trace, gadget::Node& node,
+                     const RoundTrip& remote);
+
+   void writeSpans(const NodeTrace& node, const vpr::Int64 offset,
+                   const std::vector<Span>& spans);
+
+   /**
+    * Closes the JSON array and flushes the file.  The next event overwrites
+    * the closing bracket.  A file that cannot be rewound is left open until
+    * the trace is destroyed.
+    */
+   void closeTimeline();
+
+   bool                       mEnabled;
+   bool                       mMaster;
+   vpr::Uint32                mFrame;
+   vpr::Uint32                mRoundTripCount;
+
+   /** @name Data recorded since the last flush(), guarded by mLock. */
+   //@{
+   vpr::Mutex                 mLock;
+   std::vector<std::string>   mNames;
+   std::vector<Span>          mSpans;
+   std::vector<RoundTrip>     mRoundTrips;
+   std::vector<vpr::Thread*>  mLanes;
+   //@}
+
+   /** @name Data being sent, used only by flush(). */
+   //@{
+   std::vector<std::string>   mOutNames;
+   std::vector<Span>          mOutSpans;
+   std::vector<RoundTrip>     mOutRoundTrips;
+   vpr::Uint16                mNamesSent;
+   DataPacketPtr              mPacket;
+   //@}
+
+   /** @name The timeline on the master, guarded by mTimelineLock. */
+   //@{
+   vpr::Mutex                 mTimelineLock;
+   std::ofstream              mOutput;
+   bool                       mFirstEvent;
+   vpr::Uint64                mBase;
+   std::string                mLocalName;
+   std::map<std::string, NodeTrace> mNodes;
+   vpr::Uint16                mInFirstName;
+   std::vector<std::string>   mInNames;
+   std::vector<Span>          mInSpans;
+   std::vector<RoundTrip>     mInRoundTrips;
+   //@}
+};
+
+} // end namespace cluster
+
+#endif /*_CLUSTER_FRAME_TRACE_H_*/
@@ -57,7 +57,7 @@ ConfigPacket::ConfigPacket(const std::string config, const vpr::Uint16 type)
 
 ConfigPacketPtr ConfigPacket::create()
 {
-   return ConfigPacketPtr(new ConfigPacket());
+   return makePtr(new ConfigPacket());
 }
 
 ConfigPacketPtr ConfigPacket::create(const std::string config, const vpr::Uint16 type)
@@ -43,7 +43,8 @@ DataPacket::DataPacket()
    : Packet(vpr::GUID())
 {;}
 
-DataPacket::DataPacket(const vpr::GUID& pluginId, const vpr::GUID& objectId)
+DataPacket::DataPacket(const vpr::GUID& pluginId, const vpr::GUID& objectId,
+                       const vpr::Uint32 channel)
    : Packet(pluginId)
    , mObjectId(objectId)
 {      
@@ -54,19 +55,20 @@ DataPacket::DataPacket(const vpr::GUID& pluginId, const vpr::GUID& objectId)
                             + 16 /*Plugin GUID*/
                             + 16 /*Object GUID*/
                             + 0 /* Empty now, but needs updated later. */,
-                            0/*Field not curently used*/);
+                            channel);
 
    // NOTE: We don't serialize here because we want to reuse the data packet.
 }
 
 DataPacketPtr DataPacket::create()
 {
-   return DataPacketPtr(new DataPacket());
+   return makePtr(new DataPacket());
 }
 
-DataPacketPtr DataPacket::create(const vpr::GUID& pluginId, const vpr::GUID& objectId)
+DataPacketPtr DataPacket::create(const vpr::GUID& pluginId, const vpr::GUID& objectId,
+                                 const vpr::Uint32 channel)
 {
-   return DataPacketPtr(new DataPacket(pluginId, objectId));
+   return DataPacketPtr(new DataPacket(pluginId, objectId, channel));
 }
    
 DataPacket::~DataPacket()
@@ -57,10 +57,12 @@ protected:
     * @param plugin_id GUID of the ClusterPlugin that should handle this
     *                  packet.
     * @param object_id GUID of the object that we are acknowledging.
-    * @param data      Pointer to the raw data that we want to send across
-    *                  the network
+    * @param channel   Routing channel placed in the header (see
+    *                  cluster::Header::getChannel()).  0 leaves the
+    *                  receiver to route by GUID.
     */
-   DataPacket(const vpr::GUID& pluginId, const vpr::GUID& objectId);
+   DataPacket(const vpr::GUID& pluginId, const vpr::GUID& objectId,
+              const vpr::Uint32 channel);
 
 public:
    /**
@@ -77,7 +79,8 @@ public:
     *
     * @since 1.3.7
     */
-   static DataPacketPtr create(const vpr::GUID& pluginId, const vpr::GUID& objectId);
+   static DataPacketPtr create(const vpr::GUID& pluginId, const vpr::GUID& objectId,
+                               const vpr::Uint32 channel = 0);
 
    /**
     * Clean up all unused memory.
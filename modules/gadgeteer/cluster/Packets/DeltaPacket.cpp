@@ -0,0 +1,288 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <gadget/gadgetConfig.h>
+
+#include <cstring>
+
+#include <gadget/Util/Debug.h>
+
+#include <cluster/ClusterException.h>
+#include <cluster/Packets/PacketFactory.h>
+#include <cluster/Packets/DeltaPacket.h>
+
+
+namespace
+{
+
+/**
+ * Unchanged bytes shorter than this do not end a run.  Starting a new run
+ * costs eight bytes for its offset and length.
+ */
+const vpr::Uint32 MIN_GAP(16);
+
+}
+
+namespace cluster
+{
+
+CLUSTER_REGISTER_CLUSTER_PACKET_CREATOR(DeltaPacket);
+
+DeltaPacket::DeltaPacket()
+   : Packet(vpr::GUID())
+   , mKeyframe(false)
+   , mStateSize(0)
+   , mRunCount(0)
+   , mRunsPos(0)
+{;}
+
+DeltaPacket::DeltaPacket(const vpr::GUID& pluginId, const vpr::GUID& objectId)
+   : Packet(pluginId)
+   , mObjectId(objectId)
+   , mKeyframe(false)
+   , mStateSize(0)
+   , mRunCount(0)
+   , mRunsPos(0)
+{
+   // Create a Header for this packet with the correect type and size.
+   mHeader = Header::create(Header::RIM_PACKET,
+                            Header::RIM_DELTA_PACKET,
+                            Header::RIM_PACKET_HEAD_SIZE
+                            + 16 /*Plugin GUID*/
+                            + 16 /*Object GUID*/
+                            + 0 /* Empty now, but needs updated later. */,
+                            0/*Field not curently used*/);
+
+   // NOTE: We don't serialize here because we want to reuse the packet.
+}
+
+DeltaPacketPtr DeltaPacket::create()
+{
+   return makePtr(new DeltaPacket());
+}
+
+DeltaPacketPtr DeltaPacket::create(const vpr::GUID& pluginId,
+                                   const vpr::GUID& objectId)
+{
+   return DeltaPacketPtr(new DeltaPacket(pluginId, objectId));
+}
+
+DeltaPacket::~DeltaPacket()
+{
+}
+
+bool DeltaPacket::serialize(const std::vector<vpr::Uint8>& state,
+                            const std::vector<vpr::Uint8>* base)
+{
+   const vpr::Uint32 size(state.size());
+
+   mKeyframe  = NULL == base || base->size() != state.size();
+   mStateSize = size;
+   mRuns.clear();
+
+   if ( ! mKeyframe )
+   {
+      const vpr::Uint8* cur(size > 0 ? &state[0] : NULL);
+      const vpr::Uint8* old(size > 0 ? &(*base)[0] : NULL);
+      vpr::Uint32 encoded_size(0);
+      vpr::Uint32 i(0);
+
+      while ( i < size )
+      {
+         // Skip unchanged bytes, a word at a time where possible.
+         while ( i + 8 <= size && std::memcmp(cur + i, old + i, 8) == 0 )
+         {
+            i += 8;
+         }
+         while ( i < size && cur[i] == old[i] )
+         {
+            ++i;
+         }
+
+         if ( i == size )
+         {
+            break;
+         }
+
+         // Extend the run until at least MIN_GAP unchanged bytes follow it.
+         const vpr::Uint32 start(i);
+         vpr::Uint32 end(i + 1);
+         for ( i = end; i < size && i - end < MIN_GAP; )
+         {
+            if ( i + 8 <= size )
+            {
+               if ( std::memcmp(cur + i, old + i, 8) != 0 )
+               {
+                  for ( end = i + 8; cur[end - 1] == old[end - 1]; --end )
+                  {
+                  }
+               }
+               i += 8;
+            }
+            else
+            {
+               if ( cur[i] != old[i] )
+               {
+                  end = i + 1;
+               }
+               ++i;
+            }
+         }
+
+         mRuns.push_back(std::make_pair(start, end - start));
+         encoded_size += 8 + end - start;
+
+         if ( encoded_size >= size )
+         {
+            mKeyframe = true;
+            break;
+         }
+      }
+   }
+
+   if ( mKeyframe )
+   {
+      mRuns.clear();
+      if ( size > 0 )
+      {
+         mRuns.push_back(std::make_pair(vpr::Uint32(0), size));
+      }
+   }
+
+   mRunCount = mRuns.size();
+
+   // Clear data stream since header is at beginning
+   mPacketWriter->getData()->clear();
+   mPacketWriter->setCurPos( 0 );
+
+   mPluginId.writeObject(mPacketWriter);
+   mObjectId.writeObject(mPacketWriter);
+   mPacketWriter->writeBool(mKeyframe);
+   mPacketWriter->writeUint32(mStateSize);
+   mPacketWriter->writeUint32(mRunCount);
+
+   for ( run_list_t::const_iterator r = mRuns.begin(); r != mRuns.end(); ++r )
+   {
+      writeRun(&state[0], (*r).first, (*r).second);
+   }
+
+   // Serialize the header.
+   mHeader->prependSerializedHeader(mPacketWriter);
+
+   return mKeyframe;
+}
+
+void DeltaPacket::writeRun(const vpr::Uint8* data, const vpr::Uint32 offset,
+                           const vpr::Uint32 length)
+{
+   mPacketWriter->writeUint32(offset);
+   mPacketWriter->writeUint32(length);
+
+   // BufferObjectWriter::writeRaw() appends one byte at a time, which is
+   // far too slow for keyframes of large objects.
+   std::vector<vpr::Uint8>* buffer(mPacketWriter->getData());
+   buffer->insert(buffer->end(), data + offset, data + offset + length);
+   mPacketWriter->setCurPos(mPacketWriter->getCurPos() + length);
+}
+
+void DeltaPacket::parse()
+{
+   mPacketReader->setCurPos(0);
+
+   // De-Serialize plugin GUID
+   mPluginId.readObject(mPacketReader);
+
+   // De-Serialize object GUID
+   mObjectId.readObject(mPacketReader);
+
+   mKeyframe  = mPacketReader->readBool();
+   mStateSize = mPacketReader->readUint32();
+   mRunCount  = mPacketReader->readUint32();
+
+   // The runs are read by apply().
+   mRunsPos = mPacketReader->getCurPos();
+}
+
+void DeltaPacket::apply(std::vector<vpr::Uint8>& state)
+{
+   if ( mKeyframe )
+   {
+      state.resize(mStateSize);
+   }
+   else if ( state.size() != mStateSize )
+   {
+      throw cluster::ClusterException(
+         "DeltaPacket::apply() - Changes do not match the current state!"
+      );
+   }
+
+   mPacketReader->setCurPos(mRunsPos);
+
+   for ( vpr::Uint32 r = 0; r < mRunCount; ++r )
+   {
+      const vpr::Uint32 offset = mPacketReader->readUint32();
+      const vpr::Uint32 length = mPacketReader->readUint32();
+
+      if ( offset > mStateSize || length > mStateSize - offset ||
+           length > mPacketReader->getSize() - mPacketReader->getCurPos() )
+      {
+         throw cluster::ClusterException(
+            "DeltaPacket::apply() - Invalid change range!"
+         );
+      }
+
+      if ( length > 0 )
+      {
+         std::memcpy(&state[offset], mPacketReader->readRaw(length), length);
+      }
+   }
+}
+
+void DeltaPacket::printData(int debugLevel) const
+{
+   vprDEBUG_BEGIN(gadgetDBG_RIM,debugLevel)
+      <<  clrOutBOLD(clrYELLOW,"==== Delta Data Packet ====\n") << vprDEBUG_FLUSH;
+
+   Packet::printData(debugLevel);
+
+   vprDEBUG(gadgetDBG_RIM,debugLevel)
+      << clrOutBOLD(clrYELLOW, "Plugin ID: ") << mPluginId.toString()
+      << std::endl << vprDEBUG_FLUSH;
+   vprDEBUG(gadgetDBG_RIM,debugLevel)
+      << clrOutBOLD(clrYELLOW, "Object ID: ") << mObjectId.toString()
+      << std::endl << vprDEBUG_FLUSH;
+   vprDEBUG(gadgetDBG_RIM,debugLevel)
+      << clrOutBOLD(clrYELLOW, "Keyframe:  ") << (mKeyframe ? "yes" : "no")
+      << std::endl << vprDEBUG_FLUSH;
+   vprDEBUG(gadgetDBG_RIM,debugLevel)
+      << clrOutBOLD(clrYELLOW, "State:     ") << mStateSize << " bytes, "
+      << mRunCount << " runs" << std::endl << vprDEBUG_FLUSH;
+
+   vprDEBUG_END(gadgetDBG_RIM,debugLevel)
+      <<  clrOutBOLD(clrYELLOW,"===========================\n") << vprDEBUG_FLUSH;
+}
+
+} // end namespace cluster
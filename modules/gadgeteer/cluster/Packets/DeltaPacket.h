@@ -0,0 +1,166 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _GADGET_RIM_DELTA_PACKET_H
+#define _GADGET_RIM_DELTA_PACKET_H
+
+#include <gadget/gadgetConfig.h>
+#include <utility>
+#include <vector>
+#include <vpr/vprTypes.h>
+
+#include <cluster/Packets/Header.h>
+#include <cluster/Packets/Packet.h>
+#include <cluster/Packets/DeltaPacketPtr.h>
+
+namespace cluster
+{
+
+/** \class DeltaPacket DeltaPacket.h cluster/Packets/DeltaPacket.h
+ *
+ * Cluster packet that carries the serialized state of an object as the
+ * byte ranges that changed since the state previously sent.  A keyframe
+ * carries the whole state and replaces whatever the receiver had.
+ */
+class GADGET_API DeltaPacket
+   : public Packet
+{
+protected:
+   /**
+    * Default constructor used by the PacketFactory.
+    */
+   DeltaPacket();
+
+   /**
+    * Create a DeltaPacket to send changes to an object across the network.
+    *
+    * @param pluginId GUID of the ClusterPlugin that should handle this
+    *                 packet.
+    * @param objectId GUID of the object whose state is sent.
+    */
+   DeltaPacket(const vpr::GUID& pluginId, const vpr::GUID& objectId);
+
+public:
+   /**
+    * Creates a DeltaPacket instance and returns it wrapped in a
+    * DeltaPacketPtr object.
+    */
+   static DeltaPacketPtr create();
+
+   /**
+    * Creates a DeltaPacket instance and returns it wrapped in a
+    * DeltaPacketPtr object.
+    */
+   static DeltaPacketPtr create(const vpr::GUID& pluginId,
+                                const vpr::GUID& objectId);
+
+   /**
+    * Clean up all unused memory.
+    */
+   virtual ~DeltaPacket();
+
+   /**
+    * Serializes the parts of \p state that differ from \p base.  A keyframe
+    * holding all of \p state is serialized instead if \p base is NULL, if
+    * its size differs from that of \p state, or if the changes would not be
+    * smaller than \p state.
+    *
+    * @return true if a keyframe was serialized.
+    */
+   bool serialize(const std::vector<vpr::Uint8>& state,
+                  const std::vector<vpr::Uint8>* base);
+
+   /**
+    * Parses the data stream into the local member variables.  The changed
+    * bytes are left in the packet until apply() is called.
+    */
+   virtual void parse();
+
+   /**
+    * Writes the received bytes into \p state.  A keyframe replaces \p state.
+    *
+    * @throw cluster::ClusterException is thrown if this is not a keyframe
+    *        and \p state does not have the size of the state the changes
+    *        were computed from.  \p state is not modified in that case.
+    */
+   void apply(std::vector<vpr::Uint8>& state);
+
+   /**
+    * Print the data to the screen in a readable form.
+    */
+   virtual void printData(int debugLevel) const;
+
+   /**
+    * Return the type of this packet.
+    */
+   static vpr::Uint16 getPacketFactoryType()
+   {
+      return(Header::RIM_DELTA_PACKET);
+   }
+
+   /**
+    * Return the GUID of the object that we are sending changes for.
+    */
+   const vpr::GUID& getObjectId() const
+   {
+      return mObjectId;
+   }
+
+   /**
+    * Return true if this packet holds the complete state of the object.
+    */
+   bool isKeyframe() const
+   {
+      return mKeyframe;
+   }
+
+   /**
+    * Return the number of changed byte ranges held in this packet.
+    */
+   vpr::Uint32 getRunCount() const
+   {
+      return mRunCount;
+   }
+
+private:
+   void writeRun(const vpr::Uint8* data, const vpr::Uint32 offset,
+                 const vpr::Uint32 length);
+
+   vpr::GUID                  mObjectId;     /**< GUID of the object that we are sending changes for. */
+   bool                       mKeyframe;     /**< True if all of the state is sent. */
+   vpr::Uint32                mStateSize;    /**< Size of the complete serialized state. */
+   vpr::Uint32                mRunCount;     /**< Number of changed byte ranges. */
+   unsigned int               mRunsPos;      /**< Read position of the first range. */
+
+   /** Offset and length of each changed byte range. */
+   typedef std::vector<std::pair<vpr::Uint32, vpr::Uint32> > run_list_t;
+   run_list_t                 mRuns;
+};
+
+}// end namespace cluster
+
+
+#endif
@@ -40,7 +40,8 @@ DeviceAck::DeviceAck()
 
 DeviceAck::DeviceAck(const vpr::GUID& pluginId, const vpr::GUID& id, 
                      const std::string& deviceName, 
-                     const vpr::Uint16 deviceBaseType, const bool ack)
+                     const vpr::Uint16 deviceBaseType, const bool ack,
+                     const vpr::Uint32 channel)
    : Packet(pluginId)
    , mId(id)
    , mDeviceName(deviceName)
@@ -62,7 +63,7 @@ DeviceAck::DeviceAck(const vpr::GUID& pluginId, const vpr::GUID& id,
                             + vpr::BufferObjectReader::STRING_LENGTH_SIZE
                             + mHostname.size() /*length of mDeviceBaseType*/
                             + 1 /*mAck*/,
-                            0/*Field not curently used*/);                      
+                            channel);                      
 
    // Serialize the given data.
    serialize();
@@ -70,15 +71,17 @@ DeviceAck::DeviceAck(const vpr::GUID& pluginId, const vpr::GUID& id,
 
 DeviceAckPtr DeviceAck::create()
 {
-   return DeviceAckPtr(new DeviceAck());
+   return makePtr(new DeviceAck());
 }
 
 DeviceAckPtr DeviceAck::create(const vpr::GUID& pluginId, const vpr::GUID& id,
                                const std::string& deviceName,
                                const vpr::Uint16 deviceBaseType,
-                               const bool ack)
+                               const bool ack,
+                               const vpr::Uint32 channel)
 {
-   return DeviceAckPtr(new DeviceAck(pluginId, id, deviceName, deviceBaseType, ack));
+   return DeviceAckPtr(new DeviceAck(pluginId, id, deviceName, deviceBaseType,
+                                     ack, channel));
 }
 
 DeviceAck::~DeviceAck()
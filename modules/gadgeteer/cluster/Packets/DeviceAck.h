@@ -62,10 +62,13 @@ protected:
     *                       acknowledging.
     * @param ack            Boolean determining if this is a positive (ACK)
     *                       or a negative (NACK) responce.
+    * @param channel        Routing channel that the data packets of the
+    *                       device will carry (see
+    *                       cluster::Header::getChannel()).
     */
    DeviceAck(const vpr::GUID& pluginId, const vpr::GUID& id,
              const std::string& deviceName, const vpr::Uint16 deviceBaseType,
-             const bool ack);
+             const bool ack, const vpr::Uint32 channel);
 
 public:
    /**
@@ -85,7 +88,8 @@ public:
    static DeviceAckPtr create(const vpr::GUID& pluginId, const vpr::GUID& id,
                               const std::string& devTypeId,
                               const vpr::Uint16 deviceBaseType,
-                              const bool ack);
+                              const bool ack,
+                              const vpr::Uint32 channel = 0);
 
    virtual ~DeviceAck();
 
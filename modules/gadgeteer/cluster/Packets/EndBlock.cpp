@@ -26,6 +26,11 @@
 
 #include <gadget/gadgetConfig.h>
 
+#include <cstring>
+
+#include <vpr/System.h>
+#include <vpr/Util/Assert.h>
+
 #include <cluster/Packets/PacketFactory.h>
 #include <cluster/Packets/EndBlock.h>
 #include <boost/concept_check.hpp>
@@ -61,7 +66,7 @@ EndBlock::EndBlock(const vpr::Uint32 frameNum)
 
 EndBlockPtr EndBlock::create()
 {
-   return EndBlockPtr(new EndBlock());
+   return makePtr(new EndBlock());
 }
 
 EndBlockPtr EndBlock::create(const vpr::Uint32 frameNum)
@@ -88,6 +93,20 @@ void EndBlock::serialize()
    mHeader->prependSerializedHeader(mPacketWriter);
 }
 
+void EndBlock::setFrame(const vpr::Uint32 frameNum)
+{
+   vprASSERT(mData.size() == Header::RIM_PACKET_HEAD_SIZE + 2 &&
+             "EndBlock must be serialized before its frame is changed");
+
+   mTempVar = frameNum;
+   mHeader->setFrame(frameNum);
+   mHeader->writeSerializedHeader(&mData[0]);
+
+   const vpr::Uint16 temp_var = vpr::System::Htons(mTempVar);
+   std::memcpy(&mData[Header::RIM_PACKET_HEAD_SIZE], &temp_var,
+               sizeof(temp_var));
+}
+
 /**
  * Parses the data stream into the local member variables.
  */
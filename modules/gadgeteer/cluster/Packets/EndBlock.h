@@ -80,6 +80,14 @@ public:
     */
    void serialize();
 
+   /**
+    * Changes the frame number of an end block that has already been
+    * serialized.  Only the frame field of the header and the payload are
+    * rewritten in place, so a single end block can be sent every frame
+    * without allocating or serializing it again.
+    */
+   void setFrame(const vpr::Uint32 frameNum);
+
    /**
     * Parses the data stream into the local member variables.
     */
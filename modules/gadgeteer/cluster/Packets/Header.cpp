@@ -27,6 +27,10 @@
 #include <cluster/Packets/Header.h>
 #include <gadget/Util/Debug.h>
 
+#include <cstring>
+#include <boost/checked_delete.hpp>
+
+#include <vpr/System.h>
 #include <vpr/IO/Socket/SocketStream.h>
 
 namespace cluster
@@ -45,7 +49,8 @@ Header::Header( const vpr::Uint16 code, const vpr::Uint16 type,
 
 HeaderPtr Header::create()
 {
-   return HeaderPtr(new Header());
+   return HeaderPtr(new Header(), boost::checked_deleter<Header>(),
+                    vpr::FrameAllocator<Header>());
 }
 
 HeaderPtr Header::create(const vpr::Uint16 code, const vpr::Uint16 type,
@@ -72,10 +77,10 @@ void Header::readData(vpr::SocketStream* stream, bool dumpHeader)
    }
 
    vpr::Uint32 bytes_read;   
-   std::vector<vpr::Uint8> header_data; 
+   vpr::Uint8 header_data[RIM_PACKET_HEAD_SIZE];
    try
    {
-      bytes_read = stream->readn(header_data, Header::RIM_PACKET_HEAD_SIZE);
+      bytes_read = stream->readn(header_data, RIM_PACKET_HEAD_SIZE);
    }
    catch (vpr::IOException& ex)
    {
@@ -92,48 +97,74 @@ void Header::readData(vpr::SocketStream* stream, bool dumpHeader)
 
    if(dumpHeader)
    {
-      std::cout << "Dumping Header(" << header_data.size() << " bytes): ";
-      for ( std::vector<vpr::Uint8>::const_iterator i = header_data.begin();
-            i != header_data.end(); i++ )
+      std::cout << "Dumping Header(" << RIM_PACKET_HEAD_SIZE << " bytes): ";
+      for ( unsigned int i = 0; i < RIM_PACKET_HEAD_SIZE; ++i )
       {
-         std::cout << (int)*i << " ";
+         std::cout << (int)header_data[i] << " ";
       }
       std::cout << std::endl;
    }
 }
 
+void Header::readData(std::vector<vpr::Uint8>& headerData)
+{
+   if ( RIM_PACKET_HEAD_SIZE != headerData.size() )
+   {
+      throw cluster::ClusterException("Header::readData() - Wrong header size!");
+   }
+
+   parseHeader(&headerData[0]);
+}
+
+void Header::readData(const vpr::Uint8* headerData)
+{
+   parseHeader(headerData);
+}
+
 void Header::prependSerializedHeader(vpr::BufferObjectWriter* packetWriter)
 {
    // Set Packet length
    setPacketLength( packetWriter->getData()->size() + RIM_PACKET_HEAD_SIZE );
 
-   std::vector<vpr::Uint8> header_data;
-   vpr::BufferObjectWriter writer( &header_data );
-
-   // Serialize all header data.
-   writer.writeUint16( mRIMCode );
-   writer.writeUint16( mPacketType );
-   writer.writeUint32( mFrame );
-   writer.writeUint32( mPacketLength );
-
-   // Prepend header onto packets data
-   packetWriter->getData()->insert( packetWriter->getData()->begin(),
-                                   header_data.begin(),
-                                   header_data.end() );
+   // Open a gap at the front of the packet data and fill it in place.  Once
+   // a reused packet's buffer has reached its working size, this does not
+   // allocate.
+   std::vector<vpr::Uint8>* data = packetWriter->getData();
+   data->insert(data->begin(), RIM_PACKET_HEAD_SIZE, 0);
+   writeSerializedHeader(&(*data)[0]);
 
    packetWriter->setCurPos( getPacketLength() );
-
 }
 
-void Header::parseHeader(std::vector<vpr::Uint8>& headerData)
+void Header::writeSerializedHeader(vpr::Uint8* dest) const
 {
-   vpr::BufferObjectReader reader( &headerData );
+   const vpr::Uint16 code   = vpr::System::Htons(mRIMCode);
+   const vpr::Uint16 type   = vpr::System::Htons(mPacketType);
+   const vpr::Uint32 frame  = vpr::System::Htonl(mFrame);
+   const vpr::Uint32 length = vpr::System::Htonl(mPacketLength);
+
+   // Same layout as parseHeader() reads.
+   std::memcpy(dest,     &code,   sizeof(code));
+   std::memcpy(dest + 2, &type,   sizeof(type));
+   std::memcpy(dest + 4, &frame,  sizeof(frame));
+   std::memcpy(dest + 8, &length, sizeof(length));
+}
 
-   // Parse the incoming data.
-   mRIMCode = reader.readUint16();
-   mPacketType = reader.readUint16();
-   mFrame = reader.readUint32();
-   mPacketLength = reader.readUint32();
+void Header::parseHeader(const vpr::Uint8* headerData)
+{
+   vpr::Uint16 code, type;
+   vpr::Uint32 frame, length;
+
+   // Same layout as writeSerializedHeader() writes.
+   std::memcpy(&code,   headerData,     sizeof(code));
+   std::memcpy(&type,   headerData + 2, sizeof(type));
+   std::memcpy(&frame,  headerData + 4, sizeof(frame));
+   std::memcpy(&length, headerData + 8, sizeof(length));
+
+   mRIMCode      = vpr::System::Ntohs(code);
+   mPacketType   = vpr::System::Ntohs(type);
+   mFrame        = vpr::System::Ntohl(frame);
+   mPacketLength = vpr::System::Ntohl(length);
 
    if ( RIM_PACKET != mRIMCode )
    {
@@ -29,9 +29,12 @@
 
 #include <gadget/gadgetConfig.h>
 
+#include <cstddef>
+#include <vector>
 #include <boost/noncopyable.hpp>
 
 #include <vpr/vprTypes.h>
+#include <vpr/Util/FrameArena.h>
 #include <vpr/IO/BufferObjectReader.h>
 #include <vpr/IO/BufferObjectWriter.h>
 #include <vpr/IO/Socket/SocketStream.h>
@@ -63,6 +66,7 @@ public:
    static const unsigned short RIM_END_BLOCK       = 410;
    static const unsigned short RIM_START_BLOCK     = 411;
    static const unsigned short CONFIG_PACKET       = 412;
+   static const unsigned short RIM_DELTA_PACKET    = 413;
    static const unsigned short RIM_PACKET_HEAD_SIZE = 12;
 
 protected:
@@ -77,7 +81,9 @@ protected:
 
 public:
    /**
-    * Factory method that returns an empty header.
+    * Factory method that returns an empty header.  Inside a
+    * vpr::FrameArena::Scope, the header and its reference count come from
+    * the frame arena of the calling thread.
     */
    static HeaderPtr create();
 
@@ -87,7 +93,8 @@ public:
     * @param code Packet code
     * @param type The type of the packet.
     * @param length Size of data for entire packet.
-    * @param frame The frame number the packet was sent. NOTE: Not currently used.
+    * @param frame The frame number of an end block, or the routing channel
+    *              of any other packet (see getChannel()).
     */
    static HeaderPtr create(const vpr::Uint16 code, const vpr::Uint16 type,
                            const vpr::Uint32 length, const vpr::Uint32 frame);
@@ -95,6 +102,17 @@ public:
    virtual ~Header()
    {;}
 
+   /** Headers are allocated through vpr::FrameArena. */
+   static void* operator new(std::size_t size)
+   {
+      return vpr::FrameArena::allocate(size);
+   }
+
+   static void operator delete(void* p)
+   {
+      vpr::FrameArena::deallocate(p);
+   }
+
    /**
     * Reads the packet header from the given socket.
     *
@@ -112,11 +130,40 @@ public:
     */
    void readData(vpr::SocketStream* stream, bool dumpHeader=false);
 
+   /**
+    * Parses a packet header that has already been received by some other
+    * means than a socket.
+    *
+    * @param headerData The \c RIM_PACKET_HEAD_SIZE bytes of the header.
+    *
+    * @throw cluster::ClusterException is thrown if \p headerData is not a
+    *        valid packet header.
+    */
+   void readData(std::vector<vpr::Uint8>& headerData);
+
+   /**
+    * Parses the \c RIM_PACKET_HEAD_SIZE bytes of a packet header stored at
+    * \p headerData.
+    *
+    * @throw cluster::ClusterException is thrown if \p headerData is not a
+    *        valid packet header.
+    */
+   void readData(const vpr::Uint8* headerData);
+
    /**
     * @since 1.3.19
     */
    void prependSerializedHeader(vpr::BufferObjectWriter* writer);
 
+   /**
+    * Writes the \c RIM_PACKET_HEAD_SIZE bytes of this header, in network
+    * byte order, to the given location.  This is used to patch the header
+    * of a packet that has already been serialized.
+    *
+    * @pre \p dest points to at least \c RIM_PACKET_HEAD_SIZE bytes.
+    */
+   void writeSerializedHeader(vpr::Uint8* dest) const;
+
    vpr::Uint16 getRIMCode() const
    {
       return mRIMCode;
@@ -142,9 +189,51 @@ public:
       return mFrame;
    }
 
+   void setFrame(const vpr::Uint32 frame)
+   {
+      mFrame = frame;
+   }
+
+   /**
+    * Returns the routing channel of this packet.  Packets other than end
+    * blocks carry it in the frame field.  The upper 16 bits number the
+    * packet handler and the lower 16 bits an object within that handler,
+    * both as assigned by the sender.  A half that is 0 is unassigned, and
+    * the receiver has to route by GUID instead.  Older senders always leave
+    * the field at 0.
+    */
+   vpr::Uint32 getChannel() const
+   {
+      return mFrame;
+   }
+
+   void setChannel(const vpr::Uint32 channel)
+   {
+      mFrame = channel;
+   }
+
+   /** @name Channel encoding */
+   //@{
+   static vpr::Uint32 makeChannel(const vpr::Uint16 handlerChannel,
+                                  const vpr::Uint16 objectChannel)
+   {
+      return (static_cast<vpr::Uint32>(handlerChannel) << 16) | objectChannel;
+   }
+
+   static vpr::Uint16 getHandlerChannel(const vpr::Uint32 channel)
+   {
+      return static_cast<vpr::Uint16>(channel >> 16);
+   }
+
+   static vpr::Uint16 getObjectChannel(const vpr::Uint32 channel)
+   {
+      return static_cast<vpr::Uint16>(channel & 0xFFFF);
+   }
+   //@}
+
    void printData( const int debug_level ) const;
 protected:
-   void parseHeader(std::vector<vpr::Uint8>& headerData);
+   void parseHeader(const vpr::Uint8* headerData);
 
    vpr::Uint16 mRIMCode;
    vpr::Uint16 mPacketType;
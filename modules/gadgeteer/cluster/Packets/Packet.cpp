@@ -38,24 +38,26 @@ namespace cluster
 {
 
 Packet::Packet(const vpr::GUID& pluginId)
-   : mPluginId(pluginId)
+   : mPacketReader(&mReader)
+   , mPacketWriter(&mWriter)
+   , mPluginId(pluginId)
+   , mReader(&mData)
+   , mWriter(&mData)
 {
    //mData = new std::vector<vpr::Uint8>(RIM_PACKET_HEAD_SIZE);
-   mPacketReader = new vpr::BufferObjectReader(&mData);
-   mPacketWriter= new vpr::BufferObjectWriter(&mData);
 }
-Packet::Packet(std::vector<vpr::Uint8>* data) : mPluginId()
+Packet::Packet(std::vector<vpr::Uint8>* data)
+   : mPacketReader(&mReader)
+   , mPacketWriter(&mWriter)
+   , mData(*data)
+   , mPluginId()
+   , mReader(&mData)
+   , mWriter(&mData)
 {
-   // Copy data.
-   mData = *(data);
-   mPacketReader = new vpr::BufferObjectReader(&mData);
-   mPacketWriter= new vpr::BufferObjectWriter(&mData);
 }
 
 Packet::~Packet()
 {
-   delete mPacketReader;
-   delete mPacketWriter;
    //delete mData;
 }
 
@@ -75,6 +77,11 @@ vpr::Uint16 Packet::getPacketType() const
    return mHeader->getPacketType();
 }
 
+vpr::Uint32 Packet::getChannel() const
+{
+   return mHeader->getChannel();
+}
+
 void Packet::printData(int debugLevel) const
 {
    if (NULL != mHeader.get())
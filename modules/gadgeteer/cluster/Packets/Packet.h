@@ -29,8 +29,12 @@
 
 #include <gadget/gadgetConfig.h>
 
+#include <cstddef>
 #include <boost/noncopyable.hpp>
+#include <boost/checked_delete.hpp>
+#include <boost/shared_ptr.hpp>
 #include <vpr/vprTypes.h>
+#include <vpr/Util/FrameArena.h>
 #include <vpr/Util/GUID.h>
 
 #include <vpr/IO/BufferObjectReader.h>
@@ -68,6 +72,22 @@ public:
     */
    virtual ~Packet();
 
+   /**
+    * Packets are allocated through vpr::FrameArena, so the packets that
+    * gadget::Node creates for received data come from the frame arena of
+    * the receiving thread.  Packets created anywhere else come from the
+    * heap.
+    */
+   static void* operator new(std::size_t size)
+   {
+      return vpr::FrameArena::allocate(size);
+   }
+
+   static void operator delete(void* p)
+   {
+      vpr::FrameArena::deallocate(p);
+   }
+
    /**
     * Dump all internal data to the screen.
     */
@@ -115,6 +135,13 @@ public:
       return mHeader;
    }
 
+   /**
+    * Get the routing channel from the header of this packet.
+    *
+    * @see cluster::Header::getChannel()
+    */
+   vpr::Uint32 getChannel() const;
+
    /**
     * Get a std::vector containing all internal data.
     */
@@ -130,11 +157,30 @@ public:
 
    virtual void parse() = 0;
 protected:
+   /**
+    * Wraps a newly created packet in a shared pointer whose reference count
+    * is allocated the same way as the packet.  The default create() of each
+    * packet type, which cluster::PacketFactory calls for received packets,
+    * uses this.
+    */
+   template<typename PacketType>
+   static boost::shared_ptr<PacketType> makePtr(PacketType* packet)
+   {
+      return boost::shared_ptr<PacketType>(
+         packet, boost::checked_deleter<PacketType>(),
+         vpr::FrameAllocator<PacketType>()
+      );
+   }
+
    HeaderPtr mHeader;                        /**< Header used to specify the type/size of this packet.*/
    vpr::BufferObjectReader* mPacketReader;   /**< ObjectReader that is used to parse all data. */
    vpr::BufferObjectWriter* mPacketWriter;   /**< ObjectWriter that is used to serialize all data. */
    std::vector<vpr::Uint8> mData;            /**< std::vector which contains all internal data */
    vpr::GUID mPluginId;                      /**< GUID that specifies which plugin is responsible for this packet */
+
+private:
+   vpr::BufferObjectReader mReader;          /**< Storage for mPacketReader */
+   vpr::BufferObjectWriter mWriter;          /**< Storage for mPacketWriter */
 };
 }
 
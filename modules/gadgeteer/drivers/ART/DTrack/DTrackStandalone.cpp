@@ -57,10 +57,27 @@
 #define DTRACK_CMD_STOP_DATA            12
 #define DTRACK_CMD_SEND_N_DATA          13
 
+// DTrack line identifiers:
+
+#define DTRACK_LINE_UNKNOWN    0
+#define DTRACK_LINE_FR         1
+#define DTRACK_LINE_TS         2
+#define DTRACK_LINE_6DCAL      3
+#define DTRACK_LINE_6D         4
+#define DTRACK_LINE_6DI        5
+#define DTRACK_LINE_6DF        6
+#define DTRACK_LINE_6DF2       7
+#define DTRACK_LINE_6DMT       8
+#define DTRACK_LINE_6DMT2      9
+#define DTRACK_LINE_GLCAL     10
+#define DTRACK_LINE_GL        11
+#define DTRACK_LINE_3D        12
+
 
 // Local prototypes:
 
 static char* string_nextline(char* str, char* start, int len);
+static int string_get_lineid(char** str);
 static char* string_get_i(char* str, int* i);
 static char* string_get_ui(char* str, unsigned int* ui);
 static char* string_get_d(char* str, double* d);
@@ -204,6 +221,16 @@ bool DTrackStandalone::valid(void)
 }
 
 
+// Get the handle of the UDP socket:
+//
+// return value (o): socket handle
+
+vpr::IOSys::Handle DTrackStandalone::get_handle(void)
+{
+	return d_udpsock->getHandle();
+}
+
+
 // Check last receive/send error:
 //
 // return value (o): boolean
@@ -255,13 +282,6 @@ bool DTrackStandalone::receive(void)
 {
 	vpr::Uint32 len;
 	vpr::InetAddr addr;
-	
-	char* s;
-	int i, j, k, l, n, id;
-	char sfmt[20];
-	int iarr[3];
-	float f, farr[6];
-	int loc_num_bodycal, loc_num_handcal, loc_num_flystick1, loc_num_meatool;
 
 	if(!valid()){
 		return false;
@@ -272,9 +292,6 @@ bool DTrackStandalone::receive(void)
 	act_framecounter = 0;
 	act_timestamp = -1;   // i.e. not available
 	
-	loc_num_bodycal = loc_num_handcal = -1;  // i.e. not available
-	loc_num_flystick1 = loc_num_meatool = 0;
-	
 	// receive UDP packet:
 
 	do{
@@ -301,6 +318,62 @@ bool DTrackStandalone::receive(void)
 		}
 	}while(d_udpsock->availableBytes() > 0);
 
+	return parse((int )len);
+}
+
+
+// Process one DTrack data packet that was obtained by other means:
+//
+// data (i): packet contents (ASCII protocol)
+// len (i): packet length in bytes
+//
+// return value (o): processing was successfull
+
+bool DTrackStandalone::process(const char* data, int len)
+{
+
+	if(!valid()){
+		return false;
+	}
+
+	// defaults:
+	
+	act_framecounter = 0;
+	act_timestamp = -1;   // i.e. not available
+
+	if(len < 0 || len > d_udpbufsize - 1){
+		set_parseerror();
+		return false;
+	}
+
+	memcpy(d_udpbuf, data, len);
+
+	return parse(len);
+}
+
+
+// Process the DTrack data packet in the UDP buffer:
+//  - the packet is parsed in place in one pass; lines are dispatched on their identifier
+//    and numbers are converted directly into the preallocated data arrays
+//
+// len (i): packet length in bytes
+//
+// return value (o): parsing was successfull
+
+bool DTrackStandalone::parse(int len)
+{
+	char* s;
+	int i, j, k, l, n, id;
+	char sfmt[20];
+	int iarr[3];
+	float f, farr[6];
+	int loc_num_bodycal, loc_num_handcal, loc_num_flystick1, loc_num_meatool;
+
+	// defaults:
+	
+	loc_num_bodycal = loc_num_handcal = -1;  // i.e. not available
+	loc_num_flystick1 = loc_num_meatool = 0;
+	
 	s = d_udpbuf;
 	s[len] = '\0';
 
@@ -309,49 +382,40 @@ bool DTrackStandalone::receive(void)
 	set_parseerror();
 
 	do{
+		switch(string_get_lineid(&s)){
+
 		// line for frame counter:
 
-		if(!strncmp(s, "fr ", 3)){
-			s += 3;
-			
+		case DTRACK_LINE_FR:
 			if(!(s = string_get_ui(s, &act_framecounter))){  // get frame counter
 				act_framecounter = 0;
 				return false;
 			}
 
-			continue;
-		}
+			break;
 
 		// line for timestamp:
 
-		if(!strncmp(s, "ts ", 3)){
-			s += 3;
-			
+		case DTRACK_LINE_TS:
 			if(!(s = string_get_d(s, &act_timestamp))){   // get timestamp
 				act_timestamp = -1;
 				return false;
 			}
 
-			continue;
-		}
+			break;
 		
 		// line for additional information about number of calibrated bodies:
 
-		if(!strncmp(s, "6dcal ", 6)){
-			s += 6;
-			
+		case DTRACK_LINE_6DCAL:
 			if(!(s = string_get_i(s, &loc_num_bodycal))){  // get number of calibrated bodies
 				return false;
 			}
 
-			continue;
-		}
+			break;
 
 		// line for standard body data:
 
-		if(!strncmp(s, "6d ", 3)){
-			s += 3;
-			
+		case DTRACK_LINE_6D:
 			for(i=0; i<act_num_body; i++){  // disable all existing data
 				memset(&act_body[i], 0, sizeof(dtrack_body_type));
 				act_body[i].id = i;
@@ -391,14 +455,11 @@ bool DTrackStandalone::receive(void)
 				}
 			}
 			
-			continue;
-		}
+			break;
 		
 		// line of 6di inertial data:
 		
-		if (!strncmp(s, "6di ", 4))	{
-			s += 4;
-			
+		case DTRACK_LINE_6DI:
 			// disable all existing data
 			for (i=0; i<act_num_body; i++) {
 				memset(&act_body[i], 0, sizeof(dtrack_body_type));
@@ -438,14 +499,11 @@ bool DTrackStandalone::receive(void)
 				}
 			}
 			
-			continue;
-		}
+			break;
 		
 		// line for Flystick data (older format):
 
-		if(!strncmp(s, "6df ", 4)){
-			s += 4;
-			
+		case DTRACK_LINE_6DF:
 			if(!(s = string_get_i(s, &n))){               // get number of calibrated Flysticks
 				return false;
 			}
@@ -502,14 +560,11 @@ bool DTrackStandalone::receive(void)
 				}
 			}
 			
-			continue;
-		}
+			break;
 		
 		// line for Flystick data (newer format):
 
-		if(!strncmp(s, "6df2 ", 5)){
-			s += 5;
-			
+		case DTRACK_LINE_6DF2:
 			if(!(s = string_get_i(s, &n))){               // get number of calibrated Flysticks
 				return false;
 			}
@@ -582,14 +637,11 @@ bool DTrackStandalone::receive(void)
 				}
 			}
 			
-			continue;
-		}
+			break;
 
 		// line for measurement tool data (old format):
 
-		if(!strncmp(s, "6dmt ", 5)){
-			s += 5;
-			
+		case DTRACK_LINE_6DMT:
 			// get number of calibrated measurement tools
 			if (!(s = string_get_i(s, &n))) {
 				return false;
@@ -635,14 +687,11 @@ bool DTrackStandalone::receive(void)
 					act_meatool[i].cov[j] = 0.0;
 			}
 			
-			continue;
-		}
+			break;
 		
 		// line for measurement tool data (new format):
 
-		if(!strncmp(s, "6dmt2 ", 6)){
-			s += 6;
-			
+		case DTRACK_LINE_6DMT2:
 			// get number of calibrated measurement tools
 			if (!(s = string_get_i(s, &n))) {
 				return false;
@@ -706,26 +755,20 @@ bool DTrackStandalone::receive(void)
 				}
 			}
 			
-			continue;
-		}
+			break;
 		
 		// line for additional information about number of calibrated Fingertracking hands:
 
-		if(!strncmp(s, "glcal ", 6)){
-			s += 6;
-			
+		case DTRACK_LINE_GLCAL:
 			if(!(s = string_get_i(s, &loc_num_handcal))){  // get number of calibrated hands
 				return false;
 			}
 			
-			continue;
-		}
+			break;
 
 		// line for A.R.T. Fingertracking hand data:
 
-		if(!strncmp(s, "gl ", 3)){
-			s += 3;
-			
+		case DTRACK_LINE_GL:
 			for(i=0; i<act_num_hand; i++){  // disable all existing data
 				memset(&act_hand[i], 0, sizeof(dtrack_hand_type));
 				act_hand[i].id = i;
@@ -794,14 +837,11 @@ bool DTrackStandalone::receive(void)
 				}
 			}
 			
-			continue;
-		}
+			break;
 		
 		// line for single marker data:
 
-		if(!strncmp(s, "3d ", 3)){
-			s += 3;
-			
+		case DTRACK_LINE_3D:
 			if(!(s = string_get_i(s, &act_num_marker))){  // get number of markers
 				act_num_marker = 0;
 				return false;
@@ -821,11 +861,13 @@ bool DTrackStandalone::receive(void)
 				}
 			}
 			
-			continue;
-		}
+			break;
 
 		// ignore unknown line identifiers (could be valid in future DTracks)
-		
+
+		default:
+			break;
+		}
 	}while((s = string_nextline(d_udpbuf, s, d_udpbufsize)));
 
 	// set number of calibrated standard bodies, if necessary:
@@ -1197,43 +1239,257 @@ static char* string_nextline(char* str, char* start, int len)
 }
 
 
+// Line identifiers known to the parser, most frequent first:
+//  - each identifier includes the blank that separates it from the data
+
+static const struct{
+	const char* name;  // identifier
+	int len;           // length of identifier
+	int id;            // line identifier code
+} dtrack_lineids[] = {
+	{ "6d ",    3, DTRACK_LINE_6D },
+	{ "3d ",    3, DTRACK_LINE_3D },
+	{ "fr ",    3, DTRACK_LINE_FR },
+	{ "ts ",    3, DTRACK_LINE_TS },
+	{ "6dcal ", 6, DTRACK_LINE_6DCAL },
+	{ "6df2 ",  5, DTRACK_LINE_6DF2 },
+	{ "6di ",   4, DTRACK_LINE_6DI },
+	{ "6dmt2 ", 6, DTRACK_LINE_6DMT2 },
+	{ "gl ",    3, DTRACK_LINE_GL },
+	{ "glcal ", 6, DTRACK_LINE_GLCAL },
+	{ "6df ",   4, DTRACK_LINE_6DF },
+	{ "6dmt ",  5, DTRACK_LINE_6DMT }
+};
+
+#define DTRACK_NUM_LINEIDS  (int )(sizeof(dtrack_lineids) / sizeof(dtrack_lineids[0]))
+
+
+// Identify the line starting at a string position:
+// str (i/o): begin of line; moved behind the line identifier if it is known
+// return value (o): line identifier code (DTRACK_LINE_UNKNOWN if the line is not known)
+
+static int string_get_lineid(char** str)
+{
+	char* s = *str;
+	int i;
+
+	for(i=0; i<DTRACK_NUM_LINEIDS; i++){
+		if(s[0] == dtrack_lineids[i].name[0] && s[1] == dtrack_lineids[i].name[1] &&
+		   !strncmp(s, dtrack_lineids[i].name, dtrack_lineids[i].len))
+		{
+			*str = s + dtrack_lineids[i].len;
+			return dtrack_lineids[i].id;
+		}
+	}
+
+	return DTRACK_LINE_UNKNOWN;
+}
+
+
+// Character classes as used by strtol() and strtod() in the "C" locale:
+
+static inline bool string_isspace(char c)
+{
+	return (c == ' ' || (c >= '\t' && c <= '\r'));
+}
+
+static inline bool string_isdigit(char c)
+{
+	return ((unsigned char )(c - '0') < 10);
+}
+
+
+// Powers of ten that are exactly representable as 'double':
+
+static const double string_pow10[] = {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
 // Read next 'int' value from string:
+//  - plain decimal numbers are converted inline; anything else (hexadecimal, octal, numbers that
+//    might overflow) is left to strtol(), so the result is always the same as strtol()'s
 // str (i): string
 // i (o): read value
 // return value (o): pointer behind read value in str; NULL in case of error
 
 static char* string_get_i(char* str, int* i)
 {
-	char* s;
-	
+	char* s = str;
+	unsigned int val = 0;
+	int n = 0;
+	bool neg = false;
+
+	while(string_isspace(*s)){
+		s++;
+	}
+
+	if(*s == '-' || *s == '+'){
+		neg = (*s++ == '-');
+	}
+
+	if(*s != '0' || !(s[1] == 'x' || s[1] == 'X' || string_isdigit(s[1]))){  // decimal
+		while(n < 10 && string_isdigit(s[n])){
+			val = val * 10 + (s[n] - '0');
+			n++;
+		}
+
+		if(n < 10){  // no overflow possible
+			*i = neg ? -(int )val : (int )val;
+			return n ? s + n : NULL;
+		}
+	}
+
 	*i = (int )strtol(str, &s, 0);
 	return (s == str) ? NULL : s;
 }
 
 
 // Read next 'unsigned int' value from string:
+//  - same as string_get_i(), but for strtoul()
 // str (i): string
 // ui (o): read value
 // return value (o): pointer behind read value in str; NULL in case of error
 
 static char* string_get_ui(char* str, unsigned int* ui)
 {
-	char* s;
-	
+	char* s = str;
+	unsigned int val = 0;
+	int n = 0;
+
+	while(string_isspace(*s)){
+		s++;
+	}
+
+	if(*s == '+'){
+		s++;
+	}
+
+	if(*s != '-' && (*s != '0' || !(s[1] == 'x' || s[1] == 'X' || string_isdigit(s[1])))){  // decimal
+		while(n < 10 && string_isdigit(s[n])){
+			val = val * 10 + (s[n] - '0');
+			n++;
+		}
+
+		if(n < 10){  // no overflow possible
+			*ui = val;
+			return n ? s + n : NULL;
+		}
+	}
+
 	*ui = (unsigned int )strtoul(str, &s, 0);
 	return (s == str) ? NULL : s;
 }
 
 
 // Read next 'double' value from string:
+//  - decimal numbers with up to 19 significant digits and a resulting decimal exponent of at most
+//    +-22 (i.e. everything DTrack sends) are converted inline: both the digits and the power of ten
+//    are exact as 'double', so one multiplication or division gives the correctly rounded result,
+//    the same strtod() returns
+//  - anything else ('inf', 'nan', hexadecimal, very long numbers) is left to strtod()
+//  - note that DTrack always uses '.' as decimal point, independent of the locale
 // str (i): string
 // d (o): read value
 // return value (o): pointer behind read value in str; NULL in case of error
 
 static char* string_get_d(char* str, double* d)
 {
-	char* s;
-	
+	char* s = str;
+	vpr::Uint64 mant = 0;  // significant digits
+	int ndig = 0;          // number of significant digits
+	int nread = 0;         // number of digits read
+	int exp10 = 0;         // decimal exponent
+	bool neg = false;
+
+	while(string_isspace(*s)){
+		s++;
+	}
+
+	if(*s == '-' || *s == '+'){
+		neg = (*s++ == '-');
+	}
+
+	if(*s == '0' && (s[1] == 'x' || s[1] == 'X')){  // hexadecimal
+		ndig = -1;
+	}
+
+	while(ndig >= 0 && *s == '0'){  // leading zeros of integer part
+		s++;
+		nread++;
+	}
+
+	while(ndig >= 0 && string_isdigit(*s)){  // integer part
+		if(ndig == 19){
+			ndig = -1;
+			break;
+		}
+
+		mant = mant * 10 + (*s++ - '0');
+		ndig++;
+		nread++;
+	}
+
+	if(ndig >= 0 && *s == '.'){
+		s++;
+
+		if(ndig == 0){  // leading zeros of fractional part
+			while(*s == '0'){
+				s++;
+				nread++;
+				exp10--;
+			}
+		}
+
+		while(string_isdigit(*s)){  // fractional part
+			if(ndig == 19){
+				ndig = -1;
+				break;
+			}
+
+			mant = mant * 10 + (*s++ - '0');
+			ndig++;
+			nread++;
+			exp10--;
+		}
+	}
+
+	if(ndig >= 0 && nread > 0 && (*s == 'e' || *s == 'E')){  // exponent (only if digits follow)
+		char* se = s + 1;
+		int e = 0;
+		bool eneg = false;
+
+		if(*se == '-' || *se == '+'){
+			eneg = (*se++ == '-');
+		}
+
+		if(string_isdigit(*se)){
+			while(string_isdigit(*se)){
+				if(e < 1000){
+					e = e * 10 + (*se - '0');
+				}
+				se++;
+			}
+
+			exp10 += eneg ? -e : e;
+			s = se;
+		}
+	}
+
+	if(ndig >= 0 && nread > 0 && mant <= ((vpr::Uint64 )1 << 53) && exp10 >= -22 && exp10 <= 22){
+		double val = (double )mant;
+
+		if(exp10 < 0){
+			val /= string_pow10[-exp10];
+		}else{
+			val *= string_pow10[exp10];
+		}
+
+		*d = neg ? -val : val;
+		return s;
+	}
+
 	*d = strtod(str, &s);
 	return (s == str) ? NULL : s;
 }
@@ -1246,14 +1502,17 @@ static char* string_get_d(char* str, double* d)
 
 static char* string_get_f(char* str, float* f)
 {
+	double d;
 	char* s;
 	
-	*f = (float )strtod(str, &s);   // strtof() only available in GNU-C
-	return (s == str) ? NULL : s;
+	s = string_get_d(str, &d);   // strtof() only available in GNU-C
+	*f = (float )d;
+	return s;
 }
 
 
 // Process next block '[...]' in string:
+//  - the values are read in place; none of the number conversions reads beyond the closing ']'
 // str (i): string
 // fmt (i): format string ('i' for 'int', 'f' for 'float')
 // idat (o): array for 'int' values (long enough due to fmt)
@@ -1272,8 +1531,7 @@ static char* string_get_block(char* str, const char* fmt, int* idat, float* fdat
 		return NULL;
 	}
 	
-	str++;                               // remove delimiters
-	*strend = '\0';
+	str++;                               // skip delimiter
 
 	index_i = index_f = 0;
 
@@ -1281,27 +1539,23 @@ static char* string_get_block(char* str, const char* fmt, int* idat, float* fdat
 		switch(*fmt++){
 			case 'i':
 				if(!(str = string_get_i(str, &idat[index_i++]))){
-					*strend = ']';
 					return NULL;
 				}
 				break;
 				
 			case 'f':
 				if(!(str = string_get_f(str, &fdat[index_f++]))){
-					*strend = ']';
 					return NULL;
 				}
 				break;
 				
 			default:    // unknown format character
-				*strend = ']';
 				return NULL;
 		}
 	}
 
 	// ignore additional data inside the block
 	
-	*strend = ']';
 	return strend + 1;
 }
 
@@ -156,6 +156,12 @@ public:
 
 	bool valid(void);
 
+// Get the handle of the UDP socket, e.g. to wait for data with vpr::Selector:
+//
+// return value (o): socket handle
+
+	vpr::IOSys::Handle get_handle(void);
+
 
 // Check last receive/send error:
 //
@@ -172,6 +178,15 @@ public:
 
 	bool receive(void);
 
+// Process one DTrack data packet that was obtained by other means (e.g. replayed from a recording):
+//
+// data (i): packet contents (ASCII protocol)
+// len (i): packet length in bytes
+//
+// return value (o): processing was successfull
+
+	bool process(const char* data, int len);
+
 // Get data of last received DTrack data packet:
 //  - currently not tracked bodies are getting a quality of -1
 
@@ -248,6 +263,8 @@ private:
 	void set_udperror(void);        // set last receive/send error to 'udp error'
 	void set_parseerror(void);      // set last receive/send error to 'parse error'
 	
+	bool parse(int len);            // process the packet of 'len' bytes in the UDP buffer
+	
 	bool cmd_send(int cmd, int val = 0);  // send remote control command
 };
 
@@ -29,11 +29,13 @@
 #include <boost/bind.hpp>
 
 #include <gadget/Type/DeviceConstructor.h>
+#include <gadget/Util/IOReactor.h>
 #include <gadget/gadgetParam.h>
 
 #include <jccl/Config/ConfigElement.h>
 
 #include <vpr/Util/Debug.h>
+#include <vpr/Util/Exception.h>
 
 #include "DTrackWrapper.h"
 
@@ -65,8 +67,7 @@ namespace gadget
 // Constructor
 DTrackWrapper::DTrackWrapper()
 {
-	thrRunning = false;
-	thrThread = NULL;	
+	is_sampling = false;
 	standalone = NULL;
 	receive_port = 5000;
 	use_commands = false;
@@ -77,7 +78,7 @@ DTrackWrapper::DTrackWrapper()
 // Destructor
 DTrackWrapper::~DTrackWrapper()
 {
-	if ( thrRunning )
+	if ( is_sampling )
 	{
 		this->stopSampling();
 	}
@@ -136,7 +137,7 @@ bool DTrackWrapper::config( jccl::ConfigElementPtr e )
 // return value (o): start was successfull
 bool DTrackWrapper::startSampling()
 {
-	if ( thrRunning )
+	if ( is_sampling )
 		return false;
 	
 	// initialize standalone driver:
@@ -164,13 +165,27 @@ bool DTrackWrapper::startSampling()
 		standalone->cmd_cameras( true );
 	}
 	
-	// start sample thread:
-	thrRunning = true;
-	thrThread = new vpr::Thread( boost::bind( &DTrackWrapper::thrFunction, this ) );
+	// wait for data in the shared I/O thread instead of a thread of our own:
+	is_sampling = true;
 	
-	if ( !thrThread->valid() )
+	try
 	{
-		thrRunning = false;	
+		IOReactor::instance()->registerHandle( standalone->get_handle(),
+		                                       boost::bind( &DTrackWrapper::handle_data, this, _1 ) );
+	}
+	catch ( vpr::Exception& ex )
+	{
+		vprDEBUG( vprDBG_ALL, vprDBG_CRITICAL_LVL )
+		        << "[DTrackWrapper] Failed to start I/O thread: " << ex.what()
+		        << std::endl << vprDEBUG_FLUSH;
+		
+		is_sampling = false;
+		
+		if ( use_commands )
+			standalone->cmd_cameras( false );
+		
+		delete standalone;
+		standalone = NULL;
 		return false;  // thread creation failed
 	}
 	
@@ -183,19 +198,12 @@ bool DTrackWrapper::startSampling()
 // return value (o): stop was successfull
 bool DTrackWrapper::stopSampling()
 {
-	if ( !thrRunning )
+	if ( !is_sampling )
 		return false;
 	
-	// stop sample thread:
-	thrRunning = false;
-	if ( thrThread != NULL )
-	{
-		//thrThread->kill();  // Not guaranteed to work on all platforms
-		thrThread->join();
-		
-		delete thrThread;
-		thrThread = NULL;
-	}
+	// stop receiving data (no callback is running once this returns):
+	IOReactor::instance()->unregisterHandle( standalone->get_handle() );
+	is_sampling = false;
 	
 	// stop DTrack (if necessary):
 	
@@ -213,18 +221,17 @@ bool DTrackWrapper::stopSampling()
 }
 
 
-// Sample thread:
+// Data callback (called by the I/O thread when a packet is waiting):
 //
-// classPointer (i): pointer to calling class
-void DTrackWrapper::thrFunction()
+// arrival (i): time at which the packet arrived
+void DTrackWrapper::handle_data( const vpr::Interval& arrival )
 {
-	// sampling loop:
-	while ( thrRunning )
-		sample();
+	sample_time = arrival;
+	sample();
 }
 
 
-// Samples a value (called by the sample thread):
+// Samples a value (called by the I/O thread):
 //
 // return value (o): sampling was successfull
 bool DTrackWrapper::sample()
@@ -234,10 +241,10 @@ bool DTrackWrapper::sample()
 	int nbt, nvt;
 	int num_body, num_flystick, num_meatool;
 	
-	if ( !thrRunning )
+	if ( !is_sampling )
 		return false;
 	
-	stat = standalone->receive();  // receive data from DTrack (blocking with timeout)
+	stat = standalone->receive();  // receive data from DTrack (data is waiting, so this does not block)
 	
 	if ( !stat )
 		return false;
@@ -269,7 +276,7 @@ bool DTrackWrapper::sample()
 		if ( dat.quality >= 0 )
 		{  
 			curPosition[ i ].setValue( getpos( dat ) );
-			curPosition[ i ].setTime();
+			curPosition[ i ].setTime( sample_time );
 		}
 		// otherwise keep last valid position
 		
@@ -285,7 +292,7 @@ bool DTrackWrapper::sample()
 			     i * BUTTONS_PER_FLYSTICK;  // VRJuggler id number
 			
 			curDigital[ id ] = static_cast< DigitalState::State > ( dat.button[ j ] );
-			curDigital[ id ].setTime();
+			curDigital[ id ].setTime( sample_time );
 		}
 		
 		// Flystick valuators ('HAT switch' or 'joystick'):
@@ -302,7 +309,7 @@ bool DTrackWrapper::sample()
 			     i * VALUATORS_PER_FLYSTICK;  // VRJuggler id number
 			
 			curAnalog[ id ] = dat.joystick[ j ];
-			curAnalog[ id ].setTime();
+			curAnalog[ id ].setTime( sample_time );
 		}
 	}
 	
@@ -319,7 +326,7 @@ bool DTrackWrapper::sample()
 			     num_flystick;  // VRJuggler id number
 			
 			curPosition[ id ].setValue( getpos( dat ) );
-			curPosition[ id ].setTime();
+			curPosition[ id ].setTime( sample_time );
 		}
 		// otherwise keep last valid position
 		
@@ -336,7 +343,7 @@ bool DTrackWrapper::sample()
 			     num_flystick * BUTTONS_PER_FLYSTICK;  // VRJuggler id number
 			
 			curDigital[ id ] = static_cast< DigitalState::State >( dat.button[ j ] );
-			curDigital[ id ].setTime();
+			curDigital[ id ].setTime( sample_time );
 		}
 	}
 	
@@ -354,7 +361,7 @@ bool DTrackWrapper::sample()
 			     num_meatool;  // VRJuggler id number
 			
 			curPosition[ id ].setValue( getpos( dat ) );
-			curPosition[ id ].setTime();
+			curPosition[ id ].setTime( sample_time );
 		}
 		// otherwise keep last valid position
 	}
@@ -372,7 +379,7 @@ bool DTrackWrapper::sample()
 void DTrackWrapper::updateData()
 {
 	// swap buffered data:	
-	if ( thrRunning )
+	if ( is_sampling )
 	{
 		swapPositionBuffers();
 		swapDigitalBuffers();
@@ -65,9 +65,11 @@ public:
 	virtual void updateData();
 	
 private:
-	vpr::Thread* thrThread;
-	void thrFunction();
-	bool thrRunning;
+	/** Called by gadget::IOReactor when a DTrack packet has arrived. */
+	void handle_data( const vpr::Interval& arrival );
+	
+	bool is_sampling;
+	vpr::Interval sample_time;  // arrival time of the packet being sampled
 	
 	DTrackStandalone* standalone;
 	int receive_port;
@@ -180,8 +180,28 @@ bool Flock::startSampling()
       vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL)
          << "gadget::Flock ready to go..\n" << vprDEBUG_FLUSH;
 
-      // Create a new thread to handle the control
       mExitFlag = false;
+
+      // Prefer the shared I/O thread over a sampling thread of our own.
+      if ( SerialStreamReader::isSupported() )
+      {
+         try
+         {
+            mReader.start(mFlockOfBirds.getSerialPort(),
+                          boost::bind(&Flock::processStream, this, _1, _2,
+                                      _3));
+            return true;
+         }
+         catch (vpr::Exception& ex)
+         {
+            vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_WARNING_LVL)
+               << clrOutBOLD(clrYELLOW, "WARNING")
+               << ": Flock of Birds driver could not use the shared I/O "
+               << "thread: " << ex.what() << std::endl << vprDEBUG_FLUSH;
+         }
+      }
+
+      // Create a new thread to handle the control
       try
       {
          mThread = new vpr::Thread(boost::bind(&Flock::controlLoop, this));
@@ -204,8 +224,6 @@ bool Flock::startSampling()
 
 bool Flock::sample()
 {
-   std::vector<gadget::PositionData> cur_samples(mFlockOfBirds.getNumSensors());
-
    if ( !isActive() )
    {
       return false;
@@ -213,30 +231,44 @@ bool Flock::sample()
 
    mFlockOfBirds.sample();
 
-   // get an initial timestamp for this entire sample. we'll copy it into
-   // each PositionData for this sample.
-   if (!cur_samples.empty())
+   // get a timestamp for this entire sample. it is copied into each
+   // PositionData for this sample.
+   addSample(vpr::Interval::now());
+
+   vpr::Thread::yield();
+
+   return true;
+}
+
+vpr::Uint32 Flock::processStream(const vpr::Uint8* data,
+                                 const vpr::Uint32 size,
+                                 const vpr::Interval& arrival)
+{
+   bool got_record(false);
+   const vpr::Uint32 used = mFlockOfBirds.processStream(data, size,
+                                                        got_record);
+   if ( got_record )
    {
-      cur_samples[0].setTime();
+      addSample(arrival);
    }
 
-   vpr::Thread::yield();
+   return used;
+}
+
+void Flock::addSample(const vpr::Interval& time)
+{
+   mSamples.resize(mFlockOfBirds.getNumSensors());
 
    // For each bird
-   for (unsigned int i =0; i < mFlockOfBirds.getNumSensors(); ++i)
+   for (unsigned int i =0; i < mSamples.size(); ++i)
    {
-      // Transforms between the cord frames
-      gmtl::Matrix44f transmitter_T_reciever = mFlockOfBirds.getSensorPosition(i);
-
-      // Set timestamp & Store the corrected xform back into buffer.
-      cur_samples[i].setValue(transmitter_T_reciever);
-      cur_samples[i].setTime(cur_samples[0].getTime());
+      // Set timestamp & Store the transform between the cord frames.
+      mSamples[i].setValue(mFlockOfBirds.getSensorPosition(i));
+      mSamples[i].setTime(time);
    }
 
    // Add data sample
-   addPositionSample(cur_samples);
-
-   return true;
+   addPositionSample(mSamples);
 }
 
 bool Flock::stopSampling()
@@ -246,15 +278,20 @@ bool Flock::stopSampling()
       return false;
    }
 
-   if (mThread != NULL)
+   if (mThread != NULL || mReader.isRunning())
    {
       vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL)
          << "Stopping the flock thread..." << vprDEBUG_FLUSH;
 
-      mExitFlag = true;
-      mThread->join();
-      delete mThread;
-      mThread = NULL;
+      mReader.stop();
+
+      if (mThread != NULL)
+      {
+         mExitFlag = true;
+         mThread->join();
+         delete mThread;
+         mThread = NULL;
+      }
 
       vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL)
          << "  Stopping the flock..." << vprDEBUG_FLUSH;
@@ -280,6 +317,8 @@ void Flock::updateData()
 {
    if ( isActive() )
    {
+      // The shared I/O thread cannot stop watching a failed port by itself.
+      mReader.checkFailure();
       swapPositionBuffers();
    }
 }
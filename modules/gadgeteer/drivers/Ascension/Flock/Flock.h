@@ -29,9 +29,12 @@
 
 #include <gadget/Devices/DriverConfig.h>
 
+#include <vector>
+
 #include <vpr/Thread/Thread.h>
 
 #include <gadget/Type/InputDevice.h>
+#include <gadget/Util/SerialStreamReader.h>
 
 #include "FlockStandalone.h"
 
@@ -109,8 +112,26 @@ protected:
    void controlLoop();
 
 private:
+   /**
+    * Framing callback for mReader.  Adds a sample for every complete data
+    * record, time stamped with the arrival of its last byte.
+    */
+   vpr::Uint32 processStream(const vpr::Uint8* data, const vpr::Uint32 size,
+                             const vpr::Interval& arrival);
+
+   /** Adds a sample holding the current data of all birds. */
+   void addSample(const vpr::Interval& time);
+
    FlockStandalone   mFlockOfBirds; /**< The actual Flock device object */
    bool              mExitFlag;
+
+   /**
+    * Reads the stream from the shared I/O thread.  The sampling thread is
+    * only used where SerialStreamReader is not supported.
+    */
+   SerialStreamReader mReader;
+
+   std::vector<PositionData> mSamples;    /**< Reused by addSample() */
 };
 
 } // End of gadget namespace
@@ -412,19 +412,16 @@ void FlockStandalone::sample()
    // can't sample when not streaming
    vprASSERT( (STREAMING == mStatus) || (RUNNING == mStatus) );
 
-   std::vector<vpr::Uint8> data_record;
-   std::vector<vpr::Uint8> temp_data_record;    // Temp buffer for reading data
+   // The record buffers are members so that their storage is reused.
+   std::vector<vpr::Uint8>& data_record(mDataRecord);
+   std::vector<vpr::Uint8>& temp_data_record(mReadBuffer);   // Temp buffer for reading data
    vpr::Uint8 buffer;                           // Temporary single byte buffer
 
    vpr::Uint32 bytes_read;
    vpr::Uint32 bytes_remaining;
    const vpr::Uint8 phase_mask(1<<7);     // Mask for finding phasing bit
 
-   unsigned int single_bird_data_size = Flock::Output::getDataSize(mOutputFormat);
-   if(Flock::Standalone != mMode)      // If we are in group mode, then it is one byte longer (the bird address for the sample)
-   {
-      single_bird_data_size += 1;
-   }
+   const unsigned int single_bird_data_size(getSensorRecordSize());
    const unsigned int data_record_size(mNumSensors*single_bird_data_size);    // Size of the data record to read
 
    bool sample_succeeded;        // Flag for success. When false, there was an error so repeat.
@@ -596,7 +593,56 @@ void FlockStandalone::sample()
 
    // Process the data record
    vprASSERT(data_record[0] & phase_mask);
-   processDataRecord(data_record);
+   processDataRecord(&data_record[0]);
+}
+
+vpr::Uint32 FlockStandalone::processStream(const vpr::Uint8* data,
+                                           const vpr::Uint32 size,
+                                           bool& gotRecord)
+{
+   vprASSERT(STREAMING == mStatus);
+
+   const vpr::Uint8 phase_mask(1<<7);     // Mask for finding phasing bit
+   const unsigned int single_bird_data_size(getSensorRecordSize());
+   const unsigned int data_record_size(mNumSensors*single_bird_data_size);
+
+   gotRecord = false;
+
+   // Skip to the first byte with the phasing bit.
+   if ( ! (data[0] & phase_mask) )
+   {
+      vpr::Uint32 skip(1);
+      while ( skip < size && ! (data[skip] & phase_mask) )
+      {
+         ++skip;
+      }
+      return skip;
+   }
+
+   if ( size < data_record_size )
+   {
+      return 0;
+   }
+
+   // Make sure the only phase bits in the record are at the beginning of a
+   // sensor record.  If there is another one, the record was cut short, so
+   // start over from there.
+   for ( unsigned int b = 1; b < data_record_size; ++b )
+   {
+      if ( (b % single_bird_data_size) && (phase_mask & data[b]) )
+      {
+         vprDEBUG(vprDBG_ALL, vprDBG_WARNING_LVL)
+            << "[FlockStandalone::processStream()] data out of phase, "
+            << "resynchronizing at byte " << b << " of " << data_record_size
+            << "\n" << vprDEBUG_FLUSH;
+         return b;
+      }
+   }
+
+   processDataRecord(data);
+   gotRecord = true;
+
+   return data_record_size;
 }
 
 /** Stops the Flock. */
@@ -818,17 +864,21 @@ void FlockStandalone::setSync(const vpr::Uint8& sync)
  * Processs a data record from the flock that contains one sensor record per
  * sensor.
  */
-void FlockStandalone::processDataRecord(std::vector<vpr::Uint8> dataRecord)
+unsigned int FlockStandalone::getSensorRecordSize() const
 {
-   const vpr::Uint8 phase_mask(1<<7);     // Mask for finding phasing bit
-
    unsigned int single_bird_data_size = Flock::Output::getDataSize(mOutputFormat);
-   if(Flock::Standalone != mMode)      // If we are in group mode, then it is one byte longer
+   if(Flock::Standalone != mMode)      // If we are in group mode, then it is one byte longer (the bird address for the sample)
    {
       single_bird_data_size += 1;
    }
-   const unsigned int data_record_size(mNumSensors*single_bird_data_size);    // Size of the data record to read
-   vprASSERT(dataRecord.size() == data_record_size);
+   return single_bird_data_size;
+}
+
+void FlockStandalone::processDataRecord(const vpr::Uint8* dataRecord)
+{
+   const vpr::Uint8 phase_mask(1<<7);     // Mask for finding phasing bit
+
+   const unsigned int single_bird_data_size(getSensorRecordSize());
    vprASSERT(dataRecord[0] & phase_mask);
 
    // For each sensor
@@ -864,7 +914,7 @@ void FlockStandalone::processDataRecord(std::vector<vpr::Uint8> dataRecord)
    }
 }
 
-gmtl::Matrix44f FlockStandalone::processSensorRecord(vpr::Uint8* buff)
+gmtl::Matrix44f FlockStandalone::processSensorRecord(const vpr::Uint8* buff)
 {
    gmtl::Matrix44f ret_mat;
    float x,y,z,xr,yr,zr, q0,q1,q2,q3;
@@ -702,6 +702,26 @@ public:
    /** Call this repeatedly to update the data from the birds. */
    void sample();
 
+   /**
+    * Alternative to sample() for callers that read the streamed data
+    * themselves, such as gadget::SerialStreamReader.  The bytes in \p data
+    * are examined from the front.  If they start with a complete data
+    * record, the record is processed, \p gotRecord is set to true and the
+    * size of the record is returned.  If they cannot start a record, the
+    * number of bytes to skip to the next possible start is returned.  0 is
+    * returned when more bytes are needed.
+    *
+    * @pre The Flock is streaming.
+    */
+   vpr::Uint32 processStream(const vpr::Uint8* data, const vpr::Uint32 size,
+                             bool& gotRecord);
+
+   /** Returns the port connected to the Flock, or NULL if it is closed. */
+   vpr::SerialPort* getSerialPort()
+   {
+      return mSerialPort;
+   }
+
    /** Return the position of a bird sensor */
    gmtl::Matrix44f getSensorPosition(unsigned int sensorNumber)
    {
@@ -947,11 +967,14 @@ protected:     // -- Bird commands --- //
 
 
 protected: // -- Helpers --- //
+   /** Size of the data of one sensor in a data record. */
+   unsigned int getSensorRecordSize() const;
+
    /** Process a reading (of all sensors) from the Flock. */
-   void processDataRecord(std::vector<vpr::Uint8> dataRecord);
+   void processDataRecord(const vpr::Uint8* dataRecord);
 
    /** Get a matrix position from bird input data in the buffer. */
-   gmtl::Matrix44f processSensorRecord(vpr::Uint8* buff);
+   gmtl::Matrix44f processSensorRecord(const vpr::Uint8* buff);
 
    /** Helper to convert raw binary data read to float value. */
    float rawToFloat(const vpr::Uint8& r1, const vpr::Uint8& r2);
@@ -1078,6 +1101,12 @@ private:  // --- Data members --- //
     */
    std::vector<gmtl::Matrix44f>  mSensorData;
 
+   /** @name Buffers reused by sample() */
+   //@{
+   std::vector<vpr::Uint8> mDataRecord;
+   std::vector<vpr::Uint8> mReadBuffer;
+   //@}
+
    // --- Default params --- //
    vpr::Interval        mReadTimeout;  /**< Standard timeout for all reads */
 };
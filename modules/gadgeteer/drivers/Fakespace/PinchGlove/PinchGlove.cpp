@@ -86,7 +86,7 @@ bool PinchGlove::startSampling()
 {
    bool started(true);
 
-   if (NULL != mThread)
+   if (NULL != mThread || mReader.isRunning())
    {
       // Already sampling
       started = false; 
@@ -132,7 +132,40 @@ bool PinchGlove::startSampling()
             << (*itr) << std::endl << vprDEBUG_FLUSH;
       }
 
+      // We want to add an open hand sample first because the pinch glove
+      // will not return data until there is a pinch. And until then, the
+      // hand will be open.  This has to happen before sampling starts so
+      // that it cannot overwrite the first real sample.
+      mData.assign(10, 0);
+      addSample();
+      swapDigitalBuffers();
+      swapGloveBuffers();
+
       mExitFlag = false;
+
+      // Prefer the shared I/O thread over a sampling thread of our own.
+      if ( SerialStreamReader::isSupported() )
+      {
+         try
+         {
+            mReader.start(mGlove->getSerialPort(),
+                          boost::bind(&PinchGlove::processStream, this, _1,
+                                      _2, _3));
+
+            vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL)
+               << "[PinchGlove] PinchGlove is active " << std::endl
+               << vprDEBUG_FLUSH;
+            return true;
+         }
+         catch (vpr::Exception& ex)
+         {
+            vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_WARNING_LVL)
+               << clrOutBOLD(clrYELLOW, "WARNING")
+               << ": PinchGlove driver could not use the shared I/O thread: "
+               << ex.what() << std::endl << vprDEBUG_FLUSH;
+         }
+      }
+
       vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL) 
          << "[PinchGlove] Spawning control thread." << std::endl
          << vprDEBUG_FLUSH;
@@ -143,17 +176,6 @@ bool PinchGlove::startSampling()
          mThread = new vpr::Thread(boost::bind(&PinchGlove::controlLoop,
                                                this));
 
-         // We want to add an open hand sample first because the pinch glove
-         // will not return data until there is a pinch. And until then, the
-         // hand will be open.
-         std::vector<DigitalData> digital_sample(10, DigitalState::OFF);
-         addDigitalSample(digital_sample);
-         std::vector<GloveData> gloveData =
-            getGloveDataFromDigitalData(digital_sample);
-         addGloveSample(gloveData);
-         swapDigitalBuffers();
-         swapGloveBuffers();
-         
          vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL)
             << "[PinchGlove] PinchGlove is active " << std::endl
             << vprDEBUG_FLUSH;
@@ -197,12 +219,9 @@ struct ToDigitalState
 
 bool PinchGlove::sample()
 {
-   // Create a vector of DigitalData's to hold our sample.
-   std::vector<DigitalData> digital_sample(10);
-  
-   // Create a vector to retrieve data from the PinchGloveStandalone
-   // driver with.
-   std::vector<int> data(10, 0);
+   // Clear the finger contacts, the PinchGloveStandalone driver only sets
+   // the ones that are touching.
+   mData.assign(10, 0);
 
    // NOTE: The timestamp retrieved from the PinchGlove is not used at this
    //       time. This is partly because it saturates at 16382 ticks.
@@ -210,31 +229,49 @@ bool PinchGlove::sample()
    int timestamp = 0;
    
    // Get data from PinchGlove;
-   if ( mGlove->sample(data, timestamp) )
+   if ( mGlove->sample(mData, timestamp) )
    {
-      // Copy the data into a new digital sample.
-      ToDigitalState to_dig;
-      std::transform(data.begin(), data.end(), digital_sample.begin(), to_dig);
-
-      // Add a new digital sample to the buffer.
-      addDigitalSample(digital_sample);
-
-      std::vector<GloveData> gloveData = getGloveDataFromDigitalData(digital_sample);
-      addGloveSample(gloveData);
-      
-      // Debug print.
-      //for(unsigned int i = 0 ; i < data.size() ; ++i)
-      //{
-      //   std::cout << (data[i] > 0 ? "1" : "0");
-      //}
-      //std::cout << std::endl;
+      addSample();
       return true;
    }
    return false;
 }
 
+vpr::Uint32 PinchGlove::processStream(const vpr::Uint8* data,
+                                      const vpr::Uint32 size,
+                                      const vpr::Interval&)
+{
+   mData.assign(10, 0);
+
+   int timestamp(0);
+   bool got_sample(false);
+   const vpr::Uint32 used = mGlove->processStream(data, size, mData,
+                                                  timestamp, got_sample);
+   if ( got_sample )
+   {
+      addSample();
+   }
+
+   return used;
+}
+
+void PinchGlove::addSample()
+{
+   // Copy the data into a new digital sample.
+   mDigitalSample.resize(mData.size());
+   ToDigitalState to_dig;
+   std::transform(mData.begin(), mData.end(), mDigitalSample.begin(), to_dig);
+
+   // Add a new digital sample to the buffer.
+   addDigitalSample(mDigitalSample);
+   addGloveSample(getGloveDataFromDigitalData(mDigitalSample));
+}
+
 void PinchGlove::updateData()
 {
+   // The shared I/O thread cannot stop watching a failed port by itself.
+   mReader.checkFailure();
+
    swapDigitalBuffers();
    swapGloveBuffers();
    return;
@@ -242,17 +279,22 @@ void PinchGlove::updateData()
 
 bool PinchGlove::stopSampling()
 {
-   if ( mThread != NULL )
+   if ( mThread != NULL || mReader.isRunning() )
    {
       vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_STATUS_LVL)
          << "[PinchGlove] Stopping PinchGlove." << std::endl << vprDEBUG_FLUSH;
-      
-      //Signal to thread that it should exit
-      mExitFlag = true;
 
-      mThread->join();
-      delete mThread;
-      mThread = NULL;
+      mReader.stop();
+
+      if ( mThread != NULL )
+      {
+         //Signal to thread that it should exit
+         mExitFlag = true;
+
+         mThread->join();
+         delete mThread;
+         mThread = NULL;
+      }
 
       vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_STATUS_LVL)
          << "[PinchGlove] PinchGlove stopped." << std::endl << vprDEBUG_FLUSH;
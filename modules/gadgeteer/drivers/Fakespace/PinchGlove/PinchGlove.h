@@ -34,6 +34,7 @@
 #include <boost/mpl/inherit.hpp>
 
 #include <gadget/Type/InputDevice.h>
+#include <gadget/Util/SerialStreamReader.h>
 
 #include "PinchGloveStandalone.h"
 
@@ -104,11 +105,30 @@ protected:
     */
    void controlLoop();
 
+   /**
+    * Framing callback for mReader.  Adds a sample for every complete data
+    * packet.
+    */
+   vpr::Uint32 processStream(const vpr::Uint8* data, const vpr::Uint32 size,
+                             const vpr::Interval& arrival);
+
+   /** Adds a sample built from the finger contacts in mData. */
+   void addSample();
+
 protected:
    PinchGloveStandalone* mGlove;        /**< The PinchGloveStandalone device. */
    std::string           mPortName;     /**< Serial Port to connect to. */
    int                   mBaud;         /**< Baud to communicate with device. */
    bool                  mExitFlag;     /**< Flag used to cleanly shutdown device. */
+
+   /**
+    * Reads the stream from the shared I/O thread.  The sampling thread is
+    * only used where SerialStreamReader is not supported.
+    */
+   SerialStreamReader    mReader;
+
+   std::vector<int>         mData;          /**< Reused finger contacts */
+   std::vector<DigitalData> mDigitalSample; /**< Reused digital sample */
 };
 
 } // End of gadget namespace
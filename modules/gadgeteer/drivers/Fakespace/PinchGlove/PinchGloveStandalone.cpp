@@ -245,38 +245,89 @@ namespace gadget
          return false;
       }
       
-      int num_pinch_bytes;
-      
+      if ( ! input_data.empty() )
+      {
+         decodeData(&input_data[0], input_data.size(), data, timestamp);
+      }
+      else
+      {
+         timestamp = -1;
+      }
+
+      return true;
+   }
+
+   vpr::Uint32 PinchGloveStandalone::processStream(const vpr::Uint8* buffer,
+                                                   const vpr::Uint32 size,
+                                                   std::vector<int>& data,
+                                                   int& timestamp,
+                                                   bool& gotSample)
+   {
+      const vpr::Uint8 data_type =
+         mTimeStampsOn ? PinchGlove::Control::START_BYTE_DATA_TS :
+                         PinchGlove::Control::START_BYTE_DATA;
+
+      gotSample = false;
+
+      // Skip to the start of the next data packet.  Anything else, such as
+      // the reply to a command, is of no interest here.
+      if ( buffer[0] != data_type )
+      {
+         vpr::Uint32 skip(1);
+         while ( skip < size && buffer[skip] != data_type )
+         {
+            ++skip;
+         }
+         return skip;
+      }
+
+      const vpr::Uint8* end = std::find(buffer + 1, buffer + size,
+                                        PinchGlove::Control::END_BYTE);
+      if ( buffer + size == end )
+      {
+         return 0;
+      }
+
+      decodeData(buffer + 1, end - buffer - 1, data, timestamp);
+      gotSample = true;
+
+      return end - buffer + 1;
+   }
+
+   void PinchGloveStandalone::decodeData(const vpr::Uint8* packet,
+                                         const vpr::Uint32 size,
+                                         std::vector<int>& data,
+                                         int& timestamp) const
+   {
+      vpr::Uint32 num_pinch_bytes;
+
       // Determine how to parse data depending on data type recieved.
-      if(mTimeStampsOn)
+      if(mTimeStampsOn && size >= 2)
       {
-         num_pinch_bytes = input_data.size() - 2;
-         timestamp = 
-            (input_data[input_data.size()])<<7 | input_data[input_data.size()-1];
+         num_pinch_bytes = size - 2;
+         timestamp = (packet[size - 2] << 7) | packet[size - 1];
       }
       else
       {
-         num_pinch_bytes = input_data.size();
+         num_pinch_bytes = size;
          timestamp = -1;
       }
-    
+
       // Determine if each finger is touching something else.
-      for(int i = 0 ; i < num_pinch_bytes ; i += 2)
+      for(vpr::Uint32 i = 0 ; i + 1 < num_pinch_bytes ; i += 2)
       {
-         data[0] |= (input_data[i] & 0x1);
-         data[1] |= ((input_data[i] & 0x2)>>1);
-         data[2] |= ((input_data[i] & 0x4)>>2);
-         data[3] |= ((input_data[i] & 0x8)>>3);
-         data[4] |= ((input_data[i] & 0x10)>>4);
-         
-         data[5] |= (input_data[i+1] & 0x1);
-         data[6] |= ((input_data[i+1] & 0x2)>>1);
-         data[7] |= ((input_data[i+1] & 0x4)>>2);
-         data[8] |= ((input_data[i+1] & 0x8)>>3);
-         data[9] |= ((input_data[i+1] & 0x10)>>4);
-      }
+         data[0] |= (packet[i] & 0x1);
+         data[1] |= ((packet[i] & 0x2)>>1);
+         data[2] |= ((packet[i] & 0x4)>>2);
+         data[3] |= ((packet[i] & 0x8)>>3);
+         data[4] |= ((packet[i] & 0x10)>>4);
 
-      return true;
+         data[5] |= (packet[i+1] & 0x1);
+         data[6] |= ((packet[i+1] & 0x2)>>1);
+         data[7] |= ((packet[i+1] & 0x4)>>2);
+         data[8] |= ((packet[i+1] & 0x8)>>3);
+         data[9] |= ((packet[i+1] & 0x10)>>4);
+      }
    }
 
    void PinchGloveStandalone::sendCommand(const vpr::Uint8& first,
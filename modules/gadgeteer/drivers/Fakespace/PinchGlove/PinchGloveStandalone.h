@@ -154,7 +154,31 @@ public:
     */
    bool sample(std::vector<int>& data, int& timestamp);
 
+   /**
+    * Alternative to sample() for callers that read the port themselves,
+    * such as gadget::SerialStreamReader.  The bytes in \p buffer are
+    * examined from the front.  If they start with a complete data packet,
+    * it is decoded into \p data and \p timestamp as by sample(),
+    * \p gotSample is set to true and the size of the packet is returned.
+    * Bytes that cannot start a data packet are skipped by returning their
+    * number.  0 is returned when more bytes are needed.
+    */
+   vpr::Uint32 processStream(const vpr::Uint8* buffer, const vpr::Uint32 size,
+                             std::vector<int>& data, int& timestamp,
+                             bool& gotSample);
+
+   /** Returns the port connected to the glove, or NULL before connect(). */
+   vpr::SerialPort* getSerialPort()
+   {
+      return mPort;
+   }
+
 private:
+   /** Decodes the bytes between the start and end bytes of a data packet. */
+   void decodeData(const vpr::Uint8* packet, const vpr::Uint32 size,
+                   std::vector<int>& data, int& timestamp) const;
+
+
    /**
     * Send a command to the PinchGlove.
     *
@@ -42,10 +42,13 @@
 
 #include <linux/joystick.h>      // Get the joystick abilities
 
+#include <boost/bind.hpp>
+
 #include <vpr/Util/Debug.h>
 #include <jccl/Config/ConfigElement.h>
 #include <gadget/Type/DeviceConstructor.h>
 #include <gadget/Util/Debug.h>
+#include <gadget/Util/IOReactor.h>
 #include <gadget/gadgetParam.h>
 
 
@@ -69,6 +72,11 @@ namespace gadget
 
 // Constructor.
 LinuxJoydev::LinuxJoydev()
+   : mNumAxes(0)
+   , mNumButtons(0)
+   , mJsFD(-1)
+   , mRegistered(false)
+   , mReadFailed(false)
 {
    /* Do nothing. */ ;
 }
@@ -76,7 +84,7 @@ LinuxJoydev::LinuxJoydev()
 // Destructor.
 LinuxJoydev::~LinuxJoydev()
 {
-   /* Do nothing. */ ;
+   stopSampling();
 }
 
 std::string LinuxJoydev::getElementType()
@@ -209,15 +217,49 @@ bool LinuxJoydev::startSampling()
       mAxisToButtonIndexLookup[axis_index] = int(virtual_btn_index);    // Setup the mapping
    }
 
+   // Start out with everything released and centered.  The kernel reports
+   // the actual state with its first events.
+   addDigitalSample(mCurButtons);
+   addAnalogSample(mCurAxes);
+
+   mReadFailed = false;
+
+#if VPR_IO_DOMAIN_INCLUDE == VPR_DOMAIN_POSIX
+   // Have the shared I/O thread read the events as they arrive.  Without it,
+   // they are read once per frame by updateData().
+   try
+   {
+      IOReactor::instance()->registerHandle(
+         mJsFD, boost::bind(&LinuxJoydev::handleEvents, this, _1)
+      );
+      mRegistered = true;
+   }
+   catch (vpr::Exception& ex)
+   {
+      vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_WARNING_LVL)
+         << clrOutBOLD(clrYELLOW, "WARNING")
+         << ": Linux Joystick driver could not use the shared I/O thread: "
+         << ex.what() << std::endl << vprDEBUG_FLUSH;
+   }
+#endif
+
    return true;
 }
 
 // Stops sampling.  Drops the connection to joystick and clears everything.
 bool LinuxJoydev::stopSampling()
 {
-   if(mJsFD > 0)
+   if ( mRegistered )
+   {
+      // No callback is running once this returns.
+      IOReactor::instance()->unregisterHandle(mJsFD);
+      mRegistered = false;
+   }
+
+   if(mJsFD >= 0)
    {
       close(mJsFD);     // Close the joystick device
+      mJsFD = -1;
    }
 
    return true;
@@ -227,94 +269,185 @@ bool LinuxJoydev::stopSampling()
 // Updates to the sampled data.
 void LinuxJoydev::updateData()
 {
+   if ( mReadFailed )
+   {
+      // The I/O thread cannot stop watching the device by itself.
+      if ( mRegistered )
+      {
+         IOReactor::instance()->unregisterHandle(mJsFD);
+         mRegistered = false;
+      }
+   }
    // -- Read in any new pending events
-   js_event cur_event;
+   else if ( ! mRegistered && ! readEvents(vpr::Interval::now()) )
+   {
+      vprDEBUG(vprDBG_ALL, vprDBG_CRITICAL_LVL)
+         << "ERROR: Error reading linux joystick.\n" << vprDEBUG_FLUSH;
+      return;
+   }
+
+   swapDigitalBuffers();
+   swapAnalogBuffers();
+}
+
+void LinuxJoydev::handleEvents(const vpr::Interval& arrival)
+{
+   // The device stays readable after an error, so do not retry until
+   // updateData() has stopped the I/O thread from watching it.
+   if ( ! mReadFailed && ! readEvents(arrival) )
+   {
+      mReadFailed = true;
+
+      vprDEBUG(vprDBG_ALL, vprDBG_CRITICAL_LVL)
+         << "ERROR: Error reading linux joystick " << mPortName << ": "
+         << strerror(errno) << std::endl << vprDEBUG_FLUSH;
+   }
+}
+
+bool LinuxJoydev::readEvents(const vpr::Interval& arrival)
+{
+   // Enough room for the burst of events from moving a few axes at once.
+   const unsigned int max_events(64);
+   js_event events[max_events];
+
+   bool digital_changed(false);
+   bool analog_changed(false);
+   bool ok(true);
 
    // While events pending
-   while (read(mJsFD, &cur_event, sizeof(struct js_event)) > 0)
+   while ( true )
    {
-      if(cur_event.type & JS_EVENT_BUTTON)
+      const ssize_t bytes = read(mJsFD, events, sizeof(events));
+
+      if ( bytes < 0 )
+      {
+         if ( errno == EINTR )
+         {
+            continue;
+         }
+
+         // Check to make sure error was just no-pending events
+         ok = errno == EAGAIN;
+         break;
+      }
+
+      const unsigned int count(bytes / sizeof(js_event));
+      if ( 0 == count )
       {
-         //std::cout << "ljs: btn: " << unsigned(cur_event.number) << " val:"
-         //          << cur_event.value << std::endl;
-         const unsigned int btn_number(cur_event.number);
-         vprASSERT(btn_number < mCurButtons.size() && "Button out of range");
-         // Assign the new button value (0,1)
-         mCurButtons[btn_number] =
-            static_cast<DigitalState::State>(cur_event.value);
-         mCurButtons[btn_number].setTime();                 // Set timestamp to now
+         break;
       }
-      else if(cur_event.type & JS_EVENT_AXIS)
+
+      // The kernel stamps events in milliseconds on a clock of its own.
+      // Map them onto vpr::Interval relative to the newest one, which was
+      // available by the time given in arrival.
+      const vpr::Uint32 newest(events[count - 1].time);
+
+      for ( unsigned int i = 0; i < count; ++i )
       {
-         //std::cout << "ljs: axis: " << unsigned(cur_event.number) << " val:"
-         //          << cur_event.value << std::endl;
-         const unsigned int axis_number(cur_event.number);
-         vprASSERT(axis_number < mCurAxes.size() && "Axis out of range");
-         vprASSERT(axis_number < mCurAxesRanges.size() && "Axis out of range");
-
-         mCurAxes[axis_number] = cur_event.value;
-         mCurAxes[axis_number].setTime();
-
-         // Check for axis buttons. If we have a mapping for axis_number,
-         // then we map the value of the analog axis to two buttons (high and
-         // low). If the analog value is greater than 0.5, then we map the
-         // high button to 1 and the low button to 0. If the analog value is
-         // less than 0.5, then we map the high button to 0 and the low button
-         // to 0. Otherwise, both buttons are 0.
-         if ( mAxisToButtonIndexLookup[axis_number] != -1 )    // If we map to a virtual button
+         const js_event& cur_event(events[i]);
+         const vpr::Interval event_time(
+            arrival - vpr::Interval(newest - cur_event.time,
+                                    vpr::Interval::Msec)
+         );
+
+         if(cur_event.type & JS_EVENT_BUTTON)
          {
-            const unsigned int low_btn_index =
-               mAxisToButtonIndexLookup[axis_number];
-            const unsigned int high_btn_index = low_btn_index + 1;
-            vprASSERT(high_btn_index < mCurButtons.size() &&
-                      "Virtual high button index out of range");
-            vprASSERT(low_btn_index < mCurButtons.size() &&
-                      "Virtual low button index out of range");
-
-            // Get a normalized form of the current value for axis button
-            // handling.
-            const float norm_value(normalize(cur_event.value));
-
-            // Record the high button as pressed and the low button as not
-            // pressed.
-            if ( norm_value > 0.5f )
-            {
-               mCurButtons[low_btn_index]  = DigitalState::OFF;
-               mCurButtons[high_btn_index] = DigitalState::ON;
-            }
-            // Record the high button as not pressed and the low button as
-            // pressed.
-            else if ( norm_value < 0.5f )
+            //std::cout << "ljs: btn: " << unsigned(cur_event.number) << " val:"
+            //          << cur_event.value << std::endl;
+            const unsigned int btn_number(cur_event.number);
+            vprASSERT(btn_number < mCurButtons.size() && "Button out of range");
+
+            // Add the changes so far first so that no press or release is
+            // lost when a button changes more than once in a batch.
+            if ( digital_changed )
             {
-               mCurButtons[low_btn_index]  = DigitalState::ON;
-               mCurButtons[high_btn_index] = DigitalState::OFF;
+               addDigitalSample(mCurButtons);
             }
-            // Record both buttons as not pressed.
-            else
+
+            // Assign the new button value (0,1)
+            mCurButtons[btn_number] =
+               static_cast<DigitalState::State>(cur_event.value);
+            mCurButtons[btn_number].setTime(event_time);
+            digital_changed = true;
+         }
+         else if(cur_event.type & JS_EVENT_AXIS)
+         {
+            //std::cout << "ljs: axis: " << unsigned(cur_event.number) << " val:"
+            //          << cur_event.value << std::endl;
+            const unsigned int axis_number(cur_event.number);
+            vprASSERT(axis_number < mCurAxes.size() && "Axis out of range");
+            vprASSERT(axis_number < mCurAxesRanges.size() && "Axis out of range");
+
+            mCurAxes[axis_number] = cur_event.value;
+            mCurAxes[axis_number].setTime(event_time);
+            analog_changed = true;
+
+            // Check for axis buttons. If we have a mapping for axis_number,
+            // then we map the value of the analog axis to two buttons (high and
+            // low). If the analog value is greater than 0.5, then we map the
+            // high button to 1 and the low button to 0. If the analog value is
+            // less than 0.5, then we map the high button to 0 and the low button
+            // to 0. Otherwise, both buttons are 0.
+            if ( mAxisToButtonIndexLookup[axis_number] != -1 )    // If we map to a virtual button
             {
-               mCurButtons[low_btn_index]  = DigitalState::OFF;
-               mCurButtons[high_btn_index] = DigitalState::OFF;
+               const unsigned int low_btn_index =
+                  mAxisToButtonIndexLookup[axis_number];
+               const unsigned int high_btn_index = low_btn_index + 1;
+               vprASSERT(high_btn_index < mCurButtons.size() &&
+                         "Virtual high button index out of range");
+               vprASSERT(low_btn_index < mCurButtons.size() &&
+                         "Virtual low button index out of range");
+
+               // Get a normalized form of the current value for axis button
+               // handling.
+               const float norm_value(normalize(cur_event.value));
+
+               // Record the high button as pressed and the low button as not
+               // pressed.
+               if ( norm_value > 0.5f )
+               {
+                  mCurButtons[low_btn_index]  = DigitalState::OFF;
+                  mCurButtons[high_btn_index] = DigitalState::ON;
+               }
+               // Record the high button as not pressed and the low button as
+               // pressed.
+               else if ( norm_value < 0.5f )
+               {
+                  mCurButtons[low_btn_index]  = DigitalState::ON;
+                  mCurButtons[high_btn_index] = DigitalState::OFF;
+               }
+               // Record both buttons as not pressed.
+               else
+               {
+                  mCurButtons[low_btn_index]  = DigitalState::OFF;
+                  mCurButtons[high_btn_index] = DigitalState::OFF;
+               }
+
+               mCurButtons[low_btn_index].setTime(event_time);
+               mCurButtons[high_btn_index].setTime(event_time);
+               digital_changed = true;
             }
-
-            mCurButtons[low_btn_index].setTime();
-            mCurButtons[high_btn_index].setTime();
          }
       }
+
+      // A short read means that the queue is empty.
+      if ( count < max_events )
+      {
+         break;
+      }
    }
 
-   // Check to make sure error was just no-pending events
-   if(errno != EAGAIN)
+   if ( digital_changed )
    {
-      vprDEBUG(vprDBG_ALL, vprDBG_CRITICAL_LVL)
-         << "ERROR: Error reading linux joystick.\n" << vprDEBUG_FLUSH;
-      return;
+      addDigitalSample(mCurButtons);
    }
 
-   addDigitalSample(mCurButtons);
-   swapDigitalBuffers();
+   if ( analog_changed )
+   {
+      addAnalogSample(mCurAxes);
+   }
 
-   addAnalogSample(mCurAxes);
-   swapAnalogBuffers();
+   return ok;
 }
 
 } // End of gadget namespace
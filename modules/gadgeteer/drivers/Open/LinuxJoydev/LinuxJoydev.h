@@ -33,6 +33,8 @@
 #include <utility>
 #include <boost/mpl/inherit.hpp>
 
+#include <vpr/Util/Interval.h>
+
 #include <gadget/Type/InputDevice.h>
 
 
@@ -42,6 +44,11 @@ namespace gadget
 /**
  * Driver to Linux joystick input.
  *
+ * Where the shared gadget::IOReactor thread can wait on the device, events
+ * are read in batches as soon as they arrive.  Otherwise, they are read once
+ * per frame by updateData().  Either way, each button and axis is stamped
+ * with the time at which the kernel reported its event.
+ *
  * @see gadget::Digital
  * @see gadget::Analog
  */
@@ -119,6 +126,20 @@ public:
    }
 
 private:
+   /** Readiness callback for the shared I/O thread. */
+   void handleEvents(const vpr::Interval& arrival);
+
+   /**
+    * Reads and applies all pending events and adds samples for them.
+    *
+    * @param arrival The time at which the newest pending event was known to
+    *                be available.
+    *
+    * @return false if reading failed for a reason other than there being no
+    *         more events.
+    */
+   bool readEvents(const vpr::Interval& arrival);
+
    std::string                   mPortName;        /**< Name of the port to connect to */
    std::vector<unsigned>         mAxisButtonIndices;  /**< Indices of the axis buttons */
 
@@ -135,6 +156,8 @@ private:
    unsigned          mNumButtons;      /**< Number of buttons that we have on the joystick */
 
    int               mJsFD;            /**< File descriptor for the joystick */
+   bool              mRegistered;      /**< mJsFD is watched by the I/O thread */
+   volatile bool     mReadFailed;      /**< Set by the I/O thread on errors */
 };
 
 } // End of gadget namespace
@@ -29,7 +29,6 @@
 #include <boost/bind.hpp>
 
 #include <vpr/vprConfig.h>
-#include <vpr/System.h>
 
 #include <gmtl/Matrix.h>
 #include <gmtl/Vec.h>
@@ -40,6 +39,7 @@
 #include <jccl/Config/ConfigElement.h>
 #include <gadget/Type/DeviceConstructor.h>
 #include <gadget/Util/Debug.h>
+#include <gadget/Util/IOReactor.h>
 #include <gadget/gadgetParam.h>
 
 #include <drivers/Open/TUIO/Tuio.h>
@@ -66,7 +66,6 @@ namespace gadget
 * Constructor.
 */
 Tuio::Tuio()
- : mDone(false)
 {
    mAnalog.push_back(0.0f);
    mDigital.push_back(gadget::DigitalState::OFF);
@@ -102,17 +101,10 @@ bool Tuio::config(jccl::ConfigElementPtr e)
    return true;
 }
 
-/** Main thread of control for this active object. */
-void Tuio::controlLoop()
-{  
-   // Loop through and keep sampling until stopSampling is called.
-   while (!mDone)
-   {
-      this->sample();
-
-      // Limit sampling to 100 Hz
-      vpr::System::msleep(10);
-   }
+void Tuio::handleData(const vpr::Interval& arrival)
+{
+   mSampleTime = arrival;
+   this->sample();
 }
 
 bool Tuio::startSampling()
@@ -126,16 +118,6 @@ bool Tuio::startSampling()
       return false;
    }
 
-   // Ensure that the thread has not already started.
-   if (mThread != NULL)
-   {
-      vprDEBUG(vprDBG_ERROR,vprDBG_CRITICAL_LVL)
-         << clrOutNORM(clrRED,"ERROR:")
-         << " gadget::Tuio::startSampling() called, when already "
-         << "sampling.\n" << vprDEBUG_FLUSH;
-      return false;
-   }
-
    // Initialize data
    for (unsigned int i = 0; i < mDigital.size(); i++)
    {
@@ -151,7 +133,7 @@ bool Tuio::startSampling()
    addAnalogSample(mAnalog);
 
    // Open the connection to the tracker
-   mTracker.open(mPort);
+   mTracker.open(mPort, mDigital.size());
    if (!this->isActive())
    {
       vprDEBUG(vprDBG_ERROR,vprDBG_CRITICAL_LVL)
@@ -161,24 +143,24 @@ bool Tuio::startSampling()
       return false;
    }
 
-   // Set flag that will later allow us to stop the control loop.
-   mDone = false;
-
    bool started(true);
 
-   // Create a new thread to handle the control
+   // Have the shared I/O thread sample the data as it arrives.
    try
    {
-      mThread = new vpr::Thread(boost::bind(&Tuio::controlLoop, this));
+      IOReactor::instance()->registerHandle(
+         mTracker.getHandle(), boost::bind(&Tuio::handleData, this, _1)
+      );
    }
    catch (vpr::Exception& ex)
    {
       vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CRITICAL_LVL)
          << clrOutBOLD(clrRED, "ERROR")
-         << ": Failed to spawn thread for Tuio driver!\n"
+         << ": Failed to start I/O thread for Tuio driver!\n"
          << vprDEBUG_FLUSH;
       vprDEBUG_NEXT(gadgetDBG_INPUT_MGR, vprDBG_CRITICAL_LVL)
          << ex.what() << std::endl << vprDEBUG_FLUSH;
+      mTracker.close();
       started = false;
    }
 
@@ -193,61 +175,37 @@ bool Tuio::sample()
       return false;
    }
 
-   // Check to see if we have new data to pull
-   bool receivedData = false;
-   while (mTracker.updateData())
-   {
-      receivedData = true;
-   }
-   
-   if (!receivedData)
-   {
-      return false;
-   }
-
-   std::list<TuioPoint*>points = mTracker.points();
+   bool sampled(false);
 
-   for (unsigned int i = 0; i < mDigital.size(); i++)
+   // Publish one sample for every complete frame.
+   while (mTracker.updateData())
    {
-      mDigital[i] = gadget::DigitalState::OFF;
-      mDigital[i].setTime();
+      const std::vector<TuioPoint>& cursors = mTracker.getCursors();
 
-      mAnalog[2*i].setValue(0.0f);
-      mAnalog[2*i].setTime();
-
-      mAnalog[2*i + 1].setValue(0.0f);
-      mAnalog[2*i + 1].setTime();
-   }
+      for (unsigned int i = 0; i < mDigital.size(); i++)
+      {
+         const TuioPoint& cursor = cursors[i];
+         const bool down =
+            cursor.getSessionID() != TuioStandalone::FREE_SESSION;
 
-   for (std::list<TuioPoint*>::iterator pointIter = points.begin();
-        pointIter != points.end();
-        pointIter++)
+         mDigital[i] = down ? gadget::DigitalState::ON
+                            : gadget::DigitalState::OFF;
+         mDigital[i].setTime(mSampleTime);
 
-   {
-      unsigned int cursorID = (*pointIter)->getPointID();
+         // Set first analog to x value and second analog to y value
+         mAnalog[2*i].setValue(down ? cursor.getXpos() : 0.0f);
+         mAnalog[2*i].setTime(mSampleTime);
 
-      // Check if we have more points than configured for
-      if (cursorID >= mDigital.size())
-      {
-         break;
+         mAnalog[2*i + 1].setValue(down ? cursor.getYpos() : 0.0f);
+         mAnalog[2*i + 1].setTime(mSampleTime);
       }
-	  
-      mDigital[cursorID] = gadget::DigitalState::ON;
-      mDigital[cursorID].setTime();
-      
-      // Set first analog to x value
-      mAnalog[2*cursorID].setValue((*pointIter)->getXpos());
-      mAnalog[2*cursorID].setTime();
 
-      // Set second analog to y value
-      mAnalog[2*cursorID + 1].setValue((*pointIter)->getYpos());
-      mAnalog[2*cursorID + 1].setTime();
+      addDigitalSample(mDigital);
+      addAnalogSample(mAnalog);
+      sampled = true;
    }
 
-   addDigitalSample(mDigital);
-   addAnalogSample(mAnalog);
-    
-   return true;
+   return sampled;
 }
 
 bool Tuio::stopSampling()
@@ -255,41 +213,32 @@ bool Tuio::stopSampling()
    // Make sure that we are sampling in the first place.
    if (!isActive())
    {
-      mDone = true; // just to be safe 
       return false;
    }
 
-   if (mThread != NULL)
-   {
-      vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL)
-         << "[gadget::Tuio::stopSampling()] Stopping the Tuio "
-         << "thread...\n" << vprDEBUG_FLUSH;
-
-      // Set the done flag to attempt to cause the control loop to exit
-      // naturally.
-      mDone = true;
+   vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL)
+      << "[gadget::Tuio::stopSampling()] Stopping the Tuio "
+      << "driver...\n" << vprDEBUG_FLUSH;
 
-      mThread->join();
-      delete mThread;
-      mThread = NULL;
+   // No callback is running once this returns.
+   IOReactor::instance()->unregisterHandle(mTracker.getHandle());
 
-      // Close the connection to the tracker
-      mTracker.close();
-
-      // If the tracker failed to stop
-      if (isActive() == true)
-      {
-         vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CRITICAL_LVL)
-            << clrOutNORM(clrRED,"\nERROR:")
-            << " [gadget::Tuio::stopSampling()] Tuio tracker "
-            << "failed to stop.\n" << vprDEBUG_FLUSH;
-         return false;
-      }
+   // Close the connection to the tracker
+   mTracker.close();
 
-      vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL)
-         << "*** Tuio has been shutdown. ***" << std::endl
-         << vprDEBUG_FLUSH;
+   // If the tracker failed to stop
+   if (isActive() == true)
+   {
+      vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CRITICAL_LVL)
+         << clrOutNORM(clrRED,"\nERROR:")
+         << " [gadget::Tuio::stopSampling()] Tuio tracker "
+         << "failed to stop.\n" << vprDEBUG_FLUSH;
+      return false;
    }
+
+   vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL)
+      << "*** Tuio has been shutdown. ***" << std::endl
+      << vprDEBUG_FLUSH;
    
    return true;
 }
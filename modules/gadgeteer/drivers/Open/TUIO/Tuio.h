@@ -32,7 +32,7 @@
 #include <boost/mpl/inherit.hpp>
 
 #include <vector>
-#include <vpr/Thread/Thread.h>
+#include <vpr/Util/Interval.h>
 
 #include <gadget/Type/InputDevice.h>
 
@@ -54,12 +54,12 @@ public:
     */
    virtual bool config(jccl::ConfigElementPtr e);
 
-   /** Begins sampling. */
+   /**
+    * Begins sampling.  The socket is watched by gadget::IOReactor, so data is
+    * sampled as soon as it arrives.
+    */
    bool startSampling();
 
-   /** Main thread of control for this active object. */
-   void controlLoop();
-   
    /** Stops sampling. */
    bool stopSampling();
 
@@ -90,9 +90,12 @@ public:
    }
 
 private:
+   /** Called by gadget::IOReactor when a TUIO packet has arrived. */
+   void handleData(const vpr::Interval& arrival);
+
    TuioStandalone mTracker;    /**< The tracker class to read data from. */
    int mPort;                       /**< Port to bind to. */
-   bool mDone;                      /**< Boolean to control thread exit. */
+   vpr::Interval mSampleTime;       /**< Arrival time of the current data. */
    std::vector<gadget::AnalogData> mAnalog; /**< Analog data from Tuio. */
    std::vector<gadget::DigitalData> mDigital;
 };
@@ -29,52 +29,52 @@
 class TuioPoint
 {
 public:
-   int getSessionID()
+   int getSessionID() const
    {
       return mSessionID;
    }
 
-   int getPointID()
+   int getPointID() const
    {
       return mPointID;
    }
 
-   float getXpos()
+   float getXpos() const
    {
       return mXpos;
    }
 
-   float getYpos()
+   float getYpos() const
    {
       return mYpos;
    }
 
-   float getAngle()
+   float getAngle() const
    {
       return mAngle;
    }
 
-   float getXvel()
+   float getXvel() const
    {
       return mXvel;
    }
 
-   float getYvel()
+   float getYvel() const
    {
       return mYvel;
    }
 
-   float getRotVel()
+   float getRotVel() const
    {
       return mAngle;
    }
 
-   float getMotAccel()
+   float getMotAccel() const
    {
       return mMotAccel;
    }
 
-   float getRotAccel()
+   float getRotAccel() const
    {
       return mRotAccel;
    }
@@ -24,17 +24,68 @@
  *
  *************** <auto-copyright.pl END do not edit this line> ***************/
 
+#include <cstring>
+#include <algorithm>
+
 #include <drivers/Open/TUIO/TuioStandalone.h>
 
 using namespace vpr;
 using namespace osc;
 
+namespace
+{
+
+/** Largest UDP payload. */
+const std::size_t MAX_DATAGRAM_SIZE(65536);
+
+/**
+ * A frame that is further than this behind the newest frame is taken to mean
+ * that the tracker restarted, not that the frame is late.
+ */
+const Int32 MAX_FRAME_LAG(100);
+
+const char* const CURSOR_PROFILE("/tuio/2Dcur");
+
+/**
+ * Reads the frame sequence number if \p msg is a /tuio/2Dcur "fseq" message.
+ */
+bool readFrame(const ReceivedMessage& msg, Int32& frame)
+{
+   if (0 != std::strcmp(msg.AddressPattern(), CURSOR_PROFILE))
+   {
+      return false;
+   }
+
+   ReceivedMessageArgumentStream argStream = msg.ArgumentStream();
+   const char* cmd;
+   argStream >> cmd;
+   if (0 != std::strcmp(cmd, "fseq"))
+   {
+      return false;
+   }
+
+   int32 fseq;
+   argStream >> fseq;
+   frame = fseq;
+   return true;
+}
+
+}
+
+const int TuioStandalone::FREE_SESSION;
+const int TuioStandalone::UNNUMBERED_FRAME;
+
 TuioStandalone::TuioStandalone() :
-mActive(false)
+mActive(false),
+mBuffer(MAX_DATAGRAM_SIZE),
+mBytes(0),
+mBundleFrame(0),
+mFrame(0),
+mNewestFrame(0)
 {
 }
 
-bool TuioStandalone::open(int port)
+bool TuioStandalone::open(int port, unsigned int maxCursors)
 {
    mPort = port;
 
@@ -44,6 +95,14 @@ bool TuioStandalone::open(int port)
    }
    else
    {
+      mCursors.clear();
+      for (unsigned int i = 0; i < maxCursors; ++i)
+      {
+         mCursors.push_back(TuioPoint(FREE_SESSION, i));
+      }
+      mAlive.assign(maxCursors, 0);
+      mFrame       = 0;
+      mNewestFrame = 0;
 
       InetAddr myAddr;
 
@@ -79,190 +138,239 @@ bool TuioStandalone::close()
 
 bool TuioStandalone::updateData()
 {
-   char szData[20000];
+   while (receive())
+   {
+      try
+      {
+         const ReceivedPacket packet(&mBuffer[0], mBytes);
+         processBundle(ReceivedBundle(packet));
+      }
+      catch (osc::Exception& e)
+      {
+         std::cerr << "\tMalformed OSC bundle: " << e.what() << std::endl;
+      }
+
+      if (UNNUMBERED_FRAME != mBundleFrame)
+      {
+         mFrame = mBundleFrame;
+         if (mFrame > 0)
+         {
+            mNewestFrame = mFrame;
+         }
+         return true;
+      }
+   }
+
+   return false;
+}
+
+bool TuioStandalone::receive()
+{
    InetAddr theirAddr;
-   const Interval timeout(10, Interval::Msec);
-   Uint32 bytes = 0;
-   try
+
+   // Skip anything that is not a TUIO cursor bundle or that belongs to a
+   // late frame.
+   while (true)
    {
-      bytes = mSocket->recvfrom(szData, sizeof(szData), theirAddr, Interval::NoWait);
+      try
+      {
+         mBytes = mSocket->recvfrom(&mBuffer[0], mBuffer.size(), theirAddr,
+                                    Interval::NoWait);
+      }
+      catch (TimeoutException&)
+      {
+         return false;
+      }
+
+      if (0 == mBytes)
+      {
+         return false;
+      }
+
+      try
+      {
+         const ReceivedPacket packet(&mBuffer[0], mBytes);
+         if (packet.IsBundle() &&
+             findFrame(ReceivedBundle(packet), mBundleFrame) &&
+             !isLate(mBundleFrame))
+         {
+            return true;
+         }
+      }
+      catch (osc::Exception& e)
+      {
+         std::cerr << "\tMalformed OSC bundle: " << e.what() << std::endl;
+      }
    }
-   catch (TimeoutException& ex)
+}
+
+bool TuioStandalone::findFrame(const ReceivedBundle& bundle, Int32& frame)
+{
+   // TUIO puts the fseq message last, so that one is checked first.  Walking
+   // to it only follows the element sizes.
+   ReceivedBundle::const_iterator last = bundle.ElementsEnd();
+   for (ReceivedBundle::const_iterator i = bundle.ElementsBegin();
+        i != bundle.ElementsEnd(); ++i)
    {
-      return false;
+      last = i;
    }
 
-   if (bytes > 0)
+   if (last != bundle.ElementsEnd() && !last->IsBundle() &&
+       readFrame(ReceivedMessage(*last), frame))
    {
-      const ReceivedPacket * oscPacket = new ReceivedPacket(szData, bytes);
-      ReceivedBundle * oscBundle = new  ReceivedBundle(*oscPacket);
-      ProcessBundle(*oscBundle);
       return true;
    }
 
+   for (ReceivedBundle::const_iterator i = bundle.ElementsBegin();
+        i != bundle.ElementsEnd(); ++i)
+   {
+      if (!i->IsBundle() && readFrame(ReceivedMessage(*i), frame))
+      {
+         return true;
+      }
+   }
+
    return false;
 }
 
-void TuioStandalone::ProcessBundle(const ReceivedBundle& bundle)
+void TuioStandalone::processBundle(const ReceivedBundle& bundle)
 {
-   try
+   for (ReceivedBundle::const_iterator i = bundle.ElementsBegin();
+        i != bundle.ElementsEnd(); ++i)
    {
-      for (ReceivedBundle::const_iterator i = bundle.ElementsBegin();
-           i != bundle.ElementsEnd(); ++i)
+      if (i->IsBundle())
       {
-         if (i->IsBundle())
-         {
-            ProcessBundle(ReceivedBundle(*i));
-         }
-         else
-         {
-            ProcessMessage(ReceivedMessage(*i));
-         }
+         processBundle(ReceivedBundle(*i));
+      }
+      else
+      {
+         processMessage(ReceivedMessage(*i));
       }
-   }
-   catch (vpr::Exception& e)
-   {
-      std::cerr << "\tMalformed OSC bundle: " << e.what() << std::endl;
    }
 }
 
-void TuioStandalone::ProcessMessage(const ReceivedMessage& msg)
+void TuioStandalone::processMessage(const ReceivedMessage& msg)
 {
    try
    {
+      if (0 != std::strcmp(msg.AddressPattern(), CURSOR_PROFILE))
+      {
+         return;
+      }
+
       ReceivedMessageArgumentStream argStream = msg.ArgumentStream();
+      const char* cmd;
+      argStream >> cmd;
 
-      if (0 == strcmp(msg.AddressPattern(), "/tuio/2Dcur"))
+      if (0 == std::strcmp(cmd, "set"))
       {
-         const char* cmd;
-         argStream >> cmd;
-         if (0 == strcmp(cmd, "alive"))
-         {
-            int32 sessionID;
-
-            // Add alive sessions to mAliveSessions and add any new sessions to mPoints.
-            mAliveSessions.clear();
-            while(!argStream.Eos())
-            {
-               argStream >> sessionID;
-               if (!findSession(sessionID))
-               {
-                  int pointID = getLowestAvailID();
-                  TuioPoint * newPoint = new TuioPoint(sessionID, pointID);
-                  mPoints.push_back(newPoint);
-               }
-               mAliveSessions.push_back(sessionID);
-            }
-            // Remove any points from mPoints that are no longer alive.
-            std::list<TuioPoint*>::iterator pointIter = mPoints.begin();
-            while (pointIter != mPoints.end())
-            {
-               if (!findAliveSession((*pointIter)->getSessionID()))
-               {
-                  // No longer alive, remove point
-                  pointIter = mPoints.erase(pointIter);
-               }
-               else
-               {
-                  ++pointIter;
-               }
-            }
-         }
-         else if (0 == strcmp(cmd, "set"))
-         {
-            int32 sessionID;
-            float xpos, ypos, xspeed, yspeed, maccel;
-            argStream >> sessionID >> xpos >> ypos >> xspeed >> yspeed >> maccel;
+         int32 sessionID;
+         float xpos, ypos, xspeed, yspeed, maccel;
+         argStream >> sessionID >> xpos >> ypos >> xspeed >> yspeed >> maccel;
 
-            TuioPoint * point = getPoint(sessionID);
-            point->update(sessionID, xpos, ypos, xspeed, yspeed, maccel);
-         }
-         else if (0 == strcmp(cmd, "fseq"))
+         const int slot =
+            FREE_SESSION != sessionID ? findSlot(sessionID) : -1;
+         if (slot >= 0)
          {
-            int32 fseq;
-            argStream >> fseq;
+            mCursors[slot].update(sessionID, xpos, ypos, xspeed, yspeed,
+                                  maccel);
          }
       }
+      else if (0 == std::strcmp(cmd, "alive"))
+      {
+         processAlive(argStream);
+      }
    }
-   catch (vpr::Exception& e)
+   catch (osc::Exception& e)
    {
       std::cerr << "error parsing TUIO message: "<< msg.AddressPattern() <<  " - " << e.what() << std::endl;
    }
 }
 
-long TuioStandalone::getLowestAvailID()
+void TuioStandalone::processAlive(ReceivedMessageArgumentStream& argStream)
 {
-   int min = 0;
-   bool found = false;
+   std::fill(mAlive.begin(), mAlive.end(), 0);
 
-   std::list<TuioPoint*>::iterator pointIter;
-
-   while (!found)
+   // Mark the sessions that already have a slot.
+   ReceivedMessageArgumentStream sessions(argStream);
+   bool new_sessions(false);
+   while (!sessions.Eos())
    {
-      pointIter = mPoints.begin();
-      if (pointIter != mPoints.end())
+      int32 sessionID;
+      sessions >> sessionID;
+      if (FREE_SESSION == sessionID)
       {
-         while (pointIter != mPoints.end())
-         {
-            if (min == (*pointIter)->getPointID())
-            {
-               min++;
-               found = false;
-               break;
-            }
-            else
-            {
-               found = true;
-               ++pointIter;
-            }
-         }
+         continue;
+      }
+
+      const int slot = findSlot(sessionID);
+      if (slot >= 0)
+      {
+         mAlive[slot] = 1;
       }
       else
       {
-         break;
+         new_sessions = true;
       }
    }
-   return min;
-}
 
-bool TuioStandalone::findSession(long sessionID)
-{
-   bool found = false;
-   std::list<TuioPoint*>::iterator pointIter;
-   for (pointIter = mPoints.begin(); pointIter != mPoints.end(); pointIter++)
+   if (new_sessions)
    {
-      if (sessionID == (*pointIter)->getSessionID())
+      // New sessions get the lowest free point IDs.  They are given out
+      // before the sessions that are gone free their slots so that a point
+      // ID passes from one session to another within a frame only when the
+      // table is full.
+      addSessions(argStream);
+   }
+
+   bool freed(false);
+   for (unsigned int i = 0; i < mCursors.size(); ++i)
+   {
+      if (!mAlive[i] && FREE_SESSION != mCursors[i].getSessionID())
       {
-         found = true;
-         break;
+         mCursors[i] = TuioPoint(FREE_SESSION, i);
+         freed = true;
       }
    }
-   return found;
+
+   if (new_sessions && freed)
+   {
+      addSessions(argStream);
+   }
 }
 
-bool TuioStandalone::findAliveSession(long sessionID)
+void TuioStandalone::addSessions(ReceivedMessageArgumentStream argStream)
 {
-   bool found = false;
-   std::list<long>::iterator sessionIter;
-   for (sessionIter = mAliveSessions.begin(); sessionIter != mAliveSessions.end(); sessionIter++)
+   int free_slot = findSlot(FREE_SESSION);
+
+   while (free_slot >= 0 && !argStream.Eos())
    {
-      if (sessionID == (*sessionIter))
+      int32 sessionID;
+      argStream >> sessionID;
+
+      if (FREE_SESSION != sessionID && findSlot(sessionID) < 0)
       {
-         found = true;
-         break;
+         mCursors[free_slot] = TuioPoint(sessionID, free_slot);
+         mAlive[free_slot] = 1;
+         free_slot = findSlot(FREE_SESSION);
       }
    }
-   return found;
 }
 
-TuioPoint * TuioStandalone::getPoint(long sessionID)
+int TuioStandalone::findSlot(Int32 sessionID) const
 {
-   for (std::list<TuioPoint*>::iterator pointIter = mPoints.begin(); pointIter != mPoints.end(); pointIter++)
+   for (unsigned int i = 0; i < mCursors.size(); ++i)
    {
-      if (sessionID == (*pointIter)->getSessionID())
+      if (sessionID == mCursors[i].getSessionID())
       {
-         return (*pointIter);
+         return i;
       }
    }
-   return NULL;
+   return -1;
+}
+
+bool TuioStandalone::isLate(Int32 frame) const
+{
+   return frame > 0 && frame < mNewestFrame &&
+          mNewestFrame - frame <= MAX_FRAME_LAG;
 }
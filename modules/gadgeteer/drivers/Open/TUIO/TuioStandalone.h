@@ -32,48 +32,123 @@
 #include <vpr/IO/Socket/SocketDatagram.h>
 #include <vpr/Util/Interval.h>
 #include <vpr/IO/TimeoutException.h>
-#include <list>
+#include <vector>
 
 #include "oscpack/osc/OscReceivedElements.h"
 #include "TuioPoint.h"
 
 #define DEFAULT_PORT 3333
 
+/**
+ * Receives /tuio/2Dcur cursors over UDP.
+ *
+ * Each datagram is received into a buffer owned by this object and the OSC
+ * bundle is parsed in place; no per-packet or per-cursor objects are
+ * allocated.  Cursors are kept in a fixed-capacity table in which the index
+ * of a cursor is its point ID.  A session gets the lowest free slot when it
+ * first shows up in an "alive" message, and it keeps that slot until it is
+ * no longer alive.  Sessions that do not fit are ignored until a slot frees
+ * up.
+ */
 class TuioStandalone
 {
 public:
    TuioStandalone();
    ~TuioStandalone() {;}
 
-   bool open(int port);
+   /**
+    * Binds to the given UDP port.
+    *
+    * @param port       The port to listen on.
+    * @param maxCursors The capacity of the cursor table.
+    */
+   bool open(int port, unsigned int maxCursors);
    bool close();
 
+   /**
+    * Processes the datagrams waiting on the socket until a frame is
+    * complete.  Trackers end each frame with a bundle that carries its frame
+    * sequence number ("fseq").  Bundles with the frame number
+    * TuioStandalone::UNNUMBERED_FRAME are the leading parts of a frame that
+    * did not fit in one datagram or repeats of the current state.  They are
+    * applied, and the result is reported with the next numbered frame.
+    * Bundles for frames older than the newest one seen are dropped.
+    *
+    * @return true if a frame was completed.  The cursor table then holds the
+    *         state as of that frame.  false if no more data is waiting.
+    */
    bool updateData();
 
    bool isActive()
    {
       return mActive;
    }
-   std::list<TuioPoint*> points()
+
+   /** Returns the handle of the UDP socket (valid while active). */
+   vpr::IOSys::Handle getHandle() const
+   {
+      return mSocket->getHandle();
+   }
+
+   /**
+    * Returns the cursor table.  The index of an entry is its point ID.  Free
+    * entries have the session ID TuioStandalone::FREE_SESSION.
+    */
+   const std::vector<TuioPoint>& getCursors() const
+   {
+      return mCursors;
+   }
+
+   /** Returns the frame sequence number of the last completed frame. */
+   vpr::Int32 getFrame() const
    {
-      return mPoints;
+      return mFrame;
    }
 
+   static const int FREE_SESSION = -1;
+   static const int UNNUMBERED_FRAME = -1;
+
 private:
-   void ProcessBundle(const osc::ReceivedBundle& bundle);
-   void ProcessMessage(const osc::ReceivedMessage& msg);
-   long getLowestAvailID();
-   bool findSession(long sessionID);
-   bool findAliveSession(long sessionID);
-   TuioPoint * getPoint(long sessionID);
+   /**
+    * Receives the next cursor bundle into mBuffer and finds its frame
+    * sequence number.  Returns false if no more data is waiting.
+    */
+   bool receive();
+
+   /**
+    * Finds the frame sequence number of the bundle.  Returns false if the
+    * bundle does not contain a /tuio/2Dcur "fseq" message.
+    */
+   bool findFrame(const osc::ReceivedBundle& bundle, vpr::Int32& frame);
+
+   void processBundle(const osc::ReceivedBundle& bundle);
+   void processMessage(const osc::ReceivedMessage& msg);
+   void processAlive(osc::ReceivedMessageArgumentStream& args);
+
+   /** Gives the new sessions named in an alive message free slots. */
+   void addSessions(osc::ReceivedMessageArgumentStream args);
+
+   /** Returns the slot of the given session or -1 if it has none. */
+   int findSlot(vpr::Int32 sessionID) const;
+
+   /** Returns true if the frame is older than the newest one seen. */
+   bool isLate(vpr::Int32 frame) const;
 
    bool                 mActive;  /**< If the driver is active. */
    int                  mPort;
    vpr::SocketDatagram  *mSocket;
    vpr::InetAddr        mAddress; /**< Address of TUIO device. */
 
-   std::list<long>		mAliveSessions;
-   std::list<long>		mAliveIDs;
-   std::list<TuioPoint*> mPoints;
+   /** @name Receive buffer */
+   //@{
+   std::vector<char>    mBuffer;
+   vpr::Uint32          mBytes;     /**< Size of the datagram in mBuffer. */
+   vpr::Int32           mBundleFrame; /**< Frame of the bundle in mBuffer. */
+   //@}
+
+   std::vector<TuioPoint> mCursors; /**< Cursor table indexed by point ID. */
+   std::vector<char>    mAlive;     /**< Per slot: named in the current alive. */
+   vpr::Int32           mFrame;     /**< Last completed frame. */
+   vpr::Int32           mNewestFrame; /**< Newest positive frame seen. */
 };
-#endif
\ No newline at end of file
+#endif
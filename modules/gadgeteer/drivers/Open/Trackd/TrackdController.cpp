@@ -25,6 +25,7 @@
  *************** <auto-copyright.pl END do not edit this line> ***************/
 
 #include <gadget/Devices/DriverConfig.h>
+#include <algorithm>
 #include <vpr/Util/Debug.h>
 #include <jccl/Config/ConfigElement.h>
 #include <gadget/gadgetParam.h>
@@ -119,20 +120,30 @@ bool TrackdController::config(jccl::ConfigElementPtr e)
 void TrackdController::updateData()
 {
    vprASSERT(mTrackdController != NULL && "Make sure that trackd controller has been initialized");
-   vprASSERT((unsigned)mTrackdController->numButtons() <= mCurButtons.size());
-   vprASSERT((unsigned)mTrackdController->numValuators() <= mCurValuators.size() );
 
-   for (int i=0;i<mTrackdController->numButtons();i++)
+   // Copy all inputs at once so that trackd cannot change them while they
+   // are being read.  Without a consistent copy, the last values are kept.
+   if ( mTrackdController->sample() )
    {
-      mCurButtons[i] =
-         static_cast<DigitalState::State>(mTrackdController->getButton(i));
-      mCurButtons[i].setTime();
-   }
-
-   for (int j=0;j<mTrackdController->numValuators();j++)
-   {
-       mCurValuators[j] = mTrackdController->getValuator(j);
-       mCurValuators[j].setTime();
+      const int num_buttons =
+         std::min((int) mCurButtons.size(),
+                  mTrackdController->numSampledButtons());
+      const int num_valuators =
+         std::min((int) mCurValuators.size(),
+                  mTrackdController->numSampledValuators());
+
+      for (int i=0;i<num_buttons;i++)
+      {
+         mCurButtons[i] =
+            static_cast<DigitalState::State>(mTrackdController->getButton(i));
+         mCurButtons[i].setTime();
+      }
+
+      for (int j=0;j<num_valuators;j++)
+      {
+          mCurValuators[j] = mTrackdController->getValuator(j);
+          mCurValuators[j].setTime();
+      }
    }
 
    addDigitalSample(mCurButtons);
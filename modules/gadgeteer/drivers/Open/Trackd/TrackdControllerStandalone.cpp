@@ -14,17 +14,40 @@ int TrackdControllerStandalone::numValuators()
    return trackd_controller_num_valuators(mCon);
 }
 
+bool TrackdControllerStandalone::sample()
+{
+   assert(mCon != NULL);
+
+   // One extra element keeps the pointers valid when there is no input.
+   mButtonScratch.resize(numButtons() + 1);
+   mValuatorScratch.resize(numValuators() + 1);
+
+   if ( trackd_controller_snapshot(mCon, &mButtonScratch[0],
+                                   mButtonScratch.size() - 1,
+                                   &mValuatorScratch[0],
+                                   mValuatorScratch.size() - 1) < 0 )
+   {
+      return false;
+   }
+
+   mButtonScratch.pop_back();
+   mValuatorScratch.pop_back();
+   mButtons.swap(mButtonScratch);
+   mValuators.swap(mValuatorScratch);
+   return true;
+}
+
 /** Returns the value of the button. */
 int TrackdControllerStandalone::getButton(int btnNum)
 {
-   assert(mCon != NULL);
-   return trackd_controller_button(mCon, btnNum);
+   assert(btnNum < numSampledButtons() && "Out of bounds request for a button");
+   return mButtons[btnNum];
 }
 
 float TrackdControllerStandalone::getValuator(int valNum)
 {
-   assert(mCon != NULL);
-   return trackd_controller_valuator(mCon, valNum);
+   assert(valNum < numSampledValuators() && "Out of bounds request for a valuator");
+   return mValuators[valNum];
 }
 
 /**
@@ -2,6 +2,7 @@
 #define _GADGET_TRACKD_CONTROLLER_STANDALONE_H_
 
 #include <stdlib.h>
+#include <vector>
 #include <drivers/Open/Trackd/trackdmem.h>
 
 class TrackdControllerStandalone
@@ -24,7 +25,24 @@ public:
    int numButtons();
    int numValuators();
 
-   /** Returns the value of the button. */
+   /**
+    * Copies all buttons and valuators out of the shared memory in one pass.
+    * If trackd kept changing the data and no consistent copy could be made,
+    * false is returned and the previous copy is kept.
+    */
+   bool sample();
+
+   /** Gets the number of input values copied by the last sample(). */
+   int numSampledButtons() const
+   {
+      return mButtons.size();
+   }
+   int numSampledValuators() const
+   {
+      return mValuators.size();
+   }
+
+   /** Returns the value of the button as of the last sample(). */
    int getButton(int btnNum);
 
    float getValuator(int valNum);
@@ -42,6 +60,11 @@ protected:
 private:
    int                   mShmKey;       /**< The key to the shared memory area. */
    ControllerConnection* mCon;          /**< The connection info. */
+
+   std::vector<int>      mButtons;      /**< Last consistent copy. */
+   std::vector<float>    mValuators;    /**< Last consistent copy. */
+   std::vector<int>      mButtonScratch;   /**< Copy being made. */
+   std::vector<float>    mValuatorScratch; /**< Copy being made. */
 };
 
 
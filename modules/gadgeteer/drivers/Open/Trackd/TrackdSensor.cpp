@@ -25,6 +25,7 @@
  *************** <auto-copyright.pl END do not edit this line> ***************/
 
 #include <gadget/Devices/DriverConfig.h>
+#include <algorithm>
 #include <drivers/Open/Trackd/TrackdSensorStandalone.h>
 #include <drivers/Open/Trackd/TrackdSensor.h>
 #include <jccl/Config/ConfigElement.h>
@@ -101,12 +102,21 @@ std::string TrackdSensor::getElementType()
  void TrackdSensor::updateData()
  {
     vprASSERT(mTrackdSensors != NULL && "Make sure that trackd sensors has been initialized");
-    vprASSERT((unsigned)mTrackdSensors->numSensors() <= mCurSensorValues.size());
 
-    for(int i=0;i<mTrackdSensors->numSensors();i++)
+    // Copy all sensors at once so that trackd cannot change a pose while it
+    // is being read.  Without a consistent copy, the last values are kept.
+    if ( mTrackdSensors->sample() )
     {
-       mCurSensorValues[i].setValue(mTrackdSensors->getSensorPos(i));
-       mCurSensorValues[i].setTime();
+       const unsigned int count =
+          std::min(mCurSensorValues.size(),
+                   (std::vector<PositionData>::size_type)
+                      mTrackdSensors->numSampledSensors());
+
+       for(unsigned int i=0;i<count;i++)
+       {
+          mCurSensorValues[i].setValue(mTrackdSensors->getSensorPos(i));
+          mCurSensorValues[i].setTime();
+       }
     }
 
     // Update the data buffer
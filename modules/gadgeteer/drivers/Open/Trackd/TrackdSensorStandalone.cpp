@@ -14,14 +14,30 @@ int TrackdSensorStandalone::numSensors()
    return trackd_tracker_num_sensors(mTrack);
 }
 
+bool TrackdSensorStandalone::sample()
+{
+   assert(mTrack != NULL && "We don't have a valid trackd memory area");
+
+   mScratch.resize(numSensors());
+   const int count = mScratch.empty() ? 0 :
+      trackd_tracker_snapshot(mTrack, &mScratch[0], mScratch.size());
+
+   if ( count < 0 )
+   {
+      return false;
+   }
+
+   mScratch.resize(count);
+   mSensors.swap(mScratch);
+   return true;
+}
+
 // Return the position of the given sensor
 gmtl::Matrix44f TrackdSensorStandalone::getSensorPos(int sensorNum)
 {
-   assert(mTrack != NULL && "We don't have a valid trackd memory area");
-   assert(sensorNum < numSensors() && "Out of bounds request for a sensor");
+   assert(sensorNum < numSampledSensors() && "Out of bounds request for a sensor");
 
-   CAVE_SENSOR_ST* sensor_val;
-   sensor_val = trackd_tracker_sensor(mTrack, sensorNum);
+   const CAVE_SENSOR_ST* sensor_val = &mSensors[sensorNum];
 
    // For Anthony Steed
    gmtl::Matrix44f ret_val;
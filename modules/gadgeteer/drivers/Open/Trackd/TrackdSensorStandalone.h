@@ -1,6 +1,7 @@
 #ifndef _GADGET_TRACKD_SENSOR_STANDALONE_H_
 #define _GADGET_TRACKD_SENSOR_STANDALONE_H_
 
+#include <vector>
 #include <drivers/Open/Trackd/trackdmem.h>
 #include <gmtl/Matrix.h>
 
@@ -23,7 +24,20 @@ public:
    /** Gets the number of sensors. */
    int numSensors();
 
-   /** Returns the position of the given sensor. */
+   /**
+    * Copies the data of all sensors out of the shared memory in one pass.
+    * If trackd kept changing the data and no consistent copy could be made,
+    * false is returned and the previous copy is kept.
+    */
+   bool sample();
+
+   /** Gets the number of sensors copied by the last sample(). */
+   int numSampledSensors() const
+   {
+      return mSensors.size();
+   }
+
+   /** Returns the position of the given sensor as of the last sample(). */
    gmtl::Matrix44f getSensorPos(int sensorNum);
 
 protected:
@@ -39,6 +53,9 @@ protected:
 private:
    int                mShmKey;       /**< The key to the shared memory area. */
    TrackerConnection* mTrack;        /**< The tracker info. */
+
+   std::vector<CAVE_SENSOR_ST> mSensors;  /**< Last consistent copy. */
+   std::vector<CAVE_SENSOR_ST> mScratch;  /**< Copy being made. */
 };
 
 #endif
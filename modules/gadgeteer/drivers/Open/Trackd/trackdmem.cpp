@@ -4,6 +4,7 @@
 //
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <drivers/Open/Trackd/trackdmem.h>
 
@@ -12,6 +13,24 @@
 #include <sys/shm.h>
 #endif
 
+// Orders the reads of a copy against the reads that validate it.  This is
+// also what keeps the compiler from assuming the segment is unchanged.
+static inline void
+trackd_barrier()
+{
+#if defined(VPR_OS_Windows)
+   MemoryBarrier();
+#else
+   __sync_synchronize();
+#endif
+}
+
+static inline int
+trackd_min(int a, int b)
+{
+   return a < b ? a : b;
+}
+
 // ===========================================================================
 // trackd tracker API
 
@@ -122,6 +141,48 @@ trackd_tracker_sensor(TrackerConnection* t, int sensorNum)
    return reinterpret_cast<CAVE_SENSOR_ST*>(pointer);
 }
 
+int
+trackd_tracker_snapshot(TrackerConnection* t, CAVE_SENSOR_ST* sensors,
+                        int maxSensors)
+{
+   const unsigned char* base =
+      reinterpret_cast<const unsigned char*>(t->tracker);
+
+   for ( int attempt = 0; attempt < TRACKD_SNAPSHOT_TRIES; ++attempt )
+   {
+      const uint32_t stamp[2] =
+         { t->tracker->timestamp[0], t->tracker->timestamp[1] };
+      const int count = trackd_min(t->tracker->numSensors, maxSensors);
+      const uint32_t stride = t->tracker->sensorSize;
+      const size_t size = trackd_min(stride, sizeof(CAVE_SENSOR_ST));
+      const unsigned char* first = base + t->tracker->sensorOffset;
+
+      for ( int i = 0; i < count; ++i )
+      {
+         memcpy(&sensors[i], first + i * stride, size);
+      }
+
+      trackd_barrier();
+
+      // The copy is consistent if nothing it was made from has changed.
+      bool changed = stamp[0] != t->tracker->timestamp[0] ||
+                     stamp[1] != t->tracker->timestamp[1] ||
+                     count != trackd_min(t->tracker->numSensors, maxSensors);
+
+      for ( int i = 0; i < count && ! changed; ++i )
+      {
+         changed = memcmp(&sensors[i], first + i * stride, size) != 0;
+      }
+
+      if ( ! changed )
+      {
+         return count;
+      }
+   }
+
+   return -1;
+}
+
 // ===========================================================================
 // trackd controller API
 
@@ -248,3 +309,45 @@ trackd_controller_valuator(ControllerConnection* c, int valuatorNum)
 
    return valuators[valuatorNum];
 }
+
+int
+trackd_controller_snapshot(ControllerConnection* c, int* buttons,
+                           int maxButtons, float* valuators, int maxValuators)
+{
+   const unsigned char* base =
+      reinterpret_cast<const unsigned char*>(c->controller);
+
+   for ( int attempt = 0; attempt < TRACKD_SNAPSHOT_TRIES; ++attempt )
+   {
+      const uint32_t stamp[2] =
+         { c->controller->timestamp[0], c->controller->timestamp[1] };
+      const int num_buttons = trackd_min(c->controller->numButtons,
+                                         maxButtons);
+      const int num_valuators = trackd_min(c->controller->numValuators,
+                                           maxValuators);
+      const size_t button_size = num_buttons * sizeof(int);
+      const size_t valuator_size = num_valuators * sizeof(float);
+      const unsigned char* button_data = base + c->controller->buttonOffset;
+      const unsigned char* valuator_data =
+         base + c->controller->valuatorOffset;
+
+      memcpy(buttons, button_data, button_size);
+      memcpy(valuators, valuator_data, valuator_size);
+
+      trackd_barrier();
+
+      if ( stamp[0] == c->controller->timestamp[0] &&
+           stamp[1] == c->controller->timestamp[1] &&
+           num_buttons == trackd_min(c->controller->numButtons,
+                                     maxButtons) &&
+           num_valuators == trackd_min(c->controller->numValuators,
+                                       maxValuators) &&
+           memcmp(buttons, button_data, button_size) == 0 &&
+           memcmp(valuators, valuator_data, valuator_size) == 0 )
+      {
+         return 0;
+      }
+   }
+
+   return -1;
+}
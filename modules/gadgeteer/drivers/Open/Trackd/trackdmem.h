@@ -53,6 +53,9 @@ struct CAVE_TRACKDCONTROLLER_HEADER
     either the header, sensor, or controller struct definition is expanded */
 #define CAVELIB_2_6  1
 
+/* Number of copies attempted by the snapshot functions before they give up */
+#define TRACKD_SNAPSHOT_TRIES  8
+
 struct TrackerConnection;
 struct ControllerConnection;
 
@@ -65,6 +68,18 @@ trackd_tracker_num_sensors(TrackerConnection* t);
 CAVE_SENSOR_ST*
 trackd_tracker_sensor(TrackerConnection* t, int sensorNum);
 
+/*
+ * trackd does not lock the segment while it writes, so reading a sensor in
+ * place can return a pose that is half old and half new.  This copies up to
+ * maxSensors sensors into sensors in one pass and then compares the copy
+ * with the segment.  The copy is retried when trackd changed anything in
+ * the meantime.  Returns the number of sensors copied, or -1 if no
+ * consistent copy was made within TRACKD_SNAPSHOT_TRIES attempts.
+ */
+int
+trackd_tracker_snapshot(TrackerConnection* t, CAVE_SENSOR_ST* sensors,
+                        int maxSensors);
+
 ControllerConnection*
 trackd_controller_attach(int shmKey);
 void
@@ -78,4 +93,14 @@ trackd_controller_button(ControllerConnection* c, int buttonNum);
 float
 trackd_controller_valuator(ControllerConnection* c, int valuatorNum);
 
+/*
+ * Copies up to maxButtons buttons and maxValuators valuators the same way
+ * as trackd_tracker_snapshot().  Returns 0 on success or -1 if no
+ * consistent copy was made.
+ */
+int
+trackd_controller_snapshot(ControllerConnection* c, int* buttons,
+                           int maxButtons, float* valuators,
+                           int maxValuators);
+
 #endif
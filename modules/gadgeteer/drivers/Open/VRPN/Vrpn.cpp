@@ -51,6 +51,8 @@
 
 #include <gadget/Devices/DriverConfig.h>
 
+#include <algorithm>
+#include <set>
 #include <boost/bind.hpp>
 
 #include <gmtl/Matrix.h>
@@ -88,6 +90,17 @@ GADGET_DRIVER_EXPORT void initDevice(gadget::InputManager* inputMgr)
 
 }
 
+namespace
+{
+
+/**
+ * Longest time spent waiting for VRPN messages at once.  This bounds the
+ * delay of rumble requests and of stopSampling().
+ */
+const long MAX_MESSAGE_WAIT_USEC(5000);
+
+}
+
 namespace gadget
 {
 
@@ -123,6 +136,8 @@ Vrpn::Vrpn()
    , mTrackerNumber(0)
    , mButtonNumber(0)
    , mAnalogNumber(0)
+   , mRumblePending(false)
+   , mRumbleValue(0.0)
 {
    /* Do nothing. */ ;
 }
@@ -180,6 +195,7 @@ bool Vrpn::config(jccl::ConfigElementPtr e)
 
       mPositions.resize(mTrackerNumber);
       mQuats.resize(mTrackerNumber);
+      mTrackerTimes.resize(mTrackerNumber);
    }
 
    // Get the name of the VRPN button server.
@@ -304,7 +320,7 @@ bool Vrpn::sample()
          gmtl::setTrans(pos, mPositions[i]);
 
          positions[i].setValue(pos);
-         positions[i].setTime();
+         positions[i].setTime(mTrackerTimes[i]);
       }
 
       addPositionSample(positions);
@@ -318,7 +334,6 @@ bool Vrpn::sample()
       for ( int i = 0; i < mButtonNumber; ++i )
       {
          buttons[i] = mButtons[i];
-         buttons[i].setTime();
       }
 
       addDigitalSample(buttons);
@@ -332,7 +347,6 @@ bool Vrpn::sample()
       for ( int i = 0; i < mAnalogNumber; ++i )
       {
          analogs[i] = mAnalogs[i];
-         analogs[i].setTime();
       }
 
       addAnalogSample(analogs);
@@ -370,7 +384,8 @@ void Vrpn::startRumble()
    vpr::Guard<vpr::Mutex> g(mVrpnConnectionMutex);
 
    // Send 1.0 to channel 0 to turn on rumble on WiiMote
-   mAnalogOutHandle->request_change_channel_value(0, 1.0);
+   mRumbleValue   = 1.0;
+   mRumblePending = true;
 }
 
 void Vrpn::stopRumble()
@@ -379,7 +394,19 @@ void Vrpn::stopRumble()
    vpr::Guard<vpr::Mutex> g(mVrpnConnectionMutex);
    
    // Send 0.0 to channel 0 to turn off rumble on WiiMote
-   mAnalogOutHandle->request_change_channel_value(0, 0.0);
+   mRumbleValue   = 0.0;
+   mRumblePending = true;
+}
+
+void Vrpn::applyRumbleRequest()
+{
+   vpr::Guard<vpr::Mutex> g(mVrpnConnectionMutex);
+
+   if ( mRumblePending && mAnalogOutHandle )
+   {
+      mAnalogOutHandle->request_change_channel_value(0, mRumbleValue);
+      mRumblePending = false;
+   }
 }
 
 RumbleEffectPtr Vrpn::createEffectImp(RumbleEffect::RumbleType type)
@@ -434,10 +461,63 @@ void Vrpn::readLoop()
       return;
    }
 
+   // Remotes that name the same server share a connection.  When that is
+   // the case for all of them, we can wait on that connection for data.
+   std::set<vrpn_Connection*> connections;
+   if (tracker_handle)
+   {
+      connections.insert(tracker_handle->connectionPtr());
+   }
+   if (button_handle)
+   {
+      connections.insert(button_handle->connectionPtr());
+   }
+   if (analog_handle)
+   {
+      connections.insert(analog_handle->connectionPtr());
+      connections.insert(mAnalogOutHandle->connectionPtr());
+   }
+
+   vrpn_Connection* connection(NULL);
+   if ( connections.size() == 1 && NULL != *connections.begin() )
+   {
+      connection = *connections.begin();
+   }
+
+   // Until the first message arrives, treat the current time as the time
+   // of the (default) data.
+   {
+      vpr::Guard<vpr::Mutex> g(mTrackerMutex);
+      std::fill(mTrackerTimes.begin(), mTrackerTimes.end(),
+                vpr::Interval::now());
+   }
+   {
+      vpr::Guard<vpr::Mutex> g(mButtonMutex);
+      for ( unsigned int i = 0; i < mButtons.size(); ++i )
+      {
+         mButtons[i].setTime();
+      }
+   }
+   {
+      vpr::Guard<vpr::Mutex> g(mAnalogMutex);
+      for ( unsigned int i = 0; i < mAnalogs.size(); ++i )
+      {
+         mAnalogs[i].setTime();
+      }
+   }
+
    // loop through  and keep sampling
    while ( ! mExitFlag )
    {
-      vpr::Guard<vpr::Mutex> g(mVrpnConnectionMutex);
+      if ( NULL != connection )
+      {
+         // Block until a message arrives (or the wait times out).  This
+         // dispatches the message to the change handlers.
+         timeval timeout;
+         timeout.tv_sec  = 0;
+         timeout.tv_usec = MAX_MESSAGE_WAIT_USEC;
+         connection->mainloop(&timeout);
+      }
 
       if (tracker_handle)
       {
@@ -455,12 +535,17 @@ void Vrpn::readLoop()
       }
       if (mAnalogOutHandle)
       {
+         applyRumbleRequest();
          mAnalogOutHandle->mainloop();
       }
 
-      vpr::Thread::yield();
-      // yield and take a brief sleep
-      vpr::System::msleep(1);
+      if ( NULL == connection )
+      {
+         // The remotes use different servers, so there is no single
+         // connection to wait on.  Yield and take a brief sleep.
+         vpr::Thread::yield();
+         vpr::System::msleep(1);
+      }
    }
 
    mTrackerNumber = 0;
@@ -484,7 +569,10 @@ void Vrpn::readLoop()
                                                &handleAnalogChange);
    }
 
-   mAnalogOutHandle.reset();
+   {
+      vpr::Guard<vpr::Mutex> g(mVrpnConnectionMutex);
+      mAnalogOutHandle.reset();
+   }
 }
 
 void Vrpn::trackerChange(const vrpn_TRACKERCB& t)
@@ -499,6 +587,7 @@ void Vrpn::trackerChange(const vrpn_TRACKERCB& t)
          << vprDEBUG_FLUSH;
       mPositions.resize(t.sensor + 1);
       mQuats.resize(t.sensor + 1);
+      mTrackerTimes.resize(t.sensor + 1);
    }
 
    vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_VERB_LVL)
@@ -513,6 +602,8 @@ void Vrpn::trackerChange(const vrpn_TRACKERCB& t)
    mPositions[t.sensor][0] = t.pos[0];
    mPositions[t.sensor][1] = t.pos[1];
    mPositions[t.sensor][2] = t.pos[2];
+
+   mTrackerTimes[t.sensor] = vpr::Interval::now();
 }
 
 void Vrpn::buttonChange(const vrpn_BUTTONCB& b)
@@ -533,10 +624,12 @@ void Vrpn::buttonChange(const vrpn_BUTTONCB& b)
       << vprDEBUG_FLUSH;
 
    mButtons[b.button] = static_cast<DigitalState::State>(b.state);
+   mButtons[b.button].setTime();
 }
 
 void Vrpn::analogChange(const vrpn_ANALOGCB& b)
 {
+   const vpr::Interval arrival(vpr::Interval::now());
    vpr::Guard<vpr::Mutex> g(mAnalogMutex);
 
    if ( b.num_channel > mAnalogNumber )
@@ -555,6 +648,7 @@ void Vrpn::analogChange(const vrpn_ANALOGCB& b)
          << vprDEBUG_FLUSH;
 
       mAnalogs[i] = b.channel[i];
+      mAnalogs[i].setTime(arrival);
    }
 }
 } // End of gadget namespace
@@ -48,6 +48,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include <vpr/Sync/Mutex.h>
+#include <vpr/Util/Interval.h>
 #include <gadget/Type/InputDevice.h>
 #include <gadget/Type/Rumble.h>
 
@@ -149,8 +150,16 @@ protected:
 
 private:
 
+   /**
+    * Reads from the VRPN servers.  When all the remotes share a single
+    * connection, this blocks in the connection until a message arrives
+    * instead of polling, so handlers run as soon as data is received.
+    */
    void readLoop();
 
+   /** Sends a pending rumble request.  Called from readLoop() only. */
+   void applyRumbleRequest();
+
    /** @name VRPN Data Handlers */
    //@{
    void trackerChange(const vrpn_TRACKERCB& t);
@@ -167,6 +176,7 @@ private:
    vpr::Mutex               mTrackerMutex;
    std::vector<gmtl::Quatf> mQuats;
    std::vector<gmtl::Vec3f> mPositions;
+   std::vector<vpr::Interval> mTrackerTimes; /**< Arrival of last update */
    //@}
 
    /** @name Button Data */
@@ -184,7 +194,18 @@ private:
    vpr::Mutex                      mAnalogMutex;
    std::vector<gadget::AnalogData> mAnalogs;
    boost::shared_ptr<vrpn_Analog_Output_Remote> mAnalogOutHandle;
-   vpr::Mutex                      mVrpnConnectionMutex;;
+   //@}
+
+   /**
+    * @name Rumble Requests
+    *
+    * VRPN objects are only used from the read thread.  Rumble changes
+    * requested by other threads are queued here and sent by readLoop().
+    */
+   //@{
+   vpr::Mutex                      mVrpnConnectionMutex;
+   bool                            mRumblePending;
+   double                          mRumbleValue;
    //@}
 
    friend void VRPN_CALLBACK handleTrackerChange(void*, vrpn_TRACKERCB);
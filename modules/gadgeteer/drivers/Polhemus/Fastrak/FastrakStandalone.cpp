@@ -296,8 +296,10 @@ void FastrakStandalone::sendCommand(vpr::Uint8 cmd, std::string data)
       const vpr::Uint32 bytes_written = mSerialPort->write(data, data.size());
       vprASSERT(data.size() == bytes_written);
    }
+   // Do not flush again here.  Stale input was cleared before the command
+   // was written, and a flush now would throw away the start of a reply
+   // that arrives quickly.
    mSerialPort->drainOutput();
-   mSerialPort->flushQueue(vpr::SerialTypes::IO_QUEUES);       // Clear the buffers
 }
 
 void FastrakStandalone::setOutputDataList(const vpr::Uint16 unit,
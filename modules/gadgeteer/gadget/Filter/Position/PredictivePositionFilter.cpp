@@ -0,0 +1,307 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+#include <gadget/gadgetConfig.h>
+
+#include <cmath>
+
+#include <gmtl/Matrix.h>
+#include <gmtl/Generate.h>
+#include <gmtl/QuatOps.h>
+#include <gmtl/VecOps.h>
+
+#include <jccl/Config/ConfigElement.h>
+
+#include <gadget/InputManager.h>
+#include <gadget/Util/Debug.h>
+#include <gadget/Filter/Position/PositionFilterFactory.h>
+#include <gadget/Filter/Position/PredictivePositionFilter.h>
+
+
+namespace
+{
+
+/** Weight of a new sample interval in the average sample period. */
+const float PERIOD_WEIGHT(0.1f);
+
+/** Returns (1 - t) * a + t * b, component-wise. */
+gmtl::Quatf blend(const gmtl::Quatf& a, const gmtl::Quatf& b, const float t)
+{
+   gmtl::Quatf result;
+   for ( unsigned int i = 0; i < 4; ++i )
+   {
+      result[i] = (1.0f - t) * a[i] + t * b[i];
+   }
+   return result;
+}
+
+/**
+ * Flips \p q into the same hemisphere as \p ref.  q and -q are the same
+ * rotation, but only the one close to \p ref can be averaged with it.
+ */
+void align(gmtl::Quatf& q, const gmtl::Quatf& ref)
+{
+   if ( gmtl::dot(q, ref) < 0.0f )
+   {
+      for ( unsigned int i = 0; i < 4; ++i )
+      {
+         q[i] = -q[i];
+      }
+   }
+}
+
+/** Returns the rotation of \p angle radians about the unit vector \p axis. */
+gmtl::Quatf makeRotation(const gmtl::Vec3f& axis, const float angle)
+{
+   const float s(std::sin(angle * 0.5f));
+   return gmtl::Quatf(axis[0] * s, axis[1] * s, axis[2] * s,
+                      std::cos(angle * 0.5f));
+}
+
+}
+
+namespace gadget
+{
+
+// Register this filter.
+GADGET_REGISTER_POSFILTER_CREATOR(PredictivePositionFilter);
+
+PredictivePositionFilter::UnitState::UnitState()
+   : valid(false)
+   , spinRate(0.0f)
+   , period(0.0f)
+{
+   /* Do nothing. */ ;
+}
+
+void PredictivePositionFilter::UnitState::
+update(const Model model, const float alpha, const vpr::Interval& sampleTime,
+       const gmtl::Vec3f& samplePos, const gmtl::Quatf& sampleRot)
+{
+   gmtl::Quatf new_rot(sampleRot);
+
+   if ( ! valid )
+   {
+      valid    = true;
+      time     = sampleTime;
+      pos      = samplePos;
+      rot      = new_rot;
+      velocity = gmtl::Vec3f(0.0f, 0.0f, 0.0f);
+      spinRate = 0.0f;
+      posS1    = posS2 = samplePos;
+      rotS1    = rotS2 = new_rot;
+      period   = 0.0f;
+      return;
+   }
+
+   // Repeated or out-of-order samples carry no new motion.
+   if ( sampleTime <= time )
+   {
+      return;
+   }
+
+   const float dt((sampleTime - time).secf());
+   align(new_rot, rot);
+
+   if ( CONSTANT_VELOCITY == model )
+   {
+      velocity = (samplePos - pos) / dt;
+
+      // The rotation from the previous orientation to the new one, as an
+      // axis and a rate.  new_rot is aligned with rot, so w >= 0 and the
+      // angle is at most pi.
+      const gmtl::Quatf delta(new_rot * gmtl::makeConj(rot));
+      const float w(delta[gmtl::Welt] < 1.0f ? delta[gmtl::Welt] : 1.0f);
+      const float s(std::sqrt(1.0f - w * w));
+
+      if ( s < 1.0e-6f )
+      {
+         spinRate = 0.0f;
+      }
+      else
+      {
+         spinAxis.set(delta[gmtl::Xelt] / s, delta[gmtl::Yelt] / s,
+                      delta[gmtl::Zelt] / s);
+         spinRate = 2.0f * std::acos(w) / dt;
+      }
+   }
+   else
+   {
+      period = period == 0.0f ? dt : period + PERIOD_WEIGHT * (dt - period);
+
+      posS1 = samplePos * alpha + posS1 * (1.0f - alpha);
+      posS2 = posS1 * alpha + posS2 * (1.0f - alpha);
+
+      align(new_rot, rotS1);
+      rotS1 = blend(rotS1, new_rot, alpha);
+      gmtl::normalize(rotS1);
+      align(rotS2, rotS1);
+      rotS2 = blend(rotS2, rotS1, alpha);
+      gmtl::normalize(rotS2);
+   }
+
+   time = sampleTime;
+   pos  = samplePos;
+   rot  = new_rot;
+}
+
+void PredictivePositionFilter::UnitState::
+predict(const Model model, const float alpha, const float seconds,
+        gmtl::Vec3f& outPos, gmtl::Quatf& outRot) const
+{
+   if ( CONSTANT_VELOCITY == model )
+   {
+      outPos = pos + velocity * seconds;
+      outRot = rot;
+
+      if ( spinRate != 0.0f )
+      {
+         outRot = makeRotation(spinAxis, spinRate * seconds) * rot;
+      }
+   }
+   else
+   {
+      // With tau sample periods of lead, the prediction is
+      //    (2 + c) * S1 - (1 + c) * S2,  c = alpha * tau / (1 - alpha)
+      const float tau(period > 0.0f ? seconds / period : 0.0f);
+      const float c(alpha * tau / (1.0f - alpha));
+
+      outPos = posS1 * (2.0f + c) - posS2 * (1.0f + c);
+      outRot = blend(rotS1, rotS2, -(1.0f + c));
+      gmtl::normalize(outRot);
+   }
+}
+
+PredictivePositionFilter::PredictivePositionFilter()
+   : mModel(DOUBLE_EXPONENTIAL)
+   , mSmoothing(0.5f)
+   , mLeadTime(0, vpr::Interval::Usec)
+   , mMaxPrediction(100, vpr::Interval::Msec)
+{
+   /* Do nothing. */ ;
+}
+
+PredictivePositionFilter::~PredictivePositionFilter()
+{
+   /* Do nothing. */ ;
+}
+
+std::string PredictivePositionFilter::getElementType()
+{
+   return "position_prediction_filter";
+}
+
+void PredictivePositionFilter::setSmoothing(const float alpha)
+{
+   // Both ends stop the trend estimate from working: 0 never moves and 1
+   // divides by zero.
+   mSmoothing = alpha < 0.01f ? 0.01f : (alpha > 0.99f ? 0.99f : alpha);
+}
+
+bool PredictivePositionFilter::config(jccl::ConfigElementPtr e)
+{
+   vprASSERT(e->getID() == PredictivePositionFilter::getElementType());
+
+   const int model(e->getProperty<int>("model"));
+
+   if ( model != CONSTANT_VELOCITY && model != DOUBLE_EXPONENTIAL )
+   {
+      vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CRITICAL_LVL)
+         << clrOutBOLD(clrRED, "ERROR")
+         << ": [gadget::PredictivePositionFilter::config()] Unknown model "
+         << model << " in " << e->getFullName() << std::endl
+         << vprDEBUG_FLUSH;
+      return false;
+   }
+
+   mModel = static_cast<Model>(model);
+   setSmoothing(e->getProperty<float>("smoothing"));
+   mLeadTime.msecf(e->getProperty<float>("lead_time"));
+   mMaxPrediction.msecf(e->getProperty<float>("max_prediction"));
+   reset();
+
+   vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CONFIG_LVL)
+      << "[gadget::PredictivePositionFilter::config()] "
+      << (CONSTANT_VELOCITY == mModel ? "Constant velocity"
+                                      : "Double exponential")
+      << " model, smoothing " << mSmoothing << ", lead "
+      << mLeadTime.msecf() << " ms, limit " << mMaxPrediction.msecf()
+      << " ms\n" << vprDEBUG_FLUSH;
+
+   return true;
+}
+
+void PredictivePositionFilter::apply(std::vector<PositionData>& posSamples)
+{
+   predict(posSamples, InputManager::instance()->getDisplayTime());
+}
+
+void PredictivePositionFilter::predict(std::vector<PositionData>& posSamples,
+                                       const vpr::Interval& displayTime)
+{
+   if ( mUnits.size() < posSamples.size() )
+   {
+      mUnits.resize(posSamples.size());
+   }
+
+   const vpr::Interval zero;
+
+   for ( unsigned int i = 0; i < posSamples.size(); ++i )
+   {
+      PositionData& sample(posSamples[i]);
+
+      // Without a time stamp there is nothing to extrapolate from.
+      if ( sample.getTime() == zero )
+      {
+         continue;
+      }
+
+      gmtl::Matrix44f& mat(sample.editValue());
+      UnitState& unit(mUnits[i]);
+      unit.update(mModel, mSmoothing, sample.getTime(),
+                  gmtl::makeTrans<gmtl::Vec3f>(mat),
+                  gmtl::makeRot<gmtl::Quatf>(mat));
+
+      vpr::Interval target(displayTime > unit.time ? displayTime : unit.time);
+      target += mLeadTime;
+
+      vpr::Interval ahead(target > unit.time ? target - unit.time : zero);
+      if ( ahead > mMaxPrediction )
+      {
+         ahead = mMaxPrediction;
+      }
+
+      gmtl::Vec3f pos;
+      gmtl::Quatf rot;
+      unit.predict(mModel, mSmoothing, ahead.secf(), pos, rot);
+
+      mat = gmtl::makeRot<gmtl::Matrix44f>(rot);
+      gmtl::setTrans(mat, pos);
+   }
+}
+
+} // End of gadget namespace
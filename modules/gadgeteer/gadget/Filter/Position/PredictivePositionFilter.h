@@ -0,0 +1,204 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+#ifndef _GADGET_PREDICTIVE_POSITION_FILTER_H_
+#define _GADGET_PREDICTIVE_POSITION_FILTER_H_
+
+#include <gadget/gadgetConfig.h>
+
+#include <vector>
+
+#include <gmtl/Vec.h>
+#include <gmtl/Quat.h>
+
+#include <vpr/Util/Interval.h>
+
+#include <jccl/Config/ConfigElementPtr.h>
+#include <gadget/Filter/Position/PositionFilter.h>
+#include <gadget/Type/PositionData.h>
+
+
+namespace gadget
+{
+
+/** \class PredictivePositionFilter PredictivePositionFilter.h gadget/Filter/Position/PredictivePositionFilter.h
+ *
+ * Latency compensation filter.  The newest sample of a tracker is already
+ * old when the frame that uses it reaches the display.  This filter keeps a
+ * short motion history built from the time stamps of the samples that pass
+ * through it and replaces each sample with the pose extrapolated to the
+ * display time that the kernel publishes through
+ * gadget::InputManager::setDisplayTime().
+ *
+ * Two motion models are available:
+ *
+ *  - Constant velocity: the linear and angular velocity between the last two
+ *    distinct samples is held for the prediction interval.  It has no lag,
+ *    but it amplifies tracker noise.
+ *  - Double exponential smoothing (LaViola, 2003): two exponentially smoothed
+ *    statistics of the position and orientation are combined into a trend
+ *    estimate.  The smoothing factor trades noise against lag, and it costs
+ *    far less than a Kalman filter for comparable head tracking accuracy.
+ *
+ * The filter should be the last one in a position proxy's list so that it
+ * sees the final coordinate frame.  A sample is predicted no further than the
+ * configured limit past its own time stamp, which keeps a stalled tracker
+ * from sending the pose off into the distance.  When no display time is
+ * known, samples are predicted by the configured lead time alone.
+ */
+class GADGET_API PredictivePositionFilter
+   : public PositionFilter
+{
+public:
+   /** The motion models that can be used for the prediction. */
+   enum Model
+   {
+      CONSTANT_VELOCITY  = 0,   /**< Hold the last measured velocity */
+      DOUBLE_EXPONENTIAL = 1    /**< Double exponential smoothing */
+   };
+
+   /** Constructor. */
+   PredictivePositionFilter();
+
+   /** Destructor. */
+   virtual ~PredictivePositionFilter();
+
+   /**
+    * Configures this position filter.
+    *
+    * @return \c true is returned if configured correctly.
+    */
+   virtual bool config(jccl::ConfigElementPtr e);
+
+   /**
+    * Predicts the given samples to the display time of the current frame.
+    *
+    * @post Each gadget::PositionData object in \p posSamples holds the pose
+    *       predicted for the display time.  Its time stamp is unchanged.
+    *
+    * @param posSamples The collection of samples to modify (in place).
+    */
+   virtual void apply(std::vector<PositionData>& posSamples);
+
+   /**
+    * Predicts the given samples to \p displayTime plus the lead time.  This
+    * is what apply() does with the display time from gadget::InputManager.
+    * It is public so that recorded tracker data can be replayed through the
+    * filter with known display times.
+    *
+    * @param posSamples  The collection of samples to modify (in place).
+    * @param displayTime The time at which the samples will be seen.  Zero
+    *                    means unknown.
+    */
+   void predict(std::vector<PositionData>& posSamples,
+                const vpr::Interval& displayTime);
+
+   static std::string getElementType();
+
+   /** @name Parameter Accessors */
+   //@{
+   Model getModel() const
+   {
+      return mModel;
+   }
+
+   void setModel(const Model model)
+   {
+      mModel = model;
+   }
+
+   /** Sets the smoothing factor of the double exponential model (0,1). */
+   void setSmoothing(const float alpha);
+
+   /** Sets the time added to the display time (or the sample time). */
+   void setLeadTime(const vpr::Interval& leadTime)
+   {
+      mLeadTime = leadTime;
+   }
+
+   /** Sets the longest interval that a sample may be predicted ahead. */
+   void setMaxPrediction(const vpr::Interval& maxPrediction)
+   {
+      mMaxPrediction = maxPrediction;
+   }
+   //@}
+
+   /** Forgets the motion history of all units. */
+   void reset()
+   {
+      mUnits.clear();
+   }
+
+private:
+   /** Motion history of one unit (one entry of the sample vector). */
+   struct UnitState
+   {
+      UnitState();
+
+      /** Feeds a new measurement into the motion model. */
+      void update(const Model model, const float alpha,
+                  const vpr::Interval& time, const gmtl::Vec3f& pos,
+                  const gmtl::Quatf& rot);
+
+      /** Extrapolates the newest measurement by \p seconds. */
+      void predict(const Model model, const float alpha, const float seconds,
+                   gmtl::Vec3f& pos, gmtl::Quatf& rot) const;
+
+      bool          valid;      /**< At least one sample has been seen */
+      vpr::Interval time;       /**< Time stamp of the newest sample */
+      gmtl::Vec3f   pos;        /**< Newest position */
+      gmtl::Quatf   rot;        /**< Newest orientation */
+
+      /** @name Constant velocity state */
+      //@{
+      gmtl::Vec3f   velocity;   /**< Linear velocity (units per second) */
+      gmtl::Vec3f   spinAxis;   /**< Axis of the angular velocity */
+      float         spinRate;   /**< Angular speed (radians per second) */
+      //@}
+
+      /** @name Double exponential state */
+      //@{
+      gmtl::Vec3f   posS1;      /**< Smoothed position */
+      gmtl::Vec3f   posS2;      /**< Smoothed smoothed position */
+      gmtl::Quatf   rotS1;      /**< Smoothed orientation */
+      gmtl::Quatf   rotS2;      /**< Smoothed smoothed orientation */
+      float         period;     /**< Average sample period (seconds) */
+      //@}
+   };
+
+   Model         mModel;
+   float         mSmoothing;       /**< Double exponential alpha */
+   vpr::Interval mLeadTime;        /**< Added to the target time */
+   vpr::Interval mMaxPrediction;   /**< Longest prediction interval */
+
+   std::vector<UnitState> mUnits;
+};
+
+} // End of gadget namespace
+
+
+#endif /* _GADGET_PREDICTIVE_POSITION_FILTER_H_ */
@@ -37,6 +37,7 @@
 #include <vpr/vpr.h>
 #include <vpr/DynLoad/Library.h>
 #include <vpr/Util/Singleton.h>
+#include <vpr/Util/Interval.h>
 
 #include <jccl/RTRC/ConfigElementHandler.h>
 #include <gadget/InputLoggerPtr.h>
@@ -251,6 +252,27 @@ public:
       return mEventEmitter;
    }
 
+   /**
+    * Sets the time at which the frame that will use the next proxy update is
+    * expected to reach the display.  The kernel sets this just before it
+    * calls updateAllProxies() so that predictive filters (see
+    * gadget::PredictivePositionFilter) can extrapolate to it.  It is only
+    * meant to be used from the thread that updates the proxies.
+    */
+   void setDisplayTime(const vpr::Interval& displayTime)
+   {
+      mDisplayTime = displayTime;
+   }
+
+   /**
+    * Returns the expected display time of the current frame.  This is zero
+    * if nothing has set it.
+    */
+   const vpr::Interval& getDisplayTime() const
+   {
+      return mDisplayTime;
+   }
+
 private:
    bool removeProxy(const std::string& proxyName);
    bool removeProxy(jccl::ConfigElementPtr element);
@@ -286,6 +308,8 @@ private:
 
    EventEmitterPtr mEventEmitter;
 
+   vpr::Interval mDisplayTime;   /**< Expected display time of the frame */
+
 private:
    /** Function to configure the proxy Alias array. */
    bool configureProxyAlias(jccl::ConfigElementPtr element);
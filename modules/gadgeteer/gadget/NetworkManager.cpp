@@ -29,9 +29,17 @@
 #include <algorithm>
 #include <iomanip>
 
+#include <boost/bind.hpp>
+
+#include <vpr/IO/Selector.h>
 #include <vpr/IO/Socket/InetAddr.h>
 #include <vpr/IO/TimeoutException.h> 
+#include <vpr/IO/ObjectReader.h>
+#include <vpr/IO/ObjectWriter.h>
+#include <vpr/IO/SerializableObject.h>
 #include <vpr/Perf/ProfileManager.h>
+#include <vpr/System.h>
+#include <vpr/Thread/Thread.h>
 
 #ifdef GADGET_DEBUG
 #  include <vpr/IO/Stats/BandwidthIOStatsStrategy.h>
@@ -39,14 +47,18 @@
 #  include <vpr/IO/Stats/IOStatsStrategyAdapter.h>
 #endif
 
+#include <cluster/Packets/DataPacket.h>
 #include <cluster/Packets/EndBlock.h>
 #include <cluster/Packets/Header.h>
 #include <cluster/Packets/Packet.h>
 #include <cluster/Packets/PacketFactory.h>
+#include <cluster/ClusterException.h>
 #include <cluster/ClusterManager.h>
+#include <cluster/FrameTrace.h>
 
 #include <gadget/Node.h>
 #include <gadget/PacketHandler.h>
+#include <gadget/SharedMemoryChannel.h>
 #include <gadget/Util/Debug.h>
 
 #include <jccl/Config/ConfigElement.h>
@@ -56,11 +68,182 @@
 
 #include <boost/concept_check.hpp>   /* for ignore_unused_variable_warning */
 
+
+namespace
+{
+
+/** Longest pause between two attempts to connect to a node. */
+const vpr::Interval CONNECT_RETRY_INTERVAL(250, vpr::Interval::Msec);
+
+/**
+ * Returns how much of \p timeout is left since \p start, or
+ * vpr::Interval::NoWait once it has all passed.
+ */
+vpr::Interval getRemaining(const vpr::Interval& start,
+                           const vpr::Interval& timeout)
+{
+   const vpr::Interval elapsed(vpr::Interval::now() - start);
+   return elapsed < timeout ? timeout - elapsed : vpr::Interval::NoWait;
+}
+
+void destroySocket(vpr::SocketStream* sock)
+{
+   try
+   {
+      if ( sock->isOpen() )
+      {
+         sock->close();
+      }
+   }
+   catch (vpr::IOException&)
+   {
+      // The socket is being thrown away anyway.
+   }
+
+   delete sock;
+}
+
+/**
+ * Returns true if \p sock connects two processes on this host.  Both ends of
+ * such a connection have the same address, which is a loopback one when the
+ * node was given as localhost.
+ */
+bool isSameHost(vpr::SocketStream* sock)
+{
+   return sock->getLocalAddr().getAddressValue() ==
+             sock->getRemoteAddr().getAddressValue();
+}
+
+/**
+ * How long each side waits for the other one to take part in the transport
+ * negotiation before it falls back to the socket.
+ */
+const vpr::Interval TRANSPORT_HANDSHAKE_TIMEOUT(2, vpr::Interval::Sec);
+
+/**
+ * Version of the transport negotiation.  Later versions may only append
+ * fields to TransportMessage so that older peers can skip them.
+ */
+const vpr::Uint16 TRANSPORT_PROTOCOL_VERSION(1);
+
+/** Plugin ID of the data packets that carry the transport negotiation. */
+const vpr::GUID& getTransportGUID()
+{
+   static const vpr::GUID transport_guid("6f0e4d8a-2c51-4b7e-93a4-d1c85e2b7f06");
+   return transport_guid;
+}
+
+/** Message of the transport negotiation. */
+struct TransportMessage : public vpr::SerializableObject
+{
+   enum Kind
+   {
+      HELLO  = 0,    /**< Sent by the accepting side right after connecting */
+      OFFER  = 1,    /**< Names a shared memory channel, if any */
+      ANSWER = 2     /**< Tells whether the offered channel was mapped */
+   };
+
+   TransportMessage(const Kind messageKind = HELLO)
+      : version(TRANSPORT_PROTOCOL_VERSION)
+      , kind(messageKind)
+      , accepted(false)
+   {;}
+
+   virtual void writeObject(vpr::ObjectWriter* writer)
+   {
+      writer->writeUint16(version);
+      writer->writeUint8(kind);
+      writer->writeString(name);
+      writer->writeBool(accepted);
+   }
+
+   virtual void readObject(vpr::ObjectReader* reader)
+   {
+      version  = reader->readUint16();
+      kind     = reader->readUint8();
+      name     = reader->readString();
+      accepted = reader->readBool();
+   }
+
+   vpr::Uint16 version;
+   vpr::Uint8  kind;
+   std::string name;
+   bool        accepted;
+};
+
+/** Sends \p message to \p node. */
+void sendTransportMessage(gadget::NodePtr node, TransportMessage& message)
+{
+   cluster::DataPacketPtr packet =
+      cluster::DataPacket::create(getTransportGUID(), getTransportGUID());
+   packet->serialize(message);
+
+   try
+   {
+      node->send(packet);
+   }
+   catch (cluster::ClusterException& ex)
+   {
+      throw vpr::IOException(ex.getDescription(), VPR_LOCATION);
+   }
+}
+
+/**
+ * Reads the next packet from the socket of \p node into \p message.
+ * Returns false if no packet arrives within \p timeout or if the packet is
+ * not part of the transport negotiation.  The node keeps such a packet for
+ * the frame loop.
+ */
+bool recvTransportMessage(gadget::NodePtr node, const vpr::Interval& timeout,
+                          TransportMessage& message)
+{
+   // Reading a packet cannot time out on every platform, so wait for one
+   // to arrive first.
+   vpr::Selector selector;
+   selector.addHandle(node->getSockStream()->getHandle(),
+                      vpr::Selector::Read);
+   vpr::Uint16 num_events(0);
+
+   try
+   {
+      selector.select(num_events, timeout);
+   }
+   catch (vpr::TimeoutException&)
+   {
+      return false;
+   }
+
+   cluster::PacketPtr packet;
+
+   try
+   {
+      packet = node->recvPacket();
+   }
+   catch (cluster::ClusterException& ex)
+   {
+      throw vpr::IOException(ex.getDescription(), VPR_LOCATION);
+   }
+
+   if ( cluster::Header::RIM_DATA_PACKET != packet->getPacketType() ||
+        getTransportGUID() != packet->getPluginId() )
+   {
+      node->setPendingPacket(packet);
+      return false;
+   }
+
+   message.readObject(packet->getPacketReader());
+   return true;
+}
+
+}
+
 namespace gadget
 {
 
 NetworkManager::NetworkManager() 
    : mNodes(0), mHandlerMap()
+   , mEndBlock(cluster::EndBlock::create(0))
+   , mBarrierEndBlock(cluster::EndBlock::create(0))
 {;}
 
 NetworkManager::~NetworkManager()
@@ -175,6 +358,10 @@ void NetworkManager::waitForConnection(const vpr::Uint16 listenPort)
       //ClusterDelta cluster_delta;
       //cluster_delta.clientClusterDelta(requesting_node->getSockStream());
 
+      // Switch to shared memory if the master offers it.  This never
+      // throws, so the node keeps the socket that it owns now.
+      acceptShmChannel(remote_node);
+
       // XXX: Should be alright.
       remote_node->setStatus( Node::CONNECTED );
       mReactor.addNode(remote_node);
@@ -301,10 +488,45 @@ bool NetworkManager::isLocalHost(const std::string& testHostName)
 void NetworkManager::update( const int temp)
 {
    vpr::prof::start("ClusterManager::update()",10);
+   const bool tracing(NULL != mFrameTrace.get() && mFrameTrace->isEnabled());
+   vpr::Interval sent;
+
    setAllUpdated(false);
+   if ( tracing )
+   {
+      sent.setNow();
+   }
    size_t num_nodes = sendEndBlocks(temp);
    uncorkNetwork();
    updateAllNodes(num_nodes);
+
+   // Like a barrier, this is a round trip with every node.
+   if ( tracing )
+   {
+      mFrameTrace->addRoundTrip(mNodes, sent);
+   }
+   vpr::prof::stop();
+}
+
+void NetworkManager::sendUpdate( const int temp )
+{
+   vpr::prof::start("ClusterManager::sendUpdate()",10);
+   sendEndBlocks(temp);
+   uncorkNetwork();
+
+   // Nodes that failed to receive the end block were shut down above.
+   for ( node_list_t::iterator i = mNodes.begin(); i != mNodes.end(); i++)
+   {
+      if ( (*i)->isConnected() )
+      {
+         (*i)->deferEndBlock();
+      }
+   }
+
+   if ( NULL != mFrameTrace.get() && mFrameTrace->isEnabled() )
+   {
+      mFrameTrace->skipRoundTrip();
+   }
    vpr::prof::stop();
 }
 
@@ -315,19 +537,39 @@ void NetworkManager::barrier( bool master )
       << std::endl << vprDEBUG_FLUSH;
 
    vpr::prof::start("ClusterManager::barrier()",10);
+   cluster::FrameTrace::Scope trace_scope(mFrameTrace.get(),
+                                          cluster::FrameTrace::BARRIER);
+   const bool tracing(NULL != mFrameTrace.get() && mFrameTrace->isEnabled());
+   vpr::Interval sent;
+
    if (master)
    {
       size_t num_nodes = getNumNodes();
       setAllUpdated(false);
       updateAllNodes(num_nodes);
-      sendEndBlocks(0);
+      if ( tracing )
+      {
+         sent.setNow();
+      }
+      sendEndBlocks(mBarrierEndBlock);
    }
    else
    {
-      size_t num_nodes = sendEndBlocks(0);
+      if ( tracing )
+      {
+         sent.setNow();
+      }
+      size_t num_nodes = sendEndBlocks(mBarrierEndBlock);
       setAllUpdated(false);
       updateAllNodes(num_nodes);
    }
+
+   // The barrier is a round trip with every node, from which the trace
+   // estimates the offsets between the clocks.
+   if ( tracing )
+   {
+      mFrameTrace->addRoundTrip(mNodes, sent);
+   }
    vpr::prof::stop();
 
    vprDEBUG(gadgetDBG_RIM, vprDBG_HVERB_LVL)
@@ -352,9 +594,14 @@ size_t NetworkManager::setAllUpdated(const bool updated)
 }
 
 size_t NetworkManager::sendEndBlocks( const int temp)
+{
+   mEndBlock->setFrame(temp);
+   return sendEndBlocks(mEndBlock);
+}
+
+size_t NetworkManager::sendEndBlocks( const cluster::EndBlockPtr& endBlock )
 {
    vpr::prof::start("ClusterManager::sendEndBlocks()",10);
-   cluster::EndBlockPtr end_block = cluster::EndBlock::create(temp);
 
    // Used to accumulate the number of connected nodes.
    size_t num_nodes(0);
@@ -366,7 +613,7 @@ size_t NetworkManager::sendEndBlocks( const int temp)
          try
          {
             // Send End Block to the node.
-            (*i)->send(end_block);
+            (*i)->send(endBlock);
 
             // Indicate that this node is not up to date. It will be updated
             // below.
@@ -401,6 +648,8 @@ void NetworkManager::updateAllNodes( const size_t numNodes )
    typedef std::vector<gadget::NodePtr>::iterator iter_t;
 
    vpr::prof::start("ClusterManager::updateAllNodes()",10);
+   cluster::FrameTrace::Scope trace_scope(mFrameTrace.get(),
+                                          cluster::FrameTrace::WAIT);
    std::vector<gadget::NodePtr> ready_nodes;
    while ( completed_nodes != numNodes )
    {
@@ -482,11 +731,33 @@ void NetworkManager::handlePacket(cluster::PacketPtr packet, NodePtr node)
    {
       // -Set New State
       vprASSERT(NULL != node.get() && "Can't have a NULL node.");
-      node->setUpdated( true );
+
+      // This end block closes an exchange that we did not wait for.
+      if ( ! node->consumeDeferredEndBlock() )
+      {
+         node->setUpdated( true );
+
+         if ( NULL != mFrameTrace.get() && mFrameTrace->isEnabled() )
+         {
+            node->setUpdateTime(vpr::Interval::now());
+         }
+      }
       return;
    }
 
-   vpr::GUID handler_guid = packet->getPluginId();
+   // A packet sent on a handler channel that this node has already seen
+   // goes straight to its handler.
+   const vpr::Uint16 channel =
+      cluster::Header::getHandlerChannel(packet->getChannel());
+   PacketHandler* channel_handler = node->getChannelHandler(channel);
+
+   if ( NULL != channel_handler )
+   {
+      channel_handler->handlePacket(packet, node);
+      return;
+   }
+
+   const vpr::GUID& handler_guid = packet->getPluginId();
    PacketHandlerPtr temp_handler = getHandlerByGUID( handler_guid );
 
    //vprDEBUG( gadgetDBG_NET_MGR, 0 )
@@ -501,8 +772,35 @@ void NetworkManager::handlePacket(cluster::PacketPtr packet, NodePtr node)
          << " Handler \"" << temp_handler->getHandlerName() << "\" will handle this packet."
          << std::endl << vprDEBUG_FLUSH;
 
+      if ( 0 != channel )
+      {
+         node->setChannelHandler(channel, temp_handler);
+      }
+
       temp_handler->handlePacket( packet, node );
    }
+   else if ( getTransportGUID() == handler_guid )
+   {
+      // The transport negotiation with this node gave up before this
+      // arrived.  An offer still needs an answer, and it is always no.
+      TransportMessage message;
+      message.readObject(packet->getPacketReader());
+
+      if ( TransportMessage::OFFER == message.kind && ! message.name.empty() )
+      {
+         TransportMessage answer(TransportMessage::ANSWER);
+
+         try
+         {
+            sendTransportMessage(node, answer);
+         }
+         catch (vpr::IOException& ex)
+         {
+            throw cluster::ClusterException(ex.getDescription(),
+                                            VPR_LOCATION);
+         }
+      }
+   }
    else
    {
       vprDEBUG( gadgetDBG_NET_MGR, vprDBG_CONFIG_LVL )
@@ -629,20 +927,88 @@ NodePtr NetworkManager::getNodeByName(const std::string& node_name)
    return NodePtr();
 }
 
-bool NetworkManager::connectToSlaves()
+bool NetworkManager::connectToSlaves(const vpr::Interval& timeout)
 {
-   bool ret_val = false;
+   const vpr::Interval start(vpr::Interval::now());
 
+   mConnectStatus.clear();
    for (node_list_t::iterator itr = mNodes.begin(); itr != mNodes.end(); itr++)
    {
-      if (connectTo(*itr))
+      if ( ! (*itr)->isConnected() )
       {
-         // If any of the nodes were successful connecting
-         // then we should return true
-         ret_val = true;
+         mConnectStatus.push_back(ConnectStatus());
+         mConnectStatus.back().node = *itr;
       }
    }
-   return ret_val;
+
+   // The status list is not resized from here on, so each thread can be
+   // handed a reference to its own entry.
+   std::vector<vpr::Thread*> threads;
+   threads.reserve(mConnectStatus.size());
+
+   for ( connect_status_list_t::iterator s = mConnectStatus.begin();
+         s != mConnectStatus.end(); ++s )
+   {
+      try
+      {
+         threads.push_back(
+            new vpr::Thread(boost::bind(&NetworkManager::connectTo, this,
+                                        boost::ref(*s), start, timeout))
+         );
+      }
+      catch (vpr::Exception&)
+      {
+         // Out of threads.  This node has to wait for its turn.
+         connectTo(*s, start, timeout);
+      }
+   }
+
+   for ( std::vector<vpr::Thread*>::iterator t = threads.begin();
+         t != threads.end(); ++t )
+   {
+      (*t)->join();
+      delete *t;
+   }
+
+   bool all_connected(true);
+
+   for ( connect_status_list_t::iterator s = mConnectStatus.begin();
+         s != mConnectStatus.end(); ++s )
+   {
+      // The reactor is not thread safe, so the nodes are added to it only
+      // after all of the connection threads are done.
+      if ( s->connected )
+      {
+         mReactor.addNode(s->node);
+
+         vprDEBUG(gadgetDBG_NET_MGR, vprDBG_CONFIG_STATUS_LVL)
+            << clrOutBOLD(clrBLUE, "[NetworkManager]")
+            << " Connected to " << s->node->getName() << " ("
+            << s->node->getHostname() << ":" << s->node->getPort()
+            << ") in " << s->time.msec() << " ms after " << s->attempts
+            << " attempt(s)" << std::endl << vprDEBUG_FLUSH;
+      }
+      else
+      {
+         all_connected = false;
+
+         vprDEBUG(gadgetDBG_NET_MGR, vprDBG_CRITICAL_LVL)
+            << clrOutBOLD(clrBLUE, "[NetworkManager]")
+            << clrOutBOLD(clrRED, " ERROR:")
+            << " Could not connect to " << s->node->getName() << " ("
+            << s->node->getHostname() << ":" << s->node->getPort()
+            << ") within " << timeout.msec() << " ms after " << s->attempts
+            << " attempt(s): " << s->error << std::endl << vprDEBUG_FLUSH;
+      }
+   }
+
+   vprDEBUG(gadgetDBG_NET_MGR, vprDBG_CONFIG_STATUS_LVL)
+      << clrOutBOLD(clrBLUE, "[NetworkManager]")
+      << " Connecting to " << mConnectStatus.size() << " node(s) took "
+      << (vpr::Interval::now() - start).msec() << " ms"
+      << std::endl << vprDEBUG_FLUSH;
+
+   return all_connected;
 }
 
 void NetworkManager::sendToAll(cluster::PacketPtr packet)
@@ -694,12 +1060,11 @@ void NetworkManager::uncorkNetwork()
 }
 
 
-bool NetworkManager::connectTo(NodePtr node)
+void NetworkManager::connectTo(ConnectStatus& status,
+                               const vpr::Interval& start,
+                               const vpr::Interval& timeout)
 {
-   //vprASSERT( Node::PENDING == node->getStatus() &&
-   //           "Can not connect to a node that is not pending." );
-
-   vpr::SocketStream* sock_stream(NULL);
+   NodePtr node(status.node);
    vpr::InetAddr inet_addr;
 
    vprDEBUG( gadgetDBG_NET_MGR, vprDBG_CONFIG_STATUS_LVL)
@@ -712,71 +1077,248 @@ bool NetworkManager::connectTo(NodePtr node)
       // Set the address that we want to connect to
       inet_addr.setAddress( node->getHostname(), node->getPort() );
    }
-   catch (vpr::IOException&)
+   catch (vpr::IOException& ex)
    {
-      vprDEBUG( gadgetDBG_NET_MGR, vprDBG_CRITICAL_LVL )
-         << clrOutBOLD( clrBLUE,"[NetworkManager]" )
-         << clrOutBOLD( clrRED, " ERROR:" )
-         << " Failed to set address" << std::endl << vprDEBUG_FLUSH;
-      return false;
+      status.error = "Failed to set address: " + ex.getDescription();
+      status.time  = vpr::Interval::now() - start;
+      return;
    }
 
-   // Create a new socket stream to this address
-   sock_stream = new vpr::SocketStream( vpr::InetAddr::AnyAddr, inet_addr );
+   vpr::SocketStream* sock_stream(NULL);
+
+   try
+   {
+      while ( NULL == sock_stream )
+      {
+         ++status.attempts;
+
+         // A socket whose connection was refused cannot be reused on every
+         // platform, so each attempt gets a new one.
+         sock_stream =
+            new vpr::SocketStream( vpr::InetAddr::AnyAddr, inet_addr );
 
 #ifdef GADGET_DEBUG
-   typedef class vpr::IOStatsStrategyAdapter<class vpr::BaseIOStatsStrategy, class vpr::BandwidthIOStatsStrategy>  strategy_t;
-   vpr::BaseIOStatsStrategy* new_strategy = new strategy_t;
-   sock_stream->setIOStatStrategy(new_strategy);
+         typedef class vpr::IOStatsStrategyAdapter<class vpr::BaseIOStatsStrategy, class vpr::BandwidthIOStatsStrategy>  strategy_t;
+         vpr::BaseIOStatsStrategy* new_strategy = new strategy_t;
+         sock_stream->setIOStatStrategy(new_strategy);
 #endif
 
-   // If we can successfully open the socket and connect to the server
-   sock_stream->open();
+         try
+         {
+            sock_stream->open();
+            sock_stream->connect();
+         }
+         catch (vpr::IOException& ex)
+         {
+            destroySocket(sock_stream);
+            sock_stream = NULL;
+
+            const vpr::Interval remaining(getRemaining(start, timeout));
+            if ( vpr::Interval::NoWait == remaining )
+            {
+               throw;
+            }
+
+            vprDEBUG( gadgetDBG_NET_MGR, vprDBG_STATE_LVL )
+               << clrOutBOLD( clrBLUE,"[NetworkManager]" )
+               << " Could not connect to Node: "
+               << node->getHostname() << " : " << node->getPort()
+               << " attempt: " << status.attempts << std::endl
+               << ex.getExtendedDescription() << std::endl << vprDEBUG_FLUSH;
+
+            vpr::System::msleep(
+               std::min(remaining, CONNECT_RETRY_INTERVAL).msec()
+            );
+         }
+      }
+
+      vprDEBUG( gadgetDBG_NET_MGR, vprDBG_STATE_LVL )
+         << clrOutBOLD( clrBLUE,"[NetworkManager]" )
+         << " Successfully connected to: "
+         << node->getHostname() <<":"<< node->getPort()
+         << std::endl << vprDEBUG_FLUSH;
+
+      sock_stream->setNoDelay( true );
+      node->setSockStream( sock_stream );
+      sock_stream = NULL;
+
+      // Use shared memory instead of the socket if the node is on this host.
+      offerShmChannel(node, getRemaining(start, timeout));
 
-   vpr::Uint16 retry_count(0);
-   while (!sock_stream->isConnected())
+      node->setStatus( Node::CONNECTED );
+      status.connected = true;
+   }
+   catch (vpr::IOException& ex)
    {
-      try
+      status.error = ex.getDescription();
+
+      if ( NULL != sock_stream )
       {
-         sock_stream->connect();
+         destroySocket(sock_stream);
+      }
 
-         vprDEBUG( gadgetDBG_NET_MGR, vprDBG_CONFIG_STATUS_LVL )
-            << clrOutBOLD( clrBLUE,"[NetworkManager]" )
-            << " Successfully connected to: "
-            << node->getHostname() <<":"<< node->getPort()
-            << std::endl << vprDEBUG_FLUSH;
+      // Closes the socket if the node was given one already.
+      node->shutdown();
+   }
+
+   status.time = vpr::Interval::now() - start;
+}
+
+void NetworkManager::offerShmChannel(NodePtr node,
+                                     const vpr::Interval& timeout)
+{
+   const vpr::Interval start(vpr::Interval::now());
+
+   TransportMessage hello;
+   if ( ! recvTransportMessage(node,
+                               std::min(timeout, TRANSPORT_HANDSHAKE_TIMEOUT),
+                               hello) ||
+        TransportMessage::HELLO != hello.kind )
+   {
+      vprDEBUG(gadgetDBG_NET_MGR, vprDBG_CONFIG_STATUS_LVL)
+         << clrOutBOLD(clrBLUE, "[NetworkManager]")
+         << " " << node->getName() << " does not negotiate the transport; "
+         << "using the socket" << std::endl << vprDEBUG_FLUSH;
+      return;
+   }
+
+   SharedMemoryChannelPtr channel;
+   std::string disable;
+
+   if ( SharedMemoryChannel::isSupported() &&
+        ! vpr::System::getenv("GADGET_DISABLE_SHM_TRANSPORT", disable) &&
+        isSameHost(node->getSockStream()) )
+   {
+      try
+      {
+         channel = SharedMemoryChannel::create();
       }
       catch (vpr::IOException& ex)
       {
-         vpr::Uint16 level = vprDBG_CONFIG_STATUS_LVL;
+         vprDEBUG(gadgetDBG_NET_MGR, vprDBG_WARNING_LVL)
+            << clrOutBOLD(clrYELLOW, "WARNING: ")
+            << "Failed to create shared memory channel for "
+            << node->getName() << ": " << ex.what()
+            << std::endl << vprDEBUG_FLUSH;
+      }
+   }
 
-         if (retry_count >= 50)
-         { level = vprDBG_CRITICAL_LVL; }
+   TransportMessage offer(TransportMessage::OFFER);
+   TransportMessage answer;
+   bool answered(false);
 
-         vprDEBUG( gadgetDBG_NET_MGR, level)
-            << clrOutBOLD( clrBLUE,"[NetworkManager]" )
-            << clrOutBOLD( clrRED, " ERROR:" )
-            << " Could not connect to Node: "
-            << node->getHostname() << " : " << node->getPort()
-            << " retry: " << retry_count << std::endl
-            << ex.getExtendedDescription() << std::endl << vprDEBUG_FLUSH;
+   if ( NULL != channel.get() )
+   {
+      offer.name = channel->getName();
+   }
 
-         if (retry_count > 50)
-         { throw; }
+   try
+   {
+      sendTransportMessage(node, offer);
 
-         retry_count++;
-         vpr::System::sleep(1);
+      if ( NULL != channel.get() )
+      {
+         answered = recvTransportMessage(node, getRemaining(start, timeout),
+                                         answer);
+      }
+   }
+   catch (vpr::IOException&)
+   {
+      if ( NULL != channel.get() )
+      {
+         channel->unlink();
       }
+      throw;
    }
 
-   sock_stream->setNoDelay( true );
-   node->setSockStream( sock_stream );
+   if ( NULL == channel.get() )
+   {
+      return;
+   }
 
-   // XXX: Should be alright.
-   node->setStatus( Node::CONNECTED );
-   mReactor.addNode(node);
+   // The peer has mapped the segment (or given up on it), so the name is
+   // no longer needed.
+   channel->unlink();
 
-   return true;
+   // A peer that moved on to the frame loop has declined the offer.
+   if ( ! answered && ! node->hasPendingPacket() )
+   {
+      throw vpr::TimeoutException("No answer to the shared memory offer.",
+                                  VPR_LOCATION);
+   }
+
+   if ( answered && TransportMessage::ANSWER == answer.kind &&
+        answer.accepted )
+   {
+      node->setShmChannel(channel);
+
+      vprDEBUG(gadgetDBG_NET_MGR, vprDBG_CONFIG_STATUS_LVL)
+         << clrOutBOLD(clrBLUE, "[NetworkManager]")
+         << " Using shared memory for " << node->getName()
+         << std::endl << vprDEBUG_FLUSH;
+   }
+}
+
+void NetworkManager::acceptShmChannel(NodePtr node)
+{
+   try
+   {
+      TransportMessage hello(TransportMessage::HELLO);
+      sendTransportMessage(node, hello);
+
+      TransportMessage offer;
+      if ( ! recvTransportMessage(node, TRANSPORT_HANDSHAKE_TIMEOUT, offer) ||
+           TransportMessage::OFFER != offer.kind )
+      {
+         vprDEBUG(gadgetDBG_NET_MGR, vprDBG_CONFIG_STATUS_LVL)
+            << clrOutBOLD(clrBLUE, "[NetworkManager]")
+            << " " << node->getName() << " does not negotiate the transport; "
+            << "using the socket" << std::endl << vprDEBUG_FLUSH;
+         return;
+      }
+
+      if ( offer.name.empty() )
+      {
+         return;
+      }
+
+      TransportMessage answer(TransportMessage::ANSWER);
+      SharedMemoryChannelPtr channel;
+
+      try
+      {
+         channel = SharedMemoryChannel::attach(offer.name);
+         answer.accepted = true;
+      }
+      catch (vpr::IOException& ex)
+      {
+         vprDEBUG(gadgetDBG_NET_MGR, vprDBG_WARNING_LVL)
+            << clrOutBOLD(clrYELLOW, "WARNING: ")
+            << "Failed to attach shared memory channel " << offer.name
+            << ": " << ex.what() << std::endl << vprDEBUG_FLUSH;
+      }
+
+      // The answer is the last packet that goes through the socket.
+      sendTransportMessage(node, answer);
+
+      if ( NULL != channel.get() )
+      {
+         node->setShmChannel(channel);
+
+         vprDEBUG(gadgetDBG_NET_MGR, vprDBG_CONFIG_STATUS_LVL)
+            << clrOutBOLD(clrBLUE, "[NetworkManager]")
+            << " Using shared memory for " << node->getName()
+            << std::endl << vprDEBUG_FLUSH;
+      }
+   }
+   catch (vpr::IOException& ex)
+   {
+      // A broken connection shows up again in the first frame.
+      vprDEBUG(gadgetDBG_NET_MGR, vprDBG_WARNING_LVL)
+         << clrOutBOLD(clrYELLOW, "WARNING: ")
+         << "Transport negotiation with " << node->getName()
+         << " failed: " << ex.what() << std::endl << vprDEBUG_FLUSH;
+   }
 }
 
 void NetworkManager::shutdown()
@@ -882,11 +1424,29 @@ void NetworkManager::addHandler(PacketHandlerPtr newHandler)
 {
    packet_handler_map_t::value_type p 
       = std::make_pair( newHandler->getHandlerGUID(), newHandler );
-   mHandlerMap.insert( p );
+   if ( mHandlerMap.insert( p ).second )
+   {
+      mHandlerChannels.push_back(p.first);
+   }
 
    vprDEBUG( gadgetDBG_NET_MGR, vprDBG_CONFIG_LVL )
       << clrOutBOLD( clrBLUE, "[Reactor] " )
       << "Adding Handler: " << newHandler->getHandlerName() << std::endl << vprDEBUG_FLUSH;
 }
 
+vpr::Uint16 NetworkManager::getHandlerChannel(const vpr::GUID& handlerGuid) const
+{
+   // Handler channel 0 means "unassigned", so the channels start at 1.
+   std::vector<vpr::GUID>::const_iterator found =
+      std::find(mHandlerChannels.begin(), mHandlerChannels.end(), handlerGuid);
+   const std::vector<vpr::GUID>::size_type index =
+      found - mHandlerChannels.begin();
+
+   if ( found == mHandlerChannels.end() || index >= 0xFFFF )
+   {
+      return 0;
+   }
+   return static_cast<vpr::Uint16>(index + 1);
+}
+
 } // end namespace gadget
@@ -43,8 +43,12 @@
 #  include <map>
 #endif
 
+#include <string>
+#include <vector>
+
 #include <vpr/IO/Socket/SocketStream.h>
 #include <vpr/Util/GUID.h>
+#include <vpr/Util/Interval.h>
 
 #include <jccl/RTRC/ConfigElementHandler.h>
 #include <jccl/Config/ConfigElementPtr.h>
@@ -53,6 +57,8 @@
 #include <gadget/Reactor.h>
 #include <gadget/PacketHandlerPtr.h>
 #include <cluster/Packets/PacketPtr.h>
+#include <cluster/Packets/EndBlockPtr.h>
+#include <cluster/FrameTracePtr.h>
 
 namespace gadget
 {
@@ -67,6 +73,25 @@ class GADGET_API NetworkManager
 public:
    typedef std::vector<NodePtr> node_list_t;
 
+   /**
+    * The outcome of connecting to one node in connectToSlaves().
+    */
+   struct ConnectStatus
+   {
+      ConnectStatus()
+         : connected(false)
+         , attempts(0)
+      {;}
+
+      NodePtr       node;
+      bool          connected;  /**< The connection and handshake finished. */
+      unsigned int  attempts;   /**< Number of connection attempts made. */
+      vpr::Interval time;       /**< Time taken to connect or to give up. */
+      std::string   error;      /**< Why the node could not be connected. */
+   };
+
+   typedef std::vector<ConnectStatus> connect_status_list_t;
+
    /**
     * Construct an empty representation of a network.
     */
@@ -92,6 +117,14 @@ public:
 
    void update( const int temp);
    void barrier( bool master );
+
+   /**
+    * Sends an end block to all connected nodes without waiting for theirs.
+    * The end blocks that they send for the same exchange are discarded
+    * when they arrive, so a later update() or barrier() still waits for
+    * the right one.
+    */
+   void sendUpdate( const int temp );
    
    /**
     * Optimize network traffic by gathering write calls.
@@ -107,6 +140,7 @@ public:
 private:
    size_t setAllUpdated( const bool updated );
    size_t sendEndBlocks( const int temp );
+   size_t sendEndBlocks( const cluster::EndBlockPtr& endBlock );
    void updateAllNodes( const size_t numNodes );
 
 public:
@@ -198,7 +232,35 @@ public:
    }
 
    void waitForConnection(const vpr::Uint16 listenPort);
-   bool connectToSlaves();
+
+   /**
+    * Connects to every node that is not connected yet.  Each node gets its
+    * own thread, so the connections and the handshakes that follow them
+    * proceed at the same time and startup takes as long as the slowest node
+    * instead of the sum over all of them.  A node that refuses the
+    * connection is retried until \p timeout has passed since the call.
+    *
+    * The outcome for each node is logged and kept until the next call (see
+    * getConnectStatus()).
+    *
+    * @note A connection attempt to a host that drops packets instead of
+    *       refusing them blocks until the operating system gives up on it,
+    *       which can take longer than \p timeout.
+    *
+    * @param timeout How long to keep trying to reach the nodes.
+    *
+    * @return true if every node is connected.
+    */
+   bool connectToSlaves(const vpr::Interval& timeout =
+                           vpr::Interval(60, vpr::Interval::Sec));
+
+   /**
+    * Returns the outcome for each node of the last connectToSlaves() call.
+    */
+   const connect_status_list_t& getConnectStatus() const
+   {
+      return mConnectStatus;
+   }
 
    /**
     * Send packet to all cluster nodes.
@@ -208,7 +270,42 @@ public:
    void sendToAll(cluster::PacketPtr packet);
 
 protected:
-   bool connectTo(NodePtr node);
+   /**
+    * Connects to the node of \p status, retrying until \p timeout has
+    * passed since \p start, and records the outcome in \p status.  When the
+    * node is on this host, a gadget::SharedMemoryChannel is offered to it as
+    * well and, if accepted, carries all packets instead of the socket.
+    *
+    * This runs in a thread of its own, so it must not touch the reactor or
+    * the node list.
+    */
+   void connectTo(ConnectStatus& status, const vpr::Interval& start,
+                  const vpr::Interval& timeout);
+
+private:
+   /**
+    * @name Shared memory transport negotiation.
+    *
+    * The negotiation travels in versioned cluster::DataPacket messages for
+    * a plugin ID of its own, which a peer that predates it drops as data
+    * for an unknown plugin.  Right after a connection is made, the accepting
+    * side sends a hello.  If it arrives in time, the connecting side answers
+    * with the name of a shared memory channel (or an empty name when the
+    * node is remote or the transport is disabled), and the accepting side
+    * answers whether it could map it.  The connecting side waits at most
+    * \p timeout for that answer.
+    *
+    * A peer that sends something else first, or nothing within a couple of
+    * seconds, is taken for an older one and the socket stays in use.  The
+    * packet that it sent is kept for the frame loop.  Setting the
+    * environment variable \c GADGET_DISABLE_SHM_TRANSPORT on the connecting
+    * side disables the transport.
+    */
+   //@{
+   void offerShmChannel(NodePtr node,
+                        const vpr::Interval& timeout = vpr::Interval::NoTimeout);
+   void acceptShmChannel(NodePtr node);
+   //@}
 
 public:
    /**
@@ -257,8 +354,32 @@ public:
    static bool isLocalHost(const std::string& testHostName);
 
    PacketHandlerPtr getHandlerByGUID(const vpr::GUID& handlerGuid);
+
+   /**
+    * Adds a packet handler and gives it the next handler channel.
+    */
    void addHandler(PacketHandlerPtr newHandler);
 
+   /**
+    * Returns the handler channel that was given to the identified handler
+    * when it was added.  Packets sent with it in their channel (see
+    * cluster::Header::getChannel()) are routed to the same handler on the
+    * receiving node by indexing a table of that node.  The GUID lookup
+    * happens only for the first such packet.
+    *
+    * @return 0 if there is no such handler or the channels have run out.
+    */
+   vpr::Uint16 getHandlerChannel(const vpr::GUID& handlerGuid) const;
+
+   /**
+    * Sets the trace in which the waits, barriers and end block round trips
+    * of this network are recorded.
+    */
+   void setFrameTrace(cluster::FrameTracePtr trace)
+   {
+      mFrameTrace = trace;
+   }
+
 private:
    node_list_t                  mNodes;         /**< List of nodes in network. */
    vpr::InetAddr                mListenAddr;    /**< Address to listen for incoming connections on. */
@@ -279,7 +400,22 @@ private:
 #endif
 
    packet_handler_map_t         mHandlerMap;
+   std::vector<vpr::GUID>       mHandlerChannels; /**< Handler channel - 1 to handler GUID */
    Reactor                      mReactor;
+   connect_status_list_t        mConnectStatus; /**< Outcome of connectToSlaves(). */
+
+   /** @name Reused end blocks
+    *
+    * End blocks go out several times per frame, so they are serialized
+    * once and only have their frame number patched before each send.  The
+    * barrier, which runs in the draw thread, has its own.
+    */
+   //@{
+   cluster::EndBlockPtr         mEndBlock;
+   cluster::EndBlockPtr         mBarrierEndBlock;
+   //@}
+
+   cluster::FrameTracePtr       mFrameTrace;    /**< Cluster frame timeline. */
 };
 
 } // end namespace gadget
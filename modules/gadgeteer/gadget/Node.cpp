@@ -29,9 +29,11 @@
 #include <boost/bind.hpp>
 
 #include <vpr/IO/Socket/SocketStream.h>
+#include <vpr/Util/FrameArena.h>
 
 #include <gadget/Node.h>
 #include <gadget/NetworkManager.h>
+#include <gadget/SharedMemoryChannel.h>
 #include <cluster/Packets/Packet.h>
 #include <cluster/Packets/DataPacket.h>
 #include <cluster/Packets/PacketFactory.h>
@@ -54,6 +56,8 @@ Node::Node(const std::string& name, const std::string& hostName,
    , mSockStream(socketStream)
    , mStatus(DISCONNECTED)
    , mUpdated(false)
+   , mDeferredEndBlocks(0)
+   , mDelta(0)
 {
    vprDEBUG(gadgetDBG_RIM,vprDBG_CONFIG_LVL)
       << clrOutBOLD(clrBLUE,"[Node]")
@@ -75,6 +79,14 @@ Node::~Node()
 void Node::shutdown()
 {
    setStatus(DISCONNECTED);
+   mChannelHandlers.clear();
+   mPendingPacket.reset();
+
+   if (NULL != mShmChannel.get())
+   {
+      mShmChannel->close();
+      mShmChannel.reset();
+   }
 
    if (NULL != mSockStream)
    {
@@ -87,6 +99,18 @@ void Node::shutdown()
    }
 }
 
+void Node::setChannelHandler(const vpr::Uint16 channel,
+                             PacketHandlerPtr handler)
+{
+   vprASSERT(0 != channel && "Handler channel 0 is never bound.");
+
+   if ( mChannelHandlers.size() <= channel )
+   {
+      mChannelHandlers.resize(channel + 1);
+   }
+   mChannelHandlers[channel] = handler;
+}
+
 void Node::debugDump(int debug_level)
 {
 
@@ -102,6 +126,11 @@ void Node::debugDump(int debug_level)
       << mPort << std::endl << vprDEBUG_FLUSH;
    vprDEBUG(gadgetDBG_NET_MGR, debug_level) << "SockStream "
       << (NULL == mSockStream ? "is NULL" : "is NOT NULL") << std::endl << vprDEBUG_FLUSH;
+   if (NULL != mShmChannel.get())
+   {
+      vprDEBUG(gadgetDBG_NET_MGR, debug_level) << "Shared memory: "
+         << mShmChannel->getName() << std::endl << vprDEBUG_FLUSH;
+   }
    if (CONNECTED == getStatus())
    {
       vprDEBUG(gadgetDBG_NET_MGR, debug_level) << clrOutBOLD(clrGREEN,"CONNECTED") << std::endl << vprDEBUG_FLUSH;
@@ -181,8 +210,16 @@ bool Node::send(cluster::PacketPtr outPacket)
    // -Send packet data
    try
    {
-      mSockStream->send( outPacket->getData(),
-                         outPacket->getHeader()->getPacketLength());
+      if (NULL != mShmChannel.get())
+      {
+         mShmChannel->send( &outPacket->getData()[0],
+                            outPacket->getHeader()->getPacketLength());
+      }
+      else
+      {
+         mSockStream->send( outPacket->getData(),
+                            outPacket->getHeader()->getPacketLength());
+      }
    }
    catch (vpr::IOException&)
    {
@@ -204,11 +241,32 @@ cluster::PacketPtr Node::recvPacket()
 
    vpr::Guard<vpr::Mutex> guard(mSockReadLock);
 
+   if ( NULL != mPendingPacket.get() )
+   {
+      cluster::PacketPtr packet;
+      packet.swap(mPendingPacket);
+      return packet;
+   }
+
+   // A received packet is handled and dropped within the frame, so the
+   // header and the packet are taken from the frame arena of this thread
+   // if it has one.
+   vpr::FrameArena::Scope frame_scope;
+
    cluster::HeaderPtr packet_head = cluster::Header::create();
 
    try
    {
-      packet_head->readData(mSockStream);
+      if (NULL != mShmChannel.get())
+      {
+         vpr::Uint8 header_data[cluster::Header::RIM_PACKET_HEAD_SIZE];
+         mShmChannel->recvn(header_data, sizeof(header_data));
+         packet_head->readData(header_data);
+      }
+      else
+      {
+         packet_head->readData(mSockStream);
+      }
    }
    catch (vpr::IOException& ex)
    {
@@ -266,11 +324,23 @@ cluster::PacketPtr Node::recvPacket()
    {
       try
       {
+         const vpr::Uint32 data_length =
+            packet_head->getPacketLength() - cluster::Header::RIM_PACKET_HEAD_SIZE;
+
          // Get packet data.
-         mSockStream->recvn(
-            new_packet->getData(),
-            packet_head->getPacketLength() - cluster::Header::RIM_PACKET_HEAD_SIZE
-         );
+         if (NULL != mShmChannel.get())
+         {
+            std::vector<vpr::Uint8>& data = new_packet->getData();
+            data.resize(data_length);
+            if (data_length > 0)
+            {
+               mShmChannel->recvn(&data[0], data_length);
+            }
+         }
+         else
+         {
+            mSockStream->recvn(new_packet->getData(), data_length);
+         }
       }
       catch (vpr::IOException&)
       {
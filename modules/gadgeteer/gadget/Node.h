@@ -29,13 +29,17 @@
 
 #include <gadget/gadgetConfig.h>
 
+#include <vector>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/noncopyable.hpp>
 
 #include <vpr/IO/Socket/SocketStream.h>
 #include <vpr/Thread/Thread.h>
+#include <vpr/Util/Interval.h>
 #include <gadget/Util/Debug.h>
 #include <gadget/NodePtr.h>
+#include <gadget/SharedMemoryChannelPtr.h>
+#include <gadget/PacketHandlerPtr.h>
 #include <cluster/Packets/PacketPtr.h>
 
 namespace gadget
@@ -146,6 +150,24 @@ public:
       mSockStream = stream;
    }
 
+   /**
+    * Returns the shared memory channel used to communicate with this node,
+    * if there is one.
+    */
+   SharedMemoryChannelPtr getShmChannel()
+   {
+      return mShmChannel;
+   }
+
+   /**
+    * Sets a shared memory channel to carry all packets to and from this
+    * node.  The socket stays open but is no longer used for packets.
+    */
+   void setShmChannel(SharedMemoryChannelPtr channel)
+   {
+      mShmChannel = channel;
+   }
+
    /**
     * Return if we are connected to this node.
     */
@@ -184,19 +206,112 @@ public:
    {
       mUpdated = update;
    }
+
+   /**
+    * Returns the time at which the last end block from this node was read.
+    * This is only kept while cluster::FrameTrace is recording.
+    */
+   const vpr::Interval& getUpdateTime() const
+   {
+      return mUpdateTime;
+   }
+
+   /**
+    * Sets the time at which the last end block from this node was read.
+    */
+   void setUpdateTime(const vpr::Interval& time)
+   {
+      mUpdateTime = time;
+   }
+
+   /**
+    * Records that an end block was sent to this node without waiting for
+    * the one that it sends back.  That end block is discarded when it
+    * arrives instead of marking this node as updated.
+    */
+   void deferEndBlock()
+   {
+      ++mDeferredEndBlocks;
+   }
+
+   /**
+    * Consumes one deferred end block.
+    *
+    * @return false if no end block from this node was deferred.
+    */
+   bool consumeDeferredEndBlock()
+   {
+      if ( mDeferredEndBlocks == 0 )
+      {
+         return false;
+      }
+
+      --mDeferredEndBlocks;
+      return true;
+   }
+
+   /**
+    * Keeps a packet that was read while the connection was being set up so
+    * that the next call to recvPacket() returns it.
+    */
+   void setPendingPacket(cluster::PacketPtr packet)
+   {
+      mPendingPacket = packet;
+   }
+
+   /**
+    * Returns true if recvPacket() will return a packet without reading.
+    */
+   bool hasPendingPacket() const
+   {
+      return NULL != mPendingPacket.get();
+   }
    
 public:
+   /**
+    * Returns the packet handler bound to the given handler channel of this
+    * node, or NULL if none is.  Channel 0 is never bound.
+    *
+    * @see cluster::Header::getChannel()
+    */
+   PacketHandler* getChannelHandler(const vpr::Uint16 channel) const
+   {
+      return channel < mChannelHandlers.size() ? mChannelHandlers[channel].get()
+                                               : NULL;
+   }
+
+   /**
+    * Binds a handler channel used by the remote side of this node to a
+    * local packet handler.  The bindings are dropped when the node is shut
+    * down, because the remote side numbers its handlers again when it
+    * reconnects.
+    *
+    * @pre \p channel is not 0.
+    */
+   void setChannelHandler(const vpr::Uint16 channel, PacketHandlerPtr handler);
+
    /**
     * Close the node's socket and disconnected status.
     */
    void shutdown();
 
    /**
-    * Get the time delta between the remote and local clock.
+    * Get the time delta between the remote and local clock: the local clock
+    * minus the remote clock in microseconds, wrapped to 64 bits so that it
+    * can be added to a time stamp from this node.  It is 0 unless the
+    * cluster::FrameTrace of the master has estimated it.
     */
-   vpr::Uint64* getDelta()
+   vpr::Uint64 getDelta() const
    {
-      return &mDelta;
+      return mDelta;
+   }
+
+   /**
+    * Set the time delta between the remote and local clock.
+    */
+   void setDelta(const vpr::Uint64 delta)
+   {
+      mDelta = delta;
    }
   
    /**
@@ -215,6 +330,7 @@ protected:
    vpr::Uint16          mPort;                  /**< Port that it is connected to */
 
    vpr::SocketStream*   mSockStream;            /**< Socket used for communication to this node */      
+   SharedMemoryChannelPtr mShmChannel;          /**< Used instead of mSockStream for a node on this host */
    vpr::Mutex           mSockWriteLock;         /**< Lock writing to the SocketStream */
    vpr::Mutex           mSockReadLock;          /**< Lock reading from the SocketStream */
 
@@ -222,8 +338,13 @@ protected:
    int                  mStatus;                /**< States if this node is connected */
 
    bool                 mUpdated;               /**< States if this node is updated */
+   unsigned int         mDeferredEndBlocks;     /**< End blocks not waited for */
+   vpr::Interval        mUpdateTime;            /**< When the last end block was read */
+   cluster::PacketPtr   mPendingPacket;         /**< Read while connecting */
 
    vpr::Uint64          mDelta;                 /**< Time delta between remote and local clocks. */
+
+   std::vector<PacketHandlerPtr> mChannelHandlers; /**< Handler channel to local handler */
 };
 
 } // end namespace gadget
@@ -26,15 +26,48 @@
 
 #include <gadget/gadgetConfig.h>
 
+#include <algorithm>
+
+#include <vpr/IO/IOException.h>
+#include <vpr/IO/TimeoutException.h>
+
 #include <gadget/Node.h>
+#include <gadget/SharedMemoryChannel.h>
 #include <gadget/Reactor.h>
 
 
+namespace
+{
+
+/**
+ * Longest time spent in select(2) at once when shared memory nodes have to
+ * be polled as well.
+ */
+const vpr::Interval MIXED_POLL_INTERVAL(200, vpr::Interval::Usec);
+
+}
+
 namespace gadget
 {
 
 void Reactor::addNode(gadget::NodePtr node)
 {
+   // A packet read while connecting does not show up on the socket.
+   if ( node->hasPendingPacket() )
+   {
+      mPendingNodes.push_back(node);
+   }
+
+   if ( NULL != node->getShmChannel().get() )
+   {
+      if ( std::find(mShmNodes.begin(), mShmNodes.end(), node) ==
+              mShmNodes.end() )
+      {
+         mShmNodes.push_back(node);
+      }
+      return;
+   }
+
    vpr::IOSys::Handle handle = node->getSockStream()->getHandle();
 
    if ( mDemuxTable.find(handle) == mDemuxTable.end() )
@@ -47,6 +80,19 @@ void Reactor::addNode(gadget::NodePtr node)
 
 void Reactor::removeNode(gadget::NodePtr node)
 {
+   mPendingNodes.erase(std::remove(mPendingNodes.begin(), mPendingNodes.end(),
+                                   node),
+                       mPendingNodes.end());
+
+   std::vector<gadget::NodePtr>::iterator shm_node =
+      std::find(mShmNodes.begin(), mShmNodes.end(), node);
+
+   if ( shm_node != mShmNodes.end() )
+   {
+      mShmNodes.erase(shm_node);
+      return;
+   }
+
    vpr::IOSys::Handle handle = node->getSockStream()->getHandle();
 
    typedef std::map<vpr::IOSys::Handle, gadget::NodePtr>::iterator iter_t;
@@ -60,15 +106,133 @@ void Reactor::removeNode(gadget::NodePtr node)
 }
 
 std::vector<gadget::NodePtr> Reactor::getReadyNodes(const vpr::Interval& timeout)
+{
+   std::vector<gadget::NodePtr> ready_nodes;
+
+   if ( ! mPendingNodes.empty() )
+   {
+      ready_nodes.swap(mPendingNodes);
+      return ready_nodes;
+   }
+
+   if ( mShmNodes.empty() )
+   {
+      selectSocketNodes(ready_nodes, timeout);
+      return ready_nodes;
+   }
+
+   const bool have_sockets(mSelector.getNumHandles() > 0);
+   const bool forever(vpr::Interval::NoTimeout == timeout);
+   const vpr::Interval start(vpr::Interval::now());
+
+   while ( true )
+   {
+      pollShmNodes(ready_nodes);
+
+      if ( ! ready_nodes.empty() )
+      {
+         if ( have_sockets )
+         {
+            try
+            {
+               selectSocketNodes(ready_nodes, vpr::Interval::NoWait);
+            }
+            catch (vpr::TimeoutException&)
+            {
+               /* No socket is ready yet. */ ;
+            }
+         }
+
+         return ready_nodes;
+      }
+
+      vpr::Interval remaining(timeout);
+      if ( ! forever )
+      {
+         const vpr::Interval elapsed(vpr::Interval::now() - start);
+         if ( timeout <= elapsed )
+         {
+            throw vpr::TimeoutException("Timeout occured while waiting for nodes.",
+                                        VPR_LOCATION);
+         }
+         remaining = timeout - elapsed;
+      }
+
+      // With sockets in the mix, alternate between short selects and polling
+      // the shared memory rings.
+      if ( have_sockets )
+      {
+         const vpr::Interval slice(remaining < MIXED_POLL_INTERVAL ? remaining
+                                                                   : MIXED_POLL_INTERVAL);
+         try
+         {
+            selectSocketNodes(ready_nodes, slice);
+         }
+         catch (vpr::TimeoutException&)
+         {
+            /* Poll the shared memory nodes again. */ ;
+         }
+
+         if ( ! ready_nodes.empty() )
+         {
+            pollShmNodes(ready_nodes);
+            return ready_nodes;
+         }
+
+         continue;
+      }
+
+      // Otherwise, sleep on a node that still has to send its update.  Any
+      // such node has to be read before the caller can finish, so there is
+      // no point in waking up for the others first.
+      gadget::NodePtr waiting_node;
+      typedef std::vector<gadget::NodePtr>::iterator iter_t;
+      for ( iter_t i = mShmNodes.begin(); i != mShmNodes.end(); ++i )
+      {
+         if ( NULL != (*i)->getShmChannel().get() )
+         {
+            if ( NULL == waiting_node.get() || ! (*i)->isUpdated() )
+            {
+               waiting_node = *i;
+            }
+
+            if ( ! (*i)->isUpdated() )
+            {
+               break;
+            }
+         }
+      }
+
+      if ( NULL == waiting_node.get() )
+      {
+         // Every shared memory node has been shut down.
+         selectSocketNodes(ready_nodes, remaining);
+         return ready_nodes;
+      }
+
+      try
+      {
+         waiting_node->getShmChannel()->waitReadReady(remaining);
+      }
+      catch (vpr::IOException&)
+      {
+         // The peer is gone.  Hand the node back so that reading from it
+         // fails and it gets shut down.
+         ready_nodes.push_back(waiting_node);
+         return ready_nodes;
+      }
+   }
+}
+
+void Reactor::selectSocketNodes(std::vector<gadget::NodePtr>& readyNodes,
+                                const vpr::Interval& timeout)
 {
    vpr::Uint16 num_events(0);
    mSelector.select(num_events, timeout);
 
-   std::vector<gadget::NodePtr> ready_nodes;
-
    if ( num_events > 0 )
    {
-      ready_nodes.reserve(num_events);
+      readyNodes.reserve(readyNodes.size() + num_events);
       vpr::Uint16 event_mask;
       const vpr::Uint16 num_handles = mSelector.getNumHandles();
       for ( vpr::Uint16 i = 0; i < num_handles; ++i )
@@ -78,12 +242,24 @@ std::vector<gadget::NodePtr> Reactor::getReadyNodes(const vpr::Interval& timeout
 
          if ( 0 != event_mask )
          {
-            ready_nodes.push_back(mDemuxTable[h]);
+            readyNodes.push_back(mDemuxTable[h]);
          }
       }
    }
+}
 
-   return ready_nodes;
+void Reactor::pollShmNodes(std::vector<gadget::NodePtr>& readyNodes)
+{
+   typedef std::vector<gadget::NodePtr>::iterator iter_t;
+   for ( iter_t i = mShmNodes.begin(); i != mShmNodes.end(); ++i )
+   {
+      SharedMemoryChannelPtr channel((*i)->getShmChannel());
+
+      if ( NULL != channel.get() && channel->isReadReady() )
+      {
+         readyNodes.push_back(*i);
+      }
+   }
 }
 
 }
@@ -29,6 +29,7 @@
 
 #include <gadget/gadgetConfig.h>
 
+#include <map>
 #include <vector>
 
 #include <vpr/IO/Selector.h>
@@ -39,6 +40,15 @@ namespace gadget
 
 class Node;
 
+/** \class Reactor Reactor.h gadget/Reactor.h
+ *
+ * Waits for incoming data from any node.  Nodes that communicate through a
+ * socket are watched with a vpr::Selector.  Nodes that communicate through
+ * a gadget::SharedMemoryChannel are polled, and when those are the only
+ * nodes, the reactor sleeps on the channel of a node that has not been
+ * updated yet.  A node that already holds a packet read while connecting
+ * is reported as ready first.
+ */
 class Reactor
 {
 public:
@@ -54,8 +64,22 @@ public:
    }
 
 private:
+   /**
+    * Adds the socket nodes that are ready to read to \p readyNodes.
+    *
+    * @throw vpr::TimeoutException is thrown if no socket becomes ready
+    *        within \p timeout.
+    */
+   void selectSocketNodes(std::vector<gadget::NodePtr>& readyNodes,
+                          const vpr::Interval& timeout);
+
+   /** Adds the shared memory nodes that have data to \p readyNodes. */
+   void pollShmNodes(std::vector<gadget::NodePtr>& readyNodes);
+
    vpr::Selector mSelector;
    std::map<vpr::IOSys::Handle, gadget::NodePtr> mDemuxTable;
+   std::vector<gadget::NodePtr> mShmNodes;
+   std::vector<gadget::NodePtr> mPendingNodes;
 };
 
 }
@@ -0,0 +1,582 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <gadget/gadgetConfig.h>
+
+#include <sstream>
+#include <cstring>
+
+// Defines the platform macro tested below.
+#include <vpr/vprConfig.h>
+
+#if defined(VPR_OS_Linux)
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <signal.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/syscall.h>
+#  include <linux/futex.h>
+#  include <time.h>
+#endif
+
+#include <vpr/IO/IOException.h>
+
+#include <gadget/Util/Debug.h>
+#include <gadget/SharedMemoryChannel.h>
+
+
+namespace
+{
+
+const vpr::Uint32 SEGMENT_MAGIC(0x47534d43);   // "GSMC"
+const vpr::Uint32 SEGMENT_VERSION(1);
+
+/**
+ * Longest single sleep in a blocking call.  Between sleeps, the channel
+ * checks that the peer is still around.
+ */
+const vpr::Interval PEER_CHECK_INTERVAL(100, vpr::Interval::Msec);
+
+const size_t CACHE_LINE_SIZE(64);
+
+}
+
+namespace gadget
+{
+
+// Everything in the shared segment is plain data so that the layout is the
+// same in every process that maps it.  The read and write indices are kept
+// on separate cache lines so that the two sides do not contend for them.
+struct SharedMemoryChannel::Ring
+{
+   vpr::Uint32 head;          /**< Total bytes written (wraps) */
+   vpr::Uint8  pad0[CACHE_LINE_SIZE - sizeof(vpr::Uint32)];
+   vpr::Uint32 tail;          /**< Total bytes read (wraps) */
+   vpr::Uint8  pad1[CACHE_LINE_SIZE - sizeof(vpr::Uint32)];
+   vpr::Uint32 dataSeq;       /**< Futex word bumped when data is written */
+   vpr::Uint32 readerWaiting;
+   vpr::Uint32 spaceSeq;      /**< Futex word bumped when data is read */
+   vpr::Uint32 writerWaiting;
+   vpr::Uint8  pad2[CACHE_LINE_SIZE - 4 * sizeof(vpr::Uint32)];
+};
+
+struct SharedMemoryChannel::Segment
+{
+   vpr::Uint32 magic;
+   vpr::Uint32 version;
+   vpr::Uint32 ringSize;
+   vpr::Uint32 closed;
+   vpr::Int32  creatorPid;
+   vpr::Int32  attacherPid;
+   vpr::Uint8  pad[CACHE_LINE_SIZE - 6 * sizeof(vpr::Uint32)];
+   Ring        rings[2];
+};
+
+#if defined(VPR_OS_Linux)
+
+namespace
+{
+
+/**
+ * Number of times a reader or writer polls before it sleeps.  Spinning only
+ * helps when the peer can run at the same time, so there is none on a
+ * uniprocessor.
+ */
+const unsigned int SPIN_COUNT(sysconf(_SC_NPROCESSORS_ONLN) > 1 ? 2000 : 0);
+
+inline void cpuRelax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+   __asm__ __volatile__("pause" ::: "memory");
+#else
+   __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+inline vpr::Uint32 load(const vpr::Uint32* value)
+{
+   const vpr::Uint32 result = *static_cast<const volatile vpr::Uint32*>(value);
+   __sync_synchronize();
+   return result;
+}
+
+inline void store(vpr::Uint32* value, const vpr::Uint32 newValue)
+{
+   __sync_synchronize();
+   *static_cast<volatile vpr::Uint32*>(value) = newValue;
+   __sync_synchronize();
+}
+
+std::string errorString(const std::string& what, const int err)
+{
+   std::ostringstream msg;
+   msg << what << ": " << std::strerror(err);
+   return msg.str();
+}
+
+}
+
+bool SharedMemoryChannel::isSupported()
+{
+   return true;
+}
+
+SharedMemoryChannelPtr SharedMemoryChannel::create(const vpr::Uint32 ringSize)
+{
+   vpr::Uint32 size(CACHE_LINE_SIZE);
+   while ( size < ringSize && size < 0x80000000u )
+   {
+      size <<= 1;
+   }
+
+   static vpr::Uint32 counter(0);
+
+   const size_t mapping_size = sizeof(Segment) + 2 * size_t(size);
+   std::string name;
+   int fd(-1);
+
+   // Stale segments left by a process that crashed with the same PID are
+   // skipped rather than reused.
+   for ( int attempt = 0; fd < 0 && attempt < 100; ++attempt )
+   {
+      std::ostringstream name_stream;
+      name_stream << "/gadget-shm-" << getpid() << "-"
+                  << __sync_fetch_and_add(&counter, 1);
+      name = name_stream.str();
+
+      fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+
+      if ( fd < 0 && errno != EEXIST )
+      {
+         throw vpr::IOException(errorString("shm_open(" + name + ")", errno),
+                                VPR_LOCATION);
+      }
+   }
+
+   if ( fd < 0 )
+   {
+      throw vpr::IOException("Could not find a free shared memory name",
+                             VPR_LOCATION);
+   }
+
+   if ( ftruncate(fd, mapping_size) != 0 )
+   {
+      const int err(errno);
+      ::close(fd);
+      shm_unlink(name.c_str());
+      throw vpr::IOException(errorString("ftruncate(" + name + ")", err),
+                             VPR_LOCATION);
+   }
+
+   void* mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+   const int err(errno);
+   ::close(fd);
+
+   if ( MAP_FAILED == mapping )
+   {
+      shm_unlink(name.c_str());
+      throw vpr::IOException(errorString("mmap(" + name + ")", err),
+                             VPR_LOCATION);
+   }
+
+   // ftruncate() zero-fills the segment, so only the non-zero fields need
+   // to be set.
+   Segment* segment = static_cast<Segment*>(mapping);
+   segment->ringSize   = size;
+   segment->creatorPid = getpid();
+   segment->version    = SEGMENT_VERSION;
+   store(&segment->magic, SEGMENT_MAGIC);
+
+   vprDEBUG(gadgetDBG_NET_MGR, vprDBG_CONFIG_LVL)
+      << "[SharedMemoryChannel] Created " << name << " with " << size
+      << " byte rings." << std::endl << vprDEBUG_FLUSH;
+
+   return SharedMemoryChannelPtr(
+      new SharedMemoryChannel(name, mapping, mapping_size, true)
+   );
+}
+
+SharedMemoryChannelPtr SharedMemoryChannel::attach(const std::string& name)
+{
+   const int fd = shm_open(name.c_str(), O_RDWR, 0);
+
+   if ( fd < 0 )
+   {
+      throw vpr::IOException(errorString("shm_open(" + name + ")", errno),
+                             VPR_LOCATION);
+   }
+
+   struct stat info;
+   if ( fstat(fd, &info) != 0 ||
+        static_cast<size_t>(info.st_size) < sizeof(Segment) )
+   {
+      ::close(fd);
+      throw vpr::IOException("Shared memory segment " + name +
+                                " is too small",
+                             VPR_LOCATION);
+   }
+
+   const size_t mapping_size(info.st_size);
+   void* mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+   const int err(errno);
+   ::close(fd);
+
+   if ( MAP_FAILED == mapping )
+   {
+      throw vpr::IOException(errorString("mmap(" + name + ")", err),
+                             VPR_LOCATION);
+   }
+
+   Segment* segment = static_cast<Segment*>(mapping);
+   if ( load(&segment->magic) != SEGMENT_MAGIC ||
+        segment->version != SEGMENT_VERSION ||
+        0 == segment->ringSize ||
+        0 != (segment->ringSize & (segment->ringSize - 1)) ||
+        sizeof(Segment) + 2 * size_t(segment->ringSize) > mapping_size )
+   {
+      munmap(mapping, mapping_size);
+      throw vpr::IOException("Shared memory segment " + name +
+                                " is not a channel",
+                             VPR_LOCATION);
+   }
+
+   segment->attacherPid = getpid();
+   __sync_synchronize();
+
+   return SharedMemoryChannelPtr(
+      new SharedMemoryChannel(name, mapping, mapping_size, false)
+   );
+}
+
+SharedMemoryChannel::SharedMemoryChannel(const std::string& name,
+                                         void* mapping,
+                                         const size_t mappingSize,
+                                         const bool creator)
+   : mName(name)
+   , mMapping(mapping)
+   , mMappingSize(mappingSize)
+   , mCreator(creator)
+   , mLinked(creator)
+   , mSegment(static_cast<Segment*>(mapping))
+{
+   // The creator writes ring 0 and reads ring 1.  The attacher does the
+   // opposite.
+   vpr::Uint8* data =
+      static_cast<vpr::Uint8*>(mapping) + sizeof(Segment);
+   const int out_index = creator ? 0 : 1;
+
+   mOut     = &mSegment->rings[out_index];
+   mIn      = &mSegment->rings[1 - out_index];
+   mOutData = data + out_index * mSegment->ringSize;
+   mInData  = data + (1 - out_index) * mSegment->ringSize;
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+   close();
+   unlink();
+   munmap(mMapping, mMappingSize);
+}
+
+void SharedMemoryChannel::unlink()
+{
+   if ( mLinked )
+   {
+      shm_unlink(mName.c_str());
+      mLinked = false;
+   }
+}
+
+void SharedMemoryChannel::close()
+{
+   store(&mSegment->closed, 1);
+
+   for ( int i = 0; i < 2; ++i )
+   {
+      __sync_fetch_and_add(&mSegment->rings[i].dataSeq, 1);
+      __sync_fetch_and_add(&mSegment->rings[i].spaceSeq, 1);
+      futexWake(&mSegment->rings[i].dataSeq);
+      futexWake(&mSegment->rings[i].spaceSeq);
+   }
+}
+
+void SharedMemoryChannel::send(const void* buffer, const vpr::Uint32 length)
+{
+   const vpr::Uint8* src = static_cast<const vpr::Uint8*>(buffer);
+   const vpr::Uint32 size(mSegment->ringSize);
+   const vpr::Uint32 mask(size - 1);
+   vpr::Uint32 remaining(length);
+
+   while ( remaining > 0 )
+   {
+      if ( load(&mSegment->closed) )
+      {
+         throw vpr::IOException("Shared memory channel is closed",
+                                VPR_LOCATION);
+      }
+
+      const vpr::Uint32 head = mOut->head;
+      vpr::Uint32 space = size - (head - load(&mOut->tail));
+
+      // Wait for the reader to make room.
+      for ( unsigned int spin = 0; 0 == space && spin < SPIN_COUNT; ++spin )
+      {
+         cpuRelax();
+         space = size - (head - load(&mOut->tail));
+      }
+
+      if ( 0 == space )
+      {
+         const vpr::Uint32 seq = load(&mOut->spaceSeq);
+         store(&mOut->writerWaiting, 1);
+
+         if ( size == head - load(&mOut->tail) )
+         {
+            futexWait(&mOut->spaceSeq, seq, PEER_CHECK_INTERVAL);
+            checkPeer();
+         }
+
+         store(&mOut->writerWaiting, 0);
+         continue;
+      }
+
+      // Copy up to the end of the ring, then publish the new head.
+      const vpr::Uint32 offset = head & mask;
+      vpr::Uint32 count = remaining < space ? remaining : space;
+      if ( count > size - offset )
+      {
+         count = size - offset;
+      }
+
+      std::memcpy(mOutData + offset, src, count);
+      store(&mOut->head, head + count);
+
+      src       += count;
+      remaining -= count;
+
+      if ( load(&mOut->readerWaiting) )
+      {
+         __sync_fetch_and_add(&mOut->dataSeq, 1);
+         futexWake(&mOut->dataSeq);
+      }
+   }
+}
+
+void SharedMemoryChannel::recvn(void* buffer, const vpr::Uint32 length)
+{
+   vpr::Uint8* dst = static_cast<vpr::Uint8*>(buffer);
+   const vpr::Uint32 size(mSegment->ringSize);
+   const vpr::Uint32 mask(size - 1);
+   vpr::Uint32 remaining(length);
+
+   while ( remaining > 0 )
+   {
+      if ( ! isReadReady() )
+      {
+         waitReadReady(vpr::Interval::NoTimeout);
+      }
+
+      const vpr::Uint32 tail = mIn->tail;
+      const vpr::Uint32 avail = load(&mIn->head) - tail;
+      const vpr::Uint32 offset = tail & mask;
+
+      vpr::Uint32 count = remaining < avail ? remaining : avail;
+      if ( count > size - offset )
+      {
+         count = size - offset;
+      }
+
+      std::memcpy(dst, mInData + offset, count);
+      store(&mIn->tail, tail + count);
+
+      dst       += count;
+      remaining -= count;
+
+      if ( load(&mIn->writerWaiting) )
+      {
+         __sync_fetch_and_add(&mIn->spaceSeq, 1);
+         futexWake(&mIn->spaceSeq);
+      }
+   }
+}
+
+bool SharedMemoryChannel::isReadReady() const
+{
+   return load(&mIn->head) != mIn->tail;
+}
+
+bool SharedMemoryChannel::waitReadReady(const vpr::Interval& timeout)
+{
+   for ( unsigned int spin = 0; spin < SPIN_COUNT; ++spin )
+   {
+      if ( isReadReady() )
+      {
+         return true;
+      }
+      cpuRelax();
+   }
+
+   const bool forever(vpr::Interval::NoTimeout == timeout);
+   const vpr::Interval start(vpr::Interval::now());
+
+   while ( ! isReadReady() )
+   {
+      checkPeer();
+
+      vpr::Interval slice(PEER_CHECK_INTERVAL);
+      if ( ! forever )
+      {
+         const vpr::Interval elapsed(vpr::Interval::now() - start);
+         if ( timeout <= elapsed )
+         {
+            return false;
+         }
+
+         const vpr::Interval left(timeout - elapsed);
+         if ( left < slice )
+         {
+            slice = left;
+         }
+      }
+
+      // The flag tells the writer to signal the futex.  Checking for data
+      // again after setting it closes the window where the writer could
+      // publish without seeing the flag.
+      const vpr::Uint32 seq = load(&mIn->dataSeq);
+      store(&mIn->readerWaiting, 1);
+
+      if ( ! isReadReady() )
+      {
+         futexWait(&mIn->dataSeq, seq, slice);
+      }
+
+      store(&mIn->readerWaiting, 0);
+   }
+
+   return true;
+}
+
+void SharedMemoryChannel::checkPeer() const
+{
+   if ( load(&mSegment->closed) )
+   {
+      throw vpr::IOException("Shared memory channel is closed", VPR_LOCATION);
+   }
+
+   const pid_t peer = mCreator ? mSegment->attacherPid : mSegment->creatorPid;
+
+   if ( peer > 0 && kill(peer, 0) != 0 && ESRCH == errno )
+   {
+      throw vpr::IOException("Shared memory channel peer has exited",
+                             VPR_LOCATION);
+   }
+}
+
+void SharedMemoryChannel::futexWait(vpr::Uint32* seq, const vpr::Uint32 value,
+                                    const vpr::Interval& timeout)
+{
+   struct timespec ts;
+   struct timespec* ts_ptr(NULL);
+
+   if ( vpr::Interval::NoTimeout != timeout )
+   {
+      const vpr::Uint64 usec = timeout.usec();
+      ts.tv_sec  = usec / 1000000;
+      ts.tv_nsec = (usec % 1000000) * 1000;
+      ts_ptr     = &ts;
+   }
+
+   // EAGAIN (the value already changed), EINTR and ETIMEDOUT all send the
+   // caller back to re-check the ring.
+   syscall(SYS_futex, seq, FUTEX_WAIT, value, ts_ptr, NULL, 0);
+}
+
+void SharedMemoryChannel::futexWake(vpr::Uint32* seq)
+{
+   syscall(SYS_futex, seq, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+#else /* ! VPR_OS_Linux */
+
+bool SharedMemoryChannel::isSupported()
+{
+   return false;
+}
+
+SharedMemoryChannelPtr SharedMemoryChannel::create(const vpr::Uint32)
+{
+   throw vpr::IOException("Shared memory channels are not supported",
+                          VPR_LOCATION);
+}
+
+SharedMemoryChannelPtr SharedMemoryChannel::attach(const std::string&)
+{
+   throw vpr::IOException("Shared memory channels are not supported",
+                          VPR_LOCATION);
+}
+
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+}
+
+void SharedMemoryChannel::unlink()
+{
+}
+
+void SharedMemoryChannel::close()
+{
+}
+
+void SharedMemoryChannel::send(const void*, const vpr::Uint32)
+{
+   throw vpr::IOException("Shared memory channels are not supported",
+                          VPR_LOCATION);
+}
+
+void SharedMemoryChannel::recvn(void*, const vpr::Uint32)
+{
+   throw vpr::IOException("Shared memory channels are not supported",
+                          VPR_LOCATION);
+}
+
+bool SharedMemoryChannel::isReadReady() const
+{
+   return false;
+}
+
+bool SharedMemoryChannel::waitReadReady(const vpr::Interval&)
+{
+   throw vpr::IOException("Shared memory channels are not supported",
+                          VPR_LOCATION);
+}
+
+#endif /* VPR_OS_Linux */
+
+} // End of gadget namespace
@@ -0,0 +1,192 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _GADGET_SHARED_MEMORY_CHANNEL_H_
+#define _GADGET_SHARED_MEMORY_CHANNEL_H_
+
+#include <gadget/gadgetConfig.h>
+
+#include <string>
+#include <boost/noncopyable.hpp>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Util/Interval.h>
+
+#include <gadget/SharedMemoryChannelPtr.h>
+
+
+namespace gadget
+{
+
+/** \class SharedMemoryChannel SharedMemoryChannel.h gadget/SharedMemoryChannel.h
+ *
+ * Byte stream between two processes on the same host, carried over a pair of
+ * ring buffers in a shared memory segment.  It is used in place of the
+ * socket of a gadget::Node when both ends of the connection run on the same
+ * machine.  The data written is the same cluster::Packet framing that would
+ * otherwise go over TCP.
+ *
+ * A reader that finds its ring empty spins briefly and then sleeps on a
+ * futex that the writer signals, so a packet is handed over in a few
+ * microseconds instead of a trip through the network stack.
+ *
+ * One side creates the segment with create() and passes getName() to the
+ * other side, which maps it with attach().  Once the peer has attached, the
+ * creator should call unlink() so that the segment goes away with the last
+ * process that has it mapped.
+ *
+ * Shared memory channels are only available on Linux.  Elsewhere,
+ * isSupported() returns false and create() and attach() throw.
+ *
+ * @note Each direction supports one reading thread and one writing thread.
+ *       gadget::Node serializes its reads and writes already.
+ */
+class GADGET_API SharedMemoryChannel
+   : boost::noncopyable
+{
+public:
+   /** Default capacity of each ring in bytes. */
+   static const vpr::Uint32 DEFAULT_RING_SIZE = 1024 * 1024;
+
+   /**
+    * Determines whether shared memory channels can be used on this platform.
+    */
+   static bool isSupported();
+
+   /**
+    * Creates a new shared memory segment with a unique name.
+    *
+    * @param ringSize The capacity of each direction in bytes.  It is rounded
+    *                 up to a power of two.
+    *
+    * @throw vpr::IOException is thrown if the segment cannot be created.
+    */
+   static SharedMemoryChannelPtr create(const vpr::Uint32 ringSize = DEFAULT_RING_SIZE);
+
+   /**
+    * Maps the segment created by another process.
+    *
+    * @param name The name returned by getName() in the creating process.
+    *
+    * @throw vpr::IOException is thrown if the segment cannot be mapped.
+    */
+   static SharedMemoryChannelPtr attach(const std::string& name);
+
+   /**
+    * Closes the channel and unmaps the segment.
+    */
+   ~SharedMemoryChannel();
+
+   /**
+    * Returns the name of the shared memory segment.
+    */
+   const std::string& getName() const
+   {
+      return mName;
+   }
+
+   /**
+    * Removes the name of the segment from the system.  The mapping stays
+    * valid in every process that has it.
+    */
+   void unlink();
+
+   /**
+    * Marks both directions of the channel closed and wakes the peer.  Any
+    * blocked or later read in the peer fails once the data already written
+    * has been consumed.
+    */
+   void close();
+
+   /**
+    * Writes all of the given bytes, blocking while the ring is full.
+    *
+    * @throw vpr::IOException is thrown if the channel is closed or the peer
+    *        process has exited.
+    */
+   void send(const void* buffer, const vpr::Uint32 length);
+
+   /**
+    * Reads exactly \p length bytes, blocking until they are available.
+    *
+    * @throw vpr::IOException is thrown if the channel is closed or the peer
+    *        process has exited before all the bytes arrive.
+    */
+   void recvn(void* buffer, const vpr::Uint32 length);
+
+   /**
+    * Determines whether there are bytes waiting to be read.
+    */
+   bool isReadReady() const;
+
+   /**
+    * Waits until there are bytes to read or \p timeout expires.
+    *
+    * @return true if data is available, false if the timeout expired.
+    *
+    * @throw vpr::IOException is thrown if the channel is closed or the peer
+    *        process has exited and there is nothing left to read.
+    */
+   bool waitReadReady(const vpr::Interval& timeout);
+
+private:
+   struct Ring;
+   struct Segment;
+
+   SharedMemoryChannel(const std::string& name, void* mapping,
+                       const size_t mappingSize, const bool creator);
+
+   /**
+    * Waits on the futex word \p seq until it changes from \p value or
+    * \p timeout expires.
+    */
+   static void futexWait(vpr::Uint32* seq, const vpr::Uint32 value,
+                         const vpr::Interval& timeout);
+
+   static void futexWake(vpr::Uint32* seq);
+
+   /**
+    * Throws if the channel has been closed or the peer process has gone
+    * away.
+    */
+   void checkPeer() const;
+
+   std::string mName;
+   void*       mMapping;
+   size_t      mMappingSize;
+   bool        mCreator;
+   bool        mLinked;
+   Segment*    mSegment;
+   Ring*       mOut;       /**< Ring that this process writes */
+   Ring*       mIn;        /**< Ring that this process reads */
+   vpr::Uint8* mOutData;
+   vpr::Uint8* mInData;
+};
+
+} // End of gadget namespace
+
+
+#endif /* _GADGET_SHARED_MEMORY_CHANNEL_H_ */
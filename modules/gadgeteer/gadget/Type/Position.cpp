@@ -160,6 +160,18 @@ const PositionData& Position::getPositionData(int devNum) const
    }
 }
 
+bool Position::getNewestPositionData(PositionData& data, const int devNum)
+{
+   if ( ! mPosSamples.newestReadySample(mNewestSample) ||
+        mNewestSample.size() <= static_cast<unsigned int>(devNum) )
+   {
+      return false;
+   }
+
+   data = mNewestSample[devNum];
+   return true;
+}
+
 void Position::writeObject(vpr::ObjectWriter* writer)
 {
    SampleBuffer_t::buffer_t& stable_buffer = mPosSamples.stableBuffer();
@@ -103,6 +103,20 @@ public:
    /** Get positional data. */
    const PositionData& getPositionData(int devNum = 0) const;
 
+   /**
+    * Gets the newest positional sample for the given unit that arrived
+    * after the last buffer swap.  Unlike getPositionData(), this reads the
+    * ready buffer, so it can be used to pick up a newer pose part way
+    * through a frame.  Devices that only sample in updateData() never have
+    * such a sample.
+    *
+    * @param data   Storage for the sample.
+    * @param devNum The unit to read.
+    *
+    * @return \c true if \p data was set.
+    */
+   bool getNewestPositionData(PositionData& data, const int devNum = 0);
+
    /**
     * Helper method to add a collection of positional samples to the sample
     * buffers.  This MUST be called by all positional devices to add a new
@@ -175,6 +189,9 @@ private:
 
    std::vector<PositionFilter*>  mPositionFilters;    /**< The active filters that are to be used */
    SampleBuffer_t                mPosSamples;         /**< Position samples */
+
+   /** Scratch storage for getNewestPositionData(). */
+   std::vector<PositionData>     mNewestSample;
 };
 
 } // End of gadget namespace
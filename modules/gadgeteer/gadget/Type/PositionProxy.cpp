@@ -185,21 +185,47 @@ void PositionProxy::updateData()
       // Make sure dependencies are updated.
       getProxiedInputDevice()->updateDataIfNeeded();
 
-      // Applly the filters to our sample and store it in mData.
-      mData = applyFilters(mTypedDevice->getPositionData(mUnit));
-
-      // --- CACHE FEET Scaling ---- //
-      mPosMatrix_feet = mData.getValue();
-      gmtl::Vec3f trans;                                       // SCALE: to feet
-      gmtl::setTrans(trans, mPosMatrix_feet);                  // Get the translational vector
-      trans *= PositionUnitConversion::ConvertToFeet;          // Scale the translation and set the value again
-      gmtl::setTrans(mPosMatrix_feet, trans);
+      setData(mTypedDevice->getPositionData(mUnit));
    }
 }
 
+bool PositionProxy::latchData()
+{
+   PositionData newest;
+
+   if ( mStupefied || NULL == mTypedDevice.get() ||
+        ! mTypedDevice->getNewestPositionData(newest, mUnit) )
+   {
+      return false;
+   }
+
+   setData(newest);
+   return true;
+}
+
+void PositionProxy::setData(const PositionData& posData)
+{
+   // Applly the filters to our sample and store it in mData.
+   mData = applyFilters(posData);
+
+   // --- CACHE FEET Scaling ---- //
+   mPosMatrix_feet = mData.getValue();
+   gmtl::Vec3f trans;                                       // SCALE: to feet
+   gmtl::setTrans(trans, mPosMatrix_feet);                  // Get the translational vector
+   trans *= PositionUnitConversion::ConvertToFeet;          // Scale the translation and set the value again
+   gmtl::setTrans(mPosMatrix_feet, trans);
+}
+
 const PositionData
 PositionProxy::applyFilters(const PositionData& posData) const
 {
+   // Most proxies have no filters.  Skip building the sample vector for
+   // them, since this runs for every proxy in every frame.
+   if ( mPositionFilters.empty() )
+   {
+      return posData;
+   }
+
    // Create a vector to hold all 1 of our position data samples.
    std::vector<PositionData> temp_sample(1, posData);
 
@@ -94,6 +94,17 @@ public:
     */
    virtual void updateData();
 
+   /**
+    * Replaces the proxy's data with the newest sample the device has taken
+    * since the last update, if there is one.  This is much cheaper than a
+    * full input update, so the kernel uses it to late-latch the head pose
+    * just before drawing.  The position filters are applied to the new
+    * sample as in updateData().
+    *
+    * @return \c true if the proxy's data changed.
+    */
+   bool latchData();
+
    /**
     * Applies the position filters configured for use by this object to the
     * given data.
@@ -142,6 +153,9 @@ public:
    bool config(jccl::ConfigElementPtr element);
 
 private:
+   /** Filters \p posData into mData and refreshes the cached feet matrix. */
+   void setData(const PositionData& posData);
+
    gmtl::Matrix44f   mPosMatrix_feet;                 /**< Cached version of data in feet */
 
    typedef boost::shared_ptr<PositionFilter> PositionFilterPtr;
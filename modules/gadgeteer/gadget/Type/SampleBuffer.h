@@ -143,6 +143,24 @@ public:
       mReadyBuffer.clear();
    }
 
+   /**
+    * Copies the newest sample that has not been swapped into the stable
+    * buffer yet.  This lets a reader see data that arrived after the last
+    * swap without swapping.
+    *
+    * @return \c true if the ready buffer held a sample.
+    */
+   bool newestReadySample(std::vector< DATA_TYPE >& sample)
+   {
+   vpr::Guard<vpr::Mutex>  guard(mLock);
+      if(mReadyBuffer.empty())
+      {
+         return false;
+      }
+      sample = mReadyBuffer.back();
+      return true;
+   }
+
    void lock()
    {
       mLock.acquire();
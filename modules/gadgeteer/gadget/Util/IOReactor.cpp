@@ -0,0 +1,265 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+#include <gadget/gadgetConfig.h>
+
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <vpr/IO/Selector.h>
+#include <vpr/IO/IOException.h>
+#include <vpr/IO/TimeoutException.h>
+#include <vpr/Sync/Guard.h>
+#include <vpr/Thread/ThreadPlacement.h>
+#include <vpr/Util/Debug.h>
+
+#include <gadget/Util/Debug.h>
+#include <gadget/Util/IOReactor.h>
+
+
+namespace
+{
+
+/**
+ * Longest time spent in a single select.  Data is dispatched as soon as it
+ * arrives regardless of this value; it only bounds how long registration
+ * changes wait to be picked up.
+ */
+const vpr::Interval MAX_SELECT_WAIT(20, vpr::Interval::Msec);
+
+}
+
+namespace gadget
+{
+
+vprSingletonImp(IOReactor);
+
+IOReactor::IOReactor()
+   : mChanged(false)
+   , mRunning(false)
+   , mRequestedPass(0)
+   , mCompletedPass(0)
+   , mThread(NULL)
+{
+   /* Do nothing. */ ;
+}
+
+IOReactor::~IOReactor()
+{
+   vpr::Guard<vpr::Mutex> control_guard(mControlLock);
+
+   mStateCond.acquire();
+   {
+      mHandlers.clear();
+      mRunning = false;
+   }
+   mStateCond.release();
+
+   if ( NULL != mThread )
+   {
+      mThread->join();
+      delete mThread;
+      mThread = NULL;
+   }
+}
+
+void IOReactor::registerHandle(const vpr::IOSys::Handle handle,
+                               const callback_t& callback)
+{
+   vpr::Guard<vpr::Mutex> control_guard(mControlLock);
+
+   mStateCond.acquire();
+   {
+      mHandlers[handle] = callback;
+      mChanged          = true;
+      mRunning          = true;
+   }
+   mStateCond.release();
+
+   if ( NULL == mThread )
+   {
+      try
+      {
+         mThread = new vpr::Thread(boost::bind(&IOReactor::run, this));
+      }
+      catch (vpr::Exception&)
+      {
+         mStateCond.acquire();
+         {
+            mHandlers.erase(handle);
+            mRunning = false;
+         }
+         mStateCond.release();
+         throw;
+      }
+   }
+}
+
+void IOReactor::unregisterHandle(const vpr::IOSys::Handle handle)
+{
+   vpr::Guard<vpr::Mutex> control_guard(mControlLock);
+
+   bool stop_thread(false);
+
+   mStateCond.acquire();
+   {
+      if ( mHandlers.erase(handle) > 0 )
+      {
+         mChanged = true;
+
+         if ( mHandlers.empty() )
+         {
+            mRunning   = false;
+            stop_thread = true;
+         }
+         else
+         {
+            // Wait for the reactor thread to finish its current pass.  Once
+            // it has picked up the change, the callback for handle cannot
+            // run anymore.
+            const vpr::Uint32 pass = ++mRequestedPass;
+            while ( mRunning && mCompletedPass != pass )
+            {
+               mStateCond.wait();
+            }
+         }
+      }
+   }
+   mStateCond.release();
+
+   if ( stop_thread && NULL != mThread )
+   {
+      mThread->join();
+      delete mThread;
+      mThread = NULL;
+   }
+}
+
+void IOReactor::run()
+{
+   vpr::Selector selector;
+   std::map<vpr::IOSys::Handle, callback_t> handlers;
+   std::vector<vpr::IOSys::Handle> ready;
+
+   vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_STATE_LVL)
+      << "[gadget::IOReactor] I/O thread started." << std::endl
+      << vprDEBUG_FLUSH;
+
+   vpr::ThreadPlacement::instance()->place(vpr::ThreadPlacement::DEVICE);
+
+   while ( true )
+   {
+      mStateCond.acquire();
+      {
+         if ( ! mRunning )
+         {
+            mStateCond.release();
+            break;
+         }
+
+         if ( mChanged )
+         {
+            typedef std::map<vpr::IOSys::Handle, callback_t>::iterator iter_t;
+            for ( iter_t h = handlers.begin(); h != handlers.end(); ++h )
+            {
+               selector.removeHandle((*h).first);
+            }
+
+            handlers = mHandlers;
+
+            for ( iter_t h = handlers.begin(); h != handlers.end(); ++h )
+            {
+               selector.addHandle((*h).first);
+               selector.setIn((*h).first, vpr::Selector::Read);
+            }
+
+            mChanged = false;
+         }
+
+         if ( mCompletedPass != mRequestedPass )
+         {
+            mCompletedPass = mRequestedPass;
+            mStateCond.broadcast();
+         }
+      }
+      mStateCond.release();
+
+      vpr::Uint16 num_events(0);
+
+      try
+      {
+         selector.select(num_events, MAX_SELECT_WAIT);
+      }
+      catch (vpr::TimeoutException&)
+      {
+         continue;
+      }
+      catch (vpr::IOException& ex)
+      {
+         vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_WARNING_LVL)
+            << clrOutBOLD(clrYELLOW, "WARNING:")
+            << " [gadget::IOReactor] select failed: " << ex.what()
+            << std::endl << vprDEBUG_FLUSH;
+         continue;
+      }
+
+      const vpr::Interval arrival(vpr::Interval::now());
+
+      ready.clear();
+      for ( vpr::Uint16 i = 0; i < selector.getNumHandles(); ++i )
+      {
+         const vpr::IOSys::Handle handle = selector.getHandle(i);
+         if ( selector.getOut(handle) &
+                 (vpr::Selector::Read | vpr::Selector::Error) )
+         {
+            ready.push_back(handle);
+         }
+      }
+
+      for ( std::vector<vpr::IOSys::Handle>::iterator h = ready.begin();
+            h != ready.end(); ++h )
+      {
+         try
+         {
+            handlers[*h](arrival);
+         }
+         catch (std::exception& ex)
+         {
+            vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_WARNING_LVL)
+               << clrOutBOLD(clrYELLOW, "WARNING:")
+               << " [gadget::IOReactor] Input callback failed: "
+               << ex.what() << std::endl << vprDEBUG_FLUSH;
+         }
+      }
+   }
+
+   vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_STATE_LVL)
+      << "[gadget::IOReactor] I/O thread stopped." << std::endl
+      << vprDEBUG_FLUSH;
+}
+
+} // End of gadget namespace
@@ -0,0 +1,126 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+#ifndef _GADGET_IO_REACTOR_H_
+#define _GADGET_IO_REACTOR_H_
+
+#include <gadget/gadgetConfig.h>
+
+#include <map>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <vpr/IO/IOSys.h>
+#include <vpr/Sync/CondVar.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/Interval.h>
+#include <vpr/Util/Singleton.h>
+
+
+namespace gadget
+{
+
+/** \class IOReactor IOReactor.h gadget/Util/IOReactor.h
+ *
+ * Shared I/O thread for network-based input device drivers.  Instead of
+ * running their own thread that polls a socket and sleeps, drivers register
+ * the handle of their socket along with a callback.  A single thread waits
+ * on all registered handles with vpr::Selector and invokes the callback of
+ * each handle as soon as it becomes readable, so a sample is processed
+ * within microseconds of its arrival and no core is woken while there is
+ * nothing to read.
+ *
+ * The callback receives the time at which select returned.  Drivers should
+ * use it as the time stamp of the data they read rather than the time at
+ * which the data is processed or copied to the sample buffers.
+ *
+ * Callbacks run in the reactor thread, so they must not block and must not
+ * register or unregister handles themselves.  The thread is started with
+ * the first registration and stopped when the last handle is unregistered.
+ * When vpr::ThreadPlacement is enabled, the thread runs on the CPU planned
+ * for device sampling.
+ */
+class GADGET_API IOReactor : private boost::noncopyable
+{
+public:
+   /** Readiness callback.  The argument is the time of arrival. */
+   typedef boost::function<void (const vpr::Interval&)> callback_t;
+
+   /**
+    * Starts watching \p handle for input.  Registering a handle that is
+    * already known replaces its callback.
+    *
+    * @param handle   The handle of an open socket (or other I/O object that
+    *                 vpr::Selector supports).
+    * @param callback Invoked from the reactor thread whenever \p handle is
+    *                 readable.
+    *
+    * @throw vpr::Exception is thrown if the reactor thread cannot be
+    *        started.
+    */
+   void registerHandle(const vpr::IOSys::Handle handle,
+                       const callback_t& callback);
+
+   /**
+    * Stops watching \p handle.  When this returns, the callback for
+    * \p handle is not running and will not be invoked again, so the caller
+    * may close the handle.
+    */
+   void unregisterHandle(const vpr::IOSys::Handle handle);
+
+protected:
+   IOReactor();
+
+   ~IOReactor();
+
+private:
+   /** Body of the reactor thread. */
+   void run();
+
+   /** Serializes registration changes, including thread start and stop. */
+   vpr::Mutex mControlLock;
+
+   /** @name State shared with the reactor thread, guarded by mStateCond. */
+   //@{
+   vpr::CondVar mStateCond;
+   std::map<vpr::IOSys::Handle, callback_t> mHandlers;
+   bool mChanged;                /**< mHandlers changed since last select */
+   bool mRunning;
+   vpr::Uint32 mRequestedPass;   /**< Pass an unregister is waiting for */
+   vpr::Uint32 mCompletedPass;   /**< Last pass that picked up changes */
+   //@}
+
+   vpr::Thread* mThread;
+
+   vprSingletonHeader(IOReactor);
+};
+
+} // End of gadget namespace
+
+
+#endif /* _GADGET_IO_REACTOR_H_ */
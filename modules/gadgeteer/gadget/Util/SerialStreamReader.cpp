@@ -0,0 +1,225 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <gadget/gadgetConfig.h>
+
+#include <cstring>
+#include <boost/bind.hpp>
+
+#include <vpr/IO/IOException.h>
+#include <vpr/IO/WouldBlockException.h>
+#include <vpr/Util/Debug.h>
+
+#include <gadget/Util/Debug.h>
+#include <gadget/Util/IOReactor.h>
+#include <gadget/Util/SerialStreamReader.h>
+
+
+namespace gadget
+{
+
+SerialStreamReader::SerialStreamReader(const vpr::Uint32 capacity)
+   : mPort(NULL)
+   , mWasBlocking(true)
+   , mRegistered(false)
+   , mFailed(false)
+   , mBuffer(capacity > 0 ? capacity : 1)
+   , mSize(0)
+   , mDroppedBytes(0)
+{
+   /* Do nothing. */ ;
+}
+
+SerialStreamReader::~SerialStreamReader()
+{
+   stop();
+}
+
+bool SerialStreamReader::isSupported()
+{
+   // vpr::Selector only accepts serial port handles when it is built on
+   // poll(2).
+#if VPR_IO_DOMAIN_INCLUDE == VPR_DOMAIN_POSIX
+   return true;
+#else
+   return false;
+#endif
+}
+
+void SerialStreamReader::start(vpr::SerialPort* port, const framer_t& framer)
+{
+   vprASSERT(NULL == mPort && "The reader is already running");
+   vprASSERT(isSupported());
+
+   mWasBlocking = port->isBlocking();
+   mFramer      = framer;
+   mSize        = 0;
+   mFailed      = false;
+
+   // Reads happen only when the port is readable, and they must return
+   // whatever has arrived instead of waiting for the VMIN/VTIME settings
+   // of a blocking port.
+   port->setBlocking(false);
+   mPort = port;
+
+   try
+   {
+      IOReactor::instance()->registerHandle(
+         port->getHandle(),
+         boost::bind(&SerialStreamReader::onReadable, this, _1)
+      );
+      mRegistered = true;
+   }
+   catch (vpr::Exception&)
+   {
+      mPort = NULL;
+      port->setBlocking(mWasBlocking);
+      throw;
+   }
+}
+
+void SerialStreamReader::stop()
+{
+   if ( NULL == mPort )
+   {
+      return;
+   }
+
+   if ( mRegistered )
+   {
+      IOReactor::instance()->unregisterHandle(mPort->getHandle());
+      mRegistered = false;
+   }
+
+   try
+   {
+      mPort->setBlocking(mWasBlocking);
+   }
+   catch (vpr::IOException& ex)
+   {
+      vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_WARNING_LVL)
+         << clrOutBOLD(clrYELLOW, "WARNING:")
+         << " [gadget::SerialStreamReader] Could not restore the blocking "
+         << "mode of the port: " << ex.what() << std::endl << vprDEBUG_FLUSH;
+   }
+
+   mPort = NULL;
+   mSize = 0;
+}
+
+bool SerialStreamReader::checkFailure()
+{
+   if ( mFailed && mRegistered )
+   {
+      // No callback is running once this returns.
+      IOReactor::instance()->unregisterHandle(mPort->getHandle());
+      mRegistered = false;
+   }
+
+   return mFailed;
+}
+
+void SerialStreamReader::onReadable(const vpr::Interval& arrival)
+{
+   // A port that has failed stays readable, so do not retry until
+   // checkFailure() has stopped the reactor thread from watching it.
+   if ( mFailed )
+   {
+      return;
+   }
+
+   vpr::Uint32 bytes(0);
+
+   try
+   {
+      bytes = mPort->read(&mBuffer[mSize], mBuffer.size() - mSize);
+   }
+   catch (vpr::WouldBlockException&)
+   {
+      return;
+   }
+   catch (vpr::IOException& ex)
+   {
+      mFailed = true;
+
+      vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CRITICAL_LVL)
+         << clrOutBOLD(clrRED, "ERROR:")
+         << " [gadget::SerialStreamReader] Reading the port failed: "
+         << ex.what() << std::endl << vprDEBUG_FLUSH;
+      return;
+   }
+
+   // Readable with nothing to read means that the device hung up.
+   if ( 0 == bytes )
+   {
+      mFailed = true;
+
+      vprDEBUG(gadgetDBG_INPUT_MGR, vprDBG_CRITICAL_LVL)
+         << clrOutBOLD(clrRED, "ERROR:")
+         << " [gadget::SerialStreamReader] The device hung up."
+         << std::endl << vprDEBUG_FLUSH;
+      return;
+   }
+
+   mSize += bytes;
+
+   while ( true )
+   {
+      vpr::Uint32 offset(0);
+
+      while ( offset < mSize )
+      {
+         const vpr::Uint32 used =
+            mFramer(&mBuffer[offset], mSize - offset, arrival);
+
+         if ( 0 == used )
+         {
+            break;
+         }
+
+         offset += used < mSize - offset ? used : mSize - offset;
+      }
+
+      if ( offset > 0 )
+      {
+         mSize -= offset;
+         std::memmove(&mBuffer[0], &mBuffer[offset], mSize);
+      }
+
+      // A full buffer that the framer cannot use would stall the reader.
+      // Drop the oldest byte and let the framer look again.
+      if ( mSize < mBuffer.size() )
+      {
+         break;
+      }
+
+      --mSize;
+      std::memmove(&mBuffer[0], &mBuffer[1], mSize);
+      ++mDroppedBytes;
+   }
+}
+
+} // End of gadget namespace
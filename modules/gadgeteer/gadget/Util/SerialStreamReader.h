@@ -0,0 +1,149 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _GADGET_SERIAL_STREAM_READER_H_
+#define _GADGET_SERIAL_STREAM_READER_H_
+
+#include <gadget/gadgetConfig.h>
+
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <vpr/IO/Port/SerialPort.h>
+#include <vpr/Util/Interval.h>
+
+
+namespace gadget
+{
+
+/** \class SerialStreamReader SerialStreamReader.h gadget/Util/SerialStreamReader.h
+ *
+ * Reads a serial device that streams data from the shared gadget::IOReactor
+ * thread.  Without it, each serial driver runs its own thread that blocks
+ * in vpr::SerialPort::read() until a whole record has arrived.  With it,
+ * any number of serial devices are serviced by the one reactor thread, and
+ * each record is handled as soon as its last byte arrives.
+ *
+ * Bytes are read into a buffer that is allocated once and handed to a
+ * framing callback supplied by the driver.  The callback looks at the
+ * bytes at the front of the buffer and returns how many of them it used:
+ * a complete record that it processed, or bytes that it skipped to find
+ * the start of the next record.  It returns 0 when it needs more bytes.
+ * Callbacks run in the reactor thread, so they must not block.
+ *
+ * If reading the port fails or the device hangs up, the reader stops
+ * handing bytes to the framing callback.  The reactor thread cannot stop
+ * watching the port from within the callback, so drivers must call
+ * checkFailure() regularly, typically from updateData(), to have it stop.
+ *
+ * The port is switched to non-blocking mode while the reader is running.
+ * Waiting on serial ports needs the POSIX I/O domain of VPR; use
+ * isSupported() to decide whether to fall back to a sampling thread.
+ */
+class GADGET_API SerialStreamReader : private boost::noncopyable
+{
+public:
+   /**
+    * Framing callback.  The arguments are the buffered bytes, their number,
+    * and the time at which the newest of them arrived.  The return value is
+    * the number of bytes consumed from the front of the buffer.
+    */
+   typedef boost::function<
+      vpr::Uint32 (const vpr::Uint8*, const vpr::Uint32, const vpr::Interval&)
+   > framer_t;
+
+   /**
+    * @param capacity The size of the buffer.  It must hold at least two of
+    *                 the largest records the device sends.
+    */
+   SerialStreamReader(const vpr::Uint32 capacity = 1024);
+
+   /** Stops reading if the reader is still running. */
+   ~SerialStreamReader();
+
+   /** Returns true if serial ports can be registered with IOReactor. */
+   static bool isSupported();
+
+   /**
+    * Starts reading \p port from the reactor thread.
+    *
+    * @pre \p port is open and isSupported() returns true.
+    *
+    * @throw vpr::Exception is thrown if the reactor thread cannot be
+    *        started.
+    */
+   void start(vpr::SerialPort* port, const framer_t& framer);
+
+   /**
+    * Stops reading.  When this returns, the framing callback is not running
+    * and will not be invoked again.  The port is restored to its original
+    * blocking mode and any buffered bytes are discarded.
+    */
+   void stop();
+
+   bool isRunning() const
+   {
+      return NULL != mPort;
+   }
+
+   /**
+    * Stops the reactor thread from watching the port if reading it has
+    * failed.  This must not be called from the framing callback.  The
+    * reader still counts as running until stop() is called.
+    *
+    * @return true if reading the port has failed since start().
+    */
+   bool checkFailure();
+
+   /**
+    * Returns the number of bytes dropped because the buffer filled up
+    * without the framing callback finding a record in it.
+    */
+   vpr::Uint32 getDroppedBytes() const
+   {
+      return mDroppedBytes;
+   }
+
+private:
+   /** Called by gadget::IOReactor when the port is readable. */
+   void onReadable(const vpr::Interval& arrival);
+
+   vpr::SerialPort* mPort;
+   bool             mWasBlocking;
+   bool             mRegistered;
+   volatile bool    mFailed;        /**< Set by the reactor thread */
+   framer_t         mFramer;
+
+   std::vector<vpr::Uint8> mBuffer;
+   vpr::Uint32             mSize;      /**< Bytes held in mBuffer */
+   vpr::Uint32             mDroppedBytes;
+};
+
+} // End of gadget namespace
+
+
+#endif /* _GADGET_SERIAL_STREAM_READER_H_ */
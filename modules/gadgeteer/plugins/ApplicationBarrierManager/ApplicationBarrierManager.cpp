@@ -126,6 +126,18 @@ void ApplicationBarrierManager::postPostFrame()
 void ApplicationBarrierManager::preDraw()
 {;}
 
+vpr::Uint32 ApplicationBarrierManager::getSyncPhases()
+{
+   // ApplicationBarrier::wait() blocks until the packets arrive, whichever
+   // exchange carries them.
+   return 0;
+}
+
+bool ApplicationBarrierManager::needsSlaveData(const SyncPhase)
+{
+   return false;
+}
+
 void ApplicationBarrierManager::sendWait(const vpr::GUID& id)
 {
    vprDEBUG(gadgetDBG_RIM, vprDBG_HVERB_LVL)
@@ -97,6 +97,16 @@ public:
     */
    virtual void postPostFrame();
 
+   /**
+    * Barrier packets may be delivered by any exchange.
+    */
+   virtual vpr::Uint32 getSyncPhases();
+
+   /**
+    * The master never waits for barrier packets in a given phase.
+    */
+   virtual bool needsSlaveData(const SyncPhase phase);
+
    /**
     * Is this ClusterPlugin ready for the cluster to start the application.
     */
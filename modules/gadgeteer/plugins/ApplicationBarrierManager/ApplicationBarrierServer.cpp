@@ -42,6 +42,10 @@ ApplicationBarrierServer::ApplicationBarrierServer(const vpr::GUID& guid,  Appli
 {
    // Create a DataPacket
    mDataPacket = DataPacket::create(pluginGuid, guid);
+
+   // A barrier only writes its GUID, which never changes, so the wait
+   // packet is serialized once here and sent as is every time.
+   mDataPacket->serialize(*mApplicationBarrier);
 }
 
 ApplicationBarrierServerPtr ApplicationBarrierServer::create(const vpr::GUID& guid,
@@ -58,8 +62,6 @@ ApplicationBarrierServer::~ApplicationBarrierServer()
 
 void ApplicationBarrierServer::serializeAndSend()
 {
-   mDataPacket->serialize(*mApplicationBarrier);
-
    cluster::ClusterManager::instance()->getNetwork()->sendToAll(mDataPacket);
 }
 
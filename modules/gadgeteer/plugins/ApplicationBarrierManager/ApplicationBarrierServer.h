@@ -72,7 +72,8 @@ public:
    virtual ~ApplicationBarrierServer();
 
    /**
-    * Send wait, to each client.
+    * Send wait, to each client.  The packet is serialized when the server
+    * is created and reused for every wait.
     */
    void serializeAndSend();
 
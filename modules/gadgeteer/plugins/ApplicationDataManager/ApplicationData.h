@@ -45,6 +45,10 @@ public:
     */
    ApplicationData()
       : mIsLocal(false)
+      , mDirtyTracking(false)
+      , mDirty(true)
+      , mDeltaEncoding(false)
+      , mKeyframeInterval(DEFAULT_KEYFRAME_INTERVAL)
    {;}
 
    /**
@@ -111,9 +115,86 @@ public:
       return mId;
    }
 
+   /** @name Replication control
+    *
+    * By default, this object is serialized and sent to every node each
+    * frame.  These settings only matter on the node that updates the
+    * object, but setting them the same way on every node is harmless.
+    */
+   //@{
+   /**
+    * Enables or disables dirty tracking.  With dirty tracking enabled, the
+    * object is only sent in frames in which setDirty() was called (and for
+    * periodic keyframes).  The application must then call setDirty()
+    * whenever it changes the object.
+    */
+   void setDirtyTracking(const bool enabled)
+   {
+      mDirtyTracking = enabled;
+   }
+
+   bool getDirtyTracking() const
+   {
+      return mDirtyTracking;
+   }
+
+   /**
+    * Marks this object as changed (or unchanged) since it was last sent.
+    * The flag is cleared every time the object is sent.
+    */
+   void setDirty(const bool dirty = true)
+   {
+      mDirty = dirty;
+   }
+
+   bool isDirty() const
+   {
+      return mDirty;
+   }
+
+   /**
+    * Enables or disables delta encoding.  With delta encoding enabled, the
+    * serialized object is compared byte by byte with the copy that was
+    * last sent, and only the ranges that differ are sent.  This costs one
+    * extra copy of the serialized object on every node.
+    */
+   void setDeltaEncoding(const bool enabled)
+   {
+      mDeltaEncoding = enabled;
+   }
+
+   bool getDeltaEncoding() const
+   {
+      return mDeltaEncoding;
+   }
+
+   /**
+    * Sets how often, in frames, the complete object is sent even if it did
+    * not change.  Keyframes bring nodes that missed an update back in
+    * sync.  0 disables keyframes other than the first.
+    */
+   void setKeyframeInterval(const vpr::Uint32 frames)
+   {
+      mKeyframeInterval = frames;
+   }
+
+   vpr::Uint32 getKeyframeInterval() const
+   {
+      return mKeyframeInterval;
+   }
+   //@}
+
+   /** Keyframe interval used unless setKeyframeInterval() is called. */
+   static const vpr::Uint32 DEFAULT_KEYFRAME_INTERVAL = 300;
+
 private:
    bool        mIsLocal;   /**< True if this object is to be updated by the local node. */
    vpr::GUID   mId;        /**< GUID for this object */
+
+   bool        mDirtyTracking;      /**< Only send when dirty. */
+   bool        mDirty;              /**< Changed since last sent. */
+   bool        mDeltaEncoding;      /**< Send changed byte ranges only. */
+   vpr::Uint32 mKeyframeInterval;   /**< Frames between keyframes. */
 };
 
 } // end namespace gadget
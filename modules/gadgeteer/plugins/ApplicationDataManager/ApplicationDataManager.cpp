@@ -37,6 +37,9 @@
 #include <plugins/ApplicationDataManager/ApplicationDataServer.h>
 
 #include <cluster/Packets/DataPacket.h>
+#include <cluster/Packets/DeltaPacket.h>
+#include <cluster/ClusterException.h>
+#include <vpr/IO/BufferObjectReader.h>
 
 extern "C"
 {
@@ -106,6 +109,46 @@ void ApplicationDataManager::handlePacket(PacketPtr packet, gadget::NodePtr node
          }
          break;
       }
+      case cluster::Header::RIM_DELTA_PACKET:
+      {
+         DeltaPacketPtr delta_packet = boost::dynamic_pointer_cast<DeltaPacket>(packet);
+         vprASSERT(NULL != delta_packet.get() && "Dynamic cast failed!");
+
+         ApplicationData* user_data =
+            getApplicationData(delta_packet->getObjectId());
+
+         if (user_data != NULL)
+         {
+            // Patch our copy of the serialized object and parse the result.
+            std::vector<vpr::Uint8>& state =
+               mReceivedStates[delta_packet->getObjectId()];
+
+            try
+            {
+               delta_packet->apply(state);
+
+               vpr::BufferObjectReader reader(&state);
+               user_data->readObject(&reader);
+            }
+            catch (cluster::ClusterException& ex)
+            {
+               // We missed the keyframe.  The next one will catch us up.
+               vprDEBUG(gadgetDBG_RIM,vprDBG_WARNING_LVL)
+                  << clrOutBOLD(clrCYAN,"[ApplicationDataManager] ")
+                  << "Dropped changes to ApplicationData object "
+                  << delta_packet->getObjectId() << ": " << ex.what()
+                  << std::endl << vprDEBUG_FLUSH;
+            }
+         }
+         else
+         {
+            vprDEBUG(gadgetDBG_RIM,vprDBG_WARNING_LVL)
+               << clrOutBOLD(clrCYAN,"[ApplicationDataManager] ")
+               << "Got data for an unknown ApplicationData object: "
+               << delta_packet->getObjectId() << std::endl << vprDEBUG_FLUSH;
+         }
+         break;
+      }
       default:
          vprDEBUG(gadgetDBG_RIM,vprDBG_WARNING_LVL)
             << clrOutBOLD(clrCYAN,"[ApplicationDataManager] ")
@@ -136,6 +179,16 @@ void ApplicationDataManager::preDraw()
    }
 }
 
+vpr::Uint32 ApplicationDataManager::getSyncPhases()
+{
+   return PRE_DRAW;
+}
+
+bool ApplicationDataManager::needsSlaveData(const SyncPhase)
+{
+   return false;
+}
+
 void ApplicationDataManager::addSerializableObject(vpr::SerializableObject* object)
 {
    ApplicationData* new_app_data = static_cast<ApplicationData*>(object);
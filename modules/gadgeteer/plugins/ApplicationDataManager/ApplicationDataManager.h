@@ -35,6 +35,8 @@
 
 #include <vpr/vpr.h>
 
+#include <vector>
+
 #if defined(__GNUC__) && __GNUC__ >= 4
 #  include <tr1/unordered_map>
 #elif defined(_MSC_VER) && _MSC_VER >= 1500
@@ -97,6 +99,16 @@ public:
     */
    virtual void postPostFrame();
 
+   /**
+    * Application data must reach the slaves before they draw.
+    */
+   virtual vpr::Uint32 getSyncPhases();
+
+   /**
+    * Only the master sends application data.
+    */
+   virtual bool needsSlaveData(const SyncPhase phase);
+
    /**
     * Is this ClusterPlugin ready for the cluster to start the application.
     */
@@ -160,6 +172,9 @@ private:
    typedef std::tr1::unordered_map<vpr::GUID
                                 , ApplicationDataServerPtr
                                 , vpr::GUID::hash> server_map_t;
+   typedef std::tr1::unordered_map<vpr::GUID
+                                , std::vector<vpr::Uint8>
+                                , vpr::GUID::hash> state_map_t;
 #elif BOOST_VERSION >= 103600
    typedef boost::unordered_map<vpr::GUID
                               , ApplicationData*
@@ -167,16 +182,22 @@ private:
    typedef boost::unordered_map<vpr::GUID
                               , ApplicationDataServerPtr
                               , vpr::GUID::hash> server_map_t;
+   typedef boost::unordered_map<vpr::GUID
+                              , std::vector<vpr::Uint8>
+                              , vpr::GUID::hash> state_map_t;
 #elif defined(VPR_HASH_MAP_INCLUDE)
    typedef std::hash_map<vpr::GUID, ApplicationData*, vpr::GUID::hash> object_map_t;
    typedef std::hash_map<vpr::GUID, ApplicationDataServerPtr, vpr::GUID::hash>  server_map_t;
+   typedef std::hash_map<vpr::GUID, std::vector<vpr::Uint8>, vpr::GUID::hash>  state_map_t;
 #else
    typedef std::map<vpr::GUID, ApplicationData*> object_map_t;
    typedef std::map<vpr::GUID, ApplicationDataServerPtr>  server_map_t;
+   typedef std::map<vpr::GUID, std::vector<vpr::Uint8> >  state_map_t;
 #endif
 
    object_map_t         mObjects;       /**< Application level ApplicationData list. */
    server_map_t         mServers;       /**< ApplicationData Server list. */
+   state_map_t          mReceivedStates; /**< Serialized objects received with delta encoding. */
 };
 
 } // end namespace
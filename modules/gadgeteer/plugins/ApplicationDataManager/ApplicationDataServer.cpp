@@ -30,6 +30,7 @@
 
 #include <vpr/IO/BufferObjectWriter.h>
 #include <cluster/Packets/DataPacket.h>
+#include <cluster/Packets/DeltaPacket.h>
 #include <plugins/ApplicationDataManager/ApplicationData.h>
 #include <plugins/ApplicationDataManager/ApplicationDataServer.h>
 
@@ -39,9 +40,13 @@ namespace cluster
 ApplicationDataServer::ApplicationDataServer(const vpr::GUID& guid,  ApplicationData* userData, const vpr::GUID& pluginGuid)
    : mApplicationData(userData)
    , mDataPacket()
+   , mDeltaPacket()
+   , mHaveLastSent(false)
+   , mFramesSinceKeyframe(0)
 {
    // Create a DataPacket that will be updated and sent continually.
    mDataPacket = DataPacket::create(pluginGuid, guid);
+   mDeltaPacket = DeltaPacket::create(pluginGuid, guid);
 }
 
 ApplicationDataServerPtr ApplicationDataServer::create(const vpr::GUID& guid,
@@ -58,9 +63,45 @@ ApplicationDataServer::~ApplicationDataServer()
 
 void ApplicationDataServer::serializeAndSend()
 {
-   mDataPacket->serialize(*mApplicationData);
+   const vpr::Uint32 interval(mApplicationData->getKeyframeInterval());
+   const bool keyframe_due(interval > 0 && mFramesSinceKeyframe >= interval);
 
-   cluster::ClusterManager::instance()->getNetwork()->sendToAll(mDataPacket);
+   if ( mApplicationData->getDirtyTracking() &&
+        ! mApplicationData->isDirty() && ! keyframe_due )
+   {
+      ++mFramesSinceKeyframe;
+      return;
+   }
+
+   if ( ! mApplicationData->getDeltaEncoding() )
+   {
+      mDataPacket->serialize(*mApplicationData);
+      cluster::ClusterManager::instance()->getNetwork()->sendToAll(mDataPacket);
+      mHaveLastSent = false;
+      mFramesSinceKeyframe = 0;
+   }
+   else
+   {
+      mState.clear();
+      vpr::BufferObjectWriter writer(&mState);
+      mApplicationData->writeObject(&writer);
+
+      const bool use_base(mHaveLastSent && ! keyframe_due);
+      const bool keyframe =
+         mDeltaPacket->serialize(mState, use_base ? &mLastSent : NULL);
+
+      // Nothing changed, so there is nothing to send.
+      if ( keyframe || mDeltaPacket->getRunCount() > 0 )
+      {
+         cluster::ClusterManager::instance()->getNetwork()->sendToAll(mDeltaPacket);
+      }
+
+      mLastSent.swap(mState);
+      mHaveLastSent = true;
+      mFramesSinceKeyframe = keyframe ? 0 : mFramesSinceKeyframe + 1;
+   }
+
+   mApplicationData->setDirty(false);
 }
 
 void ApplicationDataServer::debugDump(int debug_level)
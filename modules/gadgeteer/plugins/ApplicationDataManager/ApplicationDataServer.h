@@ -29,8 +29,11 @@
 
 #include <cluster/PluginConfig.h>
 
+#include <vector>
 #include <boost/noncopyable.hpp>
+#include <vpr/vprTypes.h>
 #include <cluster/Packets/DataPacketPtr.h>
+#include <cluster/Packets/DeltaPacketPtr.h>
 #include <plugins/ApplicationDataManager/ApplicationDataServerPtr.h>
 
 namespace vpr
@@ -73,7 +76,10 @@ public:
 
    /**
     * Send mDataPacket, which has been updated in updateLocalData, to each
-    * client.
+    * client.  Depending on the replication settings of the ApplicationData,
+    * nothing may be sent, or only the bytes that changed since the last
+    * send (see ApplicationData::setDirtyTracking() and
+    * ApplicationData::setDeltaEncoding()).
     */
    void serializeAndSend();
 
@@ -94,6 +100,11 @@ public:
 private:
    ApplicationData*             mApplicationData;    /**< Structure that is being shared across the cluster. */
    DataPacketPtr                mDataPacket;         /**< Packet will be sent across the cluster. */
+   DeltaPacketPtr               mDeltaPacket;        /**< Used instead of mDataPacket with delta encoding. */
+   std::vector<vpr::Uint8>      mState;              /**< Serialized state being sent. */
+   std::vector<vpr::Uint8>      mLastSent;           /**< Serialized state last sent with delta encoding. */
+   bool                         mHaveLastSent;       /**< If mLastSent is valid. */
+   vpr::Uint32                  mFramesSinceKeyframe;
 };
 
 } // end namespace cluster
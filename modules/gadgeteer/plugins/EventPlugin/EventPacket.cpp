@@ -64,7 +64,7 @@ EventPacket::EventPacket(const vpr::GUID& pluginId, const std::string& name)
 
 EventPacketPtr EventPacket::create()
 {
-   return EventPacketPtr(new EventPacket());
+   return makePtr(new EventPacket());
 }
 
 EventPacketPtr EventPacket::create(const vpr::GUID& pluginId, const std::string& name)
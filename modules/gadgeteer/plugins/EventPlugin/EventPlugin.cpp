@@ -113,6 +113,16 @@ void EventPlugin::handlePacket(PacketPtr packet, gadget::NodePtr node)
 void EventPlugin::postPostFrame()
 {;}
 
+vpr::Uint32 EventPlugin::getSyncPhases()
+{
+   return PRE_DRAW;
+}
+
+bool EventPlugin::needsSlaveData(const SyncPhase phase)
+{
+   return PRE_DRAW == phase && ! mWaitingCount.empty();
+}
+
 void EventPlugin::preDraw()
 {
    // If we are the master, check to see if any events have been finished.
@@ -99,6 +99,16 @@ public:
     */
    virtual void postPostFrame();
 
+   /**
+    * Events are registered and completed in preDraw().
+    */
+   virtual vpr::Uint32 getSyncPhases();
+
+   /**
+    * The master waits for the slaves only while an event is pending.
+    */
+   virtual bool needsSlaveData(const SyncPhase phase);
+
    /**
     * Is this ClusterPlugin ready for the cluster to start the application.
     */
@@ -37,9 +37,11 @@ namespace cluster
 {
 
 DeviceServer::DeviceServer(const std::string& name, gadget::InputPtr device,
-                           const vpr::GUID& pluginGuid)
+                           const vpr::GUID& pluginGuid,
+                           const vpr::Uint32 channel)
    : mName(name)
    , mPluginGUID(pluginGuid)
+   , mChannel(channel)
    , mDevice(device)
    , mDataPacket()
 {
@@ -55,13 +57,14 @@ DeviceServer::DeviceServer(const std::string& name, gadget::InputPtr device,
    }
    while(temp == mId);
 
-   mDataPacket = cluster::DataPacket::create(pluginGuid, mId);
+   mDataPacket = cluster::DataPacket::create(pluginGuid, mId, mChannel);
 }
 
 DeviceServerPtr DeviceServer::create(const std::string& name, gadget::InputPtr device,
-                                     const vpr::GUID& pluginGuid)
+                                     const vpr::GUID& pluginGuid,
+                                     const vpr::Uint32 channel)
 {
-   return DeviceServerPtr(new DeviceServer(name, device, pluginGuid));
+   return DeviceServerPtr(new DeviceServer(name, device, pluginGuid, channel));
 }
 
 DeviceServer::~DeviceServer()
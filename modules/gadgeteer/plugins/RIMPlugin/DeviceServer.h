@@ -59,9 +59,11 @@ protected:
     * @param pluginId GUID that should be placed at the beginning of 
     *                 each data packet so that the receiver knows which 
     *                 plugin the data is coming from.
+    * @param channel  Routing channel placed in the header of each data
+    *                 packet (see cluster::Header::getChannel()).
     */
    DeviceServer(const std::string& name, gadget::InputPtr device,
-                const vpr::GUID& pluginId);
+                const vpr::GUID& pluginId, const vpr::Uint32 channel);
 
 public:
    /**
@@ -71,7 +73,8 @@ public:
     * @since 1.3.7
     */
    static DeviceServerPtr create(const std::string& name, gadget::InputPtr device,
-                                 const vpr::GUID& pluginGuid);
+                                 const vpr::GUID& pluginGuid,
+                                 const vpr::Uint32 channel = 0);
    /**
     */
    virtual ~DeviceServer();
@@ -102,10 +105,19 @@ public:
       return mId;
    }
 
+   /**
+    * Returns the routing channel of the data packets of this server.
+    */
+   vpr::Uint32 getChannel() const
+   {
+      return mChannel;
+   }
+
 private:
    std::string                         mName;   /**< DeviceServer name */
    vpr::GUID                           mId;                    /**< GUID for shared device */
    vpr::GUID                           mPluginGUID;
+   vpr::Uint32                         mChannel;
    
    gadget::InputPtr                    mDevice;
    cluster::DataPacketPtr              mDataPacket;
@@ -53,6 +53,7 @@
 #include <jccl/Config/ConfigElement.h>
 
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
 #include <map>
 
 extern "C"
@@ -89,11 +90,13 @@ struct DeviceNamePred
 
 RIMPlugin::RIMPlugin()
    : mHandlerGUID("9c3fb301-b142-4c6f-8ca3-1570898974d0")
+   , mLastDeviceChannel(0)
 {;}
 
 RIMPlugin::~RIMPlugin()
 {
    mVirtualDevices.clear();
+   mDeviceChannels.clear();
    mDeviceServers.clear();
 
    // TODO: Make ConfigManager use shared_ptrs.
@@ -114,6 +117,16 @@ void RIMPlugin::preDraw()
    // Do nothing we are only here to sync.
 }
 
+vpr::Uint32 RIMPlugin::getSyncPhases()
+{
+   return POST_POST_FRAME;
+}
+
+bool RIMPlugin::needsSlaveData(const SyncPhase phase)
+{
+   return POST_POST_FRAME == phase && ! mVirtualDevices.empty();
+}
+
 void RIMPlugin::postPostFrame()
 {
    // Update all local device servers and send their data.
@@ -168,7 +181,8 @@ bool RIMPlugin::configAdd(jccl::ConfigElementPtr elm)
          const vpr::GUID& temp_guid(device_server->getId());
          DeviceAckPtr device_ack = DeviceAck::create(mHandlerGUID, temp_guid,
                                                      device_name, dev_type_id,
-                                                     true);
+                                                     true,
+                                                     device_server->getChannel());
 
          vprDEBUG(gadgetDBG_RIM,vprDBG_CONFIG_STATUS_LVL)
             << clrOutBOLD(clrMAGENTA, "[RemoteInputManager]")
@@ -250,7 +264,8 @@ void RIMPlugin::handlePacket(cluster::PacketPtr packet, gadget::NodePtr node)
             {
                addVirtualDevice(device_ack->getId(), device_name,
                                 device_ack->getDeviceBaseType(),
-                                device_ack->getHostname());
+                                device_ack->getHostname(),
+                                Header::getObjectChannel(packet->getChannel()));
 
                // Add this virtual device to the InputManager's list of devices.
                input_dev = getVirtualDevice(device_name);
@@ -278,18 +293,22 @@ void RIMPlugin::handlePacket(cluster::PacketPtr packet, gadget::NodePtr node)
          }
       case cluster::Header::RIM_DATA_PACKET:
          {
-            cluster::DataPacketPtr data_packet = boost::dynamic_pointer_cast<cluster::DataPacket>(packet);
-            vprASSERT(NULL != data_packet.get() && "Dynamic cast failed!");
+            // cluster::PacketFactory makes a DataPacket for every packet
+            // of this type, so the cast cannot fail.
+            cluster::DataPacket* data_packet =
+               static_cast<cluster::DataPacket*>(packet.get());
 
             //vprDEBUG(gadgetDBG_RIM,vprDBG_CONFIG_LVL) << "RIM::handlePacket()..." << std::endl <<  vprDEBUG_FLUSH;
             //data_packet->printData(1);
 
-            gadget::InputPtr virtual_device = getVirtualDevice(data_packet->getObjectId());
-            if ( NULL != virtual_device.get() )
+            VirtualDevice* virtual_device =
+               getChannelDevice(Header::getObjectChannel(packet->getChannel()),
+                                data_packet->getObjectId());
+            if ( NULL != virtual_device )
             {
                vpr::BufferObjectReader* reader = data_packet->getPacketReader();
                reader->setAttrib("rim.timestamp.delta", node->getDelta());
-               virtual_device->readObject(reader);
+               virtual_device->getDevice()->readObject(reader);
             }
             break;
          }
@@ -306,7 +325,8 @@ void RIMPlugin::handlePacket(cluster::PacketPtr packet, gadget::NodePtr node)
 bool RIMPlugin::addVirtualDevice(const vpr::GUID& deviceId,
                                  const std::string& name,
                                  const vpr::Uint16 deviceBaseType,
-                                 const std::string& hostname)
+                                 const std::string& hostname,
+                                 const vpr::Uint16 channel)
 {
    using namespace gadget;
 
@@ -328,19 +348,44 @@ bool RIMPlugin::addVirtualDevice(const vpr::GUID& deviceId,
 
    mVirtualDevices[deviceId] = virtual_device;
 
+   // Channel 0 means that the sender does not assign channels.
+   if ( 0 != channel )
+   {
+      if ( mDeviceChannels.size() <= channel )
+      {
+         mDeviceChannels.resize(channel + 1);
+      }
+      mDeviceChannels[channel] = virtual_device;
+   }
+
    return true;
 }
 
-gadget::InputPtr RIMPlugin::getVirtualDevice(const vpr::GUID& deviceId)
+VirtualDevice* RIMPlugin::getChannelDevice(const vpr::Uint16 channel,
+                                           const vpr::GUID& deviceId)
 {
-   for ( virtual_device_map_t::iterator i = mVirtualDevices.begin();
-         i != mVirtualDevices.end() ; i++ )
+   // Comparing the GUID keeps a channel that some other sender reuses from
+   // reaching the wrong device.
+   if ( channel < mDeviceChannels.size() )
    {
-      if ( (*i).first == deviceId )
+      VirtualDevice* device = mDeviceChannels[channel].get();
+      if ( NULL != device && device->getLocalId() == deviceId )
       {
-         return((*i).second->getDevice());
+         return device;
       }
    }
+
+   virtual_device_map_t::iterator found = mVirtualDevices.find(deviceId);
+   return found != mVirtualDevices.end() ? (*found).second.get() : NULL;
+}
+
+gadget::InputPtr RIMPlugin::getVirtualDevice(const vpr::GUID& deviceId)
+{
+   virtual_device_map_t::iterator found = mVirtualDevices.find(deviceId);
+   if ( found != mVirtualDevices.end() )
+   {
+      return (*found).second->getDevice();
+   }
    return gadget::InputPtr();
 }
 
@@ -382,6 +427,8 @@ void RIMPlugin::removeVirtualDevice(const vpr::GUID& device_id)
       {
          // Remove remote device from the InputManager
          gadget::InputManager::instance()->removeDevice((*i).second->getName());
+         std::replace(mDeviceChannels.begin(), mDeviceChannels.end(),
+                      (*i).second, VirtualDevicePtr());
          mVirtualDevices.erase(i);
          return;
       }
@@ -399,6 +446,8 @@ void RIMPlugin::removeVirtualDevice(const std::string& device_name)
       if ( (*i).second->getName() == device_name )
       {
          (*i).second->debugDump(vprDBG_CONFIG_LVL);
+         std::replace(mDeviceChannels.begin(), mDeviceChannels.end(),
+                      (*i).second, VirtualDevicePtr());
          mVirtualDevices.erase(i);
          return;
       }
@@ -419,8 +468,20 @@ void RIMPlugin::debugDumpVirtualDevices(int debug_level)
 bool RIMPlugin::addDeviceServer(const std::string& name,
                                 gadget::InputPtr device)
 {
+   // The data packets of the server carry the handler channel of this
+   // plugin and an object channel of their own, so that receivers can
+   // route them by indexing.  Object channels are never reused.
+   const vpr::Uint16 handler_channel =
+      ClusterManager::instance()->getNetwork()->getHandlerChannel(mHandlerGUID);
+   vpr::Uint32 channel(0);
+
+   if ( 0 != handler_channel && mLastDeviceChannel < 0xFFFF )
+   {
+      channel = Header::makeChannel(handler_channel, ++mLastDeviceChannel);
+   }
+
    DeviceServerPtr temp_device_server =
-      DeviceServer::create(name, device, mHandlerGUID);
+      DeviceServer::create(name, device, mHandlerGUID, channel);
    mDeviceServers.push_back(temp_device_server);
 
    return true;
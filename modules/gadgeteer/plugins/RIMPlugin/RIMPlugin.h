@@ -107,6 +107,21 @@ public:
     *  ClusterPlugin abstract class. 
     */
    virtual void postPostFrame();
+
+   /** Device data is sent in postPostFrame().
+    *
+    *  This function was inherited from the
+    *  ClusterPlugin abstract class.
+    */
+   virtual vpr::Uint32 getSyncPhases();
+
+   /** The master waits for the slaves only if it has virtual devices
+    *  whose data they serve.
+    *
+    *  This function was inherited from the
+    *  ClusterPlugin abstract class.
+    */
+   virtual bool needsSlaveData(const SyncPhase phase);
    
    /** Returns the status of RIMPlugin
     *
@@ -155,7 +170,19 @@ private:
    //@{
    bool addVirtualDevice(const vpr::GUID& deviceId, const std::string& name,
                          const vpr::Uint16 deviceBaseType,
-                         const std::string& hostname);
+                         const std::string& hostname,
+                         const vpr::Uint16 channel);
+
+   /**
+    * Returns the virtual device whose data arrives on the given object
+    * channel.  A device that is not bound to \p channel, which includes
+    * every device of a sender that does not assign channels, is looked up
+    * by \p deviceId instead.
+    *
+    * @return NULL if there is no such device.
+    */
+   VirtualDevice* getChannelDevice(const vpr::Uint16 channel,
+                                   const vpr::GUID& deviceId);
 
    void removeVirtualDevice(const std::string& device_name);
    void removeVirtualDevice(const vpr::GUID& device_id);
@@ -192,6 +219,9 @@ protected:
 
    typedef std::vector<DeviceServerPtr> device_server_list_t;
    device_server_list_t         mDeviceServers;      /**< List of Devices that should act as servers to remote Nodes.*/
+   vpr::Uint16                  mLastDeviceChannel;  /**< Object channel given to the newest device server. */
+
+   std::vector<VirtualDevicePtr> mDeviceChannels;    /**< Object channel to virtual device. */
 };
 
 } // end namespace gadget
@@ -101,7 +101,7 @@ public:
    /**
     * Return a pointer to the low level input device.
     */
-   gadget::InputPtr getDevice() const
+   const gadget::InputPtr& getDevice() const
    {
       return mDevice;
    }
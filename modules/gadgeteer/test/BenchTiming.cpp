@@ -0,0 +1,72 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <time.h>
+
+#include <vpr/System.h>
+
+#include "BenchTiming.h"
+
+
+namespace
+{
+
+/** How long before a tick is due the pacer stops sleeping and spins. */
+const vpr::Interval SPIN_TIME(2, vpr::Interval::Msec);
+
+}
+
+Pacer::Pacer(const float rate)
+   : mPeriodUsec(static_cast<vpr::Uint64>(1000000.0f / rate))
+   , mStartUsec(vpr::Interval::now().usec())
+{
+}
+
+vpr::Interval Pacer::wait(const vpr::Uint64 tick) const
+{
+   const vpr::Interval due(mStartUsec + mPeriodUsec * tick,
+                           vpr::Interval::Usec);
+
+   vpr::Interval now(vpr::Interval::now());
+   while ( now < due )
+   {
+      if ( due - now > SPIN_TIME )
+      {
+         vpr::System::msleep(1);
+      }
+
+      now = vpr::Interval::now();
+   }
+
+   return now;
+}
+
+double threadCpuTime()
+{
+   timespec now;
+   clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+   return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -0,0 +1,62 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _GADGET_TEST_BENCH_TIMING_H_
+#define _GADGET_TEST_BENCH_TIMING_H_
+
+#include <vpr/vpr.h>
+#include <vpr/Util/Interval.h>
+
+
+/**
+ * Paces a benchmark that replays input at a fixed rate.  Tick \c n is due
+ * \c n periods after the pacer was created.  Waiting sleeps until shortly
+ * before a tick is due and spins the rest of the way, so that the cadence
+ * is accurate without burning a CPU between ticks.
+ */
+class Pacer
+{
+public:
+   /** Starts the clock.  \p rate is the number of ticks per second. */
+   Pacer(const float rate);
+
+   /**
+    * Waits until the given tick is due.  Returns at once if it already is.
+    *
+    * @return The time at which the wait ended.
+    */
+   vpr::Interval wait(const vpr::Uint64 tick) const;
+
+private:
+   vpr::Uint64 mPeriodUsec;
+   vpr::Uint64 mStartUsec;
+};
+
+/** Returns the CPU time used by the calling thread in seconds. */
+double threadCpuTime();
+
+
+#endif /* _GADGET_TEST_BENCH_TIMING_H_ */
@@ -0,0 +1,99 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <cstdlib>
+#include <new>
+
+#include <cluster/Packets/DataPacket.h>
+
+#include "ClusterTestUtil.h"
+
+
+namespace
+{
+
+unsigned long gAllocations(0);
+
+}
+
+#if defined(__cplusplus) && __cplusplus >= 201103L
+#  define ALLOC_THROW
+#else
+#  define ALLOC_THROW throw(std::bad_alloc)
+#endif
+
+void* operator new(std::size_t size) ALLOC_THROW
+{
+   ++gAllocations;
+   void* p = std::malloc(size > 0 ? size : 1);
+   if ( NULL == p )
+   {
+      throw std::bad_alloc();
+   }
+   return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) throw()
+{
+   ++gAllocations;
+   return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size) ALLOC_THROW
+{
+   return operator new(size);
+}
+
+void operator delete(void* p) throw()
+{
+   std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) throw()
+{
+   std::free(p);
+}
+
+void operator delete[](void* p) throw()
+{
+   std::free(p);
+}
+
+unsigned long getAllocationCount()
+{
+   return gAllocations;
+}
+
+const vpr::GUID& getTestPluginId()
+{
+   static const vpr::GUID plugin_id("cc6ca39f-03f2-4779-aa4b-048f774ff9a5");
+   return plugin_id;
+}
+
+cluster::DataPacketPtr createTestDataPacket(const vpr::GUID& objectId)
+{
+   return cluster::DataPacket::create(getTestPluginId(), objectId);
+}
@@ -0,0 +1,55 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _GADGET_TEST_CLUSTER_TEST_UTIL_H_
+#define _GADGET_TEST_CLUSTER_TEST_UTIL_H_
+
+#include <vpr/vpr.h>
+#include <vpr/Util/GUID.h>
+
+#include <cluster/Packets/DataPacketPtr.h>
+
+
+/**
+ * Helpers shared by the cluster packet tests and benchmarks.
+ *
+ * Linking ClusterTestUtil into a program replaces the global operator new
+ * and operator delete with versions that count heap allocations, so that
+ * the allocations made by a piece of code can be checked with
+ * getAllocationCount().  The count is not thread safe.
+ */
+
+/** Returns the number of heap allocations made since the program started. */
+unsigned long getAllocationCount();
+
+/** Returns the GUID of the plugin that test packets are addressed to. */
+const vpr::GUID& getTestPluginId();
+
+/** Creates a data packet from the test plugin for \p objectId. */
+cluster::DataPacketPtr createTestDataPacket(const vpr::GUID& objectId);
+
+
+#endif /* _GADGET_TEST_CLUSTER_TEST_UTIL_H_ */
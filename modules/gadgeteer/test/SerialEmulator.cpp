@@ -0,0 +1,264 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+#include <boost/bind.hpp>
+
+#include <vpr/Sync/Guard.h>
+
+#include "SerialEmulator.h"
+
+
+namespace
+{
+
+/** Longest the emulator thread sleeps, so that idle() is called often. */
+const vpr::Uint64 MAX_WAIT_USEC(1000);
+
+}
+
+SerialEmulator::SerialEmulator(Protocol& protocol, const Settings& settings)
+   : mProtocol(protocol)
+   , mSettings(settings)
+   , mMasterFd(-1)
+   , mSlaveFd(-1)
+   , mThread(NULL)
+   , mRunning(false)
+   , mWriteOffset(0)
+   , mNextFrame(0)
+   , mRandom(settings.seed)
+{
+}
+
+SerialEmulator::~SerialEmulator()
+{
+   stop();
+}
+
+bool SerialEmulator::start()
+{
+   mMasterFd = posix_openpt(O_RDWR | O_NOCTTY);
+   if ( mMasterFd < 0 || grantpt(mMasterFd) != 0 ||
+        unlockpt(mMasterFd) != 0 || NULL == ptsname(mMasterFd) )
+   {
+      stop();
+      return false;
+   }
+
+   mPortName = ptsname(mMasterFd);
+
+   // The slave starts out as a terminal that echoes and translates line
+   // endings.  Make it raw before the driver opens it, and keep it open so
+   // that the master never reads EIO while the driver reopens the port.
+   mSlaveFd = ::open(mPortName.c_str(), O_RDWR | O_NOCTTY);
+   if ( mSlaveFd < 0 )
+   {
+      stop();
+      return false;
+   }
+
+   struct termios attrs;
+   tcgetattr(mSlaveFd, &attrs);
+   cfmakeraw(&attrs);
+   tcsetattr(mSlaveFd, TCSANOW, &attrs);
+
+   // A driver that stops reading must not block the emulator thread.
+   fcntl(mMasterFd, F_SETFL, fcntl(mMasterFd, F_GETFL) | O_NONBLOCK);
+
+   mRunning = true;
+   mThread  = new vpr::Thread(boost::bind(&SerialEmulator::run, this));
+
+   return true;
+}
+
+void SerialEmulator::stop()
+{
+   if ( NULL != mThread )
+   {
+      mRunning = false;
+      mThread->join();
+      delete mThread;
+      mThread = NULL;
+   }
+
+   if ( mSlaveFd >= 0 )
+   {
+      ::close(mSlaveFd);
+      mSlaveFd = -1;
+   }
+
+   if ( mMasterFd >= 0 )
+   {
+      ::close(mMasterFd);
+      mMasterFd = -1;
+   }
+}
+
+vpr::Uint32 SerialEmulator::send(const std::vector<vpr::Uint8>& frame)
+{
+   // An 8N1 character takes ten bit times.
+   const vpr::Uint64 wire_usec =
+      static_cast<vpr::Uint64>(frame.size()) * 10000000 /
+         mSettings.baud;
+
+   vpr::Interval start(vpr::Interval::now());
+   start += vpr::Interval(mSettings.responseDelayUsec + nextJitter(),
+                          vpr::Interval::Usec);
+
+   if ( start < mLineFree )
+   {
+      start = mLineFree;
+   }
+
+   mLineFree = start + vpr::Interval(wire_usec, vpr::Interval::Usec);
+
+   Pending pending;
+   pending.frame = mNextFrame++;
+   pending.due   = mLineFree;
+   pending.data  = frame;
+   mPending.push_back(pending);
+
+   return pending.frame;
+}
+
+vpr::Interval SerialEmulator::getSendTime(const vpr::Uint32 frame) const
+{
+   vpr::Guard<vpr::Mutex> guard(mSendTimesLock);
+   return frame < mSendTimes.size() ? mSendTimes[frame] : vpr::Interval();
+}
+
+vpr::Uint32 SerialEmulator::getFramesSent() const
+{
+   vpr::Guard<vpr::Mutex> guard(mSendTimesLock);
+   return static_cast<vpr::Uint32>(mSendTimes.size());
+}
+
+void SerialEmulator::run()
+{
+   std::vector<vpr::Uint8> buffer(512);
+
+   while ( mRunning )
+   {
+      const vpr::Interval now(vpr::Interval::now());
+      vpr::Uint64 wait_usec(MAX_WAIT_USEC);
+
+      flush(now);
+
+      if ( mPending.empty() )
+      {
+         mProtocol.idle(*this);
+      }
+
+      const bool blocked = ! mPending.empty() && mPending.front().due <= now;
+
+      if ( ! mPending.empty() && ! blocked )
+      {
+         const vpr::Uint64 until_due =
+            (mPending.front().due - now).usec();
+         wait_usec = until_due < wait_usec ? until_due : wait_usec;
+      }
+
+      fd_set read_fds, write_fds;
+      FD_ZERO(&read_fds);
+      FD_ZERO(&write_fds);
+      FD_SET(mMasterFd, &read_fds);
+      if ( blocked )
+      {
+         FD_SET(mMasterFd, &write_fds);
+      }
+
+      struct timeval timeout;
+      timeout.tv_sec  = 0;
+      timeout.tv_usec = static_cast<long>(wait_usec);
+
+      if ( select(mMasterFd + 1, &read_fds, &write_fds, NULL, &timeout) > 0 &&
+           FD_ISSET(mMasterFd, &read_fds) )
+      {
+         const ssize_t bytes = ::read(mMasterFd, &buffer[0], buffer.size());
+         if ( bytes > 0 )
+         {
+            mProtocol.received(&buffer[0], static_cast<vpr::Uint32>(bytes),
+                               *this);
+         }
+      }
+   }
+}
+
+void SerialEmulator::flush(const vpr::Interval& now)
+{
+   while ( ! mPending.empty() && mPending.front().due <= now )
+   {
+      Pending& pending = mPending.front();
+
+      // Record the time before writing, as the driver may return the sample
+      // before write() does.
+      if ( 0 == mWriteOffset )
+      {
+         vpr::Guard<vpr::Mutex> guard(mSendTimesLock);
+         mSendTimes.resize(pending.frame + 1);
+         mSendTimes[pending.frame] = vpr::Interval::now();
+      }
+
+      while ( mWriteOffset < pending.data.size() )
+      {
+         const ssize_t bytes = ::write(mMasterFd, &pending.data[mWriteOffset],
+                                       pending.data.size() - mWriteOffset);
+
+         if ( bytes < 0 )
+         {
+            // The driver is not keeping up.  The rest goes out once the
+            // pseudo-terminal has room for it.
+            if ( EINTR == errno )
+            {
+               continue;
+            }
+
+            return;
+         }
+
+         mWriteOffset += bytes;
+      }
+
+      mWriteOffset = 0;
+      mPending.pop_front();
+   }
+}
+
+vpr::Uint32 SerialEmulator::nextJitter()
+{
+   if ( 0 == mSettings.jitterUsec )
+   {
+      return 0;
+   }
+
+   mRandom = mRandom * 1103515245u + 12345u;
+   return ((mRandom >> 8) & 0xffffff) % mSettings.jitterUsec;
+}
@@ -0,0 +1,197 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _GADGET_TEST_SERIAL_EMULATOR_H_
+#define _GADGET_TEST_SERIAL_EMULATOR_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <vpr/vpr.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/Interval.h>
+
+
+/**
+ * Serial device emulator backed by a pseudo-terminal.  A standalone driver
+ * opens the slave side (getPortName()) exactly as it would open a real
+ * serial port, and a thread on the master side feeds what the driver writes
+ * to a Protocol that scripts the device's replies.
+ *
+ * A pty delivers bytes as fast as they are written, so the emulator paces
+ * replies itself.  Each frame is held back until its last byte would have
+ * arrived over a real 8N1 line at the configured baud rate, after the
+ * device's response delay plus a random jitter.  The whole frame is then
+ * written at once and the time is recorded, which lets a benchmark compute
+ * the latency from the moment a reply is complete on the wire to the moment
+ * the driver hands it out.
+ *
+ * Only POSIX systems are supported.
+ */
+class SerialEmulator
+{
+public:
+   /** The scripted behaviour of one device. */
+   class Protocol
+   {
+   public:
+      virtual ~Protocol()
+      {
+      }
+
+      /**
+       * Called on the emulator thread with bytes written by the driver.
+       * Replies are queued with SerialEmulator::send().
+       */
+      virtual void received(const vpr::Uint8* data, const vpr::Uint32 size,
+                            SerialEmulator& emulator) = 0;
+
+      /**
+       * Called on the emulator thread whenever no frame is waiting to be
+       * written.  Devices that stream data unprompted queue it here.
+       */
+      virtual void idle(SerialEmulator&)
+      {
+      }
+   };
+
+   struct Settings
+   {
+      Settings()
+         : baud(9600)
+         , responseDelayUsec(1000)
+         , jitterUsec(0)
+         , seed(1)
+      {
+      }
+
+      /** Line rate used to pace frames. */
+      int baud;
+
+      /**
+       * Time from the end of a command to the start of the reply.  Drivers
+       * that flush their input queue right after writing a command will
+       * lose replies that arrive earlier than that.
+       */
+      vpr::Uint32 responseDelayUsec;
+
+      /** Upper bound of the uniform random delay added to each frame. */
+      vpr::Uint32 jitterUsec;
+
+      /** Seed of the jitter generator, so that runs can be repeated. */
+      vpr::Uint32 seed;
+   };
+
+   SerialEmulator(Protocol& protocol, const Settings& settings);
+
+   ~SerialEmulator();
+
+   /**
+    * Creates the pseudo-terminal and starts the emulator thread.
+    *
+    * @return false if the pseudo-terminal could not be created.
+    */
+   bool start();
+
+   /** Stops the emulator thread and closes the pseudo-terminal. */
+   void stop();
+
+   /** Returns the device name that the driver under test should open. */
+   const std::string& getPortName() const
+   {
+      return mPortName;
+   }
+
+   /**
+    * Queues a frame for the driver.  Only call this from the Protocol
+    * callbacks.
+    *
+    * @return The number of the frame.  Frames are numbered from 0 in the
+    *         order that they are queued.
+    */
+   vpr::Uint32 send(const std::vector<vpr::Uint8>& frame);
+
+   /**
+    * Returns the number that the next frame passed to send() will get.
+    * Protocols use it to embed the frame number in the frame.
+    */
+   vpr::Uint32 getNextFrame() const
+   {
+      return mNextFrame;
+   }
+
+   /**
+    * Returns the time at which the given frame was written to the
+    * pseudo-terminal, or a zero interval if it has not been written yet.
+    */
+   vpr::Interval getSendTime(const vpr::Uint32 frame) const;
+
+   /** Returns the number of frames written to the pseudo-terminal. */
+   vpr::Uint32 getFramesSent() const;
+
+private:
+   struct Pending
+   {
+      vpr::Uint32 frame;
+      vpr::Interval due;
+      std::vector<vpr::Uint8> data;
+   };
+
+   void run();
+
+   /** Returns a jitter value in [0,Settings::jitterUsec). */
+   vpr::Uint32 nextJitter();
+
+   /** Writes every frame that is due. */
+   void flush(const vpr::Interval& now);
+
+   Protocol&   mProtocol;
+   Settings    mSettings;
+   std::string mPortName;
+
+   int mMasterFd;
+   int mSlaveFd;     /**< Held open so that the driver closing it is safe. */
+
+   vpr::Thread* mThread;
+   volatile bool mRunning;
+
+   /** @name Emulator thread state */
+   //@{
+   std::deque<Pending> mPending;
+   std::size_t   mWriteOffset;     /**< Bytes of the first frame written. */
+   vpr::Interval mLineFree;        /**< When the last queued frame ends. */
+   vpr::Uint32   mNextFrame;
+   vpr::Uint32   mRandom;
+   //@}
+
+   mutable vpr::Mutex mSendTimesLock;
+   std::vector<vpr::Interval> mSendTimes;
+};
+
+
+#endif /* _GADGET_TEST_SERIAL_EMULATOR_H_ */
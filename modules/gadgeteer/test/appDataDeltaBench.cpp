@@ -0,0 +1,280 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+/*
+ * Measures what replicating a large cluster::ApplicationData object costs per
+ * frame, in bytes sent and CPU time, with full serialization (the default)
+ * and with delta encoding (ApplicationData::setDeltaEncoding()).  The
+ * packets are built the way ApplicationDataServer builds them and applied
+ * the way ApplicationDataManager applies them, without a network in between.
+ * The received object is checked against the sent one every frame.
+ *
+ * Usage: appDataDeltaBench [-s bytes] [-c changes] [-n frames] [-k interval]
+ *                          [-e every]
+ *
+ * The shared object is an array of floats of the given size (1 MB by
+ * default).  Each frame, the given number of floats at random positions are
+ * changed.  With -e, the object only changes every given number of frames,
+ * which is what dirty tracking (ApplicationData::setDirtyTracking()) makes
+ * free.  -k is the keyframe interval.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <vpr/vpr.h>
+#include <vpr/IO/BufferObjectReader.h>
+#include <vpr/IO/BufferObjectWriter.h>
+#include <vpr/IO/SerializableObject.h>
+#include <vpr/Util/GUID.h>
+#include <vpr/Util/Interval.h>
+
+#include <cluster/ClusterException.h>
+#include <cluster/Packets/DataPacket.h>
+#include <cluster/Packets/DeltaPacket.h>
+
+#include "ClusterTestUtil.h"
+
+
+namespace
+{
+
+class SharedState : public vpr::SerializableObject
+{
+public:
+   explicit SharedState(const std::size_t bytes)
+      : mValues(bytes / sizeof(float))
+   {
+      for ( std::size_t i = 0; i < mValues.size(); ++i )
+      {
+         mValues[i] = static_cast<float>(i);
+      }
+   }
+
+   virtual void writeObject(vpr::ObjectWriter* writer)
+   {
+      writer->writeUint32(mValues.size());
+      for ( std::size_t i = 0; i < mValues.size(); ++i )
+      {
+         writer->writeFloat(mValues[i]);
+      }
+   }
+
+   virtual void readObject(vpr::ObjectReader* reader)
+   {
+      mValues.resize(reader->readUint32());
+      for ( std::size_t i = 0; i < mValues.size(); ++i )
+      {
+         mValues[i] = reader->readFloat();
+      }
+   }
+
+   std::vector<float> mValues;
+};
+
+/** Strips the packet header, as gadget::Node does when receiving. */
+void receive(cluster::Packet& sent, cluster::Packet& received)
+{
+   const std::vector<vpr::Uint8>& data = sent.getData();
+   received.getData().assign(data.begin() + cluster::Header::RIM_PACKET_HEAD_SIZE,
+                             data.end());
+   received.parse();
+}
+
+struct Result
+{
+   Result()
+      : bytes(0)
+      , packets(0)
+      , keyframes(0)
+      , sendUsec(0.0)
+      , recvUsec(0.0)
+   {;}
+
+   double      bytes;
+   unsigned    packets;
+   unsigned    keyframes;
+   double      sendUsec;
+   double      recvUsec;
+};
+
+void report(const char* name, const Result& r, const unsigned int frames)
+{
+   std::cout << name << ": " << r.bytes / frames << " bytes/frame, "
+             << r.packets << " packets, " << r.keyframes << " keyframes, "
+             << "send " << r.sendUsec / frames << " us/frame, "
+             << "receive " << r.recvUsec / frames << " us/frame"
+             << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   std::size_t size(1024 * 1024);
+   unsigned int changes(64);
+   unsigned int frames(300);
+   unsigned int interval(300);   // ApplicationData::DEFAULT_KEYFRAME_INTERVAL
+   unsigned int every(1);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-s") == 0 )
+      {
+         size = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-c") == 0 )
+      {
+         changes = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         frames = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-k") == 0 )
+      {
+         interval = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-e") == 0 )
+      {
+         every = std::atoi(argv[i + 1]);
+      }
+   }
+
+   if ( frames == 0 || every == 0 || size < sizeof(float) )
+   {
+      std::cerr << "Nothing to send" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   const vpr::GUID object_id("3c0b2d4e-56b1-4f0f-9e53-0a1d4b8e7c21");
+
+   SharedState master(size);
+   SharedState full_slave(0);
+   SharedState delta_slave(0);
+
+   cluster::DataPacketPtr data_packet =
+      createTestDataPacket(object_id);
+   cluster::DataPacketPtr data_recv = cluster::DataPacket::create();
+   cluster::DeltaPacketPtr delta_packet =
+      cluster::DeltaPacket::create(getTestPluginId(), object_id);
+   cluster::DeltaPacketPtr delta_recv = cluster::DeltaPacket::create();
+
+   std::vector<vpr::Uint8> state;
+   std::vector<vpr::Uint8> last_sent;
+   std::vector<vpr::Uint8> received_state;
+   bool have_last_sent(false);
+   unsigned int since_keyframe(0);
+
+   Result full, delta;
+   std::srand(1);
+
+   for ( unsigned int f = 0; f < frames; ++f )
+   {
+      const bool dirty(f % every == 0);
+
+      if ( dirty && f > 0 )
+      {
+         for ( unsigned int c = 0; c < changes; ++c )
+         {
+            master.mValues[std::rand() % master.mValues.size()] += 1.0f;
+         }
+      }
+
+      const bool keyframe_due(interval > 0 && since_keyframe >= interval);
+
+      // Full serialization of every frame, as without dirty tracking.
+      {
+         vpr::Interval start(vpr::Interval::now());
+         data_packet->serialize(master);
+         full.sendUsec += (vpr::Interval::now() - start).usecf();
+         full.bytes += data_packet->getData().size();
+         ++full.packets;
+         ++full.keyframes;
+
+         receive(*data_packet, *data_recv);
+
+         start = vpr::Interval::now();
+         full_slave.readObject(data_recv->getPacketReader());
+         full.recvUsec += (vpr::Interval::now() - start).usecf();
+      }
+
+      // Dirty tracking and delta encoding.
+      if ( dirty || keyframe_due )
+      {
+         vpr::Interval start(vpr::Interval::now());
+         state.clear();
+         vpr::BufferObjectWriter writer(&state);
+         master.writeObject(&writer);
+
+         const bool keyframe =
+            delta_packet->serialize(state, have_last_sent && ! keyframe_due ?
+                                              &last_sent : NULL);
+         last_sent.swap(state);
+         have_last_sent = true;
+         delta.sendUsec += (vpr::Interval::now() - start).usecf();
+
+         since_keyframe = keyframe ? 0 : since_keyframe + 1;
+
+         if ( keyframe || delta_packet->getRunCount() > 0 )
+         {
+            delta.bytes += delta_packet->getData().size();
+            ++delta.packets;
+            delta.keyframes += keyframe ? 1 : 0;
+
+            receive(*delta_packet, *delta_recv);
+
+            start = vpr::Interval::now();
+            delta_recv->apply(received_state);
+            vpr::BufferObjectReader reader(&received_state);
+            delta_slave.readObject(&reader);
+            delta.recvUsec += (vpr::Interval::now() - start).usecf();
+         }
+      }
+      else
+      {
+         ++since_keyframe;
+      }
+
+      if ( full_slave.mValues != master.mValues ||
+           delta_slave.mValues != master.mValues )
+      {
+         std::cerr << "Replicated object differs in frame " << f << std::endl;
+         return EXIT_FAILURE;
+      }
+   }
+
+   std::cout << size << " byte object, " << changes << " changes every "
+             << every << " frame(s), " << frames << " frames, keyframe every "
+             << interval << " frames" << std::endl;
+   report("full ", full, frames);
+   report("delta", delta, frames);
+
+   return EXIT_SUCCESS;
+}
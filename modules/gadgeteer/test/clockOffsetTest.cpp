@@ -0,0 +1,546 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Test for the clock offset estimate of cluster::FrameTrace.  A master trace
+ * is fed the end block round trip timings of a simulated slave whose clock
+ * is set off from the master's by a known amount.  Each round trip is timed
+ * as it would be on both ends: the master records when it sent its end
+ * block and when it read the slave's, and the slave's side arrives in a
+ * data packet the way a slave sends it.  Both end blocks are delayed by a
+ * fixed network latency plus random queueing jitter.
+ *
+ * The simulation has three parts: a steady clock, a clock that drifts fast
+ * enough that the bounds of old round trips no longer overlap those of new
+ * ones, and a clock that steps and then holds steady again.  At every round
+ * trip, the estimate must be within the one-way delay of that round trip,
+ * and once a full window of round trips of a steady clock has been seen, it
+ * must be within a tight tolerance.  The estimate must also be the delta of
+ * the slave's gadget::Node.  A slave round trip that the master did not
+ * record must leave the estimate alone.  Afterwards, the timeline file must
+ * hold a closed JSON array although the trace is still open.
+ *
+ * Finally, a master and a slave gadget::NetworkManager are connected over
+ * loopback and run frames made only of update() calls, with their traces
+ * flushed every frame as cluster::ClusterManager does.  Both share one
+ * clock, so the offset estimated from these round trips must be close to 0.
+ *
+ * Usage: clockOffsetTest [-n round trips per part] [-j max jitter usec]
+ *                        [-s seed] [-o trace file] [-l loopback trace file]
+ *                        [-p port]
+ *
+ * The exit status is non-zero if the estimate leaves its bounds or if the
+ * timeline is not closed.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <vpr/vpr.h>
+#include <vpr/IO/SerializableObject.h>
+#include <vpr/System.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/GUID.h>
+#include <vpr/Util/Interval.h>
+
+#include <gadget/NetworkManager.h>
+#include <gadget/Node.h>
+#include <cluster/FrameTrace.h>
+#include <cluster/Packets/DataPacket.h>
+#include <cluster/Packets/Header.h>
+
+
+namespace
+{
+
+/** Network latency of an end block, without queueing. */
+const vpr::Int64 LATENCY_USEC(60);
+
+/** Time between round trips. */
+const vpr::Int64 FRAME_USEC(16667);
+
+/** Number of round trips that FrameTrace keeps bounds for. */
+const unsigned int WINDOW(64);
+
+/** Frames run over loopback. */
+const vpr::Uint32 LOOPBACK_FRAMES(200);
+
+/** Largest offset accepted between two nodes that share a clock. */
+const vpr::Int64 LOOPBACK_TOLERANCE_USEC(2000);
+
+/** Master clock minus slave clock at the start. */
+const vpr::Int64 INITIAL_OFFSET_USEC(5000000);
+
+/**
+ * The slave's side of one round trip in the form that cluster::FrameTrace
+ * sends it: no new span names, one round trip sample and no spans.
+ */
+class SlaveRoundTrip : public vpr::SerializableObject
+{
+public:
+   SlaveRoundTrip(const vpr::Uint32 seq, const vpr::Uint64 sent,
+                  const vpr::Uint64 received)
+      : mSeq(seq)
+      , mSent(sent)
+      , mReceived(received)
+   {;}
+
+   virtual void writeObject(vpr::ObjectWriter* writer)
+   {
+      writer->writeUint16(0);          // First new name
+      writer->writeUint16(0);          // Number of new names
+      writer->writeUint32(1);          // Number of round trips
+      writer->writeUint32(mSeq);
+      writer->writeUint64(mSent);
+      writer->writeUint64(mReceived);
+      writer->writeUint32(0);          // Number of spans
+   }
+
+   virtual void readObject(vpr::ObjectReader*)
+   {
+   }
+
+private:
+   vpr::Uint32 mSeq;
+   vpr::Uint64 mSent;
+   vpr::Uint64 mReceived;
+};
+
+vpr::Int64 magnitude(const vpr::Int64 value)
+{
+   return value < 0 ? -value : value;
+}
+
+/** Feeds the round trips of one simulated slave to a master trace. */
+class Simulation
+{
+public:
+   Simulation(cluster::FrameTracePtr master, const vpr::Int64 maxJitter)
+      : mMaster(master)
+      , mSlave(gadget::Node::create("slave", "localhost", 0, NULL))
+      , mMaxJitter(maxJitter)
+      , mNow(1000000000)
+      , mOffset(INITIAL_OFFSET_USEC)
+      , mSeq(0)
+      , mFailures(0)
+   {
+      mSlave->setStatus(gadget::Node::CONNECTED);
+      mNodes.push_back(mSlave);
+   }
+
+   /** The true offset, master clock minus slave clock. */
+   vpr::Int64 getOffset() const
+   {
+      return mOffset;
+   }
+
+   /** Moves the slave clock by \p usec relative to the master's. */
+   void shiftClock(const vpr::Int64 usec)
+   {
+      mOffset -= usec;
+   }
+
+   /** Returns true if the master has an estimate for the slave. */
+   bool hasEstimate()
+   {
+      vpr::Int64 estimate(0);
+      return mMaster->getClockOffset(*mSlave, estimate);
+   }
+
+   /**
+    * Runs one round trip and checks the estimate against the delays of the
+    * end blocks.  If \p tolerance is positive, the estimate must also be
+    * within it.  Returns the error of the estimate.
+    */
+   vpr::Int64 roundTrip(const vpr::Int64 tolerance, const std::string& part)
+   {
+      mNow += FRAME_USEC;
+
+      // Times on the master's clock.
+      const vpr::Int64 master_sent(mNow + jitter());
+      const vpr::Int64 slave_sent(mNow + jitter());
+      const vpr::Int64 to_slave(LATENCY_USEC + jitter());
+      const vpr::Int64 to_master(LATENCY_USEC + jitter());
+
+      mSlave->setUpdateTime(usec(slave_sent + to_master));
+      mMaster->addRoundTrip(mNodes, usec(master_sent));
+
+      send(mSeq, slave_sent - mOffset, master_sent + to_slave - mOffset);
+      ++mSeq;
+
+      vpr::Int64 estimate(0);
+      if ( ! mMaster->getClockOffset(*mSlave, estimate) )
+      {
+         fail(part, "no estimate");
+         return 0;
+      }
+
+      const vpr::Int64 error(estimate - mOffset);
+
+      // A time stamp from the slave is mapped onto the master's clock by
+      // adding the node's delta, which wraps.
+      const vpr::Uint64 slave_stamp(slave_sent - mOffset);
+      if ( slave_stamp + mSlave->getDelta() !=
+              static_cast<vpr::Uint64>(slave_sent + error) )
+      {
+         fail(part, "the node's delta does not map the slave's time stamps");
+      }
+
+      // The latest round trip alone puts the offset within these bounds.
+      if ( error < -to_slave || error > to_master )
+      {
+         fail(part, "estimate outside of the latest round trip's bounds",
+              error);
+      }
+      else if ( tolerance > 0 && (error < -tolerance || error > tolerance) )
+      {
+         fail(part, "estimate outside of the tolerance", error);
+      }
+
+      return error;
+   }
+
+   /**
+    * Sends a slave sample for a round trip that the master never recorded,
+    * as one that the master did not wait for.  The estimate must not
+    * change.
+    */
+   void strayRoundTrip()
+   {
+      vpr::Int64 before(0), after(0);
+      mMaster->getClockOffset(*mSlave, before);
+
+      mMaster->skipRoundTrip();
+      send(mSeq, mNow - mOffset, mNow - mOffset);
+      ++mSeq;
+
+      mMaster->getClockOffset(*mSlave, after);
+      if ( before != after )
+      {
+         fail("stray", "estimate changed by a round trip never recorded",
+              after - before);
+      }
+   }
+
+   unsigned int getFailures() const
+   {
+      return mFailures;
+   }
+
+private:
+   vpr::Int64 jitter()
+   {
+      return mMaxJitter > 0 ? std::rand() % (mMaxJitter + 1) : 0;
+   }
+
+   static vpr::Interval usec(const vpr::Int64 time)
+   {
+      return vpr::Interval(static_cast<vpr::Uint64>(time),
+                           vpr::Interval::Usec);
+   }
+
+   /**
+    * Hands the slave's side of a round trip to the master.  The packet is
+    * serialized the way the slave sends it and read back the way
+    * gadget::Node receives it.
+    */
+   void send(const vpr::Uint32 seq, const vpr::Int64 sent,
+             const vpr::Int64 received)
+   {
+      SlaveRoundTrip sample(seq, static_cast<vpr::Uint64>(sent),
+                            static_cast<vpr::Uint64>(received));
+
+      const vpr::GUID id(mMaster->getHandlerGUID());
+      cluster::DataPacketPtr out = cluster::DataPacket::create(id, id);
+      out->serialize(sample);
+
+      const std::vector<vpr::Uint8>& wire = out->getData();
+      cluster::HeaderPtr header = cluster::Header::create();
+      header->readData(&wire[0]);
+
+      cluster::DataPacketPtr in = cluster::DataPacket::create();
+      in->setHeader(header);
+      in->getData().assign(
+         wire.begin() + cluster::Header::RIM_PACKET_HEAD_SIZE,
+         wire.begin() + header->getPacketLength());
+      in->parse();
+
+      mMaster->handlePacket(in, mSlave);
+   }
+
+   void fail(const std::string& part, const std::string& what,
+             const vpr::Int64 error = 0)
+   {
+      // Only the first few failures are worth reading.
+      if ( mFailures < 10 )
+      {
+         std::cerr << "FAILED (" << part << ", round trip " << mSeq << "): "
+                   << what << ", error " << error << " usec" << std::endl;
+      }
+      ++mFailures;
+   }
+
+   cluster::FrameTracePtr               mMaster;
+   gadget::NodePtr                      mSlave;
+   gadget::NetworkManager::node_list_t  mNodes;
+   const vpr::Int64                     mMaxJitter;
+   vpr::Int64                           mNow;
+   vpr::Int64                           mOffset;
+   vpr::Uint32                          mSeq;
+   unsigned int                         mFailures;
+};
+
+/** Returns true if \p fileName holds a JSON array closed once, at its end. */
+bool isClosedTimeline(const std::string& fileName)
+{
+   std::ifstream input(fileName.c_str());
+   const std::string text((std::istreambuf_iterator<char>(input)),
+                          std::istreambuf_iterator<char>());
+   const std::string end("\n]\n");
+
+   return text.size() > end.size() && '[' == text[0] &&
+          text.find(end) == text.size() - end.size();
+}
+
+/**
+ * Runs frames made only of update() calls, with the trace flushed the way
+ * cluster::ClusterManager flushes it.
+ */
+void runLoopbackFrames(gadget::NetworkManager& network,
+                       cluster::FrameTracePtr trace)
+{
+   for ( vpr::Uint32 f = 0; f < LOOPBACK_FRAMES; ++f )
+   {
+      network.corkNetwork();
+      trace->flush(network);
+      network.update(3);
+      trace->endFrame();
+   }
+}
+
+void runLoopbackSlave(const vpr::Uint16 port)
+{
+   gadget::NetworkManager network;
+   cluster::FrameTracePtr trace = cluster::FrameTrace::create();
+   trace->start(false, "slave");
+   network.setFrameTrace(trace);
+
+   network.waitForConnection(port);
+   runLoopbackFrames(network, trace);
+   network.shutdown();
+}
+
+/**
+ * Estimates the offset between a master and a slave that share a clock
+ * from their update() round trips.  Returns the number of failures.
+ */
+unsigned int runLoopback(const vpr::Uint16 port)
+{
+   gadget::NetworkManager network;
+   cluster::FrameTracePtr trace = cluster::FrameTrace::create();
+   trace->start(true, "master");
+   network.addHandler(trace);
+   network.setFrameTrace(trace);
+
+   vpr::Thread slave(boost::bind(&runLoopbackSlave, port));
+   network.addNode("slave", "localhost", port);
+
+   if ( ! network.connectToSlaves(vpr::Interval(10, vpr::Interval::Sec)) )
+   {
+      std::cerr << "FAILED: could not connect to the loopback slave"
+                << std::endl;
+      network.shutdown();
+      slave.join();
+      return 1;
+   }
+
+   runLoopbackFrames(network, trace);
+
+   vpr::Int64 offset(0);
+   const bool known = trace->getClockOffset(*network.getNodes()[0], offset);
+
+   network.shutdown();
+   slave.join();
+
+   if ( ! known )
+   {
+      std::cerr << "FAILED: no estimate from " << LOOPBACK_FRAMES
+                << " update() round trips" << std::endl;
+      return 1;
+   }
+
+   std::cout << "Loopback: offset " << offset << " usec after "
+             << LOOPBACK_FRAMES << " frames of update() round trips"
+             << std::endl;
+
+   if ( magnitude(offset) > LOOPBACK_TOLERANCE_USEC )
+   {
+      std::cerr << "FAILED: the estimate for a shared clock is off by more "
+                << "than " << LOOPBACK_TOLERANCE_USEC << " usec" << std::endl;
+      return 1;
+   }
+
+   return 0;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   unsigned int round_trips(500);
+   vpr::Int64 max_jitter(800);
+   unsigned int seed(1);
+   std::string trace_file("clockOffsetTest.json");
+   std::string loopback_file("clockOffsetLoopback.json");
+   vpr::Uint16 port(17800);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         round_trips = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-j") == 0 )
+      {
+         max_jitter = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-s") == 0 )
+      {
+         seed = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-o") == 0 )
+      {
+         trace_file = argv[i + 1];
+      }
+      else if ( std::strcmp(argv[i], "-l") == 0 )
+      {
+         loopback_file = argv[i + 1];
+      }
+      else if ( std::strcmp(argv[i], "-p") == 0 )
+      {
+         port = std::atoi(argv[i + 1]);
+      }
+   }
+
+   if ( round_trips < 2 * WINDOW )
+   {
+      round_trips = 2 * WINDOW;
+   }
+
+   std::srand(seed);
+
+   // FrameTrace decides whether to trace when it is created.
+   vpr::System::setenv("GADGET_CLUSTER_TRACE", trace_file);
+   cluster::FrameTracePtr master = cluster::FrameTrace::create();
+   master->start(true, "master");
+
+   if ( ! master->isEnabled() )
+   {
+      std::cerr << "FAILED: could not start tracing to " << trace_file
+                << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   Simulation sim(master, max_jitter);
+
+   if ( sim.hasEstimate() )
+   {
+      std::cerr << "FAILED: an estimate before the first round trip"
+                << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   // The best of a window of round trips is within a few microseconds of the
+   // latency asymmetry, which is zero here, unless the jitter never got
+   // small.  A tenth of the jitter leaves plenty of room for that.
+   const vpr::Int64 tolerance(max_jitter / 10 + 1);
+
+   // A steady clock.
+   vpr::Int64 worst(0);
+   for ( unsigned int r = 0; r < round_trips; ++r )
+   {
+      const vpr::Int64 error =
+         sim.roundTrip(r >= WINDOW ? tolerance : 0, "steady");
+      worst = r >= WINDOW ? std::max(worst, magnitude(error)) : worst;
+   }
+   std::cout << "Steady clock: worst error " << worst << " usec after "
+             << WINDOW << " round trips" << std::endl;
+
+   sim.strayRoundTrip();
+
+   // A clock that drifts so fast that the bounds of the oldest and the
+   // newest round trips of the window are far apart.  Only the latest round
+   // trip can be trusted then.
+   const vpr::Int64 drift(4 * (max_jitter + LATENCY_USEC) / WINDOW + 1);
+   worst = 0;
+   for ( unsigned int r = 0; r < round_trips; ++r )
+   {
+      sim.shiftClock(drift);
+      worst = std::max(worst, magnitude(sim.roundTrip(0, "drift")));
+   }
+   std::cout << "Drifting clock (" << drift << " usec per round trip): worst "
+             << "error " << worst << " usec" << std::endl;
+
+   // A step, as when the slave's clock is set, then a steady clock again.
+   sim.shiftClock(-3 * (max_jitter + LATENCY_USEC));
+   worst = 0;
+   for ( unsigned int r = 0; r < round_trips; ++r )
+   {
+      const vpr::Int64 error =
+         sim.roundTrip(r >= WINDOW ? tolerance : 0, "step");
+      worst = r >= WINDOW ? std::max(worst, magnitude(error)) : worst;
+   }
+   std::cout << "Stepped clock: worst error " << worst << " usec after "
+             << WINDOW << " round trips" << std::endl;
+
+   unsigned int failures(sim.getFailures());
+
+   // The trace is still open.
+   if ( ! isClosedTimeline(trace_file) )
+   {
+      std::cerr << "FAILED: " << trace_file << " does not hold a closed "
+                << "JSON array" << std::endl;
+      ++failures;
+   }
+
+   vpr::System::setenv("GADGET_CLUSTER_TRACE", loopback_file);
+   failures += runLoopback(port);
+
+   if ( failures > 0 )
+   {
+      std::cerr << "FAILED: " << failures << " check(s)" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,473 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Loopback test for gadget::NetworkManager::connectToSlaves().  Fake slave
+ * nodes run in threads of this process and listen on consecutive ports of
+ * localhost.  Each one waits a while before it starts listening, so the
+ * master has to retry, and another while before it answers the shared
+ * memory offer of the transport negotiation that follows the connection.
+ * The answer always declines the offer so that the socket stays in use.
+ *
+ * The first run connects to all of the slaves, which must take about as long
+ * as the slowest one and not the sum of their delays.  The second run mixes
+ * in a slave that never listens, which must be reported as failed once the
+ * deadline has passed without holding up the others, and two slaves that
+ * predate the transport negotiation.  Those must be connected through the
+ * socket: one sends an end block right away, which must be kept for the
+ * frame loop, and the other stays quiet until the negotiation gives up on
+ * it.  The time taken by each run is printed.
+ *
+ * Usage: clusterConnectTest [-n slaves] [-d max delay msec] [-t timeout sec]
+ *                           [-k dead slave timeout sec] [-p base port]
+ *
+ * The exit status is non-zero if a live slave is not connected, if the dead
+ * one is, if an old slave loses its end block, or if a run takes longer than
+ * it should.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <vpr/vpr.h>
+#include <vpr/IO/IOException.h>
+#include <vpr/IO/ObjectReader.h>
+#include <vpr/IO/ObjectWriter.h>
+#include <vpr/IO/SerializableObject.h>
+#include <vpr/IO/Socket/InetAddr.h>
+#include <vpr/IO/Socket/SocketStream.h>
+#include <vpr/System.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/GUID.h>
+#include <vpr/Util/Interval.h>
+
+#include <cluster/ClusterException.h>
+#include <cluster/Packets/DataPacket.h>
+#include <cluster/Packets/EndBlock.h>
+#include <cluster/Packets/Header.h>
+#include <gadget/NetworkManager.h>
+#include <gadget/Node.h>
+
+
+namespace
+{
+
+/**
+ * Time allowed on top of the injected delays for the retry interval, the
+ * thread start-up and the scheduler.
+ */
+const vpr::Uint64 SLACK_MSEC(750);
+
+/**
+ * The transport negotiation as gadget::NetworkManager speaks it.  It is
+ * spelled out here so that a change to the wire format breaks this test.
+ */
+struct TransportMessage : public vpr::SerializableObject
+{
+   enum Kind
+   {
+      HELLO  = 0,
+      OFFER  = 1,
+      ANSWER = 2
+   };
+
+   TransportMessage(const Kind messageKind = HELLO)
+      : version(1)
+      , kind(messageKind)
+      , accepted(false)
+   {;}
+
+   static const vpr::GUID& getGUID()
+   {
+      static const vpr::GUID guid("6f0e4d8a-2c51-4b7e-93a4-d1c85e2b7f06");
+      return guid;
+   }
+
+   virtual void writeObject(vpr::ObjectWriter* writer)
+   {
+      writer->writeUint16(version);
+      writer->writeUint8(kind);
+      writer->writeString(name);
+      writer->writeBool(accepted);
+   }
+
+   virtual void readObject(vpr::ObjectReader* reader)
+   {
+      version  = reader->readUint16();
+      kind     = reader->readUint8();
+      name     = reader->readString();
+      accepted = reader->readBool();
+   }
+
+   vpr::Uint16 version;
+   vpr::Uint8  kind;
+   std::string name;
+   bool        accepted;
+};
+
+/** A slave node that only takes part in setting up the connection. */
+class FakeSlave
+{
+public:
+   enum Kind
+   {
+      NEGOTIATING,   /**< Declines the offer after its answer delay */
+      DEAD,          /**< Never listens */
+      OLD,           /**< Sends an end block instead of a hello */
+      OLD_QUIET      /**< Sends nothing */
+   };
+
+   FakeSlave(const vpr::Uint16 port, const Kind kind,
+             const vpr::Uint32 listenDelay = 0,
+             const vpr::Uint32 answerDelay = 0)
+      : mPort(port)
+      , mKind(kind)
+      , mListenDelay(listenDelay)
+      , mAnswerDelay(answerDelay)
+      , mThread(NULL)
+   {
+   }
+
+   ~FakeSlave()
+   {
+      join();
+   }
+
+   void start()
+   {
+      if ( DEAD != mKind )
+      {
+         mThread = new vpr::Thread(boost::bind(&FakeSlave::run, this));
+      }
+   }
+
+   void join()
+   {
+      if ( NULL != mThread )
+      {
+         mThread->join();
+         delete mThread;
+         mThread = NULL;
+      }
+   }
+
+   vpr::Uint16 getPort() const
+   {
+      return mPort;
+   }
+
+   Kind getKind() const
+   {
+      return mKind;
+   }
+
+   /** Time that the master has to wait for this slave at least. */
+   vpr::Uint32 getDelay() const
+   {
+      return mListenDelay + mAnswerDelay;
+   }
+
+private:
+   void run()
+   {
+      vpr::System::msleep(mListenDelay);
+
+      try
+      {
+         vpr::InetAddr addr;
+         addr.setAddress("localhost", mPort);
+         vpr::SocketStream server(addr, vpr::InetAddr::AnyAddr);
+         server.openServer(true);
+
+         vpr::SocketStream* client = new vpr::SocketStream();
+         gadget::NodePtr master =
+            gadget::Node::create("master", "localhost", mPort, client);
+         server.accept(*client, vpr::Interval(60, vpr::Interval::Sec));
+         server.close();
+
+         if ( NEGOTIATING == mKind )
+         {
+            TransportMessage hello(TransportMessage::HELLO);
+            send(master, hello);
+
+            TransportMessage offer;
+            cluster::PacketPtr packet = master->recvPacket();
+            offer.readObject(packet->getPacketReader());
+
+            if ( ! offer.name.empty() )
+            {
+               vpr::System::msleep(mAnswerDelay);
+               TransportMessage answer(TransportMessage::ANSWER);
+               send(master, answer);
+            }
+         }
+         else if ( OLD == mKind )
+         {
+            master->send(cluster::EndBlock::create(0));
+         }
+
+         // Returns once the master closes the connection.
+         vpr::Uint8 unused;
+         client->recvn(&unused, 1);
+      }
+      catch (vpr::IOException&)
+      {
+         // The master has closed the connection.
+      }
+      catch (cluster::ClusterException& ex)
+      {
+         std::cerr << "Slave on port " << mPort << ": " << ex.what()
+                   << std::endl;
+      }
+   }
+
+   void send(gadget::NodePtr master, TransportMessage& message)
+   {
+      cluster::DataPacketPtr packet =
+         cluster::DataPacket::create(TransportMessage::getGUID(),
+                                     TransportMessage::getGUID());
+      packet->serialize(message);
+      master->send(packet);
+   }
+
+   const vpr::Uint16  mPort;
+   const Kind         mKind;
+   const vpr::Uint32  mListenDelay;
+   const vpr::Uint32  mAnswerDelay;
+   vpr::Thread*       mThread;
+};
+
+typedef std::vector<FakeSlave*> slave_list_t;
+
+/**
+ * Connects a new network to \p slaves.  Returns the number of failures,
+ * which are slaves whose connection state is not \p expected or that took
+ * longer than \p maxTime.
+ */
+unsigned int connectSlaves(const slave_list_t& slaves,
+                           const std::vector<bool>& expected,
+                           const vpr::Interval& timeout,
+                           const vpr::Interval& maxTime,
+                           vpr::Interval& elapsed)
+{
+   gadget::NetworkManager network;
+
+   for ( unsigned int i = 0; i < slaves.size(); ++i )
+   {
+      network.addNode("slave", "localhost", slaves[i]->getPort());
+      slaves[i]->start();
+   }
+
+   const vpr::Interval start(vpr::Interval::now());
+   const bool all_connected = network.connectToSlaves(timeout);
+   elapsed = vpr::Interval::now() - start;
+
+   unsigned int failures(0);
+
+   const gadget::NetworkManager::connect_status_list_t& status =
+      network.getConnectStatus();
+   for ( unsigned int i = 0; i < status.size(); ++i )
+   {
+      if ( FakeSlave::OLD == slaves[i]->getKind() && status[i].connected )
+      {
+         // The end block sent instead of a hello comes first.
+         const bool kept(status[i].node->hasPendingPacket() &&
+                         cluster::Header::RIM_END_BLOCK ==
+                            status[i].node->recvPacket()->getPacketType());
+         if ( ! kept )
+         {
+            std::cerr << "Slave on port " << status[i].node->getPort()
+                      << " lost its end block" << std::endl;
+            ++failures;
+         }
+      }
+
+      if ( status[i].connected != expected[i] ||
+           status[i].connected != status[i].node->isConnected() )
+      {
+         std::cerr << "Slave on port " << status[i].node->getPort()
+                   << (status[i].connected ? " connected" : " not connected")
+                   << " after " << status[i].attempts << " attempt(s): "
+                   << status[i].error << std::endl;
+         ++failures;
+      }
+      else if ( maxTime < status[i].time )
+      {
+         std::cerr << "Slave on port " << status[i].node->getPort()
+                   << " took " << status[i].time.msec() << " ms"
+                   << std::endl;
+         ++failures;
+      }
+   }
+
+   if ( status.size() != slaves.size() ||
+        all_connected != (std::count(expected.begin(), expected.end(), true) ==
+                             static_cast<int>(expected.size())) )
+   {
+      std::cerr << "Wrong overall result" << std::endl;
+      ++failures;
+   }
+
+   // Closing the master side lets the slaves finish.
+   network.shutdown();
+
+   for ( unsigned int i = 0; i < slaves.size(); ++i )
+   {
+      slaves[i]->join();
+   }
+
+   return failures;
+}
+
+void destroy(slave_list_t& slaves)
+{
+   for ( unsigned int i = 0; i < slaves.size(); ++i )
+   {
+      delete slaves[i];
+   }
+   slaves.clear();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   unsigned int slave_count(24);
+   vpr::Uint32 max_delay(1000);
+   unsigned int timeout_sec(10);
+   unsigned int dead_timeout_sec(2);
+   vpr::Uint16 port(17400);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         slave_count = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-d") == 0 )
+      {
+         max_delay = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-t") == 0 )
+      {
+         timeout_sec = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-k") == 0 )
+      {
+         dead_timeout_sec = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-p") == 0 )
+      {
+         port = std::atoi(argv[i + 1]);
+      }
+   }
+
+   if ( max_delay == 0 )
+   {
+      max_delay = 1;
+   }
+
+   unsigned int failures(0);
+   slave_list_t slaves;
+   std::vector<bool> expected;
+   vpr::Uint32 slowest(0);
+   vpr::Uint64 total_delay(0);
+
+   // The delays are spread over [0, max_delay) for listening and half of
+   // that for answering, in an order that does not follow the ports.
+   for ( unsigned int i = 0; i < slave_count; ++i )
+   {
+      const vpr::Uint32 listen_delay((i * 7919) % max_delay);
+      const vpr::Uint32 answer_delay(((i * 104729) % max_delay) / 2);
+      slaves.push_back(new FakeSlave(port++, FakeSlave::NEGOTIATING,
+                                     listen_delay, answer_delay));
+      expected.push_back(true);
+      slowest = std::max(slowest, slaves.back()->getDelay());
+      total_delay += slaves.back()->getDelay();
+   }
+
+   const vpr::Interval timeout(timeout_sec, vpr::Interval::Sec);
+   vpr::Interval max_time(slowest + SLACK_MSEC, vpr::Interval::Msec);
+   vpr::Interval elapsed;
+
+   failures += connectSlaves(slaves, expected, timeout, max_time, elapsed);
+
+   std::cout << slave_count << " slaves, slowest " << slowest
+             << " ms, delays add up to " << total_delay << " ms: connected in "
+             << elapsed.msec() << " ms" << std::endl;
+
+   if ( max_time < elapsed )
+   {
+      std::cerr << "FAILED: connecting took longer than the slowest slave"
+                << std::endl;
+      ++failures;
+   }
+
+   destroy(slaves);
+   expected.clear();
+
+   // A slave that never listens and two old ones next to two that answer
+   // right away.
+   slaves.push_back(new FakeSlave(port++, FakeSlave::NEGOTIATING));
+   slaves.push_back(new FakeSlave(port++, FakeSlave::DEAD));
+   slaves.push_back(new FakeSlave(port++, FakeSlave::OLD));
+   slaves.push_back(new FakeSlave(port++, FakeSlave::OLD_QUIET));
+   slaves.push_back(new FakeSlave(port++, FakeSlave::NEGOTIATING));
+   expected.push_back(true);
+   expected.push_back(false);
+   expected.push_back(true);
+   expected.push_back(true);
+   expected.push_back(true);
+
+   const vpr::Interval dead_timeout(dead_timeout_sec, vpr::Interval::Sec);
+   max_time.set(dead_timeout.msec() + SLACK_MSEC, vpr::Interval::Msec);
+
+   failures += connectSlaves(slaves, expected, dead_timeout, max_time, elapsed);
+
+   std::cout << "1 dead slave, " << dead_timeout.msec() << " ms timeout: "
+             << "gave up in " << elapsed.msec() << " ms" << std::endl;
+
+   if ( max_time < elapsed )
+   {
+      std::cerr << "FAILED: the deadline was not kept" << std::endl;
+      ++failures;
+   }
+
+   destroy(slaves);
+
+   if ( failures > 0 )
+   {
+      std::cerr << "FAILED: " << failures << " problem(s)" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,518 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Loopback test of the fused cluster synchronization.  A master and a few
+ * slave gadget::NetworkManager instances run in threads of this process and
+ * go through the exchanges that cluster::ClusterManager::exchange() makes
+ * for a plugin that sends data in preDraw() and postPostFrame(), with the
+ * software swap lock off.  Every node sends a numbered packet to the others
+ * in each exchange.
+ *
+ * With fused synchronization, the master must wait for the slaves once per
+ * frame, in postPostFrame().  Each slave holds back its preDraw() end block
+ * until the master has finished its preDraw() exchange of the same frame,
+ * so a master that waits there stalls the slave until it gives up.  After
+ * every exchange in which a node waited, it must have the packets that the
+ * others sent in that exchange, and the packets from each node must arrive
+ * in the order in which they were sent.  An end block that the master did
+ * not wait for and that is taken for the next one shows up as a packet
+ * from the previous exchange.
+ *
+ * Before each exchange, every node sleeps for a random time of up to the
+ * given work time, as the plugins and the application would take a
+ * different time on each node.  The frames are then timed with and without
+ * fused synchronization, and the average frame time on the master is
+ * printed for both.
+ *
+ * Usage: clusterSyncTest [-n slaves] [-f frames] [-b timed frames]
+ *                        [-w work usec] [-p base port]
+ *
+ * The exit status is non-zero if a node waits when it should not, misses
+ * data it should have, or receives packets out of order.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <vpr/vpr.h>
+#include <vpr/IO/ObjectReader.h>
+#include <vpr/IO/ObjectWriter.h>
+#include <vpr/IO/SerializableObject.h>
+#include <vpr/Sync/CondVar.h>
+#include <vpr/System.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/GUID.h>
+#include <vpr/Util/Interval.h>
+
+#include <cluster/ClusterException.h>
+#include <cluster/Packets/DataPacket.h>
+#include <gadget/NetworkManager.h>
+#include <gadget/Node.h>
+#include <gadget/PacketHandler.h>
+
+
+namespace
+{
+
+/** The exchanges of a frame, in order. */
+enum Phase
+{
+   PRE_DRAW = 0,
+   POST_POST_FRAME,
+   NUM_PHASES
+};
+
+/** The end block values that cluster::ClusterManager uses. */
+const int PHASE_TEMP[NUM_PHASES] = { 2, 3 };
+
+/** How long a slave waits for the master before it reports a stall. */
+const vpr::Interval STALL_TIMEOUT(2, vpr::Interval::Sec);
+
+/** The payload of the packet that each node sends in every exchange. */
+struct FrameStamp : public vpr::SerializableObject
+{
+   FrameStamp(const vpr::Uint32 frameNum = 0, const vpr::Uint8 phaseNum = 0)
+      : frame(frameNum)
+      , phase(phaseNum)
+   {;}
+
+   virtual void writeObject(vpr::ObjectWriter* writer)
+   {
+      writer->writeUint32(frame);
+      writer->writeUint8(phase);
+   }
+
+   virtual void readObject(vpr::ObjectReader* reader)
+   {
+      frame = reader->readUint32();
+      phase = reader->readUint8();
+   }
+
+   /** Returns the stamp of the exchange after this one. */
+   FrameStamp next() const
+   {
+      return phase + 1 < NUM_PHASES ? FrameStamp(frame, phase + 1)
+                                    : FrameStamp(frame + 1, 0);
+   }
+
+   bool operator==(const FrameStamp& other) const
+   {
+      return frame == other.frame && phase == other.phase;
+   }
+
+   vpr::Uint32 frame;
+   vpr::Uint8  phase;
+};
+
+/** Records the last stamp received from each node. */
+class FrameLog : public gadget::PacketHandler
+{
+public:
+   FrameLog()
+      : mOutOfOrder(0)
+   {;}
+
+   static const vpr::GUID& getGUID()
+   {
+      static const vpr::GUID guid("8d3f5a1e-7c62-4b09-a4e1-2f6b9c0d5e73");
+      return guid;
+   }
+
+   virtual vpr::GUID getHandlerGUID()
+   {
+      return getGUID();
+   }
+
+   virtual std::string getHandlerName()
+   {
+      return std::string("Frame Log");
+   }
+
+   virtual void handlePacket(cluster::PacketPtr packet, gadget::NodePtr node)
+   {
+      FrameStamp stamp;
+      stamp.readObject(packet->getPacketReader());
+
+      std::map<gadget::Node*, FrameStamp>::iterator last =
+         mLast.find(node.get());
+      const FrameStamp expected(mLast.end() != last ? last->second.next()
+                                                    : FrameStamp());
+
+      if ( ! (stamp == expected) )
+      {
+         std::cerr << "Packet " << stamp.frame << "." << int(stamp.phase)
+                   << " from " << node->getName() << " instead of "
+                   << expected.frame << "." << int(expected.phase)
+                   << std::endl;
+         ++mOutOfOrder;
+      }
+
+      mLast[node.get()] = stamp;
+   }
+
+   virtual void recoverFromLostNode(gadget::NodePtr)
+   {;}
+
+   /** Returns true if the last stamp from \p node is \p stamp. */
+   bool isCurrent(const gadget::NodePtr& node, const FrameStamp& stamp) const
+   {
+      std::map<gadget::Node*, FrameStamp>::const_iterator last =
+         mLast.find(node.get());
+      return mLast.end() != last && last->second == stamp;
+   }
+
+   unsigned int getOutOfOrder() const
+   {
+      return mOutOfOrder;
+   }
+
+private:
+   std::map<gadget::Node*, FrameStamp> mLast;
+   unsigned int                        mOutOfOrder;
+};
+
+/** The number of frames whose preDraw() exchange the master has finished. */
+class MasterProgress
+{
+public:
+   MasterProgress()
+      : mPreDrawDone(0)
+   {;}
+
+   void setPreDrawDone(const vpr::Uint32 frame)
+   {
+      mCond.acquire();
+      mPreDrawDone = frame + 1;
+      mCond.broadcast();
+      mCond.release();
+   }
+
+   /**
+    * Waits until the master has finished the preDraw() exchange of
+    * \p frame.  Returns false if that takes longer than \p timeout.
+    */
+   bool waitForPreDraw(const vpr::Uint32 frame, const vpr::Interval& timeout)
+   {
+      const vpr::Interval deadline(vpr::Interval::now() + timeout);
+      bool done(true);
+
+      mCond.acquire();
+      while ( mPreDrawDone <= frame && done )
+      {
+         const vpr::Interval now(vpr::Interval::now());
+         done = now < deadline && mCond.wait(deadline - now);
+      }
+      done = mPreDrawDone > frame;
+      mCond.release();
+
+      return done;
+   }
+
+private:
+   vpr::CondVar mCond;
+   vpr::Uint32  mPreDrawDone;
+};
+
+/**
+ * Makes the network calls of cluster::ClusterManager::exchange().  The
+ * master does not wait in preDraw() because no plugin needs the slaves'
+ * data there.
+ */
+void exchange(gadget::NetworkManager& network, const bool master,
+              const bool fused, const Phase phase)
+{
+   if ( ! fused || ! master || POST_POST_FRAME == phase )
+   {
+      network.update(PHASE_TEMP[phase]);
+   }
+   else
+   {
+      network.sendUpdate(PHASE_TEMP[phase]);
+   }
+}
+
+/**
+ * Runs \p frames frames on one node, working for up to \p work
+ * microseconds before each exchange.  If \p progress is not NULL, the
+ * master reports to it and the slaves check against it that the master did
+ * not wait for them in preDraw().  Returns the number of failures.
+ */
+unsigned int runFrames(gadget::NetworkManager& network, const FrameLog& log,
+                       const bool master, const bool fused,
+                       const vpr::Uint32 frames, const vpr::Uint32 work,
+                       vpr::Uint32 seed, MasterProgress* progress)
+{
+   gadget::NetworkManager::node_list_t& nodes = network.getNodes();
+   unsigned int failures(0);
+
+   try
+   {
+      for ( vpr::Uint32 frame = 0; frame < frames; ++frame )
+      {
+         for ( int p = 0; p < NUM_PHASES; ++p )
+         {
+            const Phase phase = static_cast<Phase>(p);
+            FrameStamp stamp(frame, phase);
+
+            if ( work > 0 )
+            {
+               seed = seed * 1103515245 + 12345;
+               vpr::System::usleep((seed >> 16) % work);
+            }
+
+            if ( NULL != progress && fused && ! master && PRE_DRAW == phase &&
+                 ! progress->waitForPreDraw(frame, STALL_TIMEOUT) )
+            {
+               std::cerr << "The master waited for the slaves in preDraw() "
+                         << "of frame " << frame << std::endl;
+               ++failures;
+            }
+
+            network.corkNetwork();
+
+            for ( unsigned int i = 0; i < nodes.size(); ++i )
+            {
+               cluster::DataPacketPtr packet =
+                  cluster::DataPacket::create(FrameLog::getGUID(),
+                                              FrameLog::getGUID());
+               packet->serialize(stamp);
+               nodes[i]->send(packet);
+            }
+
+            exchange(network, master, fused, phase);
+
+            if ( NULL != progress && master && PRE_DRAW == phase )
+            {
+               progress->setPreDrawDone(frame);
+            }
+
+            // A node that waited has the data sent by the others in this
+            // exchange.
+            if ( ! fused || ! master || POST_POST_FRAME == phase )
+            {
+               for ( unsigned int i = 0; i < nodes.size(); ++i )
+               {
+                  if ( ! log.isCurrent(nodes[i], stamp) )
+                  {
+                     std::cerr << (master ? "Master" : "Slave")
+                               << " lacks the data of " << nodes[i]->getName()
+                               << " after exchange " << frame << "."
+                               << int(phase) << std::endl;
+                     ++failures;
+                  }
+               }
+            }
+         }
+      }
+   }
+   catch (cluster::ClusterException& ex)
+   {
+      std::cerr << ex.what() << std::endl;
+      ++failures;
+   }
+
+   return failures + log.getOutOfOrder();
+}
+
+/** A slave node that runs its frames in a thread. */
+class Slave
+{
+public:
+   Slave(const vpr::Uint16 port, const bool fused, const vpr::Uint32 frames,
+         const vpr::Uint32 work, MasterProgress* progress)
+      : mPort(port)
+      , mFused(fused)
+      , mFrames(frames)
+      , mWork(work)
+      , mProgress(progress)
+      , mFailures(0)
+      , mThread(new vpr::Thread(boost::bind(&Slave::run, this)))
+   {
+   }
+
+   ~Slave()
+   {
+      join();
+   }
+
+   void join()
+   {
+      if ( NULL != mThread )
+      {
+         mThread->join();
+         delete mThread;
+         mThread = NULL;
+      }
+   }
+
+   unsigned int getFailures() const
+   {
+      return mFailures;
+   }
+
+private:
+   void run()
+   {
+      gadget::NetworkManager network;
+      boost::shared_ptr<FrameLog> log(new FrameLog());
+      network.addHandler(log);
+      network.waitForConnection(mPort);
+
+      mFailures = runFrames(network, *log, false, mFused, mFrames, mWork,
+                            mPort, mProgress);
+      network.shutdown();
+   }
+
+   const vpr::Uint16    mPort;
+   const bool           mFused;
+   const vpr::Uint32    mFrames;
+   const vpr::Uint32    mWork;
+   MasterProgress*      mProgress;
+   unsigned int         mFailures;
+   vpr::Thread*         mThread;
+};
+
+/**
+ * Runs \p frames frames on a master and \p slaveCount slaves listening on
+ * the ports from \p port up.  Returns the number of failures and sets
+ * \p frameTime to the average frame time on the master.
+ */
+unsigned int runCluster(const unsigned int slaveCount, vpr::Uint16& port,
+                        const bool fused, const vpr::Uint32 frames,
+                        const vpr::Uint32 work, const bool checkWaits,
+                        vpr::Interval& frameTime)
+{
+   MasterProgress progress;
+   MasterProgress* checked_progress(checkWaits ? &progress : NULL);
+   gadget::NetworkManager network;
+   boost::shared_ptr<FrameLog> log(new FrameLog());
+   network.addHandler(log);
+
+   std::vector<Slave*> slaves;
+   for ( unsigned int i = 0; i < slaveCount; ++i, ++port )
+   {
+      network.addNode("slave", "localhost", port);
+      slaves.push_back(new Slave(port, fused, frames, work,
+                                 checked_progress));
+   }
+
+   unsigned int failures(0);
+
+   if ( network.connectToSlaves(vpr::Interval(10, vpr::Interval::Sec)) )
+   {
+      const vpr::Interval start(vpr::Interval::now());
+      failures += runFrames(network, *log, true, fused, frames, work, 0,
+                            checked_progress);
+      frameTime.set((vpr::Interval::now() - start).usec() /
+                       (frames > 0 ? frames : 1),
+                    vpr::Interval::Usec);
+   }
+   else
+   {
+      std::cerr << "Could not connect to the slaves" << std::endl;
+      ++failures;
+   }
+
+   network.shutdown();
+
+   for ( unsigned int i = 0; i < slaves.size(); ++i )
+   {
+      slaves[i]->join();
+      failures += slaves[i]->getFailures();
+      delete slaves[i];
+   }
+
+   return failures;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   unsigned int slave_count(3);
+   vpr::Uint32 frames(200);
+   vpr::Uint32 timed_frames(1000);
+   vpr::Uint32 work(1000);
+   vpr::Uint16 port(17600);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         slave_count = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-f") == 0 )
+      {
+         frames = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-b") == 0 )
+      {
+         timed_frames = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-w") == 0 )
+      {
+         work = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-p") == 0 )
+      {
+         port = std::atoi(argv[i + 1]);
+      }
+   }
+
+   unsigned int failures(0);
+   vpr::Interval frame_time;
+
+   failures += runCluster(slave_count, port, true, frames, work, true,
+                          frame_time);
+
+   std::cout << slave_count << " slaves, " << frames << " fused frames "
+             << "checked" << std::endl;
+
+   vpr::Interval unfused_time;
+   vpr::Interval fused_time;
+   failures += runCluster(slave_count, port, false, timed_frames, work, false,
+                          unfused_time);
+   failures += runCluster(slave_count, port, true, timed_frames, work, false,
+                          fused_time);
+
+   std::cout << "Frame time over " << timed_frames << " frames with up to "
+             << work << " us of work per exchange: "
+             << unfused_time.usec() << " us unfused, "
+             << fused_time.usec() << " us fused" << std::endl;
+
+   if ( failures > 0 )
+   {
+      std::cerr << "FAILED: " << failures << " problem(s)" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,404 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+/*
+ * Throughput benchmark for the DTrack ASCII parser (DTrackStandalone).
+ * Recorded DTrack packets are replayed straight into the parser, without
+ * going through the network, and the time spent per packet is reported.
+ *
+ * Usage: dtrackParseBench [-f recording] [-n frames] [-b bodies]
+ *                         [-i iterations] [-d dumpfile] [-p port]
+ *
+ * A recording is a text file of DTrack packets separated by blank lines, as
+ * used by ioReactorLatency.  Without one, packets holding the given number
+ * of standard bodies plus Flysticks, a measurement tool, two hands and some
+ * single markers are generated.
+ *
+ * With -d, everything the parser extracted from each packet is written to
+ * the named file.  Dumps written by two builds of the driver can be compared
+ * with diff to check that a parser change does not alter the output.
+ *
+ * The port is only used to create the DTrackStandalone object; no data is
+ * received on it.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <vpr/vpr.h>
+#include <vpr/Util/Interval.h>
+
+#include <DTrackStandalone.h>
+
+
+namespace
+{
+
+std::vector<std::string> loadRecording(const std::string& fileName)
+{
+   std::vector<std::string> frames;
+   std::ifstream in(fileName.c_str());
+   std::string line, frame;
+
+   while ( std::getline(in, line) )
+   {
+      if ( line.empty() || line == "\r" )
+      {
+         if ( ! frame.empty() )
+         {
+            frames.push_back(frame);
+            frame.clear();
+         }
+      }
+      else
+      {
+         frame += line + "\n";
+      }
+   }
+
+   if ( ! frame.empty() )
+   {
+      frames.push_back(frame);
+   }
+
+   return frames;
+}
+
+/** Small deterministic generator so that every run parses the same data. */
+class Values
+{
+public:
+   Values()
+      : mState(12345)
+   {
+   }
+
+   /** Returns a value in [lo,hi). */
+   double next(const double lo, const double hi)
+   {
+      mState = mState * 1103515245u + 12345u;
+      return lo + (hi - lo) * ((mState >> 8) & 0xffffff) / 16777216.0;
+   }
+
+private:
+   vpr::Uint32 mState;
+};
+
+void writeLoc(std::ostream& out, Values& values)
+{
+   out << "[" << values.next(-2000.0, 2000.0) << " "
+       << values.next(-2000.0, 2000.0) << " " << values.next(0.0, 2500.0)
+       << "]";
+}
+
+void writeRot(std::ostream& out, Values& values)
+{
+   out << "[" << std::setprecision(6);
+   for ( int i = 0; i < 9; ++i )
+   {
+      out << (i > 0 ? " " : "") << values.next(-1.0, 1.0);
+   }
+   out << "]" << std::setprecision(3);
+}
+
+std::vector<std::string> makeFrames(const unsigned int count,
+                                    const unsigned int bodies)
+{
+   std::vector<std::string> frames;
+   Values values;
+
+   for ( unsigned int i = 0; i < count; ++i )
+   {
+      std::ostringstream frame;
+      frame << std::fixed << std::setprecision(3);
+
+      frame << "fr " << 1000 + i << "\r\n"
+            << "ts " << std::setprecision(6) << 36000.0 + i / 300.0
+            << std::setprecision(3) << "\r\n"
+            << "6dcal " << bodies + 3 << "\r\n";
+
+      frame << "6d " << bodies;
+      for ( unsigned int b = 0; b < bodies; ++b )
+      {
+         frame << " [" << b << " " << values.next(0.5, 1.0) << "]";
+         writeLoc(frame, values);
+         writeRot(frame, values);
+      }
+      frame << "\r\n";
+
+      frame << "6df2 2 2";
+      for ( unsigned int f = 0; f < 2; ++f )
+      {
+         frame << " [" << f << " " << values.next(0.5, 1.0) << " 6 2]";
+         writeLoc(frame, values);
+         writeRot(frame, values);
+         frame << "[" << (i + f) % 64 << " " << values.next(-1.0, 1.0) << " "
+               << values.next(-1.0, 1.0) << "]";
+      }
+      frame << "\r\n";
+
+      frame << "6dmt2 1 1 [0 " << values.next(0.5, 1.0) << " 2 "
+            << values.next(1.0, 5.0) << "]";
+      writeLoc(frame, values);
+      writeRot(frame, values);
+      frame << "[" << i % 4 << "][";
+      for ( int c = 0; c < 6; ++c )
+      {
+         frame << (c > 0 ? " " : "") << values.next(0.0, 0.1);
+      }
+      frame << "]\r\n";
+
+      frame << "glcal 2\r\n"
+            << "gl 2";
+      for ( unsigned int h = 0; h < 2; ++h )
+      {
+         frame << " [" << h << " " << values.next(0.5, 1.0) << " " << h
+               << " 5]";
+         writeLoc(frame, values);
+         writeRot(frame, values);
+         for ( int f = 0; f < 5; ++f )
+         {
+            frame << " ";
+            writeLoc(frame, values);
+            writeRot(frame, values);
+            frame << "[";
+            for ( int p = 0; p < 6; ++p )
+            {
+               frame << (p > 0 ? " " : "") << values.next(5.0, 50.0);
+            }
+            frame << "]";
+         }
+      }
+      frame << "\r\n";
+
+      frame << "3d 8";
+      for ( unsigned int m = 0; m < 8; ++m )
+      {
+         frame << " [" << m + 1 << " " << values.next(0.5, 1.0) << "]";
+         writeLoc(frame, values);
+      }
+      frame << "\r\n";
+
+      frames.push_back(frame.str());
+   }
+
+   return frames;
+}
+
+template<typename T>
+void dumpArray(std::ostream& out, const T* values, const int count)
+{
+   for ( int i = 0; i < count; ++i )
+   {
+      out << " " << values[i];
+   }
+}
+
+/** Writes everything the parser extracted from the last packet. */
+void dump(std::ostream& out, DTrackStandalone& dtrack)
+{
+   const std::streamsize precision(out.precision(17));
+   out << "fr " << dtrack.get_framecounter() << " ts "
+       << dtrack.get_timestamp() << "\n";
+   out.precision(precision);
+
+   for ( int i = 0; i < dtrack.get_num_body(); ++i )
+   {
+      const dtrack_body_type body = dtrack.get_body(i);
+      out << "body " << body.id << " " << body.quality;
+      dumpArray(out, body.loc, 3);
+      dumpArray(out, body.rot, 9);
+      out << "\n";
+   }
+
+   for ( int i = 0; i < dtrack.get_num_flystick(); ++i )
+   {
+      const dtrack_flystick_type fs = dtrack.get_flystick(i);
+      out << "flystick " << fs.id << " " << fs.quality << " "
+          << fs.num_button << " " << fs.num_joystick;
+      dumpArray(out, fs.button, fs.num_button);
+      dumpArray(out, fs.joystick, fs.num_joystick);
+      dumpArray(out, fs.loc, 3);
+      dumpArray(out, fs.rot, 9);
+      out << "\n";
+   }
+
+   for ( int i = 0; i < dtrack.get_num_meatool(); ++i )
+   {
+      const dtrack_meatool_type mt = dtrack.get_meatool(i);
+      out << "meatool " << mt.id << " " << mt.quality << " "
+          << mt.num_button << " " << mt.tipradius;
+      dumpArray(out, mt.button, DTRACK_MEATOOL_MAX_BUTTON);
+      dumpArray(out, mt.loc, 3);
+      dumpArray(out, mt.rot, 9);
+      dumpArray(out, mt.cov, 6);
+      out << "\n";
+   }
+
+   for ( int i = 0; i < dtrack.get_num_hand(); ++i )
+   {
+      const dtrack_hand_type hand = dtrack.get_hand(i);
+      out << "hand " << hand.id << " " << hand.quality << " " << hand.lr
+          << " " << hand.nfinger;
+      dumpArray(out, hand.loc, 3);
+      dumpArray(out, hand.rot, 9);
+      for ( int f = 0; f < hand.nfinger; ++f )
+      {
+         dumpArray(out, hand.finger[f].loc, 3);
+         dumpArray(out, hand.finger[f].rot, 9);
+         out << " " << hand.finger[f].radiustip;
+         dumpArray(out, hand.finger[f].lengthphalanx, 3);
+         dumpArray(out, hand.finger[f].anglephalanx, 2);
+      }
+      out << "\n";
+   }
+
+   for ( int i = 0; i < dtrack.get_num_marker(); ++i )
+   {
+      const dtrack_marker_type marker = dtrack.get_marker(i);
+      out << "marker " << marker.id << " " << marker.quality;
+      dumpArray(out, marker.loc, 3);
+      out << "\n";
+   }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   std::string recording;
+   std::string dump_file;
+   unsigned int count(300);
+   unsigned int bodies(24);
+   unsigned int iterations(100);
+   int port(15124);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-f") == 0 )
+      {
+         recording = argv[i + 1];
+      }
+      else if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         count = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-b") == 0 )
+      {
+         bodies = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-i") == 0 )
+      {
+         iterations = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-d") == 0 )
+      {
+         dump_file = argv[i + 1];
+      }
+      else if ( std::strcmp(argv[i], "-p") == 0 )
+      {
+         port = std::atoi(argv[i + 1]);
+      }
+   }
+
+   const std::vector<std::string> frames =
+      recording.empty() ? makeFrames(count, bodies) : loadRecording(recording);
+
+   if ( frames.empty() || iterations == 0 )
+   {
+      std::cerr << "Nothing to parse" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   std::size_t max_size(0);
+   for ( std::size_t i = 0; i < frames.size(); ++i )
+   {
+      max_size = std::max(max_size, frames[i].size());
+   }
+
+   DTrackStandalone dtrack(port, NULL, 0, static_cast<int>(max_size) + 1);
+
+   if ( ! dtrack.valid() )
+   {
+      std::cerr << "Could not create the DTrack object on port " << port
+                << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   // Check every packet once (and dump it if requested) before timing.
+   std::ofstream dump_out;
+   if ( ! dump_file.empty() )
+   {
+      dump_out.open(dump_file.c_str());
+      dump_out << std::setprecision(9);
+   }
+
+   std::size_t bytes(0);
+   for ( std::size_t i = 0; i < frames.size(); ++i )
+   {
+      if ( ! dtrack.process(frames[i].c_str(),
+                            static_cast<int>(frames[i].size())) )
+      {
+         std::cerr << "Packet " << i << " could not be parsed" << std::endl;
+         return EXIT_FAILURE;
+      }
+
+      if ( dump_out.is_open() )
+      {
+         dump(dump_out, dtrack);
+      }
+
+      bytes += frames[i].size();
+   }
+
+   const vpr::Interval start(vpr::Interval::now());
+
+   for ( unsigned int n = 0; n < iterations; ++n )
+   {
+      for ( std::size_t i = 0; i < frames.size(); ++i )
+      {
+         dtrack.process(frames[i].c_str(), static_cast<int>(frames[i].size()));
+      }
+   }
+
+   const double usec((vpr::Interval::now() - start).usecf());
+   const double packets(static_cast<double>(frames.size()) * iterations);
+
+   std::cout << frames.size() << " packets, " << bytes / frames.size()
+             << " bytes on average, " << iterations << " iterations\n"
+             << "parse time: " << usec / packets << " us per packet, "
+             << bytes * iterations / usec << " MB/s" << std::endl;
+
+   return EXIT_SUCCESS;
+}
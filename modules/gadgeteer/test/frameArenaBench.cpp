@@ -0,0 +1,357 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Benchmark for the frame arena on the cluster receive path.  Every frame,
+ * a number of data packets and an end block are "received" from a buffer
+ * the way gadget::Node::recvPacket() receives them from a socket: a header
+ * is created and parsed, cluster::PacketFactory creates the packet, the
+ * packet data is copied in and parsed, and the packet is dropped once it has
+ * been handled.  Between frames the application frees and allocates blocks
+ * of random sizes so that the heap is not left in a state that flatters
+ * malloc().
+ *
+ * The same frames are run twice, first with every object coming from the
+ * heap and then with a vpr::FrameArena that is reset at every frame boundary
+ * as vrj::Kernel::controlLoop() does.  For each run, the heap allocations
+ * per frame and the mean, standard deviation, 99th percentile and maximum
+ * frame time are reported, followed by the arena counters.  On a shared
+ * machine the maximum, and with it the standard deviation, is dominated by
+ * preemption, so the 99th percentile is the steadier measure of jitter.
+ *
+ * Usage: frameArenaBench [-n frames] [-p packets per frame]
+ *                        [-s payload bytes] [-c app blocks per frame]
+ *
+ * The exit status is non-zero if a received packet does not carry the data
+ * that was sent or if the arena run makes more heap allocations per frame
+ * than the heap run.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <vpr/vpr.h>
+#include <vpr/IO/SerializableObject.h>
+#include <vpr/Util/FrameArena.h>
+#include <vpr/Util/GUID.h>
+#include <vpr/Util/Interval.h>
+
+#include <cluster/Packets/DataPacket.h>
+#include <cluster/Packets/EndBlock.h>
+#include <cluster/Packets/Header.h>
+#include <cluster/Packets/PacketFactory.h>
+#include <cluster/Packets/PacketPtr.h>
+
+#include "ClusterTestUtil.h"
+
+
+namespace
+{
+
+/** Stands in for the device data that a RIM data packet carries. */
+class Payload : public vpr::SerializableObject
+{
+public:
+   explicit Payload(const unsigned int size)
+      : mBytes(size)
+   {
+      for ( unsigned int i = 0; i < size; ++i )
+      {
+         mBytes[i] = static_cast<vpr::Uint8>(i * 7);
+      }
+   }
+
+   virtual void writeObject(vpr::ObjectWriter* writer)
+   {
+      for ( unsigned int i = 0; i < mBytes.size(); ++i )
+      {
+         writer->writeUint8(mBytes[i]);
+      }
+   }
+
+   virtual void readObject(vpr::ObjectReader* reader)
+   {
+      for ( unsigned int i = 0; i < mBytes.size(); ++i )
+      {
+         mBytes[i] = reader->readUint8();
+      }
+   }
+
+private:
+   std::vector<vpr::Uint8> mBytes;
+};
+
+/** Copies a packet as it would appear on the wire. */
+std::vector<vpr::Uint8> wireBytes(cluster::Packet& packet)
+{
+   const std::vector<vpr::Uint8>& data = packet.getData();
+   return std::vector<vpr::Uint8>(
+      data.begin(), data.begin() + packet.getHeader()->getPacketLength()
+   );
+}
+
+/**
+ * Receives one packet from \p wire with the same steps as
+ * gadget::Node::recvPacket().  Returns the type of the packet received.
+ */
+vpr::Uint16 receive(const std::vector<vpr::Uint8>& wire,
+                    const vpr::GUID& pluginId)
+{
+   vpr::FrameArena::Scope frame_scope;
+
+   cluster::HeaderPtr head = cluster::Header::create();
+   head->readData(&wire[0]);
+
+   cluster::PacketPtr packet =
+      cluster::PacketFactory::instance()->createObject(head->getPacketType());
+   packet->setHeader(head);
+
+   std::vector<vpr::Uint8>& data = packet->getData();
+   data.assign(wire.begin() + cluster::Header::RIM_PACKET_HEAD_SIZE,
+               wire.end());
+   packet->parse();
+
+   // Handling a data packet only looks at the plug-in ID before the data is
+   // read by the plug-in.
+   if ( head->getPacketType() == cluster::Header::RIM_DATA_PACKET &&
+        packet->getPluginId() != pluginId )
+   {
+      return 0;
+   }
+
+   return head->getPacketType();
+}
+
+/** The memory that the rest of the application allocates every frame. */
+class AppChurn
+{
+public:
+   explicit AppChurn(const unsigned int blocks)
+      : mBlocks(blocks * 8, static_cast<char*>(NULL))
+      , mNext(0)
+      , mPerFrame(blocks)
+      , mSeed(12345)
+   {
+   }
+
+   ~AppChurn()
+   {
+      for ( unsigned int i = 0; i < mBlocks.size(); ++i )
+      {
+         delete [] mBlocks[i];
+      }
+   }
+
+   void frame()
+   {
+      for ( unsigned int i = 0; i < mPerFrame; ++i )
+      {
+         mSeed = mSeed * 1103515245 + 12345;
+         delete [] mBlocks[mNext];
+         mBlocks[mNext] = new char[16 + (mSeed >> 16) % 2048];
+         mNext = (mNext + 1) % mBlocks.size();
+      }
+   }
+
+private:
+   std::vector<char*> mBlocks;
+   unsigned int       mNext;
+   unsigned int       mPerFrame;
+   unsigned int       mSeed;
+};
+
+struct RunResult
+{
+   double allocsPerFrame;
+   double meanUsec;
+   double stddevUsec;
+   double p99Usec;
+   double maxUsec;
+   unsigned int badPackets;
+};
+
+RunResult run(const unsigned int frames, const unsigned int packets,
+              const std::vector<vpr::Uint8>& dataWire,
+              const std::vector<vpr::Uint8>& endWire,
+              const vpr::GUID& pluginId, const unsigned int churnBlocks,
+              vpr::FrameArena* arena)
+{
+   AppChurn churn(churnBlocks);
+   vpr::FrameArena::setCurrent(arena);
+
+   RunResult result = { 0.0, 0.0, 0.0, 0.0, 0.0, 0 };
+   double sum(0.0), sum_sq(0.0);
+   unsigned long allocations(0);
+   std::vector<double> times;
+   times.reserve(frames);
+
+   // Frame 0 warms up the factory, the heap, and the arena.
+   for ( unsigned int f = 0; f <= frames; ++f )
+   {
+      churn.frame();
+
+      const unsigned long before(getAllocationCount());
+      const vpr::Interval start(vpr::Interval::now());
+
+      if ( NULL != arena )
+      {
+         arena->reset();
+      }
+
+      for ( unsigned int p = 0; p < packets; ++p )
+      {
+         result.badPackets +=
+            receive(dataWire, pluginId) != cluster::Header::RIM_DATA_PACKET;
+      }
+      result.badPackets +=
+         receive(endWire, pluginId) != cluster::Header::RIM_END_BLOCK;
+
+      const double usec =
+         static_cast<double>((vpr::Interval::now() - start).usec());
+
+      if ( f > 0 )
+      {
+         allocations += getAllocationCount() - before;
+         sum    += usec;
+         sum_sq += usec * usec;
+         times.push_back(usec);
+         if ( usec > result.maxUsec )
+         {
+            result.maxUsec = usec;
+         }
+      }
+   }
+
+   vpr::FrameArena::setCurrent(NULL);
+
+   if ( frames > 0 )
+   {
+      result.allocsPerFrame = static_cast<double>(allocations) / frames;
+      result.meanUsec       = sum / frames;
+      result.stddevUsec     =
+         std::sqrt(std::max(sum_sq / frames - result.meanUsec * result.meanUsec,
+                            0.0));
+
+      std::vector<double>::iterator p99 =
+         times.begin() + (times.size() - 1) * 99 / 100;
+      std::nth_element(times.begin(), p99, times.end());
+      result.p99Usec = *p99;
+   }
+
+   return result;
+}
+
+void print(const char* name, const RunResult& r)
+{
+   std::cout << std::setw(6) << name << ": " << std::fixed
+             << std::setprecision(1) << std::setw(7) << r.allocsPerFrame
+             << " heap allocations/frame, frame time mean "
+             << std::setprecision(1) << r.meanUsec << " us, stddev "
+             << r.stddevUsec << " us, p99 " << r.p99Usec << " us, max "
+             << r.maxUsec << " us"
+             << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   unsigned int frames(5000);
+   unsigned int packets(32);
+   unsigned int payload(64);
+   unsigned int churn(64);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         frames = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-p") == 0 )
+      {
+         packets = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-s") == 0 )
+      {
+         payload = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-c") == 0 )
+      {
+         churn = std::atoi(argv[i + 1]);
+      }
+   }
+
+   const vpr::GUID object_id("5d1e0a4c-8b1f-4c86-9d0e-7f2a3b6c1e90");
+
+   Payload data(payload);
+   cluster::DataPacketPtr data_packet =
+      createTestDataPacket(object_id);
+   data_packet->serialize(data);
+   const std::vector<vpr::Uint8> data_wire(wireBytes(*data_packet));
+
+   cluster::EndBlockPtr end_block = cluster::EndBlock::create(0);
+   const std::vector<vpr::Uint8> end_wire(wireBytes(*end_block));
+
+   std::cout << frames << " frames of " << packets << " data packets ("
+             << data_wire.size() << " bytes) and an end block" << std::endl;
+
+   const RunResult heap =
+      run(frames, packets, data_wire, end_wire, getTestPluginId(), churn, NULL);
+   print("heap", heap);
+
+   vpr::FrameArena arena;
+   const RunResult pooled =
+      run(frames, packets, data_wire, end_wire, getTestPluginId(), churn, &arena);
+   print("arena", pooled);
+
+   const vpr::FrameArena::Stats& stats = arena.getStats();
+   std::cout << "arena counters: " << stats.allocations << " allocations, "
+             << stats.bytes << " bytes, peak " << stats.peakBytes
+             << " bytes, " << stats.heapAllocations << " heap fallbacks, "
+             << stats.deferredResets << " deferred resets in "
+             << stats.frames << " frames" << std::endl;
+
+   if ( heap.badPackets + pooled.badPackets > 0 )
+   {
+      std::cerr << "FAILED: " << heap.badPackets + pooled.badPackets
+                << " packets were received wrong" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   if ( pooled.allocsPerFrame > heap.allocsPerFrame )
+   {
+      std::cerr << "FAILED: the arena did not save any allocations"
+                << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
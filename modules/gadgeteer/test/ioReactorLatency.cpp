@@ -0,0 +1,345 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+/*
+ * Latency benchmark for gadget::IOReactor.  A recorded tracker stream is
+ * replayed over UDP on the loopback interface at the recorded rate, and the
+ * time from each send to the point where the driver-side code sees the
+ * packet is measured.  Two receivers are compared:
+ *
+ *    reactor: the socket is registered with gadget::IOReactor.
+ *    poll:    a thread polls the socket and sleeps 1 ms when it is empty,
+ *             which is how the VRPN and TUIO drivers used to sample.
+ *
+ * Usage: ioReactorLatency [-f recording] [-r rate] [-n frames] [-p port]
+ *
+ * A recording is a text file of tracker packets (such as DTrack ASCII
+ * output) separated by blank lines.  Without one, DTrack-style frames are
+ * generated.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <vpr/vpr.h>
+#include <vpr/System.h>
+#include <vpr/IO/Socket/SocketDatagram.h>
+#include <vpr/IO/Socket/InetAddr.h>
+#include <vpr/IO/IOException.h>
+#include <vpr/Sync/Guard.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/Interval.h>
+
+#include <gadget/Util/IOReactor.h>
+
+#include "BenchTiming.h"
+
+
+namespace
+{
+
+std::vector<std::string> loadRecording(const std::string& fileName)
+{
+   std::vector<std::string> frames;
+   std::ifstream in(fileName.c_str());
+   std::string line, frame;
+
+   while ( std::getline(in, line) )
+   {
+      if ( line.empty() || line == "\r" )
+      {
+         if ( ! frame.empty() )
+         {
+            frames.push_back(frame);
+            frame.clear();
+         }
+      }
+      else
+      {
+         frame += line + "\n";
+      }
+   }
+
+   if ( ! frame.empty() )
+   {
+      frames.push_back(frame);
+   }
+
+   return frames;
+}
+
+std::vector<std::string> makeFrames(const unsigned int count)
+{
+   std::vector<std::string> frames;
+
+   for ( unsigned int i = 0; i < count; ++i )
+   {
+      std::ostringstream frame;
+      frame << "fr " << i << "\n"
+            << "ts " << i / 60.0 << "\n"
+            << "6dcal 2\n"
+            << "6d 2 [0 1.000][" << i % 100 << ".0 1520.3 -230.1 10.0 "
+            << "20.0 30.0][1 0 0 0 1 0 0 0 1] "
+            << "[1 1.000][-300.2 1412.7 " << i % 50 << ".0 0.0 0.0 0.0]"
+            << "[1 0 0 0 1 0 0 0 1]\n";
+      frames.push_back(frame.str());
+   }
+
+   return frames;
+}
+
+/** Receiving end shared by both modes. */
+class Receiver
+{
+public:
+   Receiver(vpr::SocketDatagram& socket, const std::size_t frames)
+      : mSocket(socket)
+      , mSendTimes(frames)
+      , mCount(0)
+      , mDone(false)
+   {
+      mLatencies.reserve(frames);
+   }
+
+   void setSendTime(const std::size_t frame, const vpr::Interval& time)
+   {
+      vpr::Guard<vpr::Mutex> g(mLock);
+      mSendTimes[frame] = time;
+   }
+
+   /** Reads one waiting packet.  Returns false if there was none. */
+   bool readPacket(const vpr::Interval& arrival)
+   {
+      vpr::InetAddr from;
+
+      try
+      {
+         mSocket.recvfrom(mBuffer, sizeof(mBuffer), from,
+                          vpr::Interval::NoWait);
+      }
+      catch (vpr::IOException&)
+      {
+         return false;
+      }
+
+      vpr::Guard<vpr::Mutex> g(mLock);
+      if ( mCount < mSendTimes.size() )
+      {
+         mLatencies.push_back((arrival - mSendTimes[mCount]).usecf());
+         ++mCount;
+      }
+
+      return true;
+   }
+
+   /** gadget::IOReactor callback. */
+   void onReadable(const vpr::Interval& arrival)
+   {
+      readPacket(arrival);
+   }
+
+   /** Thread body for the polling mode. */
+   void pollLoop()
+   {
+      while ( ! mDone )
+      {
+         if ( ! readPacket(vpr::Interval::now()) )
+         {
+            vpr::Thread::yield();
+            vpr::System::msleep(1);
+         }
+      }
+   }
+
+   void stop()
+   {
+      mDone = true;
+   }
+
+   std::size_t getCount()
+   {
+      vpr::Guard<vpr::Mutex> g(mLock);
+      return mCount;
+   }
+
+   std::vector<float> getLatencies()
+   {
+      vpr::Guard<vpr::Mutex> g(mLock);
+      return mLatencies;
+   }
+
+private:
+   vpr::SocketDatagram&       mSocket;
+   char                       mBuffer[65536];
+   vpr::Mutex                 mLock;
+   std::vector<vpr::Interval> mSendTimes;
+   std::vector<float>         mLatencies;
+   std::size_t                mCount;
+   volatile bool              mDone;
+};
+
+void replay(const std::vector<std::string>& frames, const float rate,
+            const vpr::InetAddr& to, Receiver& receiver)
+{
+   vpr::SocketDatagram sender;
+   sender.open();
+
+   const Pacer pacer(rate);
+
+   for ( std::size_t i = 0; i < frames.size(); ++i )
+   {
+      receiver.setSendTime(i, pacer.wait(i));
+      sender.sendto(frames[i].c_str(), frames[i].size(), to);
+   }
+
+   // Give the receiver a moment to catch up.
+   vpr::System::msleep(100);
+   sender.close();
+}
+
+void report(const std::string& mode, std::vector<float> latencies,
+            const std::size_t sent)
+{
+   std::cout << mode << ": " << latencies.size() << " of " << sent
+             << " packets received";
+
+   if ( ! latencies.empty() )
+   {
+      std::sort(latencies.begin(), latencies.end());
+
+      double sum(0.0);
+      for ( std::size_t i = 0; i < latencies.size(); ++i )
+      {
+         sum += latencies[i];
+      }
+
+      std::cout << ", latency (us): mean " << sum / latencies.size()
+                << ", median " << latencies[latencies.size() / 2]
+                << ", 99% " << latencies[latencies.size() * 99 / 100]
+                << ", max " << latencies.back();
+   }
+
+   std::cout << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   std::string recording;
+   float rate(60.0f);
+   unsigned int count(600);
+   vpr::Uint16 port(15123);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-f") == 0 )
+      {
+         recording = argv[i + 1];
+      }
+      else if ( std::strcmp(argv[i], "-r") == 0 )
+      {
+         rate = static_cast<float>(std::atof(argv[i + 1]));
+      }
+      else if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         count = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-p") == 0 )
+      {
+         port = static_cast<vpr::Uint16>(std::atoi(argv[i + 1]));
+      }
+   }
+
+   const std::vector<std::string> frames =
+      recording.empty() ? makeFrames(count) : loadRecording(recording);
+
+   if ( frames.empty() || rate <= 0.0f )
+   {
+      std::cerr << "Nothing to replay" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   vpr::InetAddr addr;
+   addr.setAddress("127.0.0.1", port);
+
+   try
+   {
+      // Receive with gadget::IOReactor.
+      {
+         vpr::SocketDatagram socket(addr, vpr::InetAddr::AnyAddr);
+         socket.open();
+         socket.bind();
+
+         Receiver receiver(socket, frames.size());
+         gadget::IOReactor::instance()->registerHandle(
+            socket.getHandle(),
+            boost::bind(&Receiver::onReadable, &receiver, _1)
+         );
+
+         replay(frames, rate, addr, receiver);
+
+         gadget::IOReactor::instance()->unregisterHandle(socket.getHandle());
+         socket.close();
+
+         report("reactor", receiver.getLatencies(), frames.size());
+      }
+
+      // Receive by polling and sleeping.
+      {
+         vpr::SocketDatagram socket(addr, vpr::InetAddr::AnyAddr);
+         socket.open();
+         socket.bind();
+
+         Receiver receiver(socket, frames.size());
+         vpr::Thread poll_thread(boost::bind(&Receiver::pollLoop, &receiver));
+
+         replay(frames, rate, addr, receiver);
+
+         receiver.stop();
+         poll_thread.join();
+         socket.close();
+
+         report("poll", receiver.getLatencies(), frames.size());
+      }
+   }
+   catch (vpr::Exception& ex)
+   {
+      std::cerr << "Benchmark failed: " << ex.what() << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
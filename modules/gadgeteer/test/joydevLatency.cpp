@@ -0,0 +1,353 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Benchmark for the ways the LinuxJoydev driver can read joystick events.
+ * A thread plays the kernel and writes bursts of js_event records into a
+ * pipe, which stands in for /dev/input/js*, at a fixed rate.  Two readers
+ * are compared:
+ *
+ *    reactor: the pipe is registered with gadget::IOReactor and all pending
+ *             events are read in batches as soon as they arrive.  Each one
+ *             is stamped with its kernel time mapped onto vpr::Interval.
+ *    frame:   once per frame, events are read one read(2) at a time until
+ *             none are left and stamped with the time of the read, which is
+ *             how LinuxJoydev::updateData() used to work.
+ *
+ * For each reader, the time from the write to the point where the event is
+ * in the sample buffers, the error of the time stamps, the number of
+ * read(2) calls and the CPU time spent reading are reported.
+ *
+ * Usage: joydevLatency [-r burst rate] [-b events per burst] [-f frame rate]
+ *                      [-n bursts]
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/joystick.h>
+
+#include <vpr/vpr.h>
+#include <vpr/System.h>
+#include <vpr/Sync/Guard.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/Interval.h>
+
+#include <gadget/Util/IOReactor.h>
+
+#include "BenchTiming.h"
+
+
+namespace
+{
+
+/** Returns the time in milliseconds the way the kernel stamps js_event. */
+vpr::Uint32 kernelTime(const vpr::Interval& time)
+{
+   return static_cast<vpr::Uint32>(time.msec());
+}
+
+class Reader
+{
+public:
+   Reader(const int fd, const std::size_t events)
+      : mFd(fd)
+      , mSendTimes(events)
+      , mCount(0)
+      , mReads(0)
+      , mCpuTime(0.0)
+      , mDone(false)
+   {
+      mLatencies.reserve(events);
+      mStampErrors.reserve(events);
+   }
+
+   void setSendTime(const std::size_t event, const vpr::Interval& time)
+   {
+      vpr::Guard<vpr::Mutex> g(mLock);
+      mSendTimes[event] = time;
+   }
+
+   /** gadget::IOReactor callback.  Reads in batches. */
+   void onReadable(const vpr::Interval& arrival)
+   {
+      const double cpu_start(threadCpuTime());
+      const std::size_t max_events(64);
+      js_event events[max_events];
+      std::size_t count(max_events);
+
+      // A short read means that the pipe is empty.
+      while ( count == max_events )
+      {
+         const ssize_t bytes = read(mFd, events, sizeof(events));
+         count = bytes > 0 ? bytes / sizeof(js_event) : 0;
+
+         const vpr::Interval done(vpr::Interval::now());
+
+         vpr::Guard<vpr::Mutex> g(mLock);
+         ++mReads;
+         if ( count > 0 )
+         {
+            const vpr::Uint32 newest(events[count - 1].time);
+            for ( std::size_t i = 0; i < count; ++i )
+            {
+               record(arrival - vpr::Interval(newest - events[i].time,
+                                              vpr::Interval::Msec),
+                      done);
+            }
+         }
+      }
+
+      vpr::Guard<vpr::Mutex> g(mLock);
+      mCpuTime += threadCpuTime() - cpu_start;
+   }
+
+   /** Thread body for the once per frame mode. */
+   void frameLoop(const float frameRate)
+   {
+      const vpr::Uint32 period_usec(
+         static_cast<vpr::Uint32>(1000000.0f / frameRate)
+      );
+
+      while ( ! mDone )
+      {
+         vpr::System::usleep(period_usec);
+
+         const double cpu_start(threadCpuTime());
+         js_event event;
+         while ( true )
+         {
+            const ssize_t bytes = read(mFd, &event, sizeof(event));
+
+            vpr::Guard<vpr::Mutex> g(mLock);
+            ++mReads;
+            if ( bytes <= 0 )
+            {
+               break;
+            }
+
+            const vpr::Interval now(vpr::Interval::now());
+            record(now, now);
+         }
+
+         vpr::Guard<vpr::Mutex> g(mLock);
+         mCpuTime += threadCpuTime() - cpu_start;
+      }
+   }
+
+   void stop()
+   {
+      mDone = true;
+   }
+
+   void report(const std::string& mode)
+   {
+      vpr::Guard<vpr::Mutex> g(mLock);
+
+      std::cout << mode << ": " << mCount << " of " << mSendTimes.size()
+                << " events, " << mReads << " reads, " << mCpuTime * 1000.0
+                << " ms CPU" << std::endl;
+
+      if ( mLatencies.empty() )
+      {
+         return;
+      }
+
+      std::sort(mLatencies.begin(), mLatencies.end());
+      std::sort(mStampErrors.begin(), mStampErrors.end());
+
+      double latency_sum(0.0), error_sum(0.0);
+      for ( std::size_t i = 0; i < mLatencies.size(); ++i )
+      {
+         latency_sum += mLatencies[i];
+         error_sum   += mStampErrors[i];
+      }
+
+      std::cout << "   latency (us): mean " << latency_sum / mLatencies.size()
+                << ", median " << mLatencies[mLatencies.size() / 2]
+                << ", 99% " << mLatencies[mLatencies.size() * 99 / 100]
+                << ", max " << mLatencies.back() << std::endl
+                << "   stamp error (us): mean "
+                << error_sum / mStampErrors.size()
+                << ", max " << mStampErrors.back() << std::endl;
+   }
+
+private:
+   /** Records the next event.  mLock must be held. */
+   void record(const vpr::Interval& stamp, const vpr::Interval& done)
+   {
+      if ( mCount < mSendTimes.size() )
+      {
+         const vpr::Interval& sent(mSendTimes[mCount]);
+         mLatencies.push_back((done - sent).usecf());
+         mStampErrors.push_back(stamp > sent ? (stamp - sent).usecf()
+                                             : (sent - stamp).usecf());
+         ++mCount;
+      }
+   }
+
+   int                        mFd;
+   vpr::Mutex                 mLock;
+   std::vector<vpr::Interval> mSendTimes;
+   std::vector<float>         mLatencies;
+   std::vector<float>         mStampErrors;
+   std::size_t                mCount;
+   std::size_t                mReads;
+   double                     mCpuTime;
+   volatile bool              mDone;
+};
+
+/** Plays the kernel: writes bursts of axis events at the given rate. */
+void play(const int fd, const float rate, const unsigned int burst,
+          const unsigned int bursts, Reader& reader)
+{
+   const Pacer pacer(rate);
+   std::vector<js_event> events(burst);
+
+   for ( unsigned int b = 0; b < bursts; ++b )
+   {
+      const vpr::Interval now(pacer.wait(b));
+      for ( unsigned int i = 0; i < burst; ++i )
+      {
+         events[i].time   = kernelTime(now);
+         events[i].value  = static_cast<vpr::Int16>(b * 37 + i);
+         events[i].type   = JS_EVENT_AXIS;
+         events[i].number = static_cast<vpr::Uint8>(i % 4);
+         reader.setSendTime(b * burst + i, now);
+      }
+
+      if ( write(fd, &events[0], burst * sizeof(js_event)) < 0 )
+      {
+         std::cerr << "write: " << strerror(errno) << std::endl;
+         return;
+      }
+   }
+
+   // Give the reader a moment to catch up.
+   vpr::System::msleep(100);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   float rate(250.0f);
+   unsigned int burst(4);
+   float frame_rate(60.0f);
+   unsigned int bursts(1000);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-r") == 0 )
+      {
+         rate = static_cast<float>(std::atof(argv[i + 1]));
+      }
+      else if ( std::strcmp(argv[i], "-b") == 0 )
+      {
+         burst = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-f") == 0 )
+      {
+         frame_rate = static_cast<float>(std::atof(argv[i + 1]));
+      }
+      else if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         bursts = std::atoi(argv[i + 1]);
+      }
+   }
+
+   if ( rate <= 0.0f || frame_rate <= 0.0f || burst == 0 || bursts == 0 )
+   {
+      std::cerr << "Nothing to play" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   const std::size_t events(burst * bursts);
+
+   try
+   {
+      // Read with gadget::IOReactor.
+      {
+         int fds[2];
+         if ( pipe(fds) < 0 )
+         {
+            std::cerr << "pipe: " << strerror(errno) << std::endl;
+            return EXIT_FAILURE;
+         }
+         fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+         Reader reader(fds[0], events);
+         gadget::IOReactor::instance()->registerHandle(
+            fds[0], boost::bind(&Reader::onReadable, &reader, _1)
+         );
+
+         play(fds[1], rate, burst, bursts, reader);
+
+         gadget::IOReactor::instance()->unregisterHandle(fds[0]);
+         reader.report("reactor");
+         close(fds[0]);
+         close(fds[1]);
+      }
+
+      // Read once per frame.
+      {
+         int fds[2];
+         if ( pipe(fds) < 0 )
+         {
+            std::cerr << "pipe: " << strerror(errno) << std::endl;
+            return EXIT_FAILURE;
+         }
+         fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+         Reader reader(fds[0], events);
+         vpr::Thread frame_thread(boost::bind(&Reader::frameLoop, &reader,
+                                              frame_rate));
+
+         play(fds[1], rate, burst, bursts, reader);
+
+         reader.stop();
+         frame_thread.join();
+         reader.report("frame");
+         close(fds[0]);
+         close(fds[1]);
+      }
+   }
+   catch (vpr::Exception& ex)
+   {
+      std::cerr << "Benchmark failed: " << ex.what() << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,249 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Regression test for the number of heap allocations made by the per-frame
+ * cluster control packets.  End blocks are sent several times per frame and
+ * application barrier waits once per barrier, so after the first frame both
+ * must go out without allocating.
+ *
+ * A gadget::NetworkManager acting as the master is connected over loopback
+ * to one acting as a slave, and both are driven from the main thread once
+ * they are connected.  Every frame, the master sends an end block with
+ * NetworkManager::sendUpdate() and a wait packet prepared the way
+ * ApplicationBarrierServer prepares it, and the allocations made by these
+ * sends are counted.  It then goes through an update() and a barrier() with
+ * the slave, which send the same end blocks but also receive packets, which
+ * allocates.  The slave reads every packet and checks the frame number in
+ * its header, so an end block that goes out with the frame number of an
+ * earlier send is caught.
+ *
+ * Usage: packetAllocTest [-n frames] [-p port]
+ *
+ * The exit status is non-zero if any allocation happens in the sends after
+ * the warm-up frame or if a received header does not carry the frame number
+ * that was sent.  For comparison, the allocations made by creating a new end
+ * block for every send are also reported.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <boost/bind.hpp>
+
+#include <vpr/vpr.h>
+#include <vpr/IO/SerializableObject.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/GUID.h>
+#include <vpr/Util/Interval.h>
+
+#include <cluster/ClusterException.h>
+#include <cluster/Packets/DataPacket.h>
+#include <cluster/Packets/EndBlock.h>
+#include <cluster/Packets/Header.h>
+#include <gadget/NetworkManager.h>
+#include <gadget/Node.h>
+
+#include "ClusterTestUtil.h"
+
+
+namespace
+{
+
+/** Stands in for an ApplicationBarrier, which only writes its GUID. */
+class Barrier : public vpr::SerializableObject
+{
+public:
+   explicit Barrier(const vpr::GUID& id)
+      : mId(id)
+   {;}
+
+   virtual void writeObject(vpr::ObjectWriter* writer)
+   {
+      mId.writeObject(writer);
+   }
+
+   virtual void readObject(vpr::ObjectReader* reader)
+   {
+      mId.readObject(reader);
+   }
+
+private:
+   vpr::GUID mId;
+};
+
+/**
+ * Reads the next packet on \p node and returns false if it is not of type
+ * \p type or, for an end block, does not carry \p frame.
+ */
+bool receive(gadget::NodePtr node, const vpr::Uint16 type,
+             const vpr::Uint32 frame = 0)
+{
+   cluster::PacketPtr packet = node->recvPacket();
+
+   if ( packet->getPacketType() != type )
+   {
+      std::cerr << "Received packet type " << packet->getPacketType()
+                << " instead of " << type << std::endl;
+      return false;
+   }
+
+   if ( cluster::Header::RIM_END_BLOCK == type &&
+        packet->getHeader()->getFrame() != frame )
+   {
+      std::cerr << "Received end block " << packet->getHeader()->getFrame()
+                << " instead of " << frame << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   unsigned int frames(10000);
+   vpr::Uint16 port(17700);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         frames = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-p") == 0 )
+      {
+         port = std::atoi(argv[i + 1]);
+      }
+   }
+
+   gadget::NetworkManager master;
+   gadget::NetworkManager slave;
+
+   vpr::Thread* listener =
+      new vpr::Thread(boost::bind(&gadget::NetworkManager::waitForConnection,
+                                  &slave, port));
+   master.addNode("slave", "localhost", port);
+   const bool connected =
+      master.connectToSlaves(vpr::Interval(10, vpr::Interval::Sec));
+   listener->join();
+   delete listener;
+
+   if ( ! connected || slave.getNodes().empty() )
+   {
+      std::cerr << "FAILED: could not connect to the slave" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   gadget::NodePtr slave_node = master.getNodes()[0];
+   gadget::NodePtr master_node = slave.getNodes()[0];
+
+   const vpr::GUID barrier_id("5d1e0a4c-8b1f-4c86-9d0e-7f2a3b6c1e90");
+   Barrier barrier(barrier_id);
+
+   // Everything that lives across frames is created up front.
+   cluster::EndBlockPtr slave_end_block = cluster::EndBlock::create(0);
+   cluster::DataPacketPtr wait_packet =
+      createTestDataPacket(barrier_id);
+   wait_packet->serialize(barrier);
+
+   unsigned long send_allocations(0);
+   unsigned int bad_packets(0);
+
+   try
+   {
+      for ( unsigned int f = 0; f <= frames; ++f )
+      {
+         // The exchanges of one frame with fused synchronization
+         // (ClusterManager::exchange() with temp values 2 and 3), an
+         // application barrier and the swap barrier.  Frame 0 is the warm-up
+         // frame.
+         const unsigned long before_send(getAllocationCount());
+         master.sendUpdate(2);
+         slave_node->send(wait_packet);
+         if ( f > 0 )
+         {
+            send_allocations += getAllocationCount() - before_send;
+         }
+
+         bad_packets += ! receive(master_node, cluster::Header::RIM_END_BLOCK,
+                                  2);
+         bad_packets += ! receive(master_node, cluster::Header::RIM_DATA_PACKET);
+
+         // The slave's end blocks have to be there before the master waits
+         // for them, including the one that sendUpdate() did not wait for.
+         master_node->send(slave_end_block);
+         master_node->send(slave_end_block);
+         master.update(3);
+         bad_packets += ! receive(master_node, cluster::Header::RIM_END_BLOCK,
+                                  3);
+
+         master_node->send(slave_end_block);
+         master.barrier(true);
+         bad_packets += ! receive(master_node, cluster::Header::RIM_END_BLOCK,
+                                  0);
+      }
+   }
+   catch (cluster::ClusterException& ex)
+   {
+      std::cerr << ex.what() << std::endl;
+      ++bad_packets;
+   }
+
+   master.shutdown();
+   slave.shutdown();
+
+   // The old way: a new end block for every send.
+   const unsigned long before_create(getAllocationCount());
+   for ( unsigned int f = 0; f < frames; ++f )
+   {
+      cluster::EndBlockPtr temp = cluster::EndBlock::create(f);
+   }
+   const unsigned long created_allocations = getAllocationCount() - before_create;
+
+   std::cout << frames << " frames: " << send_allocations
+             << " allocations in the sends of reused packets, "
+             << (frames > 0 ? double(created_allocations) / frames : 0.0)
+             << " allocations per end block when created for each send"
+             << std::endl;
+
+   if ( bad_packets > 0 )
+   {
+      std::cerr << "FAILED: " << bad_packets << " packets were not received "
+                << "as sent" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   if ( send_allocations > 0 )
+   {
+      std::cerr << "FAILED: per-frame control packets allocated memory"
+                << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
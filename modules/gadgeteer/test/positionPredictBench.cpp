@@ -0,0 +1,359 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+/*
+ * Accuracy benchmark for gadget::PredictivePositionFilter.  A tracker
+ * recording is replayed the way the kernel sees it: once per frame the newest
+ * sample is run through the filter, which predicts it to the time the frame
+ * reaches the display.  The prediction is compared with the recorded pose at
+ * that time, and the RMS and worst position and orientation errors are
+ * reported for no prediction and for each motion model.
+ *
+ * Usage: positionPredictBench [-f recording] [-r frame rate] [-l latency]
+ *                             [-a smoothing] [-t tracker rate] [-s seconds]
+ *
+ * A recording is a text file with one sample per line:
+ *
+ *    seconds x y z qw qx qy qz
+ *
+ * with the position in meters.  Without one, -s seconds of synthetic head
+ * motion (slow sway plus fast turns, with a little noise) sampled at -t Hz
+ * are used.  The latency (-l, in milliseconds) is the time from the proxy
+ * update to the display.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gmtl/Matrix.h>
+#include <gmtl/Generate.h>
+#include <gmtl/QuatOps.h>
+#include <gmtl/VecOps.h>
+
+#include <vpr/vpr.h>
+#include <vpr/Util/Interval.h>
+
+#include <gadget/Type/PositionData.h>
+#include <gadget/Filter/Position/PredictivePositionFilter.h>
+
+
+namespace
+{
+
+const float PI(3.14159265f);
+
+struct Pose
+{
+   double      time;
+   gmtl::Vec3f pos;
+   gmtl::Quatf rot;
+};
+
+std::vector<Pose> loadRecording(const std::string& fileName)
+{
+   std::vector<Pose> poses;
+   std::ifstream in(fileName.c_str());
+   std::string line;
+
+   while ( std::getline(in, line) )
+   {
+      std::istringstream fields(line);
+      Pose pose;
+      float w;
+
+      if ( fields >> pose.time >> pose.pos[0] >> pose.pos[1] >> pose.pos[2]
+                  >> w >> pose.rot[gmtl::Xelt] >> pose.rot[gmtl::Yelt]
+                  >> pose.rot[gmtl::Zelt] )
+      {
+         pose.rot[gmtl::Welt] = w;
+         gmtl::normalize(pose.rot);
+         poses.push_back(pose);
+      }
+   }
+
+   return poses;
+}
+
+/** Small deterministic generator so that every run sees the same noise. */
+class Values
+{
+public:
+   Values()
+      : mState(12345)
+   {
+   }
+
+   /** Returns a value in [lo,hi). */
+   float next(const float lo, const float hi)
+   {
+      mState = mState * 1103515245u + 12345u;
+      return lo + (hi - lo) * ((mState >> 8) & 0xffffff) / 16777216.0f;
+   }
+
+private:
+   vpr::Uint32 mState;
+};
+
+gmtl::Quatf axisRotation(const float x, const float y, const float z,
+                         const float angle)
+{
+   const float s(std::sin(angle * 0.5f));
+   return gmtl::Quatf(x * s, y * s, z * s, std::cos(angle * 0.5f));
+}
+
+std::vector<Pose> makeMotion(const double seconds, const double rate)
+{
+   std::vector<Pose> poses;
+   Values noise;
+   const float deg(PI / 180.0f);
+
+   for ( double t = 0.0; t < seconds; t += 1.0 / rate )
+   {
+      const float ft(static_cast<float>(t));
+      const float yaw(60.0f * deg * std::sin(2.0f * PI * 0.25f * ft) +
+                      10.0f * deg * std::sin(2.0f * PI * 1.3f * ft));
+      const float pitch(15.0f * deg * std::sin(2.0f * PI * 0.4f * ft));
+
+      Pose pose;
+      pose.time = t;
+      pose.pos.set(0.1f * std::sin(2.0f * PI * 0.3f * ft),
+                   1.7f + 0.02f * std::sin(2.0f * PI * 1.1f * ft),
+                   0.1f * std::sin(2.0f * PI * 0.5f * ft));
+      pose.rot = axisRotation(0.0f, 1.0f, 0.0f, yaw) *
+                 axisRotation(1.0f, 0.0f, 0.0f, pitch);
+
+      for ( unsigned int i = 0; i < 3; ++i )
+      {
+         pose.pos[i] += noise.next(-0.0005f, 0.0005f);
+      }
+      pose.rot = axisRotation(0.0f, 0.0f, 1.0f,
+                              noise.next(-0.05f, 0.05f) * deg) * pose.rot;
+      poses.push_back(pose);
+   }
+
+   return poses;
+}
+
+/** Returns the recorded pose at time \p t, interpolated between samples. */
+Pose truthAt(const std::vector<Pose>& poses, const double t)
+{
+   std::vector<Pose>::size_type i(1);
+   while ( i + 1 < poses.size() && poses[i].time < t )
+   {
+      ++i;
+   }
+
+   const Pose& a(poses[i - 1]);
+   const Pose& b(poses[i]);
+   const float u(static_cast<float>((t - a.time) / (b.time - a.time)));
+
+   Pose pose;
+   pose.time = t;
+   pose.pos  = a.pos * (1.0f - u) + b.pos * u;
+
+   const float sign(gmtl::dot(a.rot, b.rot) < 0.0f ? -1.0f : 1.0f);
+   for ( unsigned int j = 0; j < 4; ++j )
+   {
+      pose.rot[j] = (1.0f - u) * a.rot[j] + u * sign * b.rot[j];
+   }
+   gmtl::normalize(pose.rot);
+
+   return pose;
+}
+
+vpr::Interval toInterval(const double seconds)
+{
+   // Time stamps of zero mean "not stamped", so start one second in.
+   return vpr::Interval(static_cast<vpr::Uint64>((seconds + 1.0) * 1.0e6),
+                        vpr::Interval::Usec);
+}
+
+/** Accumulates the prediction error of one configuration. */
+class Score
+{
+public:
+   Score(const std::string& name)
+      : mName(name)
+      , mPosSq(0.0)
+      , mRotSq(0.0)
+      , mPosMax(0.0)
+      , mRotMax(0.0)
+      , mCount(0)
+   {
+   }
+
+   void add(const gmtl::Matrix44f& predicted, const Pose& truth)
+   {
+      const gmtl::Vec3f pos(gmtl::makeTrans<gmtl::Vec3f>(predicted));
+      const gmtl::Quatf rot(gmtl::makeRot<gmtl::Quatf>(predicted));
+
+      const double pos_err(gmtl::length(gmtl::Vec3f(pos - truth.pos)) *
+                           1000.0);
+      const float d(std::fabs(gmtl::dot(rot, truth.rot)));
+      const double rot_err(2.0 * std::acos(d < 1.0f ? d : 1.0f) *
+                           180.0 / PI);
+
+      mPosSq  += pos_err * pos_err;
+      mRotSq  += rot_err * rot_err;
+      mPosMax  = pos_err > mPosMax ? pos_err : mPosMax;
+      mRotMax  = rot_err > mRotMax ? rot_err : mRotMax;
+      ++mCount;
+   }
+
+   void print() const
+   {
+      std::cout << std::setw(22) << std::left << mName << std::right
+                << std::fixed << std::setprecision(2)
+                << std::setw(10) << std::sqrt(mPosSq / mCount)
+                << std::setw(10) << mPosMax
+                << std::setw(10) << std::sqrt(mRotSq / mCount)
+                << std::setw(10) << mRotMax << std::endl;
+   }
+
+private:
+   std::string  mName;
+   double       mPosSq;
+   double       mRotSq;
+   double       mPosMax;
+   double       mRotMax;
+   unsigned int mCount;
+};
+
+}
+
+int main(int argc, char* argv[])
+{
+   std::string recording;
+   double frame_rate(60.0);
+   double latency_ms(25.0);
+   float smoothing(0.5f);
+   double tracker_rate(120.0);
+   double seconds(60.0);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-f") == 0 )
+      {
+         recording = argv[i + 1];
+      }
+      else if ( std::strcmp(argv[i], "-r") == 0 )
+      {
+         frame_rate = std::atof(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-l") == 0 )
+      {
+         latency_ms = std::atof(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-a") == 0 )
+      {
+         smoothing = static_cast<float>(std::atof(argv[i + 1]));
+      }
+      else if ( std::strcmp(argv[i], "-t") == 0 )
+      {
+         tracker_rate = std::atof(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-s") == 0 )
+      {
+         seconds = std::atof(argv[i + 1]);
+      }
+   }
+
+   const std::vector<Pose> poses(recording.empty() ?
+                                    makeMotion(seconds, tracker_rate) :
+                                    loadRecording(recording));
+
+   if ( poses.size() < 2 )
+   {
+      std::cerr << "Not enough samples in " << recording << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   gadget::PredictivePositionFilter cv_filter;
+   cv_filter.setModel(gadget::PredictivePositionFilter::CONSTANT_VELOCITY);
+   cv_filter.setMaxPrediction(vpr::Interval(1, vpr::Interval::Sec));
+
+   gadget::PredictivePositionFilter desp_filter;
+   desp_filter.setModel(gadget::PredictivePositionFilter::DOUBLE_EXPONENTIAL);
+   desp_filter.setSmoothing(smoothing);
+   desp_filter.setMaxPrediction(vpr::Interval(1, vpr::Interval::Sec));
+
+   Score none("none"), cv("constant velocity"), desp("double exponential");
+
+   const double latency(latency_ms / 1000.0);
+   const double end(poses.back().time - latency);
+   std::vector<Pose>::size_type newest(0);
+
+   for ( double frame = poses.front().time; frame < end;
+         frame += 1.0 / frame_rate )
+   {
+      while ( newest + 1 < poses.size() && poses[newest + 1].time <= frame )
+      {
+         ++newest;
+      }
+
+      const Pose& sample_pose(poses[newest]);
+      gmtl::Matrix44f mat(gmtl::makeRot<gmtl::Matrix44f>(sample_pose.rot));
+      gmtl::setTrans(mat, sample_pose.pos);
+
+      std::vector<gadget::PositionData> sample(1, gadget::PositionData(mat));
+      sample[0].setTime(toInterval(sample_pose.time));
+
+      const vpr::Interval display_time(toInterval(frame + latency));
+      const Pose truth(truthAt(poses, frame + latency));
+
+      none.add(mat, truth);
+
+      std::vector<gadget::PositionData> predicted(sample);
+      cv_filter.predict(predicted, display_time);
+      cv.add(predicted[0].getValue(), truth);
+
+      predicted = sample;
+      desp_filter.predict(predicted, display_time);
+      desp.add(predicted[0].getValue(), truth);
+   }
+
+   std::cout << poses.size() << " samples over "
+             << poses.back().time - poses.front().time << " s, "
+             << frame_rate << " Hz frames, " << latency_ms
+             << " ms to display, smoothing " << smoothing << "\n\n"
+             << std::setw(22) << std::left << "model" << std::right
+             << std::setw(10) << "RMS mm" << std::setw(10) << "max mm"
+             << std::setw(10) << "RMS deg" << std::setw(10) << "max deg"
+             << std::endl;
+   none.print();
+   cv.print();
+   desp.print();
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,381 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Benchmark for the routing of RIM data packets on the receiving node.  A
+ * gadget::NetworkManager is given a number of packet handlers, one of which
+ * stands in for the RIM plug-in and owns hundreds of virtual devices.  One
+ * data packet per device is received every frame and passed to
+ * gadget::NetworkManager::handlePacket(), which is what the cluster update
+ * does for every packet that arrives.
+ *
+ * The same packets are routed twice.  The first run sends them without a
+ * channel, which is what senders that predate channels do: the handler is
+ * found by GUID, the packet is cast with boost::dynamic_pointer_cast(), and
+ * the device is looked up by GUID the way cluster::RIMPlugin used to.  The
+ * second run sends them on the handler and object channels that the sender
+ * assigns, so both lookups are table indexing.  The time per packet is
+ * reported for each run.
+ *
+ * Usage: rimDispatchBench [-d devices] [-n frames] [-h extra handlers]
+ *
+ * The exit status is non-zero if a device does not receive every packet
+ * that was sent to it.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+#include <vpr/vpr.h>
+#include <vpr/IO/SerializableObject.h>
+#include <vpr/Util/GUID.h>
+#include <vpr/Util/Interval.h>
+
+#include <cluster/Packets/DataPacket.h>
+#include <cluster/Packets/Header.h>
+#include <cluster/Packets/PacketFactory.h>
+#include <cluster/Packets/PacketPtr.h>
+#include <gadget/NetworkManager.h>
+#include <gadget/Node.h>
+#include <gadget/PacketHandler.h>
+
+
+namespace
+{
+
+/** Stands in for the input device that a virtual device wraps. */
+class BenchDevice : public vpr::SerializableObject
+{
+public:
+   BenchDevice()
+      : mValue(0)
+      , mUpdates(0)
+   {
+   }
+
+   virtual void writeObject(vpr::ObjectWriter* writer)
+   {
+      writer->writeUint32(mValue);
+   }
+
+   virtual void readObject(vpr::ObjectReader* reader)
+   {
+      mValue = reader->readUint32();
+      ++mUpdates;
+   }
+
+   vpr::Uint32  mValue;
+   unsigned int mUpdates;
+};
+
+struct BenchVirtualDevice
+{
+   vpr::GUID   id;
+   BenchDevice device;
+};
+
+typedef boost::unordered_map<vpr::GUID, BenchVirtualDevice*, vpr::GUID::hash>
+   device_map_t;
+
+/** A packet handler that receives nothing. */
+class IdleHandler : public gadget::PacketHandler
+{
+public:
+   IdleHandler()
+   {
+      mGuid.generate();
+   }
+
+   virtual vpr::GUID getHandlerGUID()
+   {
+      return mGuid;
+   }
+
+   virtual std::string getHandlerName()
+   {
+      return "IdleHandler";
+   }
+
+   virtual void handlePacket(cluster::PacketPtr, gadget::NodePtr)
+   {
+   }
+
+   virtual void recoverFromLostNode(gadget::NodePtr)
+   {
+   }
+
+private:
+   vpr::GUID mGuid;
+};
+
+/**
+ * Routes data packets to virtual devices the way cluster::RIMPlugin does,
+ * either by GUID as before channels or by object channel.
+ */
+class DeviceHandler : public gadget::PacketHandler
+{
+public:
+   DeviceHandler(const vpr::GUID& guid, std::vector<BenchVirtualDevice>& devices)
+      : mGuid(guid)
+      , mByChannel(false)
+      , mChannels(devices.size() + 1, static_cast<BenchVirtualDevice*>(NULL))
+   {
+      for ( unsigned int i = 0; i < devices.size(); ++i )
+      {
+         mDevices[devices[i].id] = &devices[i];
+         mChannels[i + 1]        = &devices[i];
+      }
+   }
+
+   void setByChannel(const bool byChannel)
+   {
+      mByChannel = byChannel;
+   }
+
+   virtual vpr::GUID getHandlerGUID()
+   {
+      return mGuid;
+   }
+
+   virtual std::string getHandlerName()
+   {
+      return "DeviceHandler";
+   }
+
+   virtual void handlePacket(cluster::PacketPtr packet, gadget::NodePtr)
+   {
+      BenchVirtualDevice* device(NULL);
+      vpr::BufferObjectReader* reader(NULL);
+
+      if ( mByChannel )
+      {
+         cluster::DataPacket* data_packet =
+            static_cast<cluster::DataPacket*>(packet.get());
+         const vpr::Uint16 channel =
+            cluster::Header::getObjectChannel(packet->getChannel());
+
+         if ( channel < mChannels.size() && NULL != mChannels[channel] &&
+              mChannels[channel]->id == data_packet->getObjectId() )
+         {
+            device = mChannels[channel];
+         }
+         reader = data_packet->getPacketReader();
+      }
+      else
+      {
+         cluster::DataPacketPtr data_packet =
+            boost::dynamic_pointer_cast<cluster::DataPacket>(packet);
+
+         // The scan that RIMPlugin::getVirtualDevice() used to do.
+         for ( device_map_t::iterator i = mDevices.begin();
+               i != mDevices.end(); ++i )
+         {
+            if ( (*i).first == data_packet->getObjectId() )
+            {
+               device = (*i).second;
+               break;
+            }
+         }
+         reader = data_packet->getPacketReader();
+      }
+
+      if ( NULL != device )
+      {
+         device->device.readObject(reader);
+      }
+   }
+
+   virtual void recoverFromLostNode(gadget::NodePtr)
+   {
+   }
+
+private:
+   vpr::GUID                        mGuid;
+   bool                             mByChannel;
+   device_map_t                     mDevices;
+   std::vector<BenchVirtualDevice*> mChannels;
+};
+
+/**
+ * Serializes a data packet for \p device and receives it with the same steps
+ * as gadget::Node::recvPacket().
+ */
+cluster::PacketPtr transfer(const vpr::GUID& pluginId,
+                            BenchVirtualDevice& device,
+                            const vpr::Uint32 channel)
+{
+   cluster::DataPacketPtr sent =
+      cluster::DataPacket::create(pluginId, device.id, channel);
+   sent->serialize(device.device);
+
+   const std::vector<vpr::Uint8>& wire = sent->getData();
+
+   cluster::HeaderPtr head = cluster::Header::create();
+   head->readData(&wire[0]);
+
+   cluster::PacketPtr packet =
+      cluster::PacketFactory::instance()->createObject(head->getPacketType());
+   packet->setHeader(head);
+   packet->getData().assign(
+      wire.begin() + cluster::Header::RIM_PACKET_HEAD_SIZE,
+      wire.begin() + head->getPacketLength()
+   );
+   packet->parse();
+
+   return packet;
+}
+
+/** Returns the time per packet in nanoseconds. */
+double run(gadget::NetworkManager& network, gadget::NodePtr node,
+           const std::vector<cluster::PacketPtr>& packets,
+           const unsigned int frames)
+{
+   // The device data follows the plug-in and object GUIDs.
+   const unsigned int data_offset(32);
+
+   vpr::Interval start;
+
+   // Frame 0 warms up the caches and binds the handler channel.
+   for ( unsigned int f = 0; f <= frames; ++f )
+   {
+      if ( 1 == f )
+      {
+         start.setNow();
+      }
+
+      for ( unsigned int p = 0; p < packets.size(); ++p )
+      {
+         packets[p]->getPacketReader()->setCurPos(data_offset);
+         network.handlePacket(packets[p], node);
+      }
+   }
+
+   const double nsec =
+      static_cast<double>((vpr::Interval::now() - start).usec()) * 1000.0;
+   return frames > 0 && ! packets.empty() ?
+      nsec / (static_cast<double>(frames) * packets.size()) : 0.0;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   unsigned int device_count(256);
+   unsigned int frames(2000);
+   unsigned int extra_handlers(8);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-d") == 0 )
+      {
+         device_count = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         frames = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-h") == 0 )
+      {
+         extra_handlers = std::atoi(argv[i + 1]);
+      }
+   }
+
+   if ( device_count > 0xFFFE )
+   {
+      device_count = 0xFFFE;
+   }
+
+   const vpr::GUID plugin_id("9c3fb301-b142-4c6f-8ca3-1570898974d0");
+
+   std::vector<BenchVirtualDevice> devices(device_count);
+   for ( unsigned int i = 0; i < devices.size(); ++i )
+   {
+      devices[i].id.generate();
+      devices[i].device.mValue = i;
+   }
+
+   gadget::NetworkManager network;
+   for ( unsigned int i = 0; i < extra_handlers; ++i )
+   {
+      network.addHandler(gadget::PacketHandlerPtr(new IdleHandler()));
+   }
+
+   boost::shared_ptr<DeviceHandler> handler(new DeviceHandler(plugin_id,
+                                                              devices));
+   network.addHandler(handler);
+   const vpr::Uint16 handler_channel(network.getHandlerChannel(plugin_id));
+
+   std::vector<cluster::PacketPtr> by_guid, by_channel;
+   for ( unsigned int i = 0; i < devices.size(); ++i )
+   {
+      by_guid.push_back(transfer(plugin_id, devices[i], 0));
+      by_channel.push_back(
+         transfer(plugin_id, devices[i],
+                  cluster::Header::makeChannel(handler_channel, i + 1))
+      );
+   }
+
+   gadget::NodePtr node = gadget::Node::create("bench", "localhost", 0, NULL);
+
+   std::cout << frames << " frames of " << device_count << " device packets, "
+             << extra_handlers + 1 << " packet handlers" << std::endl;
+
+   handler->setByChannel(false);
+   const double guid_nsec = run(network, node, by_guid, frames);
+   std::cout << std::setw(8) << "guid" << ": " << std::fixed
+             << std::setprecision(1) << guid_nsec << " ns/packet"
+             << std::endl;
+
+   handler->setByChannel(true);
+   const double channel_nsec = run(network, node, by_channel, frames);
+   std::cout << std::setw(8) << "channel" << ": " << std::fixed
+             << std::setprecision(1) << channel_nsec << " ns/packet"
+             << std::endl;
+
+   unsigned int bad_devices(0);
+   for ( unsigned int i = 0; i < devices.size(); ++i )
+   {
+      if ( devices[i].device.mUpdates != 2 * (frames + 1) ||
+           devices[i].device.mValue != i )
+      {
+         ++bad_devices;
+      }
+   }
+
+   if ( bad_devices > 0 )
+   {
+      std::cerr << "FAILED: " << bad_devices
+                << " devices did not receive all of their packets"
+                << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,1276 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Benchmark for the standalone serial drivers.  Each driver talks to a
+ * scripted copy of its device on a pseudo-terminal (see SerialEmulator),
+ * so that driver changes can be measured without the hardware.  For every
+ * driver, the benchmark reports:
+ *
+ *    samples/s: the rate at which the driver returns samples.
+ *    CPU:       the CPU time of the reading thread per sample.  Waiting
+ *               for the device costs nothing, so this is the time spent
+ *               in the driver's own code and the system calls it makes.
+ *    latency:   the time from the moment the last byte of a sample would
+ *               have arrived on a real line to the moment the driver
+ *               returns the sample.
+ *
+ * Usage: serialDriverBench [-d driver] [-n samples] [-b baud]
+ *                          [-r rate] [-D delay] [-j jitter] [-s seed]
+ *                          [-f interval]
+ *
+ *    driver:   fastrak, pinchglove, flock or all (the default).
+ *    rate:     samples per second streamed by devices that send data
+ *              without being asked (the Pinch Glove and the Flock).
+ *    delay:    device response time in microseconds.
+ *    jitter:   upper bound of a random delay, in microseconds, added to
+ *              every frame sent by the device.
+ *    interval: one in this many records is damaged in the framing checks
+ *              (10 by default).  0 skips the framing checks.
+ *
+ * The drivers covered are the Polhemus Fastrak, polled in binary mode, and
+ * the Fakespace Pinch Glove and Ascension Flock of Birds, which stream
+ * data.  Each device encodes the number of the frame in the data it sends
+ * so that the sample returned by the driver can be matched with the time
+ * the frame was sent.
+ *
+ * The streaming drivers are run both in a blocking sample() loop, as their
+ * sampling threads do, and through gadget::SerialStreamReader, as the
+ * drivers do when the shared I/O thread is available.  The reader runs
+ * must hand out every record that the device sent.  The framing checks
+ * then repeat the streaming runs with damaged records mixed in: Flock
+ * records cut short, which the phasing bit has to recover from, and Pinch
+ * Glove packets that were not asked for or that never end, the latter
+ * filling the reader buffer so that it has to drop bytes.  The Pinch Glove
+ * reader runs finally hang up the device and check that the reader notices.
+ *
+ * The exit status is non-zero if any run loses or damages a record.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <vpr/vpr.h>
+#include <vpr/System.h>
+#include <vpr/Util/Exception.h>
+#include <vpr/Util/Interval.h>
+
+#include <gadget/Util/SerialStreamReader.h>
+
+#include <drivers/Polhemus/Fastrak/FastrakStandalone.h>
+#include <drivers/Fakespace/PinchGlove/PinchGloveStandalone.h>
+#include <drivers/Ascension/Flock/FlockStandalone.h>
+
+#include "BenchTiming.h"
+#include "SerialEmulator.h"
+
+
+namespace
+{
+
+/** Fastrak position units are inches. */
+const float METERS_PER_INCH(0.0254f);
+
+/**
+ * Flock position units are feet.  With the 36 inch scaling that the
+ * emulated Flock reports, one step of a 14-bit position word is this many
+ * feet.
+ */
+const float FEET_PER_FLOCK_STEP(3.0f / 8192.0f);
+
+/** The buffer size that the drivers give their SerialStreamReader. */
+const vpr::Uint32 READER_CAPACITY(1024);
+
+/** Records streamed by each run of the framing checks. */
+const unsigned int CHECK_SAMPLES(200);
+
+void putFloat(std::vector<vpr::Uint8>& frame, const float value)
+{
+   // The Fastrak sends floats in little-endian order.
+   vpr::Uint32 bits;
+   std::memcpy(&bits, &value, sizeof(bits));
+
+   for ( int i = 0; i < 4; ++i )
+   {
+      frame.push_back(static_cast<vpr::Uint8>(bits >> (8 * i)));
+   }
+}
+
+/**
+ * Polhemus Fastrak with two active stations.  Only the commands sent by
+ * FastrakStandalone::init() and readData() are answered.  The X position of
+ * station 1, in inches, is the number of the frame.
+ */
+class FastrakDevice : public SerialEmulator::Protocol
+{
+public:
+   virtual void received(const vpr::Uint8* data, const vpr::Uint32 size,
+                         SerialEmulator& emulator)
+   {
+      mInput.append(reinterpret_cast<const char*>(data), size);
+
+      while ( ! mInput.empty() )
+      {
+         const char command(mInput[0]);
+         std::string args;
+
+         // These commands take arguments terminated by a carriage return.
+         if ( std::strchr("OlHe", command) != NULL )
+         {
+            const std::string::size_type end = mInput.find('\r');
+            if ( std::string::npos == end )
+            {
+               return;
+            }
+
+            args = mInput.substr(1, end - 1);
+            mInput.erase(0, end + 1);
+         }
+         else
+         {
+            mInput.erase(0, 1);
+         }
+
+         if ( Fastrak::Command::SystemStatus == command )
+         {
+            sendStatus(emulator);
+         }
+         else if ( Fastrak::Command::StationStatus == command )
+         {
+            sendStationStatus(args, emulator);
+         }
+         else if ( Fastrak::Command::Point == command )
+         {
+            sendPoint(emulator);
+         }
+      }
+   }
+
+private:
+   void sendStatus(SerialEmulator& emulator)
+   {
+      // Flags 0x11: binary output, tracker configuration, inches.
+      std::string status("2 S011");
+      status.append(3, '\0');                           // Error bits
+      status.append(6, ' ');
+      status += "  4.02";                               // Software version
+
+      std::string system_id("serialDriverBench emulator");
+      system_id.resize(32, ' ');
+      status += system_id + "\r\n";
+
+      emulator.send(std::vector<vpr::Uint8>(status.begin(), status.end()));
+   }
+
+   void sendStationStatus(const std::string& station,
+                          SerialEmulator& emulator)
+   {
+      const std::string status = "2" + station.substr(0, 1) + "l1100\r\n";
+      emulator.send(std::vector<vpr::Uint8>(status.begin(), status.end()));
+   }
+
+   void sendPoint(SerialEmulator& emulator)
+   {
+      const float frame_number(static_cast<float>(emulator.getNextFrame()));
+
+      std::vector<vpr::Uint8> frame;
+      frame.reserve(2 * 33);
+
+      for ( int station = 1; station <= 2; ++station )
+      {
+         frame.push_back('0');
+         frame.push_back(static_cast<vpr::Uint8>('0' + station));
+         frame.push_back(' ');
+         putFloat(frame, frame_number);
+         putFloat(frame, static_cast<float>(station));
+         putFloat(frame, 0.0f);
+         putFloat(frame, 1.0f);
+         putFloat(frame, 0.0f);
+         putFloat(frame, 0.0f);
+         putFloat(frame, 0.0f);
+         frame.push_back('\r');
+         frame.push_back('\n');
+      }
+
+      emulator.send(frame);
+   }
+
+   std::string mInput;
+};
+
+/**
+ * Device that streams records at a fixed rate while streaming is on.  If a
+ * fault interval is set, one in that many records is preceded by a damaged
+ * one, which the driver has to skip.
+ */
+class StreamingDevice : public SerialEmulator::Protocol
+{
+public:
+   StreamingDevice(const double rate)
+      : mPeriod(static_cast<vpr::Uint64>(1000000.0 / rate),
+                vpr::Interval::Usec)
+      , mStreaming(false)
+      , mFaultInterval(0)
+      , mRecordsSent(0)
+      , mFaultsSent(0)
+   {
+   }
+
+   void setStreaming(const bool streaming)
+   {
+      mStreaming = streaming;
+   }
+
+   void setFaultInterval(const unsigned int interval)
+   {
+      mFaultInterval = interval;
+   }
+
+   /** Returns the number of good records sent. */
+   unsigned int getRecordsSent() const
+   {
+      return mRecordsSent;
+   }
+
+   /** Returns the number of damaged records sent. */
+   unsigned int getFaultsSent() const
+   {
+      return mFaultsSent;
+   }
+
+   virtual void idle(SerialEmulator& emulator)
+   {
+      const vpr::Interval now(vpr::Interval::now());
+
+      if ( ! mStreaming || now < mNext )
+      {
+         return;
+      }
+
+      mNext = (mNext == vpr::Interval() ? now : mNext) + mPeriod;
+
+      if ( mFaultInterval > 0 &&
+           mFaultInterval - 1 == mRecordsSent % mFaultInterval )
+      {
+         sendFault(emulator);
+         ++mFaultsSent;
+      }
+
+      sendRecord(emulator);
+      ++mRecordsSent;
+   }
+
+protected:
+   /** Sends a good record carrying the number of its frame. */
+   virtual void sendRecord(SerialEmulator& emulator) = 0;
+
+   /** Sends a damaged record. */
+   virtual void sendFault(SerialEmulator& emulator) = 0;
+
+private:
+   const vpr::Interval mPeriod;
+   volatile bool mStreaming;
+   volatile unsigned int mFaultInterval;
+   vpr::Interval mNext;
+   volatile unsigned int mRecordsSent;
+   volatile unsigned int mFaultsSent;
+};
+
+/**
+ * Fakespace Pinch Glove with timestamps on, streaming a data packet at a
+ * fixed rate once enabled.  The ten finger bits and the 14-bit timestamp
+ * both hold the number of the frame.  Damaged records alternate between an
+ * information packet that was not asked for and a data packet without an
+ * end byte that is longer than the reader buffer.
+ */
+class PinchGloveDevice : public StreamingDevice
+{
+public:
+   PinchGloveDevice(const double rate)
+      : StreamingDevice(rate)
+   {
+   }
+
+   virtual void received(const vpr::Uint8*, const vpr::Uint32,
+                         SerialEmulator&)
+   {
+   }
+
+protected:
+   virtual void sendRecord(SerialEmulator& emulator)
+   {
+      const vpr::Uint32 frame_number(emulator.getNextFrame());
+
+      std::vector<vpr::Uint8> frame(6);
+      frame[0] = PinchGlove::Control::START_BYTE_DATA_TS;
+      frame[1] = frame_number & 0x1f;
+      frame[2] = (frame_number >> 5) & 0x1f;
+      frame[3] = (frame_number >> 7) & 0x7f;
+      frame[4] = frame_number & 0x7f;
+      frame[5] = PinchGlove::Control::END_BYTE;
+
+      emulator.send(frame);
+   }
+
+   virtual void sendFault(SerialEmulator& emulator)
+   {
+      std::vector<vpr::Uint8> frame;
+
+      if ( getFaultsSent() % 2 == 0 )
+      {
+         const std::string info("serialDriverBench");
+         frame.push_back(PinchGlove::Control::START_BYTE_INFO);
+         frame.insert(frame.end(), info.begin(), info.end());
+         frame.push_back(PinchGlove::Control::END_BYTE);
+      }
+      else
+      {
+         frame.resize(READER_CAPACITY + 64, 0);
+         frame[0] = PinchGlove::Control::START_BYTE_DATA_TS;
+      }
+
+      emulator.send(frame);
+   }
+};
+
+/**
+ * Ascension Flock of Birds in standalone mode.  Only the commands sent by
+ * FlockStandalone::open(), configure(), startStreaming(), stopStreaming()
+ * and close() are understood.  Once streaming, the Flock sends position
+ * and angles records, the X position of which holds the low 13 bits of the
+ * number of the frame.  Damaged records are cut short after 1 to 11 bytes.
+ */
+class FlockDevice : public StreamingDevice
+{
+public:
+   FlockDevice(const double rate)
+      : StreamingDevice(rate)
+   {
+   }
+
+   virtual void received(const vpr::Uint8* data, const vpr::Uint32 size,
+                         SerialEmulator& emulator)
+   {
+      mInput.insert(mInput.end(), data, data + size);
+
+      std::size_t used(0);
+
+      while ( used < mInput.size() )
+      {
+         const vpr::Uint8 command(mInput[used]);
+
+         std::size_t length(1);
+         if ( Flock::Command::ExamineValue == command )
+         {
+            length = 2;
+         }
+         else if ( Flock::Command::Hemisphere == command )
+         {
+            length = 3;
+         }
+
+         if ( used + length > mInput.size() )
+         {
+            break;
+         }
+
+         if ( Flock::Command::ExamineValue == command )
+         {
+            sendAttribute(mInput[used + 1], emulator);
+         }
+         else if ( Flock::Command::Stream == command )
+         {
+            setStreaming(true);
+         }
+         else if ( Flock::Command::StreamStop == command ||
+                   Flock::Command::Sleep == command )
+         {
+            setStreaming(false);
+         }
+
+         // Anything else, such as picking a bird or choosing the output
+         // format, needs no reply.
+         used += length;
+      }
+
+      mInput.erase(mInput.begin(), mInput.begin() + used);
+   }
+
+protected:
+   virtual void sendRecord(SerialEmulator& emulator)
+   {
+      emulator.send(makeRecord(emulator.getNextFrame()));
+   }
+
+   virtual void sendFault(SerialEmulator& emulator)
+   {
+      std::vector<vpr::Uint8> record(makeRecord(emulator.getNextFrame()));
+      record.resize(1 + getFaultsSent() % (record.size() - 1));
+      emulator.send(record);
+   }
+
+private:
+   void sendAttribute(const vpr::Uint8 attribute, SerialEmulator& emulator)
+   {
+      std::vector<vpr::Uint8> reply;
+
+      switch ( attribute )
+      {
+         case Flock::Parameter::SoftwareRevision:
+            reply.push_back(3);
+            reply.push_back(67);
+            break;
+         case Flock::Parameter::ModelIdentification:
+            {
+               const std::string model("6DFOB     ");
+               reply.assign(model.begin(), model.end());
+            }
+            break;
+         case Flock::Parameter::AddressingMode:
+            reply.push_back(Flock::NormalAddressing);
+            break;
+         case Flock::Parameter::FbbAddress:
+            // Address 0 is a Flock in standalone mode.
+            reply.push_back(0);
+            break;
+         case Flock::Parameter::FlockSystemStatus:
+            reply.resize(14, 0);
+            break;
+         case Flock::Parameter::BirdStatus:
+         case Flock::Parameter::BirdExpandedErrorCode:
+            reply.resize(2, 0);
+            break;
+         case Flock::Parameter::PositionScaling:
+            // Scaling 0 is the 36 inch range.
+            reply.resize(2, 0);
+            break;
+         case Flock::Parameter::BirdErrorCode:
+            reply.push_back(0);
+            break;
+         default:
+            // The driver does not ask for anything else.
+            return;
+      }
+
+      emulator.send(reply);
+   }
+
+   /**
+    * Each of the six words of a record is sent as two 7-bit bytes, least
+    * significant first.  The first byte of the record has the phasing bit
+    * set.
+    */
+   static std::vector<vpr::Uint8> makeRecord(const vpr::Uint32 frameNumber)
+   {
+      std::vector<vpr::Uint8> record(12, 0);
+      record[0] = 0x80 | (frameNumber & 0x7f);
+      record[1] = (frameNumber >> 7) & 0x3f;
+      return record;
+   }
+
+   std::vector<vpr::Uint8> mInput;
+};
+
+/** Collects the measurements of one driver. */
+class Results
+{
+public:
+   Results()
+      : mCpuUsec(0.0)
+      , mSkipped(0)
+   {
+   }
+
+   void begin()
+   {
+      mStart = vpr::Interval::now();
+      mEnd   = vpr::Interval();
+   }
+
+   /** Stops the clock before the driver is shut down. */
+   void end()
+   {
+      mEnd = vpr::Interval::now();
+   }
+
+   void add(const double latencyUsec, const double cpuUsec)
+   {
+      mLatency.push_back(latencyUsec);
+      mCpuUsec += cpuUsec;
+   }
+
+   /** Counts a sample that could not be matched with a frame. */
+   void skip()
+   {
+      ++mSkipped;
+   }
+
+   std::size_t getCount() const
+   {
+      return mLatency.size();
+   }
+
+   unsigned int getSkipped() const
+   {
+      return mSkipped;
+   }
+
+   void print(const std::string& name)
+   {
+      const vpr::Interval end(mEnd == vpr::Interval() ? vpr::Interval::now()
+                                                      : mEnd);
+      const double wall((end - mStart).usecf());
+      const std::size_t count(mLatency.size());
+
+      std::cout << name << ": ";
+
+      if ( 0 == count )
+      {
+         std::cout << "no samples" << std::endl;
+         return;
+      }
+
+      std::vector<double> latency(mLatency);
+      std::sort(latency.begin(), latency.end());
+
+      double sum(0.0);
+      for ( std::size_t i = 0; i < count; ++i )
+      {
+         sum += latency[i];
+      }
+
+      std::cout << count << " samples";
+      if ( mSkipped > 0 )
+      {
+         std::cout << " (" << mSkipped << " unmatched)";
+      }
+      std::cout << "\n   " << (count + mSkipped) * 1e6 / wall
+                << " samples/s, CPU " << mCpuUsec / count << " us/sample\n"
+                << "   latency (us): mean " << sum / count
+                << ", median " << latency[count / 2]
+                << ", 99% " << latency[count * 99 / 100]
+                << ", max " << latency[count - 1] << std::endl;
+   }
+
+private:
+   vpr::Interval mStart;
+   vpr::Interval mEnd;
+   std::vector<double> mLatency;
+   double mCpuUsec;
+   unsigned int mSkipped;
+};
+
+/**
+ * Matches the frame numbers carried by samples with the frames written by
+ * the emulator.  Devices only send the low bits of the number, so it is
+ * unwrapped against the previous sample.  A sample must come from a later
+ * frame than the previous one.
+ */
+class FrameMatcher
+{
+public:
+   FrameMatcher(const SerialEmulator& emulator, const vpr::Uint32 mask)
+      : mEmulator(emulator)
+      , mMask(mask)
+      , mLastFrame(0)
+      , mMatched(false)
+   {
+   }
+
+   /**
+    * Adds a sample returned at \p done to \p results, or counts it as
+    * unmatched.
+    *
+    * @return true if the sample was matched with a frame.
+    */
+   bool add(const vpr::Uint32 bits, const vpr::Interval& done,
+            const double cpuUsec, Results& results)
+   {
+      const vpr::Uint32 frame =
+         mLastFrame + ((bits - mLastFrame) & mMask);
+      const vpr::Interval sent(mEmulator.getSendTime(frame));
+
+      if ( (mMatched && frame == mLastFrame) || sent == vpr::Interval() ||
+           done < sent )
+      {
+         results.skip();
+         return false;
+      }
+
+      mLastFrame = frame;
+      mMatched   = true;
+      results.add((done - sent).usecf(), cpuUsec);
+      return true;
+   }
+
+private:
+   const SerialEmulator& mEmulator;
+   const vpr::Uint32 mMask;
+   vpr::Uint32 mLastFrame;
+   bool mMatched;
+};
+
+/** Returns the frame number held by the finger bits of a glove sample. */
+vpr::Uint32 getFingerBits(const std::vector<int>& fingers)
+{
+   vpr::Uint32 bits(0);
+   for ( int f = 0; f < 10; ++f )
+   {
+      bits |= (fingers[f] ? 1 : 0) << f;
+   }
+   return bits;
+}
+
+/** Returns the frame number held by the position of a Flock sample. */
+vpr::Uint32 getFlockBits(FlockStandalone& flock)
+{
+   const float x(flock.getSensorPosition(0)(0, 3));
+   return static_cast<vpr::Uint32>(x / FEET_PER_FLOCK_STEP + 0.5f);
+}
+
+/**
+ * Framing callbacks for the SerialStreamReader runs.  They do what the
+ * processStream() methods of gadget::PinchGlove and gadget::Flock do, and
+ * measure every sample on the way.  The CPU time that the reactor thread
+ * spends between two samples is charged to the second one.
+ */
+class StreamFramer
+{
+public:
+   StreamFramer(FrameMatcher& matcher, Results& results)
+      : mMatcher(matcher)
+      , mResults(results)
+      , mLastCpuUsec(-1.0)
+      , mSamples(0)
+   {
+   }
+
+   vpr::Uint32 processPinchGlove(gadget::PinchGloveStandalone* glove,
+                                 const vpr::Uint8* data,
+                                 const vpr::Uint32 size, const vpr::Interval&)
+   {
+      std::vector<int> fingers(10, 0);
+      int timestamp(0);
+      bool got_sample(false);
+
+      const vpr::Uint32 used = glove->processStream(data, size, fingers,
+                                                    timestamp, got_sample);
+      if ( got_sample )
+      {
+         const vpr::Uint32 frame(static_cast<vpr::Uint32>(timestamp));
+         if ( (frame & 0x3ff) != getFingerBits(fingers) )
+         {
+            mResults.skip();
+            ++mSamples;
+         }
+         else
+         {
+            add(frame);
+         }
+      }
+
+      return used;
+   }
+
+   vpr::Uint32 processFlock(FlockStandalone* flock, const vpr::Uint8* data,
+                            const vpr::Uint32 size, const vpr::Interval&)
+   {
+      bool got_record(false);
+      const vpr::Uint32 used = flock->processStream(data, size, got_record);
+
+      if ( got_record )
+      {
+         add(getFlockBits(*flock));
+      }
+
+      return used;
+   }
+
+   unsigned int getSamples() const
+   {
+      return mSamples;
+   }
+
+private:
+   void add(const vpr::Uint32 bits)
+   {
+      const vpr::Interval done(vpr::Interval::now());
+      const double cpu_now(threadCpuTime() * 1e6);
+      const double cpu(mLastCpuUsec < 0.0 ? 0.0 : cpu_now - mLastCpuUsec);
+      mLastCpuUsec = cpu_now;
+
+      mMatcher.add(bits, done, cpu, mResults);
+      ++mSamples;
+   }
+
+   FrameMatcher& mMatcher;
+   Results& mResults;
+   double mLastCpuUsec;
+   volatile unsigned int mSamples;
+};
+
+/**
+ * Waits until \p framer has seen \p samples samples, then stops the device
+ * and waits for the records still on their way.
+ */
+void waitForSamples(const StreamFramer& framer, const unsigned int samples,
+                    const double rate, StreamingDevice& device,
+                    const SerialEmulator& emulator, Results& results)
+{
+   const vpr::Interval deadline(
+      vpr::Interval::now() +
+         vpr::Interval(static_cast<vpr::Uint64>(2e6 * samples / rate) +
+                          2000000,
+                       vpr::Interval::Usec)
+   );
+
+   while ( framer.getSamples() < samples && vpr::Interval::now() < deadline )
+   {
+      vpr::System::msleep(10);
+   }
+
+   results.end();
+   device.setStreaming(false);
+
+   // Let the emulator write whatever it queued before streaming stopped,
+   // and the reader read it.
+   vpr::System::msleep(50);
+   while ( emulator.getFramesSent() < emulator.getNextFrame() &&
+           vpr::Interval::now() < deadline )
+   {
+      vpr::System::msleep(10);
+   }
+   vpr::System::msleep(100);
+}
+
+/**
+ * Checks that a SerialStreamReader run handed out every good record that
+ * the device sent, and nothing else.
+ */
+bool checkStream(const std::string& name, const StreamingDevice& device,
+                 const Results& results)
+{
+   if ( results.getSkipped() > 0 ||
+        results.getCount() != device.getRecordsSent() )
+   {
+      std::cout << "   FAILED: " << name << " sent "
+                << device.getRecordsSent() << " records, the reader handed out "
+                << results.getCount() << " of them and "
+                << results.getSkipped() << " others" << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+void benchFastrak(const SerialEmulator::Settings& settings,
+                  const unsigned int samples)
+{
+   FastrakDevice device;
+   SerialEmulator emulator(device, settings);
+
+   if ( ! emulator.start() )
+   {
+      std::cerr << "fastrak: Could not create a pseudo-terminal" << std::endl;
+      return;
+   }
+
+   FastrakStandalone fastrak(emulator.getPortName(), settings.baud);
+   Results results;
+
+   try
+   {
+      if ( ! fastrak.open() )
+      {
+         std::cerr << "fastrak: Could not open " << emulator.getPortName()
+                   << std::endl;
+         return;
+      }
+
+      fastrak.init();
+      results.begin();
+
+      for ( unsigned int i = 0; i < samples; ++i )
+      {
+         const double cpu_start(threadCpuTime() * 1e6);
+         fastrak.readData();
+         const vpr::Interval done(vpr::Interval::now());
+         const double cpu(threadCpuTime() * 1e6 - cpu_start);
+
+         const float x(fastrak.getStationPosition(1)(0, 3));
+         const vpr::Uint32 frame =
+            static_cast<vpr::Uint32>(x / METERS_PER_INCH + 0.5f);
+         const vpr::Interval sent(emulator.getSendTime(frame));
+
+         if ( sent == vpr::Interval() || done < sent )
+         {
+            results.skip();
+         }
+         else
+         {
+            results.add((done - sent).usecf(), cpu);
+         }
+      }
+   }
+   catch (vpr::Exception& ex)
+   {
+      std::cerr << "fastrak: " << ex.what() << std::endl;
+   }
+
+   fastrak.close();
+   emulator.stop();
+   results.print("fastrak");
+}
+
+void benchPinchGlove(const SerialEmulator::Settings& settings,
+                     const unsigned int samples, const double rate)
+{
+   PinchGloveDevice device(rate);
+   SerialEmulator emulator(device, settings);
+
+   if ( ! emulator.start() )
+   {
+      std::cerr << "pinchglove: Could not create a pseudo-terminal"
+                << std::endl;
+      return;
+   }
+
+   Results results;
+
+   {
+      gadget::PinchGloveStandalone glove;
+
+      if ( ! glove.connect(emulator.getPortName(), settings.baud) )
+      {
+         std::cerr << "pinchglove: Could not open " << emulator.getPortName()
+                   << std::endl;
+         return;
+      }
+
+      device.setStreaming(true);
+      results.begin();
+
+      std::vector<int> fingers(10);
+      FrameMatcher matcher(emulator, 0x3fff);
+
+      for ( unsigned int i = 0; i < samples; ++i )
+      {
+         std::fill(fingers.begin(), fingers.end(), 0);
+         int timestamp(0);
+
+         const double cpu_start(threadCpuTime() * 1e6);
+         const bool got_sample = glove.sample(fingers, timestamp);
+         const vpr::Interval done(vpr::Interval::now());
+         const double cpu(threadCpuTime() * 1e6 - cpu_start);
+
+         const vpr::Uint32 frame(static_cast<vpr::Uint32>(timestamp));
+
+         if ( ! got_sample || (frame & 0x3ff) != getFingerBits(fingers) )
+         {
+            results.skip();
+            continue;
+         }
+
+         // The timestamp wraps after 2^14 frames.
+         matcher.add(frame, done, cpu, results);
+      }
+   }
+
+   emulator.stop();
+   results.print("pinchglove, sample()");
+}
+
+/**
+ * Streams Pinch Glove data through a SerialStreamReader.  The device hangs
+ * up at the end, which the reader must notice.
+ *
+ * @return false if a record was lost or damaged or if the reader did not
+ *         notice the hang-up.
+ */
+bool benchPinchGloveReader(const SerialEmulator::Settings& settings,
+                           const unsigned int samples, const double rate,
+                           const unsigned int faultInterval)
+{
+   const std::string name(faultInterval > 0 ? "pinchglove, reader, damaged"
+                                            : "pinchglove, reader");
+
+   PinchGloveDevice device(rate);
+   device.setFaultInterval(faultInterval);
+   SerialEmulator emulator(device, settings);
+
+   if ( ! emulator.start() )
+   {
+      std::cerr << name << ": Could not create a pseudo-terminal"
+                << std::endl;
+      return false;
+   }
+
+   gadget::PinchGloveStandalone glove;
+
+   if ( ! glove.connect(emulator.getPortName(), settings.baud) )
+   {
+      std::cerr << name << ": Could not open " << emulator.getPortName()
+                << std::endl;
+      return false;
+   }
+
+   Results results;
+   FrameMatcher matcher(emulator, 0x3fff);
+   StreamFramer framer(matcher, results);
+   gadget::SerialStreamReader reader(READER_CAPACITY);
+
+   try
+   {
+      reader.start(glove.getSerialPort(),
+                   boost::bind(&StreamFramer::processPinchGlove, &framer,
+                               &glove, _1, _2, _3));
+   }
+   catch (vpr::Exception& ex)
+   {
+      std::cerr << name << ": " << ex.what() << std::endl;
+      return false;
+   }
+
+   results.begin();
+   device.setStreaming(true);
+   waitForSamples(framer, samples, rate, device, emulator, results);
+
+   results.print(name);
+   std::cout << "   " << device.getFaultsSent() << " damaged records, "
+             << reader.getDroppedBytes() << " bytes dropped" << std::endl;
+
+   bool ok = checkStream(name, device, results);
+
+   // Every other damaged record is longer than the reader buffer.
+   if ( device.getFaultsSent() > 1 && 0 == reader.getDroppedBytes() )
+   {
+      std::cout << "   FAILED: " << name << " did not drop bytes from a full "
+                << "buffer" << std::endl;
+      ok = false;
+   }
+
+   emulator.stop();
+
+   bool hung_up(false);
+   for ( int i = 0; i < 100 && ! hung_up; ++i )
+   {
+      vpr::System::msleep(10);
+      hung_up = reader.checkFailure();
+   }
+
+   if ( ! hung_up )
+   {
+      std::cout << "   FAILED: " << name << " did not notice the hang-up"
+                << std::endl;
+      ok = false;
+   }
+
+   reader.stop();
+
+   return ok;
+}
+
+/**
+ * Opens and configures the emulated Flock and starts streaming.  This takes
+ * a few seconds because the driver resets the Flock first.
+ */
+bool startFlock(FlockStandalone& flock, const std::string& name)
+{
+   try
+   {
+      if ( ! flock.open() )
+      {
+         std::cerr << name << ": Could not open " << flock.getPort()
+                   << std::endl;
+         return false;
+      }
+
+      flock.configure();
+      flock.startStreaming();
+   }
+   catch (vpr::Exception& ex)
+   {
+      std::cerr << name << ": " << ex.what() << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+/**
+ * Reads Flock records in a blocking sample() loop.
+ *
+ * @return false if a record was damaged or the samples did not arrive.
+ */
+bool benchFlock(const SerialEmulator::Settings& settings,
+                const unsigned int samples, const double rate,
+                const unsigned int faultInterval)
+{
+   const std::string name(faultInterval > 0 ? "flock, sample(), damaged"
+                                            : "flock, sample()");
+
+   FlockDevice device(rate);
+   device.setFaultInterval(faultInterval);
+   SerialEmulator emulator(device, settings);
+
+   if ( ! emulator.start() )
+   {
+      std::cerr << name << ": Could not create a pseudo-terminal"
+                << std::endl;
+      return false;
+   }
+
+   FlockStandalone flock(emulator.getPortName(), settings.baud);
+
+   if ( ! startFlock(flock, name) )
+   {
+      return false;
+   }
+
+   Results results;
+   FrameMatcher matcher(emulator, 0x1fff);
+   results.begin();
+
+   try
+   {
+      for ( unsigned int i = 0; i < samples; ++i )
+      {
+         const double cpu_start(threadCpuTime() * 1e6);
+         flock.sample();
+         const vpr::Interval done(vpr::Interval::now());
+         const double cpu(threadCpuTime() * 1e6 - cpu_start);
+
+         matcher.add(getFlockBits(flock), done, cpu, results);
+      }
+   }
+   catch (vpr::Exception& ex)
+   {
+      std::cerr << name << ": " << ex.what() << std::endl;
+   }
+
+   results.end();
+   flock.close();
+   emulator.stop();
+   results.print(name);
+
+   // Records that were damaged or that went by while the driver recovered
+   // are lost, but every sample must be a good one.
+   if ( results.getSkipped() > 0 || results.getCount() != samples )
+   {
+      std::cout << "   FAILED: " << name << " returned "
+                << results.getCount() << " good samples of " << samples
+                << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+/**
+ * Streams Flock records through a SerialStreamReader.
+ *
+ * @return false if a record was lost or damaged.
+ */
+bool benchFlockReader(const SerialEmulator::Settings& settings,
+                      const unsigned int samples, const double rate,
+                      const unsigned int faultInterval)
+{
+   const std::string name(faultInterval > 0 ? "flock, reader, damaged"
+                                            : "flock, reader");
+
+   FlockDevice device(rate);
+   device.setFaultInterval(faultInterval);
+   SerialEmulator emulator(device, settings);
+
+   if ( ! emulator.start() )
+   {
+      std::cerr << name << ": Could not create a pseudo-terminal"
+                << std::endl;
+      return false;
+   }
+
+   FlockStandalone flock(emulator.getPortName(), settings.baud);
+
+   if ( ! startFlock(flock, name) )
+   {
+      return false;
+   }
+
+   Results results;
+   FrameMatcher matcher(emulator, 0x1fff);
+   StreamFramer framer(matcher, results);
+   gadget::SerialStreamReader reader(READER_CAPACITY);
+   bool ok(false);
+
+   try
+   {
+      reader.start(flock.getSerialPort(),
+                   boost::bind(&StreamFramer::processFlock, &framer, &flock,
+                               _1, _2, _3));
+
+      results.begin();
+      waitForSamples(framer, samples, rate, device, emulator, results);
+      reader.stop();
+
+      results.print(name);
+      std::cout << "   " << device.getFaultsSent() << " damaged records"
+                << std::endl;
+      ok = checkStream(name, device, results);
+   }
+   catch (vpr::Exception& ex)
+   {
+      std::cerr << name << ": " << ex.what() << std::endl;
+   }
+
+   reader.stop();
+   flock.close();
+   emulator.stop();
+
+   return ok;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   std::string driver("all");
+   unsigned int samples(2000);
+   double rate(100.0);
+   unsigned int fault_interval(10);
+   SerialEmulator::Settings settings;
+   settings.baud = 38400;
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-d") == 0 )
+      {
+         driver = argv[i + 1];
+      }
+      else if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         samples = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-b") == 0 )
+      {
+         settings.baud = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-r") == 0 )
+      {
+         rate = std::atof(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-D") == 0 )
+      {
+         settings.responseDelayUsec = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-j") == 0 )
+      {
+         settings.jitterUsec = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-s") == 0 )
+      {
+         settings.seed = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-f") == 0 )
+      {
+         fault_interval = std::atoi(argv[i + 1]);
+      }
+   }
+
+   if ( settings.baud <= 0 || rate <= 0.0 )
+   {
+      std::cerr << "The baud rate and the stream rate must be positive"
+                << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   std::cout << settings.baud << " baud, response delay "
+             << settings.responseDelayUsec << " us, jitter "
+             << settings.jitterUsec << " us" << std::endl;
+
+   const bool use_reader(gadget::SerialStreamReader::isSupported());
+   if ( ! use_reader )
+   {
+      std::cout << "gadget::SerialStreamReader is not supported; skipping "
+                << "the reader runs" << std::endl;
+   }
+
+   bool ok(true);
+
+   if ( driver == "all" || driver == "fastrak" )
+   {
+      benchFastrak(settings, samples);
+   }
+
+   if ( driver == "all" || driver == "pinchglove" )
+   {
+      benchPinchGlove(settings, samples, rate);
+
+      if ( use_reader )
+      {
+         ok = benchPinchGloveReader(settings, samples, rate, 0) && ok;
+      }
+   }
+
+   if ( driver == "all" || driver == "flock" )
+   {
+      ok = benchFlock(settings, samples, rate, 0) && ok;
+
+      if ( use_reader )
+      {
+         ok = benchFlockReader(settings, samples, rate, 0) && ok;
+      }
+   }
+
+   if ( fault_interval > 0 )
+   {
+      std::cout << "Framing checks, one in " << fault_interval
+                << " records damaged" << std::endl;
+
+      if ( use_reader && (driver == "all" || driver == "pinchglove") )
+      {
+         ok = benchPinchGloveReader(settings, CHECK_SAMPLES, rate,
+                                    fault_interval) && ok;
+      }
+
+      if ( driver == "all" || driver == "flock" )
+      {
+         ok = benchFlock(settings, CHECK_SAMPLES, rate, fault_interval) && ok;
+
+         if ( use_reader )
+         {
+            ok = benchFlockReader(settings, CHECK_SAMPLES, rate,
+                                  fault_interval) && ok;
+         }
+      }
+   }
+
+   return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
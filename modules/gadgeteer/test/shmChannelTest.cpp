@@ -0,0 +1,192 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <vpr/IO/IOException.h>
+#include <vpr/Util/Interval.h>
+
+#include <gadget/SharedMemoryChannel.h>
+
+
+/*
+ * Round-trip test for gadget::SharedMemoryChannel.  The parent creates a
+ * channel and forks a child that attaches to it and echoes every message
+ * back.  Each message is a 12-byte header (like a cluster packet) followed by
+ * a body of varying size, so both small and ring-wrapping transfers are
+ * exercised.  The contents of every echo are verified and the average round
+ * trip time is printed.
+ *
+ * Usage: shmChannelTest [iterations]
+ */
+
+namespace
+{
+
+const vpr::Uint32 HEADER_SIZE(12);
+
+void fillMessage(std::vector<vpr::Uint8>& msg, const unsigned int seq)
+{
+   const vpr::Uint32 body_size = (seq * 7919) % 4096;
+   msg.resize(HEADER_SIZE + body_size);
+   std::memcpy(&msg[0], &body_size, sizeof(body_size));
+   std::memcpy(&msg[4], &seq, sizeof(seq));
+
+   for ( vpr::Uint32 i = 8; i < msg.size(); ++i )
+   {
+      msg[i] = static_cast<vpr::Uint8>(seq + i);
+   }
+}
+
+void recvMessage(gadget::SharedMemoryChannelPtr channel,
+                 std::vector<vpr::Uint8>& msg)
+{
+   msg.resize(HEADER_SIZE);
+   channel->recvn(&msg[0], HEADER_SIZE);
+
+   vpr::Uint32 body_size;
+   std::memcpy(&body_size, &msg[0], sizeof(body_size));
+   msg.resize(HEADER_SIZE + body_size);
+
+   if ( body_size > 0 )
+   {
+      channel->recvn(&msg[HEADER_SIZE], body_size);
+   }
+}
+
+int runEcho(const std::string& name, const unsigned int iterations)
+{
+   try
+   {
+      gadget::SharedMemoryChannelPtr channel =
+         gadget::SharedMemoryChannel::attach(name);
+
+      std::vector<vpr::Uint8> msg;
+      for ( unsigned int i = 0; i < iterations; ++i )
+      {
+         recvMessage(channel, msg);
+         channel->send(&msg[0], msg.size());
+      }
+   }
+   catch (vpr::IOException& ex)
+   {
+      std::cerr << "Echo process failed: " << ex.what() << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   if ( ! gadget::SharedMemoryChannel::isSupported() )
+   {
+      std::cout << "Shared memory channels are not supported here."
+                << std::endl;
+      return EXIT_SUCCESS;
+   }
+
+   const unsigned int iterations = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+   // Use a small ring so that the larger messages wrap around it.
+   gadget::SharedMemoryChannelPtr channel =
+      gadget::SharedMemoryChannel::create(16 * 1024);
+
+   const pid_t child = fork();
+   if ( child < 0 )
+   {
+      std::cerr << "fork() failed" << std::endl;
+      return EXIT_FAILURE;
+   }
+   else if ( 0 == child )
+   {
+      // The inherited copy of the creator's channel is left alone.
+      // Destroying it would close the channel for the parent.
+      _exit(runEcho(channel->getName(), iterations));
+   }
+
+   int status(EXIT_SUCCESS);
+   std::vector<vpr::Uint8> sent, received;
+
+   try
+   {
+      // Wait for the child to attach before the name is removed.
+      fillMessage(sent, 0);
+      channel->send(&sent[0], sent.size());
+      recvMessage(channel, received);
+      channel->unlink();
+
+      const vpr::Interval start(vpr::Interval::now());
+
+      for ( unsigned int i = 1; i < iterations; ++i )
+      {
+         fillMessage(sent, i);
+         channel->send(&sent[0], sent.size());
+         recvMessage(channel, received);
+
+         if ( sent != received )
+         {
+            std::cerr << "Message " << i << " was corrupted" << std::endl;
+            status = EXIT_FAILURE;
+            break;
+         }
+      }
+
+      const vpr::Interval elapsed(vpr::Interval::now() - start);
+      if ( iterations > 1 && EXIT_SUCCESS == status )
+      {
+         std::cout << iterations - 1 << " round trips, "
+                   << elapsed.usecf() / (iterations - 1) << " us each"
+                   << std::endl;
+      }
+   }
+   catch (vpr::IOException& ex)
+   {
+      std::cerr << "Test failed: " << ex.what() << std::endl;
+      status = EXIT_FAILURE;
+   }
+
+   channel->close();
+
+   int child_status(0);
+   waitpid(child, &child_status, 0);
+   if ( ! WIFEXITED(child_status) || WEXITSTATUS(child_status) != 0 )
+   {
+      status = EXIT_FAILURE;
+   }
+
+   std::cout << (EXIT_SUCCESS == status ? "PASSED" : "FAILED") << std::endl;
+   return status;
+}
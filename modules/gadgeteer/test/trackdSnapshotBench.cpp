@@ -0,0 +1,274 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Torn read benchmark for the trackd shared memory readers.  A child process
+ * plays trackd and rewrites every sensor of a private segment field by field
+ * as fast as it can (or at -w updates per second), setting all the fields of
+ * every sensor to the same update number.  The parent reads the segment the
+ * old way, one sensor in place at a time, and with
+ * trackd_tracker_snapshot(), and reports how many reads mixed two updates
+ * and what each read cost.
+ *
+ * A snapshot only catches updates that happen while it is being made.  If
+ * the writer is preempted in the middle of an update, the half-written data
+ * stays put and looks consistent, since trackd keeps no sequence counter that
+ * would give it away.  On a uniprocessor the unpaced writer is almost always
+ * preempted that way, so use -w there to see the effect of the snapshots.
+ *
+ * Usage: trackdSnapshotBench [-k shm key] [-s sensors] [-n reads]
+ *                            [-w writer updates per second]
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/wait.h>
+
+#include <vpr/vpr.h>
+#include <vpr/Util/Interval.h>
+
+#include <drivers/Open/Trackd/trackdmem.h>
+
+
+namespace
+{
+
+const int MAX_SENSORS(30);
+
+struct TrackerSegment
+{
+   CAVE_TRACKDTRACKER_HEADER header;
+   CAVE_SENSOR_ST            sensor[MAX_SENSORS];
+};
+
+void runWriter(TrackerSegment* segment, const int numSensors,
+               const double rate)
+{
+   volatile CAVE_SENSOR_ST* sensors = segment->sensor;
+   volatile CAVE_TRACKDTRACKER_HEADER* header = &segment->header;
+   const useconds_t pause(rate > 0.0 ? static_cast<useconds_t>(1e6 / rate)
+                                     : 0);
+
+   // Float fields hold the update number exactly up to 2^24.
+   for ( vpr::Uint32 n = 1; ; n = (n + 1) & 0xffffff )
+   {
+      for ( int i = 0; i < numSensors; ++i )
+      {
+         const float value(static_cast<float>(n));
+         sensors[i].x     = value;
+         sensors[i].y     = value;
+         sensors[i].z     = value;
+         sensors[i].azim  = value;
+         sensors[i].elev  = value;
+         sensors[i].roll  = value;
+         sensors[i].frame = n;
+      }
+
+      header->timestamp[1] = n;
+
+      if ( pause > 0 )
+      {
+         usleep(pause);
+      }
+   }
+}
+
+/** Returns true if the sensor holds the fields of more than one update. */
+bool isTorn(const CAVE_SENSOR_ST& sensor)
+{
+   const float value(static_cast<float>(sensor.frame));
+   return sensor.x != value || sensor.y != value || sensor.z != value ||
+          sensor.azim != value || sensor.elev != value ||
+          sensor.roll != value;
+}
+
+struct Result
+{
+   Result()
+      : tornPoses(0)
+      , tornFrames(0)
+      , failed(0)
+   {
+   }
+
+   unsigned long tornPoses;   /**< Reads with a sensor mixing updates */
+   unsigned long tornFrames;  /**< Reads with sensors from different updates */
+   unsigned long failed;      /**< Reads that gave up */
+   vpr::Interval time;
+};
+
+/** Tallies one read of \p count sensors. */
+void check(const std::vector<CAVE_SENSOR_ST>& sensors, const int count,
+           Result& result)
+{
+   bool torn_pose(false), torn_frame(false);
+   for ( int i = 0; i < count; ++i )
+   {
+      torn_pose  = torn_pose || isTorn(sensors[i]);
+      torn_frame = torn_frame || sensors[i].frame != sensors[0].frame;
+   }
+
+   result.tornPoses  += torn_pose ? 1 : 0;
+   result.tornFrames += torn_frame ? 1 : 0;
+}
+
+void report(const char* name, const Result& result, const unsigned long reads)
+{
+   std::cout << std::setw(10) << std::left << name << std::right
+             << std::setw(10) << result.tornPoses
+             << std::setw(11) << result.tornFrames
+             << std::setw(9) << result.failed
+             << std::setw(11) << std::fixed << std::setprecision(1)
+             << result.time.usecf() * 1000.0 / reads << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   int key(0x7ac0);
+   int num_sensors(4);
+   unsigned long reads(1000000);
+   double rate(0.0);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-k") == 0 )
+      {
+         key = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-s") == 0 )
+      {
+         num_sensors = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         reads = std::strtoul(argv[i + 1], NULL, 10);
+      }
+      else if ( std::strcmp(argv[i], "-w") == 0 )
+      {
+         rate = std::atof(argv[i + 1]);
+      }
+   }
+
+   if ( num_sensors < 1 || num_sensors > MAX_SENSORS )
+   {
+      std::cerr << "The number of sensors must be between 1 and "
+                << MAX_SENSORS << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   const int shmid = shmget(key, sizeof(TrackerSegment),
+                            0600 | IPC_CREAT | IPC_EXCL);
+   if ( shmid < 0 )
+   {
+      perror("shmget");
+      return EXIT_FAILURE;
+   }
+
+   TrackerSegment* segment =
+      static_cast<TrackerSegment*>(shmat(shmid, NULL, 0));
+
+   // The segment goes away with the last detach once the reader is attached.
+   TrackerConnection* connection = trackd_tracker_attach(key);
+   shmctl(shmid, IPC_RMID, NULL);
+
+   if ( segment == reinterpret_cast<TrackerSegment*>(-1) ||
+        NULL == connection )
+   {
+      perror("shmat");
+      return EXIT_FAILURE;
+   }
+
+   std::memset(segment, 0, sizeof(TrackerSegment));
+   segment->header.version      = CAVELIB_2_6;
+   segment->header.numSensors   = num_sensors;
+   segment->header.sensorOffset = sizeof(CAVE_TRACKDTRACKER_HEADER);
+   segment->header.sensorSize   = sizeof(CAVE_SENSOR_ST);
+
+   const pid_t writer = fork();
+   if ( writer < 0 )
+   {
+      perror("fork");
+      return EXIT_FAILURE;
+   }
+   else if ( writer == 0 )
+   {
+      runWriter(segment, num_sensors, rate);
+      _exit(0);
+   }
+
+   std::vector<CAVE_SENSOR_ST> sensors(num_sensors);
+   Result in_place, snapshot;
+
+   vpr::Interval start(vpr::Interval::now());
+   for ( unsigned long r = 0; r < reads; ++r )
+   {
+      for ( int i = 0; i < num_sensors; ++i )
+      {
+         sensors[i] = *trackd_tracker_sensor(connection, i);
+      }
+      check(sensors, num_sensors, in_place);
+   }
+   in_place.time = vpr::Interval::now() - start;
+
+   start = vpr::Interval::now();
+   for ( unsigned long r = 0; r < reads; ++r )
+   {
+      const int count = trackd_tracker_snapshot(connection, &sensors[0],
+                                                num_sensors);
+      if ( count < 0 )
+      {
+         ++snapshot.failed;
+      }
+      else
+      {
+         check(sensors, count, snapshot);
+      }
+   }
+   snapshot.time = vpr::Interval::now() - start;
+
+   kill(writer, SIGTERM);
+   waitpid(writer, NULL, 0);
+   trackd_tracker_release(connection);
+   shmdt(segment);
+
+   std::cout << reads << " reads of " << num_sensors << " sensors, writer "
+             << (rate > 0.0 ? "paced" : "unpaced") << "\n\n"
+             << "method    torn pose  torn frame  gave up  ns/read\n";
+   report("in place", in_place, reads);
+   report("snapshot", snapshot, reads);
+
+   return EXIT_SUCCESS;
+}
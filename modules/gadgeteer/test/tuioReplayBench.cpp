@@ -0,0 +1,468 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Loopback replay benchmark for the TUIO driver.  A recording of /tuio/2Dcur
+ * traffic is generated up front: a number of cursors that all move every
+ * frame, with one cursor lifted and a new one put down every ten frames.
+ * Frames that do not fit in one datagram are split across several bundles.
+ * As with the reference TUIO server, only the last bundle of a frame carries
+ * the frame sequence number; the others carry -1.  The recording
+ * is then sent over loopback UDP at a fixed frame rate to a TuioStandalone
+ * that is serviced by gadget::IOReactor, the same way the Tuio driver reads
+ * it.
+ *
+ * Every cursor's x position encodes the frame that set it, so the receiver
+ * can tell whether a published frame was complete.  The number of frames
+ * published, the frames that were incomplete or had the wrong number of
+ * cursors, the CPU time spent receiving per frame and the time from sending
+ * a frame to publishing it are reported.
+ *
+ * Usage: tuioReplayBench [-c cursors] [-r frame rate] [-n frames]
+ *                        [-m max datagram size] [-p port]
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <vpr/vpr.h>
+#include <vpr/System.h>
+#include <vpr/IO/Socket/SocketDatagram.h>
+#include <vpr/IO/Socket/InetAddr.h>
+#include <vpr/Sync/Guard.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Util/Interval.h>
+
+#include <gadget/Util/IOReactor.h>
+
+#include <drivers/Open/TUIO/TuioStandalone.h>
+
+#include "BenchTiming.h"
+
+
+namespace
+{
+
+/** Size of a 2Dcur set message within a bundle. */
+const unsigned int SET_MESSAGE_SIZE(56);
+
+/** Size of a 2Dcur fseq message within a bundle. */
+const unsigned int FSEQ_MESSAGE_SIZE(32);
+
+/** Returns the x position that every cursor has in the given frame. */
+float frameX(const vpr::Int32 frame)
+{
+   return static_cast<float>(frame % 1000) / 1000.0f;
+}
+
+/** Writes the few kinds of OSC messages that TUIO trackers send. */
+class BundleWriter
+{
+public:
+   BundleWriter()
+      : mMessageStart(0)
+   {
+   }
+
+   /** Starts a bundle with the "immediately" time tag. */
+   void begin()
+   {
+      mData.clear();
+      putString("#bundle");
+      putInt32(0);
+      putInt32(1);
+   }
+
+   void beginMessage(const char* address, const std::string& typeTags)
+   {
+      mMessageStart = mData.size();
+      putInt32(0);
+      putString(address);
+      putString(typeTags.c_str());
+   }
+
+   void endMessage()
+   {
+      const vpr::Uint32 size(
+         vpr::System::Htonl(mData.size() - mMessageStart - 4)
+      );
+      std::memcpy(&mData[mMessageStart], &size, 4);
+   }
+
+   void putString(const char* str)
+   {
+      const std::size_t length(std::strlen(str) + 1);
+      mData.insert(mData.end(), str, str + length);
+      mData.resize((mData.size() + 3) & ~std::size_t(3), '\0');
+   }
+
+   void putInt32(const vpr::Int32 value)
+   {
+      const vpr::Uint32 swapped(vpr::System::Htonl(value));
+      const char* bytes(reinterpret_cast<const char*>(&swapped));
+      mData.insert(mData.end(), bytes, bytes + 4);
+   }
+
+   void putFloat(const float value)
+   {
+      vpr::Int32 bits;
+      std::memcpy(&bits, &value, 4);
+      putInt32(bits);
+   }
+
+   std::size_t size() const
+   {
+      return mData.size();
+   }
+
+   const std::vector<char>& data() const
+   {
+      return mData;
+   }
+
+private:
+   std::vector<char> mData;
+   std::size_t       mMessageStart;
+};
+
+struct Datagram
+{
+   std::vector<char> data;
+   vpr::Int32        frame;
+};
+
+/** Generates the recording.  Frame numbers start at 1. */
+void record(const unsigned int cursors, const unsigned int frames,
+            const unsigned int maxSize, std::vector<Datagram>& datagrams)
+{
+   std::vector<vpr::Int32> sessions;
+   vpr::Int32 next_session(0);
+   for ( unsigned int i = 0; i < cursors; ++i )
+   {
+      sessions.push_back(next_session++);
+   }
+
+   const std::string alive_tags(",s" + std::string(cursors, 'i'));
+   BundleWriter bundle;
+
+   for ( vpr::Int32 frame = 1; frame <= static_cast<vpr::Int32>(frames);
+         ++frame )
+   {
+      if ( frame % 10 == 0 && ! sessions.empty() )
+      {
+         sessions.erase(sessions.begin());
+         sessions.push_back(next_session++);
+      }
+
+      std::size_t cursor(0);
+      do
+      {
+         bundle.begin();
+         bundle.beginMessage("/tuio/2Dcur", alive_tags);
+         bundle.putString("alive");
+         for ( std::size_t i = 0; i < sessions.size(); ++i )
+         {
+            bundle.putInt32(sessions[i]);
+         }
+         bundle.endMessage();
+
+         while ( cursor < sessions.size() &&
+                 bundle.size() + SET_MESSAGE_SIZE + FSEQ_MESSAGE_SIZE <=
+                    maxSize )
+         {
+            bundle.beginMessage("/tuio/2Dcur", ",sifffff");
+            bundle.putString("set");
+            bundle.putInt32(sessions[cursor]);
+            bundle.putFloat(frameX(frame));
+            bundle.putFloat(static_cast<float>(sessions[cursor] % 1000) /
+                               1000.0f);
+            bundle.putFloat(0.1f);
+            bundle.putFloat(0.1f);
+            bundle.putFloat(0.0f);
+            bundle.endMessage();
+            ++cursor;
+         }
+
+         bundle.beginMessage("/tuio/2Dcur", ",si");
+         bundle.putString("fseq");
+         bundle.putInt32(cursor < sessions.size() ? -1 : frame);
+         bundle.endMessage();
+
+         Datagram datagram;
+         datagram.data  = bundle.data();
+         datagram.frame = frame;
+         datagrams.push_back(datagram);
+      }
+      while ( cursor < sessions.size() );
+   }
+}
+
+class Receiver
+{
+public:
+   Receiver(const unsigned int cursors, const unsigned int frames)
+      : mCursors(cursors)
+      , mSendTimes(frames + 1)
+      , mPublished(frames + 1, 0)
+      , mFrames(0)
+      , mIncomplete(0)
+      , mWrongCount(0)
+      , mCpuTime(0.0)
+   {
+      mLatencies.reserve(frames);
+   }
+
+   TuioStandalone& tracker()
+   {
+      return mTracker;
+   }
+
+   void setSendTime(const vpr::Int32 frame, const vpr::Interval& time)
+   {
+      vpr::Guard<vpr::Mutex> g(mLock);
+      mSendTimes[frame] = time;
+   }
+
+   /** gadget::IOReactor callback.  Does what Tuio::sample() does. */
+   void onReadable(const vpr::Interval&)
+   {
+      const double cpu_start(threadCpuTime());
+
+      while ( mTracker.updateData() )
+      {
+         const vpr::Interval done(vpr::Interval::now());
+         const vpr::Int32 frame(mTracker.getFrame());
+         const std::vector<TuioPoint>& cursors = mTracker.getCursors();
+         const float x(frameX(frame));
+
+         unsigned int active(0);
+         bool complete(true);
+         for ( std::size_t i = 0; i < cursors.size(); ++i )
+         {
+            if ( cursors[i].getSessionID() != TuioStandalone::FREE_SESSION )
+            {
+               ++active;
+               complete = complete && cursors[i].getXpos() == x;
+            }
+         }
+
+         vpr::Guard<vpr::Mutex> g(mLock);
+         ++mFrames;
+         if ( frame <= 0 ||
+              static_cast<std::size_t>(frame) >= mPublished.size() )
+         {
+            continue;
+         }
+
+         ++mPublished[frame];
+         if ( ! complete )
+         {
+            ++mIncomplete;
+         }
+         else
+         {
+            mLatencies.push_back((done - mSendTimes[frame]).usecf());
+         }
+         if ( active != mCursors )
+         {
+            ++mWrongCount;
+         }
+      }
+
+      vpr::Guard<vpr::Mutex> g(mLock);
+      mCpuTime += threadCpuTime() - cpu_start;
+   }
+
+   void report(const std::size_t datagrams)
+   {
+      vpr::Guard<vpr::Mutex> g(mLock);
+
+      const std::size_t sent(mPublished.size() - 1);
+      std::size_t missing(0);
+      for ( std::size_t i = 1; i < mPublished.size(); ++i )
+      {
+         if ( mPublished[i] == 0 )
+         {
+            ++missing;
+         }
+      }
+
+      std::cout << sent << " frames in " << datagrams << " datagrams, "
+                << mCursors << " cursors" << std::endl
+                << "   published " << mFrames << " samples, " << missing
+                << " frames missing, " << mIncomplete << " incomplete, "
+                << mWrongCount << " with the wrong cursor count" << std::endl
+                << "   CPU: " << mCpuTime * 1000.0 << " ms, "
+                << mCpuTime * 1e6 / sent << " us per frame" << std::endl;
+
+      if ( mLatencies.empty() )
+      {
+         return;
+      }
+
+      std::sort(mLatencies.begin(), mLatencies.end());
+      double sum(0.0);
+      for ( std::size_t i = 0; i < mLatencies.size(); ++i )
+      {
+         sum += mLatencies[i];
+      }
+
+      std::cout << "   latency (us): mean " << sum / mLatencies.size()
+                << ", median " << mLatencies[mLatencies.size() / 2]
+                << ", 99% " << mLatencies[mLatencies.size() * 99 / 100]
+                << ", max " << mLatencies.back() << std::endl;
+   }
+
+private:
+   TuioStandalone             mTracker;
+   unsigned int               mCursors;
+   vpr::Mutex                 mLock;
+   std::vector<vpr::Interval> mSendTimes;
+   std::vector<unsigned int>  mPublished;
+   std::vector<float>         mLatencies;
+   std::size_t                mFrames;
+   std::size_t                mIncomplete;
+   std::size_t                mWrongCount;
+   double                     mCpuTime;
+};
+
+/** Sends the recording at the given frame rate. */
+void replay(const std::vector<Datagram>& datagrams, const float rate,
+            const vpr::Uint16 port, Receiver& receiver)
+{
+   vpr::InetAddr to;
+   to.setAddress("127.0.0.1", port);
+
+   vpr::SocketDatagram socket;
+   socket.open();
+
+   const Pacer pacer(rate);
+
+   std::size_t d(0);
+   while ( d < datagrams.size() )
+   {
+      const vpr::Int32 frame(datagrams[d].frame);
+      receiver.setSendTime(frame, pacer.wait(frame - 1));
+      for ( ; d < datagrams.size() && datagrams[d].frame == frame; ++d )
+      {
+         socket.sendto(&datagrams[d].data[0], datagrams[d].data.size(), to);
+      }
+   }
+
+   socket.close();
+
+   // Give the receiver a moment to catch up.
+   vpr::System::msleep(100);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   unsigned int cursors(32);
+   float rate(200.0f);
+   unsigned int frames(2000);
+   unsigned int max_size(1472);
+   vpr::Uint16 port(DEFAULT_PORT);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-c") == 0 )
+      {
+         cursors = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-r") == 0 )
+      {
+         rate = static_cast<float>(std::atof(argv[i + 1]));
+      }
+      else if ( std::strcmp(argv[i], "-n") == 0 )
+      {
+         frames = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-m") == 0 )
+      {
+         max_size = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-p") == 0 )
+      {
+         port = static_cast<vpr::Uint16>(std::atoi(argv[i + 1]));
+      }
+   }
+
+   if ( rate <= 0.0f || frames == 0 )
+   {
+      std::cerr << "Nothing to replay" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   // The alive message for all cursors has to fit next to one set message.
+   const unsigned int min_size(64 + 5 * cursors + SET_MESSAGE_SIZE +
+                               FSEQ_MESSAGE_SIZE);
+   if ( max_size < min_size || max_size > 65507 )
+   {
+      std::cerr << "The datagram size must be between " << min_size
+                << " and 65507 bytes" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   std::vector<Datagram> datagrams;
+   record(cursors, frames, max_size, datagrams);
+
+   try
+   {
+      Receiver receiver(cursors, frames);
+      if ( ! receiver.tracker().open(port, cursors) )
+      {
+         std::cerr << "Could not bind to port " << port << std::endl;
+         return EXIT_FAILURE;
+      }
+
+      gadget::IOReactor::instance()->registerHandle(
+         receiver.tracker().getHandle(),
+         boost::bind(&Receiver::onReadable, &receiver, _1)
+      );
+
+      replay(datagrams, rate, port, receiver);
+
+      gadget::IOReactor::instance()->unregisterHandle(
+         receiver.tracker().getHandle()
+      );
+      receiver.tracker().close();
+      receiver.report(datagrams.size());
+   }
+   catch (vpr::Exception& ex)
+   {
+      std::cerr << "Benchmark failed: " << ex.what() << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
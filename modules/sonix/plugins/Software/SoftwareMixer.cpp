@@ -0,0 +1,361 @@
+/****************** <SNX heading BEGIN do not edit this line> *****************
+ *
+ * sonix
+ *
+ * Original Authors:
+ *   Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <SNX heading END do not edit this line> ******************/
+
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <snx/PluginConfig.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "SoftwareMixer.h"
+
+
+namespace
+{
+
+/** Distance at which positional voices play at full gain. */
+const float REFERENCE_DISTANCE_SQ(1.0f);
+
+/** Lowest legal pitch.  Zero or less would stall the read cursor. */
+const float MIN_PITCH(0.001f);
+
+}
+
+namespace snx
+{
+
+SoftwareMixer::SoftwareMixer()
+   : mSampleRate(22050)
+   , mChannels(2)
+   , mBlockSize(256)
+   , mVoiceBlocksMixed(0)
+   , mBlocksMixed(0)
+{
+   for ( unsigned int i = 0; i < 16; ++i )
+   {
+      mListener[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+   }
+
+   setFormat(mSampleRate, mChannels, mBlockSize);
+}
+
+void SoftwareMixer::setFormat(const unsigned int sampleRate,
+                              const unsigned int channels,
+                              const unsigned int blockSize)
+{
+   mSampleRate = sampleRate;
+   mChannels   = channels < 2 ? 1 : 2;
+   mBlockSize  = blockSize > 0 ? blockSize : 1;
+
+   mLeft.resize(mBlockSize);
+   mRight.resize(mBlockSize);
+}
+
+std::size_t SoftwareMixer::allocVoice()
+{
+   if ( ! mFreeVoices.empty() )
+   {
+      const std::size_t voice = mFreeVoices.back();
+      mFreeVoices.pop_back();
+      mInUse[voice] = 1;
+      return voice;
+   }
+
+   mSource.push_back(NULL);
+   mPosX.push_back(0.0f);
+   mPosY.push_back(0.0f);
+   mPosZ.push_back(0.0f);
+   mGain.push_back(1.0f);
+   mPitch.push_back(1.0f);
+   mAmbient.push_back(0.0f);
+   mGainLeft.push_back(0.0f);
+   mGainRight.push_back(0.0f);
+   mCursor.push_back(0.0);
+   mRepeat.push_back(0);
+   mPlaying.push_back(0);
+   mPaused.push_back(0);
+   mInUse.push_back(1);
+
+   return mSource.size() - 1;
+}
+
+void SoftwareMixer::freeVoice(const std::size_t voice)
+{
+   stop(voice);
+   mSource[voice]  = NULL;
+   mPosX[voice]    = 0.0f;
+   mPosY[voice]    = 0.0f;
+   mPosZ[voice]    = 0.0f;
+   mGain[voice]    = 1.0f;
+   mPitch[voice]   = 1.0f;
+   mAmbient[voice] = 0.0f;
+   mInUse[voice]   = 0;
+   mFreeVoices.push_back(voice);
+}
+
+void SoftwareMixer::setSource(const std::size_t voice, const Source* source)
+{
+   mSource[voice] = source;
+   mCursor[voice] = 0.0;
+}
+
+void SoftwareMixer::setPosition(const std::size_t voice, const float x,
+                                const float y, const float z)
+{
+   mPosX[voice] = x;
+   mPosY[voice] = y;
+   mPosZ[voice] = z;
+}
+
+void SoftwareMixer::setGain(const std::size_t voice, const float gain)
+{
+   mGain[voice] = gain;
+}
+
+void SoftwareMixer::setPitch(const std::size_t voice, const float pitch)
+{
+   mPitch[voice] = pitch < MIN_PITCH ? MIN_PITCH : pitch;
+}
+
+void SoftwareMixer::setAmbient(const std::size_t voice, const bool ambient)
+{
+   mAmbient[voice] = ambient ? 1.0f : 0.0f;
+}
+
+void SoftwareMixer::play(const std::size_t voice, const int repeat)
+{
+   mCursor[voice]  = 0.0;
+   mRepeat[voice]  = repeat == 0 ? 1 : repeat;
+   mPlaying[voice] = 1;
+   mPaused[voice]  = 0;
+}
+
+void SoftwareMixer::stop(const std::size_t voice)
+{
+   mCursor[voice]  = 0.0;
+   mRepeat[voice]  = 0;
+   mPlaying[voice] = 0;
+   mPaused[voice]  = 0;
+}
+
+void SoftwareMixer::pause(const std::size_t voice)
+{
+   if ( mPlaying[voice] )
+   {
+      mPaused[voice] = 1;
+   }
+}
+
+void SoftwareMixer::unpause(const std::size_t voice)
+{
+   mPaused[voice] = 0;
+}
+
+bool SoftwareMixer::isPlaying(const std::size_t voice) const
+{
+   return mPlaying[voice] != 0;
+}
+
+bool SoftwareMixer::isPaused(const std::size_t voice) const
+{
+   return mPaused[voice] != 0;
+}
+
+void SoftwareMixer::setListener(const float worldToListener[16])
+{
+   std::copy(worldToListener, worldToListener + 16, mListener);
+}
+
+std::size_t SoftwareMixer::mixBlock(float* out)
+{
+   const std::size_t count(mSource.size());
+
+   std::fill(mLeft.begin(), mLeft.end(), 0.0f);
+   std::fill(mRight.begin(), mRight.end(), 0.0f);
+
+   computeGains(count);
+
+   std::size_t active(0);
+   for ( std::size_t v = 0; v < count; ++v )
+   {
+      if ( mPlaying[v] && ! mPaused[v] && NULL != mSource[v] &&
+           mSource[v]->frames() > 0 )
+      {
+         mixVoice(v, mBlockSize);
+         ++active;
+      }
+   }
+
+   if ( mChannels == 2 )
+   {
+      for ( unsigned int i = 0; i < mBlockSize; ++i )
+      {
+         out[2 * i]     = mLeft[i];
+         out[2 * i + 1] = mRight[i];
+      }
+   }
+   else
+   {
+      std::copy(mLeft.begin(), mLeft.end(), out);
+   }
+
+   mVoiceBlocksMixed += active;
+   ++mBlocksMixed;
+
+   return active;
+}
+
+// This loop is deliberately free of branches and calls other than sqrt so
+// that it vectorizes.  It runs over every slot, including idle ones, which
+// is cheaper than compacting the active set each block.
+void SoftwareMixer::computeGains(const std::size_t count)
+{
+   if ( 0 == count )
+   {
+      return;
+   }
+
+   const float* m(mListener);
+   const float* px(&mPosX[0]);
+   const float* py(&mPosY[0]);
+   const float* pz(&mPosZ[0]);
+   const float* gain(&mGain[0]);
+   const float* ambient(&mAmbient[0]);
+   float* gain_l(&mGainLeft[0]);
+   float* gain_r(&mGainRight[0]);
+
+   if ( mChannels == 2 )
+   {
+      for ( std::size_t i = 0; i < count; ++i )
+      {
+         const float lx = m[0] * px[i] + m[4] * py[i] + m[8]  * pz[i] + m[12];
+         const float ly = m[1] * px[i] + m[5] * py[i] + m[9]  * pz[i] + m[13];
+         const float lz = m[2] * px[i] + m[6] * py[i] + m[10] * pz[i] + m[14];
+
+         const float dist_sq = std::max(lx * lx + ly * ly + lz * lz,
+                                        REFERENCE_DISTANCE_SQ);
+         const float inv_dist   = 1.0f / std::sqrt(dist_sq);
+         const float positional = 1.0f - ambient[i];
+         const float atten      = ambient[i] + positional * inv_dist;
+         const float pan        = positional * lx * inv_dist;
+         const float g          = gain[i] * atten;
+
+         gain_l[i] = g * std::sqrt(0.5f * (1.0f - pan));
+         gain_r[i] = g * std::sqrt(0.5f * (1.0f + pan));
+      }
+   }
+   else
+   {
+      for ( std::size_t i = 0; i < count; ++i )
+      {
+         const float lx = m[0] * px[i] + m[4] * py[i] + m[8]  * pz[i] + m[12];
+         const float ly = m[1] * px[i] + m[5] * py[i] + m[9]  * pz[i] + m[13];
+         const float lz = m[2] * px[i] + m[6] * py[i] + m[10] * pz[i] + m[14];
+
+         const float dist_sq = std::max(lx * lx + ly * ly + lz * lz,
+                                        REFERENCE_DISTANCE_SQ);
+         const float inv_dist   = 1.0f / std::sqrt(dist_sq);
+         const float positional = 1.0f - ambient[i];
+
+         gain_l[i] = gain[i] * (ambient[i] + positional * inv_dist);
+         gain_r[i] = 0.0f;
+      }
+   }
+}
+
+void SoftwareMixer::mixVoice(const std::size_t voice, const std::size_t frames)
+{
+   const Source& src(*mSource[voice]);
+   const float* data(&src.samples[0]);
+   const double length(static_cast<double>(src.frames()));
+   const double step(src.sampleRate / static_cast<double>(mSampleRate) *
+                        mPitch[voice]);
+   const float gl(mGainLeft[voice]);
+   const float gr(mGainRight[voice]);
+   float* left(&mLeft[0]);
+   float* right(&mRight[0]);
+
+   double cursor(mCursor[voice]);
+   std::size_t done(0);
+
+   while ( done < frames )
+   {
+      // Number of output frames that can be produced before the cursor
+      // reaches the end of the source data.  Rounding can overshoot by one,
+      // so trim until the last read is in range.
+      std::size_t avail =
+         static_cast<std::size_t>(std::ceil((length - cursor) / step));
+      while ( avail > 0 && cursor + (avail - 1) * step >= length )
+      {
+         --avail;
+      }
+
+      const std::size_t n(std::min(avail, frames - done));
+      float* l(left + done);
+      float* r(right + done);
+
+      // The guard sample at the end of the source makes data[i + 1] safe.
+      for ( std::size_t j = 0; j < n; ++j )
+      {
+         const double pos(cursor + j * step);
+         const std::size_t i(static_cast<std::size_t>(pos));
+         const float frac(static_cast<float>(pos - i));
+         const float s(data[i] + frac * (data[i + 1] - data[i]));
+         l[j] += s * gl;
+         r[j] += s * gr;
+      }
+
+      cursor += n * step;
+      done   += n;
+
+      if ( cursor >= length )
+      {
+         if ( mRepeat[voice] == -1 || --mRepeat[voice] > 0 )
+         {
+            cursor = std::fmod(cursor - length, length);
+         }
+         else
+         {
+            mPlaying[voice] = 0;
+            mRepeat[voice]  = 0;
+            cursor = 0.0;
+            break;
+         }
+      }
+   }
+
+   mCursor[voice] = cursor;
+}
+
+} // End of snx namespace
@@ -0,0 +1,236 @@
+/****************** <SNX heading BEGIN do not edit this line> *****************
+ *
+ * sonix
+ *
+ * Original Authors:
+ *   Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <SNX heading END do not edit this line> ******************/
+
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef SNXSOFTWAREMIXER_H
+#define SNXSOFTWAREMIXER_H
+
+#include <cstddef>
+#include <vector>
+
+
+namespace snx
+{
+
+/** \class SoftwareMixer SoftwareMixer.h
+ *
+ * Block-based software mixer used by the Software Sonix plug-in.  All
+ * per-voice state is kept in parallel arrays (structure of arrays) so that
+ * the panning and distance attenuation pass runs as one branch-free loop
+ * over every voice.  The compiler can vectorize that loop, and it is the
+ * part of the mix whose cost grows with the number of spatialized sources.
+ *
+ * Voices are mono.  Each voice is resampled with linear interpolation from
+ * the rate of its source data to the output rate (scaled by the voice pitch)
+ * and accumulated into a stereo or mono output block.
+ */
+class SoftwareMixer
+{
+public:
+   /** Mono sample data shared by any number of voices. */
+   struct Source
+   {
+      Source()
+         : samples()
+         , sampleRate(22050.0f)
+      {
+      }
+
+      /**
+       * Sample data normalized to [-1,1].  One extra guard sample is kept at
+       * the end so that interpolation never reads past the buffer.
+       */
+      std::vector<float> samples;
+
+      /** Sample rate of \c samples in Hz. */
+      float sampleRate;
+
+      /** Returns the number of frames, not counting the guard sample. */
+      std::size_t frames() const
+      {
+         return samples.empty() ? 0 : samples.size() - 1;
+      }
+   };
+
+   SoftwareMixer();
+
+   /**
+    * Changes the output format.  Any voice that is currently playing keeps
+    * its position.
+    *
+    * @param sampleRate Output sample rate in Hz.
+    * @param channels   1 for mono output, 2 for stereo output.
+    * @param blockSize  Number of frames rendered by each call to mixBlock().
+    */
+   void setFormat(const unsigned int sampleRate, const unsigned int channels,
+                  const unsigned int blockSize);
+
+   unsigned int getSampleRate() const
+   {
+      return mSampleRate;
+   }
+
+   unsigned int getChannels() const
+   {
+      return mChannels;
+   }
+
+   unsigned int getBlockSize() const
+   {
+      return mBlockSize;
+   }
+
+   /**
+    * Allocates a voice slot and returns its index.  Slots released through
+    * freeVoice() are reused.
+    */
+   std::size_t allocVoice();
+
+   /** Stops the given voice and returns its slot to the free list. */
+   void freeVoice(const std::size_t voice);
+
+   /**
+    * Attaches sample data to a voice.  The source must outlive the voice or
+    * be detached by passing NULL.
+    */
+   void setSource(const std::size_t voice, const Source* source);
+
+   void setPosition(const std::size_t voice, const float x, const float y,
+                    const float z);
+
+   void setGain(const std::size_t voice, const float gain);
+
+   void setPitch(const std::size_t voice, const float pitch);
+
+   /**
+    * Ambient voices are not attenuated or panned; positional voices are
+    * attenuated with the inverse of their distance from the listener
+    * (clamped at the reference distance) and panned with an equal-power law.
+    */
+   void setAmbient(const std::size_t voice, const bool ambient);
+
+   /**
+    * Starts playback from the beginning of the source data.
+    *
+    * @param repeat Number of times to play the sound. -1 loops forever.
+    */
+   void play(const std::size_t voice, const int repeat);
+
+   void stop(const std::size_t voice);
+
+   void pause(const std::size_t voice);
+
+   void unpause(const std::size_t voice);
+
+   bool isPlaying(const std::size_t voice) const;
+
+   bool isPaused(const std::size_t voice) const;
+
+   /**
+    * Sets the listener transform.
+    *
+    * @param worldToListener Column-major 4x4 matrix that transforms world
+    *                        coordinates into the listener's coordinate frame
+    *                        (i.e., the inverse of the listener position).
+    */
+   void setListener(const float worldToListener[16]);
+
+   /**
+    * Renders one block.
+    *
+    * @param out Interleaved output buffer that must hold
+    *            getBlockSize() * getChannels() samples.  It is overwritten.
+    *
+    * @return The number of voices that contributed to the block.
+    */
+   std::size_t mixBlock(float* out);
+
+   /** Total number of voice-blocks mixed since construction. */
+   unsigned long long getVoiceBlocksMixed() const
+   {
+      return mVoiceBlocksMixed;
+   }
+
+   /** Total number of blocks mixed since construction. */
+   unsigned long long getBlocksMixed() const
+   {
+      return mBlocksMixed;
+   }
+
+private:
+   void computeGains(const std::size_t count);
+
+   /** Accumulates \p frames frames of \p voice into the work buffers. */
+   void mixVoice(const std::size_t voice, const std::size_t frames);
+
+   unsigned int mSampleRate;
+   unsigned int mChannels;
+   unsigned int mBlockSize;
+
+   float mListener[16];
+
+   /** @name Per-voice state, indexed by voice slot. */
+   //@{
+   std::vector<const Source*> mSource;
+   std::vector<float> mPosX;
+   std::vector<float> mPosY;
+   std::vector<float> mPosZ;
+   std::vector<float> mGain;
+   std::vector<float> mPitch;
+   std::vector<float> mAmbient;    /**< 1 for ambient, 0 for positional */
+   std::vector<float> mGainLeft;   /**< Output of computeGains() */
+   std::vector<float> mGainRight;  /**< Output of computeGains() */
+   std::vector<double> mCursor;    /**< Read position in source frames */
+   std::vector<int> mRepeat;       /**< Plays left; -1 is infinite */
+   std::vector<char> mPlaying;
+   std::vector<char> mPaused;
+   std::vector<char> mInUse;
+   //@}
+
+   std::vector<std::size_t> mFreeVoices;
+
+   /** @name Work buffers sized to one block. */
+   //@{
+   std::vector<float> mLeft;
+   std::vector<float> mRight;
+   //@}
+
+   unsigned long long mVoiceBlocksMixed;
+   unsigned long long mBlocksMixed;
+};
+
+} // End of snx namespace
+
+
+#endif /* SNXSOFTWAREMIXER_H */
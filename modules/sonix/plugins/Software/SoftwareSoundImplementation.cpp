@@ -0,0 +1,690 @@
+/****************** <SNX heading BEGIN do not edit this line> *****************
+ *
+ * sonix
+ *
+ * Original Authors:
+ *   Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <SNX heading END do not edit this line> ******************/
+
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <snx/PluginConfig.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gmtl/Matrix.h>
+#include <gmtl/MatrixOps.h>
+
+#include <vpr/System.h>
+#include <vpr/Util/Assert.h>
+#include <vpr/Util/Debug.h>
+
+#include <snx/SoundImplementation.h>
+#include <snx/SoundInfo.h>
+#include <snx/SoundFactory.h>
+#include <snx/Util/Debug.h>
+
+#include "SoftwareSoundImplementation.h"
+
+/////////////////////////
+// plugin API:
+#ifdef NO_SELF_REGISTER
+extern "C"
+{
+
+SNX_PLUGIN_EXPORT const char* getVersion()
+{
+   return "sonix xx.xx.xx";
+}
+
+SNX_PLUGIN_EXPORT const char* getName()
+{
+   return "Software";
+}
+
+SNX_PLUGIN_EXPORT snx::ISoundImplementation* newPlugin()
+{
+   return new snx::SoftwareSoundImplementation;
+}
+
+}
+#endif
+/////////////////////////
+
+namespace
+{
+
+const unsigned int DEFAULT_BLOCK_SIZE(256);
+
+vpr::Uint32 readLE32(const unsigned char* p)
+{
+   return vpr::Uint32(p[0]) | (vpr::Uint32(p[1]) << 8) |
+          (vpr::Uint32(p[2]) << 16) | (vpr::Uint32(p[3]) << 24);
+}
+
+vpr::Uint16 readLE16(const unsigned char* p)
+{
+   return vpr::Uint16(p[0] | (p[1] << 8));
+}
+
+void writeLE32(std::FILE* file, const vpr::Uint32 value)
+{
+   const unsigned char b[4] = {
+      (unsigned char) (value & 0xff), (unsigned char) ((value >> 8) & 0xff),
+      (unsigned char) ((value >> 16) & 0xff),
+      (unsigned char) ((value >> 24) & 0xff)
+   };
+   std::fwrite(b, 1, 4, file);
+}
+
+void writeLE16(std::FILE* file, const vpr::Uint16 value)
+{
+   const unsigned char b[2] = {
+      (unsigned char) (value & 0xff), (unsigned char) ((value >> 8) & 0xff)
+   };
+   std::fwrite(b, 1, 2, file);
+}
+
+/**
+ * Loads an uncompressed 8- or 16-bit PCM WAV file into \p source, mixing all
+ * channels down to mono.
+ */
+bool loadWav(const std::string& filename, snx::SoftwareMixer::Source& source)
+{
+   std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+
+   if ( ! in )
+   {
+      return false;
+   }
+
+   std::vector<unsigned char> file((std::istreambuf_iterator<char>(in)),
+                                   std::istreambuf_iterator<char>());
+
+   if ( file.size() < 12 || std::string(file.begin(), file.begin() + 4) != "RIFF" ||
+        std::string(file.begin() + 8, file.begin() + 12) != "WAVE" )
+   {
+      return false;
+   }
+
+   vpr::Uint16 format(0), channels(0), bits(0);
+   vpr::Uint32 rate(0);
+   const unsigned char* data(NULL);
+   vpr::Uint32 data_size(0);
+
+   std::size_t pos(12);
+   while ( pos + 8 <= file.size() )
+   {
+      const std::string id(file.begin() + pos, file.begin() + pos + 4);
+      const vpr::Uint32 size(readLE32(&file[pos + 4]));
+      const std::size_t body(pos + 8);
+
+      if ( body + size > file.size() )
+      {
+         break;
+      }
+
+      if ( id == "fmt " && size >= 16 )
+      {
+         format   = readLE16(&file[body]);
+         channels = readLE16(&file[body + 2]);
+         rate     = readLE32(&file[body + 4]);
+         bits     = readLE16(&file[body + 14]);
+      }
+      else if ( id == "data" )
+      {
+         data      = &file[body];
+         data_size = size;
+      }
+
+      // Chunks are padded to an even length.
+      pos = body + size + (size & 1);
+   }
+
+   // Only uncompressed PCM is supported.
+   if ( format != 1 || channels == 0 || rate == 0 || NULL == data ||
+        (bits != 8 && bits != 16) )
+   {
+      return false;
+   }
+
+   const std::size_t frame_bytes(channels * (bits / 8));
+   const std::size_t frames(data_size / frame_bytes);
+   const float scale(1.0f / channels);
+
+   source.sampleRate = static_cast<float>(rate);
+   source.samples.resize(frames + 1);
+
+   for ( std::size_t f = 0; f < frames; ++f )
+   {
+      const unsigned char* frame(data + f * frame_bytes);
+      float sum(0.0f);
+
+      for ( vpr::Uint16 c = 0; c < channels; ++c )
+      {
+         if ( bits == 8 )
+         {
+            sum += (frame[c] - 128) / 128.0f;
+         }
+         else
+         {
+            sum += static_cast<vpr::Int16>(readLE16(frame + 2 * c)) /
+                      32768.0f;
+         }
+      }
+
+      source.samples[f] = sum * scale;
+   }
+
+   // Guard sample for the interpolator.
+   source.samples[frames] = frames > 0 ? source.samples[frames - 1] : 0.0f;
+
+   return true;
+}
+
+}
+
+namespace snx
+{
+#ifndef NO_SELF_REGISTER
+snx::SoundFactoryReg<SoftwareSoundImplementation> softwareRegistrator("Software");
+#endif
+
+SoftwareSoundImplementation::SoftwareSoundImplementation()
+   : snx::SoundImplementation()
+   , mBindLookup()
+   , mMixer()
+   , mIsOpen(false)
+   , mPendingFrames(0.0)
+   , mSinkType(MEMORY_SINK)
+   , mWavFile(NULL)
+   , mWavDataBytes(0)
+   , mVoiceBlocks(0)
+   , mBlocks(0)
+   , mPeakVoices(0)
+{
+   /* Do nothing. */ ;
+}
+
+SoftwareSoundImplementation::~SoftwareSoundImplementation()
+{
+   this->shutdownAPI();
+}
+
+void SoftwareSoundImplementation::trigger(const std::string& alias,
+                                          const int repeat)
+{
+   vprASSERT(mIsOpen && "startAPI must be called prior to this function");
+
+   snx::SoundImplementation::trigger(alias, repeat);
+
+   // if sound data hasn't been loaded into sound API yet, then do so
+   if ( mBindLookup.count(alias) == 0 )
+   {
+      this->bind(alias);
+   }
+
+   // if data is bound (bind() succeeded), then play it.
+   lookup_map_t::iterator i = mBindLookup.find(alias);
+   if ( i != mBindLookup.end() )
+   {
+      const std::size_t voice((*i).second.voice);
+
+      if ( mMixer.isPaused(voice) )
+      {
+         mMixer.unpause(voice);
+      }
+      else if ( this->isRetriggerable(alias) || ! mMixer.isPlaying(voice) )
+      {
+         mMixer.play(voice, repeat);
+      }
+   }
+}
+
+bool SoftwareSoundImplementation::isPlaying(const std::string& alias) const
+{
+   lookup_map_t::const_iterator i = mBindLookup.find(alias);
+   return i != mBindLookup.end() && mMixer.isPlaying((*i).second.voice);
+}
+
+bool SoftwareSoundImplementation::isPaused(const std::string& alias) const
+{
+   lookup_map_t::const_iterator i = mBindLookup.find(alias);
+   return i != mBindLookup.end() && mMixer.isPaused((*i).second.voice);
+}
+
+void SoftwareSoundImplementation::stop(const std::string& alias)
+{
+   snx::SoundImplementation::stop(alias);
+
+   lookup_map_t::iterator i = mBindLookup.find(alias);
+   if ( i != mBindLookup.end() )
+   {
+      mMixer.stop((*i).second.voice);
+   }
+}
+
+void SoftwareSoundImplementation::pause(const std::string& alias)
+{
+   lookup_map_t::iterator i = mBindLookup.find(alias);
+   if ( i != mBindLookup.end() )
+   {
+      mMixer.pause((*i).second.voice);
+   }
+}
+
+void SoftwareSoundImplementation::unpause(const std::string& alias)
+{
+   lookup_map_t::iterator i = mBindLookup.find(alias);
+   if ( i != mBindLookup.end() )
+   {
+      mMixer.unpause((*i).second.voice);
+   }
+}
+
+void SoftwareSoundImplementation::setAmbient(const std::string& alias,
+                                             bool ambient)
+{
+   snx::SoundImplementation::setAmbient(alias, ambient);
+
+   lookup_map_t::iterator i = mBindLookup.find(alias);
+   if ( i != mBindLookup.end() )
+   {
+      mMixer.setAmbient((*i).second.voice, ambient);
+   }
+}
+
+void SoftwareSoundImplementation::setPitchBend(const std::string& alias,
+                                               float amount)
+{
+   snx::SoundImplementation::setPitchBend(alias, amount);
+
+   lookup_map_t::iterator i = mBindLookup.find(alias);
+   if ( i != mBindLookup.end() )
+   {
+      mMixer.setPitch((*i).second.voice, amount);
+   }
+}
+
+void SoftwareSoundImplementation::setVolume(const std::string& alias,
+                                            float amount)
+{
+   snx::SoundImplementation::setVolume(alias, amount);
+   this->updateGain(alias);
+}
+
+void SoftwareSoundImplementation::setCutoff(const std::string& alias,
+                                            float amount)
+{
+   // There is no filter in the mixer, so the cutoff is applied as gain the
+   // same way that the OpenAL plug-in does it.
+   snx::SoundImplementation::setCutoff(alias, amount);
+   this->updateGain(alias);
+}
+
+void SoftwareSoundImplementation::setPosition(const std::string& alias,
+                                              float x, float y, float z)
+{
+   snx::SoundImplementation::setPosition(alias, x, y, z);
+
+   lookup_map_t::iterator i = mBindLookup.find(alias);
+   if ( i != mBindLookup.end() )
+   {
+      mMixer.setPosition((*i).second.voice, x, y, z);
+   }
+}
+
+void SoftwareSoundImplementation::setListenerPosition(const gmtl::Matrix44f& mat)
+{
+   snx::SoundImplementation::setListenerPosition(mat);
+
+   gmtl::Matrix44f world_to_listener;
+   gmtl::invert(world_to_listener, mat);
+   mMixer.setListener(world_to_listener.getData());
+}
+
+int SoftwareSoundImplementation::startAPI()
+{
+   if ( mIsOpen )
+   {
+      vprDEBUG(snxDBG, vprDBG_CONFIG_LVL)
+         << clrOutNORM(clrYELLOW, "Software| WARNING: startAPI called when API is already started\n")
+         << vprDEBUG_FLUSH;
+      return 1;
+   }
+
+   unsigned int rate(22050), channels(2);
+   switch ( mSoundAPIInfo.sampleRate )
+   {
+      case snx::SoundAPIInfo::STEREO_22050_KHZ:
+         rate = 22050;
+         channels = 2;
+         break;
+      case snx::SoundAPIInfo::MONO_22050_KHZ:
+         rate = 22050;
+         channels = 1;
+         break;
+      case snx::SoundAPIInfo::STEREO_44100_KHZ:
+         rate = 44100;
+         channels = 2;
+         break;
+      case snx::SoundAPIInfo::MONO_44100_KHZ:
+         rate = 44100;
+         channels = 1;
+         break;
+   }
+
+   if ( mSoundAPIInfo.speakerConfig == snx::SoundAPIInfo::MONO )
+   {
+      channels = 1;
+   }
+
+   unsigned int block_size(DEFAULT_BLOCK_SIZE);
+   std::string block_size_str;
+   if ( vpr::System::getenv("SNX_SOFTWARE_BLOCK_SIZE", block_size_str) )
+   {
+      const int value = std::atoi(block_size_str.c_str());
+      if ( value > 0 )
+      {
+         block_size = static_cast<unsigned int>(value);
+      }
+   }
+
+   mMixer.setFormat(rate, channels, block_size);
+   mBlock.resize(block_size * channels);
+   mBlockPcm.resize(block_size * channels);
+   mPendingFrames = 0.0;
+
+   mMixTime.set(0, vpr::Interval::Usec);
+   mVoiceBlocks = 0;
+   mBlocks      = 0;
+   mPeakVoices  = 0;
+
+   this->openSink();
+   mIsOpen = true;
+
+   vprDEBUG(snxDBG, vprDBG_CONFIG_LVL)
+      << clrOutNORM(clrYELLOW, "Software| NOTICE:")
+      << " Software API started: [rate=" << rate << ",channels=" << channels
+      << ",block=" << block_size << "]\n" << vprDEBUG_FLUSH;
+
+   // init the listener...
+   this->setListenerPosition(mListenerPos);
+
+   return 1;
+}
+
+void SoftwareSoundImplementation::shutdownAPI()
+{
+   if ( ! mIsOpen )
+   {
+      return;
+   }
+
+   this->unbindAll();
+   this->closeSink();
+   mIsOpen = false;
+
+   vprDEBUG(snxDBG, vprDBG_CONFIG_LVL)
+      << clrOutNORM(clrYELLOW, "Software| NOTICE:")
+      << " Software API closed: mixed " << mBlocks << " blocks of "
+      << mMixer.getBlockSize() << " frames, peak " << mPeakVoices
+      << " voices, " << this->getVoicesPerCore() << " voices/core\n"
+      << vprDEBUG_FLUSH;
+}
+
+void SoftwareSoundImplementation::configure(const std::string& alias,
+                                            const snx::SoundInfo& description)
+{
+   snx::SoundImplementation::configure(alias, description);
+}
+
+void SoftwareSoundImplementation::bind(const std::string& alias)
+{
+   if ( ! mIsOpen )
+   {
+      vprDEBUG(snxDBG, vprDBG_CONFIG_LVL)
+         << clrOutNORM(clrRED, "ERROR")
+         << ": Software| API not started, bind() failed\n" << vprDEBUG_FLUSH;
+      return;
+   }
+
+   snx::SoundInfo& soundInfo = this->lookup(alias);
+
+   if ( mBindLookup.count(alias) > 0 )
+   {
+      this->unbind(alias);
+   }
+
+   switch ( soundInfo.datasource )
+   {
+      default:
+      case snx::SoundInfo::FILESYSTEM:
+      {
+         SwSoundInfo& info = mBindLookup[alias];
+
+         if ( ! loadWav(soundInfo.filename, info.source) )
+         {
+            vprDEBUG(snxDBG, vprDBG_WARNING_LVL)
+               << clrOutNORM(clrRED, "ERROR") << ": Software| Failed to load '"
+               << soundInfo.filename << "' (only PCM WAV files are supported)\n"
+               << vprDEBUG_FLUSH;
+            mBindLookup.erase(alias);
+            return;
+         }
+
+         info.voice = mMixer.allocVoice();
+         mMixer.setSource(info.voice, &info.source);
+
+         this->setAmbient(alias, soundInfo.ambient);
+         this->setPitchBend(alias, soundInfo.pitchbend);
+         this->setPosition(alias, soundInfo.position[0],
+                           soundInfo.position[1], soundInfo.position[2]);
+         this->updateGain(alias);
+         break;
+      }
+   }
+
+   // was it playing?  if so, then start it up again...
+   if ( soundInfo.triggerOnNextBind )
+   {
+      soundInfo.triggerOnNextBind = false;
+      this->trigger(alias, soundInfo.repeat);
+   }
+}
+
+void SoftwareSoundImplementation::unbind(const std::string& alias)
+{
+   lookup_map_t::iterator i = mBindLookup.find(alias);
+   if ( i == mBindLookup.end() )
+   {
+      return;
+   }
+
+   // is it currently playing?  if so, remember to restart it on the next
+   // bind.
+   if ( mMixer.isPlaying((*i).second.voice) && mSounds.count(alias) > 0 )
+   {
+      mSounds[alias].triggerOnNextBind = true;
+   }
+
+   mMixer.freeVoice((*i).second.voice);
+   mBindLookup.erase(i);
+}
+
+void SoftwareSoundImplementation::step(const float timeElapsed)
+{
+   vprASSERT(mIsOpen && "startAPI must be called prior to this function");
+
+   snx::SoundImplementation::step(timeElapsed);
+
+   mPendingFrames += timeElapsed * mMixer.getSampleRate();
+
+   const double block_size(mMixer.getBlockSize());
+   while ( mPendingFrames >= block_size )
+   {
+      this->renderBlock();
+      mPendingFrames -= block_size;
+   }
+}
+
+double SoftwareSoundImplementation::getVoicesPerCore() const
+{
+   const double mix_sec(mMixTime.usecd() / 1000000.0);
+
+   if ( mix_sec <= 0.0 || 0 == mMixer.getSampleRate() )
+   {
+      return 0.0;
+   }
+
+   // Seconds of single-voice audio produced per second of mixing.
+   const double voice_sec(double(mVoiceBlocks) * mMixer.getBlockSize() /
+                             mMixer.getSampleRate());
+   return voice_sec / mix_sec;
+}
+
+void SoftwareSoundImplementation::updateGain(const std::string& alias)
+{
+   lookup_map_t::iterator i = mBindLookup.find(alias);
+   if ( i != mBindLookup.end() )
+   {
+      const snx::SoundInfo& info = this->lookup(alias);
+      mMixer.setGain((*i).second.voice, info.volume * info.cutoff);
+   }
+}
+
+void SoftwareSoundImplementation::openSink()
+{
+   std::string output;
+   vpr::System::getenv("SNX_SOFTWARE_OUTPUT", output);
+
+   mOutput.clear();
+   mWavDataBytes = 0;
+
+   if ( output.empty() || output == "memory" )
+   {
+      mSinkType = MEMORY_SINK;
+   }
+   else if ( output == "none" )
+   {
+      mSinkType = NULL_SINK;
+   }
+   else
+   {
+      mWavFileName = output;
+      mWavFile     = std::fopen(mWavFileName.c_str(), "wb");
+
+      if ( NULL == mWavFile )
+      {
+         vprDEBUG(snxDBG, vprDBG_WARNING_LVL)
+            << clrOutNORM(clrRED, "ERROR") << ": Software| Could not open '"
+            << mWavFileName << "' for writing; discarding output\n"
+            << vprDEBUG_FLUSH;
+         mSinkType = NULL_SINK;
+         return;
+      }
+
+      mSinkType = WAV_SINK;
+
+      // Write a placeholder header.  The sizes are patched in closeSink().
+      const vpr::Uint16 channels(mMixer.getChannels());
+      const vpr::Uint32 rate(mMixer.getSampleRate());
+      std::fwrite("RIFF", 1, 4, mWavFile);
+      writeLE32(mWavFile, 36);
+      std::fwrite("WAVEfmt ", 1, 8, mWavFile);
+      writeLE32(mWavFile, 16);
+      writeLE16(mWavFile, 1);
+      writeLE16(mWavFile, channels);
+      writeLE32(mWavFile, rate);
+      writeLE32(mWavFile, rate * channels * 2);
+      writeLE16(mWavFile, channels * 2);
+      writeLE16(mWavFile, 16);
+      std::fwrite("data", 1, 4, mWavFile);
+      writeLE32(mWavFile, 0);
+   }
+}
+
+void SoftwareSoundImplementation::closeSink()
+{
+   if ( NULL != mWavFile )
+   {
+      std::fseek(mWavFile, 4, SEEK_SET);
+      writeLE32(mWavFile, 36 + mWavDataBytes);
+      std::fseek(mWavFile, 40, SEEK_SET);
+      writeLE32(mWavFile, mWavDataBytes);
+      std::fclose(mWavFile);
+      mWavFile = NULL;
+   }
+}
+
+void SoftwareSoundImplementation::renderBlock()
+{
+   const vpr::Interval start(vpr::Interval::now());
+   const std::size_t voices(mMixer.mixBlock(&mBlock[0]));
+   mMixTime += vpr::Interval::now() - start;
+
+   mVoiceBlocks += voices;
+   ++mBlocks;
+   if ( voices > mPeakVoices )
+   {
+      mPeakVoices = voices;
+   }
+
+   if ( mSinkType == NULL_SINK )
+   {
+      return;
+   }
+
+   const std::size_t count(mBlock.size());
+   for ( std::size_t i = 0; i < count; ++i )
+   {
+      float s(mBlock[i]);
+      s = s > 1.0f ? 1.0f : (s < -1.0f ? -1.0f : s);
+      mBlockPcm[i] = static_cast<vpr::Int16>(s * 32767.0f);
+   }
+
+   if ( mSinkType == MEMORY_SINK )
+   {
+      mOutput.insert(mOutput.end(), mBlockPcm.begin(), mBlockPcm.end());
+   }
+   else
+   {
+      // WAV data is little-endian.
+      for ( std::size_t i = 0; i < count; ++i )
+      {
+         writeLE16(mWavFile, static_cast<vpr::Uint16>(mBlockPcm[i]));
+      }
+      mWavDataBytes += vpr::Uint32(count * 2);
+   }
+}
+
+} // end namespace
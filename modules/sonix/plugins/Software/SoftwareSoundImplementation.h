@@ -0,0 +1,322 @@
+/****************** <SNX heading BEGIN do not edit this line> *****************
+ *
+ * sonix
+ *
+ * Original Authors:
+ *   Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <SNX heading END do not edit this line> ******************/
+
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef SNXSOFTWARESOUNDIMPLEMENTATION_H
+#define SNXSOFTWARESOUNDIMPLEMENTATION_H
+
+#include <snx/PluginConfig.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include <gmtl/Matrix.h>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Util/Interval.h>
+
+#include <snx/SoundImplementation.h>
+#include <snx/SoundInfo.h>
+#include <snx/SoundAPIInfo.h>
+
+#include "SoftwareMixer.h"
+
+
+namespace snx
+{
+
+/** \class SoftwareSoundImplementation SoftwareSoundImplementation.h
+ *
+ * Headless sound implementation that mixes every sound in software.  No
+ * audio device is opened.  Instead, the mixed output is written to one of
+ * the following sinks, chosen by the \c SNX_SOFTWARE_OUTPUT environment
+ * variable when the API is started:
+ *
+ *  - unset or "memory": the output is kept in memory (see getOutput()).
+ *  - "none": the output is discarded.
+ *  - anything else: the name of a 16-bit PCM WAV file to write.
+ *
+ * Audio is produced only when step() is called, so the time passed to
+ * step() is the amount of audio rendered, not the wall-clock time.  This
+ * makes runs reproducible on build machines without sound hardware.  The
+ * block size defaults to 256 frames and can be changed with
+ * \c SNX_SOFTWARE_BLOCK_SIZE.
+ *
+ * The implementation also doubles as a throughput benchmark.  It times every
+ * block it mixes and, when the API is shut down, reports how many voices a
+ * single core could mix in real time at the configured block size.  The same
+ * figure is available at any time from getVoicesPerCore().
+ */
+class SoftwareSoundImplementation : public snx::SoundImplementation
+{
+public:
+   SoftwareSoundImplementation();
+
+   virtual ~SoftwareSoundImplementation();
+
+   /**
+    * every implementation can return a new copy of itself
+    */
+   virtual void clone(snx::ISoundImplementation* &newCopy)
+   {
+      SoftwareSoundImplementation* temp = new SoftwareSoundImplementation;
+      newCopy = temp;
+
+      // copy state, so that we return a true "clone"
+      temp->copy(*this);
+   }
+
+   /**
+    * @input alias of the sound to trigger, and number of times to play
+    * @preconditions alias does not have to be associated with a loaded sound.
+    * @postconditions if it is, then the loaded sound is triggered.  if it
+    *                 isn't then nothing happens.
+    * @semantics Triggers a sound
+    */
+   virtual void trigger(const std::string& alias, const int repeat = 1);
+
+   /**
+    * is the sound currently playing?
+    */
+   virtual bool isPlaying(const std::string& alias) const;
+
+   /**
+    * @semantics stop the sound
+    * @input alias of the sound to be stopped
+    */
+   virtual void stop(const std::string& alias);
+
+   /**
+    * pause the sound, use unpause to return playback where you left off...
+    */
+   virtual void pause(const std::string& alias);
+
+   /**
+    * resume playback from a paused state.  does nothing if sound was not
+    * paused.
+    */
+   virtual void unpause(const std::string& alias);
+
+   /** if the sound is paused, then return true. */
+   virtual bool isPaused(const std::string& alias) const;
+
+   /**
+    * ambient or positional sound.
+    * is the sound ambient - attached to the listener, doesn't change volume
+    * when listener moves...
+    * or is the sound positional - changes volume as listener nears or
+    * retreats..
+    */
+   virtual void setAmbient(const std::string& alias, bool ambient = false);
+
+   /** 1 is no change.  2 is really high, 0 is really low. */
+   virtual void setPitchBend(const std::string& alias, float amount);
+
+   /** 0 - 1. */
+   virtual void setVolume(const std::string& alias, float amount);
+
+   /** 1 is no change.  0 is total cutoff. */
+   virtual void setCutoff(const std::string& alias, float amount);
+
+   /**
+    * set sound's 3D position
+    */
+   virtual void setPosition(const std::string& alias, float x, float y,
+                            float z);
+
+   /**
+    * set the position of the listener
+    */
+   virtual void setListenerPosition(const gmtl::Matrix44f& mat);
+
+public:
+   /**
+    * start the sound API, creating any contexts or other configurations at
+    * startup
+    * @postconditions sound API is ready to go.
+    * @semantics this function should be called before using the other
+    *            functions in the class.
+    * @return value: 1 if sucess 0 otherwise
+    */
+   virtual int startAPI();
+
+   /**
+    * kill the sound API, deallocating any sounds, etc...
+    * @semantics this function could be called any time, the function could
+    *            be called multiple times, so it should be smart.
+    */
+   virtual void shutdownAPI();
+
+   /**
+    * query whether the API has been started or not
+    * @semantics return true if api has been started, false otherwise.
+    */
+   virtual bool isStarted() const
+   {
+      return mIsOpen;
+   }
+
+   /**
+    * configure the sound API global settings.  The output rate and channel
+    * count are taken from \p sai the next time the API is started.
+    */
+   virtual void configure(const snx::SoundAPIInfo& sai)
+   {
+      snx::SoundImplementation::configure(sai);
+   }
+
+   /**
+    * configure/reconfigure a sound
+    */
+   virtual void configure(const std::string& alias,
+                          const snx::SoundInfo& description);
+
+   /**
+    * load/allocate the sound data this alias refers to the sound API
+    * @postconditions the sound API has the sound buffered.
+    */
+   virtual void bind(const std::string& alias);
+
+   /**
+    * unload/deallocate the sound data this alias refers from the sound API
+    * @postconditions the sound API no longer has the sound buffered.
+    */
+   virtual void unbind(const std::string& alias);
+
+   /**
+    * take a time step of [timeElapsed] seconds.  Exactly that much audio is
+    * mixed and written to the sink, rounded to whole blocks (the remainder
+    * carries over to the next step).
+    */
+   virtual void step(const float timeElapsed);
+
+   /**
+    * Returns the interleaved 16-bit samples written to the memory sink since
+    * the API was started.  This is empty for the other sinks.
+    */
+   const std::vector<vpr::Int16>& getOutput() const
+   {
+      return mOutput;
+   }
+
+   /**
+    * Returns the number of voices one core can mix in real time, measured
+    * over every block mixed since the API was started.  Returns 0 before
+    * anything has been mixed.
+    */
+   double getVoicesPerCore() const;
+
+   /**
+    * Invokes the global scope delete operator.  This is required for proper
+    * releasing of memory in DLLs on Win32.
+    */
+   void operator delete(void* p)
+   {
+      ::operator delete(p);
+   }
+
+protected:
+   /**
+    * Deletes this object.  This is an implementation of the pure virtual
+    * snx::ISoundImplementation::destroy() method.
+    */
+   virtual void destroy()
+   {
+      delete this;
+   }
+
+private:
+   /** Applies the current snx::SoundInfo gain settings to the voice. */
+   void updateGain(const std::string& alias);
+
+   void openSink();
+
+   void closeSink();
+
+   /** Mixes one block and hands it to the sink. */
+   void renderBlock();
+
+   struct SwSoundInfo
+   {
+      SwSoundInfo()
+         : source()
+         , voice(0)
+      {
+      }
+
+      snx::SoftwareMixer::Source source;
+      std::size_t voice;
+   };
+
+   typedef std::map<std::string, SwSoundInfo> lookup_map_t;
+   lookup_map_t mBindLookup;
+
+   snx::SoftwareMixer mMixer;
+   bool mIsOpen;
+
+   /** Frames owed to the sink that did not fill a whole block yet. */
+   double mPendingFrames;
+
+   /** Interleaved float output of the last block. */
+   std::vector<float> mBlock;
+
+   /** Interleaved 16-bit conversion of \c mBlock. */
+   std::vector<vpr::Int16> mBlockPcm;
+
+   enum SinkType
+   {
+      MEMORY_SINK,
+      WAV_SINK,
+      NULL_SINK
+   };
+
+   SinkType mSinkType;
+   std::vector<vpr::Int16> mOutput;
+   std::string mWavFileName;
+   std::FILE* mWavFile;
+   vpr::Uint32 mWavDataBytes;
+
+   /** @name Benchmark counters, reset by startAPI(). */
+   //@{
+   vpr::Interval mMixTime;
+   unsigned long long mVoiceBlocks;
+   unsigned long long mBlocks;
+   std::size_t mPeakVoices;
+   //@}
+};
+
+} // end namespace
+
+#endif //SNXSOFTWARESOUNDIMPLEMENTATION_H
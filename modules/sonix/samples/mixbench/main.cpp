@@ -0,0 +1,155 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/****************** <SNX heading BEGIN do not edit this line> *****************
+ *
+ * Juggler Juggler
+ *
+ * Original Authors:
+ *   Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <SNX heading END do not edit this line> ******************/
+
+/*
+ * Throughput benchmark for the Software Sonix plug-in.  It configures a
+ * number of looping, positional sounds, mixes a fixed amount of audio as
+ * fast as possible, and reports how many voices one core can mix in real
+ * time at the given block size.  No audio device is needed.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <gmtl/Matrix.h>
+
+#include <vpr/System.h>
+#include <vpr/Util/Interval.h>
+
+#include <snx/sonix.h>
+
+
+int main(int argc, char* argv[])
+{
+   if ( argc < 2 )
+   {
+      std::cout << "Usage: " << argv[0]
+                << " filename [voices [block size [seconds]]]\n"
+                << "       " << argv[0] << " sol.wav 256 256 10\n"
+                << std::flush;
+      return 1;
+   }
+
+   const std::string filename(argv[1]);
+   const int voices     = argc > 2 ? std::atoi(argv[2]) : 256;
+   const int block_size = argc > 3 ? std::atoi(argv[3]) : 256;
+   const float seconds  = argc > 4 ? float(std::atof(argv[4])) : 10.0f;
+
+   if ( voices <= 0 || block_size <= 0 || seconds <= 0.0f )
+   {
+      std::cerr << "Voice count, block size, and duration must be positive\n";
+      return 1;
+   }
+
+   // The block size is read by the plug-in when the API starts.  Unless the
+   // user asked for a sink, throw the output away so that only mixing is
+   // measured.
+   std::ostringstream block_str;
+   block_str << block_size;
+   vpr::System::setenv("SNX_SOFTWARE_BLOCK_SIZE", block_str.str());
+
+   std::string output;
+   if ( ! vpr::System::getenv("SNX_SOFTWARE_OUTPUT", output) )
+   {
+      vpr::System::setenv("SNX_SOFTWARE_OUTPUT", "none");
+   }
+
+   snx::SoundAPIInfo sai;
+   sai.sampleRate = snx::SoundAPIInfo::STEREO_44100_KHZ;
+   snx::sonix::instance()->configure(sai);
+   snx::sonix::instance()->changeAPI("Software");
+
+   // Spread the sources around the listener at varying distances and pitches
+   // so that every gain and resampling path is exercised.
+   for ( int i = 0; i < voices; ++i )
+   {
+      std::ostringstream alias;
+      alias << "voice" << i;
+
+      const float angle = 2.0f * 3.14159265f * float(i) / float(voices);
+      const float dist  = 1.0f + float(i % 16);
+
+      snx::SoundInfo si;
+      si.filename   = filename;
+      si.datasource = snx::SoundInfo::FILESYSTEM;
+      si.repeat     = -1;
+      si.pitchbend  = 0.75f + 0.5f * float(i % 8) / 8.0f;
+      si.position[0] = dist * std::cos(angle);
+      si.position[1] = 0.0f;
+      si.position[2] = dist * std::sin(angle);
+
+      snx::sonix::instance()->configure(alias.str(), si);
+      snx::sonix::instance()->trigger(alias.str(), -1);
+   }
+
+   if ( ! snx::sonix::instance()->isPlaying("voice0") )
+   {
+      std::cerr << "Could not play " << filename
+                << " with the Software plug-in\n";
+      return 1;
+   }
+
+   const float block_sec = float(block_size) / 44100.0f;
+   const int blocks      = int(std::ceil(seconds / block_sec));
+
+   const vpr::Interval start(vpr::Interval::now());
+   for ( int b = 0; b < blocks; ++b )
+   {
+      snx::sonix::instance()->step(block_sec);
+   }
+   const double wall_sec = (vpr::Interval::now() - start).usecd() / 1000000.0;
+
+   const double audio_sec = double(blocks) * block_sec;
+
+   std::cout << "voices:          " << voices << "\n"
+             << "block size:      " << block_size << " frames\n"
+             << "audio mixed:     " << audio_sec << " s\n"
+             << "wall time:       " << wall_sec << " s\n";
+   if ( wall_sec > 0.0 )
+   {
+      std::cout << "real-time ratio: " << audio_sec / wall_sec << "\n"
+                << "voices/core:     " << voices * audio_sec / wall_sec
+                << "\n";
+   }
+   std::cout << std::flush;
+
+   // Shutting down makes the plug-in print its own mix-only figure.
+   snx::sonix::instance()->changeAPI("stub");
+
+   return 0;
+}
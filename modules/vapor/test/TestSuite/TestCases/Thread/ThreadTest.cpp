@@ -151,6 +151,39 @@ void ThreadTest::testUncaughtException()
 }
 
 
+void ThreadTest::testSchedClass()
+{
+   vpr::Thread thread(boost::bind(&ThreadTest::schedClassFunc, this));
+   thread.join();
+}
+
+void ThreadTest::schedClassFunc()
+{
+   vpr::Thread* self(vpr::Thread::self());
+
+   self->setSchedClass(vpr::BaseThread::VPR_SCHED_NORMAL);
+   CPPUNIT_ASSERT(self->getSchedClass() == vpr::BaseThread::VPR_SCHED_NORMAL);
+
+   // Real-time classes need privileges that the test may not have, in which
+   // case the request must fail without changing the class.  NSPR threads
+   // have no scheduling classes at all.
+#if VPR_THREAD_DOMAIN_INCLUDE != VPR_DOMAIN_NSPR
+   try
+   {
+      self->setSchedClass(vpr::BaseThread::VPR_SCHED_FIFO, 10);
+      CPPUNIT_ASSERT(self->getSchedClass() == vpr::BaseThread::VPR_SCHED_FIFO);
+   }
+   catch (vpr::Exception&)
+   {
+      CPPUNIT_ASSERT(self->getSchedClass() ==
+                        vpr::BaseThread::VPR_SCHED_NORMAL);
+   }
+#endif
+
+   self->setSchedClass(vpr::BaseThread::VPR_SCHED_NORMAL);
+   CPPUNIT_ASSERT(self->getSchedClass() == vpr::BaseThread::VPR_SCHED_NORMAL);
+}
+
 void ThreadTest::testCreateJoin()
 {
    // Spawn off a bunch of threads (m)
@@ -21,6 +21,7 @@ CPPUNIT_TEST_SUITE(ThreadTest);
 CPPUNIT_TEST(testNoSpawnCtor);
 CPPUNIT_TEST(testAutoSpawnCtor);
 CPPUNIT_TEST(testUncaughtException);
+CPPUNIT_TEST(testSchedClass);
 //CPPUNIT_TEST( testCreateJoin);
 //CPPUNIT_TEST( testSuspendResume);
 //CPPUNIT_TEST( testPriority);
@@ -55,6 +56,13 @@ public:
    void testAutoSpawnCtor();
    void testUncaughtException();
 
+   // =========================================================================
+   // Scheduling class test
+   // =========================================================================
+   void testSchedClass();
+
+   void schedClassFunc();
+
    // =========================================================================
    // thread CreateJoin test
    // =========================================================================
@@ -0,0 +1,390 @@
+/****************** <VPR heading BEGIN do not edit this line> *****************
+ *
+ * VR Juggler Portable Runtime
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Patrick Hartling, Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <VPR heading END do not edit this line> ******************/
+
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Frame-time jitter benchmark for vpr::ThreadPlacement.
+ *
+ * A kernel thread runs a frame loop that releases a set of draw threads,
+ * reads the latest sample from a device thread and waits for the draw threads
+ * to finish.  Each draw thread sweeps a private buffer a fixed number of
+ * times, so a frame always has the same amount of work.  Background threads
+ * keep every CPU busy while the frames run.  The loop is run twice, first
+ * with the threads left to the scheduler and then with the threads placed
+ * according to the plan, and the frame-time statistics of both runs are
+ * printed.
+ *
+ * Usage: placementJitter [-frames N] [-draw N] [-kb N] [-passes N]
+ *                        [-hogs N] [-sysfs DIR]
+ *
+ *    -frames  Number of frames per run (default 1000).
+ *    -draw    Number of draw threads (default: one per planned draw CPU).
+ *    -kb      Size of each draw thread's buffer in KB (default 256).
+ *    -passes  Sweeps over the buffer per frame (default 8).
+ *    -hogs    Number of background threads (default: one per CPU).
+ *    -sysfs   Print the topology and plan read from the given directory
+ *             (laid out like /sys/devices/system/cpu) and exit.
+ */
+
+#include <vpr/vpr.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <vpr/System.h>
+#include <vpr/Sync/Guard.h>
+#include <vpr/Sync/Mutex.h>
+#include <vpr/Sync/Semaphore.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Thread/ThreadPlacement.h>
+#include <vpr/Util/Interval.h>
+
+
+namespace
+{
+
+struct Options
+{
+   Options()
+      : frames(1000)
+      , draws(0)
+      , kb(256)
+      , passes(8)
+      , hogs(0)
+   {
+   }
+
+   unsigned int frames;
+   unsigned int draws;
+   unsigned int kb;
+   unsigned int passes;
+   unsigned int hogs;
+};
+
+/** State shared by the threads of one run. */
+class FrameLoop
+{
+public:
+   FrameLoop(const Options& opts)
+      : mOpts(opts)
+      , mStop(false)
+      , mSample(0)
+      , mDone(0)
+      , mSink(0.0f)
+   {
+      for ( unsigned int i = 0; i < opts.draws; ++i )
+      {
+         mStart.push_back(new vpr::Semaphore(0));
+      }
+   }
+
+   ~FrameLoop()
+   {
+      for ( unsigned int i = 0; i < mStart.size(); ++i )
+      {
+         delete mStart[i];
+      }
+   }
+
+   /** Runs the frames and returns the frame times in milliseconds. */
+   std::vector<double> run()
+   {
+      std::vector<vpr::Thread*> threads;
+
+      for ( unsigned int i = 0; i < mOpts.hogs; ++i )
+      {
+         threads.push_back(new vpr::Thread(boost::bind(&FrameLoop::hog,
+                                                       this)));
+      }
+
+      threads.push_back(new vpr::Thread(boost::bind(&FrameLoop::device,
+                                                    this)));
+
+      for ( unsigned int i = 0; i < mOpts.draws; ++i )
+      {
+         threads.push_back(new vpr::Thread(boost::bind(&FrameLoop::draw,
+                                                       this, i)));
+      }
+
+      vpr::Thread kernel_thread(boost::bind(&FrameLoop::kernel, this));
+      kernel_thread.join();
+
+      mStop = true;
+      for ( unsigned int i = 0; i < mStart.size(); ++i )
+      {
+         mStart[i]->release();
+      }
+
+      for ( unsigned int i = 0; i < threads.size(); ++i )
+      {
+         threads[i]->join();
+         delete threads[i];
+      }
+
+      return mFrameTimes;
+   }
+
+private:
+   void kernel()
+   {
+      vpr::ThreadPlacement::instance()->place(vpr::ThreadPlacement::KERNEL);
+
+      unsigned long last_sample(0);
+      for ( unsigned int frame = 0; frame < mOpts.frames; ++frame )
+      {
+         const vpr::Interval start(vpr::Interval::now());
+
+         for ( unsigned int i = 0; i < mStart.size(); ++i )
+         {
+            mStart[i]->release();
+         }
+
+         {
+            vpr::Guard<vpr::Mutex> guard(mSampleLock);
+            last_sample = mSample;
+         }
+
+         mDone.acquire();
+         for ( unsigned int i = 1; i < mStart.size(); ++i )
+         {
+            mDone.acquire();
+         }
+
+         mFrameTimes.push_back((vpr::Interval::now() - start).msecd());
+      }
+
+      mSink += static_cast<float>(last_sample);
+   }
+
+   void draw(const unsigned int pipe)
+   {
+      vpr::ThreadPlacement::instance()->place(vpr::ThreadPlacement::DRAW,
+                                              pipe);
+
+      std::vector<float> buffer(mOpts.kb * 1024 / sizeof(float), 1.0f);
+      float sum(0.0f);
+
+      while ( true )
+      {
+         mStart[pipe]->acquire();
+         if ( mStop )
+         {
+            break;
+         }
+
+         for ( unsigned int pass = 0; pass < mOpts.passes; ++pass )
+         {
+            for ( std::vector<float>::iterator i = buffer.begin();
+                  i != buffer.end(); ++i )
+            {
+               *i = *i * 0.999f + 0.001f;
+               sum += *i;
+            }
+         }
+
+         mDone.release();
+      }
+
+      vpr::Guard<vpr::Mutex> guard(mSampleLock);
+      mSink += sum;
+   }
+
+   void device()
+   {
+      vpr::ThreadPlacement::instance()->place(vpr::ThreadPlacement::DEVICE);
+
+      while ( ! mStop )
+      {
+         {
+            vpr::Guard<vpr::Mutex> guard(mSampleLock);
+            ++mSample;
+         }
+         vpr::System::usleep(1000);
+      }
+   }
+
+   void hog()
+   {
+      volatile unsigned long spin(0);
+      while ( ! mStop )
+      {
+         ++spin;
+      }
+   }
+
+   const Options& mOpts;
+   volatile bool mStop;
+
+   vpr::Mutex mSampleLock;
+   unsigned long mSample;
+
+   std::vector<vpr::Semaphore*> mStart;
+   vpr::Semaphore mDone;
+   std::vector<double> mFrameTimes;
+
+   /** Keeps the draw work from being optimized away. */
+   float mSink;
+};
+
+void report(const char* name, std::vector<double> times)
+{
+   if ( times.empty() )
+   {
+      return;
+   }
+
+   double sum(0.0);
+   for ( std::vector<double>::const_iterator t = times.begin();
+         t != times.end(); ++t )
+   {
+      sum += *t;
+   }
+   const double mean(sum / times.size());
+
+   double var(0.0);
+   for ( std::vector<double>::const_iterator t = times.begin();
+         t != times.end(); ++t )
+   {
+      var += (*t - mean) * (*t - mean);
+   }
+
+   std::sort(times.begin(), times.end());
+
+   std::cout << std::fixed << std::setprecision(3) << std::setw(10) << name
+             << ": mean " << mean << " ms, stddev "
+             << std::sqrt(var / times.size()) << " ms, p99 "
+             << times[times.size() * 99 / 100] << " ms, max " << times.back()
+             << " ms" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   Options opts;
+   const char* sysfs(NULL);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-frames") == 0 )
+      {
+         opts.frames = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-draw") == 0 )
+      {
+         opts.draws = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-kb") == 0 )
+      {
+         opts.kb = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-passes") == 0 )
+      {
+         opts.passes = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-hogs") == 0 )
+      {
+         opts.hogs = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-sysfs") == 0 )
+      {
+         sysfs = argv[i + 1];
+      }
+   }
+
+   vpr::ThreadPlacement* placement(vpr::ThreadPlacement::instance());
+
+   if ( NULL != sysfs )
+   {
+      typedef std::vector<vpr::ThreadPlacement::Cpu> cpu_list_t;
+      const cpu_list_t cpus(vpr::ThreadPlacement::readTopology(sysfs));
+      const std::vector< std::vector<int> > plan(
+         vpr::ThreadPlacement::makePlan(cpus)
+      );
+
+      for ( cpu_list_t::const_iterator c = cpus.begin(); c != cpus.end(); ++c )
+      {
+         std::cout << "cpu" << c->id << ": package " << c->package
+                   << ", core " << c->core << ", node " << c->node
+                   << ", cache " << c->cache << std::endl;
+      }
+
+      for ( unsigned int role = 0; role < plan.size(); ++role )
+      {
+         std::cout << vpr::ThreadPlacement::getRoleName(
+                         static_cast<vpr::ThreadPlacement::Role>(role)
+                      ) << ":";
+         for ( unsigned int i = 0; i < plan[role].size(); ++i )
+         {
+            std::cout << " " << plan[role][i];
+         }
+         std::cout << std::endl;
+      }
+
+      return 0;
+   }
+
+   if ( 0 == opts.draws )
+   {
+      opts.draws = std::max<std::size_t>(
+         placement->getCpus(vpr::ThreadPlacement::DRAW).size(), 1
+      );
+   }
+
+   if ( 0 == opts.hogs )
+   {
+      opts.hogs = std::max<std::size_t>(placement->getTopology().size(), 1);
+   }
+
+   placement->setEnabled(true);
+   std::cout << *placement;
+   std::cout << opts.draws << " draw threads, " << opts.hogs
+             << " background threads, " << opts.frames << " frames\n";
+
+   placement->setEnabled(false);
+   FrameLoop unplaced(opts);
+   report("unplaced", unplaced.run());
+
+   placement->setEnabled(true);
+   FrameLoop placed(opts);
+   report("placed", placed.run());
+
+   return 0;
+}
@@ -54,7 +54,11 @@
 int thread_count = 0;
 vpr::Mutex thread_count_mutex;        // Protect the count of number of threads running
 
-vpr::Timer timers[MAX_NUM_THREADS];        // Timers to get the times to call self()
+// Timers for each thread.  The first set times dereferencing the proxy, which
+// takes the thread-local fast path when VPR_THREAD_LOCAL is defined.  The
+// second set times the full lookup through the thread's vpr::TSTable.
+vpr::Timer timers[MAX_NUM_THREADS];
+vpr::Timer lookup_timers[MAX_NUM_THREADS];
 
 const long num_reps = 100000;          // Number of times to call
 
@@ -62,6 +66,17 @@ vpr::TSObjectProxy<int>    tsDataItem;     // Allocate a thread specific int
 
 void doFunc(const int);
 
+static double getAverage(vpr::Timer* threadTimers, const int numThreads)
+{
+   double total_avg(0.0f);
+   for ( int x = 0; x < numThreads; ++x )
+   {
+      total_avg += (threadTimers[x].getTiming()/(double)num_reps);
+   }
+
+   return total_avg / (double)numThreads;
+}
+
 int main(int argc, char* argv[])
 {
    if ( argc <= 1 )
@@ -97,17 +112,18 @@ int main(int argc, char* argv[])
       ;
    }
 
-   double total_avg(0.0f);
-   for ( int x = 0; x < num_threads; ++x )
-   {
-      total_avg += (timers[x].getTiming()/(double)num_reps);
-   }
-
-   total_avg /= (double)num_threads;
-
    vprDEBUG(vprDBG_ALL, vprDBG_CRITICAL_LVL)
-      << "AVERAGE TIMING: " << total_avg*1000.0f << "ms"
+      << "AVERAGE TIMING: " << getAverage(timers, num_threads)*1000.0f
+      << "ms" << std::endl << vprDEBUG_FLUSH;
+   vprDEBUG(vprDBG_ALL, vprDBG_CRITICAL_LVL)
+      << "AVERAGE TIMING (TSTable lookup): "
+      << getAverage(lookup_timers, num_threads)*1000.0f << "ms"
       << std::endl << vprDEBUG_FLUSH;
+#if ! defined(VPR_THREAD_LOCAL)
+   vprDEBUG(vprDBG_ALL, vprDBG_CRITICAL_LVL)
+      << "VPR_THREAD_LOCAL is not defined, so the proxy always does the "
+      << "TSTable lookup." << std::endl << vprDEBUG_FLUSH;
+#endif
 
    return 0;
 }
@@ -124,10 +140,21 @@ void doFunc(const int threadNum)
    }
    timers[threadNum].stopTiming();
 
+   // Asking for the object of a specific thread always bypasses the
+   // thread-local cache.  This is what every dereference used to cost.
+   lookup_timers[threadNum].startTiming();
+   for ( long rep = 0; rep < num_reps; ++rep )
+   {
+     *tsDataItem.getObjPtrForThread(vpr::Thread::self()) = rep;
+   }
+   lookup_timers[threadNum].stopTiming();
+
    vprDEBUG(vprDBG_ALL, vprDBG_CRITICAL_LVL)
       << "Thread: " << threadNum << ": Exiting: Avg Time of: "
       << ((timers[threadNum].getTiming()/(double)num_reps)*1000.0f)
-      << "ms" << std::endl << vprDEBUG_FLUSH;
+      << "ms (TSTable lookup: "
+      << ((lookup_timers[threadNum].getTiming()/(double)num_reps)*1000.0f)
+      << "ms)" << std::endl << vprDEBUG_FLUSH;
    thread_count_mutex.acquire();
       thread_count--;               // Removing us from the number there
    thread_count_mutex.release();
@@ -0,0 +1,283 @@
+/****************** <VPR heading BEGIN do not edit this line> *****************
+ *
+ * VR Juggler Portable Runtime
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Patrick Hartling, Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <VPR heading END do not edit this line> ******************/
+
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Wakeup jitter test for the vpr::Thread scheduling classes.
+ *
+ * A periodic thread sleeps until each deadline and records how late it
+ * woke up, while background threads keep every CPU busy.  The periodic
+ * thread is run in the normal class, in the normal class with 1 us timer
+ * slack, and in the FIFO real-time class.  When the real-time class cannot
+ * be set (the process needs CAP_SYS_NICE or a non-zero RLIMIT_RTPRIO), that
+ * run is reported as skipped.
+ *
+ * Usage: wakeupJitter [-period us] [-samples N] [-hogs N] [-prio N]
+ *
+ *    -period   Period of the thread in microseconds (default 1000).
+ *    -samples  Number of wakeups per run (default 2000).
+ *    -hogs     Number of background threads (default: one per CPU).
+ *    -prio     Real-time priority of the FIFO run (default 80).
+ */
+
+#include <vpr/vpr.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+
+#include <vpr/System.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/Exception.h>
+#include <vpr/Util/Interval.h>
+
+#if ! defined(VPR_OS_Windows)
+#  include <unistd.h>
+#endif
+
+
+namespace
+{
+
+struct Options
+{
+   Options()
+      : period(1000)
+      , samples(2000)
+      , hogs(0)
+      , prio(80)
+   {
+   }
+
+   unsigned int period;
+   unsigned int samples;
+   unsigned int hogs;
+   int          prio;
+};
+
+volatile bool sStop(false);
+
+void hog()
+{
+   volatile unsigned long spin(0);
+   while ( ! sStop )
+   {
+      ++spin;
+   }
+}
+
+/** Records how late each wakeup of a periodic thread is, in microseconds. */
+class PeriodicThread
+{
+public:
+   PeriodicThread(const Options& opts,
+                  const vpr::Thread::VPRSchedClass schedClass,
+                  const vpr::Interval& slack)
+      : mOpts(opts)
+      , mSchedClass(schedClass)
+      , mSlack(slack)
+      , mScheduled(false)
+   {
+   }
+
+   void run()
+   {
+      vpr::Thread* self(vpr::Thread::self());
+
+      try
+      {
+         self->setTimerSlack(mSlack);
+         self->setSchedClass(mSchedClass, mOpts.prio);
+         mScheduled = self->getSchedClass() == mSchedClass;
+      }
+      catch (vpr::Exception& ex)
+      {
+         mError = ex.what();
+         return;
+      }
+
+      if ( ! mScheduled )
+      {
+         mError = "not supported on this platform";
+         return;
+      }
+
+      vpr::Interval period;
+      period.usec(mOpts.period);
+      vpr::Interval deadline(vpr::Interval::now() + period);
+
+      mLateness.reserve(mOpts.samples);
+      for ( unsigned int i = 0; i < mOpts.samples; ++i )
+      {
+         vpr::Interval now(vpr::Interval::now());
+         if ( now < deadline )
+         {
+            vpr::System::usleep(static_cast<vpr::Uint32>(
+               (deadline - now).usec()
+            ));
+            now = vpr::Interval::now();
+         }
+
+         mLateness.push_back((now - deadline).usecd());
+         deadline += period;
+
+         // Do not try to catch up after a long stall.
+         if ( deadline < now )
+         {
+            deadline = now + period;
+         }
+      }
+
+      // Restore the normal class so that the joining thread is not starved.
+      self->setSchedClass(vpr::Thread::VPR_SCHED_NORMAL);
+   }
+
+   void report(const char* name) const
+   {
+      std::cout << std::setw(14) << name << ": ";
+
+      if ( ! mScheduled )
+      {
+         std::cout << "skipped (" << mError << ")" << std::endl;
+         return;
+      }
+
+      std::vector<double> times(mLateness);
+      std::sort(times.begin(), times.end());
+
+      double sum(0.0);
+      for ( std::vector<double>::const_iterator t = times.begin();
+            t != times.end(); ++t )
+      {
+         sum += *t;
+      }
+
+      std::cout << std::fixed << std::setprecision(1) << "mean "
+                << sum / times.size() << " us, p50 "
+                << times[times.size() / 2] << " us, p99 "
+                << times[times.size() * 99 / 100] << " us, max "
+                << times.back() << " us" << std::endl;
+   }
+
+private:
+   const Options&                mOpts;
+   vpr::Thread::VPRSchedClass    mSchedClass;
+   vpr::Interval                 mSlack;
+   bool                          mScheduled;
+   std::string                   mError;
+   std::vector<double>           mLateness;
+};
+
+void runPeriodic(PeriodicThread& periodic, const unsigned int hogs)
+{
+   sStop = false;
+
+   std::vector<vpr::Thread*> threads;
+   for ( unsigned int i = 0; i < hogs; ++i )
+   {
+      threads.push_back(new vpr::Thread(hog));
+   }
+
+   vpr::Thread thread(boost::bind(&PeriodicThread::run, &periodic));
+   thread.join();
+
+   sStop = true;
+   for ( unsigned int i = 0; i < threads.size(); ++i )
+   {
+      threads[i]->join();
+      delete threads[i];
+   }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   Options opts;
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-period") == 0 )
+      {
+         opts.period = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-samples") == 0 )
+      {
+         opts.samples = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-hogs") == 0 )
+      {
+         opts.hogs = std::atoi(argv[i + 1]);
+      }
+      else if ( std::strcmp(argv[i], "-prio") == 0 )
+      {
+         opts.prio = std::atoi(argv[i + 1]);
+      }
+   }
+
+   if ( 0 == opts.hogs )
+   {
+#if defined(_SC_NPROCESSORS_ONLN)
+      opts.hogs = std::max(sysconf(_SC_NPROCESSORS_ONLN), 1L);
+#else
+      opts.hogs = 1;
+#endif
+   }
+
+   std::cout << opts.samples << " wakeups every " << opts.period << " us, "
+             << opts.hogs << " background threads" << std::endl;
+
+   vpr::Interval no_slack;
+   vpr::Interval min_slack;
+   min_slack.usec(1);
+
+   PeriodicThread normal(opts, vpr::Thread::VPR_SCHED_NORMAL, no_slack);
+   runPeriodic(normal, opts.hogs);
+   normal.report("normal");
+
+   PeriodicThread slack(opts, vpr::Thread::VPR_SCHED_NORMAL, min_slack);
+   runPeriodic(slack, opts.hogs);
+   slack.report("normal, 1 us");
+
+   PeriodicThread fifo(opts, vpr::Thread::VPR_SCHED_FIFO, no_slack);
+   runPeriodic(fifo, opts.hogs);
+   fifo.report("fifo");
+
+   return 0;
+}
@@ -37,6 +37,7 @@
 #include <vpr/Perf/ProfileNode.h>
 #include <vpr/Util/Debug.h>
 #include <vpr/Sync/Guard.h>
+#include <algorithm>
 #include <sstream>
 
 namespace vpr
@@ -261,13 +262,18 @@ namespace vpr
       {
          mLastSample.setNow();
          mLastSample -= mStartTime;
-         if ( 0 != mMaxHistorySize )
+         if ( mHistory.size() < mMaxHistorySize )
          {
             mHistory.push_front(mLastSample);
-            if ( mHistory.size() > mMaxHistorySize )
-            {
-               mHistory.resize(mMaxHistorySize);
-            }
+         }
+         else if ( 0 != mMaxHistorySize )
+         {
+            // Once the history is full, the samples are shifted in place.
+            // Pushing to the front and dropping from the back would make
+            // the deque allocate a new block every few samples.
+            std::copy_backward(mHistory.begin(), mHistory.end() - 1,
+                               mHistory.end());
+            mHistory.front() = mLastSample;
          }
          mTotalTime += mLastSample;
       }
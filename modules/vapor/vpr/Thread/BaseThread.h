@@ -159,6 +159,18 @@ public:
       VPR_UNJOINABLE_THREAD  /**< The thread cannot be attached with join() */
    };
 
+   /**
+    * Scheduling classes.  The real-time classes preempt every thread in the
+    * normal class and usually require privileges (CAP_SYS_NICE or a non-zero
+    * RLIMIT_RTPRIO on Linux).
+    */
+   enum VPRSchedClass
+   {
+      VPR_SCHED_NORMAL,   /**< Time-sharing scheduling (the default) */
+      VPR_SCHED_FIFO,     /**< Real-time; runs until it blocks or yields */
+      VPR_SCHED_RR        /**< Real-time; time-sliced with equal priorities */
+   };
+
 protected:
    BaseThread();
 
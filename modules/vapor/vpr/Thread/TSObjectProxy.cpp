@@ -37,6 +37,20 @@
 #include <vpr/Sync/Guard.h>
 #include <vpr/Thread/TSObjectProxy.h>
 
+#if defined(VPR_THREAD_LOCAL)
+namespace
+{
+
+/**
+ * The table of the thread that owns this variable.  The pointer stays valid
+ * for the life of the thread: a vpr::Thread owns its table, and the global
+ * table is never destroyed.
+ */
+VPR_THREAD_LOCAL vpr::TSTable* sCurrentTSTable = NULL;
+
+}
+#endif
+
 namespace vpr
 {
 
@@ -53,4 +67,24 @@ namespace vpr
       return s_next_ts_object_key++;
    }
 
+   TSTable* TSObjectProxyBase::getCurrentTSTable()
+   {
+#if defined(VPR_THREAD_LOCAL)
+      if ( NULL != sCurrentTSTable )
+      {
+         return sCurrentTSTable;
+      }
+#endif
+
+      vpr::Thread* thread_self = Thread::self();
+      TSTable* table = (NULL != thread_self ? thread_self->getTSTable()
+                                            : Thread::getGlobalTSTable());
+
+#if defined(VPR_THREAD_LOCAL)
+      sCurrentTSTable = table;
+#endif
+
+      return table;
+   }
+
 }
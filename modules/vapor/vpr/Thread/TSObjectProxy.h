@@ -70,6 +70,14 @@ protected:
     * This value will be used locally by each thread in the system.
     */
    static long generateNewTSKey();
+
+   /**
+    * Returns the thread-specific table of the calling thread.  This is the
+    * table of the calling vpr::Thread or the global table for threads not
+    * created by VPR.  When VPR_THREAD_LOCAL is defined, the table is found
+    * once per thread and then kept in a thread-local variable.
+    */
+   static TSTable* getCurrentTSTable();
 };
 
 /** @example "Example of using vpr::TSObjectProxy"
@@ -92,6 +100,11 @@ protected:
  *       default constructor.
  *
  * Uses TSObject<T> internally to keep some type information.
+ *
+ * When VPR_THREAD_LOCAL is defined (see vpr/vprConfig.h), the calling
+ * thread's table is kept in a thread-local variable, and each object is
+ * looked up and cast only on its first use by that thread.  Later uses cost
+ * two loads and a compare.  Otherwise every use does the full lookup.
  */
 template<class T>
 class TSObjectProxy : public TSObjectProxyBase
@@ -158,21 +171,38 @@ private:
    {
       TSTable* table(NULL);
 
-      // --- GET TS TABLE --- //
-      // - If have self, get mine.  Otherwise use global one
-      vpr::Thread* thread_self(reqThread);
-      if(NULL == thread_self)       // If didn't request specific thread, then get for current thread
-      {
-         thread_self = Thread::self();
-      }
-
-      if(NULL != thread_self)
+#if defined(VPR_THREAD_LOCAL)
+      // --- FAST PATH --- //
+      // The calling thread has already used this object, so the cast
+      // pointer is waiting in its table.
+      if ( NULL == reqThread )
       {
-         table = thread_self->getTSTable();
+         table = TSObjectProxyBase::getCurrentTSTable();
+         void* cached = table->getCachedObject(mObjectKey);
+         if ( NULL != cached )
+         {
+            return static_cast<T*>(cached);
+         }
       }
       else
+#endif
       {
-         table = Thread::getGlobalTSTable();
+         // --- GET TS TABLE --- //
+         // - If have self, get mine.  Otherwise use global one
+         vpr::Thread* thread_self(reqThread);
+         if(NULL == thread_self)    // If didn't request specific thread, then get for current thread
+         {
+            thread_self = Thread::self();
+         }
+
+         if(NULL != thread_self)
+         {
+            table = thread_self->getTSTable();
+         }
+         else
+         {
+            table = Thread::getGlobalTSTable();
+         }
       }
 
       // ---- DOES OBJECT EXIST --- //
@@ -211,8 +241,19 @@ private:
          throw vpr::BadCastException(msg_stream.str(), VPR_LOCATION);
       }
 
+      T* result = real_object->getObject();
+
+#if defined(VPR_THREAD_LOCAL)
+      // Only the owning thread may touch the cache.  getObjPtrForThread()
+      // can be called from any thread.
+      if ( NULL == reqThread )
+      {
+         table->setCachedObject(result, mObjectKey);
+      }
+#endif
+
       // Return the pointer.
-      return real_object->getObject();
+      return result;
    }
 
    // Don't allow copy construction.
@@ -109,8 +109,23 @@ public:
     */
    inline void releaseObject(unsigned long key);
 
+   /**
+    * Returns the already cast pointer to the user object with the given key
+    * that was stored with setCachedObject(), or NULL if there is none.  This
+    * lets vpr::TSObjectProxy skip the lookup and the dynamic_cast once an
+    * object has been found.
+    */
+   void* getCachedObject(unsigned long key) const
+   {
+      return key < mCachedObjects.size() ? mCachedObjects[key] : NULL;
+   }
+
+   /** Stores the cast pointer to the user object with the given key. */
+   inline void setCachedObject(void* object, unsigned long key);
+
 private:
    std::vector<TSBaseObject*> mTSObjects;    /**< Map object key to TS Object ptr */
+   std::vector<void*>         mCachedObjects; /**< Map object key to user object ptr */
 };
 
 // Sets an object entry in the table.
@@ -140,6 +155,17 @@ void TSTable::releaseObject(unsigned long key)
       delete mTSObjects[key];
    }
    mTSObjects[key] = NULL;
+   setCachedObject(NULL, key);
+}
+
+// Stores the cast pointer to the user object with the given key.
+void TSTable::setCachedObject(void* object, unsigned long key)
+{
+   if ( mCachedObjects.size() <= key )
+   {
+      mCachedObjects.resize(key + 1, NULL);
+   }
+   mCachedObjects[key] = object;
 }
 
 } // End of vpr namespace
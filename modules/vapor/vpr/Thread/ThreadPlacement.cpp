@@ -0,0 +1,715 @@
+/****************** <VPR heading BEGIN do not edit this line> *****************
+ *
+ * VR Juggler Portable Runtime
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Patrick Hartling, Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <VPR heading END do not edit this line> ******************/
+
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <vpr/vprConfig.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <boost/concept_check.hpp>
+#include <boost/algorithm/string.hpp>
+
+#if defined(VPR_OS_Linux)
+#  include <sched.h>
+#  include <dirent.h>
+#  include <sys/resource.h>
+#endif
+
+#if ! defined(VPR_OS_Windows)
+#  include <unistd.h>
+#endif
+
+#if defined(_POSIX_MEMLOCK) && _POSIX_MEMLOCK > 0
+#  include <sys/mman.h>
+#endif
+
+#include <vpr/System.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/Debug.h>
+#include <vpr/Util/Error.h>
+#include <vpr/Util/Exception.h>
+#include <vpr/Thread/ThreadPlacement.h>
+
+
+namespace
+{
+
+/** Parses a sysfs CPU list such as "0-3,8,10-11". */
+std::vector<int> parseCpuList(const std::string& list)
+{
+   std::vector<int> cpus;
+   std::vector<std::string> ranges;
+   boost::split(ranges, list, boost::is_any_of(","));
+
+   for ( std::vector<std::string>::iterator r = ranges.begin();
+         r != ranges.end(); ++r )
+   {
+      boost::trim(*r);
+      if ( r->empty() )
+      {
+         continue;
+      }
+
+      const std::string::size_type dash(r->find('-'));
+      const int first(std::atoi(r->substr(0, dash).c_str()));
+      const int last(dash == std::string::npos ? first
+                                               : std::atoi(r->c_str() + dash + 1));
+      for ( int cpu = first; cpu <= last; ++cpu )
+      {
+         cpus.push_back(cpu);
+      }
+   }
+
+   return cpus;
+}
+
+bool readLine(const std::string& path, std::string& line)
+{
+   std::ifstream in(path.c_str());
+   return std::getline(in, line).good() || ! line.empty();
+}
+
+int readInt(const std::string& path, const int defaultValue)
+{
+   std::string line;
+   return readLine(path, line) ? std::atoi(line.c_str()) : defaultValue;
+}
+
+std::size_t countDistinct(std::vector<int> values)
+{
+   std::sort(values.begin(), values.end());
+   return std::unique(values.begin(), values.end()) - values.begin();
+}
+
+const char* getSchedClassName(const vpr::BaseThread::VPRSchedClass schedClass)
+{
+   switch ( schedClass )
+   {
+      case vpr::BaseThread::VPR_SCHED_FIFO:
+         return "fifo";
+      case vpr::BaseThread::VPR_SCHED_RR:
+         return "rr";
+      default:
+         return "normal";
+   }
+}
+
+/** A physical core and the logical CPUs (SMT threads) on it. */
+struct Core
+{
+   int package;
+   int core;
+   int node;
+   int cache;
+   std::vector<int> threads;
+};
+
+/** Orders cores by how close they are to a given core. */
+struct CloserTo
+{
+   CloserTo(const Core& c)
+      : target(c)
+   {
+   }
+
+   int distance(const Core& c) const
+   {
+      if ( c.cache == target.cache )
+      {
+         return 0;
+      }
+      return c.node == target.node ? 1 : 2;
+   }
+
+   bool operator()(const Core& a, const Core& b) const
+   {
+      const int da(distance(a)), db(distance(b));
+      if ( da != db )
+      {
+         return da < db;
+      }
+      if ( a.node != b.node )
+      {
+         return a.node < b.node;
+      }
+      return a.threads[0] < b.threads[0];
+   }
+
+   Core target;
+};
+
+}
+
+namespace vpr
+{
+
+vprSingletonImp(ThreadPlacement);
+
+std::vector<ThreadPlacement::Cpu>
+ThreadPlacement::readTopology(const std::string& root)
+{
+   std::vector<Cpu> cpus;
+
+#if defined(VPR_OS_Linux)
+   std::string online;
+   if ( ! readLine(root + "/online", online) )
+   {
+      return cpus;
+   }
+
+   const std::vector<int> ids(parseCpuList(online));
+   for ( std::vector<int>::const_iterator i = ids.begin(); i != ids.end(); ++i )
+   {
+      std::ostringstream dir_stream;
+      dir_stream << root << "/cpu" << *i;
+      const std::string dir(dir_stream.str());
+
+      Cpu cpu;
+      cpu.id      = *i;
+      cpu.package = readInt(dir + "/topology/physical_package_id", 0);
+      cpu.core    = readInt(dir + "/topology/core_id", *i);
+      cpu.node    = 0;
+      cpu.cache   = *i;
+
+      // The NUMA node shows up as a nodeN entry in the CPU directory.
+      DIR* cpu_dir = opendir(dir.c_str());
+      if ( NULL != cpu_dir )
+      {
+         while ( dirent* entry = readdir(cpu_dir) )
+         {
+            if ( std::strncmp(entry->d_name, "node", 4) == 0 &&
+                 entry->d_name[4] >= '0' && entry->d_name[4] <= '9' )
+            {
+               cpu.node = std::atoi(entry->d_name + 4);
+               break;
+            }
+         }
+         closedir(cpu_dir);
+      }
+
+      // The last-level data or unified cache is identified by the lowest
+      // CPU that shares it.
+      int cache_level(0);
+      for ( int index = 0; ; ++index )
+      {
+         std::ostringstream cache_stream;
+         cache_stream << dir << "/cache/index" << index;
+         const std::string cache_dir(cache_stream.str());
+
+         std::string type;
+         if ( ! readLine(cache_dir + "/type", type) )
+         {
+            break;
+         }
+
+         const int level(readInt(cache_dir + "/level", 0));
+         std::string shared;
+         if ( type != "Instruction" && level > cache_level &&
+              readLine(cache_dir + "/shared_cpu_list", shared) )
+         {
+            const std::vector<int> sharing(parseCpuList(shared));
+            if ( ! sharing.empty() )
+            {
+               cache_level = level;
+               cpu.cache   = *std::min_element(sharing.begin(),
+                                               sharing.end());
+            }
+         }
+      }
+
+      cpus.push_back(cpu);
+   }
+#else
+   boost::ignore_unused_variable_warning(root);
+#endif
+
+   return cpus;
+}
+
+std::vector< std::vector<int> >
+ThreadPlacement::makePlan(const std::vector<Cpu>& cpus)
+{
+   std::vector< std::vector<int> > plan(NUM_ROLES);
+
+   // Group the logical CPUs by physical core.
+   std::vector<Core> cores;
+   for ( std::vector<Cpu>::const_iterator c = cpus.begin(); c != cpus.end();
+         ++c )
+   {
+      std::vector<Core>::iterator core = cores.begin();
+      while ( core != cores.end() &&
+              (core->package != c->package || core->core != c->core) )
+      {
+         ++core;
+      }
+
+      if ( core == cores.end() )
+      {
+         Core new_core;
+         new_core.package = c->package;
+         new_core.core    = c->core;
+         new_core.node    = c->node;
+         new_core.cache   = c->cache;
+         cores.push_back(new_core);
+         core = cores.end() - 1;
+      }
+      core->threads.push_back(c->id);
+   }
+
+   if ( cores.empty() )
+   {
+      return plan;
+   }
+
+   for ( std::vector<Core>::iterator c = cores.begin(); c != cores.end(); ++c )
+   {
+      std::sort(c->threads.begin(), c->threads.end());
+   }
+
+   // The housekeeping core is the one with the lowest CPU.  The kernel
+   // thread avoids it when there is another core.
+   std::sort(cores.begin(), cores.end(), CloserTo(cores[0]));
+   const Core housekeeping(cores[0]);
+   std::vector<Core> others(cores.begin() + 1, cores.end());
+   std::sort(others.begin(), others.end(), CloserTo(housekeeping));
+
+   const Core kernel(others.empty() ? housekeeping : others[0]);
+   if ( ! others.empty() )
+   {
+      others.erase(others.begin());
+   }
+   std::sort(others.begin(), others.end(), CloserTo(kernel));
+
+   const bool shared_housekeeping(kernel.threads[0] == housekeeping.threads[0]);
+
+   plan[KERNEL].push_back(kernel.threads[0]);
+
+   if ( kernel.threads.size() > 1 )
+   {
+      plan[DEVICE].push_back(kernel.threads[1]);
+   }
+   else if ( ! shared_housekeeping )
+   {
+      plan[DEVICE].push_back(housekeeping.threads[0]);
+   }
+   else
+   {
+      plan[DEVICE].push_back(kernel.threads[0]);
+   }
+
+   plan[NETWORK].push_back(housekeeping.threads[0]);
+
+   // Sound takes the core furthest from the kernel thread when at least two
+   // are left for drawing.
+   if ( others.size() >= 3 )
+   {
+      plan[SOUND].push_back(others.back().threads[0]);
+      others.pop_back();
+   }
+
+   // Draw threads get whole cores first and SMT siblings after that.
+   for ( std::vector<Core>::const_iterator c = others.begin();
+         c != others.end(); ++c )
+   {
+      plan[DRAW].push_back(c->threads[0]);
+   }
+   for ( std::vector<Core>::const_iterator c = others.begin();
+         c != others.end(); ++c )
+   {
+      plan[DRAW].insert(plan[DRAW].end(), c->threads.begin() + 1,
+                        c->threads.end());
+   }
+
+   // With only one or two cores, draw threads share the housekeeping core or,
+   // failing that, the kernel core.
+   if ( plan[DRAW].empty() )
+   {
+      plan[DRAW].push_back(shared_housekeeping ? plan[DEVICE][0]
+                                               : housekeeping.threads[0]);
+   }
+
+   if ( plan[SOUND].empty() )
+   {
+      plan[SOUND].push_back(plan[DRAW].back());
+   }
+
+   return plan;
+}
+
+const char* ThreadPlacement::getRoleName(const Role role)
+{
+   switch ( role )
+   {
+      case KERNEL:
+         return "kernel";
+      case DRAW:
+         return "draw";
+      case DEVICE:
+         return "device";
+      case NETWORK:
+         return "network";
+      case SOUND:
+         return "sound";
+      default:
+         return "unknown";
+   }
+}
+
+ThreadPlacement::ThreadPlacement()
+   : mEnabled(false)
+   , mSchedules(NUM_ROLES)
+{
+   std::string mode;
+   vpr::System::getenv("VPR_THREAD_PLACEMENT", mode);
+   mEnabled = mode == "auto";
+
+   for ( int role = 0; role < NUM_ROLES; ++role )
+   {
+      mSchedules[role].schedClass = BaseThread::VPR_SCHED_NORMAL;
+      mSchedules[role].priority   = 0;
+   }
+
+   std::string scheduling;
+   if ( vpr::System::getenv("VPR_THREAD_SCHEDULING", scheduling) )
+   {
+      readScheduling(scheduling);
+   }
+
+   mTopology = readTopology();
+
+#if defined(VPR_OS_Linux)
+   // Leave out the CPUs that this process may not use, such as those outside
+   // of a cpuset.
+   cpu_set_t allowed;
+   if ( sched_getaffinity(0, sizeof(allowed), &allowed) == 0 )
+   {
+      std::vector<Cpu> usable;
+      for ( std::vector<Cpu>::const_iterator c = mTopology.begin();
+            c != mTopology.end(); ++c )
+      {
+         if ( c->id < CPU_SETSIZE && CPU_ISSET(c->id, &allowed) )
+         {
+            usable.push_back(*c);
+         }
+      }
+      mTopology.swap(usable);
+   }
+#endif
+
+   mPlan = makePlan(mTopology);
+
+   vprDEBUG(vprDBG_ALL, vprDBG_CONFIG_LVL) << *this << vprDEBUG_FLUSH;
+}
+
+void ThreadPlacement::readScheduling(const std::string& config)
+{
+   std::vector<std::string> entries;
+   boost::split(entries, config, boost::is_any_of(" ,"),
+                boost::token_compress_on);
+
+   for ( std::vector<std::string>::iterator e = entries.begin();
+         e != entries.end(); ++e )
+   {
+      boost::trim(*e);
+      if ( e->empty() )
+      {
+         continue;
+      }
+
+      if ( *e == "memlock" )
+      {
+         lockMemory();
+         continue;
+      }
+
+      const std::string::size_type eq(e->find('='));
+      const std::string key(e->substr(0, eq));
+      const std::string value(eq == std::string::npos ? "" : e->substr(eq + 1));
+
+      if ( key == "slack" && ! value.empty() )
+      {
+         mTimerSlack.usec(std::atoi(value.c_str()));
+         continue;
+      }
+
+      int role(0);
+      while ( role < NUM_ROLES &&
+              key != getRoleName(static_cast<Role>(role)) )
+      {
+         ++role;
+      }
+
+      const std::string::size_type colon(value.find(':'));
+      const std::string class_name(value.substr(0, colon));
+      const int priority(colon == std::string::npos ? 1
+                            : std::atoi(value.c_str() + colon + 1));
+
+      BaseThread::VPRSchedClass sched_class(BaseThread::VPR_SCHED_NORMAL);
+      if ( class_name == "fifo" )
+      {
+         sched_class = BaseThread::VPR_SCHED_FIFO;
+      }
+      else if ( class_name == "rr" )
+      {
+         sched_class = BaseThread::VPR_SCHED_RR;
+      }
+      else if ( class_name != "normal" )
+      {
+         role = NUM_ROLES;
+      }
+
+      if ( role == NUM_ROLES )
+      {
+         vprDEBUG(vprDBG_ALL, vprDBG_WARNING_LVL)
+            << clrOutBOLD(clrYELLOW, "WARNING")
+            << ": Ignoring malformed VPR_THREAD_SCHEDULING entry '" << *e
+            << "'" << std::endl << vprDEBUG_FLUSH;
+         continue;
+      }
+
+      setSchedule(static_cast<Role>(role), sched_class, priority);
+   }
+}
+
+void ThreadPlacement::setSchedule(const Role role,
+                                  const BaseThread::VPRSchedClass schedClass,
+                                  const int priority)
+{
+   mSchedules[role].schedClass = schedClass;
+   mSchedules[role].priority   = priority;
+}
+
+int ThreadPlacement::getCpu(const Role role, const unsigned int index) const
+{
+   const std::vector<int>& cpus(mPlan[role]);
+   if ( ! mEnabled || cpus.empty() )
+   {
+      return -1;
+   }
+   return cpus[index % cpus.size()];
+}
+
+bool ThreadPlacement::place(const Role role, const unsigned int index)
+{
+   schedule(role);
+
+   const int cpu(getCpu(role, index));
+   vpr::Thread* self(vpr::Thread::self());
+
+   if ( cpu < 0 || NULL == self )
+   {
+      return false;
+   }
+
+   try
+   {
+      self->setRunOn(cpu);
+   }
+   catch (vpr::Exception& ex)
+   {
+      vprDEBUG(vprDBG_ALL, vprDBG_WARNING_LVL)
+         << clrOutBOLD(clrYELLOW, "WARNING")
+         << ": Could not place " << getRoleName(role) << " thread " << index
+         << " on CPU " << cpu << ": " << ex.what() << std::endl
+         << vprDEBUG_FLUSH;
+      return false;
+   }
+
+   vprDEBUG(vprDBG_ALL, vprDBG_STATE_LVL)
+      << "Placed " << getRoleName(role) << " thread " << index << " on CPU "
+      << cpu << std::endl << vprDEBUG_FLUSH;
+
+   return true;
+}
+
+bool ThreadPlacement::schedule(const Role role)
+{
+   vpr::Thread* self(vpr::Thread::self());
+   if ( NULL == self )
+   {
+      return false;
+   }
+
+   if ( mTimerSlack.usec() > 0 )
+   {
+      try
+      {
+         self->setTimerSlack(mTimerSlack);
+      }
+      catch (vpr::Exception& ex)
+      {
+         vprDEBUG(vprDBG_ALL, vprDBG_WARNING_LVL)
+            << clrOutBOLD(clrYELLOW, "WARNING")
+            << ": Could not set the timer slack of a " << getRoleName(role)
+            << " thread: " << ex.what() << std::endl << vprDEBUG_FLUSH;
+      }
+   }
+
+   const Schedule& sched(mSchedules[role]);
+   if ( BaseThread::VPR_SCHED_NORMAL == sched.schedClass )
+   {
+      return true;
+   }
+
+   try
+   {
+      self->setSchedClass(sched.schedClass, sched.priority);
+
+      vprDEBUG(vprDBG_ALL, vprDBG_STATE_LVL)
+         << "Scheduled " << getRoleName(role) << " thread as "
+         << getSchedClassName(sched.schedClass) << ":" << sched.priority
+         << std::endl << vprDEBUG_FLUSH;
+
+      return true;
+   }
+   catch (vpr::Exception& ex)
+   {
+      // Unprivileged processes may still use real-time priorities up to
+      // RLIMIT_RTPRIO.
+      int allowed(0);
+#if defined(VPR_OS_Linux)
+      struct rlimit limit;
+      if ( getrlimit(RLIMIT_RTPRIO, &limit) == 0 )
+      {
+         allowed = static_cast<int>(std::min<rlim_t>(limit.rlim_cur, 99));
+      }
+#endif
+
+      if ( allowed > 0 && allowed < sched.priority )
+      {
+         try
+         {
+            self->setSchedClass(sched.schedClass, allowed);
+
+            vprDEBUG(vprDBG_ALL, vprDBG_WARNING_LVL)
+               << clrOutBOLD(clrYELLOW, "WARNING")
+               << ": Scheduled " << getRoleName(role) << " thread as "
+               << getSchedClassName(sched.schedClass) << ":" << allowed
+               << " instead of priority " << sched.priority
+               << " (RLIMIT_RTPRIO)" << std::endl << vprDEBUG_FLUSH;
+
+            return false;
+         }
+         catch (vpr::Exception&)
+         {
+         }
+      }
+
+      vprDEBUG(vprDBG_ALL, vprDBG_WARNING_LVL)
+         << clrOutBOLD(clrYELLOW, "WARNING")
+         << ": Could not schedule " << getRoleName(role) << " thread as "
+         << getSchedClassName(sched.schedClass) << ":" << sched.priority
+         << ": " << ex.what() << std::endl << vprDEBUG_FLUSH;
+      vprDEBUG_NEXT(vprDBG_ALL, vprDBG_WARNING_LVL)
+         << "The thread stays in the normal scheduling class." << std::endl
+         << vprDEBUG_FLUSH;
+
+      return false;
+   }
+}
+
+bool ThreadPlacement::lockMemory()
+{
+#if defined(_POSIX_MEMLOCK) && _POSIX_MEMLOCK > 0
+   if ( mlockall(MCL_CURRENT | MCL_FUTURE) == 0 )
+   {
+      vprDEBUG(vprDBG_ALL, vprDBG_CONFIG_LVL)
+         << "Locked process memory" << std::endl << vprDEBUG_FLUSH;
+      return true;
+   }
+
+   vprDEBUG(vprDBG_ALL, vprDBG_WARNING_LVL)
+      << clrOutBOLD(clrYELLOW, "WARNING")
+      << ": Could not lock process memory: "
+      << vpr::Error::getCurrentErrorMsg() << std::endl << vprDEBUG_FLUSH;
+#else
+   vprDEBUG(vprDBG_ALL, vprDBG_WARNING_LVL)
+      << clrOutBOLD(clrYELLOW, "WARNING")
+      << ": Memory locking is not available on this platform" << std::endl
+      << vprDEBUG_FLUSH;
+#endif
+
+   return false;
+}
+
+std::ostream& ThreadPlacement::print(std::ostream& out) const
+{
+   std::vector<int> cores, caches, nodes;
+   for ( std::vector<Cpu>::const_iterator c = mTopology.begin();
+         c != mTopology.end(); ++c )
+   {
+      cores.push_back(c->package * 65536 + c->core);
+      caches.push_back(c->cache);
+      nodes.push_back(c->node);
+   }
+
+   out << "Thread placement " << (mEnabled ? "enabled" : "disabled") << ": "
+       << mTopology.size() << " CPUs, " << countDistinct(cores)
+       << " cores, " << countDistinct(caches) << " last-level caches, "
+       << countDistinct(nodes) << " nodes\n";
+
+   for ( int role = 0; role < NUM_ROLES; ++role )
+   {
+      out << "   " << getRoleName(static_cast<Role>(role)) << ":";
+      for ( std::vector<int>::const_iterator c = mPlan[role].begin();
+            c != mPlan[role].end(); ++c )
+      {
+         out << " " << *c;
+      }
+      out << " (" << getSchedClassName(mSchedules[role].schedClass);
+      if ( BaseThread::VPR_SCHED_NORMAL != mSchedules[role].schedClass )
+      {
+         out << ":" << mSchedules[role].priority;
+      }
+      out << ")\n";
+   }
+
+   if ( mTimerSlack.usec() > 0 )
+   {
+      out << "   timer slack: " << mTimerSlack.usec() << " us\n";
+   }
+
+   return out;
+}
+
+std::ostream& operator<<(std::ostream& out, const ThreadPlacement& placement)
+{
+   return placement.print(out);
+}
+
+} // End of vpr namespace
@@ -0,0 +1,274 @@
+/****************** <VPR heading BEGIN do not edit this line> *****************
+ *
+ * VR Juggler Portable Runtime
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Patrick Hartling, Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <VPR heading END do not edit this line> ******************/
+
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _VPR_THREAD_PLACEMENT_H_
+#define _VPR_THREAD_PLACEMENT_H_
+
+#include <vpr/vprConfig.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <vpr/Thread/BaseThread.h>
+#include <vpr/Util/Interval.h>
+#include <vpr/Util/Singleton.h>
+
+
+namespace vpr
+{
+
+/** \class ThreadPlacement ThreadPlacement.h vpr/Thread/ThreadPlacement.h
+ *
+ * Places the long-running threads of an application on CPUs according to the
+ * processor topology and gives them the scheduling class configured for
+ * their role.  The topology (logical CPUs, physical cores, last-level cache
+ * domains and NUMA nodes) is read from /sys/devices/system/cpu, and a plan
+ * is made that maps each thread role to a list of CPUs:
+ *
+ *  - The kernel thread gets a core of its own on the node of CPU 0, but not
+ *    the core of CPU 0, which usually handles interrupts and housekeeping.
+ *  - Device samplers, which produce the data that the kernel thread reads
+ *    every frame, go on the SMT sibling of the kernel core so that the data
+ *    stays in the shared L1/L2 caches.
+ *  - Networking goes on the core of CPU 0, where network interrupts are
+ *    normally serviced.
+ *  - Draw threads get whole cores, first those that share the last-level
+ *    cache of the kernel core, then those on the same node, then the other
+ *    nodes.  SMT siblings are used only once every core has a draw thread.
+ *  - Sound gets the core that is furthest from the kernel thread when there
+ *    are enough cores left over.
+ *
+ * Placement is off unless the \c VPR_THREAD_PLACEMENT environment variable is
+ * set to "auto" or setEnabled() is called.  Only Linux exposes the topology;
+ * on other platforms the plan is empty.
+ *
+ * Scheduling is configured with the \c VPR_THREAD_SCHEDULING environment
+ * variable or with setSchedule().  The variable holds a list of entries
+ * separated by spaces or commas:
+ *
+ *  - <role>=<class>[:<priority>] gives the threads of a role the scheduling
+ *    class "normal", "fifo" or "rr" with the given real-time priority, for
+ *    example "kernel=fifo:80 draw=fifo:70 device=rr:85".
+ *  - slack=<microseconds> sets the timer slack of every thread that is
+ *    scheduled through this class.
+ *  - memlock locks all current and future pages of the process in memory
+ *    so that page faults do not stall the real-time threads.
+ *
+ * When the process lacks the privileges for the requested real-time
+ * priority, the highest priority allowed by RLIMIT_RTPRIO is used instead,
+ * and when no real-time priority is allowed, the thread stays in the normal
+ * class.  Either way a warning is printed and the application keeps
+ * running.
+ *
+ * Threads opt in by calling place() (or schedule() when something else
+ * chooses their CPU) from the thread itself.
+ */
+class VPR_API ThreadPlacement
+{
+public:
+   /** The thread roles that the plan assigns CPUs to. */
+   enum Role
+   {
+      KERNEL,   /**< The kernel control loop */
+      DRAW,     /**< Draw threads, one per pipe */
+      DEVICE,   /**< Input device sampling threads */
+      NETWORK,  /**< Networking threads */
+      SOUND,    /**< Audio threads */
+      NUM_ROLES
+   };
+
+   /** A logical CPU as described by sysfs. */
+   struct Cpu
+   {
+      int id;       /**< Logical CPU number */
+      int package;  /**< Physical package (socket) */
+      int core;     /**< Core within the package */
+      int node;     /**< NUMA node */
+      int cache;    /**< Lowest CPU that shares the last-level cache */
+   };
+
+   /**
+    * Reads the topology of the online CPUs.
+    *
+    * @param root The sysfs CPU directory.  Another directory laid out the
+    *             same way can be given to try out plans for other machines.
+    *
+    * @return The CPUs sorted by ID or an empty vector if the topology could
+    *         not be read.
+    */
+   static std::vector<Cpu> readTopology(
+      const std::string& root = "/sys/devices/system/cpu"
+   );
+
+   /**
+    * Makes a plan for the given CPUs.
+    *
+    * @return One list of CPU IDs per role, indexed by vpr::ThreadPlacement::Role.
+    *         Every list is empty if \p cpus is empty.
+    */
+   static std::vector< std::vector<int> > makePlan(const std::vector<Cpu>& cpus);
+
+   /** Returns the name of the given role. */
+   static const char* getRoleName(const Role role);
+
+   /** Returns whether threads are placed by place(). */
+   bool isEnabled() const
+   {
+      return mEnabled;
+   }
+
+   /** Turns placement on or off.  Threads that were placed stay where they are. */
+   void setEnabled(const bool enabled)
+   {
+      mEnabled = enabled;
+   }
+
+   /** Returns the CPUs that this process may run on. */
+   const std::vector<Cpu>& getTopology() const
+   {
+      return mTopology;
+   }
+
+   /** Returns the CPUs planned for the given role. */
+   const std::vector<int>& getCpus(const Role role) const
+   {
+      return mPlan[role];
+   }
+
+   /**
+    * Returns the CPU for the given thread of the given role, or -1 if
+    * placement is disabled or there is no plan.  When a role has more
+    * threads than CPUs, the CPUs are handed out again from the start.
+    */
+   int getCpu(const Role role, const unsigned int index = 0) const;
+
+   /**
+    * Binds the calling thread to the CPU planned for it and gives it the
+    * scheduling class of its role (see schedule()).  The calling thread must
+    * be a vpr::Thread.
+    *
+    * @param role  The role of the calling thread.
+    * @param index The number of the thread within its role, such as the
+    *              pipe number of a draw thread.
+    *
+    * @return true if the thread was bound to a CPU.
+    */
+   bool place(const Role role, const unsigned int index = 0);
+
+   /** The scheduling class and real-time priority of a role. */
+   struct Schedule
+   {
+      BaseThread::VPRSchedClass schedClass;
+      int                       priority;
+   };
+
+   /** Returns the scheduling class and priority of the given role. */
+   const Schedule& getSchedule(const Role role) const
+   {
+      return mSchedules[role];
+   }
+
+   /**
+    * Sets the scheduling class and priority of the given role.  This takes
+    * effect for threads that call place() or schedule() afterwards.
+    */
+   void setSchedule(const Role role, const BaseThread::VPRSchedClass schedClass,
+                    const int priority = 1);
+
+   /**
+    * Sets the timer slack given to scheduled threads.  Zero (the default)
+    * leaves the slack of each thread alone.
+    */
+   void setTimerSlack(const vpr::Interval& slack)
+   {
+      mTimerSlack = slack;
+   }
+
+   /**
+    * Gives the calling thread the scheduling class and timer slack
+    * configured for its role.  The calling thread must be a vpr::Thread.
+    *
+    * @return true if the thread got the configured scheduling class and
+    *         priority, false if it fell back to a lower priority or to the
+    *         normal class.
+    */
+   bool schedule(const Role role);
+
+   /**
+    * Locks all current and future pages of the process in memory.  Every
+    * thread stack created afterwards is locked as well, so this may fail
+    * later thread creation when RLIMIT_MEMLOCK is small.
+    *
+    * @return true if the memory was locked.  A warning is printed otherwise.
+    */
+   static bool lockMemory();
+
+   /** Prints the topology summary, the plan and the schedules. */
+   std::ostream& print(std::ostream& out) const;
+
+protected:
+   /**
+    * Reads the topology, makes the plan and reads the scheduling
+    * configuration.
+    */
+   ThreadPlacement();
+
+   ThreadPlacement(const ThreadPlacement&)
+   {;}
+
+   void operator=(const ThreadPlacement&)
+   {;}
+
+   vprSingletonHeader(ThreadPlacement);
+
+private:
+   /** Applies the entries of a \c VPR_THREAD_SCHEDULING value. */
+   void readScheduling(const std::string& config);
+
+   bool                            mEnabled;
+   std::vector<Cpu>                mTopology;
+   std::vector< std::vector<int> > mPlan;
+   std::vector<Schedule>           mSchedules;
+   vpr::Interval                   mTimerSlack;
+};
+
+VPR_API std::ostream& operator<<(std::ostream& out,
+                                 const ThreadPlacement& placement);
+
+} // End of vpr namespace
+
+
+#endif /* _VPR_THREAD_PLACEMENT_H_ */
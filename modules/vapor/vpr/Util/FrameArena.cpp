@@ -0,0 +1,298 @@
+/****************** <VPR heading BEGIN do not edit this line> *****************
+ *
+ * VR Juggler Portable Runtime
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Patrick Hartling, Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <VPR heading END do not edit this line> ******************/
+
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <vpr/vprConfig.h>
+
+#include <algorithm>
+#include <vector>
+#include <boost/concept_check.hpp>
+#include <boost/detail/atomic_count.hpp>
+
+#include <vpr/Util/Assert.h>
+#include <vpr/Util/FrameArena.h>
+
+
+namespace vpr
+{
+
+namespace detail
+{
+
+/**
+ * The part of a vpr::FrameArena that its blocks point to.  The owning thread
+ * counts its own allocations and releases without atomic operations; only
+ * releases from other threads go through \c foreignFrees.
+ */
+struct FrameArenaState
+{
+   FrameArenaState()
+      : ownerLive(0)
+      , foreignFrees(0)
+      , foreignBase(0)
+   {
+   }
+
+   long live() const
+   {
+      return ownerLive - (foreignFrees - foreignBase);
+   }
+
+   ~FrameArenaState()
+   {
+      for ( std::vector<char*>::iterator c = chunks.begin();
+            c != chunks.end(); ++c )
+      {
+         ::operator delete(*c);
+      }
+   }
+
+   long                        ownerLive;    /**< Blocks allocated less those released by the owner */
+   boost::detail::atomic_count foreignFrees; /**< Blocks released by other threads */
+   long                        foreignBase;  /**< foreignFrees at the last rewind */
+   std::vector<char*>          chunks;
+};
+
+}
+
+}
+
+namespace
+{
+
+/**
+ * Every block starts with a pointer to the state of the arena it came from
+ * (NULL for heap blocks).  The header is 16 bytes so that blocks stay aligned
+ * for any type.
+ */
+const std::size_t HEADER_SIZE(16);
+
+inline std::size_t roundUp(const std::size_t size)
+{
+   return (size + HEADER_SIZE - 1) & ~(HEADER_SIZE - 1);
+}
+
+inline vpr::detail::FrameArenaState*& owner(char* block)
+{
+   return *reinterpret_cast<vpr::detail::FrameArenaState**>(block);
+}
+
+void* allocateHeap(const std::size_t size)
+{
+   char* block = static_cast<char*>(::operator new(HEADER_SIZE + size));
+   owner(block) = NULL;
+   return block + HEADER_SIZE;
+}
+
+#if defined(VPR_THREAD_LOCAL)
+VPR_THREAD_LOCAL vpr::FrameArena* sCurrentArena = NULL;
+VPR_THREAD_LOCAL unsigned int sScopeDepth = 0;
+#endif
+
+}
+
+namespace vpr
+{
+
+FrameArena::Scope::Scope()
+{
+#if defined(VPR_THREAD_LOCAL)
+   ++sScopeDepth;
+#endif
+}
+
+FrameArena::Scope::~Scope()
+{
+#if defined(VPR_THREAD_LOCAL)
+   --sScopeDepth;
+#endif
+}
+
+FrameArena::FrameArena(const std::size_t chunkSize, const std::size_t maxSize)
+   : mState(new detail::FrameArenaState())
+   , mChunkSize(roundUp(chunkSize))
+   , mMaxChunks(std::max(maxSize / mChunkSize, std::size_t(1)))
+   , mChunk(0)
+   , mOffset(0)
+   , mInUse(0)
+{
+   vprASSERT(mChunkSize > HEADER_SIZE && "Chunk size is too small");
+
+   // The chunk list itself must not allocate on the frame path.
+   mState->chunks.reserve(mMaxChunks);
+}
+
+FrameArena::~FrameArena()
+{
+   if ( getCurrent() == this )
+   {
+      setCurrent(NULL);
+   }
+
+   // Blocks that are still alive keep pointing into the chunks, so those
+   // are leaked rather than freed under them.  This only happens when
+   // frame-scoped objects outlive their owner at shutdown.
+   if ( mState->live() == 0 )
+   {
+      delete mState;
+   }
+}
+
+void FrameArena::reset()
+{
+   ++mStats.frames;
+
+   if ( mState->live() == 0 )
+   {
+      mState->ownerLive   = 0;
+      mState->foreignBase = mState->foreignFrees;
+      mChunk  = 0;
+      mOffset = 0;
+      mInUse  = 0;
+   }
+   else
+   {
+      ++mStats.deferredResets;
+   }
+}
+
+std::size_t FrameArena::getLiveCount() const
+{
+   return static_cast<std::size_t>(mState->live());
+}
+
+void FrameArena::setCurrent(FrameArena* arena)
+{
+#if defined(VPR_THREAD_LOCAL)
+   sCurrentArena = arena;
+#else
+   boost::ignore_unused_variable_warning(arena);
+#endif
+}
+
+FrameArena* FrameArena::getCurrent()
+{
+#if defined(VPR_THREAD_LOCAL)
+   return sCurrentArena;
+#else
+   return NULL;
+#endif
+}
+
+void* FrameArena::allocate(const std::size_t size)
+{
+#if defined(VPR_THREAD_LOCAL)
+   if ( sScopeDepth > 0 && NULL != sCurrentArena )
+   {
+      return sCurrentArena->allocateBlock(size);
+   }
+#endif
+
+   return allocateHeap(size);
+}
+
+void FrameArena::deallocate(void* ptr)
+{
+   if ( NULL == ptr )
+   {
+      return;
+   }
+
+   char* block = static_cast<char*>(ptr) - HEADER_SIZE;
+   detail::FrameArenaState* state = owner(block);
+
+   if ( NULL == state )
+   {
+      ::operator delete(block);
+   }
+#if defined(VPR_THREAD_LOCAL)
+   else if ( NULL != sCurrentArena && sCurrentArena->mState == state )
+   {
+      --state->ownerLive;
+   }
+#endif
+   else
+   {
+      ++state->foreignFrees;
+   }
+}
+
+void* FrameArena::allocateBlock(const std::size_t size)
+{
+   const std::size_t needed(HEADER_SIZE + roundUp(size));
+   std::vector<char*>& chunks(mState->chunks);
+
+   if ( needed <= mChunkSize )
+   {
+      // Move on to the next chunk when this one is full, and add a chunk
+      // when there is no next one and the limit allows it.
+      if ( mChunk < chunks.size() && mOffset + needed > mChunkSize )
+      {
+         ++mChunk;
+         mOffset = 0;
+      }
+
+      if ( mChunk == chunks.size() && chunks.size() < mMaxChunks )
+      {
+         char* chunk =
+            static_cast<char*>(::operator new(mChunkSize, std::nothrow));
+
+         if ( NULL != chunk )
+         {
+            chunks.push_back(chunk);
+         }
+      }
+
+      if ( mChunk < chunks.size() )
+      {
+         char* block = chunks[mChunk] + mOffset;
+         mOffset += needed;
+         mInUse  += needed;
+
+         ++mState->ownerLive;
+         owner(block) = mState;
+
+         ++mStats.allocations;
+         mStats.bytes    += size;
+         mStats.peakBytes = std::max(mStats.peakBytes, mInUse);
+
+         return block + HEADER_SIZE;
+      }
+   }
+
+   ++mStats.heapAllocations;
+   return allocateHeap(size);
+}
+
+} // End of vpr namespace
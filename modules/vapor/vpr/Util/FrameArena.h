@@ -0,0 +1,272 @@
+/****************** <VPR heading BEGIN do not edit this line> *****************
+ *
+ * VR Juggler Portable Runtime
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Patrick Hartling, Kevin Meinert, Carolina Cruz-Neira
+ *
+ ****************** <VPR heading END do not edit this line> ******************/
+
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _VPR_FRAME_ARENA_H_
+#define _VPR_FRAME_ARENA_H_
+
+#include <vpr/vprConfig.h>
+
+#include <cstddef>
+#include <new>
+#include <boost/noncopyable.hpp>
+
+#include <vpr/vprTypes.h>
+
+
+namespace vpr
+{
+
+namespace detail
+{
+   struct FrameArenaState;
+}
+
+/** \class FrameArena FrameArena.h vpr/Util/FrameArena.h
+ *
+ * Memory for objects that live no longer than one frame.  Allocation bumps a
+ * pointer through a list of chunks, and reset() rewinds it at the frame
+ * boundary, so a loop that creates the same temporaries every frame stops
+ * calling malloc() once the chunks have grown to the working size.
+ *
+ * An arena belongs to one thread.  The owner installs it with setCurrent(),
+ * and code on a hot path opts in by opening a vpr::FrameArena::Scope around
+ * the allocations that should come from it.  The static allocate() takes
+ * memory from the current arena while a scope is open on the calling thread
+ * and from the heap otherwise, so the same code can run on any thread.
+ * deallocate() may be called from any thread and works for both kinds of
+ * memory.
+ *
+ * Memory is never handed out twice while a block from the arena is still
+ * alive: reset() only rewinds when every block has been released.  An object
+ * that outlives its frame delays the rewind (and is counted in
+ * Stats::deferredResets) instead of being overwritten.  Once the arena has
+ * grown to its size limit, further requests go to the heap until it can be
+ * rewound.
+ *
+ * Without compiler support for thread-local variables (see
+ * VPR_THREAD_LOCAL), there is no current arena and everything comes from the
+ * heap.
+ */
+class VPR_API FrameArena : boost::noncopyable
+{
+public:
+   /** Allocation counters, accumulated since the arena was created. */
+   struct Stats
+   {
+      Stats()
+         : frames(0)
+         , allocations(0)
+         , heapAllocations(0)
+         , bytes(0)
+         , peakBytes(0)
+         , deferredResets(0)
+      {
+      }
+
+      vpr::Uint64 frames;          /**< Calls to reset() */
+      vpr::Uint64 allocations;     /**< Blocks served from the arena */
+      vpr::Uint64 heapAllocations; /**< Blocks requested in a scope that had
+                                        to come from the heap */
+      vpr::Uint64 bytes;           /**< Bytes served from the arena */
+      std::size_t peakBytes;       /**< Most arena bytes in use at once */
+      vpr::Uint64 deferredResets;  /**< Resets that could not rewind */
+   };
+
+   /**
+    * Opens a scope in which vpr::FrameArena::allocate() draws from the
+    * current arena of the calling thread.  Scopes nest.
+    */
+   class VPR_API Scope : boost::noncopyable
+   {
+   public:
+      Scope();
+
+      ~Scope();
+   };
+
+   /**
+    * Creates an empty arena.  No chunk is allocated until the first
+    * allocation.
+    *
+    * @param chunkSize The size of each chunk.  Larger requests always go to
+    *                  the heap.
+    * @param maxSize   The most memory the arena grows to.
+    */
+   FrameArena(const std::size_t chunkSize = 64 * 1024,
+              const std::size_t maxSize = 4 * 1024 * 1024);
+
+   /**
+    * Releases the chunks.  If blocks from this arena are still alive, the
+    * chunks are left allocated so that those blocks stay valid.
+    */
+   ~FrameArena();
+
+   /**
+    * Marks a frame boundary.  Rewinds the arena if none of its blocks are
+    * alive any more.
+    *
+    * @pre Called by the thread that owns the arena.
+    */
+   void reset();
+
+   const Stats& getStats() const
+   {
+      return mStats;
+   }
+
+   /** Returns the number of blocks from this arena that are still alive. */
+   std::size_t getLiveCount() const;
+
+   /**
+    * Makes \p arena the current arena of the calling thread.  Pass NULL to
+    * remove it.
+    */
+   static void setCurrent(FrameArena* arena);
+
+   /** Returns the current arena of the calling thread or NULL. */
+   static FrameArena* getCurrent();
+
+   /**
+    * Allocates \p size bytes, aligned for any type, from the current arena if
+    * a scope is open on the calling thread and from the heap otherwise.
+    *
+    * @throw std::bad_alloc is thrown if the heap is exhausted.
+    */
+   static void* allocate(const std::size_t size);
+
+   /**
+    * Releases memory returned by allocate().  This may be called from any
+    * thread.  NULL is ignored.
+    */
+   static void deallocate(void* ptr);
+
+private:
+   void* allocateBlock(const std::size_t size);
+
+   detail::FrameArenaState* mState;
+   const std::size_t  mChunkSize;
+   const std::size_t  mMaxChunks;
+   std::size_t        mChunk;   /**< Index of the chunk being filled */
+   std::size_t        mOffset;  /**< Bytes used in that chunk */
+   std::size_t        mInUse;   /**< Bytes handed out since the last rewind */
+   Stats              mStats;
+};
+
+/** \class FrameAllocator FrameArena.h vpr/Util/FrameArena.h
+ *
+ * Standard allocator that gets its memory from vpr::FrameArena::allocate().
+ * It can be given to containers and to the boost::shared_ptr constructor
+ * that takes an allocator so that their storage comes from the frame arena
+ * when they are created inside a vpr::FrameArena::Scope.
+ */
+template<typename T>
+class FrameAllocator
+{
+public:
+   typedef T              value_type;
+   typedef T*             pointer;
+   typedef const T*       const_pointer;
+   typedef T&             reference;
+   typedef const T&       const_reference;
+   typedef std::size_t    size_type;
+   typedef std::ptrdiff_t difference_type;
+
+   template<typename U>
+   struct rebind
+   {
+      typedef FrameAllocator<U> other;
+   };
+
+   FrameAllocator()
+   {
+   }
+
+   template<typename U>
+   FrameAllocator(const FrameAllocator<U>&)
+   {
+   }
+
+   pointer address(reference x) const
+   {
+      return &x;
+   }
+
+   const_pointer address(const_reference x) const
+   {
+      return &x;
+   }
+
+   pointer allocate(const size_type n, const void* = 0)
+   {
+      return static_cast<pointer>(FrameArena::allocate(n * sizeof(T)));
+   }
+
+   void deallocate(pointer p, const size_type)
+   {
+      FrameArena::deallocate(p);
+   }
+
+   size_type max_size() const
+   {
+      return static_cast<size_type>(-1) / sizeof(T);
+   }
+
+   void construct(pointer p, const T& value)
+   {
+      new (p) T(value);
+   }
+
+   void destroy(pointer p)
+   {
+      p->~T();
+   }
+};
+
+template<typename T, typename U>
+inline bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&)
+{
+   return true;
+}
+
+template<typename T, typename U>
+inline bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&)
+{
+   return false;
+}
+
+} // End of vpr namespace
+
+
+#endif /* _VPR_FRAME_ARENA_H_ */
@@ -55,6 +55,7 @@
 #include <vpr/Thread/BaseThread.h>
 #include <vpr/Thread/ThreadManager.h>
 #include <vpr/Thread/UncaughtThreadException.h>
+#include <vpr/Util/Interval.h>
 
 #include <vpr/md/NSPR/Thread/ThreadKeyNSPR.h>
 #include <vpr/md/NSPR/Sync/CondVarNSPR.h>
@@ -312,6 +313,33 @@ public:
       return std::vector<unsigned int>();
    }
 
+   /**
+    * Gets this thread's scheduling class.  This implementation always
+    * returns \c VPR_SCHED_NORMAL.
+    */
+   VPRSchedClass getSchedClass() const
+   {
+      return VPR_SCHED_NORMAL;
+   }
+
+   /**
+    * Sets this thread's scheduling class.  NSPR has no scheduling classes,
+    * so this implementation does nothing.
+    */
+   void setSchedClass(const VPRSchedClass schedClass, const int priority = 1)
+   {
+      boost::ignore_unused_variable_warning(schedClass);
+      boost::ignore_unused_variable_warning(priority);
+   }
+
+   /**
+    * Sets the timer slack of this thread.  This implementation does nothing.
+    */
+   void setTimerSlack(const vpr::Interval& slack)
+   {
+      boost::ignore_unused_variable_warning(slack);
+   }
+
    /**
     * Sends the specified signal to this thread (not necessarily \c SIGKILL).
     *
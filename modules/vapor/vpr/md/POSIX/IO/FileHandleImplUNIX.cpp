@@ -598,7 +598,7 @@ bool FileHandleImplUNIX::isReadable(const vpr::Interval timeout) const
          if ( timeout.msec() >= 1000 )
          {
             timeout_obj.tv_sec  = timeout.msec() / 1000;
-            timeout_obj.tv_usec = (timeout.msec() % 1000) * 1000000;
+            timeout_obj.tv_usec = (timeout.msec() % 1000) * 1000;
          }
          else
          {
@@ -661,7 +661,7 @@ bool FileHandleImplUNIX::isWriteable(const vpr::Interval timeout) const
          if ( timeout.msec() >= 1000 )
          {
             timeout_obj.tv_sec  = timeout.msec() / 1000;
-            timeout_obj.tv_usec = (timeout.msec() % 1000) * 1000000;
+            timeout_obj.tv_usec = (timeout.msec() % 1000) * 1000;
          }
          else
          {
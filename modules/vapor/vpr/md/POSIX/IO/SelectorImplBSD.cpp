@@ -194,7 +194,7 @@ void SelectorImplBSD::select (vpr::Uint16& numWithEvents,
       if ( timeout.msec() >= 1000 )
       {
          timeout_obj.tv_sec  = timeout.msec() / 1000;
-         timeout_obj.tv_usec = (timeout.msec() % 1000) * 1000000;
+         timeout_obj.tv_usec = (timeout.msec() % 1000) * 1000;
       }
       else
       {
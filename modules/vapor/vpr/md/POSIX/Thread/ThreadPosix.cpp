@@ -35,6 +35,7 @@
 
 #include <vpr/vprConfig.h>
 
+#include <algorithm>
 #include <cstring>
 #include <iomanip>
 #include <sstream>
@@ -49,6 +50,10 @@
 #  include <sys/capability.h>
 #endif
 
+#if defined(VPR_OS_Linux)
+#  include <sys/prctl.h>
+#endif
+
 #include <boost/concept_check.hpp>
 #include <boost/bind.hpp>
 
@@ -517,6 +522,95 @@ std::vector<unsigned int> ThreadPosix::getRunOn() const
    return cpus;
 }
 
+BaseThread::VPRSchedClass ThreadPosix::getSchedClass() const
+{
+   int policy;
+   sched_param_t sched_param;
+
+   const int result = pthread_getschedparam(mThread, &policy, &sched_param);
+
+   if ( ESRCH == result )
+   {
+      throw vpr::IllegalArgumentException(
+         "Cannot query scheduling class for invalid thread", VPR_LOCATION
+      );
+   }
+
+   switch ( policy )
+   {
+      case SCHED_FIFO:
+         return VPR_SCHED_FIFO;
+      case SCHED_RR:
+         return VPR_SCHED_RR;
+      default:
+         return VPR_SCHED_NORMAL;
+   }
+}
+
+void ThreadPosix::setSchedClass(const VPRSchedClass schedClass,
+                                const int priority)
+{
+   int policy(SCHED_OTHER);
+   if ( VPR_SCHED_FIFO == schedClass )
+   {
+      policy = SCHED_FIFO;
+   }
+   else if ( VPR_SCHED_RR == schedClass )
+   {
+      policy = SCHED_RR;
+   }
+
+   sched_param_t sched_param;
+   std::memset(&sched_param, 0, sizeof(sched_param));
+   sched_param.sched_priority =
+      std::max(sched_get_priority_min(policy),
+               std::min(priority, sched_get_priority_max(policy)));
+
+   const int result = pthread_setschedparam(mThread, policy, &sched_param);
+
+   if ( ESRCH == result )
+   {
+      throw vpr::IllegalArgumentException(
+         "Cannot set scheduling class for invalid thread", VPR_LOCATION
+      );
+   }
+   else if ( result != 0 )
+   {
+      std::ostringstream msg_stream;
+      msg_stream << "Failed to set scheduling policy " << policy
+                 << " with priority " << sched_param.sched_priority << ": "
+                 << std::strerror(result);
+      throw vpr::Exception(msg_stream.str(), VPR_LOCATION);
+   }
+}
+
+void ThreadPosix::setTimerSlack(const vpr::Interval& slack)
+{
+   if ( ThreadPosix::self() == this )
+   {
+#if defined(VPR_OS_Linux) && defined(PR_SET_TIMERSLACK)
+      // Zero makes the kernel use the default slack of the process.
+      const unsigned long slack_ns(slack.usec() * 1000);
+      if ( prctl(PR_SET_TIMERSLACK, slack_ns, 0, 0, 0) != 0 )
+      {
+         std::ostringstream msg_stream;
+         msg_stream << "Failed to set timer slack: "
+                    << vpr::Error::getCurrentErrorMsg();
+         throw vpr::Exception(msg_stream.str(), VPR_LOCATION);
+      }
+#else
+      boost::ignore_unused_variable_warning(slack);
+#endif
+   }
+   else
+   {
+      throw vpr::IllegalArgumentException(
+         "Timer slack can only be set for a thread object from its thread",
+         VPR_LOCATION
+      );
+   }
+}
+
 void ThreadPosix::kill(const int signum)
 {
    const int result = pthread_kill(mThread, signum);
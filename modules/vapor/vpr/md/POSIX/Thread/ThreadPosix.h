@@ -54,6 +54,7 @@
 // To get the POSIX key stuff for storing self.
 #include <vpr/md/POSIX/Thread/ThreadKeyPosix.h>
 #include <vpr/Thread/UncaughtThreadException.h>
+#include <vpr/Util/Interval.h>
 #include <vpr/md/POSIX/Sync/CondVarPosix.h>
 
 namespace vpr
@@ -359,6 +360,60 @@ public:  // ----- Various other thread functions ------
     */
    std::vector<unsigned int> getRunOn() const;
 
+   /**
+    * Gets this thread's scheduling class.
+    *
+    * @return The scheduling class of this thread.  Classes other than FIFO
+    *         and round-robin (such as SCHED_BATCH) are reported as
+    *         \c VPR_SCHED_NORMAL.
+    *
+    * @throw vpr::IllegalArgumentException is thrown if this is not a valid
+    *        thread (and thus cannot have its scheduling queried).
+    */
+   VPRSchedClass getSchedClass() const;
+
+   /**
+    * Sets this thread's scheduling class.
+    *
+    * @post This thread has the given scheduling class and priority or an
+    *       exception is thrown and its scheduling is unchanged.
+    *
+    * @param schedClass The new scheduling class.
+    * @param priority   The real-time priority.  This is clamped to the range
+    *                   that the system allows for \p schedClass (1 to 99 on
+    *                   Linux) and ignored for \c VPR_SCHED_NORMAL.
+    *
+    * @throw vpr::IllegalArgumentException is thrown if this is not a valid
+    *        thread.
+    * @throw vpr::Exception is thrown if the process lacks the privileges
+    *        to use the requested class and priority.
+    *
+    * @note Setting a real-time class replaces any priority set by setPrio().
+    */
+   void setSchedClass(const VPRSchedClass schedClass, const int priority = 1);
+
+   /**
+    * Sets the timer slack of this thread, which is how late the kernel may
+    * deliver timer wakeups (such as the end of a sleep) in order to batch
+    * them.  The Linux default is 50 microseconds.  Real-time threads get no
+    * slack regardless of this setting.
+    *
+    * @pre The thread from which this method was invoked must be the same as
+    *      the thread spawned by this object.
+    *
+    * @param slack The timer slack.  Zero restores the default.
+    *
+    * @throw vpr::IllegalArgumentException
+    *           Thrown if the thread spawned through the use of this object is
+    *           not the thread from which this method was invoked.
+    * @throw vpr::Exception
+    *           Thrown if the timer slack could not be changed.
+    *
+    * @note Currently, this is only available on Linux.  It does nothing on
+    *       other operating systems.
+    */
+   void setTimerSlack(const vpr::Interval& slack);
+
    /**
     * Yields execution of the calling thread to allow a different blocked
     * thread to execute.
@@ -339,6 +339,19 @@ void ThreadWin32::setRunOn(const int cpu)
    }
 }
 
+BaseThread::VPRSchedClass ThreadWin32::getSchedClass() const
+{
+   return getPrio() == VPR_PRIORITY_URGENT ? VPR_SCHED_FIFO : VPR_SCHED_NORMAL;
+}
+
+void ThreadWin32::setSchedClass(const VPRSchedClass schedClass,
+                                const int priority)
+{
+   boost::ignore_unused_variable_warning(priority);
+   setPrio(VPR_SCHED_NORMAL == schedClass ? VPR_PRIORITY_NORMAL
+                                          : VPR_PRIORITY_URGENT);
+}
+
 std::vector<unsigned int> ThreadWin32::getRunOn() const
 {
    std::vector<unsigned int> cpus;
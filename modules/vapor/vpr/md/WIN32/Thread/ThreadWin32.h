@@ -52,6 +52,7 @@
 #include <vpr/md/WIN32/Thread/ThreadKeyWin32.h>
 #include <vpr/md/WIN32/Sync/CondVarWin32.h>
 #include <vpr/Thread/UncaughtThreadException.h>
+#include <vpr/Util/Interval.h>
 
 
 namespace vpr
@@ -311,6 +312,34 @@ public:  // ----- Various other thread functions ------
     */
    std::vector<unsigned int> getRunOn() const;
 
+   /**
+    * Gets this thread's scheduling class.  Threads at time-critical priority
+    * are reported as \c VPR_SCHED_FIFO.
+    *
+    * @throw vpr::IllegalArgumentException is thrown if this is not a valid
+    *        thread (and thus cannot have its scheduling queried).
+    */
+   VPRSchedClass getSchedClass() const;
+
+   /**
+    * Sets this thread's scheduling class.  Windows has no real-time classes
+    * for individual threads, so both \c VPR_SCHED_FIFO and \c VPR_SCHED_RR
+    * give the thread time-critical priority and \p priority is ignored.
+    * \c VPR_SCHED_NORMAL restores normal priority.
+    *
+    * @throw vpr::IllegalArgumentException is thrown if the thread priority
+    *        could not be changed.
+    */
+   void setSchedClass(const VPRSchedClass schedClass, const int priority = 1);
+
+   /**
+    * Sets the timer slack of this thread.  This does nothing on Windows.
+    */
+   void setTimerSlack(const vpr::Interval& slack)
+   {
+      boost::ignore_unused_variable_warning(slack);
+   }
+
    /**
     * Yields execution of the calling thread to allow a different blocked
     * thread to execute.
@@ -164,6 +164,25 @@ namespace std
 #   define VPR_HAVE_HASH_SET  1
 #endif
 
+/*
+ * VPR_THREAD_LOCAL is the storage class specifier for compiler-supported
+ * thread-local variables.  It is only defined when the compiler provides
+ * one, and it may be used only with variables that need no dynamic
+ * initialization.  Defining VPR_NO_THREAD_LOCAL turns it off so that
+ * vpr::TSObjectProxy uses the vpr::TSTable lookup for every access.
+ */
+#if ! defined(VPR_NO_THREAD_LOCAL) && ! defined(VPR_THREAD_LOCAL)
+#  if defined(_MSC_VER)
+#     define VPR_THREAD_LOCAL __declspec(thread)
+#  elif defined(VPR_OS_Darwin)
+      /* Apple compilers before Xcode 8 reject thread-local variables. */
+#  elif defined(__cplusplus) && __cplusplus >= 201103L
+#     define VPR_THREAD_LOCAL thread_local
+#  elif defined(__GNUC__)
+#     define VPR_THREAD_LOCAL __thread
+#  endif
+#endif
+
 #if ! defined(WIN32) && ! defined(WIN64)        \
       && defined(__GNUC__) && __GNUC__ >= 4     \
       && ! defined(VPR_HAVE_GCC_VISIBILITY)
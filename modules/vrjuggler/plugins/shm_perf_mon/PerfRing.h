@@ -0,0 +1,157 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _VRJ_PERF_RING_H_
+#define _VRJ_PERF_RING_H_
+
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+
+/*
+ * Layout of the shared memory segment written by the shm_perf_mon plug-in
+ * and read by vrjperf.  This header must not depend on any VR Juggler header
+ * so that the reader can be built and run on machines without VR Juggler.
+ *
+ * The segment is a PerfRingHeader followed by PerfRingHeader::capacity
+ * PerfRingRecord slots.  Record n (counting from 0) goes into slot
+ * n % capacity.  There is a single writer, and each slot is guarded by a
+ * sequence number: the writer sets it to 2n + 1 while record n is being
+ * written and to 2n + 2 once it is complete.  A reader that wants record n
+ * copies the slot and keeps the copy only if the sequence number was 2n + 2
+ * both before and after the copy.  Readers never write to the segment.
+ *
+ * The plug-in can also send every record as one datagram to a Unix domain
+ * socket.  Each datagram is exactly one PerfRingRecord.
+ */
+namespace vrj
+{
+
+const uint32_t PERF_RING_MAGIC      = 0x504a5256;   /**< "VRJP" */
+const uint32_t PERF_RING_VERSION    = 2;
+const uint32_t PERF_RING_MAX_PHASES = 16;
+const uint32_t PERF_RING_NAME_LEN   = 24;
+
+/** One frame.  The fields mirror vrj::FrameTiming. */
+struct PerfRingRecord
+{
+   volatile uint64_t sequence;
+   uint64_t frameNumber;
+   uint64_t startUsec;
+   uint32_t frameUsec;
+   uint32_t drawUsec;
+   uint32_t poseAgeUsec;
+   uint32_t phaseUsec[PERF_RING_MAX_PHASES];
+};
+
+struct PerfRingHeader
+{
+   uint32_t magic;         /**< PERF_RING_MAGIC once the header is valid */
+   uint32_t version;       /**< PERF_RING_VERSION */
+   uint32_t headerSize;    /**< sizeof(PerfRingHeader) */
+   uint32_t recordSize;    /**< sizeof(PerfRingRecord) */
+   uint32_t capacity;      /**< Number of record slots */
+   uint32_t phaseCount;    /**< Entries of PerfRingRecord::phaseUsec in use */
+   uint32_t pid;           /**< Process ID of the writer */
+   uint32_t reserved;
+
+   /** Number of records written so far.  Only the writer changes this. */
+   volatile uint64_t written;
+
+   /** NUL-terminated name of each phase. */
+   char phaseNames[PERF_RING_MAX_PHASES][PERF_RING_NAME_LEN];
+};
+
+/** Full memory barrier between the writer and the readers. */
+inline void perfRingBarrier()
+{
+   __sync_synchronize();
+}
+
+/** Returns the size in bytes of a segment with \p capacity slots. */
+inline size_t getPerfRingSize(const uint32_t capacity)
+{
+   return sizeof(PerfRingHeader) + capacity * sizeof(PerfRingRecord);
+}
+
+inline PerfRingRecord* getPerfRingSlots(PerfRingHeader* header)
+{
+   return reinterpret_cast<PerfRingRecord*>(header + 1);
+}
+
+inline const PerfRingRecord* getPerfRingSlots(const PerfRingHeader* header)
+{
+   return reinterpret_cast<const PerfRingRecord*>(header + 1);
+}
+
+/**
+ * Appends \p record to the ring.  The sequence number of \p record is
+ * ignored.  Only one thread may call this for a given ring.
+ */
+inline void writePerfRecord(PerfRingHeader* header,
+                            const PerfRingRecord& record)
+{
+   const uint64_t n(header->written);
+   PerfRingRecord& slot(getPerfRingSlots(header)[n % header->capacity]);
+   const size_t offset(offsetof(PerfRingRecord, frameNumber));
+
+   slot.sequence = 2 * n + 1;
+   perfRingBarrier();
+   memcpy(reinterpret_cast<char*>(&slot) + offset,
+          reinterpret_cast<const char*>(&record) + offset,
+          sizeof(PerfRingRecord) - offset);
+   perfRingBarrier();
+   slot.sequence = 2 * n + 2;
+   header->written = n + 1;
+}
+
+/**
+ * Copies record \p n out of the ring.  Returns false if the slot does not
+ * hold record \p n (yet or any more) or if it was overwritten during the
+ * copy.
+ */
+inline bool readPerfRecord(const PerfRingHeader* header, const uint64_t n,
+                           PerfRingRecord& record)
+{
+   const PerfRingRecord& slot(getPerfRingSlots(header)[n % header->capacity]);
+   const uint64_t complete(2 * n + 2);
+
+   if ( slot.sequence != complete )
+   {
+      return false;
+   }
+
+   perfRingBarrier();
+   memcpy(&record, &slot, sizeof(PerfRingRecord));
+   perfRingBarrier();
+
+   return slot.sequence == complete;
+}
+
+} // namespace vrj
+
+
+#endif
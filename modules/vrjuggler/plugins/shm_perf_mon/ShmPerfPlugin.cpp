@@ -0,0 +1,311 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#include <vrj/Performance/PluginConfig.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/concept_check.hpp>
+#include <boost/static_assert.hpp>
+
+#include <vpr/vpr.h>
+#include <vpr/System.h>
+#include <vpr/Util/Debug.h>
+
+#include <vrj/Util/Debug.h>
+#include <vrj/Performance/FrameTiming.h>
+#include <vrj/Performance/PerformanceMediator.h>
+
+#include <shm_perf_mon/ShmPerfPlugin.h>
+
+
+extern "C"
+{
+
+VRJ_PLUGIN_EXPORT vrj::PerfPlugin*
+initPlugin(vrj::PerformanceMediator* mediator, jccl::ConfigManager* configMgr)
+{
+   return new vrj::ShmPerfPlugin(mediator, configMgr);
+}
+
+}
+
+namespace
+{
+
+const vpr::Uint32 DEFAULT_CAPACITY(4096);
+
+}
+
+namespace vrj
+{
+
+   ShmPerfPlugin::ShmPerfPlugin(PerformanceMediator* mediator,
+                                jccl::ConfigManager* configMgr)
+   : mKeepSegment(false)
+   , mRing(NULL)
+   , mRingSize(0)
+   , mSocket(-1)
+   , mEnabled(false)
+   {
+      boost::ignore_unused_variable_warning(mediator);
+      boost::ignore_unused_variable_warning(configMgr);
+
+      std::memset(&mSocketAddr, 0, sizeof(mSocketAddr));
+      std::memset(&mRecord, 0, sizeof(mRecord));
+   }
+
+   ShmPerfPlugin::~ShmPerfPlugin()
+   {
+      release();
+   }
+
+   bool ShmPerfPlugin::init()
+   {
+      release();
+
+      std::string value;
+
+      if ( ! vpr::System::getenv("VJ_PERF_SHM_NAME", value) || value.empty() )
+      {
+         std::ostringstream name;
+         name << "/vrjuggler-perf-" << getpid();
+         value = name.str();
+      }
+      mShmName = value;
+
+      vpr::Uint32 capacity(DEFAULT_CAPACITY);
+      if ( vpr::System::getenv("VJ_PERF_SHM_RECORDS", value) )
+      {
+         const long records = std::strtol(value.c_str(), NULL, 10);
+         if ( records > 0 )
+         {
+            capacity = static_cast<vpr::Uint32>(records);
+         }
+      }
+
+      value.clear();
+      vpr::System::getenv("VJ_PERF_SHM_KEEP", value);
+      boost::trim(value);
+      mKeepSegment = ! value.empty() && value != "0" &&
+                     ! boost::iequals(value, "false");
+
+      if ( ! openSegment(capacity) )
+      {
+         return false;
+      }
+
+      // The socket is optional.  Failing to set it up is not fatal.
+      if ( vpr::System::getenv("VJ_PERF_SOCKET", value) && ! value.empty() )
+      {
+         openSocket(value);
+      }
+
+      vprDEBUG(vrjDBG_PLUGIN, vprDBG_CONFIG_STATUS_LVL)
+         << "[ShmPerfPlugin::init()] Writing frame timing to shared memory "
+         << "segment " << mShmName << " (" << capacity << " frames)"
+         << std::endl << vprDEBUG_FLUSH;
+
+      return true;
+   }
+
+   bool ShmPerfPlugin::enable()
+   {
+      mEnabled = mRing != NULL;
+      return mEnabled;
+   }
+
+   bool ShmPerfPlugin::isEnabled() const
+   {
+      return mEnabled;
+   }
+
+   void ShmPerfPlugin::disable()
+   {
+      mEnabled = false;
+   }
+
+   void ShmPerfPlugin::frameCompleted(const vrj::FrameTiming& timing)
+   {
+      if ( ! mEnabled )
+      {
+         return;
+      }
+
+      mRecord.frameNumber = timing.frameNumber;
+      mRecord.startUsec   = timing.startUsec;
+      mRecord.frameUsec   = timing.frameUsec;
+      mRecord.drawUsec    = timing.drawUsec;
+      mRecord.poseAgeUsec = timing.poseAgeUsec;
+      std::memcpy(mRecord.phaseUsec, timing.phaseUsec,
+                  sizeof(timing.phaseUsec));
+
+      writePerfRecord(mRing, mRecord);
+
+      if ( mSocket >= 0 )
+      {
+         // Nobody may be listening, and a slow reader must not hold up the
+         // frame, so any failure here just drops the record.
+         mRecord.sequence = 2 * mRing->written;
+         sendto(mSocket, &mRecord, sizeof(mRecord), MSG_DONTWAIT,
+                reinterpret_cast<sockaddr*>(&mSocketAddr),
+                sizeof(mSocketAddr));
+      }
+   }
+
+   bool ShmPerfPlugin::openSegment(const vpr::Uint32 capacity)
+   {
+      BOOST_STATIC_ASSERT(FrameTiming::NUM_PHASES <= PERF_RING_MAX_PHASES);
+
+      const int flags(O_RDWR | O_CREAT | O_EXCL);
+      int fd = shm_open(mShmName.c_str(), flags, 0644);
+
+      // A segment left behind by an earlier process with the same name is
+      // stale, so it is replaced.
+      if ( fd < 0 && EEXIST == errno )
+      {
+         shm_unlink(mShmName.c_str());
+         fd = shm_open(mShmName.c_str(), flags, 0644);
+      }
+
+      if ( fd < 0 )
+      {
+         vprDEBUG(vrjDBG_PLUGIN, vprDBG_WARNING_LVL)
+            << clrOutBOLD(clrYELLOW, "WARNING:")
+            << " [ShmPerfPlugin::openSegment()] Could not create shared "
+            << "memory segment " << mShmName << ": " << std::strerror(errno)
+            << std::endl << vprDEBUG_FLUSH;
+         return false;
+      }
+
+      const size_t size(getPerfRingSize(capacity));
+      void* addr(MAP_FAILED);
+
+      if ( ftruncate(fd, size) == 0 )
+      {
+         addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      }
+
+      const int map_errno(errno);
+      close(fd);
+
+      if ( MAP_FAILED == addr )
+      {
+         vprDEBUG(vrjDBG_PLUGIN, vprDBG_WARNING_LVL)
+            << clrOutBOLD(clrYELLOW, "WARNING:")
+            << " [ShmPerfPlugin::openSegment()] Could not map shared "
+            << "memory segment " << mShmName << ": "
+            << std::strerror(map_errno) << std::endl << vprDEBUG_FLUSH;
+         shm_unlink(mShmName.c_str());
+         return false;
+      }
+
+      mRing     = static_cast<PerfRingHeader*>(addr);
+      mRingSize = size;
+
+      // ftruncate() zero-fills the segment, so only the header needs to be
+      // filled in.  The magic number goes in last so that readers never see
+      // a partial header.
+      mRing->version    = PERF_RING_VERSION;
+      mRing->headerSize = sizeof(PerfRingHeader);
+      mRing->recordSize = sizeof(PerfRingRecord);
+      mRing->capacity   = capacity;
+      mRing->phaseCount = FrameTiming::NUM_PHASES;
+      mRing->pid        = getpid();
+      mRing->written    = 0;
+
+      for ( unsigned int i = 0; i < FrameTiming::NUM_PHASES; ++i )
+      {
+         const char* name =
+            FrameTiming::getPhaseName(static_cast<FrameTiming::Phase>(i));
+         std::strncpy(mRing->phaseNames[i], name, PERF_RING_NAME_LEN - 1);
+      }
+
+      perfRingBarrier();
+      mRing->magic = PERF_RING_MAGIC;
+
+      return true;
+   }
+
+   bool ShmPerfPlugin::openSocket(const std::string& path)
+   {
+      if ( path.size() >= sizeof(mSocketAddr.sun_path) )
+      {
+         vprDEBUG(vrjDBG_PLUGIN, vprDBG_WARNING_LVL)
+            << clrOutBOLD(clrYELLOW, "WARNING:")
+            << " [ShmPerfPlugin::openSocket()] Socket path " << path
+            << " is too long." << std::endl << vprDEBUG_FLUSH;
+         return false;
+      }
+
+      mSocket = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+      if ( mSocket < 0 )
+      {
+         vprDEBUG(vrjDBG_PLUGIN, vprDBG_WARNING_LVL)
+            << clrOutBOLD(clrYELLOW, "WARNING:")
+            << " [ShmPerfPlugin::openSocket()] Could not create socket: "
+            << std::strerror(errno) << std::endl << vprDEBUG_FLUSH;
+         return false;
+      }
+
+      mSocketAddr.sun_family = AF_UNIX;
+      std::strncpy(mSocketAddr.sun_path, path.c_str(),
+                   sizeof(mSocketAddr.sun_path) - 1);
+
+      return true;
+   }
+
+   void ShmPerfPlugin::release()
+   {
+      mEnabled = false;
+
+      if ( NULL != mRing )
+      {
+         munmap(mRing, mRingSize);
+         mRing     = NULL;
+         mRingSize = 0;
+
+         if ( ! mKeepSegment )
+         {
+            shm_unlink(mShmName.c_str());
+         }
+      }
+
+      if ( mSocket >= 0 )
+      {
+         close(mSocket);
+         mSocket = -1;
+      }
+   }
+
+} // namespace vrj
@@ -0,0 +1,142 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _VRJ_SHM_PERF_PLUGIN_H_
+#define _VRJ_SHM_PERF_PLUGIN_H_
+
+#include <vrj/Performance/PluginConfig.h>
+
+#include <string>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <vrj/Performance/PerfPlugin.h>
+
+#include <shm_perf_mon/PerfRing.h>
+
+
+namespace jccl
+{
+   class ConfigManager;
+}
+
+namespace vrj
+{
+
+   class PerformanceMediator;
+
+/**
+ * Performance monitor that exports the timing of every frame without CORBA.
+ * Each vrj::FrameTiming is appended to a ring in POSIX shared memory (see
+ * PerfRing.h for the layout) where the vrjperf tool or any other local
+ * process can read it without disturbing the kernel.  Optionally, each
+ * record is also sent to a Unix domain datagram socket.  Sends never block;
+ * records are dropped when nobody is listening.
+ *
+ * The plug-in is set up through these environment variables:
+ *
+ *  - \c VJ_PERF_SHM_NAME: Name of the shared memory segment.  The default
+ *    is "/vrjuggler-perf-<pid>".
+ *  - \c VJ_PERF_SHM_RECORDS: Number of frames kept in the ring (default
+ *    4096).
+ *  - \c VJ_PERF_SHM_KEEP: If set to anything other than "0" or "false",
+ *    the segment is not removed on exit so that it can still be read
+ *    afterwards.
+ *  - \c VJ_PERF_SOCKET: Path of a Unix datagram socket that receives every
+ *    record.  This costs one sendto() system call per frame on the kernel
+ *    thread, which is far more than the sub-microsecond write to the ring.
+ *    Leave it unset unless a reader needs the socket.
+ *
+ * To load it, set \c VJ_PERF_PLUGIN to "shm_perf_mon".
+ */
+   class ShmPerfPlugin : public vrj::PerfPlugin
+   {
+   public:
+      ShmPerfPlugin(vrj::PerformanceMediator* mediator,
+                    jccl::ConfigManager* configMgr);
+
+      virtual ~ShmPerfPlugin();
+
+      /** Creates the shared memory segment and the socket, if requested. */
+      bool init();
+
+      bool enable();
+
+      bool isEnabled() const;
+
+      void disable();
+
+      bool needsFrameTiming() const
+      {
+         return true;
+      }
+
+      /**
+       * Publishes \p timing.  Writing to the ring takes well under a
+       * microsecond.  The socket, if used, adds one non-blocking system call.
+       */
+      void frameCompleted(const vrj::FrameTiming& timing);
+
+      /**
+       * Invokes the global scope delete operator.  This is required for proper
+       * releasing of memory in DLLs on Win32.
+       */
+      void operator delete(void* p)
+      {
+         ::operator delete(p);
+      }
+
+   protected:
+      virtual void destroy()
+      {
+         delete this;
+      }
+
+   private:
+      bool openSegment(const vpr::Uint32 capacity);
+
+      bool openSocket(const std::string& path);
+
+      /** Unmaps the segment and closes the socket. */
+      void release();
+
+      std::string mShmName;
+      bool mKeepSegment;
+      PerfRingHeader* mRing;
+      size_t mRingSize;
+
+      int mSocket;
+      sockaddr_un mSocketAddr;
+
+      /** Scratch record filled in for every frame. */
+      PerfRingRecord mRecord;
+      bool mEnabled;
+   };
+
+} // namespace vrj
+
+#endif
@@ -0,0 +1,500 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * vrjperf: Reads the frame timing published by the shm_perf_mon plug-in and
+ * prints it as text, as CSV, or as a Chrome trace (load the output in
+ * chrome://tracing or Perfetto).  This program only depends on PerfRing.h so
+ * that it can be built wherever the data is analyzed.
+ */
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+
+#include "PerfRing.h"
+
+
+namespace
+{
+
+enum Format
+{
+   TEXT,
+   CSV,
+   TRACE
+};
+
+volatile std::sig_atomic_t gStop(0);
+
+void handleSignal(int)
+{
+   gStop = 1;
+}
+
+void usage(const char* prog)
+{
+   std::fprintf(stderr,
+      "Usage: %s [options]\n"
+      "  -p PID     Read the segment of the VR Juggler process PID\n"
+      "  -n NAME    Read the shared memory segment NAME\n"
+      "  -s PATH    Receive records on the Unix datagram socket PATH\n"
+      "  -f FORMAT  Output format: text (default), csv or trace\n"
+      "  -a         Print the frames still in the ring and exit\n"
+      "  -c COUNT   Stop after COUNT frames\n"
+      "  -o FILE    Write to FILE instead of standard output\n"
+      "\n"
+      "Without -a, frames are printed as they arrive until interrupted.\n"
+      "With -s, the phase names are taken from the segment given by -p or\n"
+      "-n, if any.\n", prog);
+}
+
+/** Writes records in the chosen format. */
+class Printer
+{
+public:
+   Printer(std::FILE* out, const Format format, const unsigned int pid,
+           const std::vector<std::string>& names)
+      : mOut(out)
+      , mFormat(format)
+      , mPid(pid)
+      , mNames(names)
+      , mCount(0)
+   {
+   }
+
+   void begin()
+   {
+      if ( CSV == mFormat )
+      {
+         std::fprintf(mOut, "frame,start_us,frame_us,draw_us,pose_age_us");
+         for ( size_t i = 0; i < mNames.size(); ++i )
+         {
+            std::fprintf(mOut, ",%s_us", mNames[i].c_str());
+         }
+         std::fprintf(mOut, "\n");
+      }
+      else if ( TRACE == mFormat )
+      {
+         std::fprintf(mOut, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+         std::fprintf(mOut, "{\"name\":\"process_name\",\"ph\":\"M\","
+                      "\"pid\":%u,\"args\":{\"name\":\"VR Juggler kernel\"}}",
+                      mPid);
+      }
+   }
+
+   void print(const vrj::PerfRingRecord& r)
+   {
+      const unsigned long long frame(r.frameNumber);
+      const unsigned long long start(r.startUsec);
+
+      if ( TEXT == mFormat )
+      {
+         std::fprintf(mOut, "frame %llu: %.3f ms (draw %.3f ms, pose age "
+                      "%.3f ms)", frame, r.frameUsec / 1000.0,
+                      r.drawUsec / 1000.0, r.poseAgeUsec / 1000.0);
+         for ( size_t i = 0; i < mNames.size(); ++i )
+         {
+            if ( r.phaseUsec[i] > 0 )
+            {
+               std::fprintf(mOut, " %s=%.3f", mNames[i].c_str(),
+                            r.phaseUsec[i] / 1000.0);
+            }
+         }
+         std::fprintf(mOut, "\n");
+      }
+      else if ( CSV == mFormat )
+      {
+         std::fprintf(mOut, "%llu,%llu,%u,%u,%u", frame, start, r.frameUsec,
+                      r.drawUsec, r.poseAgeUsec);
+         for ( size_t i = 0; i < mNames.size(); ++i )
+         {
+            std::fprintf(mOut, ",%u", r.phaseUsec[i]);
+         }
+         std::fprintf(mOut, "\n");
+      }
+      else
+      {
+         // The phases run back to back, so each one starts where the
+         // previous one ended.  They nest inside the event for the frame.
+         std::fprintf(mOut, ",\n{\"name\":\"frame %llu\",\"cat\":\"frame\","
+                      "\"ph\":\"X\",\"ts\":%llu,\"dur\":%u,\"pid\":%u,"
+                      "\"tid\":1}", frame, start, r.frameUsec, mPid);
+         std::fprintf(mOut, ",\n{\"name\":\"pose age\",\"ph\":\"C\","
+                      "\"ts\":%llu,\"pid\":%u,\"args\":{\"ms\":%.3f}}",
+                      start, mPid, r.poseAgeUsec / 1000.0);
+
+         unsigned long long ts(start);
+         for ( size_t i = 0; i < mNames.size(); ++i )
+         {
+            if ( r.phaseUsec[i] > 0 )
+            {
+               std::fprintf(mOut, ",\n{\"name\":\"%s\",\"cat\":\"phase\","
+                            "\"ph\":\"X\",\"ts\":%llu,\"dur\":%u,\"pid\":%u,"
+                            "\"tid\":1}", mNames[i].c_str(), ts,
+                            r.phaseUsec[i], mPid);
+               ts += r.phaseUsec[i];
+            }
+         }
+      }
+
+      ++mCount;
+
+      if ( TRACE != mFormat )
+      {
+         std::fflush(mOut);
+      }
+   }
+
+   void end()
+   {
+      if ( TRACE == mFormat )
+      {
+         std::fprintf(mOut, "\n]}\n");
+      }
+      std::fflush(mOut);
+   }
+
+   unsigned long long getCount() const
+   {
+      return mCount;
+   }
+
+private:
+   std::FILE*               mOut;
+   Format                   mFormat;
+   unsigned int             mPid;
+   std::vector<std::string> mNames;
+   unsigned long long       mCount;
+};
+
+const vrj::PerfRingHeader* mapSegment(const std::string& name)
+{
+   const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+   if ( fd < 0 )
+   {
+      std::fprintf(stderr, "Cannot open %s: %s\n", name.c_str(),
+                   std::strerror(errno));
+      return NULL;
+   }
+
+   struct stat st;
+   void* addr(MAP_FAILED);
+   if ( fstat(fd, &st) == 0 &&
+        static_cast<size_t>(st.st_size) >= sizeof(vrj::PerfRingHeader) )
+   {
+      addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+   }
+   close(fd);
+
+   if ( MAP_FAILED == addr )
+   {
+      std::fprintf(stderr, "Cannot map %s\n", name.c_str());
+      return NULL;
+   }
+
+   const vrj::PerfRingHeader* header =
+      static_cast<const vrj::PerfRingHeader*>(addr);
+
+   if ( header->magic != vrj::PERF_RING_MAGIC ||
+        header->version != vrj::PERF_RING_VERSION ||
+        header->headerSize != sizeof(vrj::PerfRingHeader) ||
+        header->recordSize != sizeof(vrj::PerfRingRecord) ||
+        header->phaseCount > vrj::PERF_RING_MAX_PHASES ||
+        header->capacity == 0 ||
+        static_cast<size_t>(st.st_size) <
+           vrj::getPerfRingSize(header->capacity) )
+   {
+      std::fprintf(stderr, "%s is not a VR Juggler frame timing segment "
+                   "this program understands\n", name.c_str());
+      munmap(addr, st.st_size);
+      return NULL;
+   }
+
+   return header;
+}
+
+/** Prints records from the ring.  Returns the number of frames lost. */
+unsigned long long readRing(const vrj::PerfRingHeader* header,
+                            Printer& printer, const bool dump,
+                            const unsigned long long limit)
+{
+   unsigned long long lost(0);
+   vrj::perfRingBarrier();
+   uint64_t written(header->written);
+   uint64_t next(written);
+
+   if ( dump )
+   {
+      next = written > header->capacity ? written - header->capacity : 0;
+   }
+
+   vrj::PerfRingRecord record;
+
+   while ( ! gStop && (0 == limit || printer.getCount() < limit) )
+   {
+      if ( next >= written )
+      {
+         if ( dump )
+         {
+            break;
+         }
+
+         usleep(1000);
+         vrj::perfRingBarrier();
+         written = header->written;
+         continue;
+      }
+
+      if ( vrj::readPerfRecord(header, next, record) )
+      {
+         printer.print(record);
+         ++next;
+      }
+      else
+      {
+         // The writer lapped us.  Skip to the oldest frame still there.
+         vrj::perfRingBarrier();
+         written = header->written;
+         const uint64_t oldest = written > header->capacity ?
+                                    written - header->capacity + 1 : 0;
+         if ( oldest > next )
+         {
+            lost += oldest - next;
+            next = oldest;
+         }
+      }
+   }
+
+   return lost;
+}
+
+bool readSocket(const std::string& path, Printer& printer,
+                const unsigned long long limit)
+{
+   sockaddr_un addr;
+   std::memset(&addr, 0, sizeof(addr));
+
+   if ( path.size() >= sizeof(addr.sun_path) )
+   {
+      std::fprintf(stderr, "Socket path %s is too long\n", path.c_str());
+      return false;
+   }
+
+   const int sock = socket(AF_UNIX, SOCK_DGRAM, 0);
+   addr.sun_family = AF_UNIX;
+   std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+   unlink(path.c_str());
+
+   if ( sock < 0 ||
+        bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 )
+   {
+      std::fprintf(stderr, "Cannot bind %s: %s\n", path.c_str(),
+                   std::strerror(errno));
+      if ( sock >= 0 )
+      {
+         close(sock);
+      }
+      return false;
+   }
+
+   vrj::PerfRingRecord record;
+
+   while ( ! gStop && (0 == limit || printer.getCount() < limit) )
+   {
+      const ssize_t n = recv(sock, &record, sizeof(record), 0);
+      if ( n == static_cast<ssize_t>(sizeof(record)) )
+      {
+         printer.print(record);
+      }
+      else if ( n < 0 && EINTR != errno )
+      {
+         std::fprintf(stderr, "recv: %s\n", std::strerror(errno));
+         break;
+      }
+   }
+
+   close(sock);
+   unlink(path.c_str());
+   return true;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   std::string shm_name;
+   std::string socket_path;
+   std::string out_file;
+   Format format(TEXT);
+   bool dump(false);
+   unsigned long long limit(0);
+
+   int opt;
+   while ( (opt = getopt(argc, argv, "p:n:s:f:ac:o:h")) != -1 )
+   {
+      switch ( opt )
+      {
+         case 'p':
+            shm_name = std::string("/vrjuggler-perf-") + optarg;
+            break;
+         case 'n':
+            shm_name = optarg;
+            break;
+         case 's':
+            socket_path = optarg;
+            break;
+         case 'f':
+            if ( std::strcmp(optarg, "text") == 0 )
+            {
+               format = TEXT;
+            }
+            else if ( std::strcmp(optarg, "csv") == 0 )
+            {
+               format = CSV;
+            }
+            else if ( std::strcmp(optarg, "trace") == 0 )
+            {
+               format = TRACE;
+            }
+            else
+            {
+               usage(argv[0]);
+               return 1;
+            }
+            break;
+         case 'a':
+            dump = true;
+            break;
+         case 'c':
+            limit = std::strtoul(optarg, NULL, 10);
+            break;
+         case 'o':
+            out_file = optarg;
+            break;
+         default:
+            usage(argv[0]);
+            return 'h' == opt ? 0 : 1;
+      }
+   }
+
+   if ( (shm_name.empty() && socket_path.empty()) ||
+        (dump && ! socket_path.empty()) )
+   {
+      usage(argv[0]);
+      return 1;
+   }
+
+   const vrj::PerfRingHeader* header(NULL);
+   if ( ! shm_name.empty() )
+   {
+      header = mapSegment(shm_name);
+      if ( NULL == header )
+      {
+         return 1;
+      }
+   }
+
+   std::vector<std::string> names;
+   unsigned int pid(0);
+   if ( NULL != header )
+   {
+      for ( uint32_t i = 0; i < header->phaseCount; ++i )
+      {
+         char name[vrj::PERF_RING_NAME_LEN];
+         std::memcpy(name, header->phaseNames[i], sizeof(name));
+         name[sizeof(name) - 1] = '\0';
+         names.push_back(name);
+      }
+      pid = header->pid;
+   }
+   else
+   {
+      for ( uint32_t i = 0; i < vrj::PERF_RING_MAX_PHASES; ++i )
+      {
+         char name[16];
+         std::sprintf(name, "phase%u", i);
+         names.push_back(name);
+      }
+   }
+
+   std::FILE* out(stdout);
+   if ( ! out_file.empty() )
+   {
+      out = std::fopen(out_file.c_str(), "w");
+      if ( NULL == out )
+      {
+         std::fprintf(stderr, "Cannot open %s: %s\n", out_file.c_str(),
+                      std::strerror(errno));
+         return 1;
+      }
+   }
+
+   // Stop cleanly on Ctrl-C so that a trace is still valid JSON.
+   struct sigaction sa;
+   std::memset(&sa, 0, sizeof(sa));
+   sa.sa_handler = handleSignal;
+   sigaction(SIGINT, &sa, NULL);
+   sigaction(SIGTERM, &sa, NULL);
+
+   Printer printer(out, format, pid, names);
+   printer.begin();
+
+   int status(0);
+   if ( ! socket_path.empty() )
+   {
+      status = readSocket(socket_path, printer, limit) ? 0 : 1;
+   }
+   else
+   {
+      const unsigned long long lost = readRing(header, printer, dump, limit);
+      if ( lost > 0 )
+      {
+         std::fprintf(stderr, "%llu frames were overwritten before they "
+                      "could be read\n", lost);
+      }
+   }
+
+   printer.end();
+
+   if ( out != stdout )
+   {
+      std::fclose(out);
+   }
+
+   return status;
+}
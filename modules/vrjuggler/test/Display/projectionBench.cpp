@@ -0,0 +1,225 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+/*
+ * Headless benchmark for the per-frame surface projection update.
+ *
+ * Usage: projectionBench [-w walls] [-u users] [-n frames]
+ *
+ * The walls form a ring around the origin, and every wall has a stereo pair
+ * of projections for every user.  Each frame, every user's head moves, and
+ * all the projections are recomputed twice: once with the surface offsets
+ * derived from the corners again for every projection, as was done before
+ * vrj::SurfaceProjection cached them, and once with the cached offsets.  The
+ * two results are compared.  When a user's head does not move, the kernel's
+ * projection stage skips untracked surfaces entirely, so that case is not
+ * timed.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <gmtl/Matrix.h>
+#include <gmtl/MatrixOps.h>
+#include <gmtl/Point.h>
+
+#include <vpr/vpr.h>
+#include <vpr/Util/Interval.h>
+
+#include <vrj/Display/SurfaceProjection.h>
+
+
+namespace
+{
+
+struct Wall
+{
+   gmtl::Point3f ll, lr, ur, ul;
+};
+
+/** Places \p count 3 m x 2.5 m walls on a ring facing the origin. */
+std::vector<Wall> makeWalls(const unsigned int count)
+{
+   const float two_pi(6.2831853f);
+   const float half_width(1.5f);
+   const float radius(half_width / std::tan(two_pi / (2.0f * count)) + 0.01f);
+
+   std::vector<Wall> walls(count);
+   for ( unsigned int i = 0; i < count; ++i )
+   {
+      const float angle(two_pi * i / count);
+      const float cx(radius * std::sin(angle));
+      const float cz(-radius * std::cos(angle));
+
+      // Unit vector along the wall, to the right of a viewer at the origin.
+      const float rx(std::cos(angle));
+      const float rz(std::sin(angle));
+
+      walls[i].ll.set(cx - rx * half_width, 0.0f, cz - rz * half_width);
+      walls[i].lr.set(cx + rx * half_width, 0.0f, cz + rz * half_width);
+      walls[i].ur.set(cx + rx * half_width, 2.5f, cz + rz * half_width);
+      walls[i].ul.set(cx - rx * half_width, 2.5f, cz - rz * half_width);
+   }
+
+   return walls;
+}
+
+/** Returns the eye points of every user for the given frame. */
+void moveUsers(const unsigned int frame, const unsigned int users,
+               std::vector<gmtl::Point3f>& eyes)
+{
+   const float eye_offset(0.0345f);
+
+   eyes.resize(users * 2);
+   for ( unsigned int u = 0; u < users; ++u )
+   {
+      const float t(0.01f * frame + u);
+      const gmtl::Point3f head(0.3f * std::sin(t), 1.7f, 0.3f * std::cos(t));
+      eyes[2 * u]     = head - gmtl::Vec3f(eye_offset, 0.0f, 0.0f);
+      eyes[2 * u + 1] = head + gmtl::Vec3f(eye_offset, 0.0f, 0.0f);
+   }
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+   unsigned int wall_count(24);
+   unsigned int users(2);
+   unsigned int frames(1000);
+
+   for ( int i = 1; i < argc; ++i )
+   {
+      if ( std::strcmp(argv[i], "-w") == 0 && i + 1 < argc )
+      {
+         wall_count = std::atoi(argv[++i]);
+      }
+      else if ( std::strcmp(argv[i], "-u") == 0 && i + 1 < argc )
+      {
+         users = std::atoi(argv[++i]);
+      }
+      else if ( std::strcmp(argv[i], "-n") == 0 && i + 1 < argc )
+      {
+         frames = std::atoi(argv[++i]);
+      }
+      else
+      {
+         std::cerr << "Usage: " << argv[0]
+                   << " [-w walls] [-u users] [-n frames]" << std::endl;
+         return 1;
+      }
+   }
+
+   if ( wall_count < 3 || users == 0 || frames == 0 )
+   {
+      std::cerr << "Need at least 3 walls, 1 user and 1 frame" << std::endl;
+      return 1;
+   }
+
+   const float scale_factor(1.0f);
+   const std::vector<Wall> walls(makeWalls(wall_count));
+
+   // One projection per wall, user and eye for each of the two methods.
+   std::vector<vrj::SurfaceProjectionPtr> uncached, cached;
+   for ( unsigned int w = 0; w < wall_count; ++w )
+   {
+      for ( unsigned int e = 0; e < users * 2; ++e )
+      {
+         const Wall& wall(walls[w]);
+         uncached.push_back(vrj::SurfaceProjection::create(wall.ll, wall.lr,
+                                                           wall.ur, wall.ul));
+         cached.push_back(vrj::SurfaceProjection::create(wall.ll, wall.lr,
+                                                         wall.ur, wall.ul));
+      }
+   }
+
+   std::vector<gmtl::Point3f> eyes;
+   vpr::Interval uncached_time, cached_time;
+   unsigned int mismatches(0);
+
+   for ( unsigned int f = 0; f < frames; ++f )
+   {
+      moveUsers(f, users, eyes);
+
+      vpr::Interval start(vpr::Interval::now());
+      for ( std::size_t p = 0; p < uncached.size(); ++p )
+      {
+         // Setting the corners again forgets the cached offsets.  It also
+         // validates the corners, which makes this figure slightly worse
+         // than the old code really was.
+         const Wall& wall(walls[p / eyes.size()]);
+         uncached[p]->updateCorners(wall.ll, wall.lr, wall.ur, wall.ul);
+         uncached[p]->calcViewMatrix(gmtl::MAT_IDENTITY44F,
+                                     eyes[p % eyes.size()], scale_factor);
+      }
+      vpr::Interval middle(vpr::Interval::now());
+      for ( std::size_t p = 0; p < cached.size(); ++p )
+      {
+         cached[p]->calcViewMatrix(gmtl::MAT_IDENTITY44F,
+                                   eyes[p % eyes.size()], scale_factor);
+      }
+      vpr::Interval end(vpr::Interval::now());
+
+      uncached_time += middle - start;
+      cached_time   += end - middle;
+
+      for ( std::size_t p = 0; p < cached.size(); ++p )
+      {
+         if ( uncached[p]->getFrustum().getValues() !=
+                 cached[p]->getFrustum().getValues() ||
+              ! gmtl::isEqual(uncached[p]->getViewMatrix(),
+                              cached[p]->getViewMatrix(), 0.0f) )
+         {
+            ++mismatches;
+         }
+      }
+   }
+
+   const double projections(static_cast<double>(cached.size()) * frames);
+
+   std::cout << wall_count << " walls, " << users << " user(s), "
+             << cached.size() << " projections per frame, " << frames
+             << " frames" << std::endl;
+   std::cout << "recomputed offsets: "
+             << uncached_time.usecf() / frames << " us/frame, "
+             << uncached_time.usecf() * 1000.0 / projections
+             << " ns/projection" << std::endl;
+   std::cout << "cached offsets:     "
+             << cached_time.usecf() / frames << " us/frame, "
+             << cached_time.usecf() * 1000.0 / projections
+             << " ns/projection" << std::endl;
+
+   if ( mismatches != 0 )
+   {
+      std::cerr << mismatches << " projections differ" << std::endl;
+      return 1;
+   }
+
+   return 0;
+}
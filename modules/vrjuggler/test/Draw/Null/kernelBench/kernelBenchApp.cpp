@@ -0,0 +1,130 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+#include <gmtl/Matrix.h>
+
+#include <vrj/Kernel/Kernel.h>
+#include <vrj/Display/Projection.h>
+#include <vrj/Display/Frustum.h>
+
+#include "kernelBenchApp.h"
+
+
+namespace vrjTest
+{
+
+KernelBenchApp::KernelBenchApp(vrj::Kernel* kernel, const unsigned int frames,
+                               const unsigned int warmup)
+   : vrj::null::App(kernel)
+   , mFrames(frames)
+   , mWarmup(warmup)
+   , mFrameNum(0)
+   , mDone(false)
+   , mEyesDrawn(0)
+   , mChecksum(0.0f)
+{
+   mFrameUsec.reserve(frames);
+}
+
+KernelBenchApp::~KernelBenchApp()
+{
+   /* Do nothing. */ ;
+}
+
+void KernelBenchApp::init()
+{
+   vrj::null::App::init();
+   mHead.init("VJHead");
+}
+
+void KernelBenchApp::preFrame()
+{
+   const gmtl::Matrix44f head(mHead->getData());
+   mChecksum += head(0, 3) + head(1, 3) + head(2, 3);
+}
+
+void KernelBenchApp::draw(const vrj::ViewportPtr&,
+                          const vrj::ProjectionPtr& proj)
+{
+   const vrj::Frustum& frust(proj->getFrustum());
+   const gmtl::Matrix44f& view(proj->getViewMatrix());
+   mChecksum += frust[vrj::Frustum::VJ_LEFT] + frust[vrj::Frustum::VJ_RIGHT] +
+                   view(0, 3);
+   ++mEyesDrawn;
+}
+
+void KernelBenchApp::postFrame()
+{
+   const vpr::Interval now(vpr::Interval::now());
+
+   if ( mFrameNum == mWarmup )
+   {
+      mFirstMeasured = now;
+   }
+   else if ( mFrameNum > mWarmup && ! mDone )
+   {
+      mFrameUsec.push_back(static_cast<vpr::Uint32>((now - mLastFrame).usec()));
+   }
+
+   mLastFrame = now;
+   ++mFrameNum;
+
+   // The kernel may finish one more frame after stop() is called.
+   if ( ! mDone && mFrameUsec.size() == mFrames )
+   {
+      mDone = true;
+      report();
+      mKernel->stop();
+   }
+}
+
+void KernelBenchApp::report() const
+{
+   std::vector<vpr::Uint32> sorted(mFrameUsec);
+   std::sort(sorted.begin(), sorted.end());
+
+   const double total_usec((mLastFrame - mFirstMeasured).usec());
+   const double mean_usec(total_usec / sorted.size());
+
+   std::cout << std::fixed << std::setprecision(1)
+             << "Frames:     " << sorted.size() << " (after " << mWarmup
+             << " warm-up frames)\n"
+             << "Frame rate: " << (1000000.0 / mean_usec) << " fps\n"
+             << "Frame time: mean " << mean_usec << " us, min "
+             << sorted.front() << " us, median "
+             << sorted[sorted.size() / 2] << " us, 99th percentile "
+             << sorted[(sorted.size() * 99) / 100] << " us, max "
+             << sorted.back() << " us\n"
+             << "Eyes drawn: " << mEyesDrawn << " (checksum " << mChecksum
+             << ")" << std::endl;
+}
+
+}
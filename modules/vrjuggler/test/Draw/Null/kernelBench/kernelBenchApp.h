@@ -0,0 +1,92 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+#ifndef _KERNEL_BENCH_APP_H_
+#define _KERNEL_BENCH_APP_H_
+
+#include <vector>
+
+#include <vpr/vprTypes.h>
+#include <vpr/Util/Interval.h>
+
+#include <gadget/Type/PositionInterface.h>
+
+#include <vrj/Draw/Null/App.h>
+
+
+namespace vrjTest
+{
+
+/**
+ * Measures the frame rate of the whole kernel loop without any rendering.
+ *
+ * The application reads the head every frame, touches every projection it
+ * is handed by vrj::null::DrawManager, and records the time between
+ * consecutive calls to postFrame().  After the requested number of frames
+ * it prints the frame statistics and stops the kernel.
+ */
+class KernelBenchApp : public vrj::null::App
+{
+public:
+   KernelBenchApp(vrj::Kernel* kernel, const unsigned int frames,
+                  const unsigned int warmup);
+
+   virtual ~KernelBenchApp();
+
+   virtual void init();
+
+   virtual void preFrame();
+
+   virtual void draw(const vrj::ViewportPtr& viewport,
+                     const vrj::ProjectionPtr& proj);
+
+   virtual void postFrame();
+
+private:
+   void report() const;
+
+   gadget::PositionInterface mHead;
+
+   unsigned int mFrames;   /**< Number of frames to measure */
+   unsigned int mWarmup;   /**< Number of frames to skip first */
+   unsigned int mFrameNum;
+   bool         mDone;
+
+   vpr::Interval mLastFrame;
+   vpr::Interval mFirstMeasured;
+   std::vector<vpr::Uint32> mFrameUsec;
+
+   vpr::Uint64 mEyesDrawn;
+
+   /** Sum of the values read each frame so the reads cannot be elided. */
+   float mChecksum;
+};
+
+}
+
+
+#endif
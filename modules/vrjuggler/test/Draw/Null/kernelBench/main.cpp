@@ -0,0 +1,95 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <vrj/Kernel/Kernel.h>
+
+#include "kernelBenchApp.h"
+
+
+static void usage(const char* name)
+{
+   std::cout << "Usage: " << name
+             << " [-f frames] [-w warmup frames] <conf files>..." << std::endl
+             << std::endl
+             << "The synthetic draw cost is set with VJ_NULL_DRAW_USEC and "
+             << "VJ_NULL_DRAW_SLEEP." << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+   vrj::Kernel* kernel = vrj::Kernel::instance();
+
+   // This removes the arguments handled by the kernel from argv.
+   kernel->init(argc, argv);
+
+   int frames(1000);
+   int warmup(100);
+   std::vector<char*> files;
+
+   for ( int i = 1; i < argc; ++i )
+   {
+      if ( std::strcmp(argv[i], "-f") == 0 && i + 1 < argc )
+      {
+         frames = std::atoi(argv[++i]);
+      }
+      else if ( std::strcmp(argv[i], "-w") == 0 && i + 1 < argc )
+      {
+         warmup = std::atoi(argv[++i]);
+      }
+      else
+      {
+         files.push_back(argv[i]);
+      }
+   }
+
+   if ( files.empty() || frames < 1 || warmup < 0 )
+   {
+      usage(argv[0]);
+      std::exit(1);
+   }
+
+   vrjTest::KernelBenchApp* application =
+      new vrjTest::KernelBenchApp(kernel, frames, warmup);
+
+   for ( std::vector<char*>::iterator f = files.begin(); f != files.end(); ++f )
+   {
+      kernel->loadConfigFile(*f);
+   }
+
+   kernel->start();
+   kernel->setApplication(application);
+   kernel->waitForKernelStop();
+
+   delete application;
+
+   return 0;
+}
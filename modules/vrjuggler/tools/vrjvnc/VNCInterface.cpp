@@ -67,6 +67,7 @@
 #include <string.h>
 #include <cmath>
 #include <list>
+#include <algorithm>
 
 // -- X11 Includes
 #if defined(WIN32) || defined(WIN64)
@@ -113,6 +114,17 @@ namespace vrjvnc
 
 static const unsigned int MAX_ENCODINGS = 10;
 
+/** Size of the socket receive buffer. */
+static const vpr::Uint32 RECV_BUFFER_SIZE = 64 * 1024;
+
+/** Width and height of a Hextile tile. */
+static const int HEXTILE_TILE_SIZE = 16;
+
+#if defined(VRJVNC_HAVE_ZLIB)
+/** Width and height of a ZRLE tile. */
+static const int ZRLE_TILE_SIZE = 64;
+#endif
+
 // -- Local Function Prototypes
 static int countBits(int mask);
 
@@ -121,7 +133,12 @@ static int countBits(int mask);
 VNCInterface::VNCInterface(const std::string& host, const vpr::Uint16 port,
                            const std::string& password)
    : mHost(host), mPort(port), mIncremental(false), mWidth(-1), mHeight(-1),
-     mFramebuffer(NULL), mReadBuffer(NULL), mRunning(false)
+     mFramebuffer(NULL), mRecvBuffer(RECV_BUFFER_SIZE), mRecvPos(0),
+     mRecvEnd(0),
+#if defined(VRJVNC_HAVE_ZLIB)
+     mZStreamInit(false),
+#endif
+     mRunning(false)
 {
    // Set up pixel format (in VNC, we get to define it ourselves)
    mPf.depth      = 24; mPf.size       = 32;
@@ -146,15 +163,15 @@ VNCInterface::VNCInterface(const std::string& host, const vpr::Uint16 port,
    mFramebuffer = new char[framebuffer_size];
    memset(mFramebuffer, 0, framebuffer_size);
 
-   // Define the read buffer to be able to read then entire frame buffer at once
-   mReadBufferSize = framebuffer_size;
-
-   vprDEBUG(vrjDBG_VNC, vprDBG_CONFIG_LVL)
-      << "VNCInterface(): mReadBufferSize (row size) == " << mReadBufferSize
-      << std::endl << vprDEBUG_FLUSH;
-
-   mReadBuffer = new char[mReadBufferSize];
-   memset(mReadBuffer, 0, mReadBufferSize);
+#if defined(VRJVNC_HAVE_ZLIB)
+   // ZRLE uses a single zlib stream for the lifetime of the connection.
+   mZStream.zalloc   = Z_NULL;
+   mZStream.zfree    = Z_NULL;
+   mZStream.opaque   = Z_NULL;
+   mZStream.next_in  = Z_NULL;
+   mZStream.avail_in = 0;
+   mZStreamInit      = (inflateInit(&mZStream) == Z_OK);
+#endif
 
    // Inform the VNC server of pixel formats and encodings
    setVNCPixelFormat();
@@ -163,10 +180,12 @@ VNCInterface::VNCInterface(const std::string& host, const vpr::Uint16 port,
 
 VNCInterface::~VNCInterface()
 {
-   if ( NULL != mReadBuffer )
+#if defined(VRJVNC_HAVE_ZLIB)
+   if ( mZStreamInit )
    {
-      delete[] mReadBuffer;
+      inflateEnd(&mZStream);
    }
+#endif
 
    if ( NULL != mFramebuffer )
    {
@@ -283,7 +302,6 @@ void VNCInterface::addUpdate(int x, int y, int w, int h)
    Rectangle r;
    r.x = x; r.y = y; r.width = w; r.height = h;
 
-   /*
    // Let's move through the rectangle queue looking for potential
    // merges to eliminate some updates
    std::list<Rectangle>::iterator i = mRectQueue.begin();
@@ -300,7 +318,6 @@ void VNCInterface::addUpdate(int x, int y, int w, int h)
          mRectQueue.erase(temp);
       }
    }
-   */
 
    // Finally, add the new rectangle to the end of the queue
    mRectQueue.push_back(r);
@@ -347,106 +364,507 @@ Rectangle VNCInterface::merge(const Rectangle &r1, const Rectangle &r2)
 #endif
    int x1 = r1.x + r1.width;  int x2 = r2.x + r2.width;
    int y1 = r1.y + r1.height; int y2 = r2.y + r2.height;
-   r.width = (x1 > x2) ? r1.width : r2.width;
-   r.height = (y1 > y2) ? r1.height : r2.height;
+   r.width = ((x1 > x2) ? x1 : x2) - r.x;
+   r.height = ((y1 > y2) ? y1 : y2) - r.y;
 
    return r;
 }
 
-/** Copy the rectange buffer at buf into the frame buffer.
-* @param buf - The buffer to read from
-* @param x,y - The origin of the target rect in the framebuffer
-* @param w,h - Width and height of the source and target rectangle buffers
-*/
-void VNCInterface::copyRectToFramebuffer(char *buf, int x, int y, int w, int h)
+void VNCInterface::fillRect(int x, int y, int w, int h, vpr::Uint32 pixel)
 {
-   int bytes_per_pixel = (mPf.size / 8);
+   vpr::Uint32* row =
+      reinterpret_cast<vpr::Uint32*>(mFramebuffer) + (y * mWidth) + x;
+
+   for ( int cur_line = 0; cur_line != h; ++cur_line )
+   {
+      std::fill(row, row + w, pixel);
+      row += mWidth;
+   }
+}
+
+vpr::Uint32 VNCInterface::readPixel()
+{
+   // Pixels arrive in our own pixel format, which is also the framebuffer
+   // format, so the bytes are used as they are.
+   vpr::Uint32 pixel;
+   readData(&pixel, sizeof(pixel));
+   return pixel;
+}
+
+void VNCInterface::handleRawRect(int x, int y, int w, int h)
+{
+   const int bytes_per_pixel = (mPf.size / 8);
+   const vpr::Uint32 row_bytes = w * bytes_per_pixel;
 
    // Find start of the target area in the frame buffer
    char* fbptr = mFramebuffer + (((y * mWidth) + x) * bytes_per_pixel);
 
-   // Copy the contents of the rectangle buffer
-   // - Copy one horizontal line at a time
-   for(int cur_line=0; cur_line != h; ++cur_line)
+   vprDEBUG(vrjDBG_VNC, vprDBG_HVERB_LVL)
+      << "Reading " << row_bytes * h << " bytes into the framebuffer\n"
+      << vprDEBUG_FLUSH;
+
+   // The pixels are read straight into the framebuffer.  A full-width
+   // rectangle is contiguous and can be read at once.  Otherwise, read one
+   // horizontal line at a time.
+   if ( w == mWidth )
+   {
+      readData(fbptr, row_bytes * h);
+   }
+   else
    {
-      // Copy memory
-      memcpy(fbptr, buf, w * bytes_per_pixel);
+      for ( int cur_line = 0; cur_line != h; ++cur_line )
+      {
+         readData(fbptr, row_bytes);
+         fbptr += mWidth * bytes_per_pixel;
+      }
+   }
+}
+
+void VNCInterface::handleCopyRect(int x, int y, int w, int h)
+{
+   rfbCopyRect cr;
+   readData(&cr, sz_rfbCopyRect);
+
+   const int src_x = Swap16IfLE(cr.srcX);
+   const int src_y = Swap16IfLE(cr.srcY);
+
+   if ( src_x + w > mWidth || src_y + h > mHeight )
+   {
+      throw VNCProtoException("CopyRect source out of range.");
+   }
+
+   const int bytes_per_pixel = (mPf.size / 8);
+   const int fb_row_bytes = mWidth * bytes_per_pixel;
+   const int row_bytes = w * bytes_per_pixel;
 
-      // Update buffer positions
-      fbptr += mWidth * bytes_per_pixel;     // Add size of fb line to get to next line in rect
-      buf   += w * bytes_per_pixel;          // Get to next start line in src
+   char* src = mFramebuffer + (((src_y * mWidth) + src_x) * bytes_per_pixel);
+   char* dst = mFramebuffer + (((y * mWidth) + x) * bytes_per_pixel);
+
+   // Source and destination may overlap.  When moving down, copy from the
+   // bottom row up so that no row is overwritten before it has been copied.
+   // memmove() takes care of overlap within a row.
+   if ( y > src_y )
+   {
+      src += (h - 1) * fb_row_bytes;
+      dst += (h - 1) * fb_row_bytes;
+
+      for ( int cur_line = 0; cur_line != h; ++cur_line )
+      {
+         memmove(dst, src, row_bytes);
+         src -= fb_row_bytes;
+         dst -= fb_row_bytes;
+      }
+   }
+   else
+   {
+      for ( int cur_line = 0; cur_line != h; ++cur_line )
+      {
+         memmove(dst, src, row_bytes);
+         src += fb_row_bytes;
+         dst += fb_row_bytes;
+      }
    }
 }
 
-void VNCInterface::readData(std::string& data, vpr::Uint32 len)
+void VNCInterface::handleHextileRect(int x, int y, int w, int h)
 {
-   vprDEBUG_OutputGuard(vrjDBG_VNC, vprDBG_STATE_LVL,
-                        "readData(std::string, vpr::Uint32) entered\n",
-                        "readData(std::string, vpr::Uint32) done.\n");
+   // The background and foreground colors carry over from one tile to the
+   // next when a tile does not specify them.
+   vpr::Uint32 bg(0), fg(0);
 
-   vprDEBUG(vrjDBG_VNC, vprDBG_STATE_LVL)
-      << "Reading " << len << " bytes from socket\n" << vprDEBUG_FLUSH;
+   for ( int ty = y; ty < y + h; ty += HEXTILE_TILE_SIZE )
+   {
+      const int th = (std::min)(HEXTILE_TILE_SIZE, y + h - ty);
 
-   try
+      for ( int tx = x; tx < x + w; tx += HEXTILE_TILE_SIZE )
+      {
+         const int tw = (std::min)(HEXTILE_TILE_SIZE, x + w - tx);
+
+         vpr::Uint8 subencoding;
+         readData(&subencoding, 1);
+
+         if ( subencoding & rfbHextileRaw )
+         {
+            handleRawRect(tx, ty, tw, th);
+            continue;
+         }
+
+         if ( subencoding & rfbHextileBackgroundSpecified )
+         {
+            bg = readPixel();
+         }
+
+         fillRect(tx, ty, tw, th, bg);
+
+         if ( subencoding & rfbHextileForegroundSpecified )
+         {
+            fg = readPixel();
+         }
+
+         if ( subencoding & rfbHextileAnySubrects )
+         {
+            vpr::Uint8 num_subrects;
+            readData(&num_subrects, 1);
+
+            const bool colored = (subencoding & rfbHextileSubrectsColoured) != 0;
+
+            for ( int i = 0; i < num_subrects; ++i )
+            {
+               const vpr::Uint32 color = colored ? readPixel() : fg;
+
+               vpr::Uint8 xy_wh[2];
+               readData(xy_wh, 2);
+
+               const int sx = rfbHextileExtractX(xy_wh[0]);
+               const int sy = rfbHextileExtractY(xy_wh[0]);
+               const int sw = rfbHextileExtractW(xy_wh[1]);
+               const int sh = rfbHextileExtractH(xy_wh[1]);
+
+               if ( sx + sw > tw || sy + sh > th )
+               {
+                  throw VNCProtoException("Hextile subrectangle out of range.");
+               }
+
+               fillRect(tx + sx, ty + sy, sw, sh, color);
+            }
+         }
+      }
+   }
+}
+
+#if defined(VRJVNC_HAVE_ZLIB)
+namespace
+{
+
+/**
+ * Bounds-checked reader over the inflated data of one ZRLE rectangle.
+ */
+class ZRLEReader
+{
+public:
+   ZRLEReader(const vpr::Uint8* data, const size_t size)
+      : mCur(data), mEnd(data + size)
    {
-      vpr::Uint32 bytes_read;
-      mSock.recvn(data, len, bytes_read);
+   }
 
-      vprDEBUG(vrjDBG_VNC, vprDBG_STATE_LVL)
-         << "Got " << bytes_read << " bytes from socket\n" << vprDEBUG_FLUSH;
+   vpr::Uint8 readByte()
+   {
+      need(1);
+      return *mCur++;
+   }
+
+   /**
+    * Reads a compressed pixel.  For our 32 bpp, depth 24, little-endian
+    * pixel format, a CPIXEL is the three least significant bytes.
+    */
+   vpr::Uint32 readCPixel()
+   {
+      need(3);
+      vpr::Uint8 bytes[4] = { mCur[0], mCur[1], mCur[2], 0 };
+      mCur += 3;
+
+      vpr::Uint32 pixel;
+      memcpy(&pixel, bytes, sizeof(pixel));
+      return pixel;
+   }
 
-      if ( len != bytes_read )
+   /** Reads a run length: the sum of bytes up to the first non-255, plus 1. */
+   int readRunLength()
+   {
+      int length(1);
+      vpr::Uint8 b;
+      do
       {
-         std::stringstream msg_stream;
-         msg_stream << "Failed to read " << len << " bytes";
-         throw NetReadException(msg_stream.str());
+         b = readByte();
+         length += b;
       }
+      while ( b == 255 );
+
+      return length;
    }
-   catch (vpr::IOException& ex)
+
+private:
+   void need(const size_t bytes)
    {
-      std::stringstream msg_stream;
-      msg_stream << "Failed to read " << len << " bytes: " << ex.what();
-      // XXX: setCause(ex) ?
-      throw NetReadException(msg_stream.str());
+      if ( static_cast<size_t>(mEnd - mCur) < bytes )
+      {
+         throw VNCProtoException("Truncated ZRLE data.");
+      }
    }
+
+   const vpr::Uint8* mCur;
+   const vpr::Uint8* mEnd;
+};
+
 }
 
-void VNCInterface::readData(void* data, vpr::Uint32 len)
+void VNCInterface::handleZRLERect(int x, int y, int w, int h)
 {
-   vprDEBUG_OutputGuard(vrjDBG_VNC, vprDBG_STATE_LVL,
-                        "readData(void*, vpr::Uint32) entered\n",
-                        "readData(void*, vpr::Uint32) done.\n");
+   if ( ! mZStreamInit )
+   {
+      throw VNCEncodingException("ZRLE received without a zlib stream.");
+   }
 
-   vpr::Uint32 bytes_read;
+   vpr::Uint32 length;
+   readData(&length, 4);
+   length = Swap32IfLE(length);
 
-   vprDEBUG(vrjDBG_VNC, vprDBG_STATE_LVL)
-      << "Reading " << len << " bytes from socket\n" << vprDEBUG_FLUSH;
+   mZlibIn.resize(length);
+   if ( length > 0 )
+   {
+      readData(&mZlibIn[0], length);
+   }
 
-   try
+   // Inflate the whole rectangle before decoding it.  The output buffer is
+   // kept between updates and only grows.
+   if ( mZlibOut.empty() )
    {
-      mSock.recvn(data, len, bytes_read);
-      vprDEBUG(vrjDBG_VNC, vprDBG_STATE_LVL)
-         << "Got " << bytes_read << " bytes from socket\n" << vprDEBUG_FLUSH;
+      mZlibOut.resize(ZRLE_TILE_SIZE * ZRLE_TILE_SIZE * 4);
+   }
 
-      if ( len != bytes_read )
+   mZStream.next_in  = length > 0 ? &mZlibIn[0] : Z_NULL;
+   mZStream.avail_in = length;
+
+   // inflate() can use up the input and still hold output back when the
+   // output buffer fills, so keep going until it has room left over.
+   size_t produced(0);
+   bool more(length > 0);
+   while ( more )
+   {
+      if ( produced == mZlibOut.size() )
       {
-         std::ostringstream msg_stream;
-         msg_stream << "Failed to read " << len << " bytes";
-         throw NetReadException(msg_stream.str());
+         mZlibOut.resize(mZlibOut.size() * 2);
       }
+
+      mZStream.next_out  = &mZlibOut[produced];
+      mZStream.avail_out = mZlibOut.size() - produced;
+
+      const int result = inflate(&mZStream, Z_SYNC_FLUSH);
+      produced = mZlibOut.size() - mZStream.avail_out;
+
+      if ( result != Z_OK && result != Z_BUF_ERROR )
+      {
+         throw VNCProtoException("ZRLE inflate failed.");
+      }
+
+      more = mZStream.avail_in > 0 || mZStream.avail_out == 0;
+   }
+
+   ZRLEReader reader(produced > 0 ? &mZlibOut[0] : NULL, produced);
+   vpr::Uint32 palette[128];
+
+   for ( int ty = y; ty < y + h; ty += ZRLE_TILE_SIZE )
+   {
+      const int th = (std::min)(ZRLE_TILE_SIZE, y + h - ty);
+
+      for ( int tx = x; tx < x + w; tx += ZRLE_TILE_SIZE )
+      {
+         const int tw = (std::min)(ZRLE_TILE_SIZE, x + w - tx);
+         const int subencoding = reader.readByte();
+
+         vpr::Uint32* tile_row =
+            reinterpret_cast<vpr::Uint32*>(mFramebuffer) + (ty * mWidth) + tx;
+
+         if ( subencoding == 0 )
+         {
+            // Raw
+            for ( int row = 0; row < th; ++row, tile_row += mWidth )
+            {
+               for ( int col = 0; col < tw; ++col )
+               {
+                  tile_row[col] = reader.readCPixel();
+               }
+            }
+         }
+         else if ( subencoding == 1 )
+         {
+            // Solid
+            fillRect(tx, ty, tw, th, reader.readCPixel());
+         }
+         else if ( subencoding <= 16 )
+         {
+            // Packed palette.  Each row starts on a byte boundary.
+            const int palette_size = subencoding;
+            for ( int i = 0; i < palette_size; ++i )
+            {
+               palette[i] = reader.readCPixel();
+            }
+
+            const int bits = palette_size == 2 ? 1 : (palette_size <= 4 ? 2 : 4);
+            const int mask = (1 << bits) - 1;
+
+            for ( int row = 0; row < th; ++row, tile_row += mWidth )
+            {
+               int byte(0), shift(0);
+               for ( int col = 0; col < tw; ++col )
+               {
+                  if ( shift == 0 )
+                  {
+                     byte  = reader.readByte();
+                     shift = 8;
+                  }
+                  shift -= bits;
+
+                  const int index = (byte >> shift) & mask;
+                  if ( index >= palette_size )
+                  {
+                     throw VNCProtoException("ZRLE palette index out of range.");
+                  }
+                  tile_row[col] = palette[index];
+               }
+            }
+         }
+         else if ( subencoding == 128 || subencoding >= 130 )
+         {
+            // Plain RLE (128) or palette RLE (130-255).  Runs continue from
+            // the end of one row of the tile onto the next.
+            const int palette_size = (subencoding == 128) ? 0
+                                                          : subencoding - 128;
+            for ( int i = 0; i < palette_size; ++i )
+            {
+               palette[i] = reader.readCPixel();
+            }
+
+            const int total = tw * th;
+            int done(0), col(0);
+
+            while ( done < total )
+            {
+               vpr::Uint32 pixel;
+               int run(1);
+
+               if ( palette_size == 0 )
+               {
+                  pixel = reader.readCPixel();
+                  run   = reader.readRunLength();
+               }
+               else
+               {
+                  const int index = reader.readByte();
+                  if ( (index & 127) >= palette_size )
+                  {
+                     throw VNCProtoException("ZRLE palette index out of range.");
+                  }
+
+                  pixel = palette[index & 127];
+                  if ( index & 128 )
+                  {
+                     run = reader.readRunLength();
+                  }
+               }
+
+               if ( run > total - done )
+               {
+                  throw VNCProtoException("ZRLE run out of range.");
+               }
+
+               done += run;
+               while ( run > 0 )
+               {
+                  const int n = (std::min)(run, tw - col);
+                  std::fill(tile_row + col, tile_row + col + n, pixel);
+                  col += n;
+                  run -= n;
+
+                  if ( col == tw )
+                  {
+                     col = 0;
+                     tile_row += mWidth;
+                  }
+               }
+            }
+         }
+         else
+         {
+            throw VNCProtoException("Unknown ZRLE tile subencoding.");
+         }
+      }
+   }
+}
+#endif
+
+void VNCInterface::fillRecvBuffer()
+{
+   try
+   {
+      mRecvPos = 0;
+      mRecvEnd = 0;
+      mRecvEnd = mSock.recv(&mRecvBuffer[0], mRecvBuffer.size());
    }
    catch (vpr::IOException& ex)
    {
+      // XXX: setCause(ex) ?
       throw NetReadException(ex.what());
    }
+
+   vprDEBUG(vrjDBG_VNC, vprDBG_HVERB_LVL)
+      << "Got " << mRecvEnd << " bytes from socket\n" << vprDEBUG_FLUSH;
+
+   if ( 0 == mRecvEnd )
+   {
+      throw NetReadException("Connection closed by the VNC server");
+   }
+}
+
+void VNCInterface::readData(std::string& data, vpr::Uint32 len)
+{
+   data.resize(len);
+
+   if ( len > 0 )
+   {
+      readData(&data[0], len);
+   }
+}
+
+// Reads are served from mRecvBuffer so that the many small reads made while
+// decoding Hextile and CopyRect do not each cost a system call.
+void VNCInterface::readData(void* data, vpr::Uint32 len)
+{
+   char* dst = static_cast<char*>(data);
+
+   while ( len > 0 )
+   {
+      if ( mRecvPos == mRecvEnd )
+      {
+         // Large reads (mostly raw rectangles) bypass the buffer so that the
+         // pixels are copied only once.
+         if ( len >= mRecvBuffer.size() )
+         {
+            try
+            {
+               const vpr::Uint32 bytes_read = mSock.recvn(dst, len);
+
+               if ( len != bytes_read )
+               {
+                  std::ostringstream msg_stream;
+                  msg_stream << "Failed to read " << len << " bytes";
+                  throw NetReadException(msg_stream.str());
+               }
+            }
+            catch (vpr::IOException& ex)
+            {
+               throw NetReadException(ex.what());
+            }
+
+            return;
+         }
+
+         fillRecvBuffer();
+      }
+
+      const vpr::Uint32 count = (std::min)(len, mRecvEnd - mRecvPos);
+      memcpy(dst, &mRecvBuffer[mRecvPos], count);
+      mRecvPos += count;
+      dst      += count;
+      len      -= count;
+   }
 }
 
 void VNCInterface::writeData(const void* data, vpr::Uint32 len)
 {
    try
    {
-      vpr::Uint32 bytes_written;
-      mSock.write(data, len, bytes_written);
+      const vpr::Uint32 bytes_written = mSock.write(data, len);
 
       if ( len != bytes_written )
       {
@@ -699,21 +1117,17 @@ void VNCInterface::setVNCEncodings()
     se->type = rfbSetEncodings;
     se->nEncodings = 0;
 
-    // @@@ We just want raw encoding for now!
-    encs[se->nEncodings++] = Swap32IfLE(rfbEncodingRaw);
-
-    /*
-    if (mSock.isSameHost() == true) {
-	fprintf(stderr,"Same machine: preferring raw encoding\n");
-	encs[se->nEncodings++] = Swap32IfLE(rfbEncodingRaw);
-    }
-
-    // Set up the encodings we support
+    // Set up the encodings we support, most preferred first.  The server
+    // uses CopyRect whenever it applies.  Raw stays last as the fallback.
     encs[se->nEncodings++] = Swap32IfLE(rfbEncodingCopyRect);
+#if defined(VRJVNC_HAVE_ZLIB)
+    if ( mZStreamInit )
+    {
+       encs[se->nEncodings++] = Swap32IfLE(rfbEncodingZRLE);
+    }
+#endif
     encs[se->nEncodings++] = Swap32IfLE(rfbEncodingHextile);
-    encs[se->nEncodings++] = Swap32IfLE(rfbEncodingCoRRE);
-    encs[se->nEncodings++] = Swap32IfLE(rfbEncodingRRE);
-    */
+    encs[se->nEncodings++] = Swap32IfLE(rfbEncodingRaw);
 
     len = sz_rfbSetEncodingsMsg + se->nEncodings * 4;
     se->nEncodings = Swap16IfLE(se->nEncodings);
@@ -775,24 +1189,22 @@ void VNCInterface::handleVNCFramebufferUpdate()
       switch (rect_u.encoding)
       {
       case rfbEncodingRaw:
-         {
-            // How many lines can we copy?
-            size_t bytes_in_update = rect_u.r.w * rect_u.r.h * (mPf.size /8);
-            vprASSERT(bytes_in_update <= mReadBufferSize);     // Assert read buffer is large enough
+         handleRawRect(rect_u.r.x, rect_u.r.y, rect_u.r.w, rect_u.r.h);
+         break;
 
-            // Read the entire rectangle from the server
-            vprDEBUG(vrjDBG_VNC, vprDBG_HVERB_LVL)
-               << "Reading " << bytes_in_update
-               << " bytes into the read buffer\n" << vprDEBUG_FLUSH;
+      case rfbEncodingCopyRect:
+         handleCopyRect(rect_u.r.x, rect_u.r.y, rect_u.r.w, rect_u.r.h);
+         break;
 
-            // Read data from the server
-            readData(mReadBuffer, bytes_in_update);
+      case rfbEncodingHextile:
+         handleHextileRect(rect_u.r.x, rect_u.r.y, rect_u.r.w, rect_u.r.h);
+         break;
 
-            // Copy the rectangle buffer into the framebuffer
-            copyRectToFramebuffer(mReadBuffer, rect_u.r.x, rect_u.r.y,
-                                  rect_u.r.w, rect_u.r.h);
-         }
+#if defined(VRJVNC_HAVE_ZLIB)
+      case rfbEncodingZRLE:
+         handleZRLERect(rect_u.r.x, rect_u.r.y, rect_u.r.w, rect_u.r.h);
          break;
+#endif
 
       default:
          throw VNCEncodingException("Unknown rectangle encoding.");
@@ -60,8 +60,13 @@
 
 #include <list>
 #include <string>
+#include <vector>
 #include <exception>
 
+#if defined(VRJVNC_HAVE_ZLIB)
+#  include <zlib.h>
+#endif
+
 #include <vpr/vpr.h>
 #include <vpr/IO/Socket/SocketStream.h>
 #include <vpr/Sync/Mutex.h>
@@ -247,17 +252,24 @@ public:
     */
    bool getFramebufferUpdate(Rectangle &r);
 
+protected:
+   /**
+    * Reads and handles one message from the VNC server.  run() calls this
+    * in a loop.
+    *
+    * @throw VNCProtoException if the server sends a malformed message.
+    * @throw NetReadException  if reading from the server fails.
+    */
+   void handleVNCServerMessage();
+
 private:
-   /// Adds a rectangle update to the update queue.
+   /**
+    * Adds a rectangle update to the update queue.  Queued rectangles that
+    * overlap the new one are merged into it so that the consumer sees as few
+    * dirty regions as possible.
+    */
    void addUpdate(int x, int y, int w, int h);
 
-   /** Copies a rectangle buffer to the framebuffer.
-   * @param buf - Source buffer.
-   * @param x,y - Destination origin.
-   * @param w,h - width and height of source and destination rect
-   */
-   void copyRectToFramebuffer(char* buf, int x, int y, int w, int h);
-
    /** Should two rectangles be merged into one?
    * @return true - Rectangles should be merged.
    */
@@ -269,12 +281,41 @@ private:
    */
    Rectangle merge(const Rectangle& r1, const Rectangle& r2);
 
+   /** @name Rectangle decoders
+    * Each of these reads the pixel data for one rectangle of a framebuffer
+    * update and writes it straight into the framebuffer.
+    */
+   //@{
+   /// Handles rfbEncodingRaw.
+   void handleRawRect(int x, int y, int w, int h);
+
+   /// Handles rfbEncodingCopyRect.
+   void handleCopyRect(int x, int y, int w, int h);
+
+   /// Handles rfbEncodingHextile.
+   void handleHextileRect(int x, int y, int w, int h);
+
+#if defined(VRJVNC_HAVE_ZLIB)
+   /// Handles rfbEncodingZRLE.
+   void handleZRLERect(int x, int y, int w, int h);
+#endif
+   //@}
+
+   /// Fills a rectangle of the framebuffer with a single pixel value.
+   void fillRect(int x, int y, int w, int h, vpr::Uint32 pixel);
+
+   /// Reads one pixel in the client pixel format from the VNC server.
+   vpr::Uint32 readPixel();
+
    /// Reads data from the VNC server.
    void readData(std::string& data, vpr::Uint32 len);
 
    /// Reads data from the VNC server.
    void readData(void* data, vpr::Uint32 len);
 
+   /// Refills the receive buffer with whatever the server has sent.
+   void fillRecvBuffer();
+
    /// Writes data to the VNC server.
    void writeData(const void* data, vpr::Uint32 len);
 
@@ -287,9 +328,6 @@ private:
    /// Initializes VNC session.
    void handleVNCInitialization();
 
-   /// Handles a VNC server message (called by main loop).
-   void handleVNCServerMessage();
-
    /// Handles server cut text.
    void handleVNCServerCutText();
 
@@ -327,9 +365,27 @@ private:
    */
    char* mFramebuffer;
 
-   // Read buffer (used in framebuffer updates)
-   vpr::Uint32 mReadBufferSize;
-   char*       mReadBuffer;
+   /** @name Receive buffer
+    * Socket reads go through this buffer so that the many small reads made
+    * by the Hextile and message decoders do not each cost a system call.
+    */
+   //@{
+   std::vector<char> mRecvBuffer;
+   vpr::Uint32       mRecvPos;       /**< Next unread byte */
+   vpr::Uint32       mRecvEnd;       /**< One past the last valid byte */
+   //@}
+
+#if defined(VRJVNC_HAVE_ZLIB)
+   /** @name ZRLE state
+    * The zlib stream persists for the lifetime of the connection.
+    */
+   //@{
+   z_stream                mZStream;
+   bool                    mZStreamInit;
+   std::vector<vpr::Uint8> mZlibIn;
+   std::vector<vpr::Uint8> mZlibOut;
+   //@}
+#endif
 
    vpr::Mutex mMutex;
    bool       mRunning;
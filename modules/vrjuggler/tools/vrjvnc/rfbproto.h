@@ -289,6 +289,7 @@ typedef struct {
 #define rfbEncodingRRE 2
 #define rfbEncodingCoRRE 4
 #define rfbEncodingHextile 5
+#define rfbEncodingZRLE 16
 
 
 
@@ -0,0 +1,1010 @@
+/*********** <VRJ VNC auto-copyright.pl BEGIN do not edit this line> **********
+ *
+ * VRJ VNC is (C) Copyright 2003-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Patrick Hartling, Allen Bierbaum
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this application; if not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ ************ <VRJ VNC auto-copyright.pl END do not edit this line> **********/
+
+/*
+ * Loopback test for the rectangle decoders of vrjvnc::VNCInterface.  A
+ * scripted stand-in for an RFB server listens on localhost, answers the
+ * connection handshake and then sends FramebufferUpdate messages that use the
+ * Raw, CopyRect, Hextile and ZRLE encodings.  Every tile kind of Hextile and
+ * ZRLE is used, CopyRect is run with overlapping source and destination in
+ * both directions, and several ZRLE rectangles share one zlib stream.  One
+ * ZRLE rectangle inflates to more than the initial inflate buffer of the
+ * client and ends just before the zlib flush marker, which comes with the
+ * next rectangle.
+ *
+ * After each message, the client framebuffer is compared with a model that
+ * the script updates as it encodes, and the dirty rectangles reported by
+ * getFramebufferUpdate() are compared with the expected, merged ones.  Last,
+ * malformed CopyRect, Hextile and ZRLE input is sent, each on a connection
+ * of its own, and must be rejected with vrjvnc::VNCProtoException.
+ *
+ * Usage: vncDecodeTest [-p port]
+ *
+ * The exit status is non-zero if any check fails.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/bind.hpp>
+
+#if defined(VRJVNC_HAVE_ZLIB)
+#  include <zlib.h>
+#endif
+
+#if defined(WIN32) || defined(WIN64)
+#  include <WinCompat.h>
+#else
+#  include <X11/Xmd.h>
+#endif
+
+extern "C" {
+#include <rfbproto.h>
+}
+
+#include <vpr/vpr.h>
+#include <vpr/IO/IOException.h>
+#include <vpr/IO/Socket/InetAddr.h>
+#include <vpr/IO/Socket/SocketStream.h>
+#include <vpr/Thread/Thread.h>
+#include <vpr/Util/Interval.h>
+
+#include <Rectangle.h>
+#include <VNCInterface.h>
+
+
+namespace
+{
+
+const int FB_WIDTH(80);
+const int FB_HEIGHT(96);
+
+unsigned int gFailures(0);
+
+void check(const bool condition, const std::string& what)
+{
+   if ( ! condition )
+   {
+      std::cerr << "FAILED: " << what << std::endl;
+      ++gFailures;
+   }
+}
+
+/** A 24-bit test color that differs for every position and seed. */
+vpr::Uint32 makePixel(const int x, const int y, const int seed)
+{
+   return ((x * 37 + y * 101 + seed * 13 + 1) * 2654435761u) & 0xFFFFFF;
+}
+
+/** Builds data in RFB wire order. */
+class Message
+{
+public:
+   void put8(const vpr::Uint32 value)
+   {
+      mData.push_back(static_cast<vpr::Uint8>(value));
+   }
+
+   void put16(const vpr::Uint32 value)
+   {
+      put8(value >> 8);
+      put8(value);
+   }
+
+   void put32(const vpr::Uint32 value)
+   {
+      put16(value >> 16);
+      put16(value);
+   }
+
+   /** A pixel in the client format: 32 bits per pixel, little-endian. */
+   void putPixel(const vpr::Uint32 pixel)
+   {
+      put8(pixel);
+      put8(pixel >> 8);
+      put8(pixel >> 16);
+      put8(pixel >> 24);
+   }
+
+   /** A ZRLE compressed pixel: the three low bytes of a pixel. */
+   void putCPixel(const vpr::Uint32 pixel)
+   {
+      put8(pixel);
+      put8(pixel >> 8);
+      put8(pixel >> 16);
+   }
+
+   /** A ZRLE run length. */
+   void putRunLength(int length)
+   {
+      for ( --length; length >= 255; length -= 255 )
+      {
+         put8(255);
+      }
+      put8(length);
+   }
+
+   void beginUpdate(const int numRects)
+   {
+      put8(rfbFramebufferUpdate);
+      put8(0);
+      put16(numRects);
+   }
+
+   void putRectHeader(const int x, const int y, const int w, const int h,
+                      const vpr::Uint32 encoding)
+   {
+      put16(x);
+      put16(y);
+      put16(w);
+      put16(h);
+      put32(encoding);
+   }
+
+   void append(const std::vector<vpr::Uint8>& data)
+   {
+      mData.insert(mData.end(), data.begin(), data.end());
+   }
+
+   std::vector<vpr::Uint8> mData;
+};
+
+/** Gives the script access to the message loop of the client. */
+class TestClient : public vrjvnc::VNCInterface
+{
+public:
+   TestClient(const vpr::Uint16 port)
+      : vrjvnc::VNCInterface("localhost", port, "")
+   {
+   }
+
+   using vrjvnc::VNCInterface::handleVNCServerMessage;
+};
+
+/** What the client framebuffer should contain. */
+class Model
+{
+public:
+   Model()
+      : mPixels(FB_WIDTH * FB_HEIGHT, 0)
+   {
+   }
+
+   vpr::Uint32& at(const int x, const int y)
+   {
+      return mPixels[y * FB_WIDTH + x];
+   }
+
+   void fill(const int x, const int y, const int w, const int h,
+             const vpr::Uint32 pixel)
+   {
+      for ( int row = y; row < y + h; ++row )
+      {
+         for ( int col = x; col < x + w; ++col )
+         {
+            at(col, row) = pixel;
+         }
+      }
+   }
+
+   void copy(const int srcX, const int srcY, const int x, const int y,
+             const int w, const int h)
+   {
+      const std::vector<vpr::Uint32> before(mPixels);
+      for ( int row = 0; row < h; ++row )
+      {
+         for ( int col = 0; col < w; ++col )
+         {
+            at(x + col, y + row) =
+               before[(srcY + row) * FB_WIDTH + srcX + col];
+         }
+      }
+   }
+
+   /** Returns the number of pixels of \p framebuffer that differ. */
+   int compare(const char* framebuffer) const
+   {
+      int differences(0);
+      for ( std::size_t i = 0; i < mPixels.size(); ++i )
+      {
+         vpr::Uint32 pixel;
+         std::memcpy(&pixel, framebuffer + i * 4, 4);
+         if ( pixel != mPixels[i] )
+         {
+            ++differences;
+         }
+      }
+      return differences;
+   }
+
+private:
+   std::vector<vpr::Uint32> mPixels;
+};
+
+#if defined(VRJVNC_HAVE_ZLIB)
+/**
+ * The ZRLE side of the server.  The zlib stream lasts as long as the
+ * connection, as in a real server.
+ */
+class ZRLEEncoder
+{
+public:
+   ZRLEEncoder()
+   {
+      std::memset(&mStream, 0, sizeof(mStream));
+      deflateInit(&mStream, Z_DEFAULT_COMPRESSION);
+   }
+
+   ~ZRLEEncoder()
+   {
+      deflateEnd(&mStream);
+   }
+
+   /**
+    * Compresses \p tiles and appends them to \p msg with their length.  If
+    * \p holdMarker is true, the last four bytes of the flush marker are
+    * held back and sent at the start of the next rectangle.
+    */
+   void put(Message& msg, const Message& tiles, const bool holdMarker = false)
+   {
+      std::vector<vpr::Uint8> out(mHeld);
+      out.resize(mHeld.size() + tiles.mData.size() * 2 + 64);
+      mStream.next_in   = const_cast<vpr::Uint8*>(&tiles.mData[0]);
+      mStream.avail_in  = tiles.mData.size();
+      mStream.next_out  = &out[mHeld.size()];
+      mStream.avail_out = out.size() - mHeld.size();
+      deflate(&mStream, Z_SYNC_FLUSH);
+      out.resize(out.size() - mStream.avail_out);
+
+      mHeld.clear();
+      if ( holdMarker )
+      {
+         mHeld.assign(out.end() - 4, out.end());
+         out.resize(out.size() - 4);
+      }
+
+      msg.put32(out.size());
+      msg.append(out);
+   }
+
+private:
+   z_stream                mStream;
+   std::vector<vpr::Uint8> mHeld;
+};
+#endif
+
+/**
+ * One connection between the scripted server and a vrjvnc::VNCInterface.
+ * The handshake runs in a thread because the client constructor does not
+ * return until it is done.  After that, the script writes to the server
+ * socket directly.
+ */
+class Session
+{
+public:
+   explicit Session(const vpr::Uint16 port)
+      : mClient(NULL)
+   {
+      vpr::InetAddr addr;
+      addr.setAddress("localhost", port);
+      mListener.setLocalAddr(addr);
+      mListener.openServer(true);
+
+      vpr::Thread server(boost::bind(&Session::handshake, this));
+
+      try
+      {
+         mClient = new TestClient(port);
+      }
+      catch (std::exception& ex)
+      {
+         mError = ex.what();
+      }
+
+      server.join();
+      mListener.close();
+   }
+
+   ~Session()
+   {
+      delete mClient;
+      mServer.close();
+   }
+
+   bool isConnected() const
+   {
+      return NULL != mClient && mError.empty();
+   }
+
+   const std::string& getError() const
+   {
+      return mError;
+   }
+
+   TestClient& client()
+   {
+      return *mClient;
+   }
+
+   void send(const Message& msg)
+   {
+      mServer.send(&msg.mData[0], msg.mData.size());
+   }
+
+#if defined(VRJVNC_HAVE_ZLIB)
+   ZRLEEncoder& zrle()
+   {
+      return mZRLE;
+   }
+#endif
+
+private:
+   void handshake()
+   {
+      try
+      {
+         mListener.accept(mServer, vpr::Interval(10, vpr::Interval::Sec));
+
+         const std::string version("RFB 003.003\n");
+         mServer.send(version.c_str(), version.size());
+
+         char client_version[12];
+         mServer.recvn(client_version, sizeof(client_version));
+
+         Message auth;
+         auth.put32(rfbNoAuth);
+         send(auth);
+
+         vpr::Uint8 shared;
+         mServer.recvn(&shared, 1);
+
+         const std::string name("vncDecodeTest");
+         Message init;
+         init.put16(FB_WIDTH);
+         init.put16(FB_HEIGHT);
+         init.put8(32);          // bits per pixel
+         init.put8(24);          // depth
+         init.put8(0);           // big endian
+         init.put8(1);           // true color
+         init.put16(255);        // red max
+         init.put16(255);        // green max
+         init.put16(255);        // blue max
+         init.put8(0);           // red shift
+         init.put8(8);           // green shift
+         init.put8(16);          // blue shift
+         init.put8(0);
+         init.put16(0);          // padding
+         init.put32(name.size());
+         init.append(std::vector<vpr::Uint8>(name.begin(), name.end()));
+         send(init);
+
+         // The SetPixelFormat, SetEncodings and FramebufferUpdateRequest
+         // messages of the client are left unread.
+      }
+      catch (vpr::IOException& ex)
+      {
+         mError = ex.what();
+      }
+   }
+
+   vpr::SocketStream     mListener;
+   vpr::SocketStream     mServer;
+   TestClient*           mClient;
+   std::string           mError;
+#if defined(VRJVNC_HAVE_ZLIB)
+   ZRLEEncoder           mZRLE;
+#endif
+};
+
+/**
+ * Has the client handle one message and compares the result with the model
+ * and the expected dirty rectangles.
+ */
+void expectUpdate(Session& session, const Message& msg, const Model& model,
+                  const std::vector<vrjvnc::Rectangle>& dirty,
+                  const std::string& what)
+{
+   session.send(msg);
+
+   try
+   {
+      session.client().handleVNCServerMessage();
+   }
+   catch (std::exception& ex)
+   {
+      check(false, what + ": " + ex.what());
+      return;
+   }
+
+   const int differences = model.compare(session.client().getFramebuffer());
+   check(differences == 0, what + ": framebuffer differs from the model");
+
+   std::vector<vrjvnc::Rectangle> reported;
+   vrjvnc::Rectangle r;
+   while ( session.client().getFramebufferUpdate(r) )
+   {
+      reported.push_back(r);
+   }
+
+   bool same(reported.size() == dirty.size());
+   for ( std::size_t i = 0; same && i < dirty.size(); ++i )
+   {
+      same = reported[i].x == dirty[i].x && reported[i].y == dirty[i].y &&
+             reported[i].width == dirty[i].width &&
+             reported[i].height == dirty[i].height;
+   }
+   check(same, what + ": wrong dirty rectangles");
+}
+
+vrjvnc::Rectangle rect(const int x, const int y, const int w, const int h)
+{
+   vrjvnc::Rectangle r;
+   r.x      = x;
+   r.y      = y;
+   r.width  = w;
+   r.height = h;
+   return r;
+}
+
+std::vector<vrjvnc::Rectangle> rects(const vrjvnc::Rectangle& r1)
+{
+   return std::vector<vrjvnc::Rectangle>(1, r1);
+}
+
+void putRaw(Message& msg, Model& model, const int x, const int y,
+            const int w, const int h, const int seed)
+{
+   for ( int row = y; row < y + h; ++row )
+   {
+      for ( int col = x; col < x + w; ++col )
+      {
+         model.at(col, row) = makePixel(col, row, seed);
+         msg.putPixel(model.at(col, row));
+      }
+   }
+}
+
+void putCopyRect(Message& msg, Model& model, const int srcX, const int srcY,
+                 const int x, const int y, const int w, const int h)
+{
+   msg.putRectHeader(x, y, w, h, rfbEncodingCopyRect);
+   msg.put16(srcX);
+   msg.put16(srcY);
+   model.copy(srcX, srcY, x, y, w, h);
+}
+
+/**
+ * Encodes a Hextile rectangle, cycling through the tile kinds: raw,
+ * background only, monochrome subrectangles, colored subrectangles without
+ * a background, and no flags at all (the background carries over).
+ */
+void putHextile(Message& msg, Model& model, const int x, const int y,
+                const int w, const int h)
+{
+   msg.putRectHeader(x, y, w, h, rfbEncodingHextile);
+
+   vpr::Uint32 bg(0);
+   int tile(0);
+
+   for ( int ty = y; ty < y + h; ty += 16 )
+   {
+      const int th = std::min(16, y + h - ty);
+      for ( int tx = x; tx < x + w; tx += 16, ++tile )
+      {
+         const int tw = std::min(16, x + w - tx);
+
+         switch ( tile % 5 )
+         {
+            case 0:
+               msg.put8(rfbHextileRaw);
+               putRaw(msg, model, tx, ty, tw, th, tile);
+               break;
+            case 1:
+               bg = makePixel(tx, ty, 1000 + tile);
+               msg.put8(rfbHextileBackgroundSpecified);
+               msg.putPixel(bg);
+               model.fill(tx, ty, tw, th, bg);
+               break;
+            case 2:
+            {
+               const vpr::Uint32 fg = makePixel(tx, ty, 2000 + tile);
+               bg = makePixel(tx, ty, 3000 + tile);
+               msg.put8(rfbHextileBackgroundSpecified |
+                        rfbHextileForegroundSpecified |
+                        rfbHextileAnySubrects);
+               msg.putPixel(bg);
+               msg.putPixel(fg);
+               msg.put8(2);
+               msg.put8(rfbHextilePackXY(1, 1));
+               msg.put8(rfbHextilePackWH(3, 2));
+               msg.put8(rfbHextilePackXY(tw - 2, th - 2));
+               msg.put8(rfbHextilePackWH(2, 2));
+               model.fill(tx, ty, tw, th, bg);
+               model.fill(tx + 1, ty + 1, 3, 2, fg);
+               model.fill(tx + tw - 2, ty + th - 2, 2, 2, fg);
+               break;
+            }
+            case 3:
+            {
+               const vpr::Uint32 c1 = makePixel(tx, ty, 4000 + tile);
+               const vpr::Uint32 c2 = makePixel(tx, ty, 5000 + tile);
+               msg.put8(rfbHextileAnySubrects | rfbHextileSubrectsColoured);
+               msg.put8(2);
+               msg.putPixel(c1);
+               msg.put8(rfbHextilePackXY(0, 0));
+               msg.put8(rfbHextilePackWH(tw, 1));
+               msg.putPixel(c2);
+               msg.put8(rfbHextilePackXY(0, th - 1));
+               msg.put8(rfbHextilePackWH(1, 1));
+               model.fill(tx, ty, tw, th, bg);
+               model.fill(tx, ty, tw, 1, c1);
+               model.fill(tx, ty + th - 1, 1, 1, c2);
+               break;
+            }
+            default:
+               msg.put8(0);
+               model.fill(tx, ty, tw, th, bg);
+               break;
+         }
+      }
+   }
+}
+
+#if defined(VRJVNC_HAVE_ZLIB)
+/** Appends one packed palette row of \p indices, \p bits bits per index. */
+void putPackedRow(Message& tiles, const std::vector<int>& indices,
+                  const int bits)
+{
+   int byte(0), used(0);
+   for ( std::size_t i = 0; i < indices.size(); ++i )
+   {
+      byte  = (byte << bits) | indices[i];
+      used += bits;
+      if ( used == 8 )
+      {
+         tiles.put8(byte);
+         byte = 0;
+         used = 0;
+      }
+   }
+
+   if ( used > 0 )
+   {
+      tiles.put8(byte << (8 - used));
+   }
+}
+
+/**
+ * Encodes one ZRLE tile of the given kind: 0 raw, 1 solid, 2 to 4 packed
+ * palettes of 2, 3 and 5 colors, 5 plain RLE and 6 palette RLE.
+ */
+void putZRLETile(Message& tiles, Model& model, const int kind, const int tx,
+                 const int ty, const int tw, const int th, const int seed)
+{
+   switch ( kind )
+   {
+      case 0:
+         tiles.put8(0);
+         for ( int row = ty; row < ty + th; ++row )
+         {
+            for ( int col = tx; col < tx + tw; ++col )
+            {
+               model.at(col, row) = makePixel(col, row, seed);
+               tiles.putCPixel(model.at(col, row));
+            }
+         }
+         break;
+      case 1:
+      {
+         const vpr::Uint32 pixel = makePixel(tx, ty, seed);
+         tiles.put8(1);
+         tiles.putCPixel(pixel);
+         model.fill(tx, ty, tw, th, pixel);
+         break;
+      }
+      case 2:
+      case 3:
+      case 4:
+      {
+         const int palette_size = kind == 2 ? 2 : (kind == 3 ? 3 : 5);
+         const int bits = kind == 2 ? 1 : (kind == 3 ? 2 : 4);
+
+         tiles.put8(palette_size);
+         std::vector<vpr::Uint32> palette;
+         for ( int i = 0; i < palette_size; ++i )
+         {
+            palette.push_back(makePixel(i, 0, seed));
+            tiles.putCPixel(palette.back());
+         }
+
+         for ( int row = ty; row < ty + th; ++row )
+         {
+            std::vector<int> indices;
+            for ( int col = tx; col < tx + tw; ++col )
+            {
+               indices.push_back((col * 3 + row) % palette_size);
+               model.at(col, row) = palette[indices.back()];
+            }
+            putPackedRow(tiles, indices, bits);
+         }
+         break;
+      }
+      case 5:
+      case 6:
+      {
+         // The runs cross the rows of the tile, and some are longer than 255
+         // so that their lengths take more than one byte.
+         const int palette_size = kind == 5 ? 0 : 4;
+         std::vector<vpr::Uint32> palette;
+
+         tiles.put8(kind == 5 ? 128 : 128 + palette_size);
+         for ( int i = 0; i < palette_size; ++i )
+         {
+            palette.push_back(makePixel(i, 1, seed));
+            tiles.putCPixel(palette.back());
+         }
+
+         const int total = tw * th;
+         int done(0), run_index(0);
+         while ( done < total )
+         {
+            const int lengths[] = { 1, 7, 300, 2, 64, 511 };
+            const int run = std::min(lengths[run_index % 6], total - done);
+
+            vpr::Uint32 pixel;
+            if ( palette_size == 0 )
+            {
+               pixel = makePixel(run_index, 2, seed);
+               tiles.putCPixel(pixel);
+               tiles.putRunLength(run);
+            }
+            else
+            {
+               const int index = run_index % palette_size;
+               pixel = palette[index];
+               if ( run == 1 )
+               {
+                  tiles.put8(index);
+               }
+               else
+               {
+                  tiles.put8(index | 128);
+                  tiles.putRunLength(run);
+               }
+            }
+
+            for ( int i = done; i < done + run; ++i )
+            {
+               model.at(tx + i % tw, ty + i / tw) = pixel;
+            }
+
+            done += run;
+            ++run_index;
+         }
+         break;
+      }
+   }
+}
+
+/**
+ * Encodes a ZRLE rectangle.  Its tiles take the kinds following \p nextKind,
+ * which is advanced past them.
+ */
+void putZRLE(Session& session, Message& msg, Model& model, const int x,
+             const int y, const int w, const int h, int& nextKind)
+{
+   msg.putRectHeader(x, y, w, h, rfbEncodingZRLE);
+
+   Message tiles;
+   for ( int ty = y; ty < y + h; ty += 64 )
+   {
+      const int th = std::min(64, y + h - ty);
+      for ( int tx = x; tx < x + w; tx += 64 )
+      {
+         const int tw = std::min(64, x + w - tx);
+         putZRLETile(tiles, model, nextKind % 7, tx, ty, tw, th, nextKind);
+         ++nextKind;
+      }
+   }
+
+   session.zrle().put(msg, tiles);
+}
+
+/**
+ * Encodes a ZRLE rectangle of black raw tiles and holds back the end of its
+ * flush marker.
+ */
+void putBlackZRLE(Session& session, Message& msg, Model& model, const int x,
+                  const int y, const int w, const int h)
+{
+   msg.putRectHeader(x, y, w, h, rfbEncodingZRLE);
+
+   Message tiles;
+   for ( int ty = y; ty < y + h; ty += 64 )
+   {
+      const int th = std::min(64, y + h - ty);
+      for ( int tx = x; tx < x + w; tx += 64 )
+      {
+         const int tw = std::min(64, x + w - tx);
+         tiles.put8(0);
+         for ( int i = 0; i < tw * th; ++i )
+         {
+            tiles.putCPixel(0);
+         }
+      }
+   }
+   model.fill(x, y, w, h, 0);
+
+   session.zrle().put(msg, tiles, true);
+}
+#endif
+
+/** Sends \p msg on a new connection and expects it to be rejected. */
+void expectProtoError(const vpr::Uint16 port, const Message& msg,
+                      const std::string& what)
+{
+   Session session(port);
+   if ( ! session.isConnected() )
+   {
+      check(false, what + ": could not connect: " + session.getError());
+      return;
+   }
+
+   session.send(msg);
+
+   try
+   {
+      session.client().handleVNCServerMessage();
+      check(false, what + ": accepted");
+   }
+   catch (vrjvnc::VNCProtoException&)
+   {
+   }
+   catch (std::exception& ex)
+   {
+      check(false, what + ": wrong exception: " + ex.what());
+   }
+}
+
+/** A message with a single rectangle whose body is \p body. */
+Message singleRect(const int w, const int h, const vpr::Uint32 encoding,
+                   const Message& body)
+{
+   Message msg;
+   msg.beginUpdate(1);
+   msg.putRectHeader(0, 0, w, h, encoding);
+   msg.append(body.mData);
+   return msg;
+}
+
+#if defined(VRJVNC_HAVE_ZLIB)
+/** A ZRLE message with a single rectangle whose tile data is \p tiles. */
+Message singleZRLE(const int w, const int h, const Message& tiles)
+{
+   ZRLEEncoder encoder;
+   Message body;
+   encoder.put(body, tiles);
+   return singleRect(w, h, rfbEncodingZRLE, body);
+}
+#endif
+
+}
+
+int main(int argc, char* argv[])
+{
+   vpr::Uint16 port(15900);
+
+   for ( int i = 1; i + 1 < argc; i += 2 )
+   {
+      if ( std::strcmp(argv[i], "-p") == 0 )
+      {
+         port = std::atoi(argv[i + 1]);
+      }
+   }
+
+   {
+      Session session(port++);
+      if ( ! session.isConnected() )
+      {
+         std::cerr << "FAILED: could not connect: " << session.getError()
+                   << std::endl;
+         return EXIT_FAILURE;
+      }
+
+      check(session.client().getWidth() == FB_WIDTH &&
+            session.client().getHeight() == FB_HEIGHT, "desktop size");
+
+      Model model;
+      Message msg;
+
+      msg.beginUpdate(1);
+      msg.putRectHeader(0, 0, FB_WIDTH, FB_HEIGHT, rfbEncodingRaw);
+      putRaw(msg, model, 0, 0, FB_WIDTH, FB_HEIGHT, 1);
+      expectUpdate(session, msg, model, rects(rect(0, 0, FB_WIDTH, FB_HEIGHT)),
+                   "Raw");
+
+      // Moving down and right, then up and left, over the source.
+      msg = Message();
+      msg.beginUpdate(1);
+      putCopyRect(msg, model, 0, 0, 8, 4, 32, 16);
+      expectUpdate(session, msg, model, rects(rect(8, 4, 32, 16)),
+                   "CopyRect down");
+
+      msg = Message();
+      msg.beginUpdate(1);
+      putCopyRect(msg, model, 10, 10, 2, 3, 20, 12);
+      expectUpdate(session, msg, model, rects(rect(2, 3, 20, 12)),
+                   "CopyRect up");
+
+      // Within one row: the same row moved to the right.
+      msg = Message();
+      msg.beginUpdate(1);
+      putCopyRect(msg, model, 40, 20, 43, 20, 30, 1);
+      expectUpdate(session, msg, model, rects(rect(43, 20, 30, 1)),
+                   "CopyRect in a row");
+
+      // Partial tiles on the right and bottom edges.
+      msg = Message();
+      msg.beginUpdate(1);
+      putHextile(msg, model, 5, 3, 40, 37);
+      expectUpdate(session, msg, model, rects(rect(5, 3, 40, 37)),
+                   "Hextile");
+
+      // Two overlapping rectangles merge; the distant one stays apart.
+      msg = Message();
+      msg.beginUpdate(3);
+      msg.putRectHeader(0, 0, 10, 10, rfbEncodingRaw);
+      putRaw(msg, model, 0, 0, 10, 10, 2);
+      msg.putRectHeader(5, 5, 10, 10, rfbEncodingRaw);
+      putRaw(msg, model, 5, 5, 10, 10, 3);
+      putCopyRect(msg, model, 0, 0, 60, 40, 4, 4);
+      std::vector<vrjvnc::Rectangle> dirty;
+      dirty.push_back(rect(0, 0, 15, 15));
+      dirty.push_back(rect(60, 40, 4, 4));
+      expectUpdate(session, msg, model, dirty, "Merged rectangles");
+
+#if defined(VRJVNC_HAVE_ZLIB)
+      // Every ZRLE tile kind, over several rectangles and messages that
+      // share the zlib stream.
+      int kind(0);
+
+      msg = Message();
+      msg.beginUpdate(2);
+      putZRLE(session, msg, model, 3, 2, 70, 45, kind);
+      putZRLE(session, msg, model, 0, 0, FB_WIDTH, FB_HEIGHT, kind);
+      expectUpdate(session, msg, model,
+                   rects(rect(0, 0, FB_WIDTH, FB_HEIGHT)), "ZRLE 1");
+
+      msg = Message();
+      msg.beginUpdate(1);
+      putZRLE(session, msg, model, 8, 8, 64, 33, kind);
+      expectUpdate(session, msg, model, rects(rect(8, 8, 64, 33)), "ZRLE 2");
+
+      msg = Message();
+      msg.beginUpdate(1);
+      putZRLE(session, msg, model, 0, 0, FB_WIDTH, FB_HEIGHT, kind);
+      expectUpdate(session, msg, model,
+                   rects(rect(0, 0, FB_WIDTH, FB_HEIGHT)), "ZRLE 3");
+
+      check(kind >= 7, "not every ZRLE tile kind was used");
+#endif
+   }
+
+#if defined(VRJVNC_HAVE_ZLIB)
+   {
+      Session session(port++);
+      if ( ! session.isConnected() )
+      {
+         std::cerr << "FAILED: could not connect: " << session.getError()
+                   << std::endl;
+         return EXIT_FAILURE;
+      }
+
+      // The first rectangle inflates to 16486 bytes, more than the 16384
+      // that the client starts with.  Its compressed data stops before the
+      // flush marker, so with the zlib default compression the last
+      // inflate() call uses up the input while zlib still holds output.
+      // The second rectangle starts with the rest of the marker and is
+      // decoded wrongly if the first one was cut short.
+      Model model;
+      Message msg;
+      int kind(0);
+
+      msg.beginUpdate(2);
+      putBlackZRLE(session, msg, model, 0, 0, 67, 82);
+      putZRLE(session, msg, model, 0, 82, FB_WIDTH, FB_HEIGHT - 82, kind);
+      expectUpdate(session, msg, model,
+                   rects(rect(0, 0, FB_WIDTH, FB_HEIGHT)),
+                   "ZRLE larger than the buffer");
+   }
+#endif
+
+   Message body;
+   body.put16(75);
+   body.put16(0);
+   expectProtoError(port++, singleRect(10, 10, rfbEncodingCopyRect, body),
+                    "CopyRect source out of range");
+
+   body = Message();
+   body.put8(rfbHextileBackgroundSpecified | rfbHextileAnySubrects);
+   body.putPixel(0);
+   body.put8(1);
+   body.put8(rfbHextilePackXY(4, 0));
+   body.put8(rfbHextilePackWH(8, 1));
+   expectProtoError(port++, singleRect(8, 8, rfbEncodingHextile, body),
+                    "Hextile subrectangle out of range");
+
+#if defined(VRJVNC_HAVE_ZLIB)
+   Message tiles;
+   tiles.put8(3);
+   tiles.putCPixel(1);
+   tiles.putCPixel(2);
+   tiles.putCPixel(3);
+   tiles.put8(0xFF);
+   expectProtoError(port++, singleZRLE(4, 1, tiles),
+                    "ZRLE packed palette index out of range");
+
+   tiles = Message();
+   tiles.put8(130);
+   tiles.putCPixel(1);
+   tiles.putCPixel(2);
+   tiles.put8(5);
+   expectProtoError(port++, singleZRLE(4, 1, tiles),
+                    "ZRLE RLE palette index out of range");
+
+   tiles = Message();
+   tiles.put8(128);
+   tiles.putCPixel(1);
+   tiles.putRunLength(11);
+   expectProtoError(port++, singleZRLE(4, 1, tiles), "ZRLE run too long");
+
+   tiles = Message();
+   tiles.put8(1);
+   tiles.put8(1);
+   tiles.put8(2);
+   expectProtoError(port++, singleZRLE(2, 2, tiles), "ZRLE truncated tile");
+
+   tiles = Message();
+   tiles.put8(17);
+   expectProtoError(port++, singleZRLE(2, 2, tiles),
+                    "ZRLE subencoding 17");
+
+   tiles = Message();
+   tiles.put8(129);
+   expectProtoError(port++, singleZRLE(2, 2, tiles),
+                    "ZRLE subencoding 129");
+#endif
+
+   if ( gFailures > 0 )
+   {
+      std::cerr << "FAILED: " << gFailures << " check(s)" << std::endl;
+      return EXIT_FAILURE;
+   }
+
+   std::cout << "All decoder checks passed" << std::endl;
+   return EXIT_SUCCESS;
+}
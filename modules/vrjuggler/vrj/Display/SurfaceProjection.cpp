@@ -56,6 +56,7 @@ SurfaceProjection::SurfaceProjection(const gmtl::Point3f& llCorner,
    , mLRCorner(lrCorner)
    , mURCorner(urCorner)
    , mULCorner(ulCorner)
+   , mOffsetsValid(false)
 {
    /* Do nothing. */ ;
 }
@@ -100,6 +101,7 @@ void SurfaceProjection::updateCorners(const gmtl::Point3f& llCorner,
    mLRCorner = lrCorner;
    mURCorner = urCorner;
    mULCorner = ulCorner;
+   mOffsetsValid = false;
 
    validateCorners();
 }
@@ -122,7 +124,12 @@ void SurfaceProjection::calcViewMatrix(const gmtl::Matrix44f&,
                                        const gmtl::Point3f& eyePoint,
                                        const float scaleFactor)
 {
-   calculateOffsets();
+   // The offsets only change with the corners.
+   if ( ! mOffsetsValid )
+   {
+      calculateOffsets();
+   }
+
    calcViewFrustum(eyePoint, scaleFactor);
 
    // Need to post translate to get the view matrix at the position of the
@@ -217,6 +224,8 @@ void SurfaceProjection::calculateOffsets()
    mOriginToLeft   = -mxLLCorner[gmtl::Xelt];
    mOriginToTop    = mxURCorner[gmtl::Yelt];
    mOriginToBottom = -mxLRCorner[gmtl::Yelt];
+
+   mOffsetsValid = true;
 }
 
 void SurfaceProjection::calculateSurfaceRotation()
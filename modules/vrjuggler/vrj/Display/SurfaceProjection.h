@@ -208,6 +208,12 @@ protected:
    float mOriginToLeft;
    float mOriginToTop;
    float mOriginToBottom;
+
+   /**
+    * Set by calculateOffsets() and cleared when the corners change.  Until
+    * then, calcViewMatrix() reuses the surface rotation and the offsets.
+    */
+   bool mOffsetsValid;
 };
 
 }
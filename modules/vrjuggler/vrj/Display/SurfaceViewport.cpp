@@ -51,6 +51,11 @@ namespace vrj
 SurfaceViewport::SurfaceViewport()
    : Viewport()
    , mTracked(false)
+   , mProjectionsValid(false)
+   , mLastEyeOffset(0.0f)
+   , mLastPositionScale(0.0f)
+   , mLastNearDist(0.0f)
+   , mLastFarDist(0.0f)
 {
    /* Do nothing. */ ;
 }
@@ -79,6 +84,7 @@ bool SurfaceViewport::config(jccl::ConfigElementPtr element)
    bool result(true);
 
    mType = SURFACE;
+   mProjectionsValid = false;
 
    // Read in the corners
    mLLCorner.set(element->getProperty<float>("lower_left_corner", 0),
@@ -184,6 +190,26 @@ void SurfaceViewport::updateProjections(const float positionScale)
    // Distance to move eye.
    const float eye_offset(interocular_dist * 0.5f);
 
+   float near_dist, far_dist;
+   Projection::getNearFar(near_dist, far_dist);
+
+   // A tracked surface moves on its own, so it is always recomputed.  Any
+   // other surface only has to be recomputed when one of its inputs changed.
+   if ( ! mTracked && mProjectionsValid &&
+        positionScale == mLastPositionScale && eye_offset == mLastEyeOffset &&
+        near_dist == mLastNearDist && far_dist == mLastFarDist &&
+        cur_head_pos == mLastHeadPos )
+   {
+      return;
+   }
+
+   mProjectionsValid  = true;
+   mLastHeadPos       = cur_head_pos;
+   mLastEyeOffset     = eye_offset;
+   mLastPositionScale = positionScale;
+   mLastNearDist      = near_dist;
+   mLastFarDist       = far_dist;
+
    // NOTE: Eye coord system is -z forward, x-right, y-up
 
    if (Viewport::LEFT_EYE == mView || Viewport::STEREO == mView)
@@ -311,6 +337,8 @@ void SurfaceViewport::updateCorners()
    }
 
    // Apply this update to the projections
+   mProjectionsValid = false;
+
    SurfaceProjectionPtr lproj = 
      boost::dynamic_pointer_cast<SurfaceProjection>(mLeftProj);
    vprASSERT(NULL != lproj.get());
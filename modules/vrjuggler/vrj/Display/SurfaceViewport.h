@@ -30,6 +30,7 @@
 #include <vrj/vrjConfig.h>
 
 #include <gmtl/Point.h>
+#include <gmtl/Matrix.h>
 #include <gmtl/Vec.h>
 #include <gmtl/VecOps.h>
 
@@ -84,6 +85,14 @@ public:
     */
    virtual bool config(jccl::ConfigElementPtr element);
 
+   /**
+    * Updates the left and right projections for the current head position.
+    * An untracked surface is only recomputed when the head position, the
+    * interocular distance, the position scale, or the near and far planes
+    * have changed since the last update, or when the corners have moved.
+    * The kernel updates every viewport once per frame before drawing starts,
+    * so the calls made by the draw managers are usually just this check.
+    */
    virtual void updateProjections(const float positionScale);
 
    void getCorners(gmtl::Point3f& ll, gmtl::Point3f& lr, gmtl::Point3f& ur,
@@ -141,6 +150,20 @@ protected:
    //@{
 
    void computePixelOriginAndSize();
+
+private:
+   /**
+    * @name Inputs to the last projection update
+    * Used by updateProjections() to skip work when nothing has changed.
+    */
+   //@{
+   bool            mProjectionsValid;
+   gmtl::Matrix44f mLastHeadPos;
+   float           mLastEyeOffset;
+   float           mLastPositionScale;
+   float           mLastNearDist;
+   float           mLastFarDist;
+   //@}
 };
 
 }
@@ -32,6 +32,7 @@
 #include <boost/algorithm/string.hpp>
 
 #include <vpr/System.h>
+#include <vpr/Thread/ThreadPlacement.h>
 #include <vpr/Util/Debug.h>
 
 #include <vrj/Util/Debug.h>
@@ -85,6 +86,12 @@ int CpuAffinityFromEnv::operator()(const unsigned int threadNum)
       // the environment variable.
       cpu = mCpuList[threadNum % mCpuList.size()];
    }
+   else
+   {
+      cpu = vpr::ThreadPlacement::instance()->getCpu(
+         vpr::ThreadPlacement::DRAW, threadNum
+      );
+   }
 
    return cpu;
 }
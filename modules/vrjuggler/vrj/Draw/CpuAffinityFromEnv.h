@@ -46,7 +46,8 @@ namespace vrj
  * that the Draw Manager creates, the affinity will be returned. If more
  * threads are created than there are CPUs identified by the environment
  * variable, then the affinity assignment simply starts over at the beginning
- * of the list.
+ * of the list.  When the environment variable is not set, the draw CPUs
+ * planned by vpr::ThreadPlacement are used (if placement is enabled).
  *
  * @since 2.3.14
  */
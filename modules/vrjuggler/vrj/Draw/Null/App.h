@@ -0,0 +1,101 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+#ifndef _VRJ_NULL_APP_H_
+#define _VRJ_NULL_APP_H_
+
+#include <vrj/vrjConfig.h>
+
+#include <vrj/Kernel/App.h>
+#include <vrj/Display/ViewportPtr.h>
+#include <vrj/Display/ProjectionPtr.h>
+
+
+namespace vrj
+{
+
+class Kernel;
+
+namespace null
+{
+
+/** \class vrj::null::App App.h vrj/Draw/Null/App.h
+ *
+ * Base class for applications rendered by vrj::null::DrawManager.  No
+ * window or graphics context is ever created for these applications, so
+ * they can run on machines without a display or a GPU.  This makes them
+ * useful for measuring the cost of the kernel frame (input update, cluster
+ * synchronization, projection updates, and the application callbacks) on
+ * its own.
+ *
+ * The control loop will look similar to this:
+ *
+ * \code
+ * while (drawing)
+ * {
+ *    app_obj->preFrame();
+ *    app_obj->latePreFrame();
+ *    app_obj->draw(viewport, proj); // called for each viewport and eye
+ *    app_obj->intraFrame();         // called in parallel to draw()
+ *    sync();
+ *    app_obj->postFrame();
+ *
+ *    updateAllDevices();
+ * }
+ * \endcode
+ *
+ * @see vrj::null::DrawManager
+ */
+class VJ_API App : public vrj::App
+{
+public:
+   App(Kernel* kern = NULL);
+
+   virtual ~App();
+
+   /**
+    * Called from the draw thread once for every eye of every active
+    * viewport.  The projection has already been updated for the current
+    * frame.  The default implementation does nothing.
+    */
+   virtual void draw(const vrj::ViewportPtr&, const vrj::ProjectionPtr&)
+   {;}
+
+   /**
+    * Returns the Null Draw Manager.
+    *
+    * @see vrj::App::getDrawManager()
+    */
+   virtual vrj::DrawManager* getDrawManager();
+};
+
+} // End of null namespace
+
+} // End of vrj namespace
+
+
+#endif
@@ -0,0 +1,373 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+#include <vrj/vrjConfig.h>
+
+#include <algorithm>
+#include <typeinfo>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include <vpr/System.h>
+#include <vpr/Util/Debug.h>
+#include <vpr/Perf/ProfileManager.h>
+
+#include <cluster/ClusterManager.h>
+
+#include <vrj/Util/Debug.h>
+#include <vrj/Kernel/KernelExceptions.h>
+#include <vrj/Display/Display.h>
+#include <vrj/Display/Viewport.h>
+
+#include <vrj/Draw/Null/App.h>
+#include <vrj/Draw/Null/DrawManager.h>
+
+
+namespace vrj
+{
+
+namespace null
+{
+
+vprSingletonImp(DrawManager);
+
+DrawManager::DrawManager()
+   : mApp(NULL)
+   , mDrawCost(0, vpr::Interval::Usec)
+   , mSleepForCost(false)
+   , mFrameCount(0)
+   , drawTriggerSema(0)
+   , drawDoneSema(0)
+   , mRunning(false)
+   , mControlThread(NULL)
+{
+   /* Do nothing. */ ;
+}
+
+DrawManager::~DrawManager()
+{
+   if ( mRunning )
+   {
+      // This will wait on mControlThread to exit.
+      closeAPI();
+   }
+
+   if ( NULL != mControlThread )
+   {
+      delete mControlThread;
+      mControlThread = NULL;
+   }
+}
+
+// Sets the app the draw should interact with.
+void DrawManager::setApp(vrj::App* app)
+{
+   mApp = dynamic_cast<vrj::null::App*>(app);
+
+   if ( NULL == mApp )
+   {
+      vprDEBUG(vprDBG_ERROR, vprDBG_CRITICAL_LVL)
+         << clrOutBOLD(clrRED, "ERROR:")
+         << " [vrj::null::DrawManager::setApp()] Failed to downcast "
+         << std::endl << vprDEBUG_FLUSH;
+      vprDEBUG_NEXT(vprDBG_ERROR, vprDBG_CRITICAL_LVL)
+         << "application object from vrj::App to vrj::null::App!"
+         << std::endl << vprDEBUG_FLUSH;
+      vprDEBUG_NEXT(vprDBG_ERROR, vprDBG_CRITICAL_LVL)
+         << "Type of object " << std::hex << app << std::dec << " is "
+         << typeid(app).name() << std::endl << vprDEBUG_FLUSH;
+
+      throw vrj::DrawMgrException("Object not of type vrj::null::App",
+                                  VPR_LOCATION);
+   }
+}
+
+// Returns the app we are rendering.
+vrj::null::App* DrawManager::getApp()
+{
+   return mApp;
+}
+
+void DrawManager::setDrawCost(const vpr::Interval& cost, const bool sleep)
+{
+   mDrawCost     = cost;
+   mSleepForCost = sleep;
+}
+
+// Starts the control loop.
+void DrawManager::start()
+{
+   mRunning = true;
+
+   // NOTE: Any exception thrown by spawning the thread will be propagated up
+   // to the caller.
+   mControlThread = new vpr::Thread(boost::bind(&DrawManager::main, this));
+
+   vprDEBUG(vrjDBG_DRAW_MGR, vprDBG_CONFIG_LVL)
+      << "vrj::null::DrawManager started (thread: " << mControlThread
+      << ")\n" << vprDEBUG_FLUSH;
+}
+
+// Trigger draw
+void DrawManager::draw()
+{
+   drawTriggerSema.release();
+}
+
+// Blocks until the end of the frame.
+void DrawManager::sync()
+{
+   drawDoneSema.acquire();
+}
+
+// This is the control loop for the manager.
+void DrawManager::main()
+{
+   bool stop_requested(false);
+
+   while ( ! stop_requested )
+   {
+      drawTriggerSema.acquire();
+
+      // As in the OpenGL Draw Manager, mRunning is only tested between
+      // drawTriggerSema.acquire() and drawDoneSema.release() so that
+      // closeAPI() can always complete its final trigger/done handshake.
+      if ( mRunning )
+      {
+         drawAllDisplays();
+      }
+      else
+      {
+         stop_requested = true;
+      }
+
+      drawDoneSema.release();
+   }
+}
+
+void DrawManager::drawAllDisplays()
+{
+   {
+      VPR_PROFILE_GUARD_HISTORY("null::DrawManager::drawAllDisplays Render",
+                                10);
+
+      typedef std::vector<DisplayPtr>::iterator iter_t;
+      for ( iter_t d = mDisplays.begin(); d != mDisplays.end(); ++d )
+      {
+         if ( ! (*d)->isActive() )
+         {
+            continue;
+         }
+
+         const std::vector<vrj::ViewportPtr>::size_type num_vp(
+            (*d)->getNumViewports()
+         );
+
+         for ( std::vector<vrj::ViewportPtr>::size_type v = 0;
+               v < num_vp;
+               ++v )
+         {
+            vrj::ViewportPtr vp = (*d)->getViewport(v);
+
+            // Simulator viewports get their projections from a draw
+            // simulator plug-in, and there is none to give them here.
+            if ( ! vp->isActive() || vp->isSimulator() )
+            {
+               continue;
+            }
+
+            const vrj::Viewport::View view(vp->getView());
+
+            if ( vrj::Viewport::LEFT_EYE == view ||
+                 vrj::Viewport::STEREO == view )
+            {
+               drawEye(vp, vp->getLeftProj());
+            }
+
+            if ( vrj::Viewport::RIGHT_EYE == view ||
+                 vrj::Viewport::STEREO == view )
+            {
+               drawEye(vp, vp->getRightProj());
+            }
+         }
+      }
+   }
+
+   {
+      VPR_PROFILE_GUARD_HISTORY("null::DrawManager::drawAllDisplays Barrier",
+                                10);
+      cluster::ClusterManager::instance()->swapBarrier();
+   }
+
+   ++mFrameCount;
+}
+
+void DrawManager::drawEye(const vrj::ViewportPtr& viewport,
+                          const vrj::ProjectionPtr& proj)
+{
+   if ( NULL != mApp )
+   {
+      mApp->draw(viewport, proj);
+   }
+
+   if ( 0 == mDrawCost.usec() )
+   {
+      return;
+   }
+
+   if ( mSleepForCost )
+   {
+      vpr::System::usleep(static_cast<vpr::Uint32>(mDrawCost.usec()));
+   }
+   else
+   {
+      const vpr::Interval start(vpr::Interval::now());
+      while ( vpr::Interval::now() - start < mDrawCost )
+      {
+         /* Spin. */ ;
+      }
+   }
+}
+
+// Initializes the drawing API (if not already running).
+void DrawManager::initAPI()
+{
+   std::string cost_str;
+   vpr::System::getenv("VJ_NULL_DRAW_USEC", cost_str);
+   boost::trim(cost_str);
+
+   if ( ! cost_str.empty() )
+   {
+      try
+      {
+         mDrawCost.set(boost::lexical_cast<vpr::Uint32>(cost_str),
+                       vpr::Interval::Usec);
+      }
+      catch (boost::bad_lexical_cast&)
+      {
+         vprDEBUG(vrjDBG_DRAW_MGR, vprDBG_WARNING_LVL)
+            << clrOutBOLD(clrYELLOW, "WARNING")
+            << ": Ignoring malformed VJ_NULL_DRAW_USEC value '" << cost_str
+            << "'\n" << vprDEBUG_FLUSH;
+      }
+   }
+
+   std::string sleep_str;
+   vpr::System::getenv("VJ_NULL_DRAW_SLEEP", sleep_str);
+   boost::trim(sleep_str);
+
+   if ( ! sleep_str.empty() )
+   {
+      mSleepForCost = sleep_str != "0" && ! boost::iequals(sleep_str, "false");
+   }
+
+   mFrameCount = 0;
+
+   vprDEBUG(vrjDBG_DRAW_MGR, vprDBG_CONFIG_LVL)
+      << "[vrj::null::DrawManager::initAPI()] Draw cost: "
+      << mDrawCost.usec() << " us per viewport eye ("
+      << (mSleepForCost ? "sleep" : "spin") << ")\n" << vprDEBUG_FLUSH;
+
+   start();
+}
+
+// Callback when display is added to display manager.
+void DrawManager::addDisplay(DisplayPtr disp)
+{
+   vprASSERT(disp.get() != NULL);    // Can't add a null display
+
+   vprDEBUG(vrjDBG_DRAW_MGR, vprDBG_STATE_LVL)
+      << "[vrj::null::DrawManager::addDisplay()] " << disp
+      << std::endl << vprDEBUG_FLUSH;
+
+   // The Display Manager only calls this between frames, so the draw thread
+   // is not looking at mDisplays.
+   if ( std::find(mDisplays.begin(), mDisplays.end(), disp) ==
+           mDisplays.end() )
+   {
+      mDisplays.push_back(disp);
+   }
+}
+
+// Callback when display is removed from display manager.
+void DrawManager::removeDisplay(DisplayPtr disp)
+{
+   mDisplays.erase(std::remove(mDisplays.begin(), mDisplays.end(), disp),
+                   mDisplays.end());
+}
+
+// Shutdown the drawing API.
+void DrawManager::closeAPI()
+{
+   vprDEBUG(vrjDBG_DRAW_MGR, vprDBG_STATE_LVL)
+      << "[vrj::null::DrawManager::closeAPI()]\n" << vprDEBUG_FLUSH;
+
+   mRunning = false;
+
+   // We must allow our control thread to fall through and die naturally.
+   drawTriggerSema.release();
+   drawDoneSema.acquire();
+   mControlThread->join();
+
+   mDisplays.clear();
+}
+
+// Adds the element to the draw manager config.
+bool DrawManager::configAdd(jccl::ConfigElementPtr)
+{
+   return false;
+}
+
+// Removes the element from the current configuration.
+bool DrawManager::configRemove(jccl::ConfigElementPtr)
+{
+   return false;
+}
+
+// Can the handler handle the given element?
+bool DrawManager::configCanHandle(jccl::ConfigElementPtr)
+{
+   return false;
+}
+
+void DrawManager::outStream(std::ostream& out) const
+{
+   out << clrSetNORM(clrGREEN)
+       << "========== vrj::null::DrawManager: " << (void*) this << " ========="
+       << clrRESET << std::endl
+       << clrOutNORM(clrCYAN, "\tapp: ") << (void*) mApp << std::endl
+       << clrOutNORM(clrCYAN, "\tDisplay count: ") << mDisplays.size()
+       << std::endl
+       << clrOutNORM(clrCYAN, "\tDraw cost: ") << mDrawCost.usec() << " us ("
+       << (mSleepForCost ? "sleep" : "spin") << ")" << std::endl
+       << "=======================================" << std::endl;
+}
+
+} // End of null namespace
+
+} // End of vrj namespace
@@ -0,0 +1,214 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+
+#ifndef _VRJ_NULL_DRAW_MANAGER_H_
+#define _VRJ_NULL_DRAW_MANAGER_H_
+
+#include <vrj/vrjConfig.h>
+
+#include <vector>
+#include <boost/noncopyable.hpp>
+
+#include <vpr/Sync/Semaphore.h>
+#include <vpr/Util/Interval.h>
+#include <vpr/Util/Singleton.h>
+#include <vpr/Thread/Thread.h>
+
+#include <jccl/Config/ConfigElementPtr.h>
+
+#include <vrj/Display/DisplayPtr.h>
+#include <vrj/Display/ViewportPtr.h>
+#include <vrj/Display/ProjectionPtr.h>
+#include <vrj/Draw/DrawManager.h>
+
+
+namespace vrj
+{
+
+namespace null
+{
+
+class App;
+
+/** \class vrj::null::DrawManager DrawManager.h vrj/Draw/Null/DrawManager.h
+ *
+ * Draw Manager that renders nothing.  It opens no windows and needs no
+ * windowing system or graphics hardware, so the whole kernel frame can be
+ * run and timed on headless machines.
+ *
+ * Like the other Draw Managers, this is an active object with a single draw
+ * thread that is triggered by draw() and waited on by sync().  For each eye
+ * of every active viewport, the draw thread passes the projection computed
+ * by the kernel for the current frame to vrj::null::App::draw() and then
+ * burns a configurable amount of time to stand in for the cost of real
+ * rendering.  By default that time is spent spinning so that the draw thread
+ * keeps a core busy the way a real draw thread would.  It can also be spent
+ * sleeping.  Once all viewports are done, the cluster swap barrier is
+ * entered exactly as it is before a real buffer swap.
+ *
+ * The initial settings are read from the environment when the API is
+ * initialized:
+ *
+ *  - \c VJ_NULL_DRAW_USEC: Draw cost per viewport eye in microseconds
+ *    (default 0).
+ *  - \c VJ_NULL_DRAW_SLEEP: If set to anything other than "0" or "false",
+ *    the draw cost is spent sleeping instead of spinning.
+ *
+ * @see vrj::null::App
+ */
+class VJ_API DrawManager
+   : public vrj::DrawManager
+   , private boost::noncopyable
+{
+public:
+   /** Starts the control loop. */
+   virtual void start();
+
+   /** Enables a frame to be drawn. */
+   virtual void draw();
+
+   /**
+    * Blocks until the end of the frame.
+    *
+    * @post The frame has been drawn.
+    */
+   virtual void sync();
+
+   /** Control loop for the manager. */
+   void main();
+
+   /** Initializes the drawing API (if not already running). */
+   virtual void initAPI();
+
+   /** Callback when display is added to the Display Manager. */
+   virtual void addDisplay(DisplayPtr disp);
+
+   /** Callback when display is removed from the Display Manager. */
+   virtual void removeDisplay(DisplayPtr disp);
+
+   /** Shuts down the drawing API. */
+   virtual void closeAPI();
+
+   /** Outputs some debug info. */
+   virtual void outStream(std::ostream& out) const;
+
+   /** "Draws" all the displays. */
+   void drawAllDisplays();
+
+   /** Sets the app the draw should interact with. */
+   virtual void setApp(vrj::App* app);
+
+   /** Returns the app we are rendering. */
+   vrj::null::App* getApp();
+
+   /**
+    * Sets the time spent on each eye of each active viewport.
+    *
+    * @param cost  The synthetic draw cost.
+    * @param sleep If true, the cost is spent sleeping.  Otherwise, the draw
+    *              thread spins for the duration.
+    */
+   void setDrawCost(const vpr::Interval& cost, const bool sleep = false);
+
+   /** Returns the time spent on each eye of each active viewport. */
+   const vpr::Interval& getDrawCost() const
+   {
+      return mDrawCost;
+   }
+
+   /** Returns the number of frames drawn since the API was initialized. */
+   vpr::Uint64 getFrameCount() const
+   {
+      return mFrameCount;
+   }
+
+public:
+   /** @name Config element handler implementation */
+   //@{
+   /**
+    * Adds the element to the configuration.
+    *
+    * @pre configCanHandle(element) == true
+    * @return success
+    */
+   virtual bool configAdd(jccl::ConfigElementPtr element);
+
+   /**
+    * Removes the element from the current configuration.
+    *
+    * @pre configCanHandle(element) == true
+    * @return success
+    */
+   virtual bool configRemove(jccl::ConfigElementPtr element);
+
+   /**
+    * Can the handler handle the given config element?
+    *
+    * @return true if we can handle it; false if we can't.
+    */
+   virtual bool configCanHandle(jccl::ConfigElementPtr element);
+   //@}
+
+protected:
+   /** Hands one eye of \p viewport to the app and spends the draw cost. */
+   void drawEye(const vrj::ViewportPtr& viewport,
+                const vrj::ProjectionPtr& proj);
+
+   vrj::null::App*          mApp;       /**< The application */
+   std::vector<DisplayPtr>  mDisplays;  /**< The displays to "draw" */
+
+   /** @name Synthetic draw cost */
+   //@{
+   vpr::Interval mDrawCost;
+   bool          mSleepForCost;
+   //@}
+
+   vpr::Uint64 mFrameCount;
+
+   /** @name MP Stuff */
+   //@{
+   vpr::Semaphore drawTriggerSema;  /**< Semaphore for draw trigger */
+   vpr::Semaphore drawDoneSema;     /**< Semaphore for drawing done */
+   bool           mRunning;         /**< Used to stop the drawing thread. */
+   vpr::Thread*   mControlThread;
+   //@}
+
+protected:
+   virtual ~DrawManager();
+
+private:
+   DrawManager();
+
+   vprSingletonHeader(DrawManager);
+};
+
+} // End of null namespace
+
+} // End of vrj namespace
+
+
+#endif
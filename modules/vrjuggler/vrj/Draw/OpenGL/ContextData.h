@@ -101,6 +101,11 @@ protected:
  * @note Requires that the type of the context-specific data provide a default
  *       constructor used to initialize all of the copies of the data.
  *
+ * @note Both of the thread-specific lookups made for each access (the
+ *       current context ID and the calling thread's data vector) go through
+ *       vpr::TSObjectProxy.  They use its thread-local fast path when
+ *       VPR_THREAD_LOCAL is defined.
+ *
  * @note This class was renamed from vrj::GlContextData in VR Juggler 2.3.11.
  */
 template<class ContextDataType = int>
@@ -31,6 +31,7 @@
 #include <boost/bind.hpp>
 
 #include <vpr/Thread/Thread.h>
+#include <vpr/Thread/ThreadPlacement.h>
 #include <vpr/Sync/Guard.h>
 
 #include <cluster/ClusterManager.h>
@@ -186,6 +187,8 @@ void Pipe::controlLoop(const int cpuAffinity)
    vprASSERT(NULL != vpr::Thread::self());
    mActiveThread = vpr::Thread::self();
 
+   vpr::ThreadPlacement::instance()->schedule(vpr::ThreadPlacement::DRAW);
+
    if ( cpuAffinity >= 0 )
    {
       vprDEBUG(vrjDBG_DRAW_MGR, vprDBG_STATE_LVL)
@@ -462,6 +465,8 @@ void Pipe::renderWindow(vrj::opengl::WindowPtr win)
 
    // Update the projections for the display using the current app's scale factor
    // NOTE: This relies upon no other thread trying to update this display at the same time
+   // NOTE: The kernel has normally updated them already for this frame, so
+   // this usually finds nothing to do.
    const float scale_factor = the_app->getDrawScaleFactor();
    the_display->updateProjections(scale_factor);
 
@@ -41,20 +41,25 @@
 #include <vrj/Kernel/App.h>
 #include <vrj/Kernel/User.h>
 #include <vrj/Kernel/KernelExceptions.h>
+#include <vrj/Performance/FrameTiming.h>
 #include <vrj/Performance/PerformanceMediator.h>
 #include <vrj/Sound/SoundManager.h>
 
 #include <vpr/vpr.h>
 #include <vpr/Thread/Thread.h>
 #include <vpr/Thread/Signal.h>
+#include <vpr/Thread/ThreadPlacement.h>
 #include <vpr/System.h>
 #include <vpr/Util/Version.h>
 #include <vpr/Util/FileUtils.h>
+#include <vpr/Util/FrameArena.h>
 #include <vpr/Util/IllegalArgumentException.h>
+#include <vpr/Util/Interval.h>
 #include <vpr/Perf/ProfileManager.h>
 
 #include <gadget/Util/Version.h>
 #include <gadget/InputManager.h>
+#include <gadget/Type/PositionProxy.h>
 
 #include <cluster/ClusterException.h>
 #include <cluster/ClusterManager.h>
@@ -87,6 +92,150 @@ void signalHandler(int signum)
    gRealHandler(signum);
 }
 
+/**
+ * Times the phases of one pass through vrj::Kernel::controlLoop() for
+ * vrj::PerformanceMediator.  Unless it is active for the current frame, each
+ * call costs a single branch.
+ */
+class FrameStamper
+{
+public:
+   FrameStamper()
+      : mActive(false)
+   {
+      memset(&mTiming, 0, sizeof(mTiming));
+   }
+
+   /** Starts timing a new frame if \p active is true. */
+   void begin(const bool active, const vpr::Uint64 frameNumber)
+   {
+      mActive = active;
+
+      if ( mActive )
+      {
+         memset(&mTiming, 0, sizeof(mTiming));
+         mTiming.frameNumber = frameNumber;
+         mStart.setNow();
+         mLast = mStart;
+         mTiming.startUsec = mStart.usec();
+      }
+   }
+
+   /** Charges the time since the previous call to \p phase. */
+   void end(const vrj::FrameTiming::Phase phase)
+   {
+      if ( mActive )
+      {
+         const vpr::Interval now(vpr::Interval::now());
+         mTiming.phaseUsec[phase] +=
+            static_cast<vpr::Uint32>((now - mLast).usec());
+         mLast = now;
+      }
+   }
+
+   /**
+    * Records how old the head pose is that the frame is drawn with, given
+    * the time stamp of its sample.
+    */
+   void poseSampled(const vpr::Interval& sampleTime)
+   {
+      if ( mActive && sampleTime != vpr::Interval() )
+      {
+         const vpr::Interval now(vpr::Interval::now());
+         mTiming.poseAgeUsec = sampleTime < now ?
+            static_cast<vpr::Uint32>((now - sampleTime).usec()) : 0;
+      }
+   }
+
+   /**
+    * Completes the timing of the current frame.  Returns NULL if the frame
+    * was not timed.
+    */
+   const vrj::FrameTiming* finish()
+   {
+      if ( ! mActive )
+      {
+         return NULL;
+      }
+
+      mTiming.frameUsec = static_cast<vpr::Uint32>((mLast - mStart).usec());
+      mTiming.drawUsec  = mTiming.phaseUsec[vrj::FrameTiming::DRAW_TRIGGER] +
+                          mTiming.phaseUsec[vrj::FrameTiming::INTRA_FRAME] +
+                          mTiming.phaseUsec[vrj::FrameTiming::DRAW_SYNC];
+      return &mTiming;
+   }
+
+private:
+   bool              mActive;
+   vrj::FrameTiming  mTiming;
+   vpr::Interval     mStart;
+   vpr::Interval     mLast;
+};
+
+/**
+ * Estimates when the frame drawn from the next proxy update will be
+ * displayed, for gadget::InputManager::setDisplayTime().  The estimate is
+ * the time of the update plus the average time from a proxy update to the end
+ * of the draw sync that follows it.  Latency after the buffer swap, such as
+ * scan-out, is left to the lead time of the predictive filters.
+ */
+class DisplayTimePredictor
+{
+public:
+   DisplayTimePredictor()
+      : mLatencyUsec(0.0)
+      , mPending(false)
+   {
+   }
+
+   /** Records that the frame using the last proxy update has been drawn. */
+   void frameDrawn()
+   {
+      if ( mPending )
+      {
+         const double sample(static_cast<double>(
+            (vpr::Interval::now() - mUpdateTime).usec()
+         ));
+         mLatencyUsec = mLatencyUsec == 0.0 ?
+            sample : mLatencyUsec + 0.1 * (sample - mLatencyUsec);
+         mPending = false;
+      }
+   }
+
+   /** Returns the display time of the frame the proxies are updated for. */
+   vpr::Interval proxiesUpdated()
+   {
+      mUpdateTime.setNow();
+      mPending = true;
+      return mUpdateTime +
+                vpr::Interval(static_cast<vpr::Uint64>(mLatencyUsec),
+                              vpr::Interval::Usec);
+   }
+
+private:
+   double         mLatencyUsec;
+   bool           mPending;
+   vpr::Interval  mUpdateTime;
+};
+
+/**
+ * Re-reads the head proxy of every user from the newest device sample.  This
+ * is the late latch that cuts the age of the head pose used for drawing by
+ * most of a frame.
+ */
+void latchHeadPoses(const std::vector<vrj::UserPtr>& users)
+{
+   typedef std::vector<vrj::UserPtr>::const_iterator iter_type;
+   for ( iter_type u = users.begin(); u != users.end(); ++u )
+   {
+      const gadget::PositionProxyPtr head((*u)->getHeadPosProxy());
+      if ( NULL != head.get() )
+      {
+         head->latchData();
+      }
+   }
+}
+
 }
 
 namespace vrj
@@ -538,6 +687,8 @@ void Kernel::controlLoop()
 
    mControlThread = vpr::Thread::self();
 
+   vpr::ThreadPlacement::instance()->place(vpr::ThreadPlacement::KERNEL);
+
    // Do any initial configuration
    initConfig();
 
@@ -546,9 +697,83 @@ void Kernel::controlLoop()
    bool first_cluster(true);
    bool cluster_active = mClusterManager->isClusterActive();
 
+   // Phase timing for the performance plug-in, if it wants it.
+   FrameStamper stamper;
+   vpr::Uint64 frame_number(0);
+
+   // Display time estimate for predictive position filters.
+   DisplayTimePredictor display_time;
+
+   // Late latching of the head poses.  Cluster nodes must all draw with the
+   // pose that was shared during the frame's synchronization, so it is only
+   // done for stand-alone applications.
+   std::string late_latch_str;
+   vpr::System::getenv("VJ_LATE_LATCH", late_latch_str);
+   const bool late_latch(! late_latch_str.empty() && late_latch_str != "0" &&
+                         ! cluster_active);
+
+   if ( late_latch )
+   {
+      vprDEBUG(vrjDBG_KERNEL, vprDBG_CONFIG_LVL)
+         << "vrj::Kernel::controlLoop: Late latching head poses.\n"
+         << vprDEBUG_FLUSH;
+   }
+
+   // Scratch memory for objects that are created and dropped within one
+   // frame, such as received cluster packets.  It is rewound at the top of
+   // every frame.  It is off unless VJ_FRAME_ARENA is set to 1.
+   vpr::FrameArena frame_arena;
+   std::string frame_arena_str;
+   vpr::System::getenv("VJ_FRAME_ARENA", frame_arena_str);
+   const bool use_frame_arena(frame_arena_str == "1");
+
+   // An object that outlives its frame keeps the arena from rewinding.  If
+   // that happens frame after frame, the arena fills up and everything goes
+   // back to the heap, so we warn once when it has gone on for this long.
+   const unsigned int deferred_reset_warn_frames(100);
+   vpr::Uint64 last_deferred_resets(0);
+   unsigned int deferred_reset_frames(0);
+   bool deferred_reset_warned(false);
+
+   if ( use_frame_arena )
+   {
+      vprDEBUG(vrjDBG_KERNEL, vprDBG_CONFIG_LVL)
+         << "vrj::Kernel::controlLoop: Using a frame arena.\n"
+         << vprDEBUG_FLUSH;
+      vpr::FrameArena::setCurrent(&frame_arena);
+   }
+
    // --- MAIN CONTROL LOOP -- //
    while(! (mExitFlag && (mApp == NULL)))     // While not exit flag set and don't have app. (can't exit until app is closed)
    {
+      if ( use_frame_arena )
+      {
+         frame_arena.reset();
+
+         const vpr::Uint64 deferred_resets =
+            frame_arena.getStats().deferredResets;
+         deferred_reset_frames =
+            deferred_resets > last_deferred_resets ? deferred_reset_frames + 1
+                                                   : 0;
+         last_deferred_resets = deferred_resets;
+
+         if ( ! deferred_reset_warned &&
+              deferred_reset_frames >= deferred_reset_warn_frames )
+         {
+            vprDEBUG(vrjDBG_KERNEL, vprDBG_WARNING_LVL)
+               << clrOutBOLD(clrYELLOW, "WARNING:")
+               << " The frame arena could not be rewound in the last "
+               << deferred_reset_frames << " frames.\n" << vprDEBUG_FLUSH;
+            vprDEBUG_NEXT(vrjDBG_KERNEL, vprDBG_WARNING_LVL)
+               << "Something keeps per-frame objects alive across frames. "
+               << "Unset VJ_FRAME_ARENA to turn the arena off.\n"
+               << vprDEBUG_FLUSH;
+            deferred_reset_warned = true;
+         }
+      }
+
+      stamper.begin(mPerformanceMediator->needsFrameTiming(), frame_number++);
+
       // Are we not running in cluster configuration, or the cluster is ready.
       bool cluster_ready = mClusterManager->isClusterReady();
       bool call_app = !cluster_active || cluster_ready;
@@ -583,6 +808,7 @@ void Kernel::controlLoop()
          vprASSERT(NULL != mControlThread);      // If control thread is not set correctly, it will seg fault here
          vpr::Thread::yield();   // Give up CPU
       }
+      stamper.end(FrameTiming::PRE_FRAME);
 
       if (call_cluster)
       {
@@ -590,6 +816,7 @@ void Kernel::controlLoop()
          mClusterManager->preDraw();
          vpr::prof::stop();
       }
+      stamper.end(FrameTiming::CLUSTER_PRE_DRAW);
 
       if((mApp != NULL) && (mDrawManager != NULL) && call_app)
       {
@@ -598,6 +825,25 @@ void Kernel::controlLoop()
                << vprDEBUG_FLUSH;
             vpr::prof::start("App: latePreFrame",10);
          mApp->latePreFrame();
+         stamper.end(FrameTiming::LATE_PRE_FRAME);
+            vprDEBUG(vrjDBG_KERNEL, vprDBG_HVERB_LVL)
+               << "vrj::Kernel::controlLoop: Update Projections\n"
+               << vprDEBUG_FLUSH;
+            vpr::prof::next("Update projections",10);
+         // LATE LATCH: Pick up head samples taken since the proxy update.
+         if ( late_latch )
+         {
+            latchHeadPoses(mUsers);
+         }
+         if ( ! mUsers.empty() &&
+              NULL != mUsers[0]->getHeadPosProxy().get() )
+         {
+            stamper.poseSampled(mUsers[0]->getHeadPosProxy()->getTimeStamp());
+         }
+         // PROJECTIONS: Computed once for every display before any draw
+         // thread runs, so that the draw threads find them up to date.
+         mDisplayManager->updateProjections(mApp->getDrawScaleFactor());
+         stamper.end(FrameTiming::PROJECTIONS);
             vprDEBUG(vrjDBG_KERNEL, vprDBG_HVERB_LVL)
                << "vrj::Kernel::controlLoop: drawManager->draw()\n"
                << vprDEBUG_FLUSH;
@@ -605,11 +851,13 @@ void Kernel::controlLoop()
          mDrawManager->draw();    // DRAW: Trigger the beginning of frame drawing
             vpr::prof::next("sound mgr update",10);
          mSoundManager->update();
+         stamper.end(FrameTiming::DRAW_TRIGGER);
             vprDEBUG(vrjDBG_KERNEL, vprDBG_HVERB_LVL)
                << "vrj::Kernel::controlLoop: mApp->intraFrame()\n"
                << vprDEBUG_FLUSH;
             vpr::prof::next("App: intraFrame",10);
          mApp->intraFrame();        // INTRA FRAME: Do computations that can be done while drawing.  This should be for next frame.
+         stamper.end(FrameTiming::INTRA_FRAME);
             vprDEBUG(vrjDBG_KERNEL, vprDBG_HVERB_LVL)
                << "vrj::Kernel::controlLoop: drawManager->sync()\n"
                << vprDEBUG_FLUSH;
@@ -617,6 +865,8 @@ void Kernel::controlLoop()
          mSoundManager->sync();
             vpr::prof::next("draw sync",10);
          mDrawManager->sync();    // SYNC: Block until drawing is done
+         display_time.frameDrawn();
+         stamper.end(FrameTiming::DRAW_SYNC);
             vprDEBUG(vrjDBG_KERNEL, vprDBG_HVERB_LVL)
                << "vrj::Kernel::controlLoop: mApp->postFrame()\n"
                << vprDEBUG_FLUSH;
@@ -630,18 +880,21 @@ void Kernel::controlLoop()
          vprASSERT(NULL != mControlThread);      // If control thread is not set correctly, it will seg fault here
          vpr::Thread::yield();   // Give up CPU
       }
+      stamper.end(FrameTiming::POST_FRAME);
 
       // --- Stop for reconfiguration -- //
          vpr::prof::start("checkForReconfig",10);
       checkForReconfig();        // Check for any reconfiguration that needs done (system or application)
          vpr::prof::next("check kern signals",10);
       checkSignalButtons();      // Check for any pending control requests
+      stamper.end(FrameTiming::RECONFIG);
          vprDEBUG(vrjDBG_KERNEL, vprDBG_HVERB_LVL)
             << "vrj::Kernel::controlLoop: Update Trackers\n" << vprDEBUG_FLUSH;
          vpr::prof::next("resetAllDevicesAndProxies", 10);
       getInputManager()->resetAllDevicesAndProxies();
          vpr::prof::next("updateAllDevices",10);
       getInputManager()->updateAllDevices();
+      stamper.end(FrameTiming::DEVICE_UPDATE);
 
 
       if (call_cluster)
@@ -651,24 +904,45 @@ void Kernel::controlLoop()
                << vprDEBUG_FLUSH;
             vpr::prof::next("Cluster: postPostFrame.",10);
          mClusterManager->postPostFrame();
+         stamper.end(FrameTiming::CLUSTER_SYNC);
               vprDEBUG(vrjDBG_KERNEL, vprDBG_HVERB_LVL)
                << "vrj::Kernel::controlLoop: Update Proxies\n"
                << vprDEBUG_FLUSH;
       }
 
          vpr::prof::next("updateAllProxies",10);
+      getInputManager()->setDisplayTime(display_time.proxiesUpdated());
       getInputManager()->updateAllProxies();
          vprDEBUG(vrjDBG_KERNEL, vprDBG_HVERB_LVL)
-            << "vrj::Kernel::controlLoop: Update Projections\n"
+            << "vrj::Kernel::controlLoop: Update frame data\n"
             << vprDEBUG_FLUSH;
          vpr::prof::next("Update frame data",10);
       updateFrameData();         // Any frame-based manager data
          vpr::prof::stop();
+      stamper.end(FrameTiming::PROXY_UPDATE);
+
+      if ( const FrameTiming* timing = stamper.finish() )
+      {
+         mPerformanceMediator->frameCompleted(*timing);
+      }
    }
 
    // Shut down managers now that the kernel is done.
    getInputManager()->shutdown();
 
+   if ( use_frame_arena )
+   {
+      const vpr::FrameArena::Stats& stats = frame_arena.getStats();
+      vprDEBUG(vrjDBG_KERNEL, vprDBG_CONFIG_LVL)
+         << "vrj::Kernel::controlLoop: Frame arena served "
+         << stats.allocations << " allocations (" << stats.bytes
+         << " bytes, peak " << stats.peakBytes << " bytes) in "
+         << stats.frames << " frames; " << stats.heapAllocations
+         << " went to the heap and " << stats.deferredResets
+         << " resets were deferred.\n" << vprDEBUG_FLUSH;
+      vpr::FrameArena::setCurrent(NULL);
+   }
+
    vpr::prof::stop();
 
    vprDEBUG(vrjDBG_KERNEL, vprDBG_WARNING_LVL)
@@ -870,9 +1144,8 @@ void Kernel::initConfig()
 
 void Kernel::updateFrameData()
 {
-   // When we have a draw manager, tell it to update its projections
-   // XXX: Moved to be updated on demand
-   // mDisplayManager->updateProjections();
+   // NOTE: The projections are updated in controlLoop() right before drawing
+   // is triggered so that they use the application's current scale factor.
 }
 
 bool Kernel::configCanHandle(jccl::ConfigElementPtr element)
@@ -0,0 +1,101 @@
+/*************** <auto-copyright.pl BEGIN do not edit this line> **************
+ *
+ * VR Juggler is (C) Copyright 1998-2011 by Iowa State University
+ *
+ * Original Authors:
+ *   Allen Bierbaum, Christopher Just,
+ *   Patrick Hartling, Kevin Meinert,
+ *   Carolina Cruz-Neira, Albert Baker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ *
+ *************** <auto-copyright.pl END do not edit this line> ***************/
+
+#ifndef _VRJ_FRAME_TIMING_H_
+#define _VRJ_FRAME_TIMING_H_
+
+#include <vrj/vrjConfig.h>
+
+#include <vpr/vprTypes.h>
+
+
+namespace vrj
+{
+
+   /** \struct FrameTiming FrameTiming.h vrj/Performance/FrameTiming.h
+    *
+    * How long one pass through the kernel frame loop spent in each of its
+    * phases.  The kernel only fills this in when the loaded performance
+    * plug-in asks for it (see vrj::PerfPlugin::needsFrameTiming()).  It is
+    * plain data so that a plug-in can copy it as is into shared memory or
+    * onto a socket.
+    *
+    * All times are in microseconds as measured by vpr::Interval.  Phases
+    * that did not run in a frame (for example, the application callbacks
+    * while no application is set) are zero.
+    */
+   struct VJ_API FrameTiming
+   {
+      /** The phases of vrj::Kernel::controlLoop(), in the order they run. */
+      enum Phase
+      {
+         PRE_FRAME = 0,       /**< vrj::App::preFrame() */
+         CLUSTER_PRE_DRAW,    /**< Cluster data exchange before drawing */
+         LATE_PRE_FRAME,      /**< vrj::App::latePreFrame() */
+         PROJECTIONS,         /**< Projection update */
+         DRAW_TRIGGER,        /**< Starting the draw and the sound update */
+         INTRA_FRAME,         /**< vrj::App::intraFrame() */
+         DRAW_SYNC,           /**< Waiting for the sound and draw managers */
+         POST_FRAME,          /**< vrj::App::postFrame() */
+         RECONFIG,            /**< Reconfiguration and signal checks */
+         DEVICE_UPDATE,       /**< Reading the input devices */
+         CLUSTER_SYNC,        /**< Cluster synchronization and barrier wait */
+         PROXY_UPDATE,        /**< Updating the input proxies and frame data */
+         NUM_PHASES
+      };
+
+      /**
+       * Returns a short, constant name for the given phase that is suitable
+       * for column headers and trace labels.
+       */
+      static const char* getPhaseName(const Phase phase);
+
+      vpr::Uint64 frameNumber;   /**< Frames since the kernel started */
+      vpr::Uint64 startUsec;     /**< When the frame started */
+      vpr::Uint32 frameUsec;     /**< Length of the whole frame */
+
+      /**
+       * Time from triggering the draw until the draw threads finished.  The
+       * draw threads run while the kernel is in the DRAW_TRIGGER,
+       * INTRA_FRAME and DRAW_SYNC phases, so this is their sum.
+       */
+      vpr::Uint32 drawUsec;
+
+      /**
+       * Age of the first user's head pose when the projections were
+       * computed: the time since the tracker took the sample that the frame
+       * is drawn with.  Zero if the pose has no time stamp.  Late latching
+       * (see \c VJ_LATE_LATCH) lowers it.
+       */
+      vpr::Uint32 poseAgeUsec;
+
+      vpr::Uint32 phaseUsec[NUM_PHASES];   /**< Length of each phase */
+   };
+
+} // namespace vrj
+
+
+#endif
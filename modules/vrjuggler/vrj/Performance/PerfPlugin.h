@@ -33,6 +33,8 @@
 namespace vrj
 {
 
+   struct FrameTiming;
+
    /** \class PerfPlugin PerfPlugin.h vrj/Performance/PerfPlugin.h
     *
     * Performance monitoring plug-in interface.
@@ -66,6 +68,29 @@ namespace vrj
        */
       virtual void disable() = 0;
 
+      /**
+       * Indicates whether this plug-in wants the timing of every frame
+       * passed to frameCompleted().  The kernel only reads the clock between
+       * the phases of its frame loop when this returns true, so plug-ins
+       * that do not use the timing should leave it alone.  It is queried
+       * once when the plug-in is enabled.
+       */
+      virtual bool needsFrameTiming() const
+      {
+         return false;
+      }
+
+      /**
+       * Receives the timing of the frame that just ended.  This is invoked
+       * from the kernel thread at the end of every frame, so it must not
+       * block.
+       */
+      virtual void frameCompleted(const vrj::FrameTiming&)
+      {
+         /* Do nothing. */ 
+         ;
+      }
+
 #ifdef VPR_OS_Windows
       /**
        * Overlaod delete so that we can delete our memory correctly.  This is
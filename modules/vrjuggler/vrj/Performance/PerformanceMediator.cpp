@@ -51,6 +51,7 @@ namespace vrj
 
    PerformanceMediator::PerformanceMediator()
    : mPerfIf(NULL)
+   , mNeedsFrameTiming(false)
    {
       try
       {
@@ -196,13 +197,19 @@ namespace vrj
                          search_path[0] / std::string("debug"));
 #endif
 
+      // The base name of the plug-in to load can be given through
+      // VJ_PERF_PLUGIN.  The CORBA-based plug-in is the default.
+      const std::string vj_perf_plugin("VJ_PERF_PLUGIN");
+      std::string perf_mon_dso;
+
+      if ( ! vpr::System::getenv(vj_perf_plugin, perf_mon_dso) ||
+           perf_mon_dso.empty() )
+      {
+         perf_mon_dso = "corba_perf_mon";
+      }
+
       try
       {
-         // In the long run, we may not want to hard-code the base name of the
-         // plug-in we load.  If we ever reach a point where we have multiple
-         // ways of implementing remote performance monitoring, we could have
-         // options for which plug-in to load.
-         const std::string perf_mon_dso("corba_perf_mon");
          const std::string init_func("initPlugin");
          Callable functor(this);
          vpr::LibraryLoader::findDSOAndCallEntryPoint(perf_mon_dso,
@@ -252,6 +259,8 @@ namespace vrj
          delete mPerfIf;
       }
 
+      mNeedsFrameTiming = false;
+
       vprDEBUG(jcclDBG_RECONFIG, vprDBG_VERB_LVL)
       << "[PerformanceMediator::setPerfPlugin()] "
          << "Enabling new remote performance monitoring plug-in\n"
@@ -273,6 +282,10 @@ namespace vrj
                delete mPerfIf;
                mPerfIf = NULL;
             }
+            else
+            {
+               mNeedsFrameTiming = mPerfIf->needsFrameTiming();
+            }
          }
          // Initialization failed.
          else
@@ -287,4 +300,12 @@ namespace vrj
       }
    }
 
+   void PerformanceMediator::frameCompleted(const vrj::FrameTiming& timing)
+   {
+      if ( NULL != mPerfIf )
+      {
+         mPerfIf->frameCompleted(timing);
+      }
+   }
+
 } // namespace vrj
@@ -42,6 +42,7 @@ namespace vrj
 {
 
    class PerfPlugin;
+   struct FrameTiming;
 
    /** \class PerformanceMediator PerformanceMediator.h vrj/Performance/PerformanceMediator.h
     *
@@ -55,6 +56,19 @@ namespace vrj
       virtual ~PerformanceMediator();
       void setPerfPlugin(vrj::PerfPlugin* plugin);
 
+      /**
+       * Indicates whether the kernel should time the phases of each frame
+       * and pass the result to frameCompleted().  This is false unless the
+       * current plug-in asks for the timing.
+       */
+      bool needsFrameTiming() const
+      {
+         return mNeedsFrameTiming;
+      }
+
+      /** Hands the timing of the frame that just ended to the plug-in. */
+      void frameCompleted(const vrj::FrameTiming& timing);
+
    protected:
       /** Enables the remote performance monitoring interface object. */
       void loadPerfPlugin();
@@ -71,6 +85,7 @@ namespace vrj
    private:
       vpr::LibraryPtr mPluginDSO;
       PerfPlugin* mPerfIf;
+      bool mNeedsFrameTiming;
    }; // class Mediator
 
 } // namespace vrj